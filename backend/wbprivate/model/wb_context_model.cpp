@@ -49,6 +49,7 @@
 #include "grtdb/db_object_helpers.h"
 #include "grt/clipboard.h"
 #include "grt/common.h"
+#include "grt/validation_manager.h"
 
 #include "grtpp_notifications.h"
 
@@ -381,6 +382,8 @@ void WBContextModel::model_created(ModelFile *file, workbench_DocumentRef doc)
   
   _doc->physicalModels()[0]->get_data()->realize();
 
+  bec::ValidationManager::track_catalog(_doc->physicalModels()[0]->catalog());
+
   _wbui->get_wb()->request_refresh(RefreshNewModel, "", 0);
 
   // setup GRT proxy object
@@ -406,6 +409,8 @@ void WBContextModel::model_loaded(ModelFile *file, workbench_DocumentRef doc)
   _wbui->get_wb()->foreach_component(boost::bind(&WBComponent::document_loaded, _1));
   
   _doc->physicalModels().get(0)->get_data()->set_delegate(this);
+
+  bec::ValidationManager::track_catalog(_doc->physicalModels()[0]->catalog());
     
   _wbui->get_wb()->request_refresh(RefreshNewModel, "", 0);
   
@@ -694,10 +699,13 @@ void WBContextModel::diagram_object_changed(const std::string &member, const grt
   {
     if (view->get_model_diagram().is_valid())
     {
-      base::NotificationInfo info;
-      info["form"] = view->form_id();
-      info["title"] = view->get_title();
-      base::NotificationCenter::get()->send("GNFormTitleDidChange", view, info);
+      if (base::NotificationCenter::get()->has_observers("GNFormTitleDidChange"))
+      {
+        base::NotificationInfo info;
+        info["form"] = view->form_id();
+        info["title"] = view->get_title();
+        base::NotificationCenter::get()->send("GNFormTitleDidChange", view, info);
+      }
       _wbui->get_physical_overview()->send_refresh_diagram(view->get_model_diagram());
     }
   }
@@ -28,9 +28,11 @@
 #include "base/log.h"
 
 #include "mforms/utilities.h"
+#include "mforms/filechooser.h"
 #include "wb_sql_editor_form.h"
 #include "wb_sql_editor_panel.h"
 #include <boost/foreach.hpp>
+#include <set>
 
 DEFAULT_LOG_DOMAIN("SqlEditorLog");
 
@@ -56,14 +58,17 @@ DbSqlEditorLog::DbSqlEditorLog(SqlEditorForm *owner, GRTManager *grtm, int max_e
   _context_menu.add_item("Copy Action", "copy_action");
   _context_menu.add_item("Copy Response", "copy_message");
   _context_menu.add_item("Copy Duration", "copy_duration");
+  _context_menu.add_item("Copy Timings as JSON", "copy_timings");
   _context_menu.add_separator();
   _context_menu.add_item("Append Selected Items to SQL script", "append_selected_items");
   _context_menu.add_item("Replace SQL Script With Selected Items", "replace_sql_script");
   _context_menu.add_separator();
   _context_menu.add_item("Clear", "clear");
+  _context_menu.add_separator();
+  _context_menu.add_item("Save All Timings as JSON...", "save_timings");
   _context_menu.set_handler(boost::bind(&DbSqlEditorLog::handle_context_menu, this, _1));
   
-  for (int i = 0; i < 8; i++)
+  for (int i = 0; i < 9; i++)
     _context_menu.set_item_enabled(i, false);
 }
 
@@ -135,6 +140,14 @@ void DbSqlEditorLog::handle_context_menu(const std::string &action)
     sql = get_selection_text(false, false, false, true);
     mforms::Utilities::set_clipboard_text(sql);
   }
+  else if (action == "copy_timings")
+  {
+    mforms::Utilities::set_clipboard_text(get_timings_json(true));
+  }
+  else if (action == "save_timings")
+  {
+    save_timings();
+  }
   else if (action == "append_selected_items")
   {
     sql = get_selection_text(false, true, false, false);
@@ -161,7 +174,7 @@ void DbSqlEditorLog::set_selection(const std::vector<int> &selection)
 {
   _selection = selection;
   bool has_selection = !selection.empty();
-  for (int i = 0; i < 8; i++)
+  for (int i = 0; i < 9; i++)
     _context_menu.set_item_enabled(i, has_selection);
 }
 
@@ -174,6 +187,7 @@ void DbSqlEditorLog::reset()
   {
     base::RecMutexLock data_mutex(_data_mutex);
     _data.clear();
+    _timings.clear();
     _next_id = 1;
   }
 
@@ -289,9 +303,32 @@ bool DbSqlEditorLog::get_field(const bec::NodeId &node, ColumnId column, std::st
 
 //--------------------------------------------------------------------------------------------------
 
+static std::string format_timings(const DbSqlEditorLog::StatementTimings &timings)
+{
+  return strfmt("analysis %.6f sec, execution %.6f sec, transfer %.6f sec, swap db %.6f sec, total %.6f sec",
+    timings.analysis, timings.execution, timings.transfer, timings.swap_db, timings.total());
+}
+
+//--------------------------------------------------------------------------------------------------
+
 bool DbSqlEditorLog::get_field_description(const bec::NodeId &node, ColumnId column, std::string &value)
 {
-  return VarGridModel::get_field(node, column, value);
+  if (!VarGridModel::get_field(node, column, value))
+    return false;
+
+  // The duration tooltip shows where the time went.
+  if (column == 5)
+  {
+    ssize_t id;
+    if (VarGridModel::get_field(node, 1, id))
+    {
+      base::RecMutexLock data_mutex(_data_mutex);
+      const TimingsEntry *entry = find_timings((RowId)id);
+      if (entry != NULL)
+        value.append("\n").append(format_timings(entry->timings));
+    }
+  }
+  return true;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -370,6 +407,117 @@ void DbSqlEditorLog::set_message(RowId row, int msg_type, const std::string &con
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Records the time spent in the phases of a statement run, which was logged with the given message.
+ * Timings are kept for as many messages as the log holds.
+ */
+void DbSqlEditorLog::set_timings(RowId row, const std::string &statement, const StatementTimings &timings)
+{
+  TimingsEntry entry;
+  entry.id = row;
+  entry.time = current_time();
+  entry.statement = base::truncate_text(statement, MAX_LOG_STATEMENT_TEXT);
+  entry.timings = timings;
+
+  {
+    base::FILE_scope_ptr fp = base_fopen(_log_file_name.c_str(), "a");
+    fprintf(fp, "[%u, %s] Timings: %s\n",  (unsigned)row, entry.time.c_str(), format_timings(timings).c_str());
+  }
+
+  base::RecMutexLock data_mutex(_data_mutex);
+  if (!_timings.empty() && _timings.back().id == row)
+  {
+    // A statement that failed while fetching was recorded already.
+    _timings.back() = entry;
+    return;
+  }
+  if (_max_entry_count > -1 && (int)_timings.size() >= _max_entry_count)
+    _timings.pop_front();
+  _timings.push_back(entry);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the timings recorded for the given message or NULL if there are none. _data_mutex must be locked.
+ */
+const DbSqlEditorLog::TimingsEntry *DbSqlEditorLog::find_timings(RowId row) const
+{
+  // Recent entries are looked up most often.
+  for (std::deque<TimingsEntry>::const_reverse_iterator entry = _timings.rbegin(); entry != _timings.rend(); ++entry)
+  {
+    if (entry->id == row)
+      return &*entry;
+  }
+  return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static std::string timings_json_fields(const DbSqlEditorLog::StatementTimings &timings)
+{
+  return strfmt("\"analysis\": %.6f, \"execution\": %.6f, \"transfer\": %.6f, \"swap_db\": %.6f, \"total\": %.6f",
+    timings.analysis, timings.execution, timings.transfer, timings.swap_db, timings.total());
+}
+
+std::string DbSqlEditorLog::get_timings_json(bool selection_only)
+{
+  std::set<RowId> selected_ids;
+  if (selection_only)
+  {
+    for (std::vector<int>::const_iterator row = _selection.begin(); row != _selection.end(); ++row)
+    {
+      ssize_t id;
+      if (VarGridModel::get_field(*row, 1, id))
+        selected_ids.insert((RowId)id);
+    }
+  }
+
+  StatementTimings totals;
+  size_t count = 0;
+  std::string json = "{\n  \"statements\": [";
+
+  base::RecMutexLock data_mutex(_data_mutex);
+  for (std::deque<TimingsEntry>::const_iterator entry = _timings.begin(); entry != _timings.end(); ++entry)
+  {
+    if (selection_only && selected_ids.find(entry->id) == selected_ids.end())
+      continue;
+
+    json.append(count > 0 ? ",\n" : "\n");
+    json.append(strfmt("    {\"id\": %u, \"time\": \"%s\", \"statement\": \"%s\", %s}", (unsigned)entry->id,
+      base::escape_json_string(entry->time).c_str(), base::escape_json_string(entry->statement).c_str(),
+      timings_json_fields(entry->timings).c_str()));
+
+    totals.analysis += entry->timings.analysis;
+    totals.execution += entry->timings.execution;
+    totals.transfer += entry->timings.transfer;
+    totals.swap_db += entry->timings.swap_db;
+    ++count;
+  }
+  json.append("\n  ],\n");
+  json.append(strfmt("  \"totals\": {\"count\": %u, %s}\n}\n", (unsigned)count, timings_json_fields(totals).c_str()));
+
+  return json;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void DbSqlEditorLog::save_timings()
+{
+  mforms::FileChooser chooser(mforms::SaveFile);
+  chooser.set_title("Save Statement Timings to File");
+  chooser.set_extensions("JSON Files (*.json)|*.json", "json");
+  if (chooser.run_modal())
+  {
+    std::string json = get_timings_json(false);
+    if (!g_file_set_contents(chooser.get_path().c_str(), json.c_str(), (gssize)json.size(), NULL))
+      mforms::Utilities::show_error("Save to File",
+        strfmt("Could not save timings to file '%s'", chooser.get_path().c_str()), "OK");
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 /**
  * This function does actually add the message and can also be called be set_message, if the 
  * there's no message with a given id anymore.
@@ -23,6 +23,7 @@
 #include "workbench/wb_backend_public_interface.h"
 #include "sqlide/var_grid_model_be.h"
 #include <boost/shared_ptr.hpp>
+#include <deque>
 #include "mforms/menu.h"
 
 class SqlEditorForm;
@@ -41,6 +42,18 @@ public:
   
   typedef boost::shared_ptr<DbSqlEditorLog> Ref;
 
+  // Time spent in the phases of running a statement, in seconds.
+  struct StatementTimings
+  {
+    double analysis;   // Splitting, type detection and decoration of the statement in the client.
+    double execution;  // Sending the statement and running it on the server.
+    double transfer;   // Reading result rows from the server.
+    double swap_db;    // Storing result rows in the local swap db.
+
+    StatementTimings() : analysis(0), execution(0), transfer(0), swap_db(0) {}
+    double total() const { return analysis + execution + transfer + swap_db; }
+  };
+
   virtual ~DbSqlEditorLog() {}
 
   static Ref create(SqlEditorForm *owner, bec::GRTManager *grtm, int max_entry_count)
@@ -58,6 +71,10 @@ public:
 
   RowId add_message(int msg_type, const std::string &context, const std::string &msg, const std::string &duration);
   void set_message(RowId row, int msg_type, const std::string &context, const std::string &msg, const std::string &duration);
+  void set_timings(RowId row, const std::string &statement, const StatementTimings &timings);
+
+  // All recorded timings, or only those of the selected messages.
+  std::string get_timings_json(bool selection_only);
 
   mforms::Menu* get_context_menu();
   void set_selection(const std::vector<int> &selection);
@@ -75,7 +92,18 @@ private:
   int _max_entry_count;        // For the internal list which is used in the UI.
   std::string _log_file_name;  // For the action log file.
   unsigned _next_id;
-  
+
+  struct TimingsEntry
+  {
+    RowId id;
+    std::string time;
+    std::string statement;
+    StatementTimings timings;
+  };
+  std::deque<TimingsEntry> _timings;
+
+  const TimingsEntry *find_timings(RowId row) const;
+  void save_timings();
   void handle_context_menu(const std::string &action);
 };
 
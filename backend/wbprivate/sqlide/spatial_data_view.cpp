@@ -41,6 +41,9 @@
 
 DEFAULT_LOG_DOMAIN("spatial");
 
+// Number of geometries read from a resultset before they are parsed (in parallel).
+#define LOAD_BATCH_SIZE 10000
+
 
 class RecordsetLayer : public spatial::Layer
 {
@@ -66,15 +69,29 @@ public:
       ssize_t row_count = rs->row_count();
       float step = 1.0f / row_count;
 
-      for (ssize_t c = row_count, row = 0; row < c; row++)
+      // Raw data is fetched here, but parsing happens in parallel for a whole batch of rows.
+      std::vector<std::pair<int, std::string> > batch;
+      batch.reserve(LOAD_BATCH_SIZE);
+      for (ssize_t c = row_count, row = 0; row < c && !_interrupt; row++)
       {
         std::string geom_data; // data in MySQL internal binary geometry format.. this is neither WKT nor WKB
         // but the internal format seems to be 4 bytes of SRID followed by WKB data
         if (rs->get_raw_field(row, _geom_column, geom_data) && !geom_data.empty())
-          add_feature((int)row, geom_data, false);
+        {
+          batch.push_back(std::make_pair((int)row, std::string()));
+          batch.back().second.swap(geom_data);
+        }
+
+        if (batch.size() == LOAD_BATCH_SIZE)
+        {
+          add_features(batch, false);
+          batch.clear();
+        }
 
         _render_progress += step;
       }
+      if (!batch.empty())
+        add_features(batch, false);
     }
   }
 
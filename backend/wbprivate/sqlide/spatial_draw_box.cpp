@@ -194,49 +194,71 @@ void SpatialDrawBox::render(bool reproject)
   _spatial_reprojector->change_projection(visible_area, NULL, spatial::Projection::get_instance().get_projection(_proj));
 
   // TODO lat/long ranges must be adjusted accordingly to account for the aspect ratio of the visible area
-  boost::shared_ptr<mdc::ImageSurface> surface(new mdc::ImageSurface(get_width(), get_height(), CAIRO_FORMAT_ARGB32));
-  _cache = surface;
-
-  if (_ctx_cache != NULL)
-    delete _ctx_cache;
-  _ctx_cache = new mdc::CairoCtx(*surface);
+  // The new frame is drawn into its own surface and only published when complete, so the UI can continue
+  // to show the previous one in the meantime.
+  boost::shared_ptr<mdc::ImageSurface> surface(new mdc::ImageSurface(width, height, CAIRO_FORMAT_ARGB32));
+  mdc::CairoCtx *ctx = new mdc::CairoCtx(*surface);
+  int offset_x = _offset_x, offset_y = _offset_y;
 
   _current_work = "Rendering layers...";
   _current_layer = NULL;
   _current_layer_index = 0;
 
+  ctx->set_color(_background_layer && _background_layer->fill() ? _background_layer->color() : base::Color(1, 1, 1));
+  ctx->paint();
+
   if (_zoom_level != 1)
   {
-    _ctx_cache->translate(base::Point(this->get_width() / 2.0, this->get_height() / 2.0));
-    _ctx_cache->scale(base::Point(_zoom_level, _zoom_level));
-    _ctx_cache->translate(base::Point(- this->get_width() / 2.0, - this->get_height() / 2.0));
+    ctx->translate(base::Point(width / 2.0, height / 2.0));
+    ctx->scale(base::Point(_zoom_level, _zoom_level));
+    ctx->translate(base::Point(- width / 2.0, - height / 2.0));
   }
 
-  _ctx_cache->translate(base::Point(_offset_x, _offset_y));
+  ctx->translate(base::Point(offset_x, offset_y));
 
-  _ctx_cache->set_line_width(0);
+  ctx->set_line_width(0);
 
-  if (reproject && !_background_layer->hidden())
-    _background_layer->render(_spatial_reprojector);
+  // Only features within the visible part of the view are painted.
+  double left = 0, top = 0, right = width, bottom = height;
+  ctx->device_to_user(&left, &top);
+  ctx->device_to_user(&right, &bottom);
+  base::Rect clip_area(base::Point(left, top), base::Point(right, bottom));
+
+  if (_background_layer && !_background_layer->hidden())
+  {
+    if (reproject)
+      _background_layer->render(_spatial_reprojector);
+    _background_layer->repaint(*ctx, _zoom_level, clip_area);
+  }
 
   int i = 0;
 
-  base::MutexLock lock(_layer_mutex);
-  for (std::deque<spatial::Layer*>::iterator it = _layers.begin(); it != _layers.end() && !_quitting; ++it, ++i)
   {
-    _current_work = base::strfmt("Rendering %i objects in layer %i...", (int)(*it)->size(), i+1);
-
-    _current_layer_index = i;
-    _current_layer = *it;
-    if (!(*it)->hidden())
+    base::MutexLock lock(_layer_mutex);
+    for (std::deque<spatial::Layer*>::iterator it = _layers.begin(); it != _layers.end() && !_quitting; ++it, ++i)
     {
-      if (reproject)
-        (*it)->render(_spatial_reprojector);
-      (*it)->repaint(*_ctx_cache, _zoom_level, base::Rect());
+      _current_work = base::strfmt("Rendering %i objects in layer %i...", (int)(*it)->size(), i+1);
 
+      _current_layer_index = i;
+      _current_layer = *it;
+      if (!(*it)->hidden())
+      {
+        if (reproject)
+          (*it)->render(_spatial_reprojector);
+        (*it)->repaint(*ctx, _zoom_level, clip_area);
+      }
     }
   }
 
+  {
+    base::MutexLock lock(_cache_mutex);
+    _cache = surface;
+    delete _ctx_cache;
+    _ctx_cache = ctx;
+    _cache_offset_x = offset_x;
+    _cache_offset_y = offset_y;
+  }
+
   if (reproject)
     _needs_reprojection = false;
 }
@@ -263,7 +285,7 @@ bool SpatialDrawBox::get_progress(std::string &action, float &pct)
 
 SpatialDrawBox::SpatialDrawBox()
 : _background_layer(NULL), _last_autozoom_layer(0),
-_proj(spatial::ProjRobinson), _ctx_cache(NULL), _spatial_reprojector(NULL),
+_proj(spatial::ProjRobinson), _ctx_cache(NULL), _cache_offset_x(0), _cache_offset_y(0), _spatial_reprojector(NULL),
 _zoom_level(1.0), _offset_x(0), _offset_y(0), _ready(false), _dragging(false),
 _rendering(false), _quitting(false), _needs_reprojection(true), _select_pending(false), _selecting(false)
 {
@@ -692,41 +714,29 @@ void SpatialDrawBox::restrict_displayed_area(int x1, int y1, int x2, int y2, boo
 
 void SpatialDrawBox::repaint(cairo_t *crt, int x, int y, int w, int h)
 {
-  boost::shared_ptr<mdc::Surface> cache(_cache);
+  boost::shared_ptr<mdc::Surface> cache;
+  int cache_offset_x, cache_offset_y;
+  {
+    base::MutexLock lock(_cache_mutex);
+    cache = _cache;
+    cache_offset_x = _cache_offset_x;
+    cache_offset_y = _cache_offset_y;
+  }
+
   mdc::CairoCtx cr(crt);
+  cr.set_color(_background_layer && _background_layer->fill() ? _background_layer->color() : base::Color(1, 1, 1));
+  cr.paint();
   if (cache)
   {
-    cr.set_color(_background_layer && _background_layer->fill() ? _background_layer->color() : base::Color(1, 1, 1));
-    cr.paint();
-    cr.set_source_surface(cache->get_surface(), 0, 0);
+    // The background layer is part of the rendered frame. Panning done since the frame was rendered
+    // is applied by shifting the image until the next frame is ready.
+    cr.set_source_surface(cache->get_surface(), (_offset_x - cache_offset_x) * _zoom_level,
+      (_offset_y - cache_offset_y) * _zoom_level);
     if (_rendering) // if we're currently re-rendering the image, we paint the old version half transparent
       cr.paint_with_alpha(0.4);
     else
       cr.paint();
   }
-  else if (!_progress)
-  {
-    cr.set_color(_background_layer &&  _background_layer->fill() ? _background_layer->color() : base::Color(1, 1, 1));
-    cr.paint();
-  }
-
-  if (_background_layer && !_background_layer->hidden())
-  {
-    cr.save();
-    if (_zoom_level != 1)
-    {
-      cr.translate(base::Point(this->get_width() / 2, this->get_height() / 2));
-      cr.scale(base::Point(_zoom_level, _zoom_level));
-      cr.translate(base::Point(- this->get_width() / 2, - this->get_height() / 2));
-    }
-
-    cr.translate(base::Point(_offset_x, _offset_y));
-
-
-    cr.set_line_width(0);
-    _background_layer->repaint(cr, _zoom_level, base::Rect());
-    cr.restore();
-  }
 
   if (_rendering)
   {
@@ -803,14 +813,18 @@ void SpatialDrawBox::clear_pins()
 base::Point SpatialDrawBox::unapply_cairo_transformation(const base::Point &p) const
 {
   double xx = p.x, yy = p.y;
-  _ctx_cache->user_to_device(&xx, &yy);
+  base::MutexLock lock(_cache_mutex);
+  if (_ctx_cache != NULL)
+    _ctx_cache->user_to_device(&xx, &yy);
   return base::Point(xx, yy);
 }
 
 base::Point SpatialDrawBox::apply_cairo_transformation(const base::Point &p) const
 {
   double xx = p.x, yy = p.y;
-  _ctx_cache->device_to_user(&xx, &yy);
+  base::MutexLock lock(_cache_mutex);
+  if (_ctx_cache != NULL)
+    _ctx_cache->device_to_user(&xx, &yy);
   return base::Point(xx, yy);
 }
 
@@ -41,8 +41,12 @@ class SpatialDrawBox : public mforms::DrawBox
   std::deque<spatial::Layer*> _layers;
   spatial::LayerId _last_autozoom_layer;
   spatial::ProjectionType _proj;
+  // The last completely rendered frame. Rendering happens in a background thread, the UI only blits
+  // this surface (shifted by the panning done since it was rendered).
+  mutable base::Mutex _cache_mutex; // Also guards _ctx_cache, which the UI thread uses for coordinate mapping.
   boost::shared_ptr<mdc::Surface> _cache;
   mdc::CairoCtx *_ctx_cache;
+  int _cache_offset_x, _cache_offset_y;
   base::Mutex _thread_mutex;
   spatial::Converter *_spatial_reprojector;
 
@@ -185,6 +185,26 @@ public:
     return grt::IntegerRef(0);
   }
 
+  virtual grt::IntegerRef executeScriptFile(const std::string &path, const std::string &defaultSchema, const std::string &defaultCharset,
+    ssize_t startOffset, const std::string &delimiter)
+  {
+    boost::shared_ptr<SqlEditorForm> ref(_editor);
+    if (ref)
+    {
+      ref->exec_sql_script_file(path, defaultSchema, defaultCharset, startOffset, delimiter);
+      return grt::IntegerRef(0);
+    }
+    return grt::IntegerRef(-1);
+  }
+
+  virtual grt::DictRef scriptFileStatus()
+  {
+    boost::shared_ptr<SqlEditorForm> ref(_editor);
+    if (ref)
+      return ref->script_file_status();
+    return grt::DictRef();
+  }
+
   virtual db_query_ResultsetRef executeManagementQuery(const std::string &sql, bool log)
   {
     boost::shared_ptr<SqlEditorForm> ref(_editor);
@@ -514,13 +514,16 @@ _is_schema_contents_enabled(true), _enabled_events(false), _base(0), _filter_typ
   mforms::TreeNodeSkeleton fetching_trigger(FETCHING_CAPTION, _icon_paths[Trigger], "");
   triggers.children.push_back(fetching_trigger);
   table_nodes.children.push_back(triggers);
-  
+
+  // Schemas can have thousands of tables, most of which are never expanded
+  table_nodes.lazy_children = true;
   _node_collections[Table] = table_nodes;
 
   // Setup the view node collection skeleton
   mforms::TreeNodeCollectionSkeleton view_nodes(_icon_paths[View]);
   mforms::TreeNodeSkeleton fetching_view(FETCHING_CAPTION, _icon_paths[View], "");
   view_nodes.children.push_back(fetching_view);
+  view_nodes.lazy_children = true;
   _node_collections[View] = view_nodes;
   
   mforms::TreeNodeCollectionSkeleton procedure_nodes(_icon_paths[Procedure]);
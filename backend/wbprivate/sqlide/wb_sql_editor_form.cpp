@@ -167,6 +167,18 @@ private:
   double _duration;
 };
 
+/**
+ * Completes the phase timings of a statement with what the timers measured and adds them to the log.
+ * Execution includes the network round trip, as the client cannot tell it apart from server time.
+ */
+static void log_statement_timings(DbSqlEditorLog::Ref log, RowId log_message_index, const std::string &statement,
+  DbSqlEditorLog::StatementTimings timings, Timer &exec_timer, Timer &fetch_timer)
+{
+  timings.execution= exec_timer.duration();
+  timings.transfer+= fetch_timer.duration();
+  log->set_timings(log_message_index, statement, timings);
+}
+
 SqlEditorForm::Ref SqlEditorForm::create(wb::WBContextSQLIDE *wbsql, const db_mgmt_ConnectionRef &conn)
 {
   SqlEditorForm::Ref instance(new SqlEditorForm(wbsql));
@@ -1635,7 +1647,14 @@ void SqlEditorForm::cancel_query()
     db_mgmt_RdbmsRef rdbms= db_mgmt_RdbmsRef::cast_from(_connection->driver()->owner());
     SqlFacade::Ref sql_facade= SqlFacade::instance_for_rdbms(rdbms);
     Sql_specifics::Ref sql_specifics= sql_facade->sqlSpecifics();
-    query_kill_query= sql_specifics->query_kill_query(_usr_dbc_conn->id);
+    // A running script file has its own connection, that's where its statements must be stopped.
+    boost::int64_t conn_id= _usr_dbc_conn->id;
+    {
+      base::MutexLock lock(_script_file_mutex);
+      if (_script_dbc_conn)
+        conn_id= _script_dbc_conn->id;
+    }
+    query_kill_query= sql_specifics->query_kill_query(conn_id);
   }
   if (query_kill_query.empty())
     return;
@@ -1931,6 +1950,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(grt::GRT *grt, Ptr self_ptr, boost::sh
       }
 
       statement = sql->substr(statement_range.first, statement_range.second);
+      Timer statement_analysis_timer(true);
       std::list<std::string> sub_statements;
       sql_facade->splitSqlScript(statement, sub_statements);
       size_t multiple_statement_count = sub_statements.size();
@@ -1987,6 +2007,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(grt::GRT *grt, Ptr self_ptr, boost::sh
           }
           statement= data_storage->decorated_sql_query();
         }
+        statement_analysis_timer.stop();
 
         {
           RowId log_message_index= add_log_message(DbSqlEditorLog::BusyMsg, _("Running..."), statement,
@@ -1996,6 +2017,9 @@ grt::StringRef SqlEditorForm::do_exec_sql(grt::GRT *grt, Ptr self_ptr, boost::sh
           long long updated_rows_count= -1;
           Timer statement_exec_timer(false);
           Timer statement_fetch_timer(false);
+          RowId timings_log_message_index= log_message_index;
+          DbSqlEditorLog::StatementTimings statement_timings;
+          statement_timings.analysis= statement_analysis_timer.duration();
           boost::shared_ptr<sql::Statement> dbc_statement(_usr_dbc_conn->ref->createStatement());
           bool is_result_set_first= false;
 
@@ -2049,6 +2073,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(grt::GRT *grt, Ptr self_ptr, boost::sh
           }
           if (statement_failed)
           {
+            log_statement_timings(_log, timings_log_message_index, statement, statement_timings, statement_exec_timer, statement_fetch_timer);
             if (_continue_on_error)
               continue; // goto next statement
             else
@@ -2152,6 +2177,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(grt::GRT *grt, Ptr self_ptr, boost::sh
                         break;
                       }
                       set_log_message(log_message_index, DbSqlEditorLog::ErrorMsg, err_msg, statement, statement_exec_timer.duration_formatted());
+                      log_statement_timings(_log, timings_log_message_index, statement, statement_timings, statement_exec_timer, statement_fetch_timer);
                       
                       if (_continue_on_error)
                         continue; // goto next statement
@@ -2201,6 +2227,8 @@ grt::StringRef SqlEditorForm::do_exec_sql(grt::GRT *grt, Ptr self_ptr, boost::sh
                       RecMutexLock aux_mtx(ensure_valid_aux_connection(_aux_dbc_conn));
                       rs->reset(true);
                     }
+                    statement_timings.transfer+= data_storage->fetch_duration();
+                    statement_timings.swap_db+= data_storage->swap_db_duration();
 
                     if (data_storage->valid()) // query statement
                     {
@@ -2244,6 +2272,7 @@ grt::StringRef SqlEditorForm::do_exec_sql(grt::GRT *grt, Ptr self_ptr, boost::sh
           {
             set_log_message(log_message_index, DbSqlEditorLog::OKMsg, _("OK"), statement, statement_exec_timer.duration_formatted());
           }
+          log_statement_timings(_log, timings_log_message_index, statement, statement_timings, statement_exec_timer, statement_fetch_timer);
         }
       }
     } // BOOST_FOREACH (statement, statements)
@@ -2280,6 +2309,214 @@ stop_processing_sql_script:
 }
 
 
+/**
+ * Runs the given script file in the background, on a connection of its own so the script can't change
+ * the character set, default schema or other session state of the editor. The file is read while
+ * it is executed, so its size is not limited by the available memory. Progress is shown in the
+ * action log and can be polled with script_file_status(). Execution stops at the first error, the
+ * log then tells at which offset and with which delimiter the script can be continued. Pass both to
+ * continue a stopped run.
+ */
+void SqlEditorForm::exec_sql_script_file(const std::string &path, const std::string &default_schema,
+  const std::string &default_charset, boost::int64_t start_offset, const std::string &delimiter)
+{
+  if (!connected())
+    throw grt::db_not_connected("Not connected");
+
+  {
+    base::MutexLock lock(_script_file_mutex);
+    _script_file_status = ScriptFileStatus();
+    _script_file_status.running = true;
+    _script_file_status.resume_offset = start_offset;
+    _script_file_status.resume_delimiter = delimiter;
+  }
+
+  exec_sql_task->exec(false,
+    boost::bind(&SqlEditorForm::do_exec_sql_script_file, this, _1, weak_ptr_from(this), path,
+                default_schema, default_charset, start_offset, delimiter));
+}
+
+
+/**
+ * Returns the state of the current or last script file run as dict with the keys running, done,
+ * total, rate, output (list of messages), resumeOffset, resumeDelimiter, errorCode and loginError.
+ */
+grt::DictRef SqlEditorForm::script_file_status()
+{
+  base::MutexLock lock(_script_file_mutex);
+
+  grt::DictRef status(_grtm->get_grt());
+  status.gset("running", _script_file_status.running ? 1 : 0);
+  status.gset("done", (long)_script_file_status.done);
+  status.gset("total", (long)_script_file_status.total);
+  status.gset("rate", _script_file_status.rate);
+  grt::StringListRef output(_grtm->get_grt());
+  for (std::vector<std::string>::const_iterator line = _script_file_status.output.begin();
+       line != _script_file_status.output.end(); ++line)
+    output.insert(*line);
+  status.set("output", output);
+  status.gset("resumeOffset", (long)_script_file_status.resume_offset);
+  status.gset("resumeDelimiter", _script_file_status.resume_delimiter);
+  status.gset("errorCode", _script_file_status.error_code);
+  status.gset("loginError", _script_file_status.login_error ? 1 : 0);
+
+  return status;
+}
+
+
+grt::StringRef SqlEditorForm::do_exec_sql_script_file(grt::GRT *grt, Ptr self_ptr, const std::string &path,
+  const std::string &default_schema, const std::string &default_charset, boost::int64_t start_offset,
+  const std::string &delimiter)
+{
+  RETVAL_IF_FAIL_TO_RETAIN_WEAK_PTR (SqlEditorForm, self_ptr, self, grt::StringRef(""))
+
+  _grtm->replace_status_text(strfmt(_("Running script %s..."), path.c_str()));
+
+  std::string context = strfmt(_("Run script %s"), path.c_str());
+  RowId log_id = add_log_message(DbSqlEditorLog::BusyMsg, _("Running..."), context, "");
+
+  sql::Dbc_connection_handler::Ref script_conn(new sql::Dbc_connection_handler());
+  sql::Driver *dbc_driver= NULL;
+  std::string message;
+  try
+  {
+    // The user connection stays locked, so the editor doesn't run anything else meanwhile.
+    RecMutexLock use_dbc_conn_mutex(ensure_valid_usr_connection());
+
+    dbc_driver= _usr_dbc_conn->ref->getDriver();
+    dbc_driver->threadInit();
+
+    bool is_running_query= true;
+    AutoSwap<bool> is_running_query_keeper(_is_running_query, is_running_query);
+    update_menu_and_toolbar();
+
+    // Scripts without a USE statement run in the current schema of the editor, like typed statements.
+    script_conn->active_schema = default_schema.empty() ? _usr_dbc_conn->active_schema : default_schema;
+    create_connection(script_conn, _connection, sql::DriverManager::getDriverManager()->getTunnel(_connection),
+                      _dbc_auth, true, false);
+    {
+      base::MutexLock lock(_script_file_mutex);
+      _script_dbc_conn = script_conn;
+    }
+
+    std::auto_ptr<sql::Statement> stmt(script_conn->ref->createStatement());
+    if (!default_charset.empty())
+      stmt->execute(std::string(base::sqlstring("SET NAMES ?", 0) << default_charset));
+
+    Timer exec_timer(true);
+    sql::SqlScriptReader reader(path, start_offset, delimiter);
+    sql::SqlBatchExec sql_batch_exec;
+    sql_batch_exec.stop_on_error(true);
+    sql_batch_exec.error_cb(boost::bind(&SqlEditorForm::on_script_file_error, this, _1, _2, _3));
+    sql_batch_exec.script_file_progress_cb(boost::bind(&SqlEditorForm::on_script_file_progress, this, log_id, context,
+      _1, _2, _3));
+
+    long err_count = sql_batch_exec(stmt.get(), reader);
+    exec_timer.stop();
+
+    {
+      base::MutexLock lock(_script_file_mutex);
+      _script_file_status.resume_offset = sql_batch_exec.resume_offset();
+      _script_file_status.resume_delimiter = sql_batch_exec.resume_delimiter();
+    }
+
+    if (_usr_dbc_conn->is_stop_query_requested)
+    {
+      message = strfmt(_("Stopped by the user at offset %lli with delimiter %s, the script can be continued from there"),
+                       (long long)sql_batch_exec.resume_offset(), sql_batch_exec.resume_delimiter().c_str());
+      set_log_message(log_id, DbSqlEditorLog::WarningMsg, message, context, exec_timer.duration_formatted());
+    }
+    else if (err_count > 0)
+    {
+      message = strfmt(_("Stopped at the failed statement at offset %lli with delimiter %s, the script can be continued from there"),
+                       (long long)sql_batch_exec.resume_offset(), sql_batch_exec.resume_delimiter().c_str());
+      set_log_message(log_id, DbSqlEditorLog::ErrorMsg, message, context, exec_timer.duration_formatted());
+    }
+    else
+    {
+      message = strfmt(_("%s executed"), sizefmt(reader.file_size() - start_offset, false).c_str());
+      set_log_message(log_id, DbSqlEditorLog::OKMsg, message, context, exec_timer.duration_formatted());
+    }
+
+    _grtm->replace_status_text(_("Script finished"));
+  }
+  catch (sql::SQLException &e)
+  {
+    message = strfmt(SQL_EXCEPTION_MSG_FORMAT, e.getErrorCode(), e.what());
+    set_log_message(log_id, DbSqlEditorLog::ErrorMsg, message, context, "");
+
+    base::MutexLock lock(_script_file_mutex);
+    _script_file_status.error_code = e.getErrorCode();
+  }
+  catch (grt::db_login_error &e)
+  {
+    message = strfmt(EXCEPTION_MSG_FORMAT, e.what());
+    set_log_message(log_id, DbSqlEditorLog::ErrorMsg, message, context, "");
+
+    base::MutexLock lock(_script_file_mutex);
+    _script_file_status.login_error = true;
+  }
+  catch (std::exception &e)
+  {
+    message = strfmt(EXCEPTION_MSG_FORMAT, e.what());
+    set_log_message(log_id, DbSqlEditorLog::ErrorMsg, message, context, "");
+  }
+
+  {
+    base::MutexLock lock(_script_file_mutex);
+    _script_dbc_conn.reset();
+    _script_file_status.output.push_back(message);
+  }
+  close_connection(script_conn);
+
+  if (dbc_driver)
+    dbc_driver->threadEnd();
+
+  update_menu_and_toolbar();
+
+  _usr_dbc_conn->is_stop_query_requested = false;
+
+  {
+    base::MutexLock lock(_script_file_mutex);
+    _script_file_status.running = false;
+  }
+
+  return grt::StringRef("");
+}
+
+
+int SqlEditorForm::on_script_file_error(long long err_code, const std::string &err_msg, const std::string &statement)
+{
+  std::string message = strfmt(SQL_EXCEPTION_MSG_FORMAT, (int)err_code, err_msg.c_str());
+  add_log_message(DbSqlEditorLog::ErrorMsg, message, statement, "");
+
+  base::MutexLock lock(_script_file_mutex);
+  _script_file_status.error_code = (int)err_code;
+  _script_file_status.output.push_back(message + "\n" + statement);
+
+  return 0;
+}
+
+
+int SqlEditorForm::on_script_file_progress(RowId log_id, const std::string &context, boost::int64_t done,
+  boost::int64_t total, double rate)
+{
+  set_log_message(log_id, DbSqlEditorLog::BusyMsg,
+    strfmt(_("%s of %s executed (%s/s)"), sizefmt(done, false).c_str(), sizefmt(total, false).c_str(),
+           sizefmt((boost::int64_t)rate, false).c_str()), context, "");
+
+  {
+    base::MutexLock lock(_script_file_mutex);
+    _script_file_status.done = done;
+    _script_file_status.total = total;
+    _script_file_status.rate = rate;
+  }
+
+  // Returning non-zero stops the execution.
+  return _usr_dbc_conn->is_stop_query_requested ? 1 : 0;
+}
+
+
 void SqlEditorForm::exec_management_sql(const std::string &sql, bool log)
 {
   sql::Dbc_connection_handler::Ref conn;
@@ -317,6 +317,27 @@ private:
   sql::Dbc_connection_handler::Ref _usr_dbc_conn;
   mutable base::RecMutex _usr_dbc_conn_mutex;
 
+  // connection for running a script file, only open while it runs (see exec_sql_script_file)
+  sql::Dbc_connection_handler::Ref _script_dbc_conn;
+
+  struct ScriptFileStatus
+  {
+    ScriptFileStatus() : running(false), done(0), total(0), rate(0), resume_offset(0), resume_delimiter(";"),
+      error_code(0), login_error(false) {}
+
+    bool running;
+    boost::int64_t done;
+    boost::int64_t total;
+    double rate;
+    std::vector<std::string> output;
+    boost::int64_t resume_offset;
+    std::string resume_delimiter;
+    int error_code;
+    bool login_error;
+  };
+  ScriptFileStatus _script_file_status;
+  base::Mutex _script_file_mutex; // guards _script_dbc_conn and _script_file_status
+
   sql::Authentication::Ref _dbc_auth;
 
   ServerState _last_server_running_state;
@@ -338,6 +359,11 @@ public:
 
   RecordsetsRef exec_sql_returning_results(const std::string &sql_script, bool dont_add_limit_clause);
 
+  // Runs a script file in the background without loading it into memory (see sql::SqlScriptReader).
+  void exec_sql_script_file(const std::string &path, const std::string &default_schema, const std::string &default_charset,
+                            boost::int64_t start_offset = 0, const std::string &delimiter = ";");
+  grt::DictRef script_file_status();
+
   void exec_management_sql(const std::string &sql, bool log);
   db_query_ResultsetRef exec_management_query(const std::string &sql, bool log);
 
@@ -358,6 +384,11 @@ private:
 
   grt::StringRef do_exec_sql(grt::GRT *grt, Ptr self_ptr, boost::shared_ptr<std::string> sql,
     SqlEditorPanel *editor, ExecFlags flags, RecordsetsRef result_list);
+  grt::StringRef do_exec_sql_script_file(grt::GRT *grt, Ptr self_ptr, const std::string &path,
+    const std::string &default_schema, const std::string &default_charset, boost::int64_t start_offset,
+    const std::string &delimiter);
+  int on_script_file_error(long long err_code, const std::string &err_msg, const std::string &statement);
+  int on_script_file_progress(RowId log_id, const std::string &context, boost::int64_t done, boost::int64_t total, double rate);
 
   void handle_command_side_effects(const std::string &sql);
 public:
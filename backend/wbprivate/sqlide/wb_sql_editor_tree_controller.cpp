@@ -331,9 +331,13 @@ void SqlEditorTreeController::schema_row_selected()
 
 
     // send out notification about selection change
-    grt::DictRef info(_grtm->get_grt());
-    info.gset("selection-size", (int)nodes.size());
-    grt::GRTNotificationCenter::get()->send_grt("GRNLiveDBObjectSelectionDidChange", _owner->wbsql()->get_grt_editor_object(_owner), info);
+    grt::ObjectRef editor(_owner->wbsql()->get_grt_editor_object(_owner));
+    if (grt::GRTNotificationCenter::get()->has_grt_observers("GRNLiveDBObjectSelectionDidChange", editor))
+    {
+      grt::DictRef info(_grtm->get_grt());
+      info.gset("selection-size", (int)nodes.size());
+      grt::GRTNotificationCenter::get()->send_grt("GRNLiveDBObjectSelectionDidChange", editor, info);
+    }
   }
 }
 
@@ -65,7 +65,7 @@ bool OverviewBE::ObjectNode::rename(WBContext *wb, const std::string &name)
     grt::AutoUndo undo(wb->get_grt());
     dbobj->name(name);
     undo.end(strfmt(_("Rename %s"), dbobj.get_metaclass()->get_attribute("caption").c_str()));
-    bec::ValidationManager::validate_instance(object, CHECK_NAME);
+    bec::ValidationManager::validate_changes(object, CHECK_NAME);
   }
   else
     throw std::runtime_error("rename not implemented for this object");
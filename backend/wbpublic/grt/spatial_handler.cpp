@@ -20,11 +20,18 @@
 #include "spatial_handler.h"
 #include <algorithm>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
+#include <boost/bind.hpp>
 #include "base/log.h"
 
 DEFAULT_LOG_DOMAIN("spatial");
 
+// Layers with less features than this are processed in the calling thread.
+#define PARALLEL_FEATURE_THRESHOLD 512
+
+static gint last_projection_serial = 0;
+
 #ifdef _WIN32
 static void __stdcall ogr_error_handler(CPLErr eErrClass, int err_no, const char *msg)
 {
@@ -81,7 +88,7 @@ spatial::Envelope::Envelope(double left, double top, double right, double bottom
   bottom_right.y = 90;
 }
 
-bool spatial::Envelope::is_init()
+bool spatial::Envelope::is_init() const
 {
   return (top_left.x != 180 && top_left.y != -90 && bottom_right.x != -180 && bottom_right.y != 90);
 }
@@ -570,11 +577,20 @@ void spatial::Importer::interrupt()
 }
 
 spatial::Converter::Converter(ProjectionView view, OGRSpatialReference *src_srs, OGRSpatialReference *dst_srs)
-: _geo_to_proj(NULL), _proj_to_geo(NULL), _source_srs(NULL), _target_srs(NULL), _interrupt(false)
+: _geo_to_proj(NULL), _proj_to_geo(NULL), _source_srs(NULL), _target_srs(NULL), _interrupt(false),
+  _projection_serial(0)
 {
   change_projection(view, src_srs, dst_srs);
 }
 
+spatial::Converter *spatial::Converter::clone()
+{
+  base::RecMutexLock mtx(_projection_protector);
+  Converter *converter = new Converter(_view, _source_srs, _target_srs);
+  converter->_projection_serial = _projection_serial; // Same projection, so cached data stays valid.
+  return converter;
+}
+
 std::string spatial::Converter::dec_to_dms(double angle, AxisType axis, int precision)
 {
   const char *tmp = NULL;
@@ -597,6 +613,12 @@ std::string spatial::Converter::dec_to_dms(double angle, AxisType axis, int prec
 spatial::Converter::~Converter()
 {
   base::RecMutexLock mtx(_projection_protector);
+
+  // Each converter (including every clone used for a render chunk) owns its transformations.
+  if (_geo_to_proj != NULL)
+    OCTDestroyCoordinateTransformation(_geo_to_proj);
+  if (_proj_to_geo != NULL)
+    OCTDestroyCoordinateTransformation(_proj_to_geo);
 }
 
 void spatial::Converter::change_projection(OGRSpatialReference *src_srs, OGRSpatialReference *dst_srs)
@@ -641,6 +663,7 @@ void spatial::Converter::change_projection(ProjectionView view, OGRSpatialRefere
     _proj_to_geo = OGRCreateCoordinateTransformation(_target_srs, _source_srs);
     if (!_geo_to_proj || !_proj_to_geo)
       throw std::logic_error("Unable to create coordinate transformation context.");
+    _projection_serial = g_atomic_int_add(&last_projection_serial, 1) + 1;
   }
 
   double minLat = _view.MinLat, maxLon = _view.MaxLon, maxLat = _view.MaxLat, minLon = _view.MinLon;
@@ -714,7 +737,19 @@ bool spatial::Converter::from_proj_to_latlon(double &lat, double &lon)
 
 void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_container)
 {
+  project_points(shapes_container);
+  std::deque<ShapeContainer> screen;
+  projected_to_screen(shapes_container, screen, 0);
+  shapes_container.swap(screen);
+}
 
+/**
+ * Converts the given shapes from geographic coordinates to projection units. Points which cannot
+ * be converted are removed. The result does not depend on the view, so it can be cached as long
+ * as projection_serial() does not change.
+ */
+void spatial::Converter::project_points(std::deque<ShapeContainer> &shapes_container)
+{
   std::deque<ShapeContainer>::iterator it;
   for(it = shapes_container.begin(); it != shapes_container.end() && !_interrupt; it++)
   {
@@ -725,18 +760,9 @@ void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_con
         for_removal.push_back(i);
     }
 
-    if(_geo_to_proj->Transform(1, &(*it).bounding_box.bottom_right.x, &(*it).bounding_box.bottom_right.y) &&
-       _geo_to_proj->Transform(1, &(*it).bounding_box.top_left.x, &(*it).bounding_box.top_left.y))
-    {
-      int x, y;
-      from_projected((*it).bounding_box.bottom_right.x, (*it).bounding_box.bottom_right.y, x, y);
-      (*it).bounding_box.bottom_right.x = x;
-      (*it).bounding_box.bottom_right.y = y;
-      from_projected((*it).bounding_box.top_left.x, (*it).bounding_box.top_left.y, x, y);
-      (*it).bounding_box.top_left.x = x;
-      (*it).bounding_box.top_left.y = y;
-      (*it).bounding_box.converted = true;
-    }
+    if(!_geo_to_proj->Transform(1, &(*it).bounding_box.bottom_right.x, &(*it).bounding_box.bottom_right.y) ||
+       !_geo_to_proj->Transform(1, &(*it).bounding_box.top_left.x, &(*it).bounding_box.top_left.y))
+      (*it).bounding_box = Envelope();
 
     if (!for_removal.empty())
       log_debug("%i points that could not be converted were skipped\n", (int)for_removal.size());
@@ -744,13 +770,51 @@ void spatial::Converter::transform_points(std::deque<ShapeContainer> &shapes_con
     std::deque<size_t>::reverse_iterator rit;
     for (rit = for_removal.rbegin(); rit != for_removal.rend() && !_interrupt; rit++)
       (*it).points.erase((*it).points.begin() + *rit);
+  }
+}
+
+/**
+ * Maps shapes in projection units (as returned by project_points) to screen coordinates of the current view.
+ * Consecutive points closer than tolerance pixels to the last kept point are dropped, as they would
+ * not be visible anyway. The first and last point of each shape are always kept.
+ */
+void spatial::Converter::projected_to_screen(const std::deque<ShapeContainer> &projected,
+  std::deque<ShapeContainer> &screen, double tolerance)
+{
+  double inv[6];
+  {
+    base::RecMutexLock mtx(_projection_protector);
+    std::copy(_inv_projection, _inv_projection + 6, inv);
+  }
+
+  std::deque<ShapeContainer>::const_iterator it;
+  for (it = projected.begin(); it != projected.end() && !_interrupt; ++it)
+  {
+    screen.push_back(ShapeContainer());
+    ShapeContainer &target = screen.back();
+    target.type = it->type;
 
-    for(size_t i=0; i < (*it).points.size() && !_interrupt; i++)
+    if (it->bounding_box.is_init())
     {
-      int x, y;
-      from_projected((*it).points[i].x, (*it).points[i].y, x, y);
-      (*it).points[i].x = x;
-      (*it).points[i].y = y;
+      target.bounding_box.top_left.x = (int)(inv[0] + inv[1] * it->bounding_box.top_left.x);
+      target.bounding_box.top_left.y = (int)(inv[3] + inv[5] * it->bounding_box.top_left.y);
+      target.bounding_box.bottom_right.x = (int)(inv[0] + inv[1] * it->bounding_box.bottom_right.x);
+      target.bounding_box.bottom_right.y = (int)(inv[3] + inv[5] * it->bounding_box.bottom_right.y);
+      target.bounding_box.converted = true;
+    }
+
+    size_t count = it->points.size();
+    target.points.reserve(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+      base::Point p((int)(inv[0] + inv[1] * it->points[i].x), (int)(inv[3] + inv[5] * it->points[i].y));
+      if (tolerance > 0 && !target.points.empty() && i < count - 1)
+      {
+        const base::Point &last = target.points.back();
+        if (fabs(p.x - last.x) < tolerance && fabs(p.y - last.y) < tolerance)
+          continue;
+      }
+      target.points.push_back(p);
     }
   }
 }
@@ -793,7 +857,7 @@ void spatial::Converter::interrupt()
 using namespace spatial;
 
 Feature::Feature(Layer *layer, int row_id, const std::string &data, bool wkt = false)
-: _owner(layer), _row_id(row_id)
+: _owner(layer), _row_id(row_id), _proj_serial(0)
 {
   if (wkt)
     _geometry.import_from_wkt(data);
@@ -818,17 +882,26 @@ void Feature::get_envelope(spatial::Envelope &env, const bool &screen_coords)
 
 void Feature::render(Converter *converter)
 {
-  std::deque<ShapeContainer> tmp_shapes;
-  _geometry.get_points(tmp_shapes);
-  converter->transform_points(tmp_shapes);
+  // Reprojection is the expensive part, so it's only done when the projection changed.
+  // Panning and zooming only need the (cheap) mapping to screen coordinates.
+  if (_proj_serial == 0 || _proj_serial != converter->projection_serial())
+  {
+    std::deque<ShapeContainer> tmp_shapes;
+    _geometry.get_points(tmp_shapes);
+    converter->project_points(tmp_shapes);
+    _proj_shapes.swap(tmp_shapes);
+    _proj_serial = converter->projection_serial();
+  }
+
+  std::deque<ShapeContainer> screen_shapes;
+  converter->projected_to_screen(_proj_shapes, screen_shapes);
+
   spatial::Envelope env;
   _geometry.get_envelope(env);
   converter->transform_envelope(env);
   _env_screen = env;
 
-  _shapes = tmp_shapes;
-
-
+  _shapes.swap(screen_shapes);
 }
 
 
@@ -862,8 +935,52 @@ void Feature::interrupt()
   _geometry.interrupt();
 }
 
+/**
+ * Returns the bounding box of the feature in screen coordinates (as computed by the last render() call).
+ */
+bool Feature::screen_bounds(base::Rect &bounds) const
+{
+  if (!_env_screen.is_init())
+    return false;
+
+  double left = std::min(_env_screen.top_left.x, _env_screen.bottom_right.x);
+  double top = std::min(_env_screen.top_left.y, _env_screen.bottom_right.y);
+  bounds = base::Rect(left, top, fabs(_env_screen.bottom_right.x - _env_screen.top_left.x),
+    fabs(_env_screen.bottom_right.y - _env_screen.top_left.y));
+  return true;
+}
+
+/**
+ * Adds the given points to the current path, leaving out those which would end up on the same device pixel
+ * as the previous one at the given scale. The last point is always added.
+ */
+static void add_path_points(mdc::CairoCtx &cr, const std::vector<base::Point> &points, float scale)
+{
+  double tolerance = 1.0 / scale;
+  base::Point last = points[0];
+  cr.move_to(last);
+  for (size_t i = 1; i < points.size(); i++)
+  {
+    const base::Point &p = points[i];
+    if (i < points.size() - 1 && fabs(p.x - last.x) < tolerance && fabs(p.y - last.y) < tolerance)
+      continue;
+    cr.line_to(p);
+    last = p;
+  }
+}
+
 void Feature::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area, base::Color fill_color)
 {
+  // Level of detail: anything (except point markers) which is smaller than a device pixel is drawn as a dot.
+  base::Rect bounds;
+  if (!_shapes.empty() && _shapes.front().type != ShapePoint && screen_bounds(bounds)
+      && bounds.width() * scale < 1 && bounds.height() * scale < 1)
+  {
+    cr.rectangle(bounds.left(), bounds.top(), 1.0 / scale, 1.0 / scale);
+    cr.fill();
+    return;
+  }
+
   for (std::deque<ShapeContainer>::iterator it = _shapes.begin(); it != _shapes.end() && !_owner->_interrupt; it++)
   {
     if ((*it).points.empty())
@@ -876,9 +993,7 @@ void Feature::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_are
     {
       case ShapePolygon:
         cr.new_path();
-        cr.move_to((*it).points[0]);
-        for (size_t i = 1; i < (*it).points.size(); i++)
-          cr.line_to((*it).points[i]);
+        add_path_points(cr, (*it).points, scale);
         cr.close_path();
         if (fill_color.is_valid())
         {
@@ -891,9 +1006,7 @@ void Feature::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_are
         break;
 
       case ShapeLineString:
-        cr.move_to((*it).points[0]);
-        for (size_t i = 1; i < (*it).points.size(); i++)
-          cr.line_to((*it).points[i]);
+        add_path_points(cr, (*it).points, scale);
         cr.stroke();
         break;
 
@@ -926,7 +1039,8 @@ static void extend_env(spatial::Envelope &env, const spatial::Envelope &env2)
 
 
 Layer::Layer(int layer_id, base::Color color)
-: _layer_id(layer_id), _color(color), _show(false), _interrupt(false)
+: _layer_id(layer_id), _color(color), _render_progress(0), _show(false), _interrupt(false), _max_threads(-1),
+  _index_columns(0), _index_rows(0)
 {
   _spatial_envelope.top_left.x = 180;
   _spatial_envelope.top_left.y = -90;
@@ -941,6 +1055,37 @@ Layer::~Layer()
     delete *it;
 }
 
+/**
+ * Limits the number of threads used to parse and render features. Values <= 0 mean one thread per processor.
+ */
+void Layer::set_max_threads(int count)
+{
+  _max_threads = count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Splits the range [0, count) into chunks and runs the job for each of them in a worker thread.
+ * Small ranges are processed in the calling thread.
+ */
+static void run_chunked(size_t count, int max_threads, const boost::function<void (size_t, size_t)> &job)
+{
+  if (count < PARALLEL_FEATURE_THRESHOLD || max_threads == 1)
+  {
+    job(0, count);
+    return;
+  }
+
+  base::TaskGroup workers(max_threads);
+  size_t chunk_size = std::max(count / (workers.thread_count() * 2), (size_t)PARALLEL_FEATURE_THRESHOLD / 2);
+  for (size_t first = 0; first < count; first += chunk_size)
+    workers.run(boost::bind(job, first, std::min(first + chunk_size, count)));
+  workers.wait();
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void Layer::set_fill_polygons(bool fill)
 {
   _fill_polygons = fill;
@@ -982,6 +1127,47 @@ void Layer::add_feature(int row_id, const std::string &geom_data, bool wkt)
   feature->get_envelope(env);
   extend_env(_spatial_envelope, env);
   _features.push_back(feature);
+  _index_cells.clear(); // Not rendered yet, so the index is incomplete until the next render() call.
+}
+
+/**
+ * Parses a batch of geometries (row id + geometry data) in parallel and adds them as features.
+ * Features keep the order of the input data. Invalid geometries are skipped.
+ */
+void Layer::add_features(const std::vector<std::pair<int, std::string> > &data, bool wkt)
+{
+  // Make sure the projection singleton exists before worker threads start to use it.
+  Projection::get_instance();
+
+  std::vector<Feature*> features(data.size(), (Feature*)NULL);
+  try
+  {
+    run_chunked(data.size(), _max_threads, boost::bind(&Layer::parse_range, this, &data, &features, wkt, _1, _2));
+  }
+  catch (std::exception &exc)
+  {
+    log_error("Error while loading spatial features: %s\n", exc.what());
+  }
+
+  for (std::vector<Feature*>::iterator it = features.begin(); it != features.end(); ++it)
+  {
+    if (*it == NULL)
+      continue;
+    spatial::Envelope env;
+    (*it)->get_envelope(env);
+    extend_env(_spatial_envelope, env);
+    _features.push_back(*it);
+  }
+  _index_cells.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Layer::parse_range(const std::vector<std::pair<int, std::string> > *data, std::vector<Feature*> *features,
+  bool wkt, size_t first, size_t last)
+{
+  for (size_t i = first; i < last && !_interrupt; ++i)
+    (*features)[i] = new Feature(this, (*data)[i].first, (*data)[i].second, wkt);
 }
 
 void Layer::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area)
@@ -995,12 +1181,116 @@ void Layer::repaint(mdc::CairoCtx &cr, float scale, const base::Rect &clip_area)
   color.green *= 0.6;
   color.blue *= 0.6;
   cr.set_color(color);
-  for (std::deque<Feature*>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it)
-    (*it)->repaint(cr, scale, clip_area, _fill_polygons ? _color : base::Color::Invalid());
+  base::Color fill_color = _fill_polygons ? _color : base::Color::Invalid();
+  if (clip_area.empty() || _index_cells.empty())
+  {
+    for (std::deque<Feature*>::iterator it = _features.begin(); it != _features.end() && !_interrupt; ++it)
+      (*it)->repaint(cr, scale, clip_area, fill_color);
+  }
+  else
+  {
+    std::vector<size_t> visible;
+    features_in_area(clip_area, visible);
+    for (std::vector<size_t>::const_iterator it = visible.begin(); it != visible.end() && !_interrupt; ++it)
+      _features[*it]->repaint(cr, scale, clip_area, fill_color);
+  }
 
   cr.restore();
 }
 
+//--------------------------------------------------------------------------------------------------
+
+void Layer::build_index()
+{
+  _index_cells.clear();
+  _unindexed.clear();
+
+  std::vector<base::Rect> bounds(_features.size());
+  std::vector<bool> valid(_features.size(), false);
+  bool have_bounds = false;
+  double left = 0, top = 0, right = 0, bottom = 0;
+  for (size_t i = 0; i < _features.size(); ++i)
+  {
+    if (!_features[i]->screen_bounds(bounds[i]))
+    {
+      _unindexed.push_back(i);
+      continue;
+    }
+    valid[i] = true;
+
+    if (!have_bounds)
+    {
+      left = bounds[i].left();
+      top = bounds[i].top();
+      right = bounds[i].right();
+      bottom = bounds[i].bottom();
+      have_bounds = true;
+    }
+    else
+    {
+      left = std::min(left, bounds[i].left());
+      top = std::min(top, bounds[i].top());
+      right = std::max(right, bounds[i].right());
+      bottom = std::max(bottom, bounds[i].bottom());
+    }
+  }
+
+  if (!have_bounds)
+    return;
+
+  // Aim for a few features per cell but keep the grid size reasonable.
+  int size = (int)ceil(sqrt(_features.size() / 4.0));
+  _index_columns = _index_rows = std::max(1, std::min(size, 256));
+  _index_bounds = base::Rect(left, top, std::max(right - left, 1.0), std::max(bottom - top, 1.0));
+  _index_cells.resize(_index_columns * _index_rows);
+
+  double cell_width = _index_bounds.width() / _index_columns;
+  double cell_height = _index_bounds.height() / _index_rows;
+  for (size_t i = 0; i < _features.size(); ++i)
+  {
+    if (!valid[i])
+      continue; // Listed in _unindexed.
+
+    int first_column = std::min((int)((bounds[i].left() - left) / cell_width), _index_columns - 1);
+    int last_column = std::min((int)((bounds[i].right() - left) / cell_width), _index_columns - 1);
+    int first_row = std::min((int)((bounds[i].top() - top) / cell_height), _index_rows - 1);
+    int last_row = std::min((int)((bounds[i].bottom() - top) / cell_height), _index_rows - 1);
+    for (int row = first_row; row <= last_row; ++row)
+      for (int column = first_column; column <= last_column; ++column)
+        _index_cells[row * _index_columns + column].push_back(i);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the (sorted, so paint order is kept) indexes of all features whose screen envelope intersects
+ * the given area.
+ */
+void Layer::features_in_area(const base::Rect &area, std::vector<size_t> &result)
+{
+  result = _unindexed;
+
+  double cell_width = _index_bounds.width() / _index_columns;
+  double cell_height = _index_bounds.height() / _index_rows;
+  int first_column = std::max(0, (int)floor((area.left() - _index_bounds.left()) / cell_width));
+  int last_column = std::min(_index_columns - 1, (int)floor((area.right() - _index_bounds.left()) / cell_width));
+  int first_row = std::max(0, (int)floor((area.top() - _index_bounds.top()) / cell_height));
+  int last_row = std::min(_index_rows - 1, (int)floor((area.bottom() - _index_bounds.top()) / cell_height));
+
+  for (int row = first_row; row <= last_row; ++row)
+  {
+    for (int column = first_column; column <= last_column; ++column)
+    {
+      const std::vector<size_t> &cell = _index_cells[row * _index_columns + column];
+      result.insert(result.end(), cell.begin(), cell.end());
+    }
+  }
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
 
 float Layer::query_render_progress()
 {
@@ -1016,13 +1306,52 @@ spatial::Envelope spatial::Layer::get_envelope()
 void Layer::render(Converter *converter)
 {
   _render_progress = 0.0;
+  if (_features.empty())
+    return;
+
   float step = 1.0f / _features.size();
+  try
+  {
+    if (_features.size() < PARALLEL_FEATURE_THRESHOLD || _max_threads == 1)
+    {
+      for (std::deque<spatial::Feature*>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt; ++iter)
+      {
+        (*iter)->render(converter);
+        _render_progress += step;
+      }
+    }
+    else
+      run_chunked(_features.size(), _max_threads, boost::bind(&Layer::render_range, this, converter, step, _1, _2));
+  }
+  catch (std::exception &exc)
+  {
+    log_error("Error while rendering spatial layer %i: %s\n", _layer_id, exc.what());
+  }
 
-  for (std::deque<spatial::Feature*>::iterator iter = _features.begin(); iter != _features.end() && !_interrupt; ++iter)
+  build_index();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void Layer::render_range(Converter *converter, float step, size_t first, size_t last)
+{
+  // Each worker needs its own coordinate transformation.
+  std::auto_ptr<Converter> local_converter(converter->clone());
+
+  size_t done = 0;
+  for (size_t i = first; i < last && !_interrupt; ++i)
   {
-    (*iter)->render(converter);
-    _render_progress += step;
+    _features[i]->render(local_converter.get());
+    if (++done == 256)
+    {
+      base::MutexLock lock(_progress_lock);
+      _render_progress += step * done;
+      done = 0;
+    }
   }
+
+  base::MutexLock lock(_progress_lock);
+  _render_progress += step * done;
 }
 
 spatial::Feature* Layer::feature_closest(const base::Point &p, const double &allowed_distance)
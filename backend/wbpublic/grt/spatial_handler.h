@@ -27,7 +27,9 @@
 #include <gdal/gdal_alg.h>
 #include <gdal/gdal.h>
 #include <deque>
+#include <vector>
 #include "base/geometry.h"
+#include "base/threading.h"
 #include "wbpublic_public_interface.h"
 
 #include "mdc.h"
@@ -68,7 +70,7 @@ namespace spatial
     base::Point bottom_right;
     friend bool operator == (const Envelope &env1, const Envelope &env2);
     friend bool operator != (const Envelope &env1, const Envelope &env2);
-    bool is_init();
+    bool is_init() const;
     bool within(const base::Point &p) const;
   };
 
@@ -165,6 +167,7 @@ namespace spatial
     OGRSpatialReference *_target_srs;
     ProjectionView _view;
     bool _interrupt;
+    int _projection_serial;
   public:
     Converter(ProjectionView view, OGRSpatialReference *src_srs, OGRSpatialReference *dst_srs);
     ~Converter();
@@ -180,8 +183,17 @@ namespace spatial
     bool from_proj_to_latlon(double &lat, double &lon);
     static std::string dec_to_dms(double angle, AxisType axis, int precision);
     void transform_points(std::deque<ShapeContainer> &shapes_container);
+    void project_points(std::deque<ShapeContainer> &shapes_container);
+    void projected_to_screen(const std::deque<ShapeContainer> &projected, std::deque<ShapeContainer> &screen,
+      double tolerance = 1.0);
     void transform_envelope(spatial::Envelope &env);
     void interrupt();
+
+    // Coordinate transformations are not thread safe, so each worker thread needs its own converter.
+    Converter *clone();
+
+    // Changes whenever source or target projection change. Used to validate cached projected coordinates.
+    int projection_serial() const { return _projection_serial; }
   };
 
 
@@ -192,7 +204,9 @@ namespace spatial
     Layer *_owner;
     int _row_id;
     Importer _geometry;
-    std::deque<ShapeContainer> _shapes;
+    std::deque<ShapeContainer> _proj_shapes; // Cached coordinates in projection units (see _proj_serial).
+    int _proj_serial;
+    std::deque<ShapeContainer> _shapes; // Screen coordinates, simplified to what is visible at pixel level.
     spatial::Envelope _env_screen;
   public:
     Feature(Layer *layer, int row_id, const std::string &data, bool wkt);
@@ -205,6 +219,7 @@ namespace spatial
 
     int row_id() const { return _row_id; }
     double distance(const base::Point &p, const double &allowed_distance = 4.0);
+    bool screen_bounds(base::Rect &bounds) const;
   };
 
   typedef int LayerId;
@@ -224,6 +239,22 @@ namespace spatial
     bool _interrupt;
     spatial::Envelope _spatial_envelope;
     bool _fill_polygons;
+    int _max_threads;
+    base::Mutex _progress_lock;
+
+    // Uniform grid over the screen envelopes of the features, rebuilt by render(). Each cell lists the
+    // indexes of the features overlapping it. Features without valid screen coordinates are always drawn.
+    std::vector<std::vector<size_t> > _index_cells;
+    std::vector<size_t> _unindexed;
+    base::Rect _index_bounds;
+    int _index_columns;
+    int _index_rows;
+
+    void parse_range(const std::vector<std::pair<int, std::string> > *data, std::vector<Feature*> *features,
+      bool wkt, size_t first, size_t last);
+    void render_range(spatial::Converter *converter, float step, size_t first, size_t last);
+    void build_index();
+    void features_in_area(const base::Rect &area, std::vector<size_t> &result);
 
   public:
     Layer(LayerId layer_id, base::Color color);
@@ -244,6 +275,8 @@ namespace spatial
     bool fill() { return _fill_polygons; }
 
     void add_feature(int row_id, const std::string &geom_data, bool wkt);
+    void add_features(const std::vector<std::pair<int, std::string> > &data, bool wkt);
+    void set_max_threads(int count);
     virtual void render(spatial::Converter *converter);
     spatial::Feature *feature_closest(const base::Point &p, const double &allowed_distance = 4.0);
     void set_fill_polygons(bool fill);
@@ -622,3 +622,21 @@ void TreeModel::dump(int show_field)
 }
 
 //--------------------------------------------------------------------------------------------------
+
+size_t GridModel::get_field_reprs(RowId row, size_t row_count, std::vector<std::string> &values)
+{
+  size_t total_rows = count();
+  size_t column_count = get_column_count();
+
+  row_count = (row < total_rows) ? std::min(row_count, total_rows - row) : 0;
+  values.resize(row_count * column_count);
+  for (size_t i = 0; i < row_count; ++i)
+  {
+    NodeId node(row + i);
+    for (size_t column = 0; column < column_count; ++column)
+      get_field_repr(node, column, values[i * column_count + column]);
+  }
+  return row_count;
+}
+
+//--------------------------------------------------------------------------------------------------
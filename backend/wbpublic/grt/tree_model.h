@@ -427,6 +427,10 @@ namespace bec
     virtual bool set_field_null(const bec::NodeId &node, ColumnId column) { return set_convert_field(node, column, ""); } //!
     virtual void set_edited_field(RowId row_index, ColumnId col_index) { }
 
+    // Fetches the display representation of all fields in the given rows at once, row by row.
+    // Returns the number of rows actually fetched, which is less than row_count at the end of the data.
+    virtual size_t get_field_reprs(RowId row, size_t row_count, std::vector<std::string> &values);
+
   public:
     typedef std::list<std::pair<ColumnId, int> > SortColumns;
     virtual void sort_by(ColumnId column, int direction, bool retaining) {}
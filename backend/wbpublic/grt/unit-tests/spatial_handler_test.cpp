@@ -0,0 +1,159 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <memory>
+
+#include "test.h"
+#include "grt/spatial_handler.h"
+#include "base/string_utilities.h"
+
+// Number of polygons used for the tests. Large enough to be split over several worker threads.
+// Timings for serial and parallel import and rendering are in the spatial_benchmark tool.
+#define FEATURE_COUNT 50000
+
+// Gives access to the features of a layer.
+class TestLayer : public spatial::Layer
+{
+public:
+  TestLayer(int threads)
+  : spatial::Layer(spatial::new_layer_id(), base::Color(0, 0, 0))
+  {
+    set_max_threads(threads);
+  }
+
+  spatial::Feature *feature(size_t index)
+  {
+    return _features[index];
+  }
+};
+
+static void generate_polygons(std::vector<std::pair<int, std::string> > &data, int count)
+{
+  data.reserve(count);
+  for (int i = 0; i < count; ++i)
+  {
+    double x = -170 + (i % 340);
+    double y = -80 + (i / 340) % 160;
+    std::string wkt = base::strfmt("POLYGON((%f %f,%f %f,%f %f,%f %f,%f %f,%f %f))",
+      x, y, x + 0.5, y, x + 0.5, y + 0.25, x + 0.5, y + 0.5, x, y + 0.5, x, y);
+    data.push_back(std::make_pair(i, wkt));
+  }
+}
+
+static spatial::Converter *create_converter(spatial::ProjectionType type)
+{
+  spatial::ProjectionView view;
+  view.width = 1000;
+  view.height = 500;
+  view.MaxLat = 179;
+  view.MinLat = -179;
+  view.MaxLon = 89;
+  view.MinLon = -89;
+
+  return new spatial::Converter(view, spatial::Projection::get_instance().get_projection(spatial::ProjGeodetic),
+    spatial::Projection::get_instance().get_projection(type));
+}
+
+BEGIN_TEST_DATA_CLASS(spatial_handler_test)
+public:
+  std::vector<std::pair<int, std::string> > data;
+END_TEST_DATA_CLASS
+
+TEST_MODULE(spatial_handler_test, "Spatial feature import and reprojection");
+
+TEST_FUNCTION(1)
+{
+  generate_polygons(data, FEATURE_COUNT);
+  ensure_equals("Generated polygons", data.size(), (size_t)FEATURE_COUNT);
+}
+
+static void ensure_same_features(const std::string &message, TestLayer &actual, TestLayer &expected)
+{
+  tut::ensure_equals(message + ": feature count", actual.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i)
+  {
+    std::string feature = message + ": feature " + base::to_string(i);
+    tut::ensure_equals(feature + " row id", actual.feature(i)->row_id(), expected.feature(i)->row_id());
+
+    spatial::Envelope env1, env2;
+    actual.feature(i)->get_envelope(env1);
+    expected.feature(i)->get_envelope(env2);
+    tut::ensure(feature + " envelope", env1 == env2);
+
+    actual.feature(i)->get_envelope(env1, true);
+    expected.feature(i)->get_envelope(env2, true);
+    tut::ensure(feature + " screen envelope", env1 == env2);
+  }
+}
+
+// Parallel import and rendering must give the same result as the serial one.
+TEST_FUNCTION(5)
+{
+  TestLayer serial(1);
+  TestLayer parallel(-1);
+  std::auto_ptr<spatial::Converter> converter(create_converter(spatial::ProjRobinson));
+
+  serial.add_features(data, true);
+  parallel.add_features(data, true);
+
+  ensure_equals("Feature count", serial.size(), data.size());
+  ensure("Layer envelope", serial.get_envelope() == parallel.get_envelope());
+  for (size_t i = 0; i < serial.size(); ++i)
+    ensure_equals("Row id of feature " + base::to_string(i), serial.feature(i)->row_id(), data[i].first);
+
+  serial.render(converter.get());
+  parallel.render(converter.get());
+  ensure_same_features("Rendered", parallel, serial);
+
+  // Rendering again with the same projection (e.g. after panning) only maps to screen coordinates,
+  // using the cached projected coordinates. The result must not change.
+  parallel.render(converter.get());
+  ensure_same_features("Rendered again", parallel, serial);
+}
+
+// A projection change must invalidate cached coordinates.
+TEST_FUNCTION(10)
+{
+  TestLayer layer(-1);
+  layer.add_features(data, true);
+
+  std::auto_ptr<spatial::Converter> converter(create_converter(spatial::ProjRobinson));
+  layer.render(converter.get());
+
+  spatial::Envelope robinson;
+  layer.feature(0)->get_envelope(robinson, true);
+
+  converter->change_projection(NULL, spatial::Projection::get_instance().get_projection(spatial::ProjMercator));
+  layer.render(converter.get());
+
+  spatial::Envelope mercator;
+  layer.feature(0)->get_envelope(mercator, true);
+
+  std::auto_ptr<spatial::Converter> fresh(create_converter(spatial::ProjMercator));
+  TestLayer reference(1);
+  reference.add_features(data, true);
+  reference.render(fresh.get());
+
+  spatial::Envelope expected;
+  reference.feature(0)->get_envelope(expected, true);
+  ensure("Reprojected envelope", mercator == expected);
+  ensure("Projection changed", mercator != robinson);
+}
+
+END_TESTS
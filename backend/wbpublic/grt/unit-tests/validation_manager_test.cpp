@@ -0,0 +1,201 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "grt/validation_manager.h"
+#include "wb_helpers.h"
+
+using namespace bec;
+
+// Records the tables it validates and complains about tables without a comment.
+class TestTableValidator : public grt::Validator
+{
+public:
+  base::Mutex lock;
+  std::multiset<std::string> validated;
+
+  virtual int validate(const Tag &what, const grt::ObjectRef &obj)
+  {
+    db_TableRef table(db_TableRef::cast_from(obj));
+    {
+      base::MutexLock guard(lock);
+      validated.insert(*table->name());
+    }
+
+    if ((*table->comment()).empty())
+    {
+      ValidationManager::message(what, obj, "Table " + *table->name() + " has no comment", grt::WarningMsg);
+      return 1;
+    }
+    return 0;
+  }
+};
+
+BEGIN_TEST_DATA_CLASS(validation_manager_test)
+protected:
+  WBTester _tester;
+  TestTableValidator _validator;
+
+  TEST_DATA_CONSTRUCTOR(validation_manager_test)
+  {
+    populate_grt(_tester.grt, _tester);
+    ValidationManager::register_validator(_tester.grt, "db.Table", &_validator);
+  }
+
+  db_CatalogRef create_catalog(int schema_count, int table_count)
+  {
+    db_CatalogRef catalog(_tester.grt);
+    for (int i = 0; i < schema_count; i++)
+    {
+      db_SchemaRef schema(_tester.grt);
+      schema->owner(catalog);
+      schema->name(base::strfmt("schema%i", i));
+      catalog->schemata().insert(schema);
+
+      for (int j = 0; j < table_count; j++)
+      {
+        db_TableRef table(_tester.grt);
+        table->owner(schema);
+        table->name(base::strfmt("table%i_%i", i, j));
+        table->comment("some comment");
+        schema->tables().insert(table);
+      }
+    }
+    return catalog;
+  }
+
+END_TEST_DATA_CLASS
+
+TEST_MODULE(validation_manager_test, "incremental validation");
+
+// Only objects changed since the last pass are validated again.
+TEST_FUNCTION(5)
+{
+  db_CatalogRef catalog = create_catalog(4, 10);
+  IncrementalValidator validator(catalog);
+
+  ensure("Everything dirty initially", validator.dirty_count() > 40);
+  ensure("First pass", validator.validate(CHECK_NAME, 4));
+  ensure_equals("Tables validated in first pass", _validator.validated.size(), (size_t)40);
+  ensure_equals("Nothing dirty after a pass", validator.dirty_count(), (size_t)0);
+
+  _validator.validated.clear();
+  ensure("Pass without changes", validator.validate(CHECK_NAME, 4));
+  ensure_equals("Tables validated without changes", _validator.validated.size(), (size_t)0);
+
+  db_TableRef table = catalog->schemata()[2]->tables()[3];
+  table->comment("");
+  ensure("Pass with a failing table", !validator.validate(CHECK_NAME, 4));
+  ensure_equals("Tables validated after a change", _validator.validated.size(), (size_t)1);
+  ensure_equals("Changed table validated", _validator.validated.count("table2_3"), (size_t)1);
+
+  // A change in a column dirties the table.
+  _validator.validated.clear();
+  db_ColumnRef column(_tester.grt);
+  column->owner(table);
+  column->name("id");
+  table->columns().insert(column);
+  validator.validate(CHECK_NAME, 4);
+  ensure_equals("Table validated after adding a column", _validator.validated.count("table2_3"), (size_t)1);
+
+  _validator.validated.clear();
+  column->name("other");
+  validator.validate(CHECK_NAME, 4);
+  ensure_equals("Table validated after renaming a column", _validator.validated.count("table2_3"), (size_t)1);
+
+  // New tables are tracked too.
+  _validator.validated.clear();
+  db_TableRef new_table(_tester.grt);
+  new_table->owner(catalog->schemata()[0]);
+  new_table->name("new_table");
+  catalog->schemata()[0]->tables().insert(new_table);
+  validator.validate(CHECK_NAME, 4);
+  ensure_equals("New table validated", _validator.validated.count("new_table"), (size_t)1);
+}
+
+// Messages are replaced per object and removed together with their object.
+TEST_FUNCTION(10)
+{
+  ValidationMessagesBE messages;
+  db_CatalogRef catalog = create_catalog(2, 5);
+  catalog->schemata()[0]->tables()[1]->comment("");
+  catalog->schemata()[1]->tables()[2]->comment("");
+
+  IncrementalValidator validator(catalog);
+  validator.validate(CHECK_NAME, 2);
+  ensure_equals("Messages after first pass", messages.count(), (size_t)2);
+
+  // Validating a table again replaces its message instead of adding another one.
+  catalog->schemata()[0]->tables()[1]->name("renamed");
+  validator.validate(CHECK_NAME, 2);
+  ensure_equals("Messages after renaming", messages.count(), (size_t)2);
+
+  std::string text;
+  bool found = false;
+  for (size_t i = 0; i < messages.count(); i++)
+  {
+    messages.get_field(NodeId(i), ValidationMessagesBE::Description, text);
+    if (text == "Table renamed has no comment")
+      found = true;
+  }
+  ensure("Message of renamed table", found);
+
+  catalog->schemata()[0]->tables()[1]->comment("fixed");
+  validator.validate(CHECK_NAME, 2);
+  ensure_equals("Messages after fixing a table", messages.count(), (size_t)1);
+
+  catalog->schemata()[1]->tables().remove(2);
+  ensure_equals("Messages after removing a table", messages.count(), (size_t)0);
+
+  ValidationManager::clear();
+}
+
+// Editors validate the objects of the model catalog together with everything else changed since.
+TEST_FUNCTION(15)
+{
+  db_CatalogRef catalog = create_catalog(2, 5);
+  ValidationManager::track_catalog(catalog);
+
+  db_TableRef table = catalog->schemata()[0]->tables()[1];
+  db_TableRef other_table = catalog->schemata()[1]->tables()[3];
+  other_table->name("renamed");
+
+  _validator.validated.clear();
+  ensure("Tracked table", ValidationManager::validate_changes(table, CHECK_NAME));
+  ensure_equals("Tables validated", _validator.validated.size(), (size_t)2);
+  ensure_equals("Given table validated", _validator.validated.count("table0_1"), (size_t)1);
+  ensure_equals("Changed table validated", _validator.validated.count("renamed"), (size_t)1);
+
+  _validator.validated.clear();
+  ValidationManager::validate_changes(table, CHECK_NAME);
+  ensure_equals("Tables validated without other changes", _validator.validated.size(), (size_t)1);
+
+  // Objects outside the tracked catalog are validated directly.
+  db_CatalogRef other_catalog = create_catalog(1, 1);
+  _validator.validated.clear();
+  ValidationManager::validate_changes(other_catalog->schemata()[0]->tables()[0], CHECK_NAME);
+  ensure_equals("Untracked table validated", _validator.validated.count("table0_0"), (size_t)1);
+
+  ValidationManager::clear();
+  _validator.validated.clear();
+  other_table->name("renamed_again");
+  ValidationManager::validate_changes(table, CHECK_NAME);
+  ensure_equals("No tracking after clear", _validator.validated.size(), (size_t)1);
+}
+
+END_TESTS
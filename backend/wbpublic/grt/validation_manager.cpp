@@ -29,12 +29,14 @@ DEFAULT_LOG_DOMAIN("validation")
 //--------------------------------------------------------------------------------------------------
 
 bec::ValidationMessagesBE::ValidationMessagesBE()
+  : _rows_valid(true)
 {
   _error_icon   = IconManager::get_instance()->get_icon_id("mini_error.png");
   _warning_icon = IconManager::get_instance()->get_icon_id("mini_warning.png");
   _info_icon    = IconManager::get_instance()->get_icon_id("mini_notice.png");
 
   scoped_connect(bec::ValidationManager::signal_notify(),boost::bind(&bec::ValidationMessagesBE::validation_message, this, _1, _2, _3, _4));
+  scoped_connect(bec::ValidationManager::signal_batch_done(),boost::bind(&bec::ValidationMessagesBE::batch_done, this));
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -43,6 +45,27 @@ void bec::ValidationMessagesBE::clear()
 {
   _errors.clear();
   _warnings.clear();
+  _messages_by_object.clear();
+  _rows.clear();
+  _rows_valid = true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+const bec::ValidationMessagesBE::Message* bec::ValidationMessagesBE::message_at(size_t row)
+{
+  if (!_rows_valid)
+  {
+    _rows.clear();
+    _rows.reserve(_errors.size() + _warnings.size());
+    for (MessageList::const_iterator it = _errors.begin(); it != _errors.end(); ++it)
+      _rows.push_back(&*it);
+    for (MessageList::const_iterator it = _warnings.begin(); it != _warnings.end(); ++it)
+      _rows.push_back(&*it);
+    _rows_valid = true;
+  }
+
+  return row < _rows.size() ? _rows[row] : NULL;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -52,14 +75,12 @@ bool bec::ValidationMessagesBE::get_field(const bec::NodeId &node, ColumnId colu
   bool ret = false;
   if (column == bec::ValidationMessagesBE::Description)
   {
-    const MessageList::size_type idx = node.end();
-  
-    if (idx < _errors.size())
-      value = _errors[idx].msg;
-    else
-      value = _warnings[idx].msg;
-
-    ret = true;
+    const Message* message = message_at(node.end());
+    if (message)
+    {
+      value = message->msg;
+      ret = true;
+    }
   }
   
   return ret;
@@ -73,7 +94,7 @@ bec::IconId bec::ValidationMessagesBE::get_field_icon(const bec::NodeId &node, C
   
   if (column == bec::ValidationMessagesBE::Description)
   {
-    const MessageList::size_type idx = node.end();
+    const size_t idx = node.end();
 
     if (idx < _errors.size())
       icon_id = _error_icon;
@@ -105,29 +126,39 @@ void bec::ValidationMessagesBE::activate_node_popup_item(const bec::NodeId &node
 
 //--------------------------------------------------------------------------------------------------
 
-bool bec::ValidationMessagesBE::match_message(const bec::ValidationMessagesBE::Message& m, const grt::ObjectRef& obj, const grt::Validator::Tag& tag)
+void bec::ValidationMessagesBE::add_message(bec::ValidationMessagesBE::MessageList* ml, const bec::ValidationMessagesBE::Message& message)
 {
-  return (obj == m.obj && tag == m.tag);
-};
+  MessageList::iterator it = ml->insert(ml->end(), message);
+  _messages_by_object[message.obj.is_valid() ? message.obj.id() : ""].push_back(std::make_pair(ml, it));
+  _rows_valid = false;
+}
 
 //--------------------------------------------------------------------------------------------------
 
-void bec::ValidationMessagesBE::remove_messages(bec::ValidationMessagesBE::MessageList* ml, const grt::ObjectRef& obj, const grt::Validator::Tag& tag)
+/**
+ * Removes the messages with the given tag from the object, or all its messages if the tag is "*".
+ */
+void bec::ValidationMessagesBE::remove_messages(const grt::ObjectRef& obj, const grt::Validator::Tag& tag)
 {
-  bec::ValidationMessagesBE::MessageList::iterator it = ml->end();
-  bool was_remove = true;
+  boost::unordered_map<std::string, MessageRefs>::iterator entry = _messages_by_object.find(obj.is_valid() ? obj.id() : "");
+  if (entry == _messages_by_object.end())
+    return;
 
-  while (was_remove)
+  MessageRefs& refs = entry->second;
+  for (MessageRefs::iterator ref = refs.begin(); ref != refs.end();)
   {
-    it = std::remove_if(ml->begin(), ml->end(),  boost::bind(&bec::ValidationMessagesBE::match_message, _1, obj, tag));
-    if (it != ml->end())
+    if (tag == "*" || ref->second->tag == tag)
     {
-      was_remove = true;
-      ml->erase(it);
+      ref->first->erase(ref->second);
+      ref = refs.erase(ref);
+      _rows_valid = false;
     }
     else
-      was_remove = false;
+      ++ref;
   }
+
+  if (refs.empty())
+    _messages_by_object.erase(entry);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -138,11 +169,10 @@ void bec::ValidationMessagesBE::validation_message(const grt::Validator::Tag& ta
   {
     case grt::NoErrorMsg:
     {
-      if ("*" != tag)
+      if ("*" != tag || obj.is_valid())
       {
         // Clear all types with obj and tag. Argument @msg in this case holds tag value
-        remove_messages(&_errors, obj, tag);
-        remove_messages(&_warnings, obj, tag);
+        remove_messages(obj, tag);
       }
       else
         clear();
@@ -150,12 +180,12 @@ void bec::ValidationMessagesBE::validation_message(const grt::Validator::Tag& ta
     }
     case grt::ErrorMsg:
     {
-      _errors.push_back(Message(msg, obj, tag));
+      add_message(&_errors, Message(msg, obj, tag));
       break;
     }
     case grt::WarningMsg:
     {
-      _warnings.push_back(Message(msg, obj, tag));
+      add_message(&_warnings, Message(msg, obj, tag));
       break;
     }
     default:
@@ -164,10 +194,24 @@ void bec::ValidationMessagesBE::validation_message(const grt::Validator::Tag& ta
     }
   }
 
+  // Refreshing for every single message of a batch would make it quadratic
+  if (!bec::ValidationManager::in_batch())
+    tree_changed();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationMessagesBE::batch_done()
+{
   tree_changed();
 }
 
 bec::ValidationManager::MessageSignal* bec::ValidationManager::_signal_notify = 0;
+bec::ValidationManager::BatchSignal* bec::ValidationManager::_signal_batch_done = 0;
+base::Mutex bec::ValidationManager::_batch_lock;
+std::vector<bec::ValidationManager::BatchMessage>* bec::ValidationManager::_batch_messages = 0;
+bool bec::ValidationManager::_delivering_batch = false;
+bec::IncrementalValidator* bec::ValidationManager::_catalog_validator = 0;
 
 //--------------------------------------------------------------------------------------------------
 
@@ -220,9 +264,10 @@ bool bec::ValidationManager::validate_instance(const grt::ObjectRef& obj, const
   bool ret = true;
 
   // Clear messages with corresponding tag from the object.
-  (*signal_notify())(tag, obj, tag, grt::NoErrorMsg);
+  message(tag, obj, tag, grt::NoErrorMsg);
 
-  static const grt::MetaClass *mc_to_break_checks = obj->get_grt()->get_metaclass("db.DatabaseObject");
+  // Not cached in a static, this can run on several threads at the same time.
+  const grt::MetaClass *mc_to_break_checks = obj->get_grt()->get_metaclass("db.DatabaseObject");
   grt::MetaClass* mc = obj->get_metaclass();
   
   while (mc && mc != mc_to_break_checks)
@@ -236,8 +281,49 @@ bool bec::ValidationManager::validate_instance(const grt::ObjectRef& obj, const
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Starts tracking changes in the given catalog, replacing the previously tracked one.
+ * Objects are not validated before they change.
+ */
+void bec::ValidationManager::track_catalog(const db_CatalogRef& catalog)
+{
+  delete _catalog_validator;
+  _catalog_validator = 0;
+
+  if (catalog.is_valid())
+    _catalog_validator = new IncrementalValidator(catalog, false);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Validates the given object after a change. If it is part of the tracked catalog, all objects
+ * changed since the previous pass are validated along with it, otherwise only the object itself.
+ *
+ * @return false if any validator failed.
+ */
+bool bec::ValidationManager::validate_changes(const grt::ObjectRef& obj, const grt::Validator::Tag& tag)
+{
+  if (!_catalog_validator || !_catalog_validator->is_tracked(obj))
+    return validate_instance(obj, tag);
+
+  _catalog_validator->mark_dirty(GrtObjectRef::cast_from(obj));
+  return _catalog_validator->validate(tag);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void bec::ValidationManager::message(const grt::Validator::Tag& tag, const grt::ObjectRef& o, const std::string& m, const int level)
 {
+  {
+    base::MutexLock lock(_batch_lock);
+    if (_batch_messages)
+    {
+      _batch_messages->push_back(BatchMessage(tag, o, m, level));
+      return;
+    }
+  }
+
   // Add message to the Object
   (*signal_notify())(tag, o, m, level);
 }
@@ -246,8 +332,306 @@ void bec::ValidationManager::message(const grt::Validator::Tag& tag, const grt::
 
 void bec::ValidationManager::clear()
 {
+  // Called when the model is closed or another one is loaded.
+  track_catalog(db_CatalogRef());
+
   // Clear messages from listeners
   (*signal_notify())("*", grt::ObjectRef(), "", grt::NoErrorMsg);
 }
 
 //--------------------------------------------------------------------------------------------------
+
+bec::ValidationManager::BatchSignal* bec::ValidationManager::signal_batch_done()
+{
+  if (!_signal_batch_done)
+    _signal_batch_done = new ValidationManager::BatchSignal;
+
+  return _signal_batch_done;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::ValidationManager::in_batch()
+{
+  return _delivering_batch;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationManager::begin_batch()
+{
+  // Make sure the signals exist before any worker thread could ask for them.
+  signal_notify();
+  signal_batch_done();
+
+  base::MutexLock lock(_batch_lock);
+  if (_batch_messages)
+    throw std::logic_error("A validation batch is already running");
+  _batch_messages = new std::vector<BatchMessage>();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::ValidationManager::end_batch()
+{
+  std::vector<BatchMessage> messages;
+  {
+    base::MutexLock lock(_batch_lock);
+    if (!_batch_messages)
+      return;
+    messages.swap(*_batch_messages);
+    delete _batch_messages;
+    _batch_messages = 0;
+  }
+
+  _delivering_batch = true;
+  try
+  {
+    for (std::vector<BatchMessage>::const_iterator it = messages.begin(); it != messages.end(); ++it)
+      (*signal_notify())(it->tag, it->object, it->msg, it->level);
+  }
+  catch (...)
+  {
+    _delivering_batch = false;
+    throw;
+  }
+  _delivering_batch = false;
+
+  (*signal_batch_done())();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bec::IncrementalValidator::IncrementalValidator(const db_CatalogRef& catalog, bool initially_dirty)
+  : _catalog(catalog)
+{
+  track(catalog, initially_dirty);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bec::IncrementalValidator::~IncrementalValidator()
+{
+  for (std::map<std::string, std::vector<boost::signals2::connection> >::iterator it = _connections.begin();
+       it != _connections.end(); ++it)
+  {
+    for (std::vector<boost::signals2::connection>::iterator conn = it->second.begin(); conn != it->second.end(); ++conn)
+      conn->disconnect();
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Schedules the object for the next validation pass, together with the table it is part of (if any).
+ */
+void bec::IncrementalValidator::mark_dirty(const GrtObjectRef& object)
+{
+  std::string schema = schema_id(object);
+  GrtObjectRef owner = object->owner();
+
+  base::MutexLock lock(_dirty_lock);
+  _dirty[schema][object.id()] = object;
+  if (owner.is_valid() && db_TableRef::can_wrap(owner))
+    _dirty[schema][owner.id()] = owner;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t bec::IncrementalValidator::dirty_count()
+{
+  base::MutexLock lock(_dirty_lock);
+  size_t count = 0;
+  for (std::map<std::string, ObjectMap>::const_iterator it = _dirty.begin(); it != _dirty.end(); ++it)
+    count += it->second.size();
+  return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::IncrementalValidator::is_tracked(const grt::ObjectRef& object) const
+{
+  return object.is_valid() && _connections.find(object.id()) != _connections.end();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Validates all objects changed since the previous call, using up to max_threads worker threads.
+ *
+ * @return false if any validator failed.
+ */
+bool bec::IncrementalValidator::validate(const grt::Validator::Tag& tag, int max_threads)
+{
+  std::map<std::string, ObjectMap> dirty;
+  {
+    base::MutexLock lock(_dirty_lock);
+    dirty.swap(_dirty);
+  }
+  if (dirty.empty())
+    return true;
+
+  std::vector<Job> jobs(dirty.size());
+  std::vector<Job>::iterator job = jobs.begin();
+  for (std::map<std::string, ObjectMap>::const_iterator group = dirty.begin(); group != dirty.end(); ++group, ++job)
+  {
+    job->valid = true;
+    job->objects.reserve(group->second.size());
+    for (ObjectMap::const_iterator object = group->second.begin(); object != group->second.end(); ++object)
+      job->objects.push_back(object->second);
+  }
+  log_debug2("Validating %i schema groups\n", (int)jobs.size());
+
+  ValidationManager::begin_batch();
+  try
+  {
+    if (jobs.size() == 1)
+      validate_objects(&jobs[0], tag);
+    else
+    {
+      base::TaskGroup group(max_threads);
+      for (job = jobs.begin(); job != jobs.end(); ++job)
+        group.run(boost::bind(&IncrementalValidator::validate_objects, &*job, tag));
+      group.wait();
+    }
+  }
+  catch (...)
+  {
+    ValidationManager::end_batch();
+    throw;
+  }
+  ValidationManager::end_batch();
+
+  bool valid = true;
+  for (job = jobs.begin(); job != jobs.end(); ++job)
+    valid = valid && job->valid;
+  return valid;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::IncrementalValidator::validate_objects(Job* job, const grt::Validator::Tag& tag)
+{
+  for (std::vector<GrtObjectRef>::const_iterator object = job->objects.begin(); object != job->objects.end(); ++object)
+  {
+    if (!ValidationManager::validate_instance(*object, tag))
+      job->valid = false;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::string bec::IncrementalValidator::schema_id(GrtObjectRef object)
+{
+  while (object.is_valid() && !db_SchemaRef::can_wrap(object))
+    object = object->owner();
+  return object.is_valid() ? object.id() : "";
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Starts listening to changes of the object and all objects it owns, which are all marked dirty if requested.
+ */
+void bec::IncrementalValidator::track(const GrtObjectRef& object, bool dirty)
+{
+  std::vector<boost::signals2::connection>& connections = _connections[object.id()];
+  if (!connections.empty())
+    return;
+
+  // The raw pointer is bound so the slots don't keep the object alive.
+  GrtObject* ptr = static_cast<GrtObject*>(object.valueptr());
+  connections.push_back(object->signal_changed()->connect(boost::bind(&IncrementalValidator::member_changed, this, _1, _2, ptr)));
+  connections.push_back(object->signal_list_changed()->connect(boost::bind(&IncrementalValidator::list_changed, this, _1, _2, _3, ptr)));
+
+  if (dirty)
+    mark_dirty(object);
+  object->get_metaclass()->foreach_member(boost::bind(&IncrementalValidator::track_owned_list, this, object, _1, dirty));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::IncrementalValidator::track_owned_list(const GrtObjectRef& object, const grt::ClassMember* member,
+  bool dirty)
+{
+  if (member->owned_object && member->type.base.type == grt::ListType && member->type.content.type == grt::ObjectType)
+  {
+    grt::BaseListRef list(grt::BaseListRef::cast_from(object->get_member(member->name)));
+    for (size_t c = list.is_valid() ? list.count() : 0, i = 0; i < c; i++)
+    {
+      if (list.get(i).is_valid())
+        track(GrtObjectRef::cast_from(list.get(i)), dirty);
+    }
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::IncrementalValidator::untrack(const GrtObjectRef& object)
+{
+  std::map<std::string, std::vector<boost::signals2::connection> >::iterator entry = _connections.find(object.id());
+  if (entry == _connections.end())
+    return;
+
+  for (std::vector<boost::signals2::connection>::iterator conn = entry->second.begin(); conn != entry->second.end(); ++conn)
+    conn->disconnect();
+  _connections.erase(entry);
+
+  {
+    base::MutexLock lock(_dirty_lock);
+    for (std::map<std::string, ObjectMap>::iterator group = _dirty.begin(); group != _dirty.end(); ++group)
+      group->second.erase(object.id());
+  }
+
+  // Messages of removed objects are obsolete.
+  ValidationManager::message("*", object, "", grt::NoErrorMsg);
+
+  object->get_metaclass()->foreach_member(boost::bind(&IncrementalValidator::untrack_owned_list, this, object, _1));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool bec::IncrementalValidator::untrack_owned_list(const GrtObjectRef& object, const grt::ClassMember* member)
+{
+  if (member->owned_object && member->type.base.type == grt::ListType && member->type.content.type == grt::ObjectType)
+  {
+    grt::BaseListRef list(grt::BaseListRef::cast_from(object->get_member(member->name)));
+    for (size_t c = list.is_valid() ? list.count() : 0, i = 0; i < c; i++)
+    {
+      if (list.get(i).is_valid())
+        untrack(GrtObjectRef::cast_from(list.get(i)));
+    }
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::IncrementalValidator::member_changed(const std::string& name, const grt::ValueRef& ovalue, GrtObject* object)
+{
+  mark_dirty(GrtObjectRef(object));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void bec::IncrementalValidator::list_changed(grt::internal::OwnedList* list, bool added, const grt::ValueRef& value,
+  GrtObject* object)
+{
+  GrtObjectRef owner(object);
+  mark_dirty(owner);
+
+  // Only the content of owned lists is tracked, other lists just reference objects owned elsewhere.
+  if (!value.is_valid() || !GrtObjectRef::can_wrap(value))
+    return;
+  GrtObjectRef item(GrtObjectRef::cast_from(value));
+  if (item->owner() != owner)
+    return;
+
+  if (added)
+    track(item, true);
+  else
+    untrack(item);
+}
+
+//--------------------------------------------------------------------------------------------------
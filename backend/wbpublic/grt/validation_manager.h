@@ -22,9 +22,12 @@
 #include "wbpublic_public_interface.h"
 #include "grtpp.h"
 #include "grts/structs.app.h"
+#include "grts/structs.db.h"
 #include "tree_model.h"
 #include "refresh_ui.h"
-#include <deque>
+#include "base/threading.h"
+#include <list>
+#include <boost/unordered_map.hpp>
 
 
 // Common tag names
@@ -37,6 +40,7 @@ namespace bec
 {
 
 class GRTManager;
+class IncrementalValidator;
 
 class WBPUBLICBACKEND_PUBLIC_FUNC ValidationMessagesBE : public ListModel, public RefreshUI
 {
@@ -59,6 +63,7 @@ class WBPUBLICBACKEND_PUBLIC_FUNC ValidationMessagesBE : public ListModel, publi
 
   private:
     void validation_message(const grt::Validator::Tag& tag, const grt::ObjectRef&, const std::string&, const int level);
+    void batch_done();
 
     IconId _error_icon;
     IconId _warning_icon;
@@ -77,12 +82,22 @@ class WBPUBLICBACKEND_PUBLIC_FUNC ValidationMessagesBE : public ListModel, publi
       grt::Validator::Tag  tag;
     };
 
-    typedef std::deque<Message>  MessageList;
+    typedef std::list<Message>  MessageList;
     MessageList  _errors;
     MessageList  _warnings;
 
-    static bool match_message(const Message& m, const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
-    void remove_messages(MessageList* ml, const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
+    // The messages of each object, by object id. Replacing the messages of an object
+    // doesn't need to look at the messages of any other object.
+    typedef std::vector<std::pair<MessageList*, MessageList::iterator> > MessageRefs;
+    boost::unordered_map<std::string, MessageRefs> _messages_by_object;
+
+    // Errors followed by warnings, for access by row. Rebuilt when needed after a change.
+    std::vector<const Message*> _rows;
+    bool _rows_valid;
+
+    void add_message(MessageList* ml, const Message& message);
+    void remove_messages(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
+    const Message* message_at(size_t row);
 };
 
 class WBPUBLICBACKEND_PUBLIC_FUNC ValidationManager
@@ -90,18 +105,102 @@ class WBPUBLICBACKEND_PUBLIC_FUNC ValidationManager
   public:
     // const int parameter in MessageSignal is a grt::MessageType
     typedef boost::signals2::signal<void (const grt::Validator::Tag&, const grt::ObjectRef&, const std::string&, const int)> MessageSignal;
+    typedef boost::signals2::signal<void ()> BatchSignal;
     
     static void scan(GRTManager* grtm);
     static void register_validator(grt::GRT* grt, const std::string& type, grt::Validator* v);
     static bool validate_instance(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
 
+    // Validation of the model catalog. Objects of a tracked catalog are validated together with
+    // everything else changed since the previous pass, others directly.
+    static void track_catalog(const db_CatalogRef& catalog);
+    static bool validate_changes(const grt::ObjectRef& obj, const grt::Validator::Tag& tag);
+
     static MessageSignal* signal_notify();
     static void message(const grt::Validator::Tag&, const grt::ObjectRef&, const std::string&, const int level);//level is grt::MessageType
     static void clear();
+
+    // Messages of a validation batch are delivered together once the batch is done, followed by this signal.
+    static BatchSignal* signal_batch_done();
+    static bool in_batch();
+
   private:
+    friend class IncrementalValidator;
+
+    struct BatchMessage
+    {
+      BatchMessage(const grt::Validator::Tag& t, const grt::ObjectRef& o, const std::string& m, int l)
+        : tag(t), object(o), msg(m), level(l)
+      {}
+      grt::Validator::Tag tag;
+      grt::ObjectRef object;
+      std::string msg;
+      int level;
+    };
+
     static bool is_validation_plugin(const app_PluginRef& plugin);
+    static void begin_batch();
+    static void end_batch();
 
     static MessageSignal* _signal_notify;
+    static BatchSignal* _signal_batch_done;
+
+    // Validators may run on worker threads during a batch, their messages are queued until it ends.
+    static base::Mutex _batch_lock;
+    static std::vector<BatchMessage>* _batch_messages;
+    static bool _delivering_batch;
+
+    static IncrementalValidator* _catalog_validator;
+};
+
+/**
+ * Revalidates only the objects of a catalog that changed since the previous pass.
+ *
+ * Changes are tracked through the GRT change signals of the catalog and all objects it owns (schemas,
+ * tables, columns etc.). A change in a part of a table also dirties the table itself. Unless told
+ * otherwise, all objects are dirty when tracking starts. Schemas don't depend on each other, so the dirty objects of each schema are
+ * validated on a separate worker thread. Messages are delivered on the calling thread afterwards.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC IncrementalValidator
+{
+  public:
+    IncrementalValidator(const db_CatalogRef& catalog, bool initially_dirty = true);
+    ~IncrementalValidator();
+
+    void mark_dirty(const GrtObjectRef& object);
+    size_t dirty_count();
+    bool is_tracked(const grt::ObjectRef& object) const;
+
+    bool validate(const grt::Validator::Tag& tag, int max_threads = -1);
+
+  private:
+    typedef std::map<std::string, GrtObjectRef> ObjectMap;
+
+    struct Job
+    {
+      std::vector<GrtObjectRef> objects;
+      bool valid;
+    };
+
+    db_CatalogRef _catalog;
+
+    base::Mutex _dirty_lock;
+    std::map<std::string, ObjectMap> _dirty; // Dirty objects by schema id, "" for objects outside schemas.
+    std::map<std::string, std::vector<boost::signals2::connection> > _connections; // By object id.
+
+    void track(const GrtObjectRef& object, bool dirty);
+    bool track_owned_list(const GrtObjectRef& object, const grt::ClassMember* member, bool dirty);
+    void untrack(const GrtObjectRef& object);
+    bool untrack_owned_list(const GrtObjectRef& object, const grt::ClassMember* member);
+
+    void member_changed(const std::string& name, const grt::ValueRef& ovalue, GrtObject* object);
+    void list_changed(grt::internal::OwnedList* list, bool added, const grt::ValueRef& value, GrtObject* object);
+
+    static std::string schema_id(GrtObjectRef object);
+    static void validate_objects(Job* job, const grt::Validator::Tag& tag);
+
+    IncrementalValidator(const IncrementalValidator&);
+    IncrementalValidator& operator= (const IncrementalValidator&);
 };
 
 //------------------------------------------------------------------------------
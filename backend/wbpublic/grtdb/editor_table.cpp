@@ -1871,7 +1871,7 @@ bool IndexListBE::set_field(const NodeId &node, ColumnId column, const std::stri
       index->name(value);
       _owner->update_change_date();
       undo.end(strfmt(_("Rename Index '%s.%s'"), _owner->get_name().c_str(), index->name().c_str()));
-      bec::ValidationManager::validate_instance(index, CHECK_NAME);
+      bec::ValidationManager::validate_changes(index, CHECK_NAME);
     }
     return true;
   case Type:
@@ -2738,8 +2738,8 @@ bool FKConstraintListBE::set_field(const NodeId &node, ColumnId column, const st
           TableHelper::update_foreign_key_index(fk);
 
           _owner->update_change_date();
-          bec::ValidationManager::validate_instance(_owner->get_table(), "chk_fk_lgc");
-          bec::ValidationManager::validate_instance(dbtable, "chk_fk_lgc");
+          bec::ValidationManager::validate_changes(_owner->get_table(), "chk_fk_lgc");
+          bec::ValidationManager::validate_changes(dbtable, "chk_fk_lgc");
 
           undo.end(strfmt(_("Change Ref. Table for FK '%s.%s'"), _owner->get_name().c_str(), fk->name().c_str()));
         }
@@ -2927,7 +2927,7 @@ void TableEditorBE::set_name(const std::string &name)
     RefreshUI::Blocker __centry(*this);
 
     AutoUndoEdit undo(this, get_object(), "name");
-    bec::ValidationManager::validate_instance(get_table(), CHECK_NAME);
+    bec::ValidationManager::validate_changes(get_table(), CHECK_NAME);
     std::string name_= base::trim_right(name);
     get_dbobject()->name(name_);
     undo.end(strfmt(_("Rename Table to '%s'"), name_.c_str()));
@@ -2957,8 +2957,8 @@ NodeId TableEditorBE::add_column(const std::string &name)
 
   column_count_changed();
 
-  bec::ValidationManager::validate_instance(column, CHECK_NAME);
-  bec::ValidationManager::validate_instance(get_table(), "columns-count");
+  bec::ValidationManager::validate_changes(column, CHECK_NAME);
+  bec::ValidationManager::validate_changes(get_table(), "columns-count");
   return NodeId(get_table()->columns().count()-1);
 }
 
@@ -2983,8 +2983,8 @@ NodeId TableEditorBE::duplicate_column(const db_ColumnRef &column, ssize_t inser
   if (insert_after >= 0)
     get_table()->columns()->reorder(get_table()->columns()->get_index(new_column), insert_after);
 
-  bec::ValidationManager::validate_instance(new_column, CHECK_NAME);
-  bec::ValidationManager::validate_instance(get_table(), "columns-count");
+  bec::ValidationManager::validate_changes(new_column, CHECK_NAME);
+  bec::ValidationManager::validate_changes(get_table(), "columns-count");
   
   column_count_changed();
 
@@ -3008,7 +3008,7 @@ void TableEditorBE::rename_column(const db_ColumnRef &column, const std::string
   update_change_date();
 
   undo.end(strfmt(_("Rename '%s.%s' to '%s'"), get_name().c_str(), old_name.c_str(), name.c_str()));
-  bec::ValidationManager::validate_instance(column, CHECK_NAME);
+  bec::ValidationManager::validate_changes(column, CHECK_NAME);
 
   column_count_changed();
 }
@@ -3029,7 +3029,7 @@ void TableEditorBE::remove_column(const NodeId &node)
   undo.end(strfmt(_("Remove '%s.%s'"), get_name().c_str(), column->name().c_str()));
 
   get_columns()->refresh();
-  bec::ValidationManager::validate_instance(get_table(), "columns-count");
+  bec::ValidationManager::validate_changes(get_table(), "columns-count");
 
   column_count_changed();
 }
@@ -3060,7 +3060,7 @@ NodeId TableEditorBE::add_fk(const std::string &name)
 
   _fk_list.refresh();
 
-  bec::ValidationManager::validate_instance(fk, CHECK_NAME);
+  bec::ValidationManager::validate_changes(fk, CHECK_NAME);
 
   return NodeId(fklist.count() - 1);
 }
@@ -3088,8 +3088,8 @@ bool TableEditorBE::remove_fk(const NodeId &fk)
 
   // There might be no referenced table yet.
   if (ref_table.is_valid())
-    bec::ValidationManager::validate_instance(ref_table, "chk_fk_lgc");
-  bec::ValidationManager::validate_instance(get_table(), "chk_fk_lgc");
+    bec::ValidationManager::validate_changes(ref_table, "chk_fk_lgc");
+  bec::ValidationManager::validate_changes(get_table(), "chk_fk_lgc");
 
   return true;
 }
@@ -3126,8 +3126,8 @@ NodeId TableEditorBE::add_index(const std::string &name)
 
   get_indexes()->refresh();
 
-  bec::ValidationManager::validate_instance(index, CHECK_NAME);
-  bec::ValidationManager::validate_instance(get_table(), CHECK_EFFICIENCY);
+  bec::ValidationManager::validate_changes(index, CHECK_NAME);
+  bec::ValidationManager::validate_changes(get_table(), CHECK_EFFICIENCY);
 
   return NodeId(indices.count() - 1);
 }
@@ -3154,7 +3154,7 @@ bool TableEditorBE::remove_index(const NodeId &index, bool delete_even_if_foreig
   update_change_date();
   undo.end(strfmt(_("Remove Index '%s'.'%s'"), indexobj->name().c_str(), get_name().c_str()));
 
-  bec::ValidationManager::validate_instance(get_table(), CHECK_EFFICIENCY);
+  bec::ValidationManager::validate_changes(get_table(), CHECK_EFFICIENCY);
 
   return true;
 }
@@ -3180,7 +3180,7 @@ NodeId TableEditorBE::add_index_with_columns(const std::vector<NodeId> &columns)
   update_change_date();
   undo.end(strfmt(_("Add Index '%s' to '%s'"), index->name().c_str(), get_name().c_str()));
 
-  bec::ValidationManager::validate_instance(index, CHECK_NAME);
+  bec::ValidationManager::validate_changes(index, CHECK_NAME);
 
   return id;
 }
@@ -3206,7 +3206,7 @@ NodeId TableEditorBE::add_fk_with_columns(const std::vector<NodeId> &columns)
   update_change_date();
   undo.end(strfmt(_("Add Foreign Key '%s' to '%s'"), fk->name().c_str(), get_name().c_str()));
 
-  bec::ValidationManager::validate_instance(fk, CHECK_NAME);
+  bec::ValidationManager::validate_changes(fk, CHECK_NAME);
   
   return id;
 }
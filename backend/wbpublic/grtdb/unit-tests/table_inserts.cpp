@@ -24,6 +24,7 @@
 #include "grtdb/db_object_helpers.h"
 #include "base/string_utilities.h"
 #include "sqlide/recordset_be.h"
+#include "sqlide/table_inserts_loader_be.h"
 #include "wb_helpers.h"
 
 using namespace grt;
@@ -461,6 +462,82 @@ TEST_FUNCTION(15)
     "INSERT INTO `table` (`id`, `name`, `ts`, `pic`) VALUES (DEFAULT, DEFAULT, NOW(), NULL);\n");
 }
 
-END_TESTS
 
+TEST_FUNCTION(20)
+{
+  // Loading an inserts script into the inserts storage of a table (as done when opening old models).
+  db_TableRef table(make_inserts_test_table(grtm->get_grt(), wbt.get_rdbms(), wbt.get_catalog()));
+  db_SchemaRef::cast_from(table->owner())->name("inserts_schema");
+
+  // Column order differs from the table, unknown columns are ignored, missing columns get NULL and
+  // statements for other tables are skipped. The bulk part has more rows than are written per transaction.
+  std::string script =
+    "INSERT INTO `table` (`name`, `id`) VALUES ('first', 1);\n"
+    "INSERT INTO `table` (`id`, `unknown`, `name`) VALUES (2, 'ignored', 'second');\n"
+    "INSERT INTO `other_table` (`id`, `name`) VALUES (3, 'other table');\n"
+    "INSERT INTO `other_schema`.`table` (`id`, `name`) VALUES (4, 'other schema');\n"
+    "INSERT INTO `table` (`id`, `name`, `ts`) VALUES (5, NULL, '2015-01-01 10:00:00');\n"
+    "INSERT INTO `inserts_schema`.`table` (`id`, `name`) VALUES (6, 'qualified');\n";
+  const int bulk_statements = 105;
+  const int rows_per_statement = 100;
+  for (int i = 0; i < bulk_statements; ++i)
+  {
+    script += "INSERT INTO `table` (`ts`, `name`, `id`) VALUES ";
+    for (int j = 0; j < rows_per_statement; ++j)
+    {
+      int id = 1000 + i * rows_per_statement + j;
+      script += strfmt("%s(NULL, 'row %i', %i)", j > 0 ? ", " : "", id, id);
+    }
+    script += ";\n";
+  }
+
+  TableInsertsLoader loader(grtm);
+  loader.process_table(table, script);
+
+  Recordset_table_inserts_storage::Ref storage= Recordset_table_inserts_storage::create(grtm);
+  storage->table(table);
+  Recordset::Ref rs= Recordset::create(grtm);
+  rs->data_storage(storage);
+  rs->reset();
+
+  // The last row is the placeholder for new records.
+  const size_t bulk_rows = bulk_statements * rows_per_statement;
+  ensure_equals("rows", rs->count(), 4 + bulk_rows + 1);
+  ensure_equals("columns", rs->get_column_count(), 4U);
+
+  std::string s;
+  rs->get_field(0, 0, s);
+  ensure_equals("reordered id", s, "1");
+  rs->get_field(0, 1, s);
+  ensure_equals("reordered name", s, "first");
+  ensure("missing column is NULL", rs->is_field_null(0, 2));
+  ensure("missing blob column is NULL", rs->is_field_null(0, 3));
+
+  rs->get_field(1, 0, s);
+  ensure_equals("id with unknown column", s, "2");
+  rs->get_field(1, 1, s);
+  ensure_equals("name with unknown column", s, "second");
+
+  rs->get_field(2, 0, s);
+  ensure_equals("id after other tables", s, "5");
+  ensure("explicit NULL", rs->is_field_null(2, 1));
+  rs->get_field(2, 2, s);
+  ensure_equals("timestamp", s, "2015-01-01 10:00:00");
+
+  rs->get_field(3, 0, s);
+  ensure_equals("qualified id", s, "6");
+  rs->get_field(3, 1, s);
+  ensure_equals("qualified name", s, "qualified");
+
+  for (size_t row = 0; row < bulk_rows; ++row)
+  {
+    std::string id = strfmt("%i", 1000 + (int)row);
+    rs->get_field(4 + row, 0, s);
+    ensure_equals("bulk id", s, id);
+    rs->get_field(4 + row, 1, s);
+    ensure_equals("bulk name", s, "row " + id);
+    ensure("bulk NULL", rs->is_field_null(4 + row, 2));
+  }
+}
 
+END_TESTS
@@ -20,6 +20,9 @@
 #include "mysql_parser_services.h"
 
 #include "base/string_utilities.h"
+#include "base/threading.h"
+
+#include <boost/scoped_ptr.hpp>
 
 #include "mysql-parser.h"
 #include "mysql-syntax-check.h"
@@ -48,11 +51,96 @@ long short_version(const GrtVersionRef &version)
   return (long)short_version;
 }
 
+//------------------ RecognizerPool ----------------------------------------------------------------
+
+/**
+ * Keeps the recognizers of destroyed parser contexts, so that new contexts (e.g. for a new editor)
+ * get recognizers which already have set up their ANTLR input stream, lexer, token stream and parser.
+ * Recognizers are pooled by the charsets they were created with. Server version and sql mode are
+ * simply set on acquisition.
+ */
+class RecognizerPool
+{
+public:
+  void acquire(const std::set<std::string> &charsets, long server_version, MySQLRecognizer *&recognizer,
+    MySQLSyntaxChecker *&syntax_checker)
+  {
+    {
+      base::MutexLock lock(_mutex);
+      PoolMap::iterator iterator = _pool.find(charsets);
+      if (iterator != _pool.end() && !iterator->second.empty())
+      {
+        recognizer = iterator->second.back().first;
+        syntax_checker = iterator->second.back().second;
+        iterator->second.pop_back();
+      }
+      else
+      {
+        recognizer = NULL;
+        syntax_checker = NULL;
+      }
+    }
+
+    if (recognizer == NULL)
+    {
+      recognizer = new MySQLRecognizer(server_version, "", charsets);
+      syntax_checker = new MySQLSyntaxChecker(server_version, "", charsets);
+    }
+    else
+    {
+      recognizer->set_server_version(server_version);
+      recognizer->set_sql_mode("");
+      syntax_checker->set_server_version(server_version);
+      syntax_checker->set_sql_mode("");
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  void release(const std::set<std::string> &charsets, MySQLRecognizer *recognizer, MySQLSyntaxChecker *syntax_checker)
+  {
+    {
+      base::MutexLock lock(_mutex);
+      std::vector<Entry> &entries = _pool[charsets];
+      if (entries.size() < MaxEntries)
+      {
+        entries.push_back(Entry(recognizer, syntax_checker));
+        return;
+      }
+    }
+
+    delete recognizer;
+    delete syntax_checker;
+  }
+
+private:
+  // Recognizers keep their last AST until the next parse run, so don't hold too many of them.
+  static const size_t MaxEntries = 2;
+
+  typedef std::pair<MySQLRecognizer *, MySQLSyntaxChecker *> Entry;
+  typedef std::map<std::set<std::string>, std::vector<Entry> > PoolMap;
+
+  base::Mutex _mutex;
+  PoolMap _pool;
+};
+
+// Intentionally never freed. Parser contexts might still be destroyed during static destruction.
+static RecognizerPool *recognizer_pool = new RecognizerPool();
+
 //------------------ ParserContext -----------------------------------------------------------------
 
+struct ParserContext::PooledScanner
+{
+  std::string text;
+  boost::scoped_ptr<MySQLScanner> scanner;
+};
+
+//--------------------------------------------------------------------------------------------------
+
 ParserContext::ParserContext(GrtCharacterSetsRef charsets, GrtVersionRef version,
   bool case_sensitive)
 {
+  _charsets = charsets;
   _version = version;
   _case_sensitive = case_sensitive;
 
@@ -65,16 +153,15 @@ ParserContext::ParserContext(GrtCharacterSetsRef charsets, GrtVersionRef version
   // Both, parser and syntax checker are only a few hundreds of bytes in size (except for any
   // stored token strings or the AST), so we can always simply create both without serious memory
   // concerns (the syntax checker has no AST).
-  _recognizer = new MySQLRecognizer(server_version, "", _filtered_charsets);
-  _syntax_checker = new MySQLSyntaxChecker(server_version, "", _filtered_charsets);
+  _recognizer_charsets = _filtered_charsets;
+  recognizer_pool->acquire(_recognizer_charsets, server_version, _recognizer, _syntax_checker);
 }
 
 //--------------------------------------------------------------------------------------------------
 
 ParserContext::~ParserContext()
 {
-  delete _recognizer;
-  delete _syntax_checker;
+  recognizer_pool->release(_recognizer_charsets, _recognizer, _syntax_checker);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -98,11 +185,36 @@ void ParserContext::update_filtered_charsets(long version)
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Returns a scanner for the given text. Code completion and the object editors often scan the same text
+ * several times in a row (e.g. the current statement on each key stroke), so the last scanner is kept and handed out again if nobody else uses it anymore. For the same text
+ * its tokens are reused, otherwise its lexer and token memory.
+ */
 boost::shared_ptr<MySQLScanner> ParserContext::createScanner(const std::string &text)
 {
-  long server_version = short_version(_version);
-  return boost::shared_ptr<MySQLScanner>(new MySQLScanner(text.c_str(), text.size(), true, server_version,
-    _sql_mode, _filtered_charsets));
+  if (_scanner && _scanner.unique())
+  {
+    if (_scanner->text != text)
+    {
+      _scanner->text = text;
+      _scanner->scanner->set_text(_scanner->text.c_str(), _scanner->text.size(), true);
+    }
+    else
+      _scanner->scanner->reset();
+  }
+  else
+  {
+    // Either there's no scanner yet or it is still in use. In the latter case the old one stays
+    // alive (together with its text) until its last user releases it.
+    long server_version = short_version(_version);
+    _scanner.reset(new PooledScanner());
+    _scanner->text = text;
+    _scanner->scanner.reset(new MySQLScanner(_scanner->text.c_str(), _scanner->text.size(), true, server_version,
+      _sql_mode, _filtered_charsets));
+  }
+
+  // The returned pointer shares ownership of the pooled entry, so the text stays valid as long as the scanner.
+  return boost::shared_ptr<MySQLScanner>(_scanner, _scanner->scanner.get());
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -120,6 +232,9 @@ void ParserContext::use_sql_mode(const std::string &mode)
   _sql_mode = mode;
   _recognizer->set_sql_mode(mode);
   _syntax_checker->set_sql_mode(mode);
+
+  // The sql mode influences tokenizing (e.g. ANSI_QUOTES), so don't hand out the current tokens again.
+  _scanner.reset();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -143,6 +258,8 @@ void ParserContext::use_server_version(GrtVersionRef version)
 
   _recognizer->set_server_version(server_version);
   _syntax_checker->set_server_version(server_version);
+
+  _scanner.reset(); // The scanner has the old charsets.
 }
 
 //--------------------------------------------------------------------------------------------------
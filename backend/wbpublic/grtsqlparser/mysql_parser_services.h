@@ -43,16 +43,32 @@ namespace parser {
     size_t length;
   } ParserErrorEntry;
 
+  // Counters and memory use of the parse result cache for single object definitions.
+  struct ParseCacheStatistics
+  {
+    size_t hits;
+    size_t misses;
+    size_t entries;
+    size_t size;  // Estimated memory used by the cached objects (in bytes).
+    size_t limit; // Maximum memory for the cache. 0 means caching is disabled.
+  };
+
   class WBPUBLICBACKEND_PUBLIC_FUNC ParserContext {
 
   private:
     MySQLRecognizer *_recognizer;
     MySQLSyntaxChecker *_syntax_checker;
 
+    GrtCharacterSetsRef _charsets;
     GrtVersionRef _version;
     bool _case_sensitive;
     std::string _sql_mode;
     std::set<std::string> _filtered_charsets;
+    std::set<std::string> _recognizer_charsets; // The charsets the recognizers were created with.
+
+    // The scanner returned by the last createScanner() call, together with its text.
+    struct PooledScanner;
+    boost::shared_ptr<PooledScanner> _scanner;
 
     void update_filtered_charsets(long version);
   public:
@@ -72,6 +88,8 @@ namespace parser {
     void use_server_version(GrtVersionRef version);
     GrtVersionRef get_server_version() { return _version; };
 
+    GrtCharacterSetsRef get_charsets() { return _charsets; };
+
     bool case_sensitive() { return _case_sensitive; };
 
     std::vector<ParserErrorEntry> get_errors_with_offset(size_t offset, bool for_syntax_check);
@@ -114,11 +132,18 @@ namespace parser {
     virtual size_t renameSchemaReferences(parser::ParserContext::Ref context, db_mysql_CatalogRef catalog,
       const std::string old_name, const std::string new_name) = 0;
 
+    // If given, delimiter_changes receives the position of each DELIMITER command and the delimiter it sets.
     virtual size_t determineStatementRanges(const char *sql, size_t length, const std::string &initial_delimiter,
-      std::vector<std::pair<size_t, size_t> > &ranges, const std::string &line_break = "\n") = 0;
+      std::vector<std::pair<size_t, size_t> > &ranges, const std::string &line_break = "\n",
+      std::vector<std::pair<size_t, std::string> > *delimiter_changes = NULL) = 0;
 
     virtual grt::DictRef parseStatement(ParserContext::Ref context, grt::GRT *grt, const std::string &sql) = 0;
 
+    // Results of parseTable, parseView, parseRoutine and parseTrigger are cached process-wide.
+    virtual ParseCacheStatistics parseCacheStatistics() = 0;
+    virtual void setParseCacheLimit(size_t limit) = 0; // In bytes. 0 disables and clears the cache.
+    virtual void clearParseCache() = 0;
+
     // Query manipulation services.
     virtual std::string replaceTokenSequenceWithText(parser::ParserContext::Ref context,
       const std::string &sql, size_t start_token, size_t count, const std::vector<std::string> replacements) = 0;
@@ -138,6 +138,23 @@ grt::IntegerRef db_query_Editor::executeScriptAndOutputToGrid(const std::string
 }
 
 
+grt::IntegerRef db_query_Editor::executeScriptFile(const std::string &path, const std::string &defaultSchema, const std::string &defaultCharset,
+  ssize_t startOffset, const std::string &delimiter)
+{
+  if (_data)
+    return _data->executeScriptFile(path, defaultSchema, defaultCharset, startOffset, delimiter);
+  return grt::IntegerRef(-1);
+}
+
+
+grt::DictRef db_query_Editor::scriptFileStatus()
+{
+  if (_data)
+    return _data->scriptFileStatus();
+  return grt::DictRef();
+}
+
+
 db_query_ResultsetRef db_query_Editor::executeManagementQuery(const std::string &sql, ssize_t log)
 {
   if (_data)
@@ -41,6 +41,9 @@ public:
   virtual grt::IntegerRef addToOutput(const std::string &text, long bringToFront)= 0;  
   virtual grt::ListRef<db_query_Resultset> executeScript(const std::string &sql)= 0;
   virtual grt::IntegerRef executeScriptAndOutputToGrid(const std::string &sql)= 0;
+  virtual grt::IntegerRef executeScriptFile(const std::string &path, const std::string &defaultSchema, const std::string &defaultCharset,
+    ssize_t startOffset, const std::string &delimiter)= 0;
+  virtual grt::DictRef scriptFileStatus()= 0;
   virtual db_query_EditableResultsetRef createTableEditResultset(const std::string &schema, const std::string &table, const std::string &where, bool showGrid)= 0;
   
   virtual void activeSchema(const std::string &schema)= 0;
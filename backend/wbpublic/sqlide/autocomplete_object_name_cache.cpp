@@ -60,6 +60,8 @@ AutoCompleteCache::AutoCompleteCache(const std::string &connection_id,
   // is open already that uses this cache.
   if (newDb)
     init_db();
+  else
+    load_index();
 
   log_debug2("Using autocompletion cache file %s\n", (make_path(cache_dir, _connection_id) + ".cache").c_str());
 
@@ -214,60 +216,54 @@ std::vector<std::string> AutoCompleteCache::get_matching_tablespaces(const std::
 
 //--------------------------------------------------------------------------------------------------
 
+std::vector<ObjectNameIndex::Match> AutoCompleteCache::get_fuzzy_matching_table_names(const std::string &schema,
+  const std::string &pattern, size_t max_results)
+{
+  refresh_schema_cache_if_needed(schema);
+
+  base::MutexLock lock(_index_mutex);
+  if (_shutdown)
+    return std::vector<ObjectNameIndex::Match>();
+
+  return _index.fuzzy_matches("tables", schema, "", pattern, max_results);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<ObjectNameIndex::Match> AutoCompleteCache::get_fuzzy_matching_column_names(const std::string &schema,
+  const std::string &table, const std::string &pattern, size_t max_results)
+{
+  refresh_schema_cache_if_needed(schema);
+
+  base::MutexLock lock(_index_mutex);
+  if (_shutdown)
+    return std::vector<ObjectNameIndex::Match>();
+
+  return _index.fuzzy_matches("columns", schema, table, pattern, max_results);
+}
+
+//--------------------------------------------------------------------------------------------------
+
 /**
- * Core object retrieval function.
+ * Core object retrieval function. Lookups are answered from the in-memory index, which holds the
+ * same content as the cache db, so typing doesn't have to wait for a running cache update.
  */
 std::vector<std::string> AutoCompleteCache::get_matching_objects(const std::string &cache,
   const std::string &schema, const std::string &table, const std::string &prefix, RetrievalType type)
 {
-  base::RecMutexLock lock(_sqconn_mutex);
+  base::MutexLock lock(_index_mutex);
   if (_shutdown)
     return std::vector<std::string>();
 
-  std::vector<std::string> items;
-  std::string sql;
   switch (type)
   {
   case RetrieveWithNoQualifier:
-    sql = "SELECT name FROM " + cache + " WHERE name LIKE ? ESCAPE '\\'";
-    break;
+    return _index.prefix_matches(cache, "", "", prefix);
   case RetrieveWithSchemaQualifier:
-    sql = "SELECT name FROM " + cache + " WHERE schema_id LIKE ? ESCAPE '\\' "
-      "AND name LIKE ? ESCAPE '\\'";
-    break;
+    return _index.prefix_matches(cache, schema, "", prefix);
   default: // RetrieveWithFullQualifier
-    sql = "SELECT name FROM " + cache + " WHERE schema_id LIKE ? ESCAPE '\\' "
-      "AND table_id LIKE ? ESCAPE '\\' AND name LIKE ? ESCAPE '\\'";
-    break;
+    return _index.prefix_matches(cache, schema, table, prefix);
   }
-
-  sqlite::query q(*_sqconn, sql);
-  switch (type)
-  {
-  case RetrieveWithNoQualifier:
-    q.bind(1, base::escape_sql_string(prefix, true) + "%");
-    break;
-  case RetrieveWithSchemaQualifier:
-    q.bind(1, schema.empty() ? "%" : base::escape_sql_string(schema, true));
-    q.bind(2, base::escape_sql_string(prefix, true) + "%");
-    break;
-  default: // RetrieveWithFullQualifier
-    q.bind(1, schema.empty() ? "%" : base::escape_sql_string(schema, true));
-    q.bind(2, table.empty() ? "%" : base::escape_sql_string(table, true));
-    q.bind(3, base::escape_sql_string(prefix, true) + "%");
-    break;
-  }
-
-  if (q.emit())
-  {
-    boost::shared_ptr<sqlite::result> matches(q.get_result());
-    do
-    {
-      items.push_back(matches->get_string(0));
-    } while (matches->next_row());
-  }
-
-  return items;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -883,6 +879,58 @@ void AutoCompleteCache::init_db()
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Fills the in-memory index from an existing cache db.
+ */
+void AutoCompleteCache::load_index()
+{
+  std::string caches[] = {"schemas", "variables", "engines", "tablespaces", "logfile_groups", "udfs",
+    "tables", "views", "functions", "procedures", "columns", "triggers"};
+
+  base::RecMutexLock lock(_sqconn_mutex);
+  base::MutexLock index_lock(_index_mutex);
+  for (size_t i = 0; i < sizeof(caches) / sizeof(caches[0]); ++i)
+  {
+    try
+    {
+      std::string sql;
+      if (i < 6)
+        sql = "select '', '', name from " + caches[i] + " where name <> ''";
+      else if (i < 10)
+        sql = "select schema_id, '', name from " + caches[i] + " order by schema_id";
+      else
+        sql = "select schema_id, table_id, name from " + caches[i] + " order by schema_id, table_id";
+
+      sqlite::query q(*_sqconn, sql);
+      if (!q.emit())
+        continue;
+
+      boost::shared_ptr<sqlite::result> matches(q.get_result());
+      std::string schema = matches->get_string(0);
+      std::string table = matches->get_string(1);
+      std::vector<std::string> names;
+      do
+      {
+        if (matches->get_string(0) != schema || matches->get_string(1) != table)
+        {
+          _index.set_names(caches[i], schema, table, names);
+          schema = matches->get_string(0);
+          table = matches->get_string(1);
+          names.clear();
+        }
+        names.push_back(matches->get_string(2));
+      } while (matches->next_row());
+      _index.set_names(caches[i], schema, table, names);
+    }
+    catch (std::exception &exc)
+    {
+      log_error("Error loading cache db.%s: %s\n", caches[i].c_str(), exc.what());
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 bool AutoCompleteCache::is_schema_list_fetch_done()
 {
   // TODO: optimize this.
@@ -1007,6 +1055,9 @@ void AutoCompleteCache::update_schemas(const std::vector<std::string> &schemas)
         insert.clear();
       }
     }
+
+    base::MutexLock index_lock(_index_mutex);
+    _index.set_names("schemas", "", "", schemas);
   }
   catch (std::exception &exc)
   {
@@ -1068,6 +1119,9 @@ void AutoCompleteCache::update_object_names(const std::string &cache, const std:
       insert.emit();
       insert.clear();
     }
+
+    base::MutexLock index_lock(_index_mutex);
+    _index.set_names(cache, "", "", objects);
   }
   catch (std::exception &exc)
   {
@@ -1105,6 +1159,9 @@ void AutoCompleteCache::update_object_names(const std::string &cache, const std:
       insert.emit();
       insert.clear();
     }
+
+    base::MutexLock index_lock(_index_mutex);
+    _index.set_names(cache, schema, "", std::vector<std::string>(objects->begin(), objects->end()));
   }
   catch (std::exception &exc)
   {
@@ -1143,6 +1200,9 @@ void AutoCompleteCache::update_object_names(const std::string &cache, const std:
       insert.emit();
       insert.clear();
     }
+
+    base::MutexLock index_lock(_index_mutex);
+    _index.set_names(cache, schema, table, objects);
   }
   catch (std::exception &exc)
   {
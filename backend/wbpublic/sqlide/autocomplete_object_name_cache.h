@@ -27,6 +27,7 @@
 #include "grts/structs.db.mgmt.h"
 
 #include "cppdbc.h"
+#include "object_name_index.h"
 
 class WBPUBLICBACKEND_PUBLIC_FUNC AutoCompleteCache
 {
@@ -63,6 +64,15 @@ public:
   std::vector<std::string> get_matching_logfile_groups(const std::string &prefix = ""); // Only useful for NDB cluster.
   std::vector<std::string> get_matching_tablespaces(const std::string &prefix = ""); // Only useful for NDB cluster.
 
+  // Scored prefix, camel-hump and subsequence matches, best first. See ObjectNameIndex::fuzzy_matches.
+  std::vector<ObjectNameIndex::Match> get_fuzzy_matching_table_names(const std::string &schema,
+                                                                     const std::string &pattern,
+                                                                     size_t max_results = 0);
+  std::vector<ObjectNameIndex::Match> get_fuzzy_matching_column_names(const std::string &schema,
+                                                                      const std::string &table,
+                                                                      const std::string &pattern,
+                                                                      size_t max_results = 0);
+
   // Data refresh functions. To be called from outside when data objects are created or destroyed.
   void refresh_schema_list();
   bool refresh_schema_cache_if_needed(const std::string &schema);
@@ -130,6 +140,7 @@ private:
   };
 
   void init_db();
+  void load_index();
 
   static void *_refresh_cache_thread(void *);
   void refresh_cache_thread();
@@ -172,6 +183,10 @@ private:
   base::RecMutex _sqconn_mutex;
   sqlite::connection *_sqconn;
 
+  // Lookups are answered from this in-memory copy of the cache db.
+  base::Mutex _index_mutex;
+  ObjectNameIndex _index;
+
   GThread *_refresh_thread;
   base::Semaphore _cache_working;
 
@@ -0,0 +1,425 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "object_name_index.h"
+
+#include <algorithm>
+#include <string.h>
+
+using namespace boost;
+
+//--------------------------------------------------------------------------------------------------
+
+// Only ASCII letters are folded, which is what SQLite does for LIKE.
+static inline char fold(char c)
+{
+  return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static std::string fold(const std::string &text)
+{
+  std::string result(text);
+  for (std::string::iterator i = result.begin(); i != result.end(); ++i)
+    *i = fold(*i);
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static inline uint64_t char_mask(char c)
+{
+  unsigned char u = (unsigned char)fold(c);
+  if (u >= 'a' && u <= 'z')
+    return (uint64_t)1 << (u - 'a');
+  if (u >= '0' && u <= '9')
+    return (uint64_t)1 << (26 + u - '0');
+  if (u == '_')
+    return (uint64_t)1 << 36;
+  return (uint64_t)1 << (37 + u % 27);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static uint64_t text_mask(const char *text, size_t length)
+{
+  uint64_t mask = 0;
+  for (size_t i = 0; i < length; ++i)
+    mask |= char_mask(text[i]);
+  return mask;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static bool is_upper(char c)
+{
+  return c >= 'A' && c <= 'Z';
+}
+
+static bool is_lower(char c)
+{
+  return c >= 'a' && c <= 'z';
+}
+
+static bool is_digit(char c)
+{
+  return c >= '0' && c <= '9';
+}
+
+/**
+ * Word starts in identifiers: the first char, chars after an underscore or other separator,
+ * upper case letters after lower case letters and the first digit of a number.
+ */
+static bool is_word_start(const char *name, size_t i)
+{
+  if (i == 0)
+    return true;
+
+  char previous = name[i - 1];
+  char c = name[i];
+  if (previous == '_' || previous == '$' || previous == ' ' || previous == '.')
+    return c != '_';
+  if (is_upper(c) && is_lower(previous))
+    return true;
+  return is_digit(c) && !is_digit(previous);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Tries to match the pattern from pattern_index on, starting in the name at position. The pattern char
+ * can either continue the current word (i.e. match at position) or match at any later word start.
+ */
+static bool match_humps(const char *name, const char *folded, size_t length, const std::string &pattern,
+  size_t pattern_index, size_t position)
+{
+  if (pattern_index == pattern.size())
+    return true;
+
+  char c = pattern[pattern_index];
+  if (position < length && folded[position] == c
+    && match_humps(name, folded, length, pattern, pattern_index + 1, position + 1))
+    return true;
+
+  for (size_t i = position + 1; i < length; ++i)
+  {
+    if (folded[i] == c && is_word_start(name, i)
+      && match_humps(name, folded, length, pattern, pattern_index + 1, i + 1))
+      return true;
+  }
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the length of the name part that contains all pattern chars in order, or 0 if the pattern
+ * isn't a subsequence of the name. The start of that part is returned in start.
+ */
+static size_t match_subsequence(const char *folded, size_t length, const std::string &pattern, size_t &start)
+{
+  const char *match = (const char *)memchr(folded, pattern[0], length);
+  if (match == NULL)
+    return 0;
+
+  start = match - folded;
+  size_t position = start + 1;
+  for (size_t i = 1; i < pattern.size(); ++i)
+  {
+    match = (const char *)memchr(folded + position, pattern[i], length - position);
+    if (match == NULL)
+      return 0;
+    position = match - folded + 1;
+  }
+  return position - start;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+struct FoldedLess
+{
+  bool operator() (const std::string &left, const std::string &right) const
+  {
+    size_t length = std::min(left.size(), right.size());
+    for (size_t i = 0; i < length; ++i)
+    {
+      char l = fold(left[i]);
+      char r = fold(right[i]);
+      if (l != r)
+        return (unsigned char)l < (unsigned char)r;
+    }
+    if (left.size() != right.size())
+      return left.size() < right.size();
+    return left < right;
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+//----------------- ObjectNameIndex ----------------------------------------------------------------
+
+void ObjectNameIndex::set_names(const std::string &kind, const std::string &schema, const std::string &table,
+  const std::vector<std::string> &names)
+{
+  std::vector<std::string> sorted(names);
+  std::sort(sorted.begin(), sorted.end(), FoldedLess());
+
+  NameList &list = _kinds[kind][OwnerKey(Owner(fold(schema), fold(table)), Owner(schema, table))];
+  list.names.clear();
+  list.offsets.clear();
+  list.masks.clear();
+
+  size_t total = 0;
+  for (std::vector<std::string>::const_iterator i = sorted.begin(); i != sorted.end(); ++i)
+    total += i->size();
+  list.names.reserve(total);
+  list.offsets.reserve(sorted.size() + 1);
+  list.masks.reserve(sorted.size());
+
+  for (std::vector<std::string>::const_iterator i = sorted.begin(); i != sorted.end(); ++i)
+  {
+    list.offsets.push_back((uint32_t)list.names.size());
+    list.masks.push_back(text_mask(i->data(), i->size()));
+    list.names += *i;
+  }
+  list.offsets.push_back((uint32_t)list.names.size());
+  list.folded = fold(list.names);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ObjectNameIndex::remove_names(const std::string &kind, const std::string &schema, const std::string &table)
+{
+  std::map<std::string, OwnerMap>::iterator owners = _kinds.find(kind);
+  if (owners == _kinds.end())
+    return;
+
+  if (schema.empty())
+  {
+    _kinds.erase(owners);
+    return;
+  }
+
+  for (OwnerMap::iterator i = owners->second.begin(); i != owners->second.end();)
+  {
+    if (i->first.second.first == schema && (table.empty() || i->first.second.second == table))
+      owners->second.erase(i++);
+    else
+      ++i;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ObjectNameIndex::clear()
+{
+  _kinds.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t ObjectNameIndex::count(const std::string &kind) const
+{
+  size_t result = 0;
+  std::map<std::string, OwnerMap>::const_iterator owners = _kinds.find(kind);
+  if (owners != _kinds.end())
+  {
+    for (OwnerMap::const_iterator i = owners->second.begin(); i != owners->second.end(); ++i)
+      result += i->second.size();
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns all name lists of the given kind whose owner matches schema and table. Empty values
+ * match any schema or table.
+ */
+std::vector<const ObjectNameIndex::NameList*> ObjectNameIndex::find_lists(const std::string &kind,
+  const std::string &schema, const std::string &table) const
+{
+  std::vector<const NameList*> result;
+  std::map<std::string, OwnerMap>::const_iterator owners = _kinds.find(kind);
+  if (owners == _kinds.end())
+    return result;
+
+  std::string folded_schema = fold(schema);
+  std::string folded_table = fold(table);
+
+  OwnerMap::const_iterator i = owners->second.begin();
+  if (!schema.empty())
+    i = owners->second.lower_bound(OwnerKey(Owner(folded_schema, folded_table), Owner()));
+
+  for (; i != owners->second.end(); ++i)
+  {
+    const Owner &owner = i->first.first;
+    if (!schema.empty() && owner.first != folded_schema)
+      break;
+    if (!table.empty() && owner.second != folded_table)
+    {
+      if (!schema.empty())
+        break; // Owners are sorted, so there can't be any other matching table.
+      continue;
+    }
+    result.push_back(&i->second);
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<std::string> ObjectNameIndex::prefix_matches(const std::string &kind, const std::string &schema,
+  const std::string &table, const std::string &prefix) const
+{
+  std::vector<std::string> result;
+  std::string folded_prefix = fold(prefix);
+
+  std::vector<const NameList*> lists = find_lists(kind, schema, table);
+  for (std::vector<const NameList*>::const_iterator l = lists.begin(); l != lists.end(); ++l)
+  {
+    const NameList &list = **l;
+
+    // Binary search for the first name not less than the prefix.
+    size_t low = 0, high = list.size();
+    while (low < high)
+    {
+      size_t middle = (low + high) / 2;
+      size_t start = list.offsets[middle];
+      size_t length = list.offsets[middle + 1] - start;
+      if (list.folded.compare(start, length, folded_prefix) < 0)
+        low = middle + 1;
+      else
+        high = middle;
+    }
+
+    for (; low < list.size(); ++low)
+    {
+      size_t start = list.offsets[low];
+      size_t length = list.offsets[low + 1] - start;
+      if (length < folded_prefix.size() || list.folded.compare(start, folded_prefix.size(), folded_prefix) != 0)
+        break;
+      result.push_back(list.names.substr(start, length));
+    }
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::vector<ObjectNameIndex::Match> ObjectNameIndex::fuzzy_matches(const std::string &kind,
+  const std::string &schema, const std::string &table, const std::string &pattern, size_t max_results) const
+{
+  std::vector<Candidate> candidates;
+  std::string folded_pattern = fold(pattern);
+  uint64_t pattern_mask = text_mask(pattern.data(), pattern.size());
+
+  std::vector<const NameList*> lists = find_lists(kind, schema, table);
+  for (std::vector<const NameList*>::const_iterator l = lists.begin(); l != lists.end(); ++l)
+    match_list(**l, pattern, folded_pattern, pattern_mask, candidates);
+
+  if (max_results > 0 && max_results < candidates.size())
+  {
+    std::partial_sort(candidates.begin(), candidates.begin() + max_results, candidates.end());
+    candidates.resize(max_results);
+  }
+  else
+    std::sort(candidates.begin(), candidates.end());
+
+  std::vector<Match> result(candidates.size());
+  for (size_t i = 0; i < candidates.size(); ++i)
+  {
+    result[i].name.assign(candidates[i].name, candidates[i].length);
+    result[i].kind = candidates[i].kind;
+    result[i].score = candidates[i].score;
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Best matches first, otherwise sorted by name.
+bool ObjectNameIndex::Candidate::operator < (const Candidate &other) const
+{
+  if (score != other.score)
+    return score > other.score;
+
+  int result = memcmp(name, other.name, std::min(length, other.length));
+  if (result != 0)
+    return result < 0;
+  return length < other.length;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Scoring: prefix matches rank above camel-hump matches, which rank above other subsequence matches.
+ * Within each group shorter names (i.e. closer matches) come first. Prefixes typed in the same case
+ * as the name and subsequences with fewer gaps rank higher.
+ */
+void ObjectNameIndex::match_list(const NameList &list, const std::string &pattern,
+  const std::string &folded_pattern, uint64_t pattern_mask, std::vector<Candidate> &candidates)
+{
+  const char *names = list.names.data();
+  const char *folded = list.folded.data();
+  for (size_t i = 0; i < list.size(); ++i)
+  {
+    if ((list.masks[i] & pattern_mask) != pattern_mask)
+      continue;
+
+    size_t start = list.offsets[i];
+    size_t length = list.offsets[i + 1] - start;
+    if (length < pattern.size())
+      continue;
+
+    Candidate match;
+    int length_penalty = (int)std::min(length - pattern.size(), (size_t)100);
+    if (memcmp(folded + start, folded_pattern.data(), pattern.size()) == 0)
+    {
+      match.kind = PrefixMatch;
+      match.score = 3000 - length_penalty;
+      if (memcmp(names + start, pattern.data(), pattern.size()) == 0)
+        match.score += 200;
+    }
+    else if (folded[start] == folded_pattern[0]
+      && match_humps(names + start, folded + start, length, folded_pattern, 1, 1))
+    {
+      match.kind = CamelHumpMatch;
+      match.score = 2000 - length_penalty;
+    }
+    else
+    {
+      size_t match_start;
+      size_t span = match_subsequence(folded + start, length, folded_pattern, match_start);
+      if (span == 0)
+        continue;
+
+      match.kind = SubsequenceMatch;
+      match.score = 1000 - 10 * (int)std::min(span - pattern.size(), (size_t)50) - (int)std::min(match_start, (size_t)100)
+        - length_penalty;
+    }
+
+    match.name = names + start;
+    match.length = (uint32_t)length;
+    candidates.push_back(match);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
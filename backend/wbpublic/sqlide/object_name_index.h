@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+
+#include <boost/cstdint.hpp>
+#include <map>
+#include <string>
+#include <vector>
+
+/**
+ * In-memory index of object names for code completion, so that lookups don't need to go to the
+ * auto completion cache db for every key stroke.
+ *
+ * Names are kept per object kind (e.g. "tables", "columns") and owner (schema and table, both can be
+ * empty for unqualified objects). Each name list is a sorted arena: all names stored back to back
+ * in a single string, sorted case insensitively, so prefix lookups are a binary search.
+ * For fuzzy matching every name also has a mask of the characters it contains, which allows to
+ * skip most non-matching names without looking at them.
+ *
+ * The class is not thread safe. Callers must serialize access.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC ObjectNameIndex
+{
+public:
+  enum MatchKind
+  {
+    SubsequenceMatch, // All pattern chars appear in the name in the same order.
+    CamelHumpMatch,   // Pattern chars match word starts, e.g. "fn" -> "first_name" or "FirstName".
+    PrefixMatch
+  };
+
+  struct Match
+  {
+    std::string name;
+    MatchKind kind;
+    int score; // Higher is better.
+  };
+
+  // Replaces all names of the given kind and owner.
+  void set_names(const std::string &kind, const std::string &schema, const std::string &table,
+                 const std::vector<std::string> &names);
+
+  // Removes names of the given kind, either all of them (for an empty schema) or only those of the
+  // given schema (and table, if not empty).
+  void remove_names(const std::string &kind, const std::string &schema = "", const std::string &table = "");
+  void clear();
+
+  // Lookups. Empty schema or table values match any schema or table. Owner names and the prefix/pattern
+  // are compared case insensitively (like SQLite's LIKE operator does).
+  std::vector<std::string> prefix_matches(const std::string &kind, const std::string &schema,
+                                          const std::string &table, const std::string &prefix) const;
+
+  // Returns prefix, camel-hump and subsequence matches for the pattern, best matches first.
+  // If max_results is not 0 only that many of the best matches are returned.
+  std::vector<Match> fuzzy_matches(const std::string &kind, const std::string &schema, const std::string &table,
+                                   const std::string &pattern, size_t max_results = 0) const;
+
+  size_t count(const std::string &kind) const;
+
+private:
+  struct NameList
+  {
+    std::string names;               // All names, sorted case insensitively.
+    std::string folded;              // The same in lower case.
+    std::vector<boost::uint32_t> offsets; // Start of each name in the arena, plus the end of the last one.
+    std::vector<boost::uint64_t> masks;   // Characters contained in each name.
+
+    size_t size() const { return masks.size(); }
+  };
+
+  // Schema + table. Owners are sorted by their lower case names first, so all owners that match
+  // a lookup case insensitively are next to each other.
+  typedef std::pair<std::string, std::string> Owner;
+  typedef std::pair<Owner, Owner> OwnerKey; // Lower case + original owner.
+  typedef std::map<OwnerKey, NameList> OwnerMap;
+
+  std::vector<const NameList*> find_lists(const std::string &kind, const std::string &schema,
+                                          const std::string &table) const;
+
+  // A match pointing into a name arena. Match strings are only created for the results returned.
+  struct Candidate
+  {
+    const char *name;
+    boost::uint32_t length;
+    MatchKind kind;
+    int score;
+
+    bool operator < (const Candidate &other) const;
+  };
+
+  static void match_list(const NameList &list, const std::string &pattern, const std::string &folded_pattern,
+                         boost::uint64_t pattern_mask, std::vector<Candidate> &candidates);
+
+  std::map<std::string, OwnerMap> _kinds;
+};
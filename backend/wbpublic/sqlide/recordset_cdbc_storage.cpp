@@ -24,6 +24,7 @@
 #include "grtsqlparser/sql_facade.h"
 #include "base/string_utilities.h"
 #include "base/sqlstring.h"
+#include "base/util_functions.h"
 #include <sqlite/query.hpp>
 #include <boost/cstdint.hpp>
 #include <boost/foreach.hpp>
@@ -40,7 +41,9 @@ Recordset_cdbc_storage::Recordset_cdbc_storage(GRTManager *grtm)
 :
 Recordset_sql_storage(grtm),
 _reloadable(true),
-_gather_field_info(false)
+_gather_field_info(false),
+_fetch_duration(0),
+_swap_db_duration(0)
 {
 }
 
@@ -270,6 +273,9 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
 
   Recordset_sql_storage::do_unserialize(recordset, data_swap_db);
 
+  _fetch_duration= 0;
+  _swap_db_duration= 0;
+
   std::string sql_query= decorated_sql_query();
 
   Recordset::Column_names &column_names= get_column_names(recordset);
@@ -468,6 +474,7 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
 
     std::list<boost::shared_ptr<sqlite::command> > insert_commands= prepare_data_swap_record_add_statement(data_swap_db, column_names);
     // XXX this will fetch all records before displaying them, which will result in a huge unnecessary lag in the UI
+    double fetch_start= timestamp();
     while (rs->next())
     {
       for (ColumnId n= 0; editable_col_count > n; ++n)
@@ -484,13 +491,22 @@ void Recordset_cdbc_storage::do_unserialize(Recordset *recordset, sqlite::connec
       }
       for (ColumnId n= 0; rowid_col_count > n; ++n) // copy original value of pk field(s)
         row_values[editable_col_count+n]= row_values[_pkey_columns[n]];
+
+      double swap_start= timestamp();
+      _fetch_duration+= swap_start - fetch_start;
       add_data_swap_record(insert_commands, row_values);
+      fetch_start= timestamp();
+      _swap_db_duration+= fetch_start - swap_start;
 
       if (_dbms_conn->is_stop_query_requested)
         throw std::runtime_error(_("Query execution has been stopped, the connection to the DB server was not restarted, any open transaction remains open"));
     }
 
+    _fetch_duration+= timestamp() - fetch_start;
+
+    double commit_start= timestamp();
     transaction_guarder.commit();
+    _swap_db_duration+= timestamp() - commit_start;
   }
 
   // remap rowid columns to duplicated columns
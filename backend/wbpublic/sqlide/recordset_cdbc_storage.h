@@ -74,6 +74,10 @@ public:
 
   void set_gather_field_info(bool flag) { _gather_field_info = flag; }
   std::vector<FieldInfo> &field_info() { return _field_info; }
+
+  // Seconds spent by the last unserialization reading rows from the server and storing them in the swap db.
+  double fetch_duration() const { return _fetch_duration; }
+  double swap_db_duration() const { return _swap_db_duration; }
 protected:
   sql::Dbc_connection_handler::ConnectionRef dbms_conn_ref();
   sql::Dbc_connection_handler::ConnectionRef aux_dbms_conn_ref();
@@ -85,6 +89,8 @@ private:
   std::vector<FieldInfo> _field_info;
   bool _reloadable; // whether can be reloaded using stored sql query
   bool _gather_field_info;
+  double _fetch_duration;
+  double _swap_db_duration;
 
   size_t determine_pkey_columns(Recordset::Column_names &column_names, Recordset::Column_types &column_types, Recordset::Column_types &real_column_types);
   size_t determine_pkey_columns_alt(Recordset::Column_names &column_names, Recordset::Column_types &column_types, Recordset::Column_types &real_column_types);
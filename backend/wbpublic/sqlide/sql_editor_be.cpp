@@ -41,6 +41,7 @@
 #include "mforms/filechooser.h"
 
 #include "autocomplete_object_name_cache.h"
+#include "statement_ranges.h"
 
 #include "grts/structs.db.mysql.h"
 
@@ -48,6 +49,13 @@
 
 DEFAULT_LOG_DOMAIN("MySQL editor");
 
+// Statement and error markers are only set for the visible lines plus this many lines above and below
+// (or a page, if that is more), so that scrolling a bit doesn't require an update each time.
+#define MARKER_MARGIN_LINES 50
+
+// Text of this size (in bytes) and more switches the editor automatically into large file mode.
+#define LARGE_FILE_SIZE (10 * 1024 * 1024)
+
 using namespace bec;
 using namespace grt;
 using namespace base;
@@ -92,16 +100,24 @@ public:
   std::pair<const char*, size_t> _text_info; // Only valid during a parse run.
 
   base::RecMutex _sql_errors_mutex;
-  std::vector<ParserErrorEntry> _recognition_errors; // List of errors from the last sql check run.
+  std::vector<ParserErrorEntry> _recognition_errors; // List of errors from the last sql check run, sorted by position.
   std::set<size_t> _error_marker_lines;
 
-  bool _splitting_required;
+  bool _splitting_required;  // The text changed since _text_info was set.
   bool _updating_statement_markers;
   std::set<size_t> _statement_marker_lines;
   base::RecMutex _sql_statement_borders_mutex;
+  StatementRanges _statement_ranges;
 
-  // Each entry is a pair of statement position (byte position) and statement length (also bytes).
-  std::vector<std::pair<size_t, size_t> > _statement_ranges;
+  // The lines for which we set markers and their byte range (start and end position). That is the visible part
+  // of the text plus some margin. Markers outside this range are removed.
+  size_t _marker_first_line;
+  size_t _marker_last_line;
+  std::pair<size_t, size_t> _marker_range;
+
+  // In large file mode statements are only checked for errors in this byte range (protected by _sql_errors_mutex).
+  bool _large_file_mode;
+  std::pair<size_t, size_t> _check_range;
 
   bool _is_refresh_enabled;   // whether FE control is permitted to replace its contents from BE
   bool _is_sql_check_enabled; // Enables automatic syntax checks.
@@ -112,7 +128,7 @@ public:
 
   // autocomplete_context will go after auto completion refactoring.
   Private(grt::GRT *grt, ParserContext::Ref syntaxcheck_context, ParserContext::Ref autocomplete_context)
-    : _grtobj(grt)
+    : _grtobj(grt), _statement_ranges(MySQLParserServices::get(grt))
   {
     _grtm = GRTManager::get_instance_for(grt);
 
@@ -137,34 +153,65 @@ public:
     _toolbar = NULL;
     _last_typed_char = 0;
     _updating_statement_markers = false;
+
+    _marker_first_line = 0;
+    _marker_last_line = 0;
+    _marker_range = std::make_pair(0, 0);
+    _large_file_mode = false;
+    _check_range = std::make_pair(0, 0);
   }
 
   //------------------------------------------------------------------------------------------------
 
   /**
-   * Determines ranges for all statements in the current text.
+   * Determines ranges for all statements in the current text that start at or before the given position.
+   * Only text after the first change since the last run is split again.
+   * Returns false if splitting was stopped (only possible if interruptible is true).
    */
-  void split_statements_if_required()
+  bool split_statements_if_required(size_t limit = (size_t)-1, bool interruptible = false)
   {
+    base::RecMutexLock lock(_sql_statement_borders_mutex);
+
     // If we have restricted content (e.g. for object editors) then we don't split and handle the entire content
     // as a single statement. This will then show syntax errors for any invalid additional input.
-    if (_splitting_required)
+    if (_parse_unit != QtUnknown)
     {
-      log_debug3("Start splitting\n");
+      if (_splitting_required)
+        _statement_ranges.set_single_range(_text_info.second);
       _splitting_required = false;
+      return true;
+    }
+
+    _splitting_required = false;
+    return _statement_ranges.split(_text_info.first, _text_info.second, limit,
+      interruptible ? &_stop_processing : NULL);
+  }
 
-      base::RecMutexLock lock(_sql_statement_borders_mutex);
+  //------------------------------------------------------------------------------------------------
 
-      _statement_ranges.clear();
-      if (_parse_unit == QtUnknown)
-      {
-        double start = timestamp();
-        _services->determineStatementRanges(_text_info.first, _text_info.second, ";", _statement_ranges);
-        log_debug3("Splitting ended after %f ticks\n", timestamp() - start);
-      }
-      else
-        _statement_ranges.push_back(std::make_pair(0, _text_info.second));
+  /**
+   * Determines the lines for which markers are shown (the visible lines plus a margin) and their byte range.
+   */
+  void update_marker_range(mforms::CodeEditor *editor)
+  {
+    size_t first, last;
+    editor->get_visible_lines(first, last);
+
+    size_t margin = std::max((size_t)MARKER_MARGIN_LINES, last - first);
+    first = first > margin ? first - margin : 0;
+    last += margin;
+
+    size_t line_count = editor->line_count();
+    if (last + 1 >= line_count)
+    {
+      last = line_count > 0 ? line_count - 1 : 0;
+      _marker_range = std::make_pair(editor->position_from_line(first), editor->text_length());
     }
+    else
+      _marker_range = std::make_pair(editor->position_from_line(first), editor->position_from_line(last + 1));
+
+    _marker_first_line = first;
+    _marker_last_line = last;
   }
 
   //------------------------------------------------------------------------------------------------
@@ -254,6 +301,7 @@ MySQLEditor::MySQLEditor(grt::GRT *grt, ParserContext::Ref syntax_check_context,
   scoped_connect(_code_editor->signal_char_added(), boost::bind(&MySQLEditor::char_added, this, _1));
   scoped_connect(_code_editor->signal_dwell(), boost::bind(&MySQLEditor::dwell_event, this, _1, _2, _3, _4));
   scoped_connect(_code_editor->signal_marker_changed(), boost::bind(&MySQLEditor::Private::marker_changed, d, _1, _2));
+  scoped_connect(_code_editor->signal_visible_lines_changed(), boost::bind(&MySQLEditor::visible_lines_changed, this));
 
   setup_auto_completion();
 
@@ -365,6 +413,8 @@ static void open_file(MySQLEditor *sql_editor)
       if (FileCharsetDialog::ensure_filedata_utf8(sql_editor->grtm()->get_grt(),
                                                   contents, length, "", file, converted))
       {
+        if (length >= LARGE_FILE_SIZE)
+          sql_editor->set_large_file_mode(true);
         code_editor->set_text_keeping_state(converted ? converted : contents);
         g_free(contents);
         g_free(converted);
@@ -609,7 +659,14 @@ void MySQLEditor::append_text(const std::string &text)
  */
 void MySQLEditor::sql(const char *sql)
 {
+  if (!d->_large_file_mode && strlen(sql) >= LARGE_FILE_SIZE)
+    set_large_file_mode(true);
+
   _code_editor->set_text(sql);
+  {
+    RecMutexLock sql_statement_borders_mutex(d->_sql_statement_borders_mutex);
+    d->_statement_ranges.changed(0);
+  }
   d->_splitting_required = true;
   d->_statement_marker_lines.clear();
   _code_editor->set_eol_mode(mforms::EolLF, true);
@@ -746,9 +803,18 @@ void MySQLEditor::text_changed(int position, int length, int lines_changed, bool
     std::string text = get_written_part(position);
     update_auto_completion(text);
   }
-  
+
+  {
+    // Any running splitter was stopped above, so this doesn't block for long.
+    RecMutexLock sql_statement_borders_mutex(d->_sql_statement_borders_mutex);
+    d->_statement_ranges.changed(position);
+  }
   d->_splitting_required = true;
-  d->_text_info = _code_editor->get_text_ptr();
+
+  // Getting the text pointer makes the editor move its internal gap buffer, which means copying the text
+  // after the change. For large files we defer that to the (delayed) start of the processing.
+  if (!d->_large_file_mode)
+    d->_text_info = _code_editor->get_text_ptr();
   if (d->_is_sql_check_enabled)
     d->_current_delay_timer = d->_grtm->run_every(boost::bind(&MySQLEditor::start_sql_processing, this), 0.05);
   else
@@ -779,19 +845,32 @@ void MySQLEditor::cancel_auto_completion()
 
 //--------------------------------------------------------------------------------------------------
 
+static bool error_less(const ParserErrorEntry &lhs, const ParserErrorEntry &rhs)
+{
+  return lhs.position < rhs.position;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void MySQLEditor::dwell_event(bool started, size_t position, int x, int y)
 {
   if (started)
   {
     if (_code_editor->indicator_at(position) == mforms::RangeIndicatorError)
     {
-      // TODO: sort by position and do a binary search.
-      for (size_t i = 0; i < d->_recognition_errors.size(); ++i)
+      RecMutexLock sql_errors_mutex(d->_sql_errors_mutex);
+
+      // Errors are sorted by position, so search backwards from the first error after the given position.
+      ParserErrorEntry key;
+      key.position = position;
+      std::vector<ParserErrorEntry>::const_iterator iterator = std::upper_bound(d->_recognition_errors.begin(),
+        d->_recognition_errors.end(), key, error_less);
+      while (iterator != d->_recognition_errors.begin())
       {
-        ParserErrorEntry entry = d->_recognition_errors[i];
-        if (entry.position <= position && position <= entry.position + entry.length)
+        --iterator;
+        if (position <= iterator->position + iterator->length)
         {
-          _code_editor->show_calltip(true, position, entry.message);
+          _code_editor->show_calltip(true, position, iterator->message);
           break;
         }
       }
@@ -821,6 +900,16 @@ bool MySQLEditor::start_sql_processing()
 
   d->_stop_processing = false;
 
+  if (d->_large_file_mode)
+  {
+    d->_text_info = _code_editor->get_text_ptr();
+
+    // Only the statements around the visible text are checked. Scrolling further starts a new check.
+    d->update_marker_range(_code_editor);
+    RecMutexLock sql_errors_mutex(d->_sql_errors_mutex);
+    d->_check_range = d->_marker_range;
+  }
+
   _code_editor->set_status_text("");
   if (d->_text_info.first != NULL && d->_text_info.second > 0)
     d->_current_work_timer_id = ThreadedTimer::get()->add_task(TimerTimeSpan, 0.05, true,
@@ -832,22 +921,46 @@ bool MySQLEditor::start_sql_processing()
 
 bool MySQLEditor::do_statement_split_and_check(int id)
 {
-  // TODO: there's no need always split and error-check all text in the editor.
-  //       Only split and scan from the current caret position.
-  d->split_statements_if_required();
-  
+  // In large file mode the text is only split as far as the statements in the check range
+  // (the visible text plus margin) need it. After a change splitting continues before the changed position.
+  std::pair<size_t, size_t> check_range(0, (size_t)-1);
+  if (d->_large_file_mode)
+  {
+    RecMutexLock sql_errors_mutex(d->_sql_errors_mutex);
+    check_range = d->_check_range;
+  }
+  bool split_done = d->split_statements_if_required(check_range.second, true);
+
   // Start tasks that depend on the statement ranges (markers + auto completion).
   d->_grtm->run_once_when_idle(this, boost::bind(&MySQLEditor::splitting_done, this));
 
-  if (d->_stop_processing)
+  if (!split_done || d->_stop_processing)
     return false;
 
   base::RecMutexLock lock(d->_sql_checker_mutex);
 
+  // Copy the ranges to check, as the range list can grow while we are checking (see get_current_statement_range).
+  // Limit them to the statements in the check range, including one that starts before it.
+  StatementRanges::RangeList ranges;
+  {
+    base::RecMutexLock sql_statement_borders_mutex(d->_sql_statement_borders_mutex);
+
+    typedef StatementRanges::RangeList::const_iterator RangeIterator;
+    const StatementRanges::RangeList &all_ranges = d->_statement_ranges.ranges();
+    RangeIterator range_begin = std::upper_bound(all_ranges.begin(), all_ranges.end(),
+      std::make_pair(check_range.first, (size_t)-1));
+    if (range_begin != all_ranges.begin())
+      --range_begin;
+    RangeIterator range_end = std::lower_bound(range_begin, all_ranges.end(),
+      std::make_pair(check_range.second, (size_t)0));
+    ranges.assign(range_begin, range_end);
+  }
+
   // Now do error checking for each of the statements, collecting error positions for later markup.
+  std::vector<ParserErrorEntry> recognition_errors;
   d->_last_sql_check_progress_msg_timestamp = timestamp();
-  for (std::vector<std::pair<size_t, size_t> >::const_iterator range_iterator = d->_statement_ranges.begin();
-    range_iterator != d->_statement_ranges.end(); ++range_iterator)
+  for (StatementRanges::RangeList::const_iterator range_iterator = ranges.begin(); range_iterator != ranges.end();
+    ++range_iterator)
   {
     if (d->_stop_processing)
       return false;
@@ -856,10 +969,16 @@ bool MySQLEditor::do_statement_split_and_check(int id)
                                  range_iterator->second, d->_parse_unit) > 0)
     {
       std::vector<ParserErrorEntry> errors = d->_parser_context->get_errors_with_offset(range_iterator->first, true);
-      d->_recognition_errors.insert(d->_recognition_errors.end(), errors.begin(), errors.end());
+      recognition_errors.insert(recognition_errors.end(), errors.begin(), errors.end());
     }
   }
 
+  std::stable_sort(recognition_errors.begin(), recognition_errors.end(), error_less);
+  {
+    RecMutexLock sql_errors_mutex(d->_sql_errors_mutex);
+    d->_recognition_errors.swap(recognition_errors);
+  }
+
   d->_grtm->run_once_when_idle(this, boost::bind(&MySQLEditor::update_error_markers, this));
 
   return false;
@@ -882,12 +1001,33 @@ void* MySQLEditor::splitting_done()
     show_auto_completion(false, d->_autocompletion_context);
   }
 
+  // Line numbers might have changed, so the marker range must be computed again.
+  d->update_marker_range(_code_editor);
+  update_statement_markers();
+
+  return NULL;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Sets statement markers for all statements starting in the marker range and removes those outside of it.
+ */
+void MySQLEditor::update_statement_markers()
+{
+  // If the splitter is running right now we will get another update when it is done.
+  base::RecMutexTryLock lock(d->_sql_statement_borders_mutex);
+  if (!lock.locked())
+    return;
+
   std::set<size_t> removal_candidates;
   std::set<size_t> insert_candidates;
 
   std::set<size_t> lines;
-  for (std::vector<std::pair<size_t, size_t> >::const_iterator iterator = d->_statement_ranges.begin();
-    iterator != d->_statement_ranges.end(); ++iterator)
+  const StatementRanges::RangeList &ranges = d->_statement_ranges.ranges();
+  StatementRanges::RangeList::const_iterator iterator = std::lower_bound(ranges.begin(), ranges.end(),
+    std::make_pair(d->_marker_range.first, (size_t)0));
+  for (; iterator != ranges.end() && iterator->first < d->_marker_range.second; ++iterator)
     lines.insert(_code_editor->line_from_position(iterator->first));
 
   std::set_difference(lines.begin(), lines.end(), d->_statement_marker_lines.begin(), d->_statement_marker_lines.end(),
@@ -907,12 +1047,14 @@ void* MySQLEditor::splitting_done()
     iterator != insert_candidates.end(); ++iterator)
     _code_editor->show_markup(mforms::LineMarkupStatement, *iterator);
   d->_updating_statement_markers = false;
-
-  return NULL;
 }
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Shows error indicators and markers for all errors in the marker range. The status text counts all errors
+ * found by the last check, which in large file mode only covers the statements around the visible text.
+ */
 void* MySQLEditor::update_error_markers()
 {
   std::set<size_t> removal_candidates;
@@ -920,18 +1062,29 @@ void* MySQLEditor::update_error_markers()
 
   std::set<size_t> lines;
 
+  // Clearing is cheap, as there are indicators only in the marker range.
   _code_editor->remove_indicator(mforms::RangeIndicatorError, 0, _code_editor->text_length());
+
+  RecMutexLock sql_errors_mutex(d->_sql_errors_mutex);
   if (d->_recognition_errors.size() > 0)
   {
+    std::string status;
     if (d->_recognition_errors.size() == 1)
-      _code_editor->set_status_text(_("1 error found"));
+      status = _("1 error found");
     else
-      _code_editor->set_status_text(base::strfmt(_("%lu errors found"), (unsigned long)d->_recognition_errors.size()));
-
-    for (size_t i = 0; i < d->_recognition_errors.size(); ++i)
+      status = base::strfmt(_("%lu errors found"), (unsigned long)d->_recognition_errors.size());
+    if (d->_large_file_mode)
+      status += _(" in the statements around the visible text");
+    _code_editor->set_status_text(status);
+
+    ParserErrorEntry key;
+    key.position = d->_marker_range.first;
+    std::vector<ParserErrorEntry>::const_iterator iterator = std::lower_bound(d->_recognition_errors.begin(),
+      d->_recognition_errors.end(), key, error_less);
+    for (; iterator != d->_recognition_errors.end() && iterator->position < d->_marker_range.second; ++iterator)
     {
-      _code_editor->show_indicator(mforms::RangeIndicatorError, d->_recognition_errors[i].position, d->_recognition_errors[i].length);
-      lines.insert(_code_editor->line_from_position(d->_recognition_errors[i].position));
+      _code_editor->show_indicator(mforms::RangeIndicatorError, iterator->position, iterator->length);
+      lines.insert(_code_editor->line_from_position(iterator->position));
     }
   }
   else
@@ -958,6 +1111,71 @@ void* MySQLEditor::update_error_markers()
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Called when the editor was scrolled or resized. Moves the marker range along if the visible lines
+ * are no longer within it and (in large file mode) starts a syntax check for the newly covered text.
+ */
+void MySQLEditor::visible_lines_changed()
+{
+  size_t first, last;
+  _code_editor->get_visible_lines(first, last);
+  if (first >= d->_marker_first_line && last <= d->_marker_last_line)
+    return;
+
+  d->update_marker_range(_code_editor);
+  update_statement_markers();
+
+  // A pending check after a text change will cover the new range anyway.
+  if (d->_large_file_mode && d->_is_sql_check_enabled && d->_current_delay_timer == NULL &&
+      d->_text_info.first != NULL)
+  {
+    RecMutexLock sql_errors_mutex(d->_sql_errors_mutex);
+    if (d->_marker_range.first < d->_check_range.first || d->_marker_range.second > d->_check_range.second)
+    {
+      d->_check_range = d->_marker_range;
+
+      ThreadedTimer::get()->remove_task(d->_current_work_timer_id); // Does nothing if the id is -1.
+      d->_stop_processing = false;
+      d->_current_work_timer_id = ThreadedTimer::get()->add_task(TimerTimeSpan, 0.05, true,
+        boost::bind(&MySQLEditor::do_statement_split_and_check, this, _1));
+    }
+  }
+
+  update_error_markers();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Large file mode avoids all work on each change that depends on the text size: the editor doesn't wrap or fold
+ * text and only statements near the visible text are checked for syntax errors. It is switched on automatically
+ * when loading text of 10MB or more.
+ */
+void MySQLEditor::set_large_file_mode(bool flag)
+{
+  if (d->_large_file_mode == flag)
+    return;
+
+  d->_large_file_mode = flag;
+  _code_editor->set_features(mforms::FeatureLargeFile, flag);
+
+  if (d->_is_sql_check_enabled)
+  {
+    stop_processing();
+    d->_text_info = _code_editor->get_text_ptr();
+    d->_current_delay_timer = d->_grtm->run_every(boost::bind(&MySQLEditor::start_sql_processing, this), 0.05);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool MySQLEditor::large_file_mode() const
+{
+  return d->_large_file_mode;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 std::string MySQLEditor::selected_text()
 {
   return _code_editor->get_text(true);
@@ -1235,16 +1453,21 @@ bool MySQLEditor::get_current_statement_range(size_t &start, size_t &end, bool s
   // If the splitter wasn't triggered yet (e.g. when typing fast and then immediately running a statement)
   // then we do the splitting here instead.
   RecMutexLock sql_statement_borders_mutex(d->_sql_statement_borders_mutex);
-  d->split_statements_if_required();
+  if (d->_large_file_mode && d->_splitting_required)
+    d->_text_info = _code_editor->get_text_ptr(); // Not updated on each change in this mode.
 
-  if (d->_statement_ranges.empty())
+  // Only the text up to the caret is needed (plus the next statement in strict mode, see below).
+  size_t caret_position = _code_editor->get_caret_pos();
+  d->split_statements_if_required(caret_position);
+
+  const StatementRanges::RangeList &ranges = d->_statement_ranges.ranges();
+  if (ranges.empty())
     return false;
 
-  typedef std::vector<std::pair<size_t, size_t> >::iterator RangeIterator;
+  typedef StatementRanges::RangeList::const_iterator RangeIterator;
 
-  size_t caret_position = _code_editor->get_caret_pos();
-  RangeIterator low = d->_statement_ranges.begin();
-  RangeIterator high = d->_statement_ranges.end() - 1;
+  RangeIterator low = ranges.begin();
+  RangeIterator high = ranges.end() - 1;
   while (low < high)
   {
     RangeIterator middle = low + (high - low + 1) / 2;
@@ -1259,16 +1482,18 @@ bool MySQLEditor::get_current_statement_range(size_t &start, size_t &end, bool s
     }
   }
 
-  if (low == d->_statement_ranges.end())
+  if (low == ranges.end())
     return false;
 
   // If we are between two statements (in white spaces) then the algorithm above returns the lower one.
-  if (strict)
+  if (strict && low->first + low->second < caret_position)
   {
-    if (low->first + low->second < caret_position)
-      ++low;
-    if (low == d->_statement_ranges.end())
+    size_t next = low - ranges.begin() + 1;
+    if (next == ranges.size())
+      d->split_statements_if_required(d->_statement_ranges.split_end()); // Adds at least the next statement, if any.
+    if (next == ranges.size())
       return false;
+    low = ranges.begin() + next;
   }
 
   start = low->first;
@@ -55,6 +55,7 @@ namespace mforms {
 };
 
 class AutoCompleteCache;
+struct CompletionCollectionCache;
 class MySQLRecognizer;
 
 // Identifiers for images used in auto completion lists.
@@ -150,6 +151,12 @@ public:
   void cancel_auto_completion();
   void set_auto_completion_cache(AutoCompleteCache *cache);
 
+  // The grammar based part of auto completion, without an editor (e.g. for benchmarks).
+  // Returns token and rule names possible at the caret (one-based line, character offset).
+  static void load_completion_grammar(const std::string &path);
+  static std::set<std::string> collect_completion_candidates(parser::ParserContext::Ref context,
+    const std::string &statement, size_t caret_line, size_t caret_offset);
+
   std::string selected_text();
   void set_selected_text(const std::string &new_text);
   void insert_text(const std::string &new_text);
@@ -164,6 +171,9 @@ public:
 
   bool has_sql_errors() const;
 
+  void set_large_file_mode(bool flag);
+  bool large_file_mode() const;
+
   void sql_check_progress_msg_throttle(double val);
   void stop_processing();
 
@@ -203,7 +213,9 @@ private:
   int on_sql_check_progress(float progress, const std::string &msg, int tag);
   
   void* splitting_done();
+  void update_statement_markers();
   void* update_error_markers();
+  void visible_lines_changed();
 
   bool code_completion_enabled();
   bool auto_start_code_completion();
@@ -215,6 +227,7 @@ private:
   // is derived from these entries filtered by the current input.
   std::vector<std::pair<int, std::string> > _auto_completion_entries;
   AutoCompleteCache *_auto_completion_cache;
+  boost::shared_ptr<CompletionCollectionCache> _completion_collection_cache; // Grammar rule results, see there.
 
   mforms::CodeEditor* _code_editor;
   mforms::CodeEditorConfig *_editor_config;
@@ -60,7 +60,7 @@ struct GrammarNode {
   bool is_required;     // false for * and ? operators, otherwise true.
   bool multiple;        // true for + and * operators, otherwise false.
   uint32_t token_ref;   // In case of a terminal the id of the token.
-  std::string rule_ref; // In case of a non-terminal the name of the rule.
+  uint32_t rule_ref;    // In case of a non-terminal the id of the rule (index into rules_holder.rules).
 
   GrammarNode()
   {
@@ -68,6 +68,7 @@ struct GrammarNode {
     is_required = true;
     multiple = false;
     token_ref = INVALID_TOKEN;
+    rule_ref = 0;
   }
 };
 
@@ -97,13 +98,25 @@ struct GrammarSequence {
 
 typedef std::vector<GrammarSequence> RuleAlternatives; // A list of alternatives for a given rule.
 
+enum RuleKind { NormalRule, SpecialRule, IgnoredRule };
+
 //--------------------------------------------------------------------------------------------------
 
 // A shared data structure for a given grammar file + some additional parsing info.
+// The grammar is compiled once into a flat list of rules, which reference each other by their index
+// in that list, so no name lookups are needed while matching or collecting candidates.
 static struct
 {
-  std::map<std::string, RuleAlternatives> rules; // The full grammar.
-  std::map<std::string, uint32_t> token_map;     // Map token names to token ids.
+  std::vector<RuleAlternatives> rules;       // The full grammar, indexed by rule id.
+  std::vector<std::string> rule_names;       // The name for each rule id.
+  std::vector<RuleKind> rule_kinds;          // Special and ignored rules (see below), per rule id.
+  std::map<std::string, uint32_t> rule_map;  // Map rule names to rule ids (only used while loading).
+  std::map<std::string, uint32_t> token_map; // Map token names to token ids.
+
+  // Ids of the rules the completion code refers to directly.
+  uint32_t query_rule;
+  uint32_t join_table_list_rule;
+  uint32_t table_alias_rule;
 
   // Rules that must not be examined further when collecting candidates.
   std::set<std::string> special_rules;  // Rules with a special meaning (e.g. "table_ref").
@@ -112,12 +125,35 @@ static struct
 
   //------------------------------------------------------------------------------------------------
 
+  // Returns the id for the given rule name. Rules can be referenced before they are defined, so
+  // an (empty) entry is created for any name not seen so far.
+  uint32_t rule_id(const std::string &name)
+  {
+    std::map<std::string, uint32_t>::const_iterator entry = rule_map.find(name);
+    if (entry != rule_map.end())
+      return entry->second;
+
+    uint32_t id = (uint32_t)rules.size();
+    rule_map[name] = id;
+    rule_names.push_back(name);
+    rules.push_back(RuleAlternatives());
+    rule_kinds.push_back(NormalRule);
+    return id;
+  }
+
+  //------------------------------------------------------------------------------------------------
+
   // Parses the given grammar file (and its associated .tokens file which must be in the same folder)
   // and fills the rule and token_map structures.
   void parse_file(const std::string &name)
   {
     log_debug("Parsing grammar file: %s\n", name.c_str());
 
+    rules.clear();
+    rule_names.clear();
+    rule_kinds.clear();
+    rule_map.clear();
+
     special_rules.clear();
     special_rules.insert("schema_ref");
 
@@ -201,6 +237,15 @@ static struct
     ignored_tokens.insert("DOUBLE_QUOTED_TEXT");
     ignored_tokens.insert("NCHAR_TEXT");
 
+    for (std::set<std::string>::const_iterator i = special_rules.begin(); i != special_rules.end(); ++i)
+      rule_kinds[rule_id(*i)] = SpecialRule;
+    for (std::set<std::string>::const_iterator i = ignored_rules.begin(); i != ignored_rules.end(); ++i)
+      rule_kinds[rule_id(*i)] = IgnoredRule;
+
+    query_rule = rule_id("query");
+    join_table_list_rule = rule_id("join_table_list");
+    table_alias_rule = rule_id("table_alias");
+
     // Load token map first.
     std::string tokenFileName = base::strip_extension(name) + ".tokens";
     std::ifstream tokenFile(tokenFileName.c_str());
@@ -457,7 +502,7 @@ private:
                   node.is_terminal = false;
                   pANTLR3_STRING token_text = child->getText(child);
                   std::string name = (char*)token_text->chars;
-                  node.rule_ref = name;
+                  node.rule_ref = rule_id(name);
                   break;
                 }
 
@@ -478,7 +523,7 @@ private:
             traverse_block(child, block_name.str());
 
             node.is_terminal = false;
-            node.rule_ref = block_name.str();
+            node.rule_ref = rule_id(block_name.str());
           }
           break;
         }
@@ -497,7 +542,7 @@ private:
           node.is_terminal = false;
           pANTLR3_STRING token_text = child->getText(child);
           std::string name = (char*)token_text->chars;
-          node.rule_ref = name;
+          node.rule_ref = rule_id(name);
           break;
         }
 
@@ -508,7 +553,7 @@ private:
           traverse_block(child, block_name.str());
 
           node.is_terminal = false;
-          node.rule_ref = block_name.str();
+          node.rule_ref = rule_id(block_name.str());
           break;
         }
 
@@ -548,7 +593,7 @@ private:
         alternatives.push_back(sequence);
       }
     }
-    rules[name] = alternatives;
+    rules[rule_id(name)] = alternatives;
   }
 
   //------------------------------------------------------------------------------------------------
@@ -585,6 +630,69 @@ struct TableReference
   std::string alias;
 };
 
+enum CompletionRunState { RunStateMatching, RunStateCollectionPending, RunStateCollectionDone };
+
+/**
+ * Collecting candidates from a rule doesn't look at the input, so the result only depends on the
+ * run state the rule is entered with and the innermost special rule on the walk stack (used for
+ * ignored rules). The same rules are visited many times while matching the alternatives that
+ * lead to the caret, so we keep what was collected for a rule and reuse it.
+ *
+ * Each editor keeps its cache between completion requests, as long as the text before the caret
+ * (and so the caret token index) stays the same. Any change there drops the cached entries.
+ */
+struct CompletionCollectionCache
+{
+  struct Key
+  {
+    uint32_t rule;
+    int special_rule; // -1 if there's no special rule on the walk stack.
+    CompletionRunState entry_state;
+
+    bool operator < (const Key &other) const
+    {
+      if (rule != other.rule)
+        return rule < other.rule;
+      if (special_rule != other.special_rule)
+        return special_rule < other.special_rule;
+      return entry_state < other.entry_state;
+    }
+  };
+
+  struct Result
+  {
+    CompletionRunState run_state;
+    std::set<std::string> candidates;
+  };
+
+  std::string statement_prefix; // The statement text before the caret token.
+  size_t caret_token_index;
+  long server_version;
+  int sql_mode;
+  std::map<Key, Result> entries;
+
+  CompletionCollectionCache()
+    : caret_token_index(0), server_version(0), sql_mode(0)
+  {
+  }
+
+  // Clears the entries if they were collected for a different input.
+  void validate(const std::string &prefix, size_t token_index, long version, int mode)
+  {
+    if (token_index == caret_token_index && version == server_version && mode == sql_mode
+      && prefix == statement_prefix)
+      return;
+
+    entries.clear();
+    statement_prefix = prefix;
+    caret_token_index = token_index;
+    server_version = version;
+    sql_mode = mode;
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
 // Context structure for code completion results and token info.
 struct AutoCompletionContext
 {
@@ -594,10 +702,13 @@ struct AutoCompletionContext
   int sql_mode;
 
   char **token_names;
-  std::deque<std::string> walk_stack; // The rules as they are being matched or collected from.
-                                      // It's a deque instead of a stack as we need to iterate over it.
+  std::deque<uint32_t> walk_stack; // The rules as they are being matched or collected from.
+                                   // It's a deque instead of a stack as we need to iterate over it.
+
+  typedef CompletionRunState RunState;
+  RunState run_state;
 
-  enum RunState { RunStateMatching, RunStateCollectionPending, RunStateCollectionDone } run_state;
+  CompletionCollectionCache *collection_cache; // Must be set before collecting.
 
   boost::shared_ptr<MySQLScanner> scanner;
   std::set<std::string> completion_candidates;
@@ -628,10 +739,23 @@ struct AutoCompletionContext
     run_state = RunStateMatching;
     completion_candidates.clear();
 
+    // Entries collected for an earlier request stay valid as long as the text before the caret is the same.
+    scanner->seek(caret_line, caret_offset);
+    size_t caret_token_index = scanner->position();
+    std::string statement_prefix;
+    scanner->reset();
+    while (scanner->position() < caret_token_index)
+    {
+      statement_prefix += scanner->token_text();
+      scanner->next(false);
+    }
+    scanner->reset();
+    collection_cache->validate(statement_prefix, caret_token_index, server_version, sql_mode);
+
     if (scanner->token_channel() != 0)
       scanner->next(true);
 
-    bool matched = match_rule("query");
+    bool matched = match_rule(rules_holder.query_rule);
 
     // Post processing some entries.
     if (completion_candidates.find("NOT2_SYMBOL") != completion_candidates.end())
@@ -741,12 +865,12 @@ private:
    * We try to match only one of the alts in the given rule (the first wins) and collect
    * table references on the way.
    */
-  bool matchRuleAndCollectTableRefs(const std::string &rule)
+  bool matchRuleAndCollectTableRefs(uint32_t rule)
   {
     walk_stack.push_back(rule);
 
     size_t marker = scanner->position();
-    RuleAlternatives alts = rules_holder.rules[rule];
+    const RuleAlternatives &alts = rules_holder.rules[rule];
     for (std::vector<GrammarSequence>::const_iterator i = alts.begin(); i != alts.end(); ++i)
     {
       // First run predicate checks if this alt can be considered at all.
@@ -765,7 +889,7 @@ private:
 
         // If that was the table_alias rule then we can look back for which table (or subquery)
         // it was set and collect the values.
-        if (rule == "table_alias")
+        if (rule == rules_holder.table_alias_rule)
         {
           // The current scanner position is after the alias, so we can seek back straight to the
           // needed values. Need to hard code grammar knowledge here, for this to work however.
@@ -877,7 +1001,7 @@ private:
 
     walk_stack.clear();
     references.clear();
-    matchRuleAndCollectTableRefs("join_table_list");
+    matchRuleAndCollectTableRefs(rules_holder.join_table_list_rule);
   }
 
   //------------------------------------------------------------------------------------------------
@@ -922,7 +1046,7 @@ private:
   {
     for (size_t i = start_index; i < sequence.nodes.size(); ++i)
     {
-      GrammarNode node = sequence.nodes[i];
+      const GrammarNode &node = sequence.nodes[i];
       if (node.is_terminal && node.token_ref == ANTLR3_TOKEN_EOF)
         break;
 
@@ -944,7 +1068,7 @@ private:
           {
             while (++i < sequence.nodes.size())
             {
-              GrammarNode node = sequence.nodes[i];
+              const GrammarNode &node = sequence.nodes[i];
               if (!node.is_terminal || !node.is_required || node.multiple)
                 break;
               token_refs += std::string(" ") + token_names[node.token_ref];
@@ -978,37 +1102,66 @@ private:
   //----------------------------------------------------------------------------------------------------------------------
 
   /**
-   * Collects possibly reachable tokens from all alternatives in the given rule.
+   * Returns the id of the innermost special rule on the walk stack or -1 if there is none.
    */
-  void collect_from_rule(const std::string rule)
+  int innermost_special_rule()
   {
-    // Don't go deeper if we have one of the special or ignored rules.
-    if (rules_holder.special_rules.find(rule) != rules_holder.special_rules.end())
+    for (std::deque<uint32_t>::const_reverse_iterator i = walk_stack.rbegin(); i != walk_stack.rend(); ++i)
     {
-      completion_candidates.insert(rule);
-      run_state = RunStateCollectionDone;
-      return;
+      if (rules_holder.rule_kinds[*i] == SpecialRule)
+        return (int)*i;
     }
+    return -1;
+  }
 
-    // If this is an ignored rule see if we are in a path that involves a special rule
-    // and use this if found.
-    if (rules_holder.ignored_rules.find(rule) != rules_holder.ignored_rules.end())
+  //----------------------------------------------------------------------------------------------------------------------
+
+  /**
+   * Collects possibly reachable tokens from all alternatives in the given rule.
+   */
+  void collect_from_rule(uint32_t rule)
+  {
+    // Don't go deeper if we have one of the special or ignored rules.
+    switch (rules_holder.rule_kinds[rule])
     {
-      for (std::deque<std::string>::const_reverse_iterator i = walk_stack.rbegin(); i != walk_stack.rend(); ++i)
+      case SpecialRule:
+        completion_candidates.insert(rules_holder.rule_names[rule]);
+        run_state = RunStateCollectionDone;
+        return;
+
+      case IgnoredRule:
       {
-        if (rules_holder.special_rules.find(*i) != rules_holder.special_rules.end())
+        // If this is an ignored rule see if we are in a path that involves a special rule
+        // and use this if found.
+        int special_rule = innermost_special_rule();
+        if (special_rule > -1)
         {
-          completion_candidates.insert(*i);
+          completion_candidates.insert(rules_holder.rule_names[special_rule]);
           run_state = RunStateCollectionDone;
-          break;
         }
+        return;
       }
+
+      default:
+        break;
+    }
+
+    CompletionCollectionCache::Key key = { rule, innermost_special_rule(), run_state };
+    std::map<CompletionCollectionCache::Key, CompletionCollectionCache::Result>::const_iterator entry =
+      collection_cache->entries.find(key);
+    if (entry != collection_cache->entries.end())
+    {
+      completion_candidates.insert(entry->second.candidates.begin(), entry->second.candidates.end());
+      run_state = entry->second.run_state;
       return;
     }
 
-    // Any other rule goes here.
+    // Any other rule goes here. Collect into an empty set, so that we can keep the result for this rule.
+    std::set<std::string> outer_candidates;
+    outer_candidates.swap(completion_candidates);
+
     RunState combined_state = RunStateCollectionDone;
-    RuleAlternatives alts = rules_holder.rules[rule];
+    const RuleAlternatives &alts = rules_holder.rules[rule];
     for (std::vector<GrammarSequence>::const_iterator i = alts.begin(); i != alts.end(); ++i)
     {
       // First run a predicate check if this alt can be considered at all.
@@ -1026,6 +1179,13 @@ private:
         combined_state = RunStateCollectionPending;
     }
     run_state = combined_state;
+
+    CompletionCollectionCache::Result &result = collection_cache->entries[key];
+    result.run_state = run_state;
+    result.candidates = completion_candidates;
+
+    outer_candidates.insert(completion_candidates.begin(), completion_candidates.end());
+    completion_candidates.swap(outer_candidates);
   }
   
   //------------------------------------------------------------------------------------------------
@@ -1076,8 +1236,8 @@ private:
             // If we just started collecting it might be we are in a special rule.
             // Check the end of the stack and if so push the rule name to the candidates.
             // Duplicates will be handled automatically.
-            if (rules_holder.special_rules.find(walk_stack.back()) != rules_holder.special_rules.end())
-              completion_candidates.insert(walk_stack.back());
+            if (rules_holder.rule_kinds[walk_stack.back()] == SpecialRule)
+              completion_candidates.insert(rules_holder.rule_names[walk_stack.back()]);
              */
           }
           return false;
@@ -1155,7 +1315,7 @@ private:
 
   //----------------------------------------------------------------------------------------------------------------------
 
-  bool match_rule(const std::string &rule)
+  bool match_rule(uint32_t rule)
   {
     if (run_state != RunStateMatching) // Sanity check - should never happen at this point.
       return false;
@@ -1169,7 +1329,7 @@ private:
     walk_stack.push_back(rule);
 
     // The first alternative that matches wins.
-    RuleAlternatives alts = rules_holder.rules[rule];
+    const RuleAlternatives &alts = rules_holder.rules[rule];
     bool can_seek = false;
 
     size_t highest_token_index = 0;
@@ -1178,7 +1338,7 @@ private:
     for (size_t i = 0; i < alts.size(); ++i)
     {
       // First run a predicate check if this alt can be considered at all.
-      GrammarSequence alt = alts[i];
+      const GrammarSequence &alt = alts[i];
       if ((alt.min_version > server_version) || (server_version > alt.max_version))
         continue;
 
@@ -1252,11 +1412,33 @@ void MySQLEditor::setup_auto_completion()
   _code_editor->auto_completion_fillups("");
 
   // Set up the shared grammar data if this is the first editor.
+  load_completion_grammar(make_path(grtm()->get_basedir(), "data/MySQL.g"));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MySQLEditor::load_completion_grammar(const std::string &path)
+{
   if (rules_holder.rules.empty())
-  {
-    std::string grammar_path = make_path(grtm()->get_basedir(), "data/MySQL.g");
-    rules_holder.parse_file(grammar_path);
-  }
+    rules_holder.parse_file(path);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+std::set<std::string> MySQLEditor::collect_completion_candidates(ParserContext::Ref context,
+  const std::string &statement, size_t caret_line, size_t caret_offset)
+{
+  CompletionCollectionCache collection_cache;
+  AutoCompletionContext completion_context;
+  completion_context.collection_cache = &collection_cache;
+  completion_context.token_names = context->get_token_name_list();
+  completion_context.caret_line = caret_line;
+  completion_context.caret_offset = caret_offset;
+
+  boost::shared_ptr<MySQLScanner> scanner = context->createScanner(statement);
+  completion_context.collect_candiates(scanner);
+
+  return completion_context.completion_candidates;
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1581,7 +1763,11 @@ void MySQLEditor::show_auto_completion(bool auto_choose_single, ParserContext::R
 
   _code_editor->auto_completion_options(true, auto_choose_single, false, true, false);
 
+  if (!_completion_collection_cache)
+    _completion_collection_cache.reset(new CompletionCollectionCache());
+
   AutoCompletionContext context;
+  context.collection_cache = _completion_collection_cache.get();
   context.token_names = parser_context->get_token_name_list();
 
   // Get the statement and its absolute position.
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "statement_ranges.h"
+
+#include <algorithm>
+
+// When splitting is limited to a position the text is split in chunks that extend at least this far beyond it.
+#define SPLIT_CHUNK_SIZE (256 * 1024)
+
+//--------------------------------------------------------------------------------------------------
+
+static bool ends_before(const std::pair<size_t, size_t> &range, size_t position)
+{
+  return range.first + range.second < position;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+StatementRanges::StatementRanges(parser::MySQLParserServices::Ref services)
+  : _services(services), _split_end(0), _changed_position(0)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void StatementRanges::changed(size_t position)
+{
+  _changed_position = std::min(_changed_position, position);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Removes all statements from the one before the given position on. That statement is split again too,
+ * because a change after it can make it part of a DELIMITER command or extend it (e.g. by removing the delimiter).
+ */
+void StatementRanges::discard_from(size_t position)
+{
+  RangeList::iterator first_changed = std::lower_bound(_ranges.begin(), _ranges.end(), position, ends_before);
+  size_t resume = 0;
+  if (first_changed != _ranges.begin())
+  {
+    --first_changed;
+    resume = first_changed->first;
+  }
+  _ranges.erase(first_changed, _ranges.end());
+
+  while (!_delimiter_changes.empty() && _delimiter_changes.back().first >= resume)
+    _delimiter_changes.pop_back();
+
+  _split_end = resume;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool StatementRanges::split(const char *text, size_t length, size_t limit, const bool *stop)
+{
+  if (_changed_position < _split_end)
+    discard_from(_changed_position);
+  _changed_position = (size_t)-1;
+
+  size_t chunk_size = SPLIT_CHUNK_SIZE;
+  while (_split_end < length && _split_end <= limit)
+  {
+    std::string delimiter = _delimiter_changes.empty() ? ";" : _delimiter_changes.back().second;
+    size_t chunk_length = length - _split_end;
+    if (limit < length && limit - _split_end + chunk_size < chunk_length)
+      chunk_length = limit - _split_end + chunk_size;
+
+    RangeList ranges;
+    std::vector<std::pair<size_t, std::string> > delimiter_changes;
+    _services->determineStatementRanges(text + _split_end, chunk_length, delimiter, ranges, "\n", &delimiter_changes);
+    if (stop != NULL && *stop)
+      return false;
+
+    size_t chunk_end = chunk_length;
+    if (_split_end + chunk_length < length)
+    {
+      // The last statement might continue after the chunk, so it is split again with the next chunk.
+      // That requires at least one complete statement before it.
+      if (ranges.size() < 2)
+      {
+        chunk_size *= 2;
+        continue;
+      }
+      chunk_end = ranges.back().first;
+      ranges.pop_back();
+      while (!delimiter_changes.empty() && delimiter_changes.back().first >= chunk_end)
+        delimiter_changes.pop_back();
+    }
+
+    for (RangeList::const_iterator iterator = ranges.begin(); iterator != ranges.end(); ++iterator)
+      _ranges.push_back(std::make_pair(_split_end + iterator->first, iterator->second));
+    for (std::vector<std::pair<size_t, std::string> >::const_iterator iterator = delimiter_changes.begin();
+      iterator != delimiter_changes.end(); ++iterator)
+      _delimiter_changes.push_back(std::make_pair(_split_end + iterator->first, iterator->second));
+    _split_end += chunk_end;
+  }
+
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void StatementRanges::set_single_range(size_t length)
+{
+  _ranges.clear();
+  _ranges.push_back(std::make_pair(0, length));
+  _delimiter_changes.clear();
+  _split_end = length;
+  _changed_position = (size_t)-1;
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#pragma once
+
+#include "wbpublic_public_interface.h"
+
+#include "grtsqlparser/mysql_parser_services.h"
+
+#include <string>
+#include <vector>
+
+/**
+ * Statement ranges of an editor text, kept up to date incrementally.
+ *
+ * After a change only the text from the statement before the change on is split again. Splitting can also
+ * be limited to a position (e.g. the end of the visible text), in which case the text is split in chunks
+ * and only as far as needed. Text after that is split when a later call needs it.
+ *
+ * The class is not thread safe. Callers must serialize access.
+ */
+class WBPUBLICBACKEND_PUBLIC_FUNC StatementRanges
+{
+public:
+  // Each entry is a pair of statement position (byte position) and statement length (also bytes).
+  typedef std::vector<std::pair<size_t, size_t> > RangeList;
+
+  StatementRanges(parser::MySQLParserServices::Ref services);
+
+  // Marks the text from the given position on as changed. Use 0 if the entire text was replaced.
+  void changed(size_t position);
+
+  // Makes sure all statements starting at or before limit are in the range list.
+  // Returns false if splitting was stopped via stop (the list then ends earlier).
+  bool split(const char *text, size_t length, size_t limit = (size_t)-1, const bool *stop = NULL);
+
+  // Uses the entire text as a single statement (for content restricted to a single object).
+  void set_single_range(size_t length);
+
+  const RangeList &ranges() const { return _ranges; }
+
+  // All statements starting before this position are in the range list.
+  size_t split_end() const { return _split_end; }
+
+private:
+  parser::MySQLParserServices::Ref _services;
+
+  RangeList _ranges;
+  std::vector<std::pair<size_t, std::string> > _delimiter_changes; // Position of each DELIMITER command + delimiter.
+  size_t _split_end;
+  size_t _changed_position; // (size_t)-1 if there was no change since the last split.
+
+  void discard_from(size_t position);
+};
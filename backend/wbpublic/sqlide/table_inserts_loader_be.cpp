@@ -20,11 +20,125 @@
 #include "table_inserts_loader_be.h"
 #include "recordset_table_inserts_storage.h"
 #include "recordset_be.h"
+#include "sqlide_generics.h"
+#include "sqlide_generics_private.h"
+#include "grtsqlparser/sql_facade.h"
+#include "base/string_utilities.h"
+#include <boost/foreach.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <algorithm>
+#include <map>
 
 
 using namespace grt;
 
 
+// Rows written to the inserts storage per transaction.
+#define INSERTS_BATCH_SIZE 10000
+
+
+/**
+ * Writes the rows reported by the inserts loader straight into the storage table of a db table,
+ * using a prepared statement and committing every INSERTS_BATCH_SIZE rows.
+ * Rows are checked and mapped to the table columns like Recordset_sql_storage does it.
+ */
+class TableInsertsWriter
+{
+public:
+  TableInsertsWriter(grt::GRT *grt, db_TableRef table, const std::string &db_path);
+
+  void add_row(const std::string &sql, const std::pair<std::string, std::string> &schema_table,
+    const Sql_inserts_loader::Strings &fields_names, const Sql_inserts_loader::Strings &fields_values,
+    const std::vector<bool> &null_fields);
+
+  void commit() { _transaction->commit(); }
+
+private:
+  grt::GRT *_grt;
+  std::string _schema_name;
+  std::string _table_name;
+  std::map<std::string, size_t> _column_indexes;
+  std::vector<const std::string*> _row_values;
+  size_t _pending_rows;
+
+  sqlite::connection _connection;
+  boost::scoped_ptr<sqlide::Sqlite_transaction_guarder> _transaction;
+  boost::scoped_ptr<sqlite::command> _insert_command;
+};
+
+
+TableInsertsWriter::TableInsertsWriter(grt::GRT *grt, db_TableRef table, const std::string &db_path)
+:
+_grt(grt),
+_schema_name(table->owner()->name()),
+_table_name(table->name()),
+_pending_rows(0),
+_connection(db_path)
+{
+  // The storage table uses the object ids as table and column names.
+  std::string column_ids;
+  std::string placeholders;
+  ListRef<db_Column> columns(table->columns());
+  for (size_t n= 0, count= columns.count(); n < count; ++n)
+  {
+    _column_indexes.insert(std::make_pair(*columns[n]->name(), n));
+    column_ids+= base::strfmt("`%s`, ", columns[n]->id().c_str());
+    placeholders+= "?, ";
+  }
+  _row_values.resize(columns.count());
+  column_ids.resize(column_ids.size()-2);
+  placeholders.resize(placeholders.size()-2);
+
+  sqlide::optimize_sqlite_connection_for_speed(&_connection);
+  _transaction.reset(new sqlide::Sqlite_transaction_guarder(&_connection));
+  _insert_command.reset(new sqlite::command(_connection,
+    base::strfmt("insert into `%s` (%s) values (%s)", table->id().c_str(), column_ids.c_str(), placeholders.c_str())));
+}
+
+
+void TableInsertsWriter::add_row(const std::string &sql, const std::pair<std::string, std::string> &schema_table,
+  const Sql_inserts_loader::Strings &fields_names, const Sql_inserts_loader::Strings &fields_values,
+  const std::vector<bool> &null_fields)
+{
+  if ((schema_table.first != _schema_name) || (schema_table.second != _table_name))
+  {
+    _grt->send_error("Irrelevant insert statement (skipped): " + sql);
+    return;
+  }
+
+  if (fields_names.size() != fields_values.size())
+  {
+    _grt->send_error("Invalid insert statement: " + sql);
+    return;
+  }
+
+  // Fields that are not in the table are ignored, columns without a field get NULL.
+  std::fill(_row_values.begin(), _row_values.end(), (const std::string*)NULL);
+  for (size_t n= 0, count= fields_names.size(); n < count; ++n)
+  {
+    std::map<std::string, size_t>::const_iterator column= _column_indexes.find(fields_names[n]);
+    if (column != _column_indexes.end())
+      _row_values[column->second]= null_fields[n] ? NULL : &fields_values[n];
+  }
+
+  _insert_command->clear();
+  BOOST_FOREACH (const std::string *value, _row_values)
+  {
+    if (value != NULL)
+      *_insert_command % *value;
+    else
+      *_insert_command % sqlite::nil;
+  }
+  _insert_command->emit();
+
+  if (++_pending_rows == INSERTS_BATCH_SIZE)
+  {
+    _transaction->commit_and_start_new_transaction();
+    _pending_rows= 0;
+  }
+}
+
+
 TableInsertsLoader::TableInsertsLoader(bec::GRTManager *grtm)
 :
 _grtm(grtm)
@@ -37,22 +151,6 @@ void TableInsertsLoader::process_table(db_TableRef table, const std::string &ins
   if (!table.is_valid() || inserts_script.empty())
     return;
 
-  Recordset_sql_storage::Ref input_storage= Recordset_sql_storage::create(_grtm);
-  input_storage->sql_script(inserts_script);
-  input_storage->schema_name(table->owner()->name());
-  input_storage->table_name(table->name());
-  {
-    Sql_inserts_loader::Strings affective_columns;
-    affective_columns.reserve(table->columns().count());
-    GRTLIST_FOREACH (db_Column, table->columns(), col)
-      affective_columns.push_back((*col)->name());
-    input_storage->affective_columns(affective_columns);
-  }
-
-  Recordset::Ref rs= Recordset::create(_grtm);
-  rs->data_storage(input_storage);
-  rs->reset();
-  
   Recordset_table_inserts_storage::Ref output_storage= Recordset_table_inserts_storage::create(_grtm);
   output_storage->table(table);
   // provoke creation of underlying table
@@ -60,5 +158,13 @@ void TableInsertsLoader::process_table(db_TableRef table, const std::string &ins
     Recordset::Ref rs= Recordset::create(_grtm);
     output_storage->unserialize(rs);
   }
-  output_storage->serialize(rs);
+
+  // Rows go directly from the script into the storage table, without a recordset in between,
+  // so also big scripts can be loaded.
+  TableInsertsWriter writer(_grtm->get_grt(), table, output_storage->db_path());
+  SqlFacade::Ref sql_facade= SqlFacade::instance_for_rdbms_name(_grtm->get_grt(), "Mysql"); //!
+  Sql_inserts_loader::Ref loader= sql_facade->sqlInsertsLoader();
+  loader->process_insert_cb(boost::bind(&TableInsertsWriter::add_row, &writer, _1, _2, _3, _4, _5));
+  loader->load(inserts_script, table->owner()->name());
+  writer.commit();
 }
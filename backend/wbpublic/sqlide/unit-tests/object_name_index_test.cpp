@@ -0,0 +1,162 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "base/string_utilities.h"
+#include "wb_helpers.h"
+#include "sqlide/object_name_index.h"
+
+#include <algorithm>
+
+BEGIN_TEST_DATA_CLASS(object_name_index_test)
+public:
+  ObjectNameIndex _index;
+
+  TEST_DATA_CONSTRUCTOR(object_name_index_test)
+  {
+    std::vector<std::string> names;
+    names.push_back("first_name");
+    names.push_back("FirstName");
+    names.push_back("film_id");
+    names.push_back("last_name");
+    names.push_back("Fin");
+    _index.set_names("columns", "Sakila", "actor", names);
+
+    names.clear();
+    names.push_back("address_id");
+    names.push_back("first_name");
+    _index.set_names("columns", "sakila", "customer", names);
+    _index.set_names("columns", "world", "city", names);
+  }
+
+END_TEST_DATA_CLASS
+
+TEST_MODULE(object_name_index_test, "object name index for code completion");
+
+// Prefix lookups work like the LIKE queries on the cache db (case insensitive, empty owners match all).
+TEST_FUNCTION(5)
+{
+  std::vector<std::string> list = _index.prefix_matches("columns", "sakila", "ACTOR", "fi");
+  ensure_equals("Prefix matches", list.size(), (size_t)4);
+  ensure_equals("First match", list[0], "film_id");
+  ensure_equals("Second match", list[1], "Fin");
+
+  list = _index.prefix_matches("columns", "sakila", "", "first");
+  ensure_equals("Matches in all tables of a schema", list.size(), (size_t)3);
+
+  list = _index.prefix_matches("columns", "", "", "first_");
+  ensure_equals("Matches in all schemas", list.size(), (size_t)3);
+
+  list = _index.prefix_matches("columns", "", "city", "");
+  ensure_equals("All names of a table", list.size(), (size_t)2);
+
+  ensure("Unknown kind", _index.prefix_matches("tables", "", "", "").empty());
+
+  _index.remove_names("columns", "world");
+  ensure_equals("Names after removing a schema", _index.count("columns"), (size_t)7);
+  _index.remove_names("columns");
+  ensure_equals("Names after removing a kind", _index.count("columns"), (size_t)0);
+}
+
+// Fuzzy matches are scored: prefix before camel-hump before subsequence matches.
+TEST_FUNCTION(10)
+{
+  std::vector<ObjectNameIndex::Match> matches = _index.fuzzy_matches("columns", "sakila", "actor", "fn");
+  ensure_equals("Fuzzy matches", matches.size(), (size_t)3);
+  ensure_equals("Best match", matches[0].name, "FirstName");
+  ensure_equals("Best match kind", matches[0].kind, ObjectNameIndex::CamelHumpMatch);
+  ensure_equals("Second match", matches[1].name, "first_name");
+  ensure_equals("Last match", matches[2].name, "Fin");
+  ensure_equals("Last match kind", matches[2].kind, ObjectNameIndex::SubsequenceMatch);
+
+  matches = _index.fuzzy_matches("columns", "sakila", "", "fir", 1);
+  ensure_equals("Limited result", matches.size(), (size_t)1);
+  ensure_equals("Prefix match", matches[0].kind, ObjectNameIndex::PrefixMatch);
+
+  matches = _index.fuzzy_matches("columns", "sakila", "", "aid");
+  ensure_equals("Camel-hump over several words", matches.size(), (size_t)1);
+  ensure_equals("Camel-hump match", matches[0].name, "address_id");
+
+  ensure("No match", _index.fuzzy_matches("columns", "", "", "xyz").empty());
+}
+
+// Lookups in a big catalog (100k columns in 2000 tables) give the same results as a linear search.
+// Lookup times for this catalog are measured by the name_index benchmark in tools/parser_benchmark.
+TEST_FUNCTION(15)
+{
+  static const char *words[] = { "customer", "order", "id", "name", "address", "created", "at", "total",
+    "amount", "status", "Product", "line", "item", "city", "zip" };
+
+  ObjectNameIndex index;
+  std::vector<std::vector<std::string> > tables;
+  for (int t = 0; t < 2000; ++t)
+  {
+    std::vector<std::string> columns;
+    for (int c = 0; c < 50; ++c)
+      columns.push_back(base::strfmt("%s_%s_%i", words[(t * 7 + c) % 15], words[(c * 3 + t) % 15], c));
+    index.set_names("columns", "shop", base::strfmt("table%i", t), columns);
+    tables.push_back(columns);
+  }
+  ensure_equals("Column count", index.count("columns"), (size_t)100000);
+
+  size_t schema_count = 0;
+  for (int t = 0; t < 2000; ++t)
+  {
+    std::vector<std::string> expected;
+    for (size_t c = 0; c < tables[t].size(); ++c)
+    {
+      std::string folded = base::tolower(tables[t][c]);
+      if (base::starts_with(folded, "or"))
+        expected.push_back(tables[t][c]);
+      if (base::starts_with(folded, "ord"))
+        ++schema_count;
+    }
+
+    if (t % 100 == 0)
+    {
+      std::vector<std::string> list = index.prefix_matches("columns", "shop", base::strfmt("table%i", t), "or");
+      std::sort(list.begin(), list.end());
+      std::sort(expected.begin(), expected.end());
+      ensure_equals(base::strfmt("Prefix match count in table%i", t), list.size(), expected.size());
+      for (size_t i = 0; i < list.size(); ++i)
+        ensure_equals(base::strfmt("Prefix match %u in table%i", (unsigned)i, t), list[i], expected[i]);
+    }
+  }
+  ensure_equals("Prefix matches in the schema", index.prefix_matches("columns", "shop", "", "ord").size(),
+    schema_count);
+
+  // The best 50 fuzzy matches are the first 50 of all matches, best first.
+  std::vector<ObjectNameIndex::Match> all_matches = index.fuzzy_matches("columns", "shop", "", "ps");
+  std::vector<ObjectNameIndex::Match> matches = index.fuzzy_matches("columns", "shop", "", "ps", 50);
+  ensure("Many fuzzy matches", all_matches.size() > 50);
+  ensure_equals("Fuzzy match count", matches.size(), (size_t)50);
+  for (size_t i = 0; i < matches.size(); ++i)
+  {
+    ensure_equals(base::strfmt("Fuzzy match %u", (unsigned)i), matches[i].name, all_matches[i].name);
+    ensure_equals(base::strfmt("Fuzzy match score %u", (unsigned)i), matches[i].score, all_matches[i].score);
+    if (i > 0)
+      ensure(base::strfmt("Fuzzy matches sorted (%u)", (unsigned)i), matches[i - 1].score >= matches[i].score);
+
+    std::string folded = base::tolower(matches[i].name);
+    std::string::size_type p = folded.find('p');
+    ensure(base::strfmt("Fuzzy match %u contains the pattern", (unsigned)i), p != std::string::npos &&
+      folded.find('s', p + 1) != std::string::npos);
+  }
+}
+
+END_TESTS
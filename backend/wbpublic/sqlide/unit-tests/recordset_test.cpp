@@ -21,11 +21,14 @@
 #include <sstream>
 #endif
 
+#include <algorithm>
+
 #include "sqlide/recordset_cdbc_storage.h"
 #include "sqlide/recordset_be.h"
 #include "connection_helpers.h"
 #include "cppdbc.h"
 #include "wb_helpers.h"
+#include "base/string_utilities.h"
 
 BEGIN_TEST_DATA_CLASS(recordset)
 public:
@@ -76,4 +79,93 @@ TEST_FUNCTION(2)
 }
 
 
+// Display values of a wide resultset fetched per block of rows must be the same as fetched per field,
+// also for blocks crossing the block size of the grids, the data frame of the model (1000 rows) and the end.
+TEST_FUNCTION(3)
+{
+  const int column_count = 100;
+  const size_t block_size = 64;
+
+  std::string digits = "(SELECT 0 n UNION ALL SELECT 1 UNION ALL SELECT 2 UNION ALL SELECT 3 UNION ALL SELECT 4 "
+    "UNION ALL SELECT 5 UNION ALL SELECT 6 UNION ALL SELECT 7 UNION ALL SELECT 8 UNION ALL SELECT 9)";
+  std::string query = "SELECT ";
+  for (int i = 0; i < column_count; i++)
+  {
+    // Every 10th column has some NULLs.
+    if (i % 10 == 9)
+      query += base::strfmt("%sif(c.n = 5, NULL, concat('value ', d.n, a.n, b.n, c.n, ' %i')) c%i", i > 0 ? ", " : "",
+        i, i);
+    else
+      query += base::strfmt("%sconcat('value ', d.n, a.n, b.n, c.n, ' %i') c%i", i > 0 ? ", " : "", i, i);
+  }
+  query += " FROM (SELECT 0 n UNION ALL SELECT 1) d, " + digits + " a, " + digits + " b, " + digits + " c"
+    " ORDER BY d.n, a.n, b.n, c.n";
+
+  Recordset_cdbc_storage::Ref data_storage(Recordset_cdbc_storage::create(wbt.wb->get_grt_manager()));
+  data_storage->dbms_conn(dbc_conn);
+
+  Recordset::Ref rs = Recordset::create(wbt.wb->get_grt_manager());
+  rs->data_storage(data_storage);
+
+  boost::shared_ptr<sql::Statement> dbc_statement(dbc_conn->ref->createStatement());
+  dbc_statement->execute(query);
+
+  boost::shared_ptr<sql::ResultSet> rset(dbc_statement->getResultSet());
+  data_storage->dbc_resultset(rset);
+  rs->reset(true);
+
+  // count() includes the placeholder row for new records if the resultset is editable.
+  size_t row_count = rs->count();
+  ensure("Rows", row_count == 2000 || row_count == 2001);
+  ensure_equals("Columns", rs->get_column_count(), (size_t)column_count);
+
+  std::vector<std::string> expected(row_count * column_count);
+  for (size_t row = 0; row < row_count; row++)
+  {
+    for (int column = 0; column < column_count; column++)
+      rs->get_field_repr(row, column, expected[row * column_count + column]);
+  }
+  ensure_equals("Sample value", expected[1234 * column_count + 45], "value 1234 45");
+  ensure_equals("NULL value", expected[1235 * column_count + 9], "");
+
+  // Sequential blocks as the grid fetches them while scrolling down, then going back up (which makes
+  // the model load other data frames).
+  std::vector<size_t> starts;
+  for (size_t row = 0; row < row_count; row += block_size)
+    starts.push_back(row);
+  for (size_t row = row_count - row_count % block_size; row > 0; row -= block_size)
+    starts.push_back(row - block_size);
+
+  // Blocks starting right before a block, data frame or result border.
+  size_t borders[] = { block_size, 2 * block_size, 999, 1000, 1001, 1500, 2000, row_count };
+  for (size_t i = 0; i < sizeof(borders) / sizeof(borders[0]); ++i)
+  {
+    starts.push_back(borders[i] - 1);
+    starts.push_back(borders[i] - 2);
+  }
+
+  std::vector<std::string> block;
+  for (size_t i = 0; i < starts.size(); ++i)
+  {
+    size_t row = starts[i];
+    size_t fetched = rs->get_field_reprs(row, block_size, block);
+    ensure_equals(base::strfmt("Rows fetched from %u", (unsigned)row), fetched,
+      std::min(block_size, row_count - row));
+    ensure_equals(base::strfmt("Values fetched from %u", (unsigned)row), block.size(), fetched * column_count);
+    for (size_t j = 0; j < block.size(); ++j)
+    {
+      size_t index = row * column_count + j;
+      if (block[j] != expected[index])
+        ensure_equals(base::strfmt("Row %u, column %u (block from %u)", (unsigned)(index / column_count),
+          (unsigned)(index % column_count), (unsigned)row), block[j], expected[index]);
+    }
+  }
+
+  // Nothing beyond the end.
+  ensure_equals("Rows fetched at the end", rs->get_field_reprs(row_count, block_size, block), (size_t)0);
+  ensure("Values fetched at the end", block.empty());
+  ensure_equals("Rows fetched after the end", rs->get_field_reprs(row_count + 10, block_size, block), (size_t)0);
+}
+
+
 END_TESTS
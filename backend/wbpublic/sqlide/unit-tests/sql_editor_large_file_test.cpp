@@ -0,0 +1,506 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "base/string_utilities.h"
+#include "grt/grt_manager.h"
+#include "sqlide/sql_editor_be.h"
+#include "mforms/code_editor.h"
+
+#include "Platform.h"
+#include "ILexer.h"
+#include "SplitVector.h"
+#include "Partitioning.h"
+#include "RunStyles.h"
+#include "CellBuffer.h"
+#include "PerLine.h"
+#include "CharClassify.h"
+#include "Decoration.h"
+#include "CaseFolder.h"
+#include "Document.h"
+
+#include "grt_test_utility.h"
+#include "wb_helpers.h"
+
+using namespace Scintilla;
+
+#define LINES_ON_SCREEN 50
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * A headless replacement for the platform editor control: a real Scintilla document (text, lines,
+ * markers and indicators), but no view. A fixed number of lines is assumed to be on screen.
+ * Document changes and scrolling are sent to the code editor as notifications, like the platform
+ * code does.
+ */
+class HeadlessScintilla : public DocWatcher
+{
+public:
+  HeadlessScintilla(mforms::CodeEditor *owner)
+    : _owner(owner), _first_visible_line(0), _caret(0), _anchor(0)
+  {
+    _document = new Document();
+    _document->AddRef();
+    _document->SetDBCSCodePage(SC_CP_UTF8);
+    _document->SetUndoCollection(false);
+    _document->AddWatcher(this, NULL);
+  }
+
+  ~HeadlessScintilla()
+  {
+    _document->RemoveWatcher(this, NULL);
+    _document->Release();
+  }
+
+  sptr_t send(unsigned int message, uptr_t wParam, sptr_t lParam)
+  {
+    switch (message)
+    {
+    case SCI_SETTEXT:
+      _document->DeleteChars(0, _document->Length());
+      _document->InsertString(0, (const char *)lParam, (int)strlen((const char *)lParam));
+      _caret = _anchor = 0;
+      return 0;
+    case SCI_CLEARALL:
+      _document->DeleteChars(0, _document->Length());
+      _caret = _anchor = 0;
+      return 0;
+    case SCI_APPENDTEXT:
+      _document->InsertString(_document->Length(), (const char *)lParam, (int)wParam);
+      return 0;
+    case SCI_INSERTTEXT:
+      _document->InsertString((int)wParam, (const char *)lParam, (int)strlen((const char *)lParam));
+      return 0;
+    case SCI_DELETERANGE:
+      _document->DeleteChars((int)wParam, (int)lParam);
+      return 0;
+    case SCI_REPLACESEL:
+    {
+      int start = std::min(_caret, _anchor);
+      _document->DeleteChars(start, std::max(_caret, _anchor) - start);
+      _caret = _anchor = start + _document->InsertString(start, (const char *)lParam, (int)strlen((const char *)lParam));
+      return 0;
+    }
+
+    case SCI_GETLENGTH:
+    case SCI_GETTEXTLENGTH:
+      return _document->Length();
+    case SCI_GETCHARACTERPOINTER:
+      return (sptr_t)_document->BufferPointer();
+    case SCI_GETLINECOUNT:
+      return _document->LinesTotal();
+    case SCI_LINEFROMPOSITION:
+      return _document->LineFromPosition((int)wParam);
+    case SCI_POSITIONFROMLINE:
+      return _document->LineStart((int)wParam);
+    case SCI_GETLINEENDPOSITION:
+      return _document->LineEnd((int)wParam);
+
+    case SCI_GETCURRENTPOS:
+    case SCI_GETSELECTIONEND:
+      return std::max(_caret, _anchor);
+    case SCI_GETSELECTIONSTART:
+      return std::min(_caret, _anchor);
+    case SCI_SETCURRENTPOS:
+    case SCI_SETSELECTIONEND:
+      _caret = (int)wParam;
+      return 0;
+    case SCI_SETSELECTIONSTART:
+      _anchor = (int)wParam;
+      return 0;
+    case SCI_GOTOPOS:
+    case SCI_SETEMPTYSELECTION:
+      _caret = _anchor = (int)wParam;
+      return 0;
+
+    case SCI_MARKERGET:
+      return _document->GetMark((int)wParam);
+    case SCI_MARKERADDSET:
+      _document->AddMarkSet((int)wParam, (int)lParam);
+      return 0;
+    case SCI_MARKERDELETE:
+      _document->DeleteMark((int)wParam, (int)lParam);
+      return 0;
+    case SCI_MARKERDELETEALL:
+      _document->DeleteAllMarks((int)wParam);
+      return 0;
+    case SCI_MARKERNEXT:
+      return _document->MarkerNext((int)wParam, (int)lParam);
+
+    case SCI_SETINDICATORCURRENT:
+      _document->decorations.SetCurrentIndicator((int)wParam);
+      return 0;
+    case SCI_SETINDICATORVALUE:
+      _document->decorations.SetCurrentValue((int)wParam);
+      return 0;
+    case SCI_INDICATORFILLRANGE:
+      _document->DecorationFillRange((int)wParam, _document->decorations.GetCurrentValue(), (int)lParam);
+      return 0;
+    case SCI_INDICATORCLEARRANGE:
+      _document->DecorationFillRange((int)wParam, 0, (int)lParam);
+      return 0;
+    case SCI_INDICATORVALUEAT:
+      return _document->decorations.ValueAt((int)wParam, (int)lParam);
+
+    case SCI_GETFIRSTVISIBLELINE:
+      return _first_visible_line;
+    case SCI_SETFIRSTVISIBLELINE:
+      scroll_to((int)wParam);
+      return 0;
+    case SCI_LINESONSCREEN:
+      return LINES_ON_SCREEN;
+    case SCI_DOCLINEFROMVISIBLE: // No folding here.
+    case SCI_VISIBLEFROMDOCLINE:
+      return wParam;
+
+    default:
+      return 0;
+    }
+  }
+
+  virtual void NotifyModifyAttempt(Document *doc, void *userData) {}
+  virtual void NotifySavePoint(Document *doc, void *userData, bool atSavePoint) {}
+  virtual void NotifyDeleted(Document *doc, void *userData) {}
+  virtual void NotifyStyleNeeded(Document *doc, void *userData, int endPos) {}
+  virtual void NotifyLexerChanged(Document *doc, void *userData) {}
+  virtual void NotifyErrorOccurred(Document *doc, void *userData, int status) {}
+
+  virtual void NotifyModified(Document *doc, DocModification mh, void *userData)
+  {
+    SCNotification notification;
+    memset(&notification, 0, sizeof(notification));
+    notification.nmhdr.code = SCN_MODIFIED;
+    notification.position = mh.position;
+    notification.modificationType = mh.modificationType;
+    notification.text = mh.text;
+    notification.length = mh.length;
+    notification.linesAdded = mh.linesAdded;
+    notification.line = mh.line;
+    _owner->on_notify(&notification);
+  }
+
+private:
+  mforms::CodeEditor *_owner;
+  Document *_document;
+  int _first_visible_line;
+  int _caret;
+  int _anchor;
+
+  void scroll_to(int line)
+  {
+    line = std::max(0, std::min(line, _document->LinesTotal() - 1));
+    if (line == _first_visible_line)
+      return;
+
+    _first_visible_line = line;
+
+    SCNotification notification;
+    memset(&notification, 0, sizeof(notification));
+    notification.nmhdr.code = SCN_UPDATEUI;
+    notification.updated = SC_UPDATE_V_SCROLL;
+    _owner->on_notify(&notification);
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+static std::map<mforms::CodeEditor*, HeadlessScintilla*> headless_editors;
+
+static bool create_headless(mforms::CodeEditor *self)
+{
+  headless_editors[self] = new HeadlessScintilla(self);
+  return true;
+}
+
+static sptr_t send_headless(mforms::CodeEditor *self, unsigned int message, uptr_t wParam, sptr_t lParam)
+{
+  std::map<mforms::CodeEditor*, HeadlessScintilla*>::iterator iterator = headless_editors.find(self);
+  if (iterator == headless_editors.end())
+    return 0;
+  return iterator->second->send(message, wParam, lParam);
+}
+
+static std::string status_text;
+
+static void set_status_text_headless(mforms::CodeEditor *self, const std::string &text)
+{
+  status_text = text;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Counts the lines with the given markup in the entire document (not only the marker range).
+ * If given, first and last are set to the first and last line with that markup.
+ */
+static size_t count_markup(mforms::CodeEditor *editor, mforms::LineMarkup markup, sptr_t *first = NULL,
+  sptr_t *last = NULL)
+{
+  size_t count = 0;
+  sptr_t line = editor->send_editor(SCI_MARKERNEXT, 0, markup);
+  if (first != NULL)
+    *first = line;
+  while (line > -1)
+  {
+    ++count;
+    if (last != NULL)
+      *last = line;
+    line = editor->send_editor(SCI_MARKERNEXT, line + 1, markup);
+  }
+  return count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Runs the editor's delayed work in this thread (the timer that starts a syntax check and the idle tasks
+ * that set the markers) while the check runs in a worker thread, until the condition is met.
+ * Returns false on timeout.
+ */
+static bool process_until(bec::GRTManager *grtm, const boost::function<bool ()> &condition, double timeout = 60)
+{
+  GTimer *timer = g_timer_new();
+  bool result = false;
+  while (g_timer_elapsed(timer, NULL) < timeout)
+  {
+    grtm->flush_timers();
+    grtm->perform_idle_tasks();
+    if (condition())
+    {
+      result = true;
+      break;
+    }
+    g_usleep(10000);
+  }
+  g_timer_destroy(timer);
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static bool has_error_at(mforms::CodeEditor *editor, size_t position)
+{
+  return editor->indicator_at(position) == mforms::RangeIndicatorError;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static bool has_no_error_markers(mforms::CodeEditor *editor)
+{
+  return count_markup(editor, mforms::LineMarkupError) == 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void delete_headless_editors()
+{
+  for (std::map<mforms::CodeEditor*, HeadlessScintilla*>::iterator iterator = headless_editors.begin();
+    iterator != headless_editors.end(); ++iterator)
+    delete iterator->second;
+  headless_editors.clear();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+BEGIN_TEST_DATA_CLASS(sql_editor_large_file_test)
+public:
+  WBTester _tester;
+  parser::ParserContext::Ref _context;
+  mforms::CodeEditorImplPtrs _stub_impl;
+  std::string _script;
+  size_t _statement_count;
+
+  TEST_DATA_CONSTRUCTOR(sql_editor_large_file_test)
+  {
+    db_mgmt_RdbmsRef rdbms = db_mgmt_RdbmsRef::cast_from(_tester.grt->unserialize("data/res/mysql_rdbms_info.xml"));
+    GrtVersionRef version = bec::parse_version(_tester.grt, "5.6.10");
+    parser::MySQLParserServices::Ref services = parser::MySQLParserServices::get(_tester.grt);
+    _context = services->createParserContext(rdbms->characterSets(), version, 1);
+
+    // Route all code editors created by the tests to the headless Scintilla document.
+    mforms::ControlFactory *factory = mforms::ControlFactory::get_instance();
+    _stub_impl = factory->_code_editor_impl;
+    factory->_code_editor_impl.create = &create_headless;
+    factory->_code_editor_impl.send_editor = &send_headless;
+    factory->_code_editor_impl.set_status_text = &set_status_text_headless;
+
+    // A script of about 50MB: mostly single line inserts, with a multi line table definition every 1000 lines.
+    _statement_count = 0;
+    _script.reserve(51 * 1024 * 1024);
+    while (_script.size() < 50 * 1024 * 1024)
+    {
+      if (_statement_count % 1000 == 0)
+        _script += base::strfmt("CREATE TABLE t%u (\n  id int PRIMARY KEY,\n  name varchar(100),\n  "
+          "created datetime\n);\n", (unsigned)_statement_count);
+      else
+        _script += base::strfmt("INSERT INTO t1 (id, name, created) VALUES (%u, 'customer name %u', "
+          "'2015-01-01 12:00:00');\n", (unsigned)_statement_count, (unsigned)_statement_count);
+      ++_statement_count;
+    }
+  }
+
+  TEST_DATA_DESTRUCTOR(sql_editor_large_file_test)
+  {
+    mforms::ControlFactory::get_instance()->_code_editor_impl = _stub_impl;
+  }
+
+END_TEST_DATA_CLASS
+
+TEST_MODULE(sql_editor_large_file_test, "SQL editor with huge scripts");
+
+// Loading, scrolling and editing a 50MB script. Markers must only exist around the visible lines.
+// Timings for this are measured by the large_file_edit benchmark in tools/parser_benchmark.
+TEST_FUNCTION(5)
+{
+  MySQLEditor::Ref editor = MySQLEditor::create(_tester.grt, _context, _context);
+  mforms::CodeEditor *code_editor = editor->get_editor_control();
+  editor->set_sql_check_enabled(false); // No background work, only what happens synchronously.
+
+  editor->sql(_script.c_str());
+  ensure("Large file mode switched on", editor->large_file_mode());
+  ensure_equals("Text length", code_editor->text_length(), _script.size());
+
+  // Splitting is done on demand when the current statement is needed.
+  size_t start, end;
+  ensure("Current statement found", editor->get_current_statement_range(start, end));
+  ensure_equals("First statement start", start, (size_t)0);
+
+  // Scroll a bit to set the first markers (the initial position doesn't count as scrolling).
+  code_editor->send_editor(SCI_SETFIRSTVISIBLELINE, 10, 0);
+  size_t markers = count_markup(code_editor, mforms::LineMarkupStatement);
+  ensure("Statement markers set", markers > 0);
+  ensure("Statement markers only near the visible lines", markers <= 3 * LINES_ON_SCREEN + 1);
+  ensure("First statement marked", code_editor->has_markup(mforms::LineMarkupStatement, 0));
+  ensure("First table column not marked", !code_editor->has_markup(mforms::LineMarkupStatement, 1));
+
+  // Jump through the document, page by page and a few far away positions.
+  size_t line_count = code_editor->line_count();
+  for (int i = 0; i < 1000; ++i)
+  {
+    size_t line = (i % 2 == 0) ? i * LINES_ON_SCREEN : (line_count / 1000) * i;
+    code_editor->send_editor(SCI_SETFIRSTVISIBLELINE, line, 0);
+  }
+
+  sptr_t first_marker, last_marker;
+  markers = count_markup(code_editor, mforms::LineMarkupStatement, &first_marker, &last_marker);
+  ensure("Statement markers still only near the visible lines", markers > 0 && markers <= 3 * LINES_ON_SCREEN + 1);
+  size_t first, last;
+  code_editor->get_visible_lines(first, last);
+  ensure_equals("Last visible line", last - first, (size_t)LINES_ON_SCREEN);
+
+  // Scrolling must not leave markers behind. The marker range has a margin of one screen and only moves
+  // when the visible lines leave it, so markers are at most two screens away from the visible lines.
+  ensure("No statement markers far above the visible lines", first_marker >= (sptr_t)first - 2 * LINES_ON_SCREEN);
+  ensure("No statement markers far below the visible lines", last_marker <= (sptr_t)last + 2 * LINES_ON_SCREEN);
+  ensure("Visible statements marked",
+    code_editor->send_editor(SCI_MARKERNEXT, first, mforms::LineMarkupStatement) <= (sptr_t)first + 5);
+
+  // Add lines at the start of the text, which moves all markers and (in normal mode) the entire text
+  // in the editor's gap buffer. Large file mode first, then normal mode.
+  code_editor->send_editor(SCI_SETFIRSTVISIBLELINE, 0, 0);
+  size_t position = code_editor->position_from_line(1);
+  for (int i = 0; i < 200; ++i)
+    code_editor->send_editor(SCI_INSERTTEXT, position, (sptr_t)"\n");
+
+  // Markers move with their lines, no new ones appear on the inserted lines.
+  ensure("Large file mode: first statement still marked", code_editor->has_markup(mforms::LineMarkupStatement, 0));
+  ensure("Large file mode: inserted lines not marked",
+    code_editor->send_editor(SCI_MARKERNEXT, 1, mforms::LineMarkupStatement) > 200);
+  markers = count_markup(code_editor, mforms::LineMarkupStatement);
+  ensure("Large file mode: statement markers after typing", markers > 0 && markers <= 3 * LINES_ON_SCREEN + 1);
+
+  editor->set_large_file_mode(false);
+  for (int i = 0; i < 200; ++i)
+    code_editor->send_editor(SCI_INSERTTEXT, position, (sptr_t)"\n");
+
+  ensure("Normal mode: inserted lines not marked",
+    code_editor->send_editor(SCI_MARKERNEXT, 1, mforms::LineMarkupStatement) > 400);
+  markers = count_markup(code_editor, mforms::LineMarkupStatement);
+  ensure("Normal mode: statement markers after typing", markers > 0 && markers <= 3 * LINES_ON_SCREEN + 1);
+
+  editor.reset();
+  delete_headless_editors();
+}
+
+// Syntax checks in large file mode: errors are only reported for the statements around the visible text.
+// Scrolling checks the newly visible text, editing checks it again (splitting only from the change on).
+TEST_FUNCTION(10)
+{
+  // Errors near the start, in the middle and at the end of the script. Each changes a single statement
+  // and keeps the text size and lines.
+  std::string script = _script;
+  size_t error_positions[3] = { script.find("VALUES", 1000), script.find("VALUES", script.size() / 2),
+    script.find("VALUES", script.size() - 10000) };
+  for (size_t i = 0; i < 3; ++i)
+    script.replace(error_positions[i], 6, "VALUEZ");
+
+  MySQLEditor::Ref editor = MySQLEditor::create(_tester.grt, _context, _context);
+  mforms::CodeEditor *code_editor = editor->get_editor_control();
+  bec::GRTManager *grtm = bec::GRTManager::get_instance_for(_tester.grt);
+  ensure("Syntax check enabled", editor->is_sql_check_enabled());
+
+  status_text.clear();
+  editor->sql(script.c_str());
+  ensure("Large file mode switched on", editor->large_file_mode());
+
+  // Only the start of the text is visible.
+  ensure("Error near the start reported",
+    process_until(grtm, boost::bind(has_error_at, code_editor, error_positions[0])));
+  ensure_equals("Only the error near the start counted", status_text,
+    std::string("1 error found in the statements around the visible text"));
+  ensure_equals("Error marker count", count_markup(code_editor, mforms::LineMarkupError), (size_t)1);
+  ensure("Error line marked", code_editor->has_markup(mforms::LineMarkupError,
+    code_editor->line_from_position(error_positions[0])));
+  ensure("Error in the middle not reported", !has_error_at(code_editor, error_positions[1]));
+  ensure("Error at the end not reported", !has_error_at(code_editor, error_positions[2]));
+
+  // Scrolling to the other errors checks the statements there instead.
+  for (size_t i = 1; i < 3; ++i)
+  {
+    ssize_t line = code_editor->line_from_position(error_positions[i]);
+    code_editor->send_editor(SCI_SETFIRSTVISIBLELINE, line - LINES_ON_SCREEN / 2, 0);
+    ensure(base::strfmt("Error %u reported after scrolling", (unsigned)i),
+      process_until(grtm, boost::bind(has_error_at, code_editor, error_positions[i])));
+    ensure_equals(base::strfmt("Only error %u counted", (unsigned)i), status_text,
+      std::string("1 error found in the statements around the visible text"));
+    ensure_equals(base::strfmt("Error marker count after scrolling to error %u", (unsigned)i),
+      count_markup(code_editor, mforms::LineMarkupError), (size_t)1);
+    ensure(base::strfmt("Error line %u marked", (unsigned)i), code_editor->has_markup(mforms::LineMarkupError, line));
+    ensure(base::strfmt("Error near the start no longer shown (%u)", (unsigned)i),
+      !has_error_at(code_editor, error_positions[0]));
+  }
+
+  // Fix the visible error. The statements around it are split and checked again.
+  code_editor->send_editor(SCI_DELETERANGE, error_positions[2], 6);
+  code_editor->send_editor(SCI_INSERTTEXT, error_positions[2], (sptr_t)"VALUES");
+  ensure("Error markers removed after the fix", process_until(grtm, boost::bind(has_no_error_markers, code_editor)));
+  ensure_equals("No errors counted after the fix", status_text, std::string(""));
+
+  size_t start, end;
+  editor->set_cursor_pos(error_positions[2]);
+  ensure("Statement found after the fix", editor->get_current_statement_range(start, end));
+  ensure_equals("Statement start after the fix", start, script.rfind('\n', error_positions[2]) + 1);
+  ensure("Statement end after the fix", end > error_positions[2] && end <= script.find('\n', error_positions[2]) + 1);
+
+  editor->stop_processing();
+  editor.reset();
+  delete_headless_editors();
+}
+
+END_TESTS
@@ -0,0 +1,174 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "base/string_utilities.h"
+#include "sqlide/statement_ranges.h"
+
+#include "grt_test_utility.h"
+#include "wb_helpers.h"
+
+BEGIN_TEST_DATA_CLASS(statement_ranges_test)
+public:
+  WBTester _tester;
+  parser::MySQLParserServices::Ref _services;
+
+  TEST_DATA_CONSTRUCTOR(statement_ranges_test)
+  {
+    _services = parser::MySQLParserServices::get(_tester.grt);
+  }
+
+  StatementRanges::RangeList split_all(const std::string &text)
+  {
+    StatementRanges::RangeList ranges;
+    _services->determineStatementRanges(text.c_str(), text.size(), ";", ranges);
+    return ranges;
+  }
+
+  void ensure_same_ranges(const std::string &message, const StatementRanges::RangeList &actual,
+    const StatementRanges::RangeList &expected)
+  {
+    ensure_equals(message + ": statement count", actual.size(), expected.size());
+    for (size_t i = 0; i < actual.size(); ++i)
+    {
+      ensure_equals(base::strfmt("%s: statement %u start", message.c_str(), (unsigned)i), actual[i].first,
+        expected[i].first);
+      ensure_equals(base::strfmt("%s: statement %u length", message.c_str(), (unsigned)i), actual[i].second,
+        expected[i].second);
+    }
+  }
+
+END_TEST_DATA_CLASS
+
+TEST_MODULE(statement_ranges_test, "incremental statement splitting");
+
+// After a change only the text from the statement before the change on is split again. The result must
+// be the same as splitting the entire text, also when the change affects a DELIMITER command.
+TEST_FUNCTION(5)
+{
+  std::string text = "select 1;\nselect 2;\nDELIMITER $$\ncreate procedure p() begin select 3; end$$\n"
+    "DELIMITER ;\nselect 4;\nselect 5";
+
+  StatementRanges ranges(_services);
+  ensure("Initial split", ranges.split(text.c_str(), text.size()));
+  ensure_same_ranges("Initial split", ranges.ranges(), split_all(text));
+  ensure_equals("Split end", ranges.split_end(), text.size());
+
+  // Each change is given as position, number of bytes removed and the inserted text.
+  struct Change
+  {
+    size_t position;
+    size_t removed;
+    const char *inserted;
+  } changes[] = {
+    { text.find("select 4"), 0, "select 'x';\n" },    // A new statement.
+    { text.find("select 2") + 8, 1, "" },              // Removes a delimiter, joining two statements.
+    { 0, 0, "-- comment\n" },                          // Before the first statement.
+    { text.find("$$\ncreate") + 4, 0, "\n" },          // Right after a DELIMITER command.
+    { text.find("DELIMITER ;"), 9, "SELECTXXX" },      // Removes the DELIMITER command that resets the delimiter.
+    { text.size(), 0, ";\nselect 6;" },                // At the end.
+  };
+
+  for (size_t i = 0; i < sizeof(changes) / sizeof(changes[0]); ++i)
+  {
+    // Positions refer to the original text, so apply each change to a fresh copy.
+    std::string changed_text = text;
+    changed_text.replace(changes[i].position, changes[i].removed, changes[i].inserted);
+
+    StatementRanges changed_ranges(_services);
+    changed_ranges.split(text.c_str(), text.size());
+    changed_ranges.changed(changes[i].position);
+    ensure(base::strfmt("Split after change %u", (unsigned)i),
+      changed_ranges.split(changed_text.c_str(), changed_text.size()));
+    ensure_same_ranges(base::strfmt("Change %u", (unsigned)i), changed_ranges.ranges(), split_all(changed_text));
+  }
+
+  // Replacing the entire text.
+  std::string other_text = "DELIMITER //\nselect 1//\nselect 2//";
+  ranges.changed(0);
+  ranges.split(other_text.c_str(), other_text.size());
+  ensure_same_ranges("Replaced text", ranges.ranges(), split_all(other_text));
+}
+
+// Splitting limited to a position only splits chunks up to (a bit beyond) that position. Splitting further
+// later gives the same result as splitting everything at once, also with delimiter changes and
+// statements across chunk borders.
+TEST_FUNCTION(10)
+{
+  std::string text;
+  for (size_t i = 0; text.size() < 2 * 1024 * 1024; ++i)
+  {
+    if (i % 100 == 0)
+      text += base::strfmt("DELIMITER $$\ncreate procedure p%u()\nbegin\n  select %u;\nend$$\nDELIMITER ;\n",
+        (unsigned)i, (unsigned)i);
+    else
+      text += base::strfmt("insert into t1 values (%u, 'some text; with a delimiter');\n", (unsigned)i);
+  }
+  StatementRanges::RangeList expected = split_all(text);
+
+  StatementRanges ranges(_services);
+  ensure("Limited split", ranges.split(text.c_str(), text.size(), 100));
+  ensure("Limited split covers the limit", ranges.split_end() > 100);
+  ensure("Limited split stops early", ranges.split_end() < text.size() / 2);
+  ensure("Limited split found statements", !ranges.ranges().empty() && ranges.ranges().size() < expected.size());
+  ensure_same_ranges("Limited split", ranges.ranges(),
+    StatementRanges::RangeList(expected.begin(), expected.begin() + ranges.ranges().size()));
+
+  for (size_t limit = 300 * 1024; limit < text.size(); limit += 300 * 1024)
+  {
+    ranges.split(text.c_str(), text.size(), limit);
+    ensure(base::strfmt("Split end beyond %u", (unsigned)limit), ranges.split_end() > limit);
+  }
+  ranges.split(text.c_str(), text.size());
+  ensure_equals("Split end", ranges.split_end(), text.size());
+  ensure_same_ranges("Split in steps", ranges.ranges(), expected);
+
+  // A change in the middle, followed by a limited split before the change: nothing after the change is kept.
+  size_t position = text.find("create procedure", text.size() / 2);
+  text.insert(position, "select 'x'$$\n");
+  ranges.changed(position);
+  ranges.split(text.c_str(), text.size(), 100);
+  ensure("Ranges after the change removed", ranges.split_end() <= position);
+  ranges.split(text.c_str(), text.size());
+  ensure_same_ranges("Split after the change", ranges.ranges(), split_all(text));
+
+  // A stopped split keeps what was split before.
+  bool stop = true;
+  ranges.changed(position);
+  ensure("Stopped split", !ranges.split(text.c_str(), text.size(), (size_t)-1, &stop));
+  ensure("Stopped split keeps the ranges before the change", ranges.split_end() <= position &&
+    !ranges.ranges().empty());
+  ranges.split(text.c_str(), text.size());
+  ensure_same_ranges("Split after stopping", ranges.ranges(), split_all(text));
+}
+
+// Content restricted to a single object is handled as a single statement.
+TEST_FUNCTION(15)
+{
+  std::string text = "create view v as select 1; select 2";
+  StatementRanges ranges(_services);
+  ranges.set_single_range(text.size());
+  ensure_equals("Single range count", ranges.ranges().size(), (size_t)1);
+  ensure_equals("Single range length", ranges.ranges()[0].second, text.size());
+
+  ranges.changed(10);
+  ranges.split(text.c_str(), text.size());
+  ensure_same_ranges("Split after a single range", ranges.ranges(), split_all(text));
+}
+
+END_TESTS
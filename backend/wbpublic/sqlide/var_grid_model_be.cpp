@@ -344,6 +344,43 @@ bool VarGridModel::get_field_repr_(const NodeId &node, ColumnId column, std::str
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Same as get_field_repr() for all fields of the given rows, but with a single lock and cache lookup
+ * per row instead of per field. The placeholder row for new records gives empty values.
+ */
+size_t VarGridModel::get_field_reprs(RowId row, size_t row_count, std::vector<std::string> &values)
+{
+  base::RecMutexLock data_mutex UNUSED (_data_mutex);
+
+  size_t total_rows = count();
+  row_count = (row < total_rows) ? std::min(row_count, total_rows - row) : 0;
+  values.resize(row_count * _column_count);
+
+  for (size_t i = 0; i < row_count; ++i)
+  {
+    RowId current_row = row + i;
+    std::string *row_values = _column_count > 0 ? &values[i * _column_count] : NULL;
+    if (current_row >= _row_count)
+    {
+      for (ColumnId column = 0; column < _column_count; ++column)
+        row_values[column].clear();
+      continue;
+    }
+
+    // Fields of a row are adjacent in the data frame.
+    Cell cell = this->cell(current_row, 0);
+    for (ColumnId column = 0; column < _column_count; ++column, ++cell)
+    {
+      if (_is_field_value_truncation_enabled)
+        _var_to_str_repr.is_truncation_enabled = (current_row != _edited_field_row) || (column != _edited_field_col);
+      row_values[column] = boost::apply_visitor(_var_to_str_repr, *cell);
+    }
+  }
+  return row_count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 bool VarGridModel::get_field(const NodeId &node, ColumnId column, sqlite::variant_t &value)
 {
   base::RecMutexLock data_mutex UNUSED (_data_mutex);
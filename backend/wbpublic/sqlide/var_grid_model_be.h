@@ -108,6 +108,7 @@ public:
   virtual bool get_field(const bec::NodeId &node, ColumnId column, std::string &value);
   virtual bool get_field_repr(const bec::NodeId &node, ColumnId column, std::string &value);
   bool get_field_repr_no_truncate(const bec::NodeId &node, ColumnId column, std::string &value);
+  virtual size_t get_field_reprs(RowId row, size_t row_count, std::vector<std::string> &values);
   virtual bool get_field(const bec::NodeId &node, ColumnId column, ssize_t &value);
   virtual bool get_field(const bec::NodeId &node, ColumnId column, double &value);
   virtual bool get_field(const bec::NodeId &node, ColumnId column, sqlite::variant_t &value);
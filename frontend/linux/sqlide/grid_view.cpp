@@ -411,6 +411,16 @@ bool GridView::on_button_press_event(GdkEventButton *event)
 }
 
 
+bool GridView::on_expose_event(GdkEventExpose *event)
+{
+  // Data may have been changed in the backend without a refresh (e.g. deleted rows), so values
+  // cached for an earlier paint can't be used anymore.
+  if (_view_model)
+    _view_model->invalidate_row_cache();
+  return Gtk::TreeView::on_expose_event(event);
+}
+
+
 static void add_node_for_path(const Gtk::TreeModel::Path &path, std::vector<int> *rows)
 {
   rows->push_back(path[0]);
@@ -83,6 +83,7 @@ class GridView : public Gtk::TreeView
 
     virtual bool on_key_press_event(GdkEventKey *event);
     virtual bool on_button_press_event(GdkEventButton *event);
+    virtual bool on_expose_event(GdkEventExpose *event);
     bool on_focus_out(GdkEventFocus *event, Gtk::CellRenderer *cell, Gtk::Entry *e);
     void on_signal_cursor_changed();
     void on_signal_button_release_event(GdkEventButton *ev);
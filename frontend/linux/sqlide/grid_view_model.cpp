@@ -23,6 +23,9 @@
 #include "custom_renderers.h"
 #include "base/string_utilities.h"
 
+// Number of rows whose display values are fetched from the backend at once.
+#define ROW_CACHE_BLOCK_SIZE 64
+
 GridViewModel::Ref GridViewModel::create(bec::GridModel::Ref model, GridView *view, const std::string &name)
 {
   return Ref(new GridViewModel(model, view, name));
@@ -35,7 +38,11 @@ ListModelWrapper(model.get(), view, name),
 _model(model),
 _view(view),
 _row_numbers_visible(true),
-_text_cell_fixed_height(false)
+_text_cell_fixed_height(false),
+_column_layout_editable(false),
+_column_layout_row_numbers(false),
+_cached_first_row(0),
+_cached_row_count(0)
 {
   _ignore_column_resizes = 0;
   view->set_rules_hint(true); // enable alternating row colors
@@ -75,6 +82,25 @@ int GridViewModel::refresh(bool reset_columns)
 {
   freeze_notify();
   model_changed(bec::NodeId(), -1);
+  invalidate_row_cache();
+
+  if (reset_columns)
+  {
+    // Refreshing a resultset usually gives the same columns again, keep the existing ones then.
+    std::vector<std::pair<bec::GridModel::ColumnType, std::string> > layout;
+    for (int index= 0, count= _model->get_column_count(); index < count; ++index)
+      layout.push_back(std::make_pair(_model->get_column_type(index), _model->get_column_caption(index)));
+
+    if (!_col_index_map.empty() && layout == _column_layout && _column_layout_editable == !_model->is_readonly()
+        && _column_layout_row_numbers == _row_numbers_visible)
+      reset_columns= false;
+    else
+    {
+      _column_layout.swap(layout);
+      _column_layout_editable= !_model->is_readonly();
+      _column_layout_row_numbers= _row_numbers_visible;
+    }
+  }
 
   if (reset_columns)
   {
@@ -217,7 +243,7 @@ Gtk::TreeViewColumn * GridViewModel::add_column(int index, const std::string &na
   }
 
   renderer->floating_point_visible_scale(_model->floating_point_visible_scale());
-  renderer->set_edit_state= sigc::bind(sigc::mem_fun(_model.get(), &::bec::GridModel::set_edited_field), index);
+  renderer->set_edit_state= sigc::bind(sigc::mem_fun(this, &GridViewModel::set_edited_field), index);
   Gtk::TreeViewColumn *treeview_column= renderer->bind_columns(_view, name, index, col, icon);
   if (index >= 0 || index == -2)
   {
@@ -342,8 +368,55 @@ bool GridViewModel::handle_popup_event(GdkEvent* event)
   return false;
 }
 
+/**
+ * Returns the display value of a field from the row cache, fetching the block of rows containing
+ * the field if needed. Returns NULL for rows past the end of the data.
+ */
+const std::string *GridViewModel::cached_field(size_t row, int column) const
+{
+  size_t column_count= _model->get_column_count();
+  if (row < _cached_first_row || row >= _cached_first_row + _cached_row_count)
+  {
+    _cached_first_row= row - row % ROW_CACHE_BLOCK_SIZE;
+    _cached_row_count= _model->get_field_reprs(_cached_first_row, ROW_CACHE_BLOCK_SIZE, _row_cache);
+    if (row >= _cached_first_row + _cached_row_count)
+      return NULL;
+  }
+  return &_row_cache[(row - _cached_first_row) * column_count + column];
+}
+
+void GridViewModel::set_edited_field(int row, int column)
+{
+  // The edited field is shown without truncation.
+  invalidate_row_cache();
+  _model->set_edited_field(row, column);
+}
+
 void GridViewModel::get_value_vfunc(const iterator& iter, int column, Glib::ValueBase& value) const
 {
+  // Text of data columns comes from the row cache, everything else is handled by the wrapper.
+  if (*(_columns.types() + column) == G_TYPE_STRING)
+  {
+    int model_column= _columns.ui2bec(column);
+    if (model_column >= 0 && model_column < (int)_model->get_column_count())
+    {
+      bec::NodeId node= node_for_iter(iter);
+      if (node.is_valid())
+      {
+        const std::string *field= cached_field(node[0], model_column);
+        set_glib_string(value, field ? *field : std::string(), true);
+        before_render(column, &value);
+        return;
+      }
+    }
+  }
+
   ListModelWrapper::get_value_vfunc(iter, column, value);
   before_render(column, &value);
 }
+
+void GridViewModel::set_value_impl(const iterator& row, int column, const Glib::ValueBase& value)
+{
+  ListModelWrapper::set_value_impl(row, column, value);
+  invalidate_row_cache();
+}
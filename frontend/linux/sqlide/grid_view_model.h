@@ -28,6 +28,9 @@ public:
 
   void ignore_column_resizes(bool flag) { if (flag) _ignore_column_resizes++; else _ignore_column_resizes--; }
 
+  // Drops the cached field values, must be called whenever the backend data may have changed.
+  void invalidate_row_cache() { _cached_row_count = 0; }
+
   sigc::slot<void, const int, Glib::ValueBase*>   before_render;
 
   sigc::slot<void, int> column_resized;
@@ -38,6 +41,7 @@ public:
 protected:
   GridViewModel(bec::GridModel::Ref model, GridView *view, const std::string &name);
   virtual void get_value_vfunc(const iterator& iter, int column, Glib::ValueBase& value) const;
+  virtual void set_value_impl(const iterator& row, int column, const Glib::ValueBase& value);
 
 private:
   bec::GridModel::Ref                   _model;
@@ -48,6 +52,21 @@ private:
   bool                                  _row_numbers_visible;
   bool                                  _text_cell_fixed_height;
 
+  // The columns (type and caption) the tree view columns were created for, to reuse them if a refresh
+  // doesn't change them.
+  std::vector<std::pair<bec::GridModel::ColumnType, std::string> > _column_layout;
+  bool                                  _column_layout_editable;
+  bool                                  _column_layout_row_numbers;
+
+  // Display values of a block of rows, fetched from the backend in one go when a cell of the block is
+  // drawn. Cells are drawn row by row for the visible rows only, so a single block is enough.
+  mutable std::vector<std::string>      _row_cache;
+  mutable size_t                        _cached_first_row;
+  mutable size_t                        _cached_row_count;
+
+  const std::string *cached_field(size_t row, int column) const;
+  void set_edited_field(int row, int column);
+
   template <typename ValueTypeTraits>
   Gtk::TreeViewColumn * add_column(int index, const std::string &name, Editable editable, Gtk::TreeModelColumnBase *color_column);
 
@@ -1283,6 +1283,21 @@ obj.sidebar = value
 
    */
   virtual grt::IntegerRef executeScriptAndOutputToGrid(const std::string &sql);
+  /** Method. executes a SQL script file on a separate connection in the background, reading it while executing, and reports the progress in the action log
+  \param path 
+  \param defaultSchema schema to use unless the script selects one, empty for none
+  \param defaultCharset character set to use unless the script sets one, empty for none
+  \param startOffset file offset to start at, 0 or the offset logged by a stopped run
+  \param delimiter delimiter active at the start offset, ; or the delimiter logged by a stopped run
+  \return 
+
+   */
+  virtual grt::IntegerRef executeScriptFile(const std::string &path, const std::string &defaultSchema, const std::string &defaultCharset, ssize_t startOffset, const std::string &delimiter);
+  /** Method. returns the state of the current or last executeScriptFile run
+  \return running, done, total, rate, output, resumeOffset, resumeDelimiter, errorCode and loginError
+
+   */
+  virtual grt::DictRef scriptFileStatus();
 
   ImplData *get_data() const { return _data; }
 
@@ -1328,6 +1343,10 @@ private: // wrapper methods for use by grt
 
   static grt::ValueRef call_executeScriptAndOutputToGrid(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_query_Editor*>(self)->executeScriptAndOutputToGrid(grt::StringRef::cast_from(args[0])); }
 
+  static grt::ValueRef call_executeScriptFile(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_query_Editor*>(self)->executeScriptFile(grt::StringRef::cast_from(args[0]), grt::StringRef::cast_from(args[1]), grt::StringRef::cast_from(args[2]), grt::IntegerRef::cast_from(args[3]), grt::StringRef::cast_from(args[4])); }
+
+  static grt::ValueRef call_scriptFileStatus(grt::internal::Object *self, const grt::BaseListRef &args){ return dynamic_cast<db_query_Editor*>(self)->scriptFileStatus(); }
+
 
 public:
   static void grt_register(grt::GRT *grt)
@@ -1384,6 +1403,8 @@ public:
     meta->bind_method("executeQuery", &db_query_Editor::call_executeQuery);
     meta->bind_method("executeScript", &db_query_Editor::call_executeScript);
     meta->bind_method("executeScriptAndOutputToGrid", &db_query_Editor::call_executeScriptAndOutputToGrid);
+    meta->bind_method("executeScriptFile", &db_query_Editor::call_executeScriptFile);
+    meta->bind_method("scriptFileStatus", &db_query_Editor::call_scriptFileStatus);
   }
 };
 
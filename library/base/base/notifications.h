@@ -28,7 +28,9 @@
 #include <list>
 #include <string>
 #include <map>
+#include <vector>
 #include <boost/function.hpp>
+#include <boost/unordered_map.hpp>
 
 #include "base/common.h"
 
@@ -48,11 +50,25 @@ namespace base
     struct ObserverEntry
     {
       std::string observed_notification;
-      Observer *observer;
+      Observer *observer; // NULL if the entry was removed while a notification was being sent.
+      unsigned int serial; // Registration order, observers are notified in that order.
       //boost::function<void (const std::string &, void*, NotificationInfo &)> callback;
     };
+    typedef std::list<ObserverEntry> ObserverList;
     
-    std::list<ObserverEntry> _observers;
+    // Observers by the name of the notification they observe, observers for all notifications are
+    // registered under an empty name.
+    boost::unordered_map<std::string, ObserverList> _observers;
+
+    // Number of registrations per observer.
+    std::map<Observer*, int> _registrations;
+
+    unsigned int _next_serial;
+    int _send_depth;
+    bool _has_removed_entries;
+
+    void cleanup_removed_entries();
+    static bool registered_earlier(const ObserverEntry *entry1, const ObserverEntry *entry2);
 
   public:
     struct NotificationHelp
@@ -70,6 +86,7 @@ namespace base
     static void set_instance(NotificationCenter *center);
   public:
     static NotificationCenter *get();
+    NotificationCenter();
     virtual ~NotificationCenter();
     
     void register_notification(const std::string &name,
@@ -85,6 +102,9 @@ namespace base
     bool remove_observer(Observer *observer, const std::string &name = "");
     bool is_registered(Observer *observer);
 
+    // Allows senders of frequent notifications to skip building the info if nobody is listening.
+    bool has_observers(const std::string &name);
+
     // notification names MUST start with GN (global notification) for easy grepping
 
     // must be called from main thread only
@@ -25,6 +25,8 @@
 
 #ifndef HAVE_PRECOMPILED_HEADERS
 #include "glib.h"
+#include <string>
+#include <boost/function.hpp>
 #endif
 
 namespace base {
@@ -337,4 +339,37 @@ namespace base {
     bool try_wait();
   };
 
+
+  // A task group runs a number of independent jobs on a pool of worker threads and allows to
+  // wait until all of them have finished. Jobs must not depend on each other's results and must
+  // not call into the UI. Exceptions thrown by a job are collected and the first one is rethrown
+  // (as std::runtime_error) from wait().
+  class BASELIBRARY_PUBLIC_FUNC TaskGroup
+  {
+  public:
+    typedef boost::function<void ()> Job;
+
+    TaskGroup(int max_threads = -1);
+    ~TaskGroup();
+
+    void run(const Job &job);
+    void wait();
+
+    int thread_count() const { return _thread_count; }
+
+    static int default_thread_count();
+
+  private:
+    GThreadPool *_pool;
+    Mutex _lock;
+    Cond _done;
+    int _pending;
+    int _thread_count;
+    std::string _error;
+
+    static void pool_function(gpointer data, gpointer user_data);
+
+    TaskGroup(const TaskGroup &);
+    TaskGroup &operator = (const TaskGroup &);
+  };
 }
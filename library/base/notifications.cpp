@@ -20,6 +20,7 @@
 #include "base/notifications.h"
 #include "base/log.h"
 #include <stdexcept>
+#include <algorithm>
 
 DEFAULT_LOG_DOMAIN(DOMAIN_BASE);
 
@@ -59,14 +60,27 @@ Observer::~Observer()
 
 //--------------------------------------------------------------------------------------------------
 
+NotificationCenter::NotificationCenter()
+  : _next_serial(0), _send_depth(0), _has_removed_entries(false)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
 NotificationCenter::~NotificationCenter()
 {
-  if (_observers.size() > 0)
+  if (!_registrations.empty())
   {
     log_error("Notifications: The following observers are not unregistered:\n");
 
-    for (std::list<ObserverEntry>::iterator next, iter = _observers.begin(); iter != _observers.end(); ++iter)
-      log_error("\tObserver %p, for message: %s\n", iter->observer, iter->observed_notification.c_str());
+    for (boost::unordered_map<std::string, ObserverList>::iterator list = _observers.begin(); list != _observers.end(); ++list)
+    {
+      for (ObserverList::iterator iter = list->second.begin(); iter != list->second.end(); ++iter)
+      {
+        if (iter->observer != NULL)
+          log_error("\tObserver %p, for message: %s\n", iter->observer, iter->observed_notification.c_str());
+      }
+    }
   }
 }
 
@@ -92,7 +106,9 @@ void NotificationCenter::add_observer(Observer *observer, const std::string &nam
   ObserverEntry entry;
   entry.observer = observer;
   entry.observed_notification = name;
-  _observers.push_back(entry);
+  entry.serial = _next_serial++;
+  _observers[name].push_back(entry);
+  _registrations[observer]++;
 }
 
 /*
@@ -109,16 +125,38 @@ void NotificationCenter::add_observer(Observer *observer, boost::function<void (
 bool NotificationCenter::remove_observer(Observer *observer, const std::string &name)
 {
   bool found = false;
-  for (std::list<ObserverEntry>::iterator next, iter = _observers.begin(); iter != _observers.end();)
+  std::map<Observer*, int>::iterator registration = _registrations.find(observer);
+  if (registration != _registrations.end())
   {
-    next = iter;
-    ++next;
-    if (iter->observer == observer && (name.empty() || name == iter->observed_notification))
+    for (boost::unordered_map<std::string, ObserverList>::iterator list = _observers.begin(); list != _observers.end(); ++list)
     {
-      found = true;
-      _observers.erase(iter);
+      if (!name.empty() && list->first != name)
+        continue;
+
+      for (ObserverList::iterator next, iter = list->second.begin(); iter != list->second.end();)
+      {
+        next = iter;
+        ++next;
+        if (iter->observer == observer)
+        {
+          found = true;
+          --registration->second;
+
+          // Entries must stay valid while a notification is being sent, they are removed afterwards.
+          if (_send_depth > 0)
+          {
+            iter->observer = NULL;
+            _has_removed_entries = true;
+          }
+          else
+            list->second.erase(iter);
+        }
+        iter = next;
+      }
     }
-    iter = next;
+
+    if (registration->second <= 0)
+      _registrations.erase(registration);
   }
   if (!found)
     log_debug("remove_observer: %p for %s failed to remove any observers\n", observer, name.c_str());
@@ -127,39 +165,96 @@ bool NotificationCenter::remove_observer(Observer *observer, const std::string &
 
 //--------------------------------------------------------------------------------------------------
 
-bool NotificationCenter::is_registered(Observer *observer)
+void NotificationCenter::cleanup_removed_entries()
 {
-  for (std::list<ObserverEntry>::iterator next, iter = _observers.begin(); iter != _observers.end(); ++iter)
+  for (boost::unordered_map<std::string, ObserverList>::iterator list = _observers.begin(); list != _observers.end(); ++list)
   {
-    if (iter->observer == observer)
-      return true;
+    for (ObserverList::iterator next, iter = list->second.begin(); iter != list->second.end();)
+    {
+      next = iter;
+      ++next;
+      if (iter->observer == NULL)
+        list->second.erase(iter);
+      iter = next;
+    }
   }
+  _has_removed_entries = false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool NotificationCenter::is_registered(Observer *observer)
+{
+  return _registrations.find(observer) != _registrations.end();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool NotificationCenter::has_observers(const std::string &name)
+{
+  boost::unordered_map<std::string, ObserverList>::const_iterator list = _observers.find(name);
+  if (list != _observers.end() && !list->second.empty())
+    return true;
 
-  return false;
+  list = _observers.find("");
+  return list != _observers.end() && !list->second.empty();
 }
 
 //--------------------------------------------------------------------------------------------------
 
+bool NotificationCenter::registered_earlier(const ObserverEntry *entry1, const ObserverEntry *entry2)
+{
+  return entry1->serial < entry2->serial;
+}
+
+
 void NotificationCenter::send(const std::string &name, void *sender, NotificationInfo &info)
 {
-  if (name.substr(0, 2) != "GN")
+  if (name.compare(0, 2, "GN") != 0)
     throw std::invalid_argument("Attempt to send notification with a name that doesn't start with GN\n");
   
   if (_notification_help.find(name) == _notification_help.end())
     log_info("Notification %s is not registered\n", name.c_str());
   
-  // act on a copy of the observer list, because one of them could remove stuff from the list
-  std::list<ObserverEntry> copy(_observers);
-  for (std::list<ObserverEntry>::iterator iter = copy.begin(); iter != copy.end(); ++iter)
+  // Collect the observers first, observers added while sending don't get this notification.
+  std::vector<ObserverEntry*> entries;
+  boost::unordered_map<std::string, ObserverList>::iterator list = _observers.find(name);
+  if (list != _observers.end())
   {
-    if (iter->observed_notification.empty() || iter->observed_notification == name)
+    for (ObserverList::iterator iter = list->second.begin(); iter != list->second.end(); ++iter)
+      entries.push_back(&*iter);
+  }
+  size_t named_count = entries.size();
+
+  list = _observers.find("");
+  if (list != _observers.end())
+  {
+    for (ObserverList::iterator iter = list->second.begin(); iter != list->second.end(); ++iter)
+      entries.push_back(&*iter);
+  }
+
+  // Both lists are in registration order, merge them to keep the order of the notifications.
+  if (named_count > 0 && named_count < entries.size())
+    std::inplace_merge(entries.begin(), entries.begin() + named_count, entries.end(), registered_earlier);
+
+  ++_send_depth;
+  try
+  {
+    for (std::vector<ObserverEntry*>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
     {
-      //if (iter->callback)
-      //  iter->callback(name, sender, info);
-      //else
-      iter->observer->handle_notification(name, sender, info);
+      // An observer removed by an earlier one must not be called anymore.
+      if ((*iter)->observer != NULL)
+        (*iter)->observer->handle_notification(name, sender, info);
     }
   }
+  catch (...)
+  {
+    if (--_send_depth == 0 && _has_removed_entries)
+      cleanup_removed_entries();
+    throw;
+  }
+  if (--_send_depth == 0 && _has_removed_entries)
+    cleanup_removed_entries();
 }
 
 
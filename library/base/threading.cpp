@@ -177,3 +177,105 @@ bool Semaphore::try_wait()
 }
 
 //--------------------------------------------------------------------------------------------------
+
+//----------------- TaskGroup ----------------------------------------------------------------------
+
+/**
+ * Creates a new task group with its own thread pool. If max_threads is <= 0 then as many threads
+ * as there are processors are used.
+ */
+TaskGroup::TaskGroup(int max_threads)
+: _pending(0)
+{
+  threading_init();
+
+  _thread_count = max_threads > 0 ? max_threads : default_thread_count();
+  _pool = g_thread_pool_new(&TaskGroup::pool_function, this, _thread_count, FALSE, NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+TaskGroup::~TaskGroup()
+{
+  // Let scheduled jobs finish, they reference this instance.
+  g_thread_pool_free(_pool, FALSE, TRUE);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int TaskGroup::default_thread_count()
+{
+#if GLIB_CHECK_VERSION(2,36,0)
+  int count = (int)g_get_num_processors();
+#else
+  int count = 2;
+#endif
+  return count > 0 ? count : 1;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Schedules the given job for execution on one of the pool threads. Returns immediately.
+ */
+void TaskGroup::run(const Job &job)
+{
+  {
+    MutexLock lock(_lock);
+    ++_pending;
+  }
+  g_thread_pool_push(_pool, new Job(job), NULL);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Blocks until all jobs scheduled so far have been executed. If one of them failed then the error
+ * is rethrown here (only the first error is kept).
+ */
+void TaskGroup::wait()
+{
+  std::string error;
+  {
+    MutexLock lock(_lock);
+    while (_pending > 0)
+      _done.wait(_lock);
+    error.swap(_error);
+  }
+
+  if (!error.empty())
+    throw std::runtime_error(error);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void TaskGroup::pool_function(gpointer data, gpointer user_data)
+{
+  TaskGroup *self = static_cast<TaskGroup *>(user_data);
+  Job *job = static_cast<Job *>(data);
+
+  std::string error;
+  try
+  {
+    (*job)();
+  }
+  catch (std::exception &exc)
+  {
+    error = exc.what();
+    if (error.empty())
+      error = "Unknown error in worker thread";
+  }
+  catch (...)
+  {
+    error = "Unknown error in worker thread";
+  }
+  delete job;
+
+  MutexLock lock(self->_lock);
+  if (!error.empty() && self->_error.empty())
+    self->_error = error;
+  if (--self->_pending == 0)
+    self->_done.broadcast();
+}
+
+//--------------------------------------------------------------------------------------------------
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "base/notifications.h"
+#include "wb_helpers.h"
+
+TEST_MODULE(notifications_test, "Base library notification center");
+
+using namespace base;
+
+// Records the notifications it gets and optionally removes another observer when notified.
+struct TestObserver : public Observer
+{
+  std::string id;
+  std::string *log;
+  NotificationCenter *center;
+  Observer *to_remove;
+
+  TestObserver(const std::string &aid, std::string *alog, NotificationCenter *acenter)
+    : id(aid), log(alog), center(acenter), to_remove(NULL)
+  {
+  }
+
+  virtual void handle_notification(const std::string &name, void *sender, NotificationInfo &info)
+  {
+    *log += id;
+    if (to_remove != NULL)
+      center->remove_observer(to_remove);
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+// Observers for a specific notification and for all notifications are called in registration order.
+TEST_FUNCTION(5)
+{
+  NotificationCenter center;
+  std::string log;
+  TestObserver a("a", &log, &center), b("b", &log, &center), c("c", &log, &center);
+
+  center.add_observer(&a, "GNTestOne");
+  center.add_observer(&b);
+  center.add_observer(&c, "GNTestOne");
+  center.add_observer(&c, "GNTestTwo");
+
+  ensure("Observers for GNTestOne", center.has_observers("GNTestOne"));
+  ensure("Observers for other notifications", center.has_observers("GNTestThree"));
+
+  center.send("GNTestOne", NULL);
+  ensure_equals("GNTestOne", log, "abc");
+
+  log.clear();
+  center.send("GNTestTwo", NULL);
+  ensure_equals("GNTestTwo", log, "bc");
+
+  ensure("Removing b", center.remove_observer(&b));
+  ensure("b unregistered", !center.is_registered(&b));
+  ensure("No observers for GNTestThree", !center.has_observers("GNTestThree"));
+
+  ensure("Removing c for GNTestOne", center.remove_observer(&c, "GNTestOne"));
+  ensure("c still registered", center.is_registered(&c));
+
+  center.remove_observer(&a);
+  center.remove_observer(&c);
+  ensure("c unregistered", !center.is_registered(&c));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// An observer removed while a notification is sent is not called anymore.
+TEST_FUNCTION(10)
+{
+  NotificationCenter center;
+  std::string log;
+  TestObserver a("a", &log, &center), b("b", &log, &center), c("c", &log, &center);
+
+  a.to_remove = &b;
+  center.add_observer(&a, "GNTest");
+  center.add_observer(&b);
+  center.add_observer(&c, "GNTest");
+
+  center.send("GNTest", NULL);
+  ensure_equals("Notified observers", log, "ac");
+  ensure("b unregistered", !center.is_registered(&b));
+
+  log.clear();
+  a.to_remove = &a;
+  center.send("GNTest", NULL);
+  center.send("GNTest", NULL);
+  ensure_equals("Observer removing itself", log, "acc");
+
+  center.remove_observer(&c);
+}
+
+END_TESTS
@@ -18,6 +18,7 @@
  */
 
 #include "base/threading.h"
+#include <boost/bind.hpp>
 #include "wb_helpers.h"
 
 // Would be good if we could determine the order of how test modules are run.
@@ -169,6 +170,50 @@ TEST_FUNCTION(20)
   }
 }
 
+//--------------------------------------------------------------------------------------------------
+
+static void add_to_counter(int value)
+{
+  g_atomic_int_add(&counter, value);
+}
+
+static void failing_job()
+{
+  throw std::runtime_error("job failed");
+}
+
+/**
+ * Task group: all jobs must have run when wait() returns and errors must be passed on to the caller.
+ */
+TEST_FUNCTION(30)
+{
+  counter = 0;
+  base::TaskGroup group(4);
+  ensure_equals("Thread count", group.thread_count(), 4);
+
+  for (int i = 1; i <= 100; ++i)
+    group.run(boost::bind(add_to_counter, i));
+  group.wait();
+  ensure_equals("All jobs executed", counter, 5050);
+
+  group.run(failing_job);
+  group.run(boost::bind(add_to_counter, 1));
+  try
+  {
+    group.wait();
+    fail("Exception expected");
+  }
+  catch (std::runtime_error &exc)
+  {
+    ensure_equals("Error message", std::string(exc.what()), "job failed");
+  }
+  ensure_equals("Other jobs are not affected", counter, 5051);
+
+  // The group is usable again after an error.
+  group.run(boost::bind(add_to_counter, 1));
+  group.wait();
+  ensure_equals("Group reusable", counter, 5052);
+}
 
 END_TESTS;
 
@@ -4,6 +4,7 @@
 
 #include "driver_manager.h"
 #include "sql_batch_exec.h"
+#include "sql_script_reader.h"
 
 #include <cppconn/connection.h>
 #include <cppconn/driver.h>
@@ -18,16 +18,22 @@
  */
 
 #include "sql_batch_exec.h"
+#include "sql_script_reader.h"
 #include <cppconn/exception.h>
 #include <cppconn/resultset.h>
+#include <glib.h>
 #include <memory>
 
+// Minimal time in seconds between two progress reports while executing a script file.
+#define SCRIPT_FILE_PROGRESS_INTERVAL 0.25
+
 namespace sql
 {
 
 SqlBatchExec::SqlBatchExec()
 :
-_stop_on_error(true)
+_stop_on_error(true),
+_resume_offset(0)
 {
 }
 
@@ -89,4 +95,81 @@ void SqlBatchExec::exec_sql_script(sql::Statement *stmt, std::list<std::string>
 }
 
 
+long SqlBatchExec::operator()(sql::Statement *stmt, SqlScriptReader &reader)
+{
+  _batch_exec_success_count= 0;
+  _batch_exec_err_count= 0;
+  _sql_log.clear();
+  _resume_offset= reader.start_offset();
+  _resume_delimiter= reader.delimiter();
+
+  GTimer *timer= g_timer_new();
+  double last_report= 0;
+  bool cancelled= false;
+  std::string statement;
+  try
+  {
+    while (!cancelled && reader.next(statement))
+    {
+      _resume_offset= reader.statement_offset();
+      _resume_delimiter= reader.delimiter();
+      try
+      {
+        if (stmt->execute(statement))
+          std::auto_ptr<sql::ResultSet> rs(stmt->getResultSet());
+        ++_batch_exec_success_count;
+      }
+      catch (SQLException &e)
+      {
+        ++_batch_exec_err_count;
+        if (_error_cb.empty())
+          throw;
+        _error_cb(e.getErrorCode(), e.what(), statement);
+      }
+
+      if (_batch_exec_err_count && _stop_on_error)
+        break;
+      _resume_offset= reader.offset();
+
+      double elapsed= g_timer_elapsed(timer, NULL);
+      if (elapsed - last_report >= SCRIPT_FILE_PROGRESS_INTERVAL)
+      {
+        last_report= elapsed;
+        report_file_progress(reader, elapsed, cancelled);
+      }
+    }
+    if (!cancelled)
+      report_file_progress(reader, g_timer_elapsed(timer, NULL), cancelled);
+  }
+  catch (...)
+  {
+    g_timer_destroy(timer);
+    throw;
+  }
+  g_timer_destroy(timer);
+
+  if(_batch_exec_stat_cb)
+    _batch_exec_stat_cb(_batch_exec_success_count, _batch_exec_err_count);
+
+  return _batch_exec_err_count;
+}
+
+
+void SqlBatchExec::report_file_progress(SqlScriptReader &reader, double elapsed, bool &cancelled)
+{
+  boost::int64_t done= reader.offset();
+  boost::int64_t total= reader.file_size();
+
+  if (_batch_exec_progress_cb)
+    _batch_exec_progress_cb(total > 0 ? (float)((double)done / total) : 1.f);
+
+  if (_script_file_progress_cb)
+  {
+    double rate= elapsed > 0 ? (done - reader.start_offset()) / elapsed : 0;
+    if (_script_file_progress_cb(done, total, rate) != 0)
+      cancelled= true;
+  }
+}
+
+
 } // namespace sql
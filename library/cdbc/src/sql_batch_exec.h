@@ -8,11 +8,14 @@
 #include <list>
 #include <string>
 #include <boost/function.hpp>
+#include <boost/cstdint.hpp>
 
 
 namespace sql
 {
 
+class SqlScriptReader;
+
 
 class CPPDBC_PUBLIC_FUNC SqlBatchExec
 {
@@ -21,6 +24,8 @@ public:
 
 public:
   long operator()(sql::Statement *stmt, std::list<std::string> &statements);
+  // Executes the statements of a script file while reading it. They are not added to the sql log.
+  long operator()(sql::Statement *stmt, SqlScriptReader &reader);
 private:
   void exec_sql_script(sql::Statement *stmt, std::list<std::string> &statements, long &batch_exec_err_count);
 
@@ -28,14 +33,18 @@ public:
   typedef boost::function<int (long long, const std::string&, const std::string&)> Error_cb;
   typedef boost::function<int (float)> Batch_exec_progress_cb;
   typedef boost::function<int (long, long)> Batch_exec_stat_cb;
+  // Parameters: bytes processed, file size, bytes/sec. Returning non-zero stops the execution.
+  typedef boost::function<int (boost::int64_t, boost::int64_t, double)> Script_file_progress_cb;
 
   Error_cb _error_cb;
   Batch_exec_progress_cb _batch_exec_progress_cb;
   Batch_exec_stat_cb _batch_exec_stat_cb;
+  Script_file_progress_cb _script_file_progress_cb;
 
   void error_cb(const Error_cb &cb) { _error_cb= cb; };
   void batch_exec_progress_cb(const Batch_exec_progress_cb &cb) { _batch_exec_progress_cb= cb; };
   void batch_exec_stat_cb(const Batch_exec_stat_cb &cb) { _batch_exec_stat_cb= cb; };
+  void script_file_progress_cb(const Script_file_progress_cb &cb) { _script_file_progress_cb= cb; };
 
 private:
   long _batch_exec_success_count;
@@ -59,6 +68,17 @@ public:
   const std::list<std::string> & sql_log() const { return _sql_log; }
 private:
   std::list<std::string> _sql_log;
+
+public:
+  // Where the last script file execution stopped: at the failed statement if it stopped on an error,
+  // otherwise after the last executed statement. Pass both to a new SqlScriptReader to continue.
+  boost::int64_t resume_offset() const { return _resume_offset; }
+  const std::string & resume_delimiter() const { return _resume_delimiter; }
+private:
+  void report_file_progress(SqlScriptReader &reader, double elapsed, bool &cancelled);
+
+  boost::int64_t _resume_offset;
+  std::string _resume_delimiter;
 };
 
 
@@ -0,0 +1,307 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "sql_script_reader.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace sql
+{
+
+static bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+
+SqlScriptReader::SqlScriptReader(const std::string &path, boost::int64_t start_offset, const std::string &delimiter,
+  size_t chunk_size)
+:
+_path(path),
+_chunk_size(std::max(chunk_size, (size_t)16)),
+_file_size(0),
+_start_offset(start_offset),
+_statement_offset(start_offset),
+_eof(false),
+_buffer_offset(start_offset),
+_head(0),
+_tail(0),
+_delimiter(delimiter.empty() ? ";" : delimiter),
+_state(Normal),
+_quote(0),
+_have_content(false)
+{
+  _file.open(path.c_str(), std::ios::in | std::ios::binary);
+  if (!_file.is_open())
+    throw std::runtime_error("Could not open SQL script file " + path);
+
+  _file.seekg(0, std::ios::end);
+  _file_size= (boost::int64_t)_file.tellg();
+  if (start_offset < 0 || start_offset > _file_size)
+    throw std::runtime_error("Invalid start position for SQL script file " + path);
+  _file.seekg((std::streamoff)start_offset, std::ios::beg);
+}
+
+
+bool SqlScriptReader::next(std::string &statement)
+{
+  while (!scan(statement))
+  {
+    if (_eof)
+    {
+      // Whatever is left is the last statement, which has no delimiter.
+      size_t start= _head;
+      size_t end= _buffer.size();
+      bool have_content= _have_content;
+
+      _head= _tail= end;
+      _state= Normal;
+      _have_content= false;
+
+      while (start < end && is_space(_buffer[start]))
+        ++start;
+      while (end > start && is_space(_buffer[end - 1]))
+        --end;
+      if (!have_content || start == end)
+        return false;
+
+      statement.assign(_buffer, start, end - start);
+      _statement_offset= _buffer_offset + (boost::int64_t)start;
+      return true;
+    }
+    read_chunk();
+  }
+  return true;
+}
+
+
+void SqlScriptReader::read_chunk()
+{
+  // Text before the current statement has been returned already and is not needed anymore.
+  if (_head > 0)
+  {
+    _buffer.erase(0, _head);
+    _buffer_offset+= _head;
+    _tail-= _head;
+    _head= 0;
+  }
+
+  size_t size= _buffer.size();
+  _buffer.resize(size + _chunk_size);
+  _file.read(&_buffer[size], (std::streamsize)_chunk_size);
+  size_t count= (size_t)_file.gcount();
+  _buffer.resize(size + count);
+  if (count < _chunk_size)
+    _eof= true;
+}
+
+
+// Checks if count chars starting at the scan position can be looked at. At the end of the file
+// missing chars read as 0 (see char_at()).
+bool SqlScriptReader::available(size_t count) const
+{
+  return _eof || _tail + count <= _buffer.size();
+}
+
+
+char SqlScriptReader::char_at(size_t index) const
+{
+  return index < _buffer.size() ? _buffer[index] : 0;
+}
+
+
+// Continues splitting at the scan position. Returns false if more text is needed for the next
+// statement. The scan state is only changed for completely examined text, so scanning can be
+// continued after more text was read.
+bool SqlScriptReader::scan(std::string &statement)
+{
+  while (_tail < _buffer.size())
+  {
+    char c= _buffer[_tail];
+    switch (_state)
+    {
+    case Quoted:
+      if (c == '\\')
+      {
+        // Skip any escaped character too.
+        if (!available(2))
+          return false;
+        _tail+= 2;
+      }
+      else
+      {
+        if (c == _quote)
+          _state= Normal;
+        _tail++;
+      }
+      continue;
+
+    case LineComment:
+      _tail++;
+      if (c == '\n')
+      {
+        _state= Normal;
+        if (!_have_content)
+          _head= _tail; // Skip over the comment.
+      }
+      continue;
+
+    case BlockComment:
+      if (c == '*')
+      {
+        if (!available(2))
+          return false;
+        if (char_at(_tail + 1) == '/')
+        {
+          _tail+= 2;
+          _state= Normal;
+          if (!_have_content)
+            _head= _tail;
+          continue;
+        }
+      }
+      _tail++;
+      continue;
+
+    case Normal:
+      break;
+    }
+
+    if (c == _delimiter[0])
+    {
+      if (!available(_delimiter.size()))
+        return false;
+      if (_buffer.compare(_tail, _delimiter.size(), _delimiter) == 0)
+      {
+        size_t start= _head;
+        size_t end= _tail;
+        bool have_content= _have_content;
+
+        _tail+= _delimiter.size();
+        _head= _tail;
+        _have_content= false;
+
+        while (start < end && is_space(_buffer[start]))
+          ++start;
+        while (end > start && is_space(_buffer[end - 1]))
+          --end;
+        if (have_content && start < end)
+        {
+          statement.assign(_buffer, start, end - start);
+          _statement_offset= _buffer_offset + (boost::int64_t)start;
+          return true;
+        }
+        continue;
+      }
+    }
+
+    switch (c)
+    {
+    case '/': // Possible multi line comment or hidden (conditional) command.
+      if (!available(3))
+        return false;
+      if (char_at(_tail + 1) == '*')
+      {
+        // Hidden commands are kept.
+        if (char_at(_tail + 2) == '!')
+          _have_content= true;
+        _state= BlockComment;
+        _tail+= 2;
+        continue;
+      }
+      break;
+
+    case '-': // Possible single line comment.
+    {
+      if (!available(3))
+        return false;
+      char next= char_at(_tail + 2);
+      if (char_at(_tail + 1) == '-' && (next == 0 || is_space(next)))
+      {
+        _state= LineComment;
+        _tail+= 2;
+        continue;
+      }
+      break;
+    }
+
+    case '#': // MySQL single line comment.
+      _state= LineComment;
+      _tail++;
+      continue;
+
+    case '"':
+    case '\'':
+    case '`': // Quoted string/id.
+      _have_content= true;
+      _state= Quoted;
+      _quote= c;
+      _tail++;
+      continue;
+
+    case 'd':
+    case 'D':
+      // Possible DELIMITER command, which must be the first thing in a statement.
+      if (!_have_content)
+      {
+        static const char keyword[]= "delimiter";
+        if (!available(10))
+          return false;
+
+        size_t i= 1;
+        while (i < 9 && (char_at(_tail + i) | 0x20) == keyword[i])
+          ++i;
+        char next= char_at(_tail + 9);
+        if (i == 9 && (next == ' ' || next == '\t'))
+        {
+          // The new delimiter is everything until the end of the line.
+          size_t line_end= _buffer.find('\n', _tail);
+          if (line_end == std::string::npos)
+          {
+            if (!_eof)
+              return false;
+            line_end= _buffer.size();
+          }
+
+          size_t start= _tail + 10;
+          size_t end= line_end;
+          while (start < end && is_space(_buffer[start]))
+            ++start;
+          while (end > start && is_space(_buffer[end - 1]))
+            --end;
+          if (start < end)
+            _delimiter= _buffer.substr(start, end - start);
+
+          _tail= std::min(line_end + 1, _buffer.size());
+          _head= _tail;
+          continue;
+        }
+      }
+      break;
+    }
+
+    if ((unsigned char)c > ' ')
+      _have_content= true;
+    _tail++;
+  }
+  return false;
+}
+
+
+} // namespace sql
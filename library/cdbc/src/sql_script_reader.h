@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#ifndef _SQL_SCRIPT_READER_H_
+#define _SQL_SCRIPT_READER_H_
+
+
+#include "cppdbc_public_interface.h"
+#include <fstream>
+#include <string>
+#include <boost/cstdint.hpp>
+
+
+namespace sql
+{
+
+
+/**
+ * Reads an SQL script file in chunks and splits it into statements while reading, so that scripts of
+ * any size can be executed with bounded memory (the current statement plus one chunk).
+ *
+ * Statement borders are found like in MySQLParserServices::determineStatementRanges: quoted text,
+ * comments and DELIMITER commands (at the start of a statement) are taken into account. Leading
+ * comments are removed from the returned statements.
+ *
+ * Reading can start at any offset returned by statement_offset(), together with the delimiter that
+ * was active then, which allows resuming a script after a failed statement.
+ */
+class CPPDBC_PUBLIC_FUNC SqlScriptReader
+{
+public:
+  SqlScriptReader(const std::string &path, boost::int64_t start_offset = 0, const std::string &delimiter = ";",
+    size_t chunk_size = 4 * 1024 * 1024);
+
+  // Returns false if there are no more statements.
+  bool next(std::string &statement);
+
+  // File offset of the last statement returned by next().
+  boost::int64_t statement_offset() const { return _statement_offset; }
+
+  // File offset up to which the file has been split into statements.
+  boost::int64_t offset() const { return _buffer_offset + (boost::int64_t)_head; }
+
+  boost::int64_t start_offset() const { return _start_offset; }
+  boost::int64_t file_size() const { return _file_size; }
+
+  const std::string &delimiter() const { return _delimiter; }
+  const std::string &path() const { return _path; }
+
+private:
+  enum State { Normal, LineComment, BlockComment, Quoted };
+
+  bool scan(std::string &statement);
+  bool available(size_t count) const;
+  char char_at(size_t index) const;
+  void read_chunk();
+
+  std::string _path;
+  std::ifstream _file;
+  size_t _chunk_size;
+  boost::int64_t _file_size;
+  boost::int64_t _start_offset;
+  boost::int64_t _statement_offset;
+  bool _eof;
+
+  std::string _buffer;            // Text not yet returned as statements.
+  boost::int64_t _buffer_offset;  // File offset of the first char in _buffer.
+  size_t _head;                   // Start of the current statement in _buffer.
+  size_t _tail;                   // Scan position in _buffer.
+
+  std::string _delimiter;
+  State _state;
+  char _quote;
+  bool _have_content;
+};
+
+
+} // namespace sql
+
+
+#endif // _SQL_SCRIPT_READER_H_
@@ -0,0 +1,100 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "wb_helpers.h"
+#include "cppdbc.h"
+
+#include <glib/gstdio.h>
+
+#define SCRIPT_FILE "sql_script_reader_test.sql"
+
+static const char *test_script=
+  "-- Leading comment\n"
+  "CREATE TABLE t1 (id int);\n"
+  "/* block comment */ INSERT INTO t1 VALUES ('a;b', \"c\\\";d\"); # trailing comment\n"
+  "DELIMITER $$\n"
+  "CREATE PROCEDURE p1() BEGIN SELECT 1; SELECT `x$$y` FROM t1; END$$\n"
+  "DELIMITER ;\n"
+  "/*!40101 SET NAMES utf8 */;\n"
+  ";;\n"
+  "SELECT 2";
+
+BEGIN_TEST_DATA_CLASS(sql_script_reader_test)
+public:
+  std::vector<std::string> expected;
+
+  TEST_DATA_CONSTRUCTOR(sql_script_reader_test)
+  {
+    expected.push_back("CREATE TABLE t1 (id int)");
+    expected.push_back("INSERT INTO t1 VALUES ('a;b', \"c\\\";d\")");
+    expected.push_back("CREATE PROCEDURE p1() BEGIN SELECT 1; SELECT `x$$y` FROM t1; END");
+    expected.push_back("/*!40101 SET NAMES utf8 */");
+    expected.push_back("SELECT 2");
+
+    ensure("Script file written", g_file_set_contents(SCRIPT_FILE, test_script, -1, NULL) != 0);
+  }
+
+  TEST_DATA_DESTRUCTOR(sql_script_reader_test)
+  {
+    g_remove(SCRIPT_FILE);
+  }
+
+END_TEST_DATA_CLASS
+
+TEST_MODULE(sql_script_reader_test, "SQL script reader");
+
+// Statements must be the same no matter where the chunk borders are.
+TEST_FUNCTION(5)
+{
+  for (size_t chunk_size= 16; chunk_size < 200; chunk_size+= 5)
+  {
+    sql::SqlScriptReader reader(SCRIPT_FILE, 0, ";", chunk_size);
+    std::string statement;
+    size_t count= 0;
+    while (reader.next(statement))
+    {
+      ensure("Statement count", count < expected.size());
+      ensure_equals(base::strfmt("Statement %i with chunk size %i", (int)count, (int)chunk_size), statement, expected[count]);
+      ++count;
+    }
+    ensure_equals("Statement count", count, expected.size());
+    ensure("Whole file read", reader.offset() == reader.file_size());
+  }
+}
+
+// Reading can be resumed at any statement, with the delimiter in effect there.
+TEST_FUNCTION(10)
+{
+  sql::SqlScriptReader reader(SCRIPT_FILE, 0, ";", 16);
+  std::string statement;
+  for (size_t i= 0; i < 3; ++i)
+    ensure("Statement read", reader.next(statement));
+  ensure_equals("Delimiter", reader.delimiter(), "$$");
+  ensure_equals("Statement", statement, expected[2]);
+
+  sql::SqlScriptReader resumed(SCRIPT_FILE, reader.statement_offset(), reader.delimiter(), 16);
+  for (size_t i= 2; i < expected.size(); ++i)
+  {
+    ensure("Resumed statement read", resumed.next(statement));
+    ensure_equals("Resumed statement", statement, expected[i]);
+  }
+  ensure("No more statements", !resumed.next(statement));
+}
+
+END_TESTS
@@ -284,6 +284,7 @@ CodeEditor::CodeEditor(void *host)
   _find_panel = NULL;
   _scroll_on_resize = true;
   _auto_indent = false;
+  _large_file_mode = false;
 
   setup();
 }
@@ -900,6 +901,24 @@ size_t CodeEditor::line_from_position(size_t position)
 
 //--------------------------------------------------------------------------------------------------
 
+void CodeEditor::get_visible_lines(size_t &first, size_t &last)
+{
+  // Scintilla counts display lines here, which differ from document lines if text is folded.
+  sptr_t first_visible = _code_editor_impl->send_editor(this, SCI_GETFIRSTVISIBLELINE, 0, 0);
+  sptr_t lines_on_screen = _code_editor_impl->send_editor(this, SCI_LINESONSCREEN, 0, 0);
+
+  first = _code_editor_impl->send_editor(this, SCI_DOCLINEFROMVISIBLE, first_visible, 0);
+  last = _code_editor_impl->send_editor(this, SCI_DOCLINEFROMVISIBLE, first_visible + lines_on_screen, 0);
+
+  size_t count = _code_editor_impl->send_editor(this, SCI_GETLINECOUNT, 0, 0);
+  if (last >= count)
+    last = count > 0 ? count - 1 : 0;
+  if (first > last)
+    first = last;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void CodeEditor::set_font(const std::string& fontDescription)
 {
   // Set this font for all styles.
@@ -1018,18 +1037,11 @@ void CodeEditor::on_notify(SCNotification* notification)
     break;
 
   case SCN_UPDATEUI:
-    switch (notification->updated)
-    {
-    case SC_UPDATE_CONTENT:   // Contents, styling or markers have been changed.
-      break;
-    case SC_UPDATE_SELECTION: // Selection has been changed or the caret moved.
+    // The update flags can be combined, e.g. typing can move the caret and scroll at the same time.
+    if ((notification->updated & SC_UPDATE_SELECTION) != 0) // Selection has been changed or the caret moved.
       NotificationCenter::get()->send("GNTextSelectionChanged", this);
-      break;
-    case SC_UPDATE_V_SCROLL:  // Scrolled vertically.
-      break;
-    case SC_UPDATE_H_SCROLL:  // Scrolled horizontally.
-      break;
-    }
+    if ((notification->updated & SC_UPDATE_V_SCROLL) != 0)  // Scrolled vertically.
+      _visible_lines_changed_event();
     break;
 
   case SCN_CHARADDED:
@@ -1078,9 +1090,24 @@ void CodeEditor::on_command(int command)
 
 void CodeEditor::set_features(CodeEditorFeature features, bool flag)
 {
-  if ((features & mforms::FeatureWrapText) != 0)
+  if ((features & mforms::FeatureLargeFile) != 0)
   {
+    // Wrapping lays out the entire text and folding makes the lexer compute fold levels, both of which
+    // make huge documents crawl. Also cache only the layout of the visible page (instead of all lines).
+    _large_file_mode = flag;
     if (flag)
+    {
+      _code_editor_impl->send_editor(this, SCI_SETWRAPMODE, SC_WRAP_NONE, 0);
+      _code_editor_impl->send_editor(this, SCI_SETPROPERTY, (uptr_t)"fold", (sptr_t)"0");
+      _code_editor_impl->send_editor(this, SCI_SETLAYOUTCACHE, SC_CACHE_PAGE, 0);
+    }
+    else
+      _code_editor_impl->send_editor(this, SCI_SETLAYOUTCACHE, SC_CACHE_CARET, 0);
+  }
+
+  if ((features & mforms::FeatureWrapText) != 0)
+  {
+    if (flag && !_large_file_mode)
       _code_editor_impl->send_editor(this, SCI_SETWRAPMODE, SC_WRAP_WORD, 0);
     else
       _code_editor_impl->send_editor(this, SCI_SETWRAPMODE, SC_WRAP_NONE, 0);
@@ -1126,7 +1153,7 @@ void CodeEditor::set_features(CodeEditorFeature features, bool flag)
     _scroll_on_resize = true;
 
   if ((features & mforms::FeatureFolding) != 0)
-    _code_editor_impl->send_editor(this, SCI_SETPROPERTY, (uptr_t)"fold", flag ? (sptr_t)"1" : (sptr_t)"0");
+    _code_editor_impl->send_editor(this, SCI_SETPROPERTY, (uptr_t)"fold", flag && !_large_file_mode ? (sptr_t)"1" : (sptr_t)"0");
 
   if ((features & mforms::FeatureAutoIndent) != 0)
     _auto_indent = true;
@@ -1141,12 +1168,8 @@ void CodeEditor::toggle_features(CodeEditorFeature features)
   // set_features we do it internally with this toggle_features function.
   
   if ((features & mforms::FeatureWrapText) != 0)
-  {
-    if (_code_editor_impl->send_editor(this, SCI_GETWRAPMODE, 0, 0) == SC_WRAP_NONE)
-      _code_editor_impl->send_editor(this, SCI_SETWRAPMODE, SC_WRAP_WORD, 0);
-    else
-      _code_editor_impl->send_editor(this, SCI_SETWRAPMODE, SC_WRAP_NONE, 0);
-  }
+    set_features(mforms::FeatureWrapText,
+      _code_editor_impl->send_editor(this, SCI_GETWRAPMODE, 0, 0) == SC_WRAP_NONE);
 
   if ((features & mforms::FeatureGutter) != 0)
       set_features(mforms::FeatureGutter,
@@ -1171,13 +1194,14 @@ void CodeEditor::toggle_features(CodeEditorFeature features)
     _scroll_on_resize = !_scroll_on_resize;
 
   if ((features & mforms::FeatureFolding) != 0)
-  {
-    bool folding_enabled = _code_editor_impl->send_editor(this, SCI_GETPROPERTYINT, (uptr_t)"fold", 0) != 0;
-    _code_editor_impl->send_editor(this, SCI_SETPROPERTY, (uptr_t)"fold", folding_enabled ? (sptr_t)"0" : (sptr_t)"1");
-  }
+    set_features(mforms::FeatureFolding,
+      _code_editor_impl->send_editor(this, SCI_GETPROPERTYINT, (uptr_t)"fold", 0) == 0);
 
   if ((features & mforms::FeatureAutoIndent) != 0)
     _auto_indent = !_auto_indent;
+
+  if ((features & mforms::FeatureLargeFile) != 0)
+    set_features(mforms::FeatureLargeFile, !_large_file_mode);
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -1743,6 +1767,7 @@ void CodeEditor::resize()
 {
   if (_scroll_on_resize)
     _code_editor_impl->send_editor(this, SCI_SCROLLCARET, 0, 0);
+  _visible_lines_changed_event();
 }
 
 //--------------------------------------------------------------------------------------------------
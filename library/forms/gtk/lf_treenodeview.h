@@ -20,6 +20,7 @@
 #define _LF_TREENODEVIEW_H_
 
 #include <mforms/mforms.h>
+#include <boost/shared_ptr.hpp>
 
 #include "lf_view.h"
 #include "base/string_utilities.h"
@@ -65,6 +66,10 @@ struct TreeNodeDataRef
   }
 };
 
+// The skeletons for the children of a node that were not created yet (see TreeNodeCollectionSkeleton::lazy_children).
+// Shared by all nodes of the collection they were added with.
+typedef boost::shared_ptr<const std::vector<TreeNodeSkeleton> > LazyChildrenRef;
+
 class CustomTreeStore : public Gtk::TreeStore {
 public:
   CustomTreeStore(const Gtk::TreeModelColumnRecord& columns);
@@ -116,6 +121,8 @@ public:
 
   virtual void add_children_from_skeletons(const std::vector<Gtk::TreeIter>& parents, const std::vector<TreeNodeSkeleton>& children);
 
+  void create_lazy_children(const Gtk::TreeIter &parent) const;
+
   virtual void remove_from_parent();
 
   virtual TreeNodeRef get_child(int index) const;
@@ -285,6 +292,7 @@ private:
     std::vector<Gtk::TreeModelColumnBase*> columns;
     Gtk::TreeModelColumn<std::string>     _tag_column;
     Gtk::TreeModelColumn<TreeNodeDataRef>   _data_column;
+    Gtk::TreeModelColumn<LazyChildrenRef>   _lazy_children_column;
     std::vector<int> column_value_index;
     std::vector<int> column_attr_index;
 
@@ -299,8 +307,10 @@ private:
     virtual ~ColumnRecord();
     void add_tag_column();
     void add_data_column();
+    void add_lazy_children_column();
     Gtk::TreeModelColumn<std::string>& tag_column();
     Gtk::TreeModelColumn<TreeNodeDataRef>& data_column();
+    Gtk::TreeModelColumn<LazyChildrenRef>& lazy_children_column();
     int add_string(Gtk::TreeView *tree, const std::string &title, bool editable, bool attr, bool with_icon, bool align_right = false);
     int add_integer(Gtk::TreeView *tree, const std::string &title, bool editable, bool attr);
     int add_long_integer(Gtk::TreeView *tree, const std::string &title, bool editable, bool attr);
@@ -347,6 +357,16 @@ private:
 
   mforms::TreeNodeRef _root_node;
 
+  // State saved while the model is detached from the view for a large update.
+  int _detach_count;
+  Glib::RefPtr<Gtk::TreeModel> _detached_model;
+  std::vector<Gtk::TreeRowReference> _detached_expanded_rows;
+  std::vector<Gtk::TreeRowReference> _detached_selection;
+  double _detached_scroll_position;
+  bool _restoring_expansion;
+
+  void remember_expanded_row(Gtk::TreeView *tree, const Gtk::TreePath &path);
+
   mforms::TreeNodeRef find_node_at_row(const Gtk::TreeModel::Children &trow, int &c, int row);
 
   Gtk::TreeView *tree_view() { return &_tree; }
@@ -413,6 +433,9 @@ private:
 
   void header_clicked(Gtk::TreeModelColumnBase*, Gtk::TreeViewColumn*);
 
+  void detach_model();
+  void attach_model();
+
 
   virtual void set_back_color(const std::string &color);
 
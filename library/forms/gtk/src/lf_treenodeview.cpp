@@ -32,8 +32,8 @@ DEFAULT_LOG_DOMAIN("mforms.linux");
 namespace mforms {
 namespace gtk {
 
-
-
+// Collections with at least this many nodes are added while the model is detached from the view.
+#define DETACHED_UPDATE_THRESHOLD 100
 
 static int count_rows_in_node(Gtk::TreeView *tree, const Gtk::TreeIter &iter)
 {
@@ -213,9 +213,15 @@ std::vector<mforms::TreeNodeRef> RootTreeNodeImpl::add_node_collection(const Tre
   // If the nodes have children, also allocates enough room
   // For the created iters
   bool sub_items = !nodes.children.empty();
-  if (sub_items)
+  bool lazy_items = sub_items && nodes.lazy_children;
+  if (sub_items && !lazy_items)
     added_iters.reserve(nodes.captions.size());
 
+  // Lazy children are created from a copy of the skeletons shared by all new nodes
+  LazyChildrenRef lazy_children;
+  if (lazy_items)
+    lazy_children = LazyChildrenRef(new std::vector<TreeNodeSkeleton>(nodes.children));
+
   Glib::RefPtr<Gtk::TreeStore> store(_treeview->tree_store());
   Gtk::TreeIter new_iter;
 
@@ -228,6 +234,12 @@ std::vector<mforms::TreeNodeRef> RootTreeNodeImpl::add_node_collection(const Tre
 
   int index_for_string = _treeview->index_for_column(0);
   int index_for_icon   = index_for_string - 1;
+  Gtk::TreeModelColumn<LazyChildrenRef>& lazy_column = _treeview->_columns.lazy_children_column();
+
+  // Having the view process every single inserted row is much slower than rebuilding it once
+  bool detached = nodes.captions.size() >= DETACHED_UPDATE_THRESHOLD;
+  if (detached)
+    _treeview->detach_model();
 
   store->freeze_notify();
 
@@ -256,19 +268,28 @@ std::vector<mforms::TreeNodeRef> RootTreeNodeImpl::add_node_collection(const Tre
     added_nodes.push_back(ref_from_iter(new_iter));
 
     // If there are sub items the iter needs to be stored so
-    // it gets the childs added
-    if (sub_items)
+    // it gets the childs added. Lazy ones only get an empty placeholder
+    // child, so the node can be expanded
+    if (lazy_items)
+    {
+      row[lazy_column] = lazy_children;
+      store->append(row.children());
+    }
+    else if (sub_items)
       added_iters.push_back(new_iter);
 
   }
 
   // If there are sub items adds them into each of the
   // added iters at this level
-  if (sub_items)
+  if (!added_iters.empty())
     add_children_from_skeletons(added_iters, nodes.children);
 
   store->thaw_notify();
 
+  if (detached)
+    _treeview->attach_model();
+
   return added_nodes;
 }
 
@@ -339,6 +360,22 @@ void RootTreeNodeImpl::add_children_from_skeletons(const std::vector<Gtk::TreeIt
   }
 }
 
+// Creates the children of a node added with TreeNodeCollectionSkeleton::lazy_children, if not done yet.
+void RootTreeNodeImpl::create_lazy_children(const Gtk::TreeIter &parent) const
+{
+  Gtk::TreeRow row = *parent;
+  LazyChildrenRef children = row[_treeview->_columns.lazy_children_column()];
+  if (!children)
+    return;
+  row[_treeview->_columns.lazy_children_column()] = LazyChildrenRef();
+
+  // The placeholder is removed only after the real children were added, so the node never
+  // becomes childless (which would make GTK cancel an expansion in progress)
+  Gtk::TreeIter placeholder = row.children().begin();
+  const_cast<RootTreeNodeImpl*>(this)->add_children_from_skeletons(std::vector<Gtk::TreeIter>(1, parent), *children);
+  _treeview->tree_store()->erase(placeholder);
+}
+
 void RootTreeNodeImpl::remove_from_parent()
 {
   throw std::logic_error("Cannot delete root node");
@@ -542,6 +579,7 @@ int TreeNodeImpl::count() const
   if (is_valid())
   {
     //Glib::RefPtr<Gtk::TreeStore> store(model());
+    create_lazy_children(iter());
     Gtk::TreeRow row = *iter();
     return row.children().size();
   }
@@ -553,6 +591,8 @@ Gtk::TreeIter TreeNodeImpl::create_child(int index)
   Glib::RefPtr<Gtk::TreeStore> store(model());
   Gtk::TreeIter new_iter;
 
+  create_lazy_children(iter());
+
   if (index < 0)
     new_iter = store->append(iter()->children());
   else
@@ -591,6 +631,7 @@ TreeNodeRef TreeNodeImpl::get_child(int index) const
 {
   if (is_valid())
   {
+    create_lazy_children(iter());
     Gtk::TreeRow row = *iter();
     return ref_from_iter(row->children()[index]);
   }
@@ -1061,6 +1102,11 @@ void TreeNodeViewImpl::ColumnRecord::add_data_column()
   add(_data_column);
 }
 
+void TreeNodeViewImpl::ColumnRecord::add_lazy_children_column()
+{
+  add(_lazy_children_column);
+}
+
 Gtk::TreeModelColumn<std::string>& TreeNodeViewImpl::ColumnRecord::tag_column()
 {
   return _tag_column;
@@ -1071,6 +1117,11 @@ Gtk::TreeModelColumn<TreeNodeDataRef>& TreeNodeViewImpl::ColumnRecord::data_colu
   return _data_column;
 }
 
+Gtk::TreeModelColumn<LazyChildrenRef>& TreeNodeViewImpl::ColumnRecord::lazy_children_column()
+{
+  return _lazy_children_column;
+}
+
 template <typename T>
       std::pair<Gtk::TreeViewColumn*,int> TreeNodeViewImpl::ColumnRecord::create_column(Gtk::TreeView *tree, const std::string &title, bool editable, bool attr, bool with_icon,
                                                       bool align_right)
@@ -1240,7 +1291,8 @@ bool TreeNodeViewImpl::ColumnRecord::on_focus_out(GdkEventFocus *event, Gtk::Ent
 //---------------------------------------------------------------------------------------
 
 TreeNodeViewImpl::TreeNodeViewImpl(TreeNodeView *self, mforms::TreeOptions opts)
-  : ViewImpl(self), _row_height(-1), _org_event(0)
+  : ViewImpl(self), _row_height(-1), _detach_count(0), _detached_scroll_position(0),
+    _restoring_expansion(false), _org_event(0)
 {
   _mouse_inside = false;
   _hovering_overlay = -1;
@@ -1650,10 +1702,13 @@ void TreeNodeViewImpl::on_activated(const Gtk::TreeModel::Path& path, Gtk::TreeV
 
 void TreeNodeViewImpl::on_will_expand(const Gtk::TreeModel::iterator& iter, const Gtk::TreeModel::Path& path)
 {
+  Gtk::TreePath tree_path = to_list_path(path);
+  dynamic_cast<RootTreeNodeImpl*>(_root_node.ptr())->create_lazy_children(_tree_store->get_iter(tree_path));
+
+  // Rows expanded again after a detached update were already expanded for the owner
   mforms::TreeNodeView* tv = dynamic_cast<mforms::TreeNodeView*>(owner);
-  if (tv)
+  if (tv && !_restoring_expansion)
   {
-    Gtk::TreePath tree_path = to_list_path(path);
     tv->expand_toggle(mforms::TreeNodeRef(new TreeNodeImpl(this, _tree_store, tree_path)), true);
   }
 }
@@ -1853,6 +1908,7 @@ void TreeNodeViewImpl::end_columns()
 {
   _columns.add_tag_column();
   _columns.add_data_column();
+  _columns.add_lazy_children_column();
 
   _tree_store = CustomTreeStore::create(_columns);
   _tree.set_model(_tree_store);
@@ -2158,6 +2214,69 @@ Gtk::TreeModel::Path TreeNodeViewImpl::to_list_path(const Gtk::TreeModel::Path &
   return (_tree.get_headers_clickable() && _sort_model) ? _sort_model->convert_path_to_child_path(path) : path;
 }
 
+// Removes the model from the view until attach_model() is called, so that a large number of rows can be
+// changed without the view updating itself for each of them. Expanded rows, selection and scroll position
+// are restored when attaching the model again. Calls can be nested.
+void TreeNodeViewImpl::detach_model()
+{
+  if (_detach_count++ > 0)
+    return;
+
+  _detached_model = _tree.get_model();
+  if (!_detached_model)
+    return;
+
+  _detached_expanded_rows.clear();
+  _tree.map_expanded_rows(sigc::mem_fun(this, &TreeNodeViewImpl::remember_expanded_row));
+
+  _detached_selection.clear();
+  std::vector<Gtk::TreePath> selection = _tree.get_selection()->get_selected_rows();
+  for (std::vector<Gtk::TreePath>::const_iterator it = selection.begin(); it != selection.end(); ++it)
+    _detached_selection.push_back(Gtk::TreeRowReference(_tree_store, to_list_path(*it)));
+
+  _detached_scroll_position = _swin.get_vadjustment()->get_value();
+
+  // The selection is restored afterwards, so the owner must not see it going away
+  _conn.block();
+  _tree.unset_model();
+}
+
+void TreeNodeViewImpl::attach_model()
+{
+  if (--_detach_count > 0 || !_detached_model)
+    return;
+
+  _tree.set_model(_detached_model);
+  _detached_model.reset();
+
+  _restoring_expansion = true;
+  for (std::vector<Gtk::TreeRowReference>::const_iterator it = _detached_expanded_rows.begin();
+       it != _detached_expanded_rows.end(); ++it)
+  {
+    if (it->is_valid())
+      _tree.expand_row(to_sort_path(it->get_path()), false);
+  }
+  _restoring_expansion = false;
+  _detached_expanded_rows.clear();
+
+  Glib::RefPtr<Gtk::TreeSelection> selection = _tree.get_selection();
+  for (std::vector<Gtk::TreeRowReference>::const_iterator it = _detached_selection.begin();
+       it != _detached_selection.end(); ++it)
+  {
+    if (it->is_valid())
+      selection->select(to_sort_path(it->get_path()));
+  }
+  _detached_selection.clear();
+  _conn.unblock();
+
+  _tree.scroll_to_point(-1, (int)_detached_scroll_position);
+}
+
+void TreeNodeViewImpl::remember_expanded_row(Gtk::TreeView *tree, const Gtk::TreePath &path)
+{
+  _detached_expanded_rows.push_back(Gtk::TreeRowReference(_tree_store, to_list_path(path)));
+}
+
 void TreeNodeViewImpl::header_clicked(Gtk::TreeModelColumnBase* cbase, Gtk::TreeViewColumn* col)
 {
   if (!(col && cbase))
@@ -105,6 +105,8 @@ namespace mforms {
     FeatureScrollOnResize     = 1 << 6, // Scroll caret into view if it would be hidden by a resize action.
     FeatureFolding            = 1 << 7, // Enable code folding.
     FeatureAutoIndent         = 1 << 8, // Auto indent the new line on pressing enter.
+    FeatureLargeFile          = 1 << 9, // For huge documents: switches off features that work on the whole
+                                        // text (word wrapping, folding) and caches only the visible page layout.
 
     FeatureAll               = 0xFFFF,
   };
@@ -301,6 +303,11 @@ public:
     /** Returns the line number from the given character position. */
     size_t line_from_position(size_t position);
 
+    /** Returns the first and last document line (both zero-based) currently shown in the editor.
+     *  With folded text the range can contain more lines than fit on screen.
+     */
+    void get_visible_lines(size_t &first, size_t &last);
+
     void set_font(const std::string &fontDescription); // e.g. "Trebuchet MS bold 9"
     
     /** Enables or disables different features in the editor which have a yes/no behavior. */
@@ -499,6 +506,11 @@ public:
     /** Signal emitted when the control loses input focus.
      */
     boost::signals2::signal<void ()>* signal_lost_focus() { return &_signal_lost_focus; }
+
+    /** Signal emitted when other lines become visible, because the editor was scrolled vertically or resized.
+     *  Use get_visible_lines() to get the new line range.
+     */
+    boost::signals2::signal<void ()>* signal_visible_lines_changed() { return &_visible_lines_changed_event; }
 #ifndef DOXYGEN_SHOULD_SKIP_THIS
     /** Called by the platform code forwarding us all scintilla notifications, so we can act on them. */
     void on_notify(Scintilla::SCNotification* notification);
@@ -519,6 +531,7 @@ public:
     void *_host;
     bool _scroll_on_resize;
     bool _auto_indent;
+    bool _large_file_mode;
 
     void setup_marker(int marker, const std::string& name);
     void check_markers_removed(int position, int length);
@@ -533,6 +546,7 @@ public:
     boost::signals2::signal<void (int)> _char_added_event;
     boost::signals2::signal<void ()> _signal_lost_focus;
     boost::signals2::signal<void(const LineMarkupChangeset &changeset, bool deleted)> _marker_changed_event;
+    boost::signals2::signal<void ()> _visible_lines_changed_event;
 
     boost::function<void (CodeEditor*, bool)> _show_find_panel;
   };
@@ -101,11 +101,15 @@ namespace mforms {
   struct MFORMS_EXPORT TreeNodeCollectionSkeleton
   {
   public:
-    TreeNodeCollectionSkeleton() {};
+    TreeNodeCollectionSkeleton() : lazy_children(false) {};
     TreeNodeCollectionSkeleton(const std::string& icon);
     std::string icon;
     std::vector<TreeNodeSkeleton> children;
     std::vector<std::string> captions;
+
+    // If set, the children are only created when a node is expanded or its children are accessed.
+    // Platforms that don't support this create them right away.
+    bool lazy_children;
   };
 
   class MFORMS_EXPORT TreeNodeData {
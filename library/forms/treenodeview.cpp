@@ -29,6 +29,7 @@ TreeNodeSkeleton::TreeNodeSkeleton(const std::string& strcaption, const std::str
 }
 
 TreeNodeCollectionSkeleton::TreeNodeCollectionSkeleton(const std::string& stricon)
+  : lazy_children(false)
 {
   icon = stricon;
 }
@@ -2226,6 +2226,7 @@ namespace grt {
     bool has_method(const std::string &method) const;
 
     const Member *get_member_info(const std::string &member) const;
+    const Member *get_member_getter_info(const std::string &member) const;
     const Method *get_method_info(const std::string &method) const;
     
     TypeSpec get_member_type(const std::string &member) const;
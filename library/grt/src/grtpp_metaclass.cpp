@@ -866,20 +866,11 @@ void MetaClass::set_member_internal(internal::Object *object, const std::string
 
 ValueRef MetaClass::get_member_value(const internal::Object *object, const std::string &name)
 {
-  MetaClass *mc= this;
-  MemberList::const_iterator mem, end;
-  do
-  {
-    mem= mc->_members.find(name);
-    end= mc->_members.end();
-
-    mc= mc->_parent;
-  } while (mc && (mem == end || mem->second.overrides));
-
-  if (mem == end || mem->second.property == NULL)
+  const Member *member= get_member_getter_info(name);
+  if (member == NULL)
     throw bad_item(name);
 
-  return mem->second.property->get(object);
+  return member->property->get(object);
 }
 
 
@@ -930,6 +921,29 @@ const MetaClass::Member* MetaClass::get_member_info(const std::string &member) c
 }
 
 
+/**
+ * Returns the member whose property is used to read the value of the given member, that is the
+ * original definition if the member is overridden in this class. Returns 0 if there's no such member
+ * or it can't be read.
+ */
+const MetaClass::Member* MetaClass::get_member_getter_info(const std::string &member) const
+{
+  const MetaClass *mc= this;
+  MemberList::const_iterator mem, end;
+  do
+  {
+    mem= mc->_members.find(member);
+    end= mc->_members.end();
+
+    mc= mc->_parent;
+  } while (mc && (mem == end || mem->second.overrides));
+
+  if (mem == end || mem->second.property == NULL)
+    return 0;
+  return &mem->second;
+}
+
+
 const MetaClass::Method* MetaClass::get_method_info(const std::string &method) const
 {
   const MetaClass *mc= this;
@@ -19,6 +19,8 @@
 
 #include "grtpp_notifications.h"
 
+#include <algorithm>
+
 using namespace grt;
 
 void GRTNotificationCenter::setup()
@@ -26,6 +28,11 @@ void GRTNotificationCenter::setup()
   base::NotificationCenter::set_instance(new GRTNotificationCenter());
 }
 
+GRTNotificationCenter::GRTNotificationCenter()
+  : _next_grt_serial(0), _grt_send_depth(0), _has_removed_grt_entries(false)
+{
+}
+
 GRTNotificationCenter *GRTNotificationCenter::get()
 {
   return dynamic_cast<GRTNotificationCenter*>(base::NotificationCenter::get());
@@ -38,42 +45,154 @@ void GRTNotificationCenter::add_grt_observer(GRTObserver *observer, const std::s
   entry.observer = observer;
   entry.observed_notification = name;
   entry.observed_object_id = object.is_valid() ? object.id() : "";
-  _grt_observers.push_back(entry);
+  entry.serial = _next_grt_serial++;
+  _grt_observers[name][entry.observed_object_id].push_back(entry);
 }
 
 
 bool GRTNotificationCenter::remove_grt_observer(GRTObserver *observer, const std::string &name, ObjectRef object)
 {
   bool found = false;
-  for (std::list<GRTObserverEntry>::iterator next, iter = _grt_observers.begin(); iter != _grt_observers.end();)
+  for (boost::unordered_map<std::string, GRTObserversByObject>::iterator by_name = _grt_observers.begin();
+       by_name != _grt_observers.end(); ++by_name)
   {
-    next = iter;
-    ++next;
-    if (iter->observer == observer && (name.empty() || name == iter->observed_notification) && (!object.is_valid() || object.id() == iter->observed_object_id))
+    if (!name.empty() && by_name->first != name)
+      continue;
+
+    for (GRTObserversByObject::iterator list = by_name->second.begin(); list != by_name->second.end(); ++list)
     {
-      found = true;
-      _grt_observers.erase(iter);
+      if (object.is_valid() && list->first != object.id())
+        continue;
+
+      for (GRTObserverList::iterator next, iter = list->second.begin(); iter != list->second.end();)
+      {
+        next = iter;
+        ++next;
+        if (iter->observer == observer)
+        {
+          found = true;
+
+          // Entries must stay valid while a notification is being sent, they are removed afterwards.
+          if (_grt_send_depth > 0)
+          {
+            iter->observer = NULL;
+            _has_removed_grt_entries = true;
+          }
+          else
+            list->second.erase(iter);
+        }
+        iter = next;
+      }
     }
-    iter = next;
   }
   return found;  
 }
 
 
+void GRTNotificationCenter::cleanup_removed_grt_entries()
+{
+  for (boost::unordered_map<std::string, GRTObserversByObject>::iterator by_name = _grt_observers.begin();
+       by_name != _grt_observers.end(); ++by_name)
+  {
+    for (GRTObserversByObject::iterator list = by_name->second.begin(); list != by_name->second.end(); ++list)
+    {
+      for (GRTObserverList::iterator next, iter = list->second.begin(); iter != list->second.end();)
+      {
+        next = iter;
+        ++next;
+        if (iter->observer == NULL)
+          list->second.erase(iter);
+        iter = next;
+      }
+    }
+  }
+  _has_removed_grt_entries = false;
+}
+
+
+bool GRTNotificationCenter::registered_earlier(const GRTObserverEntry *entry1, const GRTObserverEntry *entry2)
+{
+  return entry1->serial < entry2->serial;
+}
+
+
+void GRTNotificationCenter::collect_grt_entries(GRTObserverList &list, std::vector<GRTObserverEntry*> &entries)
+{
+  for (GRTObserverList::iterator iter = list.begin(); iter != list.end(); ++iter)
+  {
+    if (iter->observer != NULL)
+      entries.push_back(&*iter);
+  }
+}
+
+
+/**
+ * Adds the observers for the given notification and sender to entries. Observers of a specific object
+ * get notifications without a sender too.
+ */
+void GRTNotificationCenter::collect_grt_observers(const std::string &name, const ObjectRef &sender,
+                                                  std::vector<GRTObserverEntry*> &entries)
+{
+  boost::unordered_map<std::string, GRTObserversByObject>::iterator by_name = _grt_observers.find(name);
+  if (by_name == _grt_observers.end())
+    return;
+
+  if (!sender.is_valid())
+  {
+    for (GRTObserversByObject::iterator list = by_name->second.begin(); list != by_name->second.end(); ++list)
+      collect_grt_entries(list->second, entries);
+    return;
+  }
+
+  GRTObserversByObject::iterator list = by_name->second.find("");
+  if (list != by_name->second.end())
+    collect_grt_entries(list->second, entries);
+
+  list = by_name->second.find(sender.id());
+  if (list != by_name->second.end())
+    collect_grt_entries(list->second, entries);
+}
+
+
+bool GRTNotificationCenter::has_grt_observers(const std::string &name, ObjectRef sender)
+{
+  std::vector<GRTObserverEntry*> entries;
+  collect_grt_observers(name, sender, entries);
+  if (entries.empty())
+    collect_grt_observers("", sender, entries);
+  return !entries.empty();
+}
+
+
 void GRTNotificationCenter::send_grt(const std::string &name, ObjectRef sender, DictRef info)
 {
-  if (name.substr(0, 3) != "GRN")
+  if (name.compare(0, 3, "GRN") != 0)
     throw std::invalid_argument("Attempt to send GRT notification with a name that doesn't start with GRN");
   
-  // act on a copy of the observer list, because one of them could remove stuff from the list
-  std::list<GRTObserverEntry> copy(_grt_observers);
-  for (std::list<GRTObserverEntry>::iterator iter = copy.begin(); iter != copy.end(); ++iter)
+  // Collect the observers first, observers added while sending don't get this notification.
+  std::vector<GRTObserverEntry*> entries;
+  collect_grt_observers(name, sender, entries);
+  collect_grt_observers("", sender, entries);
+
+  // Notify in registration order, like with a single observer list.
+  std::sort(entries.begin(), entries.end(), registered_earlier);
+
+  ++_grt_send_depth;
+  try
   {
-    if ((iter->observed_notification.empty() || iter->observed_notification == name) &&
-        (iter->observed_object_id.empty() || !sender.is_valid() || iter->observed_object_id == sender.id()))
+    for (std::vector<GRTObserverEntry*>::const_iterator iter = entries.begin(); iter != entries.end(); ++iter)
     {
-      iter->observer->handle_grt_notification(name, sender, info);
+      // An observer removed by an earlier one must not be called anymore.
+      if ((*iter)->observer != NULL)
+        (*iter)->observer->handle_grt_notification(name, sender, info);
     }
-  }  
+  }
+  catch (...)
+  {
+    if (--_grt_send_depth == 0 && _has_removed_grt_entries)
+      cleanup_removed_grt_entries();
+    throw;
+  }
+  if (--_grt_send_depth == 0 && _has_removed_grt_entries)
+    cleanup_removed_grt_entries();
 }
-
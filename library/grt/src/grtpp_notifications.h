@@ -38,18 +38,35 @@ namespace grt {
     struct GRTObserverEntry
     {
       std::string observed_notification;
-      GRTObserver *observer;
+      GRTObserver *observer; // NULL if the entry was removed while a notification was being sent.
       std::string observed_object_id;
+      unsigned int serial;
     };
-    
-    std::list<GRTObserverEntry> _grt_observers;
+    typedef std::list<GRTObserverEntry> GRTObserverList;
+    typedef boost::unordered_map<std::string, GRTObserverList> GRTObserversByObject;
+
+    // Observers by notification name and then by the id of the object they observe. Empty names
+    // and ids stand for all notifications or all senders, respectively.
+    boost::unordered_map<std::string, GRTObserversByObject> _grt_observers;
+
+    unsigned int _next_grt_serial;
+    int _grt_send_depth;
+    bool _has_removed_grt_entries;
+
+    void collect_grt_observers(const std::string &name, const ObjectRef &sender, std::vector<GRTObserverEntry*> &entries);
+    static void collect_grt_entries(GRTObserverList &list, std::vector<GRTObserverEntry*> &entries);
+    void cleanup_removed_grt_entries();
+    static bool registered_earlier(const GRTObserverEntry *entry1, const GRTObserverEntry *entry2);
   public:
+    GRTNotificationCenter();
     static GRTNotificationCenter *get();
     
     //void add_observer(Observer *observer, boost::function<void (const std::string &, void*, NotificationInfo &)> &callback, const std::string &name = "");
     void add_grt_observer(GRTObserver *observer, const std::string &name = "", ObjectRef object = ObjectRef());
     bool remove_grt_observer(GRTObserver *observer, const std::string &name = "", ObjectRef object = ObjectRef());
     
+    bool has_grt_observers(const std::string &name, ObjectRef sender = ObjectRef());
+
     // must be called from main thread only
     void send_grt(const std::string &name, ObjectRef sender, DictRef info);
   public:
@@ -88,6 +88,9 @@ namespace grt
                                             bool case_sensitive = true,
                                             const std::string &name = "name")
     {
+      if (list.is_valid() && name == "name" && list->has_name_index(case_sensitive))
+        return Ref<O>::cast_from(list->find_by_name(value));
+
       for (size_t i = 0; i < list.count(); i++)
       {
         Ref<O> tmp = list[i];
@@ -205,6 +205,133 @@ bool String::less_than(const Value *o) const
 //--------------------------------------------------------------------------------------------------
 
 
+/**
+ * Maps names of the objects in a list to the objects. Keys are collation keys of the (normalized and,
+ * if needed, case folded) names, so that lookups match what base::same_string() considers equal.
+ */
+class grt::internal::NameIndex
+{
+public:
+  NameIndex(bool case_sensitive) : _case_sensitive(case_sensitive) {}
+
+  ~NameIndex()
+  {
+    for (std::map<Object*, boost::signals2::connection>::iterator iter= _connections.begin();
+         iter != _connections.end(); ++iter)
+      iter->second.disconnect();
+  }
+
+  bool case_sensitive() const { return _case_sensitive; }
+
+  void add(const ValueRef &value)
+  {
+    Object *object= dynamic_cast<Object*>(value.valueptr());
+    if (object == NULL || !object->has_member("name"))
+      return;
+
+    _entries.insert(std::make_pair(key(object->get_string_member("name")), object));
+    if (_connections.find(object) == _connections.end())
+      _connections[object]= object->signal_changed()->connect(boost::bind(&NameIndex::member_changed, this, object, _1, _2));
+  }
+
+  void remove(const ValueRef &value)
+  {
+    Object *object= dynamic_cast<Object*>(value.valueptr());
+    if (object == NULL || !object->has_member("name"))
+      return;
+
+    std::pair<Entries::iterator, Entries::iterator> range= _entries.equal_range(key(object->get_string_member("name")));
+    size_t remaining= 0;
+    bool removed= false;
+    for (Entries::iterator iter= range.first; iter != range.second; )
+    {
+      if (iter->second == object)
+      {
+        if (!removed)
+        {
+          _entries.erase(iter++);
+          removed= true;
+          continue;
+        }
+        ++remaining;
+      }
+      ++iter;
+    }
+
+    if (remaining == 0)
+    {
+      std::map<Object*, boost::signals2::connection>::iterator connection= _connections.find(object);
+      if (connection != _connections.end())
+      {
+        connection->second.disconnect();
+        _connections.erase(connection);
+      }
+    }
+  }
+
+  // Returns the object with the given name and the number of objects with that name.
+  Object *find(const std::string &name, size_t &count) const
+  {
+    std::pair<Entries::const_iterator, Entries::const_iterator> range= _entries.equal_range(key(name));
+    count= std::distance(range.first, range.second);
+    return count > 0 ? range.first->second : NULL;
+  }
+
+private:
+  typedef std::multimap<std::string, Object*> Entries;
+
+  std::string key(const std::string &name) const
+  {
+    gchar *normalized= g_utf8_normalize(name.c_str(), -1, G_NORMALIZE_DEFAULT);
+    if (normalized == NULL) // Invalid UTF-8, use as is.
+      return name;
+
+    if (!_case_sensitive)
+    {
+      gchar *folded= g_utf8_casefold(normalized, -1);
+      g_free(normalized);
+      normalized= folded;
+    }
+
+    gchar *collate_key= g_utf8_collate_key(normalized, -1);
+    std::string result(collate_key);
+    g_free(collate_key);
+    g_free(normalized);
+
+    return result;
+  }
+
+  void member_changed(Object *object, const std::string &member, const ValueRef &ovalue)
+  {
+    if (member != "name")
+      return;
+
+    std::string old_key= key(ovalue.is_valid() ? *StringRef::cast_from(ovalue) : std::string());
+    std::pair<Entries::iterator, Entries::iterator> range= _entries.equal_range(old_key);
+    size_t count= 0;
+    for (Entries::iterator iter= range.first; iter != range.second; )
+    {
+      if (iter->second == object)
+      {
+        _entries.erase(iter++);
+        ++count;
+      }
+      else
+        ++iter;
+    }
+
+    std::string new_key= key(object->get_string_member("name"));
+    while (count-- > 0)
+      _entries.insert(std::make_pair(new_key, object));
+  }
+
+  Entries _entries;
+  std::map<Object*, boost::signals2::connection> _connections;
+  bool _case_sensitive;
+};
+
+//--------------------------------------------------------------------------------------------------
+
 std::string List::repr() const
 {
   std::string s;
@@ -225,14 +352,14 @@ std::string List::repr() const
 
 
 List::List(GRT *grt, bool allow_null)
-: _grt(grt), _allow_null(allow_null)
+: _grt(grt), _allow_null(allow_null), _name_index(NULL)
 {
   _is_global= 0;
 }
 
 
 List::List(GRT *grt, Type content_type, const std::string &content_class, bool allow_null)
-  : _grt(grt), _allow_null(allow_null)
+  : _grt(grt), _allow_null(allow_null), _name_index(NULL)
 {
   _content_type.type= content_type;
   _content_type.object_class= content_class;
@@ -243,6 +370,61 @@ List::List(GRT *grt, Type content_type, const std::string &content_class, bool a
 
 List::~List()
 {
+  delete _name_index;
+}
+
+
+void List::enable_name_index(bool case_sensitive)
+{
+  if (_content_type.type != ObjectType)
+    throw std::logic_error("Name index can only be used for object lists");
+
+  if (_name_index != NULL)
+  {
+    if (_name_index->case_sensitive() == case_sensitive)
+      return;
+    disable_name_index();
+  }
+
+  _name_index= new NameIndex(case_sensitive);
+  for (raw_const_iterator iter= raw_begin(); iter != raw_end(); ++iter)
+    _name_index->add(*iter);
+}
+
+
+void List::disable_name_index()
+{
+  delete _name_index;
+  _name_index= NULL;
+}
+
+
+bool List::has_name_index(bool case_sensitive) const
+{
+  return _name_index != NULL && _name_index->case_sensitive() == case_sensitive;
+}
+
+
+/**
+ * Returns the first object in the list with the given name, using the name index.
+ * The index must have been enabled before.
+ */
+ValueRef List::find_by_name(const std::string &name) const
+{
+  size_t count;
+  Object *object= _name_index->find(name, count);
+  if (count <= 1)
+    return ValueRef(object);
+
+  // Duplicate names are rare, but the first one in list order must win as without index.
+  bool case_sensitive= _name_index->case_sensitive();
+  for (raw_const_iterator iter= raw_begin(); iter != raw_end(); ++iter)
+  {
+    Object *candidate= dynamic_cast<Object*>(iter->valueptr());
+    if (candidate != NULL && same_string(candidate->get_string_member("name"), name, case_sensitive))
+      return *iter;
+  }
+  return ValueRef();
 }
 
 void List::set_unchecked(size_t index, const ValueRef &value)
@@ -270,6 +452,12 @@ void List::set_unchecked(size_t index, const ValueRef &value)
       value.mark_global();
     }
 
+    if (_name_index != NULL)
+    {
+      _name_index->remove(_content[index]);
+      _name_index->add(value);
+    }
+
     _content[index]= value;
   }
 }
@@ -296,6 +484,9 @@ void List::insert_unchecked(const ValueRef &value, size_t index)
 
     _content.insert(_content.begin()+index, value);
   }
+
+  if (_name_index != NULL)
+    _name_index->add(value);
 }
 
 
@@ -312,6 +503,8 @@ void List::remove(const ValueRef &value)
       if (_is_global > 0 && _grt->tracking_changes())
         _grt->get_undo_manager()->add_undo(new UndoListRemoveAction(this, i));
 
+      if (_name_index != NULL)
+        _name_index->remove(_content[i]);
       _content.erase(_content.begin()+i);
     }
   }
@@ -328,6 +521,8 @@ void List::remove(size_t index)
   if (_is_global > 0 && _grt->tracking_changes())
     _grt->get_undo_manager()->add_undo(new UndoListRemoveAction(this, index));
 
+  if (_name_index != NULL)
+    _name_index->remove(_content[index]);
   _content.erase(_content.begin()+index);
 }
 
@@ -142,6 +142,7 @@ namespace grt {
   namespace internal {
     
     class Object;
+    class NameIndex;
   
     class MYSQLGRT_PUBLIC Value
     {
@@ -317,6 +318,13 @@ namespace grt {
       
       inline const ValueRef &operator[](size_t i) const { return get(i); }
 
+      // Optional index over the name member of the objects in the list, used by find_named_object_in_list().
+      // It is kept up to date on insert/remove and when an object in the list is renamed.
+      void enable_name_index(bool case_sensitive);
+      void disable_name_index();
+      bool has_name_index(bool case_sensitive) const;
+      ValueRef find_by_name(const std::string &name) const;
+
       virtual bool equals(const Value*) const;
       virtual bool less_than(const Value *) const;
 
@@ -351,6 +359,7 @@ namespace grt {
       storage_type _content;
       SimpleTypeSpec _content_type;
       bool _allow_null;
+      NameIndex *_name_index;
 
       mutable short _is_global;
     };
@@ -26,6 +26,8 @@
 #include "base/util_functions.h"
 #include "base/wb_memory.h"
 
+#include <algorithm>
+
 // python internals
 #include <node.h>
 //#include <grammar.h>
@@ -53,6 +55,10 @@ static const char *GRTTypeSignature= "GRTCONTEXT";
 // used to identify a GRT value as a PyCObject
 static const char *GRTValueSignature= "GRTVALUE";
 
+// The context registered in the grt module, to save the lookup in get(), which is called for
+// nearly every access to a GRT value from Python.
+static PythonContext *current_context= NULL;
+
 
 static std::string flatten_class_name(std::string name)
 {
@@ -174,6 +180,9 @@ PythonContext::~PythonContext()
 {
   GRTNotificationCenter::get()->remove_grt_observer(this);
   NotificationCenter::get()->remove_observer(this);
+
+  if (current_context == this)
+    current_context= NULL;
 }
 
 
@@ -261,6 +270,9 @@ PythonContext *PythonContext::get()
   PyObject *module;
   PyObject *dict;
 
+  if (current_context)
+    return current_context;
+
   module= PyDict_GetItemString(PyImport_GetModuleDict(), "grt");
   if (!module)
     throw std::runtime_error("GRT module not found in Python runtime");
@@ -1240,7 +1252,10 @@ void PythonContext::register_grt_module()
   // add the context ptr
   PyObject* context_object= PyCObject_FromVoidPtrAndDesc(this, &GRTTypeSignature, NULL);
   if (context_object != NULL)
+  {
     PyModule_AddObject(module, "__GRT__", context_object);
+    current_context= this;
+  }
   
   PyModule_AddStringConstant(module, "INT", (char*)type_to_str(IntegerType).c_str());
   PyModule_AddStringConstant(module, "DOUBLE", (char*)type_to_str(DoubleType).c_str());
@@ -1440,34 +1455,28 @@ PyObject *PythonContext::from_grt(const ValueRef &value)
         return PyString_FromStringAndSize(data.data(), data.size());
       }
       case ListType:
-      {
-        PyObject *content= PythonContext::internal_cobject_from_value(value);
-        PyObject *args = Py_BuildValue("(ssO)", "", "", content);
-        PyObject *r= PyObject_Call(_grt_list_class, args, NULL);
-        Py_XDECREF(args);
-        Py_XDECREF(content);
-        return r;
-      }
       case DictType:
-      {
-        PyObject *content= PythonContext::internal_cobject_from_value(value);
-        PyObject *args = Py_BuildValue("(ssO)", "", "", content);
-        PyObject *r= PyObject_Call(_grt_dict_class, args, NULL);
-        Py_XDECREF(args);
-        Py_XDECREF(content);
-        return r;
-      }
       case ObjectType:
       {
-        std::string class_name= grt::ObjectRef::cast_from(value).class_name();
-        PyObject *content= PythonContext::internal_cobject_from_value(value);
-        PyObject *theclass= _grt_class_wrappers[class_name];
-        PyObject *args = Py_BuildValue("(sO)", "", content);
-        PyObject *r= PyObject_Call(theclass ? theclass : (PyObject*)_grt_object_class, args, NULL);
-        Py_XDECREF(args);
-        Py_XDECREF(content);
-        
-        return r;
+        // Containers and objects are passed by reference, so reuse the wrapper if there is one.
+        boost::unordered_map<internal::Value*, PyObject*>::const_iterator wrapper= _wrappers.find(value.valueptr());
+        if (wrapper != _wrappers.end())
+        {
+          Py_INCREF(wrapper->second);
+          return wrapper->second;
+        }
+
+        if (value.type() == ListType)
+          return new_list_wrapper(BaseListRef::cast_from(value));
+        if (value.type() == DictType)
+          return new_dict_wrapper(DictRef::cast_from(value));
+
+        ObjectRef object(ObjectRef::cast_from(value));
+        PyObject *theclass= NULL;
+        std::map<std::string, AutoPyObject>::iterator iter= _grt_class_wrappers.find(object.class_name());
+        if (iter != _grt_class_wrappers.end())
+          theclass= iter->second;
+        return new_object_wrapper(theclass ? theclass : (PyObject*)_grt_object_class, object);
       }
       default:
         return NULL;
@@ -1477,6 +1486,53 @@ PyObject *PythonContext::from_grt(const ValueRef &value)
   return Py_None;
 }
 
+
+/** Converts the items of a GRT list from start to end (exclusive) into a Python list in one go.
+ */
+PyObject *PythonContext::from_grt_list(const BaseListRef &list, size_t start, size_t end)
+{
+  end= std::min(end, list.count());
+  start= std::min(start, end);
+
+  PyObject *result= PyList_New(end - start);
+  if (!result)
+    return NULL;
+
+  internal::List *content= &list.content();
+  for (size_t i= start; i < end; ++i)
+  {
+    PyObject *item= from_grt(content->get(i));
+    if (!item)
+    {
+      Py_DECREF(result);
+      return NULL;
+    }
+    PyList_SET_ITEM(result, i - start, item);
+  }
+  return result;
+}
+
+
+/** Remembers the Python object wrapping the given GRT value. The wrapper must unregister itself
+ * with remove_wrapper() when it is deallocated.
+ */
+void PythonContext::add_wrapper(internal::Value *value, PyObject *wrapper)
+{
+  // Keep the first wrapper if several were created for a value, e.g. from Python code.
+  _wrappers.insert(std::make_pair(value, wrapper));
+}
+
+
+void PythonContext::remove_wrapper(internal::Value *value, PyObject *wrapper)
+{
+  if (!current_context)
+    return;
+
+  boost::unordered_map<internal::Value*, PyObject*>::iterator iter= current_context->_wrappers.find(value);
+  if (iter != current_context->_wrappers.end() && iter->second == wrapper)
+    current_context->_wrappers.erase(iter);
+}
+
 bool PythonContext::pystring_to_string(PyObject *strobject, std::string &ret_string, bool convert)
 {
   if (PyUnicode_Check(strobject))
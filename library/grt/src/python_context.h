@@ -131,6 +131,7 @@ namespace grt {
     bool import_module(const std::string &name);
     
     PyObject *from_grt(const ValueRef &value);
+    PyObject *from_grt_list(const BaseListRef &list, size_t start, size_t end);
     grt::ValueRef from_pyobject(PyObject *object);
     grt::ValueRef from_pyobject(PyObject *object, const grt::TypeSpec &expected_type);
     bool pystring_to_string(PyObject *str, std::string &ret_string, bool convert = false);
@@ -174,6 +175,9 @@ namespace grt {
     PyObject *db_error() { return _grt_db_error; }
     PyObject *db_not_connected() { return _grt_db_not_connected; }
 
+    void add_wrapper(internal::Value *value, PyObject *wrapper);
+    static void remove_wrapper(internal::Value *value, PyObject *wrapper);
+
     void set_grt_observer_callable(PyObject *obj);
     void setEventlogCallback(PyObject *obj);
     void printResult(std::map<std::string, std::string> &output);
@@ -205,6 +209,10 @@ namespace grt {
 
     std::map<std::string, AutoPyObject> _grt_class_wrappers;
 
+    // The Python objects currently wrapping GRT values (not owned), so that a value is always represented
+    // by the same Python object and doesn't need a new wrapper each time it is passed to Python.
+    boost::unordered_map<internal::Value*, PyObject*> _wrappers;
+
   private:
     ValueRef simple_type_from_pyobject(PyObject *object, const grt::SimpleTypeSpec &type);
     
@@ -217,6 +225,10 @@ namespace grt {
     void init_grt_dict_type();
     void init_grt_object_type();
 
+    PyObject *new_list_wrapper(const BaseListRef &list);
+    PyObject *new_dict_wrapper(const DictRef &dict);
+    PyObject *new_object_wrapper(PyObject *wrapper_class, const ObjectRef &object);
+
     void run_post_init_script();
     
     virtual void handle_grt_notification(const std::string &name, ObjectRef sender, DictRef info);
@@ -39,7 +39,10 @@ static int dict_init(PyGRTDictObject *self, PyObject *args, PyObject *kwds)
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "|zzO", (char**)kwdict, &type, &class_name, &valueptr))
       return -1;
     
+    if (self->dict)
+      PythonContext::remove_wrapper(self->dict->valueptr(), (PyObject*)self);
     delete self->dict;
+    self->dict= NULL;
     
     if (valueptr)
     {
@@ -85,6 +88,7 @@ static int dict_init(PyGRTDictObject *self, PyObject *args, PyObject *kwds)
         self->dict= new grt::DictRef(ctx->get_grt(), content_type, class_name);
       }
     }
+    ctx->add_wrapper(self->dict->valueptr(), (PyObject*)self);
     return 0;
   }
   return -1;
@@ -93,6 +97,8 @@ static int dict_init(PyGRTDictObject *self, PyObject *args, PyObject *kwds)
 
 static void dict_dealloc(PyGRTDictObject *self)
 {
+  if (self->dict)
+    PythonContext::remove_wrapper(self->dict->valueptr(), (PyObject*)self);
   delete self->dict;
   
   self->ob_type->tp_free(self);
@@ -296,6 +302,36 @@ dict_values(PyGRTDictObject *self, PyObject *args)
 }
 
 
+// Converts the whole dict into a native Python dict, which is much cheaper to work with
+// than going through the wrapper for each key.
+static PyObject *
+dict_copy(PyGRTDictObject *self, PyObject *args)
+{
+  if (args)
+  {
+    PyErr_SetString(PyExc_ValueError, "method takes no arguments");
+    return NULL;
+  }
+  PythonContext *ctx= PythonContext::get_and_check();
+  if (!ctx) return NULL;
+  PyObject *dict= PyDict_New();
+
+  for (grt::DictRef::const_iterator iter= self->dict->begin(); iter != self->dict->end(); ++iter)
+  {
+    PyObject *value= ctx->from_grt(iter->second);
+    if (!value || PyDict_SetItemString(dict, iter->first.c_str(), value) < 0)
+    {
+      Py_XDECREF(value);
+      Py_DECREF(dict);
+      return NULL;
+    }
+    Py_DECREF(value);
+  }
+
+  return dict;
+}
+
+
 static PyObject *
 dict_has_key(PyGRTDictObject *self, PyObject *arg)
 {
@@ -453,6 +489,7 @@ static PyMethodDef PyGRTDictMethods[] = {
 {"keys", (PyCFunction)dict_keys, 0, NULL},
 {"items", (PyCFunction)dict_items, 0, NULL},
 {"values", (PyCFunction)dict_values, 0, NULL},
+{"copy", (PyCFunction)dict_copy, 0, "D.copy() -> shallow copy of D as a Python dict"},
 {"has_key", (PyCFunction)dict_has_key, 0, NULL},
 {"update", (PyCFunction)dict_update, 0, NULL},
 {"get", (PyCFunction)dict_get, METH_VARARGS, NULL},
@@ -571,3 +608,19 @@ void grt::PythonContext::init_grt_dict_type()
   _grt_dict_class= PyDict_GetItemString(PyModule_GetDict(get_grt_module()), "Dict");
 }
 
+
+/** Creates a grt.Dict object wrapping the dict, without going through the Python constructor.
+ */
+PyObject *grt::PythonContext::new_dict_wrapper(const grt::DictRef &dict)
+{
+  PyTypeObject *type= (PyTypeObject*)_grt_dict_class;
+  PyGRTDictObject *wrapper= (PyGRTDictObject*)type->tp_alloc(type, 0);
+  if (!wrapper)
+    return NULL;
+
+  wrapper->dict= new grt::DictRef(dict);
+  add_wrapper(dict.valueptr(), (PyObject*)wrapper);
+
+  return (PyObject*)wrapper;
+}
+
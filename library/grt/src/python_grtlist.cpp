@@ -39,7 +39,10 @@ static int list_init(PyGRTListObject *self, PyObject *args, PyObject *kwds)
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "|zzO", (char**)kwlist, &type, &class_name, &valueptr))
       return -1;
     
+    if (self->list)
+      PythonContext::remove_wrapper(self->list->valueptr(), (PyObject*)self);
     delete self->list;
+    self->list= NULL;
     
     if (valueptr)
     {
@@ -86,6 +89,7 @@ static int list_init(PyGRTListObject *self, PyObject *args, PyObject *kwds)
         self->list= new grt::BaseListRef(ctx->get_grt(), content_type, class_name);
       }
     }
+    ctx->add_wrapper(self->list->valueptr(), (PyObject*)self);
     return 0;
   }
   return -1;
@@ -94,6 +98,8 @@ static int list_init(PyGRTListObject *self, PyObject *args, PyObject *kwds)
 
 static void list_dealloc(PyGRTListObject *self)
 {
+  if (self->list)
+    PythonContext::remove_wrapper(self->list->valueptr(), (PyObject*)self);
   delete self->list;
   
   self->ob_type->tp_free(self);
@@ -143,6 +149,29 @@ static PyObject *list_item(PyGRTListObject *self, Py_ssize_t index)
 
 
 
+// Slices are converted into plain Python lists in one go.
+static PyObject *list_slice(PyGRTListObject *self, Py_ssize_t ilow, Py_ssize_t ihigh)
+{
+  PythonContext *ctx= PythonContext::get_and_check();
+  if (!ctx) return NULL;
+
+  if (ilow < 0)
+    ilow= 0;
+  if (ihigh < ilow)
+    ihigh= ilow;
+
+  try
+  {
+    return ctx->from_grt_list(*self->list, ilow, ihigh);
+  }
+  catch (std::exception &exc)
+  {
+    PyErr_SetString(PyExc_RuntimeError, exc.what());
+    return NULL;
+  }
+}
+
+
 static int list_assign(PyGRTListObject *self, Py_ssize_t index, PyObject *value)
 {
   PythonContext *ctx= PythonContext::get_and_check();
@@ -201,9 +230,11 @@ static PyObject *list_inplace_concat(PyGRTListObject *self, PyObject *other)
   if (!other)
     return NULL;
 
-  for (Py_ssize_t i= 0; i < PySequence_Length(other); i++)
+  // Items of the fast sequence are borrowed references.
+  Py_ssize_t count= PySequence_Fast_GET_SIZE(other);
+  for (Py_ssize_t i= 0; i < count; i++)
   {
-    PyObject *item= PySequence_GetItem(other, i);
+    PyObject *item= PySequence_Fast_GET_ITEM(other, i);
     
     try
     {
@@ -212,14 +243,17 @@ static PyObject *list_inplace_concat(PyGRTListObject *self, PyObject *other)
     catch (grt::type_error &exc)
     {
       PyErr_SetString(PyExc_TypeError, base::strfmt("type of sequence contents: %s", exc.what()).c_str());
+      Py_DECREF(other);
       return NULL;
     }
     catch (std::exception &exc)
     {
       PyErr_SetString(PyExc_RuntimeError, exc.what());
+      Py_DECREF(other);
       return NULL;
     }
   }
+  Py_DECREF(other);
 
   Py_INCREF(self);
   return (PyObject*)self;
@@ -424,7 +458,7 @@ static PySequenceMethods PyGRTListObject_as_sequence =
 0, // binaryfunc sq_concat;
 0, // ssizeargfunc sq_repeat;
 (ssizeargfunc)list_item, // ssizeargfunc sq_item;
-0,//(ssizessizeargfunc)list_slice, // ssizessizeargfunc sq_slice;
+(ssizessizeargfunc)list_slice, // ssizessizeargfunc sq_slice;
 (ssizeobjargproc)list_assign, // ssizeobjargproc sq_ass_item;
 0,///(ssizessizeobjargproc)list_assign_slice,// ssizessizeobjargproc sq_ass_slice;
 (objobjproc)list_contains,// objobjproc sq_contains;
@@ -530,3 +564,19 @@ void grt::PythonContext::init_grt_list_type()
   
   _grt_list_class= PyDict_GetItemString(PyModule_GetDict(get_grt_module()), "List");
 }
+
+
+/** Creates a grt.List object wrapping the list, without going through the Python constructor.
+ */
+PyObject *grt::PythonContext::new_list_wrapper(const grt::BaseListRef &list)
+{
+  PyTypeObject *type= (PyTypeObject*)_grt_list_class;
+  PyGRTListObject *wrapper= (PyGRTListObject*)type->tp_alloc(type, 0);
+  if (!wrapper)
+    return NULL;
+
+  wrapper->list= new grt::BaseListRef(list);
+  add_wrapper(list.valueptr(), (PyObject*)wrapper);
+
+  return (PyObject*)wrapper;
+}
@@ -29,6 +29,28 @@
 using namespace grt;
 using namespace base;
 
+// Members looked up by class and attribute name. Attribute names used in Python code are interned
+// strings, so the string object identifies the name and repeated accesses to the same member don't
+// need to search the class hierarchy by name. The keys hold a reference to the name.
+typedef std::map<std::pair<grt::MetaClass*, PyObject*>, const grt::MetaClass::Member*> MemberCache;
+static MemberCache member_getters;
+
+static const grt::MetaClass::Member *find_member_getter(grt::MetaClass *meta, PyObject *attr_name)
+{
+  if (!PyString_CHECK_INTERNED(attr_name))
+    return meta->get_member_getter_info(PyString_AsString(attr_name));
+
+  std::pair<grt::MetaClass*, PyObject*> key(meta, attr_name);
+  MemberCache::const_iterator iter= member_getters.find(key);
+  if (iter != member_getters.end())
+    return iter->second;
+
+  const grt::MetaClass::Member *member= meta->get_member_getter_info(PyString_AsString(attr_name));
+  Py_INCREF(attr_name);
+  member_getters[key]= member;
+  return member;
+}
+
 static PyObject *call_object_method(const grt::ObjectRef &object, const grt::ClassMethod *method, PyObject *args)
 {    
   PythonContext *ctx= PythonContext::get_and_check();
@@ -220,7 +242,10 @@ static int object_init(PyGRTObjectObject *self, PyObject *args, PyObject *kwds)
     if (!PyArg_ParseTupleAndKeywords(args, kwds, "z|O", (char**)kwlist, &class_name, &valueptr))
       return -1;
     
+    if (self->object)
+      PythonContext::remove_wrapper(self->object->valueptr(), (PyObject*)self);
     delete self->object;
+    self->object= NULL;
     
     if (valueptr && valueptr != Py_None)
     {
@@ -230,6 +255,7 @@ static int object_init(PyGRTObjectObject *self, PyObject *args, PyObject *kwds)
         grt::ObjectRef content= grt::ObjectRef::cast_from(v);
         self->object= new grt::ObjectRef(content);
         self->hash= -1;
+        ctx->add_wrapper(self->object->valueptr(), (PyObject*)self);
       }
       catch (grt::type_error &exc)
       {
@@ -252,6 +278,7 @@ static int object_init(PyGRTObjectObject *self, PyObject *args, PyObject *kwds)
 
       self->object= new grt::ObjectRef(ctx->get_grt()->create_object<internal::Object>(class_name));
       self->hash= -1;
+      ctx->add_wrapper(self->object->valueptr(), (PyObject*)self);
     }
     return 0;
   }
@@ -261,6 +288,8 @@ static int object_init(PyGRTObjectObject *self, PyObject *args, PyObject *kwds)
 
 static void object_dealloc(PyGRTObjectObject *self)
 {
+  if (self->object)
+    PythonContext::remove_wrapper(self->object->valueptr(), (PyObject*)self);
   delete self->object;
   
   self->ob_type->tp_free(self);
@@ -310,7 +339,21 @@ static PyObject *object_getattro(PyGRTObjectObject *self, PyObject *attr_name)
   if (PyString_Check(attr_name)) 
   {
     const char *attrname= PyString_AsString(attr_name);
-    
+
+    // GRT members are by far the most common attributes, so check them before the Python ones.
+    // Names starting with __ are left to Python.
+    if (attrname[0] != '_' || attrname[1] != '_')
+    {
+      const grt::MetaClass::Member *member= find_member_getter(self->object->get_metaclass(), attr_name);
+      if (member)
+      {
+        PythonContext *ctx= PythonContext::get_and_check();
+        if (!ctx) return NULL;
+
+        return ctx->from_grt(member->property->get(&self->object->content()));
+      }
+    }
+
     PyObject *object;
     if ((object= PyObject_GenericGetAttr((PyObject*)self, attr_name)))
       return object;
@@ -603,6 +646,24 @@ PyType_GenericNew, //  newfunc tp_new;
 
 
 
+/** Creates a Python object of the given class (grt.Object or one of the classes in grt.classes)
+ * wrapping the GRT object, without going through the Python constructors of the class hierarchy.
+ */
+PyObject *grt::PythonContext::new_object_wrapper(PyObject *wrapper_class, const grt::ObjectRef &object)
+{
+  PyTypeObject *type= (PyTypeObject*)wrapper_class;
+  PyGRTObjectObject *wrapper= (PyGRTObjectObject*)type->tp_alloc(type, 0);
+  if (!wrapper)
+    return NULL;
+
+  wrapper->object= new grt::ObjectRef(object);
+  wrapper->hash= -1;
+  add_wrapper(object.valueptr(), (PyObject*)wrapper);
+
+  return (PyObject*)wrapper;
+}
+
+
 void grt::PythonContext::init_grt_object_type()
 {
   {
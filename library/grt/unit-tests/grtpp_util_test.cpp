@@ -96,6 +96,55 @@ TEST_FUNCTION(10)
   ensure_equals("don't modify owned objects Bug #17324160", book->publisher().id(), publisher.id());
 }
 
+
+// Lookups through the name index must give the same results as the linear search.
+TEST_FUNCTION(20)
+{
+  test_BookRef book(&grt);
+  grt::ListRef<test_Author> authors(book->authors());
+  for (int i= 0; i < 1000; i++)
+  {
+    test_AuthorRef author(&grt);
+    author->name(base::strfmt("Author%i", i));
+    authors.insert(author);
+  }
+
+  authors->enable_name_index(true);
+  ensure("index enabled", authors->has_name_index(true));
+  ensure("no case insensitive index", !authors->has_name_index(false));
+
+  ensure_equals("found", find_named_object_in_list(authors, "Author500").id(), authors[500].id());
+  ensure("case mismatch", !find_named_object_in_list(authors, "author500").is_valid());
+  ensure("not found", !find_named_object_in_list(authors, "Author1000").is_valid());
+
+  // Renames are tracked.
+  authors[10]->name("Renamed");
+  ensure("old name", !find_named_object_in_list(authors, "Author10").is_valid());
+  ensure_equals("new name", find_named_object_in_list(authors, "Renamed").id(), authors[10].id());
+
+  // Removed and inserted objects.
+  test_AuthorRef removed(authors[20]);
+  authors.remove_value(removed);
+  ensure("removed", !find_named_object_in_list(authors, "Author20").is_valid());
+  removed->name("Removed");
+  ensure("rename after remove", !find_named_object_in_list(authors, "Removed").is_valid());
+
+  // The first of several objects with the same name wins.
+  test_AuthorRef duplicate(&grt);
+  duplicate->name("Author30");
+  authors.insert(duplicate, 0);
+  ensure_equals("duplicate", find_named_object_in_list(authors, "Author30").id(), duplicate.id());
+  authors.remove(0);
+  ensure_equals("duplicate removed", find_named_object_in_list(authors, "Author30").id(), authors[29].id());
+
+  authors->enable_name_index(false);
+  ensure_equals("case insensitive", find_named_object_in_list(authors, "AUTHOR500", false).id(), authors[499].id());
+
+  authors->disable_name_index();
+  ensure("index disabled", !authors->has_name_index(false));
+  ensure_equals("without index", find_named_object_in_list(authors, "Renamed").id(), authors[10].id());
+}
+
 END_TESTS
 
 
@@ -0,0 +1,151 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "testgrt.h"
+#include "structs.test.h"
+#include "grtpp_util.h"
+#include "grtpp_module_python.h"
+#include "python_context.h"
+
+// Number of list items used for the list access tests.
+#define LIST_ITEMS 1000
+
+BEGIN_TEST_DATA_CLASS(grt_python_test)
+public:
+  GRT *grt;
+  PythonContext *ctx;
+
+TEST_DATA_CONSTRUCTOR(grt_python_test)
+{
+  grt= new GRT();
+  grt->load_metaclasses("data/structs.test.xml");
+  grt->end_loading_metaclasses();
+
+  grt::init_python_support(grt, "");
+  ctx= dynamic_cast<PythonModuleLoader*>(grt->get_module_loader("python"))->get_python_context();
+  ctx->refresh();
+}
+
+  // Makes the value available to Python code as a global with the given name.
+  void set_global(const std::string &name, const ValueRef &value)
+  {
+    WillEnterPython lock;
+    PyObject *object= ctx->from_grt(value);
+    ctx->set_global(name, object);
+    Py_XDECREF(object);
+  }
+
+  bool eval_bool(const std::string &expression)
+  {
+    WillEnterPython lock;
+    PyObject *result= ctx->eval_string(expression);
+    bool value= result && PyObject_IsTrue(result);
+    Py_XDECREF(result);
+    return value;
+  }
+
+  void run(const std::string &code)
+  {
+    ensure_equals("Script result", ctx->run_buffer(code), 0);
+  }
+
+END_TEST_DATA_CLASS
+
+TEST_MODULE(grt_python_test, "GRT: Python bindings");
+
+// Wrappers are reused and conversions give the expected Python types.
+TEST_FUNCTION(5)
+{
+  test_BookRef book(grt);
+  book->title("Some Title");
+  book->extras().set("isbn", StringRef("1234"));
+  for (int i= 0; i < 10; i++)
+  {
+    test_AuthorRef author(grt);
+    author->name(base::strfmt("Author %i", i));
+    book->authors().insert(author);
+  }
+  set_global("book", book);
+
+  ensure("Same list wrapper", eval_bool("book.authors is book.authors"));
+  ensure("Same object wrapper", eval_bool("book.authors[3] is book.authors[3]"));
+  ensure("Object class", eval_bool("isinstance(book, grt.classes.test_Book)"));
+  ensure("Slice", eval_bool("type(book.authors[2:5]) is list and len(book.authors[2:5]) == 3"));
+  ensure("Slice items", eval_bool("book.authors[2:5][0] is book.authors[2]"));
+  ensure("Open slice", eval_bool("len(book.authors[8:100]) == 2 and len(book.authors[:]) == 10"));
+  ensure("Dict copy", eval_bool("book.extras.copy() == {'isbn': '1234'}"));
+
+  ensure_equals("Set attribute", ctx->run_buffer("book.title = 'Other Title'\nbook.authors.extend([grt.classes.test_Author()])\n"), 0);
+  ensure_equals("Title set from Python", *book->title(), "Other Title");
+  ensure_equals("List extended from Python", book->authors().count(), (size_t)11);
+  ensure("Unknown attribute", eval_bool("not hasattr(book, 'nonexisting')"));
+}
+
+// Values read and written through the cached member getters, indexing and slicing must be the
+// ones of the GRT objects, also when the objects change on the C++ side and for members of the same
+// name in different classes.
+TEST_FUNCTION(10)
+{
+  test_BookRef book(grt);
+  book->title("Some Title");
+  book->pages(321);
+  book->price(9.5);
+  test_PublisherRef publisher(grt);
+  publisher->name("Publisher");
+  book->publisher(publisher);
+  for (int i= 0; i < LIST_ITEMS; i++)
+  {
+    test_AuthorRef author(grt);
+    author->name(base::strfmt("Author %i", i));
+    book->authors().insert(author);
+  }
+  set_global("book", book);
+  run(base::strfmt("expected = ['Author %%d' %% i for i in range(%i)]\n", LIST_ITEMS));
+
+  ensure("Get via iteration", eval_bool("[a.name for a in book.authors] == expected"));
+  ensure("Get via index", eval_bool("[book.authors[i].name for i in range(len(book.authors))] == expected"));
+  ensure("Get via slice", eval_bool("[a.name for a in book.authors[:]] == expected"));
+  ensure("Get via partial slice", eval_bool("[a.name for a in book.authors[10:20]] == expected[10:20]"));
+  ensure("Members of other types", eval_bool("book.title == 'Some Title' and book.pages == 321 and book.price == 9.5"));
+
+  // Publisher and author both have a name member.
+  ensure("Same member name in another class", eval_bool("book.publisher.name == 'Publisher'"));
+  ensure("Author name after publisher name", eval_bool("book.authors[0].name == 'Author 0'"));
+
+  run("for i, author in enumerate(book.authors):\n"
+    "  author.name = 'Name %d' % (i * 2)\n"
+    "book.pages = 123\n"
+    "book.publisher.name = 'Other Publisher'\n");
+  for (int i= 0; i < LIST_ITEMS; i++)
+    ensure_equals("Name set from Python", *book->authors()[i]->name(), base::strfmt("Name %i", i * 2));
+  ensure_equals("Int set from Python", *book->pages(), 123);
+  ensure_equals("Name of other class set from Python", *book->publisher()->name(), "Other Publisher");
+
+  // Changes on the C++ side must be visible through the already existing wrappers.
+  run("authors = book.authors\n"
+    "author = authors[5]\n");
+  book->authors()[5]->name("Changed");
+  book->authors().remove(0);
+  ensure("Changed value via wrapper", eval_bool("author.name == 'Changed'"));
+  ensure("Changed value via index", eval_bool("authors[4].name == 'Changed'"));
+  ensure_equals("Changed list length", book->authors().count(), (size_t)LIST_ITEMS - 1);
+  ensure("Changed list via slice", eval_bool("len(authors[:]) == len(book.authors) and authors[:][4] is author"));
+}
+
+END_TESTS
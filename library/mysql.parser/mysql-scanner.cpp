@@ -86,18 +86,7 @@ MySQLScanner::MySQLScanner(const char *text, size_t length, bool is_utf8, long s
   // (everything requiring only one byte per char as Latin1, ASCII and similar).
   d->_input_encoding = is_utf8 ? ANTLR3_ENC_UTF8 : ANTLR3_ENC_8BIT;
   setup();
-
-  // Cache the tokens. There's always at least one token: the EOF token.
-  // It might seem counter productive to load all tokens upfront, but this makes many
-  // things a lot simpler or even possible. The token stream used by a parser does exactly the same.
-  d->_token_index = 0;
-  while (true)
-  {
-    pANTLR3_COMMON_TOKEN token = d->_token_source->nextToken(d->_token_source);
-    d->_tokens.push_back(token);
-    if (token->type == ANTLR3_TOKEN_EOF)
-      break;
-  }
+  fetch_tokens();
 }
 
 //--------------------------------------------------------------------------------------------------
@@ -119,6 +108,60 @@ void MySQLScanner::reset()
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Scans a new text, reusing the input stream, lexer and token factory of the previous run.
+ * As with the constructor the text must stay valid as long as the scanner uses it.
+ */
+void MySQLScanner::set_text(const char *text, size_t length, bool is_utf8)
+{
+  MySQLRecognitionBase::reset();
+
+  d->_text = text;
+  d->_text_length = length;
+
+  // The previous text might have ended within a version comment.
+  d->_context.inVersionComment = false;
+  d->_context.versionMatched = false;
+
+  // Token texts are allocated by the string factory of the input stream and are only freed when the stream
+  // is closed. So start over from time to time, as well as when the encoding changes (the stream cannot switch that).
+  int encoding = is_utf8 ? ANTLR3_ENC_UTF8 : ANTLR3_ENC_8BIT;
+  if (encoding != d->_input_encoding || d->_input->strFactory->index > 10000)
+  {
+    d->_lexer->free(d->_lexer);
+    d->_input->close(d->_input);
+    d->_input_encoding = encoding;
+    setup();
+  }
+  else
+  {
+    d->_input->reuse(d->_input, (pANTLR3_UINT8)d->_text, (ANTLR3_UINT32)d->_text_length, (pANTLR3_UINT8)"mysql-script");
+    d->_lexer->reset(d->_lexer); // Also resets the token factory, so the token memory is reused.
+  }
+
+  fetch_tokens();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MySQLScanner::fetch_tokens()
+{
+  // Cache the tokens. There's always at least one token: the EOF token.
+  // It might seem counter productive to load all tokens upfront, but this makes many
+  // things a lot simpler or even possible. The token stream used by a parser does exactly the same.
+  d->_tokens.clear();
+  d->_token_index = 0;
+  while (true)
+  {
+    pANTLR3_COMMON_TOKEN token = d->_token_source->nextToken(d->_token_source);
+    d->_tokens.push_back(token);
+    if (token->type == ANTLR3_TOKEN_EOF)
+      break;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 /**
  * All token information in one call.
  */
@@ -35,6 +35,7 @@ public:
 
   static MySQLQueryType getQueryType(const char *text, size_t length, bool is_utf8, long server_version);
   void reset();
+  void set_text(const char *text, size_t length, bool is_utf8);
 
   // Informations about the current token.
   MySQLToken token();
@@ -75,6 +76,8 @@ protected:
 private:
   class Private;
   Private *d;
+
+  void fetch_tokens();
 };
 
 /**
@@ -21,8 +21,11 @@
 
 #include "MySQLLexer.h"
 
+#include "grtdb/db_helpers.h"
+#include "grtsqlparser/mysql_parser_services.h"
 #include "grtsqlparser/sql_facade.h"
 #include "mysql-parser.h"
+#include "mysql-scanner.h"
 
 
 #include <boost/assign/list_of.hpp>
@@ -892,6 +895,152 @@ TEST_FUNCTION(40)
   }
 }
 
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns all tokens of the last parse run of the given recognizer as "type:channel:text" strings.
+ */
+static std::vector<std::string> recognizer_tokens(MySQLRecognizer &recognizer)
+{
+  std::vector<std::string> result;
+  for (ANTLR3_MARKER index = 0; ; ++index)
+  {
+    MySQLToken token = recognizer.token_at_index(index);
+    if (token.type == INVALID_TOKEN || token.type == ANTLR3_TOKEN_EOF)
+      break;
+    result.push_back(base::strfmt("%u:%u:%s", token.type, token.channel, token.text.c_str()));
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns all tokens of the given scanner (from its current position on) as "type:text" strings.
+ */
+static std::vector<std::string> scanner_tokens(MySQLScanner &scanner)
+{
+  std::vector<std::string> result;
+  while (scanner.token_type() != ANTLR3_TOKEN_EOF)
+  {
+    result.push_back(base::strfmt("%u:%s", scanner.token_type(), scanner.token_text().c_str()));
+    scanner.next(false);
+  }
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void ensure_same_tokens(const std::string &message, const std::vector<std::string> &actual,
+  const std::vector<std::string> &expected)
+{
+  tut::ensure_equals(message + ": token count", actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i)
+    tut::ensure_equals(base::strfmt("%s: token %u", message.c_str(), (unsigned)i), actual[i], expected[i]);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void ensure_same_errors(const std::string &message, const std::vector<MySQLParserErrorInfo> &actual,
+  const std::vector<MySQLParserErrorInfo> &expected)
+{
+  tut::ensure_equals(message + ": error count", actual.size(), expected.size());
+  for (size_t i = 0; i < actual.size(); ++i)
+  {
+    tut::ensure_equals(message + ": error message", actual[i].message, expected[i].message);
+    tut::ensure_equals(message + ": error token", actual[i].token_type, expected[i].token_type);
+    tut::ensure_equals(message + ": error offset", actual[i].charOffset, expected[i].charOffset);
+    tut::ensure_equals(message + ": error line", actual[i].line, expected[i].line);
+    tut::ensure_equals(message + ": error line offset", actual[i].offset, expected[i].offset);
+    tut::ensure_equals(message + ": error length", actual[i].length, expected[i].length);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Recognizers and scanners taken from parser contexts are reused (the recognizers via the process-wide
+ * pool, the scanners per context). They must return the same tokens and errors as new ones for the same input.
+ * Each file gets its own parser context, so the recognizer used for a file has parsed the previous file
+ * before. Timings for both variants are in the parser_benchmark tool.
+ */
+TEST_FUNCTION(45)
+{
+  SqlFacade::Ref sql_facade = SqlFacade::instance_for_rdbms_name(_tester.grt, "Mysql");
+  GrtVersionRef version = bec::parse_version(_tester.grt, "5.6.4");
+  MySQLScanner reused_scanner("", 0, true, 50604, "ANSI_QUOTES", _charsets);
+
+  // Put a recognizer into the pool which has already parsed something.
+  {
+    parser::ParserContext::Ref context = parser::MySQLParserServices::createParserContext(
+      _tester.get_rdbms()->characterSets(), version, false);
+    context->recognizer()->parse("select 1 from", 13, true, PuGeneric);
+    ensure("Warm-up query has errors", context->recognizer()->has_errors());
+  }
+
+  // Invalid statements too, so that error_info() is compared with content.
+  const char *invalid_statements[] = {
+    "select 1 from",
+    "create table t1 (a int primary key, b varchar(10) unknown)",
+    "select \"a\" from t1 where"
+  };
+
+  for (size_t i = 0; i < sizeof(test_files) / sizeof(test_files[0]); ++i)
+  {
+    gchar *sql = NULL;
+    gsize  size = 0;
+    g_file_get_contents(test_files[i].name, &sql, &size, NULL);
+    ensure("Error loading sql file", sql != NULL);
+
+    std::vector<std::pair<size_t, size_t> > ranges;
+    sql_facade->splitSqlScript(sql, size, test_files[i].initial_delmiter, ranges, test_files[i].line_break);
+
+    parser::ParserContext::Ref context = parser::MySQLParserServices::createParserContext(
+      _tester.get_rdbms()->characterSets(), version, false);
+    context->use_sql_mode("ANSI_QUOTES");
+    MySQLRecognizer *pooled_recognizer = context->recognizer();
+
+    for (size_t j = 0; j < ranges.size() + sizeof(invalid_statements) / sizeof(invalid_statements[0]); ++j)
+    {
+      std::string statement;
+      bool is_utf8 = true;
+      if (j < ranges.size())
+      {
+        statement.assign(sql + ranges[j].first, ranges[j].second);
+        is_utf8 = test_files[i].is_utf8;
+      }
+      else
+        statement = invalid_statements[j - ranges.size()];
+      std::string message = base::strfmt("%s, statement %u", test_files[i].name, (unsigned)j);
+
+      MySQLRecognizer recognizer(50604, "ANSI_QUOTES", _charsets);
+      recognizer.parse(statement.c_str(), statement.size(), is_utf8, PuGeneric);
+      pooled_recognizer->parse(statement.c_str(), statement.size(), is_utf8, PuGeneric);
+      ensure_same_tokens(message + ": recognizer", recognizer_tokens(*pooled_recognizer),
+        recognizer_tokens(recognizer));
+      ensure_same_errors(message, pooled_recognizer->error_info(), recognizer.error_info());
+
+      MySQLScanner scanner(statement.c_str(), statement.size(), is_utf8, 50604, "ANSI_QUOTES", _charsets);
+      std::vector<std::string> tokens = scanner_tokens(scanner);
+
+      reused_scanner.set_text(statement.c_str(), statement.size(), is_utf8);
+      ensure_same_tokens(message + ": reused scanner", scanner_tokens(reused_scanner), tokens);
+
+      // The context hands out the same scanner again for the same text, which must start over.
+      // Context scanners always scan utf-8.
+      for (size_t k = 0; is_utf8 && k < 2; ++k)
+      {
+        boost::shared_ptr<MySQLScanner> context_scanner = context->createScanner(statement);
+        ensure_same_tokens(message + ": context scanner", scanner_tokens(*context_scanner), tokens);
+      }
+    }
+
+    g_free(sql);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
 // TODO: create tests for restricted content parsing (e.g. routines only, views only etc.).
 
 END_TESTS;
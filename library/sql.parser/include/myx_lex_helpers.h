@@ -7,17 +7,6 @@
 namespace mysql_parser
 {
 
-extern const void *tree;
-
-struct Lex_args
-{
-  void *arg1;
-  void *arg2;
-};
-extern struct Lex_args lex_args;
-
-extern std::istream* lex_input_stream;
-
 extern int yylex(void **yylval);
 extern void yyerror(const char *msg);
 //extern int yywrap();
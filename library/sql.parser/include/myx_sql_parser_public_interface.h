@@ -97,8 +97,7 @@ MYX_PUBLIC_FUNC int myx_process_sql_statements_from_file(const char *filename,
                                                void *user_data, 
                                                int mode);
 
-MYX_PUBLIC_FUNC void myx_set_parser_source(const char *sql);
-MYX_PUBLIC_FUNC void myx_free_parser_source(void);
+// The functions below work with the current SqlAstContext of the calling thread.
 MYX_PUBLIC_FUNC void myx_parse(void);
 MYX_PUBLIC_FUNC const std::string & myx_get_err_msg(void);
 MYX_PUBLIC_FUNC const void * myx_get_parser_tree(void);
@@ -114,9 +113,6 @@ MYX_PUBLIC_FUNC void tree_item_dump_xml_to_file(const void * tree_item,
 
 #ifdef __cplusplus
 }
-
-MYX_PUBLIC_FUNC void myx_set_parser_input(std::istream *sqlstream);
-
 #endif /* __cplusplus */
 
 } // namespace mysql_parser
@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <stdarg.h>
+#include <new>
 #include <boost/shared_ptr.hpp>
 
 
@@ -45,48 +46,159 @@ const char* find_str_in_array_ci(const char *arr[], size_t arr_size, const std::
 class SqlAstNode;
 class SqlAstTerminalNode;
 class SqlAstNonTerminalNode;
-class SqlAstStatics
+
+/**
+ * State of a single parser run: the arena all AST nodes, their subitem lists and token values are
+ * allocated from, the resulting tree and the parsed statement. Memory is only released when the context
+ * is destroyed, all at once, no node destructors are run.
+ *
+ * Creating a context makes it the current one for the calling thread, which is what the scanner and the
+ * generated parser work with (see SqlAstStatics). The previously current context is restored on destruction,
+ * so contexts nest and parsing is reentrant. Several threads can parse at the same time, each with its own context.
+ */
+class MYSQL_SQL_PARSER_PUBLIC_FUNC SqlAstContext
 {
+public:
+  SqlAstContext();
+  ~SqlAstContext();
+
+  static SqlAstContext * current();
+
+  // Makes the previously current context current again, e.g. before the tree is handed over to another thread.
+  void leave();
+
+  void * allocate(size_t size);
+  const char * copy_string(const char *value);
+
+  const SqlAstNode * tree() const { return _tree; }
+  void tree(const SqlAstNode *tree) { _tree= tree; }
+
+  const char * sql_statement() const { return _sql_statement; }
+  void sql_statement(const char *val) { _sql_statement= val; }
+
+  bool is_ast_generation_enabled() const { return _is_ast_generation_enabled; }
+  void is_ast_generation_enabled(bool val) { _is_ast_generation_enabled= val; }
+
+  const std::string & err_msg() const { return _err_msg; }
+  void err_msg(const std::string &val) { _err_msg= val; }
+
+  // scanner state (LEX) used by yylex()
+  void * lex() const { return _lex; }
+  void lex(void *val) { _lex= val; }
+
+  // With AST generation disabled only the first and the last token of a statement are kept, in these 2 nodes.
+  SqlAstTerminalNode * terminal_node(bool first, const char *value, int value_length, int stmt_lineno, int stmt_boffset, int stmt_eoffset);
+
 private:
-  static std::list<SqlAstNode *> _ast_nodes; // flat list of all allocated ast nodes
+  static const size_t BLOCK_SIZE= 32768;
+
+#ifdef _MSC_VER
+#pragma warning(push)
+#pragma warning(disable: 4251)
+#endif
+  std::list<char *> _blocks;
+  std::string _err_msg;
+  std::string _terminal_values[2];
+#ifdef _MSC_VER
+#pragma warning(pop)
+#endif
+  char *_block_pos;
+  size_t _block_left;
+  SqlAstContext *_previous;
+
+  const SqlAstNode *_tree;
+  const char *_sql_statement;
+  bool _is_ast_generation_enabled;
+  void *_lex;
+  SqlAstTerminalNode *_terminal_nodes[2];
+
+  SqlAstContext(const SqlAstContext &);
+  SqlAstContext & operator= (const SqlAstContext &);
+};
+
+
+/**
+ * Allocator for the subitem lists of AST nodes, taking memory from the arena of a parse context.
+ * Without a context the heap is used.
+ */
+template <typename T>
+class SqlAstAllocator
+{
 public:
-  static SqlAstNode * add_ast_node(SqlAstNode *ast_node)
+  typedef T value_type;
+  typedef T * pointer;
+  typedef const T * const_pointer;
+  typedef T & reference;
+  typedef const T & const_reference;
+  typedef size_t size_type;
+  typedef ptrdiff_t difference_type;
+
+  template <typename U> struct rebind { typedef SqlAstAllocator<U> other; };
+
+  SqlAstAllocator(SqlAstContext *context= NULL) : _context(context) {}
+  template <typename U> SqlAstAllocator(const SqlAstAllocator<U> &other) : _context(other.context()) {}
+
+  SqlAstContext * context() const { return _context; }
+
+  pointer address(reference x) const { return &x; }
+  const_pointer address(const_reference x) const { return &x; }
+
+  pointer allocate(size_type n, const void * = 0)
   {
-    _ast_nodes.push_back(ast_node);
-    return ast_node;
+    if (_context)
+      return static_cast<pointer>(_context->allocate(n * sizeof(T)));
+    return static_cast<pointer>(::operator new(n * sizeof(T)));
   }
-  static void cleanup_ast_nodes();
+  void deallocate(pointer p, size_type)
+  {
+    // arena memory is released together with its context
+    if (!_context)
+      ::operator delete(p);
+  }
+
+  size_type max_size() const { return size_t(-1) / sizeof(T); }
+  void construct(pointer p, const T &val) { new (static_cast<void *>(p)) T(val); }
+  void destroy(pointer p) { p->~T(); }
+
+  template <typename U> bool operator== (const SqlAstAllocator<U> &other) const { return _context == other.context(); }
+  template <typename U> bool operator!= (const SqlAstAllocator<U> &other) const { return _context != other.context(); }
 
 private:
-  static const SqlAstNode *_tree;
+  SqlAstContext *_context;
+};
+
+
+/**
+ * Access to the current parse context (see SqlAstContext) in the form used by the generated parser code.
+ */
+class MYSQL_SQL_PARSER_PUBLIC_FUNC SqlAstStatics
+{
 public:
-  static const SqlAstNode * tree() { return _tree; }
+  static const SqlAstNode * tree();
   static void tree(const SqlAstNode *tree);
 
-public:
-  static bool is_ast_generation_enabled;
-  
-  static boost::shared_ptr<SqlAstTerminalNode> first_terminal_node();
-  static boost::shared_ptr<SqlAstTerminalNode> last_terminal_node();
-  
-  static void first_terminal_node(boost::shared_ptr<SqlAstTerminalNode> value);
-  static void last_terminal_node(boost::shared_ptr<SqlAstTerminalNode> value);
-private:
-  static const char *_sql_statement;
-public:
-  static const char * sql_statement() { return _sql_statement; }
-  static void sql_statement(const char *val) { _sql_statement= val; }
+  // Reads and writes the flag of the current context, looks like a plain bool to the generated parser.
+  struct MYSQL_SQL_PARSER_PUBLIC_FUNC Ast_generation_flag
+  {
+    operator bool() const;
+    Ast_generation_flag & operator= (bool val);
+  };
+  static Ast_generation_flag is_ast_generation_enabled;
+
+  static const char * sql_statement();
+  static void sql_statement(const char *val);
 };
 
 // pattern composite
 class MYSQL_SQL_PARSER_PUBLIC_FUNC SqlAstNode
 {
 public:
-  typedef std::list<SqlAstNode *> SubItemList;
+  typedef std::list<SqlAstNode *, SqlAstAllocator<SqlAstNode *> > SubItemList;
 
 private:
   sql::symbol _name;      // _name is sql::symbol
-  boost::shared_ptr<std::string> _value;
+  const char *_value;     // either a copy owned by the parse context or a part of the statement text
+  int _value_size;
   int _value_length;      // _value_length is in bytes
   int _stmt_lineno;
   int _stmt_boffset;
@@ -110,10 +222,12 @@ private:
   void restore_sql_text(int &boffset, int &eoffset, const SqlAstNode *first_subitem, const SqlAstNode *last_subitem) const;
 
 public:
+  // value is not copied, it must live as long as the node (NULL refers to the statement text of the current context)
   SqlAstNode(sql::symbol name, const char *value, int value_length, int stmt_lineno, int stmt_boffset, int stmt_eoffset, SubItemList *items);
   virtual ~SqlAstNode();
 
   void set_name(sql::symbol name) { _name= name; }
+  void set_value(const char *value, int value_length, int stmt_lineno, int stmt_boffset, int stmt_eoffset);
   bool name_equals(sql::symbol to) const { return _name == to; }
   sql::symbol name() const { return _name; }
   std::string value() const;
@@ -151,9 +265,10 @@ class SqlAstTerminalNode : public SqlAstNode
 {
   SubItemList _empty_list;
 public:
-  SqlAstTerminalNode() : SqlAstNode(sql::_, NULL, 0, -1, -1, -1, &_empty_list) {} 
-  SqlAstTerminalNode(const char *value, int value_length, int stmt_lineno, int stmt_boffset, int stmt_eoffset)
-    : SqlAstNode(sql::_, value, value_length, stmt_lineno, stmt_boffset, stmt_eoffset, &_empty_list) {} 
+  SqlAstTerminalNode(SqlAstContext *context)
+    : SqlAstNode(sql::_, NULL, 0, -1, -1, -1, &_empty_list), _empty_list(SqlAstAllocator<SqlAstNode *>(context)) {} 
+  SqlAstTerminalNode(SqlAstContext *context, const char *value, int value_length, int stmt_lineno, int stmt_boffset, int stmt_eoffset)
+    : SqlAstNode(sql::_, value, value_length, stmt_lineno, stmt_boffset, stmt_eoffset, &_empty_list), _empty_list(SqlAstAllocator<SqlAstNode *>(context)) {} 
 };
 
 
@@ -161,8 +276,8 @@ class SqlAstNonTerminalNode : public SqlAstNode
 {
   SubItemList _subitems;
 public:
-  SqlAstNonTerminalNode(sql::symbol name)
-    : SqlAstNode(name, NULL, 0, -1, -1, -1, &_subitems) {} 
+  SqlAstNonTerminalNode(SqlAstContext *context, sql::symbol name)
+    : SqlAstNode(name, NULL, 0, -1, -1, -1, &_subitems), _subitems(SqlAstAllocator<SqlAstNode *>(context)) {} 
   virtual ~SqlAstNonTerminalNode();
 };
 
@@ -44,8 +44,12 @@ class MYSQL_SQL_PARSER_PUBLIC_FUNC MyxStatementParser
   int peek_next_char(std::istream& is, int *len);
   void add_char_to_buffer(std::string& buffer, int c, int len) const;
 
+  MyxStatementParser & operator= (const MyxStatementParser &);
+
 public:
   MyxStatementParser(CHARSET_INFO *charset);
+  // Copies the position info of the current statement only, the copy can't be used for splitting.
+  MyxStatementParser(const MyxStatementParser &other);
   virtual ~MyxStatementParser();
 
   void process(std::istream& is, process_sql_statement_callback, void *arg, int mode);
@@ -13,10 +13,6 @@
 namespace mysql_parser
 {
 
-std::istream* lex_input_stream= 0;
-static std::string err_msg;
-const void* tree= 0;
-struct Lex_args lex_args;
 extern int MYSQLlex(void **arg, void *yyl);
 
 int yylex(void **yylval) 
@@ -24,13 +20,13 @@ int yylex(void **yylval)
   //struct Lex_args *p= (struct Lex_args *)ptr_to_arg_pair;
   //return MYSQLlex(lex_args.arg1, lex_args.arg2); 
   
-  int state= mysql_parser::MYSQLlex(yylval, mysql_parser::lex_args.arg2);
+  int state= mysql_parser::MYSQLlex(yylval, SqlAstContext::current()->lex());
   //int state= myx_map_lexer_value(MYSQLlex(yylval, lex_args.arg2)); 
   //return state == END_OF_INPUT ? 0 : state;
   return state;
 }
 
-void yyerror(const char *msg) { mysql_parser::err_msg= msg; }
+void yyerror(const char *msg) { SqlAstContext::current()->err_msg(msg); }
 /*
 int yywrap() { return 1; }  // stop after EOF
 
@@ -54,38 +50,17 @@ int yy_unknown_token(const char *value)
 
 MYX_PUBLIC_FUNC const std::string & myx_get_err_msg()
 {
-  return err_msg;
+  return SqlAstContext::current()->err_msg();
 }
 
 MYX_PUBLIC_FUNC const void *myx_get_parser_tree()
 {
-  return tree;
-}
-
-MYX_PUBLIC_FUNC void myx_set_parser_input(std::istream *sqlstream)
-{
-  lex_input_stream= sqlstream;
-}
-
-MYX_PUBLIC_FUNC void myx_set_parser_source(const char *sql)
-{
-  lex_input_stream= new std::istringstream(sql);
-}
-
-MYX_PUBLIC_FUNC void myx_set_parser_source(std::istream *sqlstream)
-{
-  lex_input_stream= sqlstream;
-}
-
-MYX_PUBLIC_FUNC void myx_free_parser_source(void)
-{
-  delete lex_input_stream;
-  SqlAstStatics::cleanup_ast_nodes();
+  return SqlAstContext::current()->tree();
 }
 
 MYX_PUBLIC_FUNC void myx_parse(void)
 {
-  err_msg.clear();
+  SqlAstContext::current()->err_msg("");
   yyparse();
 }
 
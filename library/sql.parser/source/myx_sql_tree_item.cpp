@@ -92,68 +92,148 @@ MYX_PUBLIC_FUNC std::ostream& operator << (std::ostream& os, const SqlAstNode& i
 }
 
 
-std::list<SqlAstNode *> SqlAstStatics::_ast_nodes;
-const SqlAstNode * SqlAstStatics::_tree= NULL;
-const char * SqlAstStatics::_sql_statement= NULL;
-bool SqlAstStatics::is_ast_generation_enabled= true;
-static  boost::shared_ptr<SqlAstTerminalNode> _last_terminal_node;
-static  boost::shared_ptr<SqlAstTerminalNode> _first_terminal_node;
+#ifdef _MSC_VER
+#define SQL_AST_THREAD_LOCAL __declspec(thread)
+#else
+#define SQL_AST_THREAD_LOCAL __thread
+#endif
 
+static SQL_AST_THREAD_LOCAL SqlAstContext *current_context= NULL;
 
-void SqlAstStatics::tree(const SqlAstNode *tree)
+
+SqlAstContext::SqlAstContext()
+  :
+_block_pos(NULL),
+_block_left(0),
+_previous(current_context),
+_tree(NULL),
+_sql_statement(NULL),
+_is_ast_generation_enabled(true),
+_lex(NULL)
+{
+  _terminal_nodes[0]= _terminal_nodes[1]= NULL;
+  current_context= this;
+}
+
+
+SqlAstContext::~SqlAstContext()
+{
+  leave();
+  for (std::list<char *>::iterator i= _blocks.begin(), i_end= _blocks.end(); i != i_end; ++i)
+    delete[] *i;
+}
+
+
+SqlAstContext * SqlAstContext::current()
+{
+  return current_context;
+}
+
+
+void SqlAstContext::leave()
 {
-  _tree= tree;
-  mysql_parser::tree= _tree;
+  // a context left before (possibly on another thread) must not touch the current one
+  if (current_context == this)
+    current_context= _previous;
 }
 
 
-void SqlAstStatics::cleanup_ast_nodes()
+void * SqlAstContext::allocate(size_t size)
 {
-  for (std::list<SqlAstNode*>::iterator i= _ast_nodes.begin(), i_end= _ast_nodes.end(); i != i_end; ++i)
-    delete *i;
-  _ast_nodes.clear();
-  _tree= NULL;
-  //_sql_statement= NULL;
+  // keep everything aligned for pointers and doubles
+  size= (size + 7) & ~(size_t)7;
+  if (size > _block_left)
+  {
+    if (size > BLOCK_SIZE / 4)
+    {
+      // big chunks get a block of their own, so the current block can still be filled
+      _blocks.push_back(new char[size]);
+      return _blocks.back();
+    }
+    _blocks.push_back(new char[BLOCK_SIZE]);
+    _block_pos= _blocks.back();
+    _block_left= BLOCK_SIZE;
+  }
+  void *result= _block_pos;
+  _block_pos+= size;
+  _block_left-= size;
+  return result;
 }
 
-boost::shared_ptr<SqlAstTerminalNode> SqlAstStatics::first_terminal_node()
+
+const char * SqlAstContext::copy_string(const char *value)
 {
-  if (_first_terminal_node == NULL)
-    first_terminal_node(boost::shared_ptr<SqlAstTerminalNode>(new SqlAstTerminalNode));
-  
-  return _first_terminal_node;
+  size_t size= strlen(value) + 1;
+  return static_cast<const char *>(memcpy(allocate(size), value, size));
 }
 
-boost::shared_ptr<SqlAstTerminalNode> SqlAstStatics::last_terminal_node()
+
+SqlAstTerminalNode * SqlAstContext::terminal_node(bool first, const char *value, int value_length, int stmt_lineno, int stmt_boffset, int stmt_eoffset)
 {
-  if (_last_terminal_node == NULL)
-    last_terminal_node(boost::shared_ptr<SqlAstTerminalNode>(new SqlAstTerminalNode));
-  
-  return _last_terminal_node;
+  int n= first ? 0 : 1;
+  if (!_terminal_nodes[n])
+    _terminal_nodes[n]= new (allocate(sizeof(SqlAstTerminalNode))) SqlAstTerminalNode(this);
+
+  // the node is reused for every token, so its value can't live in the arena
+  if (value)
+  {
+    _terminal_values[n]= value;
+    value= _terminal_values[n].c_str();
+  }
+  _terminal_nodes[n]->set_value(value, value_length, stmt_lineno, stmt_boffset, stmt_eoffset);
+  return _terminal_nodes[n];
 }
 
-void SqlAstStatics::first_terminal_node(boost::shared_ptr<SqlAstTerminalNode> value)
+
+SqlAstStatics::Ast_generation_flag SqlAstStatics::is_ast_generation_enabled;
+
+
+SqlAstStatics::Ast_generation_flag::operator bool() const
 {
-  _first_terminal_node = value;
+  return !current_context || current_context->is_ast_generation_enabled();
 }
 
-void SqlAstStatics::last_terminal_node(boost::shared_ptr<SqlAstTerminalNode> value)
+
+SqlAstStatics::Ast_generation_flag & SqlAstStatics::Ast_generation_flag::operator= (bool val)
 {
-  _last_terminal_node = value;
+  if (current_context)
+    current_context->is_ast_generation_enabled(val);
+  return *this;
 }
 
+
+const SqlAstNode * SqlAstStatics::tree()
+{
+  return current_context ? current_context->tree() : NULL;
+}
+
+
+void SqlAstStatics::tree(const SqlAstNode *tree)
+{
+  if (current_context)
+    current_context->tree(tree);
+}
+
+
+const char * SqlAstStatics::sql_statement()
+{
+  return current_context ? current_context->sql_statement() : NULL;
+}
+
+
+void SqlAstStatics::sql_statement(const char *val)
+{
+  if (current_context)
+    current_context->sql_statement(val);
+}
+
+
 SqlAstNode::SqlAstNode(sql::symbol name, const char *value, int value_length, int stmt_lineno, int stmt_boffset, int stmt_eoffset, SubItemList *items)
   :
 _name(name),
-_value((value) ? new std::string(value) : NULL),
-_value_length(value_length),
-_stmt_lineno(stmt_lineno),
-_stmt_boffset(stmt_boffset),
-_stmt_eoffset(stmt_eoffset),
 _subitems(items)
 {
-  if (-1 != _stmt_eoffset && (_stmt_boffset + _value_length) > _stmt_eoffset)
-    _stmt_eoffset= _stmt_boffset + _value_length;
+  set_value(value, value_length, stmt_lineno, stmt_boffset, stmt_eoffset);
 }
 
 
@@ -162,14 +242,36 @@ SqlAstNode::~SqlAstNode()
 }
 
 
-std::string SqlAstNode::value() const
+void SqlAstNode::set_value(const char *value, int value_length, int stmt_lineno, int stmt_boffset, int stmt_eoffset)
 {
-  if (_value.get())
-    return *_value;
-  else if (_value_length)
-    return std::string(SqlAstStatics::sql_statement() + _stmt_boffset, _value_length);
+  _value_length= value_length;
+  _stmt_lineno= stmt_lineno;
+  _stmt_boffset= stmt_boffset;
+  _stmt_eoffset= stmt_eoffset;
+  if (-1 != _stmt_eoffset && (_stmt_boffset + _value_length) > _stmt_eoffset)
+    _stmt_eoffset= _stmt_boffset + _value_length;
+
+  if (value)
+  {
+    _value= value;
+    _value_size= (int)strlen(value);
+  }
+  else if (_value_length > 0 && SqlAstStatics::sql_statement())
+  {
+    _value= SqlAstStatics::sql_statement() + _stmt_boffset;
+    _value_size= _value_length;
+  }
   else
-    return "";
+  {
+    _value= NULL;
+    _value_size= 0;
+  }
+}
+
+
+std::string SqlAstNode::value() const
+{
+  return _value ? std::string(_value, _value_size) : std::string();
 }
 
 
@@ -592,9 +694,7 @@ char * SqlAstNode::subitems_as_string(const char *delim) const
 
 SqlAstNonTerminalNode::~SqlAstNonTerminalNode()
 {
-  // no need in this code after flat list of all allocated ast nodes was introduced, see SqlAstStatics::_ast_nodes
-  //for (SubItemList::iterator i= _subitems.begin(), end= _subitems.end(); i != end; ++i)
-  //  delete *i;
+  // nodes live in the arena of their SqlAstContext and are freed together with it, destructors aren't called
 }
 
 
@@ -603,8 +703,10 @@ SqlAstNonTerminalNode::~SqlAstNonTerminalNode()
 
   extern void * new_ast_node(sql::symbol name)
   {
-    SqlAstNode *node= SqlAstStatics::add_ast_node(new SqlAstNonTerminalNode(name));
-    return node;
+    SqlAstContext *context= SqlAstContext::current();
+    if (!context)
+      return NULL;
+    return new (context->allocate(sizeof(SqlAstNonTerminalNode))) SqlAstNonTerminalNode(context, name);
   }
 
   extern void * reuse_ast_node(void *node_, sql::symbol name)
@@ -30,6 +30,13 @@ MyxStatementParser::MyxStatementParser(CHARSET_INFO *charset)
   char_buffer_e= char_buffer_b= char_buffer + CHAR_BUFFER_SIZE;
 }
 
+MyxStatementParser::MyxStatementParser(const MyxStatementParser &other)
+  : delim(other.delim), cs(other.cs), char_buffer(NULL), char_buffer_b(NULL), char_buffer_e(NULL), eof_hit(other.eof_hit),
+  _stmt_boffset(other._stmt_boffset), _stmt_first_line_first_symbol_pos(other._stmt_first_line_first_symbol_pos),
+  _symbols_since_newline(other._symbols_since_newline), _total_lc(other._total_lc)
+{
+}
+
 MyxStatementParser::~MyxStatementParser()
 {
   delete[] char_buffer;
@@ -198,6 +198,9 @@ void lex_init(void)
   for (i=0 ; i < array_elements(sql_functions) ; i++)
     sql_functions[i].length=(uchar) strlen(sql_functions[i].name);
 
+  // build the keyword hash tables now, statements may be scanned on several threads later
+  get_hash_symbol("SELECT", 6, false);
+
   DBUG_VOID_RETURN;
 }
 
@@ -267,6 +270,7 @@ void lex_start(/*THD *thd, */LEX *lex, const uchar *buf, uint length)
   //lex->select_lex.select_number= 1;
   lex->next_state=MY_LEX_START;
   lex->yylineno = 1;
+  lex->token_start_lineno = 1;
   lex->in_comment=0;
   lex->length=0;
   lex->part_info= 0;
@@ -338,17 +342,23 @@ void lex_end(LEX *lex)
 #endif
 }
 
-int token_start_lineno;
 inline SqlAstNode * new_ast_terminal_node(LEX *lex, const char* value, int value_length, char *lex_string_to_free)
 {
-  if (SqlAstStatics::is_ast_generation_enabled)
+  SqlAstContext *context= SqlAstContext::current();
+  if (!context)
+  {
+    free(lex_string_to_free);
+    return NULL;
+  }
+  if (context->is_ast_generation_enabled())
   {
-    lex->last_item= *lex->yylval= SqlAstStatics::add_ast_node(new SqlAstTerminalNode(
-      value,
+    lex->last_item= *lex->yylval= new (context->allocate(sizeof(SqlAstTerminalNode))) SqlAstTerminalNode(
+      context,
+      value ? context->copy_string(value) : NULL,
       value_length,
-      token_start_lineno,
+      lex->token_start_lineno,
       /*stmt_boffset*/(lex->tok_start - lex->buf),
-      /*stmt_eoffset*/(lex->ptr - lex->buf)));
+      /*stmt_eoffset*/(lex->ptr - lex->buf));
     if (!lex->first_item)
       lex->first_item= lex->last_item;
     free(lex_string_to_free);
@@ -356,22 +366,16 @@ inline SqlAstNode * new_ast_terminal_node(LEX *lex, const char* value, int value
   }
   else
   {
-    boost::shared_ptr<SqlAstTerminalNode> node(new SqlAstTerminalNode(
+    // only the first and the last token are of interest, so just 2 nodes are reused for all tokens
+    lex->last_item= context->terminal_node(!lex->first_item,
         value,
         value_length,
-        token_start_lineno,
+        lex->token_start_lineno,
         /*stmt_boffset*/(lex->tok_start - lex->buf),
-        /*stmt_eoffset*/(lex->ptr - lex->buf)));
-    
-    lex->last_item = node.get();
-    SqlAstStatics::last_terminal_node(node);
-    
+        /*stmt_eoffset*/(lex->ptr - lex->buf));
     if (!lex->first_item)
-    {
-      lex->first_item = node.get();
-      SqlAstStatics::first_terminal_node(node);
-    }
-    
+      lex->first_item= lex->last_item;
+
     free(lex_string_to_free);
     return NULL;
   }
@@ -732,7 +736,7 @@ int MYSQLlex(void **arg, void *yyl)
 
   lex->yylval=yylval;			// The global state
 
-  token_start_lineno= lex->yylineno;
+  lex->token_start_lineno= lex->yylineno;
 
   lex->tok_end_prev= lex->tok_end;
   lex->tok_start_prev= lex->tok_start;
@@ -753,7 +757,7 @@ int MYSQLlex(void **arg, void *yyl)
       for (c=yyGet() ; state_map[c] == MY_LEX_SKIP ; c= yyGet()) ;
       lex->tok_start=lex->ptr-1;	// Start of real token
       state= (enum my_lex_states) state_map[c];
-      token_start_lineno= lex->yylineno;
+      lex->token_start_lineno= lex->yylineno;
       break;
     case MY_LEX_ESCAPE:
       if (yyGet() == 'N')
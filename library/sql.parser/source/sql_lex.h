@@ -778,6 +778,7 @@ enum xa_option_words {XA_NONE, XA_JOIN, XA_RESUME, XA_ONE_PHASE,
 typedef struct st_lex
 {
   uint	 yylineno,yytoklen;			/* Simulate lex */
+  uint	 token_start_lineno;			/* Line of the current token start */
   SqlAstNode **yylval;
   SqlAstNode *first_item;
   SqlAstNode *last_item;
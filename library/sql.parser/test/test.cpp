@@ -51,8 +51,8 @@ int main(int argc, char* argv[])
   lex_start(&lex, reinterpret_cast<const unsigned char *>(query), (unsigned int)strlen(query));
   lex.charset= get_charset_by_name("utf8_bin", MYF(0));
 
-  lex_args.arg1= &yystype;
-  lex_args.arg2= &lex;
+  SqlAstContext context;
+  context.lex(&lex);
 
   yytokentype retval;
 
@@ -29,6 +29,11 @@
 #include "base/string_utilities.h"
 #include "base/util_functions.h"
 #include "base/log.h"
+#include "base/threading.h"
+
+#include <boost/bind.hpp>
+#include <boost/cstdint.hpp>
+#include <boost/scoped_ptr.hpp>
 
 #include "grtpp_util.h"
 
@@ -1872,7 +1877,7 @@ static void fillTableCreateItem(MySQLRecognizerTreeWalker &walker, db_CatalogRef
 
 static std::pair<std::string, bool> fillTableDetails(MySQLRecognizerTreeWalker &walker,
   db_mysql_CatalogRef catalog, db_mysql_SchemaRef schema, db_mysql_TableRef &table,
-  bool caseSensistive, bool autoGenerateFkNames, DbObjectsRefsCache &refCache)
+  bool caseSensistive, bool autoGenerateFkNames, DbObjectsRefsCache &refCache, bool *isCopy = NULL)
 {
   std::pair<std::string, bool> result("", false);
 
@@ -1899,6 +1904,8 @@ static std::pair<std::string, bool> fillTableDetails(MySQLRecognizerTreeWalker &
   if (walker.is(OPEN_PAR_SYMBOL) && walker.look_ahead(true) == LIKE_SYMBOL
     || walker.is(LIKE_SYMBOL))
   {
+    if (isCopy != NULL)
+      *isCopy = true;
     walker.next(walker.is(OPEN_PAR_SYMBOL) ? 2 : 1);
     Identifier reference = getIdentifier(walker);
     db_SchemaRef schema = catalog->defaultSchema();
@@ -2167,6 +2174,448 @@ void resolveReferences(db_mysql_CatalogRef catalog, DbObjectsRefsCache refCache,
   }
 }
 
+//------------------ ParseResultCache --------------------------------------------------------------
+
+/**
+ * Records which members of an object are set while it is filled by the parser. Only these members
+ * make up a cached parse result, everything else in the object is left alone on a cache hit, just as
+ * parsing would.
+ */
+class MemberRecorder
+{
+public:
+  MemberRecorder(grt::ObjectRef object)
+    : _object(object)
+  {
+    _changedConnection = object->signal_changed()->connect(boost::bind(&MemberRecorder::memberChanged, this, _1));
+    _listChangedConnection = object->signal_list_changed()->connect(boost::bind(&MemberRecorder::listChanged, this, _1));
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  // For list members the parser clears: an empty list cleared and left empty sends no change.
+  void add(const std::string &member)
+  {
+    _members.insert(member);
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  bool contains(const std::string &member) const
+  {
+    return _members.find(member) != _members.end();
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  const std::set<std::string> &members() const
+  {
+    return _members;
+  }
+
+private:
+  void memberChanged(const std::string &member)
+  {
+    _members.insert(member);
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  void listChanged(grt::internal::OwnedList *list)
+  {
+    for (grt::MetaClass *meta = _object.get_metaclass(); meta != NULL; meta = meta->parent())
+    {
+      for (grt::MetaClass::MemberList::const_iterator iterator = meta->get_members_partial().begin();
+        iterator != meta->get_members_partial().end(); ++iterator)
+      {
+        if (iterator->second.type.base.type == ListType
+          && _object.get_member(iterator->first).valueptr() == static_cast<grt::internal::Value *>(list))
+        {
+          _members.insert(iterator->first);
+          return;
+        }
+      }
+    }
+  }
+
+  grt::ObjectRef _object;
+  std::set<std::string> _members;
+  boost::signals2::scoped_connection _changedConnection;
+  boost::signals2::scoped_connection _listChangedConnection;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Keeps the results of parsing single object definitions (tables, views, routines, triggers), so that
+ * object editors and sync/diff runs get unchanged definitions by copying instead of parsing them again.
+ *
+ * Entries are keyed by the object type, everything in the parser context and the owning schema
+ * that influences the result and a hash of the sql. An entry stores a detached copy of the parsed
+ * object with only the members the parser set (a fragment). The sql is stored too, so a hash
+ * collision is only a cache miss.
+ * The parser module owns the cache, so it exists once per grt (and hence once per process in the
+ * application) and cached objects never outlive their grt. The cache is limited by the estimated
+ * memory of its entries. The least recently used entries are dropped first.
+ */
+class ParseResultCache
+{
+public:
+  ParseResultCache()
+    : _limit(DefaultLimit), _size(0), _hits(0), _misses(0)
+  {
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  static std::string makeKey(ParserContext::Ref context, const std::string &type, const std::string &sql,
+    const std::string &ownerDetails)
+  {
+    // FNV-1a.
+    boost::uint64_t hash = 14695981039346656037ULL;
+    for (std::string::const_iterator iterator = sql.begin(); iterator != sql.end(); ++iterator)
+    {
+      hash ^= (unsigned char)*iterator;
+      hash *= 1099511628211ULL;
+    }
+
+    GrtVersionRef version = context->get_server_version();
+    std::string versionText = version.is_valid() ? base::strfmt("%i.%i.%i", (int)version->majorNumber(),
+      (int)version->minorNumber(), (int)version->releaseNumber()) : "";
+
+    return base::strfmt("%s\n%s\n%s\n%i\n%s\n%016llx", type.c_str(), versionText.c_str(),
+      context->get_sql_mode().c_str(), context->case_sensitive() ? 1 : 0, ownerDetails.c_str(),
+      (unsigned long long)hash);
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  /**
+   * Copies the cached parse result for the key into the target object.
+   * Returns false if there is no entry (or the sql differs), in which case the caller has to parse.
+   */
+  bool materialize(const std::string &key, const std::string &sql, grt::ObjectRef target)
+  {
+    base::MutexLock lock(_mutex);
+    EntryMap::iterator iterator = _index.find(key);
+    if (iterator == _index.end() || iterator->second->sql != sql)
+    {
+      ++_misses;
+      return false;
+    }
+
+    ++_hits;
+    _entries.splice(_entries.begin(), _entries, iterator->second);
+    const Entry &entry = *iterator->second;
+
+    // References to the fragment (e.g. the owner of copied columns) are changed to the target.
+    grt::CopyContext copier(target.get_grt());
+    copier.object_copies[entry.fragment.id()] = target;
+
+    // Owned values first, so references to them can be mapped to their copies afterwards.
+    for (int pass = 0; pass < 2; ++pass)
+    {
+      bool ownedPass = pass == 0;
+      for (std::vector<std::string>::const_iterator member = entry.members.begin(); member != entry.members.end(); ++member)
+      {
+        const grt::MetaClass::Member *info = target.get_metaclass()->get_member_info(*member);
+        if (info == NULL || info->owned_object != ownedPass)
+          continue;
+
+        grt::ValueRef value = entry.fragment.get_member(*member);
+        switch (info->type.base.type)
+        {
+        case ListType:
+        {
+          grt::BaseListRef source = grt::BaseListRef::cast_from(value);
+          grt::BaseListRef list = grt::BaseListRef::cast_from(target.get_member(*member));
+          list.remove_all();
+          for (size_t i = 0; i < source.count(); ++i)
+            list.ginsert(copyValue(copier, source[i], info->owned_object));
+          break;
+        }
+
+        case DictType:
+          break;
+
+        default:
+          target.set_member(*member, copyValue(copier, value, info->owned_object));
+          break;
+        }
+      }
+    }
+    copier.finish();
+
+    return true;
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  /**
+   * Stores a fragment of the given (just parsed) object with the given members under the key.
+   */
+  void store(const std::string &key, const std::string &sql, grt::ObjectRef object,
+    const std::set<std::string> &members)
+  {
+    base::MutexLock lock(_mutex);
+    if (_limit == 0)
+      return;
+
+    // The copy gets all recorded members and leaves out anything else (e.g. the owner).
+    std::set<std::string> skippedMembers;
+    for (grt::MetaClass *meta = object.get_metaclass(); meta != NULL; meta = meta->parent())
+    {
+      for (grt::MetaClass::MemberList::const_iterator iterator = meta->get_members_partial().begin();
+        iterator != meta->get_members_partial().end(); ++iterator)
+      {
+        if (members.find(iterator->first) == members.end())
+          skippedMembers.insert(iterator->first);
+      }
+    }
+
+    Entry entry;
+    entry.key = key;
+    entry.sql = sql;
+    entry.fragment = grt::copy_object(object, skippedMembers);
+    entry.members.assign(members.begin(), members.end());
+    entry.size = sizeof(Entry) + 2 * key.size() + sql.size() + estimateSize(entry.fragment, true);
+    if (entry.size > _limit)
+      return;
+
+    remove(key);
+    _entries.push_front(entry);
+    _index[key] = _entries.begin();
+    _size += entry.size;
+
+    while (_size > _limit)
+      remove(_entries.back().key);
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  ParseCacheStatistics statistics()
+  {
+    base::MutexLock lock(_mutex);
+    ParseCacheStatistics result;
+    result.hits = _hits;
+    result.misses = _misses;
+    result.entries = _entries.size();
+    result.size = _size;
+    result.limit = _limit;
+
+    return result;
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  void setLimit(size_t limit)
+  {
+    base::MutexLock lock(_mutex);
+    _limit = limit;
+    while (_size > _limit)
+      remove(_entries.back().key);
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  void clear()
+  {
+    base::MutexLock lock(_mutex);
+    _index.clear();
+    _entries.clear();
+    _size = 0;
+    _hits = 0;
+    _misses = 0;
+  }
+
+private:
+  static const size_t DefaultLimit = 32 * 1024 * 1024;
+
+  struct Entry
+  {
+    std::string key;
+    std::string sql;
+    grt::ObjectRef fragment;
+    std::vector<std::string> members;
+    size_t size;
+  };
+
+  typedef std::list<Entry> EntryList; // Most recently used first.
+  typedef std::map<std::string, EntryList::iterator> EntryMap;
+
+  //------------------------------------------------------------------------------------------------
+
+  static grt::ValueRef copyValue(grt::CopyContext &copier, const grt::ValueRef &value, bool owned)
+  {
+    if (!value.is_valid() || value.type() != ObjectType)
+      return value;
+
+    grt::ObjectRef object = grt::ObjectRef::cast_from(value);
+    if (owned)
+      return copier.copy(object);
+
+    grt::ValueRef copy = copier.copy_for_object(object);
+    return copy.is_valid() ? copy : value;
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  /**
+   * A rough estimate of the memory used by the value, following owned objects only.
+   */
+  static size_t estimateSize(const grt::ValueRef &value, bool owned)
+  {
+    if (!value.is_valid())
+      return 0;
+
+    switch (value.type())
+    {
+    case StringType:
+      return 32 + (*grt::StringRef::cast_from(value)).size();
+
+    case ListType:
+    {
+      grt::BaseListRef list = grt::BaseListRef::cast_from(value);
+      size_t size = 32;
+      for (size_t i = 0; i < list.count(); ++i)
+        size += estimateSize(list[i], owned);
+      return size;
+    }
+
+    case DictType:
+    {
+      grt::DictRef dict = grt::DictRef::cast_from(value);
+      size_t size = 32;
+      for (grt::DictRef::const_iterator iterator = dict.begin(); iterator != dict.end(); ++iterator)
+        size += 32 + iterator->first.size() + estimateSize(iterator->second, owned);
+      return size;
+    }
+
+    case ObjectType:
+    {
+      if (!owned)
+        return 16;
+
+      grt::ObjectRef object = grt::ObjectRef::cast_from(value);
+      size_t size = 64;
+      for (grt::MetaClass *meta = object.get_metaclass(); meta != NULL; meta = meta->parent())
+      {
+        for (grt::MetaClass::MemberList::const_iterator iterator = meta->get_members_partial().begin();
+          iterator != meta->get_members_partial().end(); ++iterator)
+        {
+          if (!iterator->second.calculated && !iterator->second.overrides)
+            size += estimateSize(object.get_member(iterator->first), iterator->second.owned_object);
+        }
+      }
+      return size;
+    }
+
+    default:
+      return 16;
+    }
+  }
+
+  //------------------------------------------------------------------------------------------------
+
+  void remove(const std::string &key)
+  {
+    EntryMap::iterator iterator = _index.find(key);
+    if (iterator == _index.end())
+      return;
+
+    _size -= iterator->second->size;
+    _entries.erase(iterator->second);
+    _index.erase(iterator);
+  }
+
+  base::Mutex _mutex;
+  EntryList _entries;
+  EntryMap _index;
+  size_t _limit;
+  size_t _size;
+  size_t _hits;
+  size_t _misses;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the owner details which influence parse results for the given object.
+ */
+static std::string ownerDetails(const db_mysql_SchemaRef &schema)
+{
+  if (!schema.is_valid())
+    return "";
+  return *schema->name() + '\n' + *schema->defaultCharacterSetName() + '\n' + *schema->defaultCollationName();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Cached tables can come from a catalog with different (but equally named) data type objects.
+ */
+static void useCatalogTypes(db_mysql_CatalogRef catalog, db_mysql_TableRef table)
+{
+  grt::ListRef<db_SimpleDatatype> types = catalog->simpleDatatypes();
+  for (size_t i = 0; i < table->columns().count(); ++i)
+  {
+    db_ColumnRef column = table->columns()[i];
+    if (column->simpleType().is_valid() && types.get_index(column->simpleType()) == grt::BaseListRef::npos)
+      column->simpleType(findType(types, column->simpleType()->name()));
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+MySQLParserServicesImpl::MySQLParserServicesImpl(grt::CPPModuleLoader *loader)
+  : grt::ModuleImplBase(loader), _stop(false), _parseCache(new ParseResultCache())
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+MySQLParserServicesImpl::~MySQLParserServicesImpl()
+{
+  // Defined here, where ParseResultCache is a complete type.
+}
+
+//--------------------------------------------------------------------------------------------------
+
+grt::DictRef MySQLParserServicesImpl::getParseCacheStatistics()
+{
+  ParseCacheStatistics statistics = parseCacheStatistics();
+
+  grt::DictRef result(get_grt());
+  result.gset("hits", (long)statistics.hits);
+  result.gset("misses", (long)statistics.misses);
+  result.gset("entries", (long)statistics.entries);
+  result.gset("size", (long)statistics.size);
+  result.gset("limit", (long)statistics.limit);
+
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ParseCacheStatistics MySQLParserServicesImpl::parseCacheStatistics()
+{
+  return _parseCache->statistics();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MySQLParserServicesImpl::setParseCacheLimit(size_t limit)
+{
+  _parseCache->setLimit(limit);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void MySQLParserServicesImpl::clearParseCache()
+{
+  _parseCache->clear();
+}
+
 //--------------------------------------------------------------------------------------------------
 
 /**
@@ -2182,22 +2631,57 @@ size_t MySQLParserServicesImpl::parseTable(parser::ParserContext::Ref context,
 
   table->lastChangeDate(base::fmttime(0, DATETIME_FMT));
 
+  db_mysql_CatalogRef catalog;
+  db_mysql_SchemaRef schema;
+  if (table->owner().is_valid())
+  {
+    schema = db_mysql_SchemaRef::cast_from(table->owner());
+    catalog = db_mysql_CatalogRef::cast_from(schema->owner());
+  }
+
+  std::string cacheKey;
+  if (catalog.is_valid())
+  {
+    cacheKey = ParseResultCache::makeKey(context, "table", sql, ownerDetails(schema));
+    if (_parseCache->materialize(cacheKey, sql, table))
+    {
+      useCatalogTypes(catalog, table);
+      return 0;
+    }
+  }
+
+  MemberRecorder recorder(table);
   context->recognizer()->parse(sql.c_str(), sql.length(), true, PuCreateTable);
   size_t error_count = context->recognizer()->error_info().size();
   MySQLRecognizerTreeWalker walker = context->recognizer()->tree_walker();
   if (error_count == 0)
   {
-    db_mysql_CatalogRef catalog;
-    db_mysql_SchemaRef schema;
-    if (table->owner().is_valid())
+    DbObjectsRefsCache refCache;
+    bool isCopy = false;
+    std::pair<std::string, bool> result = fillTableDetails(walker, catalog, schema, table,
+      context->case_sensitive(), true, refCache, &isCopy);
+
+    // Only tables which don't refer to anything outside of them can be cached: no LIKE, no schema
+    // qualified name, no foreign keys and no merge union (all of which can change the catalog).
+    bool cacheable = !cacheKey.empty() && !isCopy && result.first.empty() && !recorder.contains("mergeUnion");
+    for (DbObjectsRefsCache::const_iterator iterator = refCache.begin(); iterator != refCache.end(); ++iterator)
     {
-      schema = db_mysql_SchemaRef::cast_from(table->owner());
-      catalog = db_mysql_CatalogRef::cast_from(schema->owner());
+      if (iterator->type != DbObjectReferences::Index)
+        cacheable = false;
     }
 
-    DbObjectsRefsCache refCache;
-    fillTableDetails(walker, catalog, schema, table, context->case_sensitive(), true, refCache);
     resolveReferences(catalog, refCache, context->case_sensitive());
+
+    if (cacheable)
+    {
+      recorder.add("primaryKey");
+      recorder.add("columns");
+      recorder.add("indices");
+      recorder.add("foreignKeys");
+      if (recorder.contains("partitionType"))
+        recorder.add("partitionDefinitions");
+      _parseCache->store(cacheKey, sql, table, recorder.members());
+    }
   }
   else
   {
@@ -2275,36 +2759,45 @@ size_t MySQLParserServicesImpl::parseTrigger(ParserContext::Ref context, db_mysq
   trigger->sqlDefinition(base::trim(sql));
   trigger->lastChangeDate(base::fmttime(0, DATETIME_FMT));
 
-  context->recognizer()->parse(sql.c_str(), sql.length(), true, PuCreateTrigger);
-  size_t error_count = context->recognizer()->error_info().size();
+  std::string cacheKey = ParseResultCache::makeKey(context, "trigger", sql, "");
+  size_t error_count = 0;
   int result_flag = 0;
-  MySQLRecognizerTreeWalker walker = context->recognizer()->tree_walker();
-  if (error_count == 0)
-    fillTriggerDetails(walker, trigger);
-  else
+  if (!_parseCache->materialize(cacheKey, sql, trigger))
   {
-    result_flag = 1;
-
-    // Finished with errors. See if we can get at least the trigger name out.
-    if (walker.advance_to_type(TRIGGER_NAME_TOKEN, true))
+    MemberRecorder recorder(trigger);
+    context->recognizer()->parse(sql.c_str(), sql.length(), true, PuCreateTrigger);
+    error_count = context->recognizer()->error_info().size();
+    MySQLRecognizerTreeWalker walker = context->recognizer()->tree_walker();
+    if (error_count == 0)
     {
-      Identifier identifier = getIdentifier(walker);
-      trigger->name(identifier.second);
-      trigger->oldName(trigger->name());
+      fillTriggerDetails(walker, trigger);
+      _parseCache->store(cacheKey, sql, trigger, recorder.members());
     }
-
-    // Another attempt: find the ordering as we may need to manipulate this.
-    if (walker.advance_to_type(ROW_SYMBOL, true))
+    else
     {
-      walker.next();
-      if (walker.is(FOLLOWS_SYMBOL) || walker.is(PRECEDES_SYMBOL))
+      result_flag = 1;
+
+      // Finished with errors. See if we can get at least the trigger name out.
+      if (walker.advance_to_type(TRIGGER_NAME_TOKEN, true))
+      {
+        Identifier identifier = getIdentifier(walker);
+        trigger->name(identifier.second);
+        trigger->oldName(trigger->name());
+      }
+
+      // Another attempt: find the ordering as we may need to manipulate this.
+      if (walker.advance_to_type(ROW_SYMBOL, true))
       {
-        trigger->ordering(walker.token_text());
         walker.next();
-        if (walker.is_identifier())
+        if (walker.is(FOLLOWS_SYMBOL) || walker.is(PRECEDES_SYMBOL))
         {
-          trigger->otherTrigger(walker.token_text());
+          trigger->ordering(walker.token_text());
           walker.next();
+          if (walker.is_identifier())
+          {
+            trigger->otherTrigger(walker.token_text());
+            walker.next();
+          }
         }
       }
     }
@@ -2405,14 +2898,20 @@ size_t MySQLParserServicesImpl::parseView(ParserContext::Ref context,
   view->sqlDefinition(base::trim(sql));
   view->lastChangeDate(base::fmttime(0, DATETIME_FMT));
 
+  // The schema name is part of the key because of the wrong schema check.
+  db_mysql_SchemaRef schema;
+  if (view->owner().is_valid())
+    schema = db_mysql_SchemaRef::cast_from(view->owner());
+  std::string cacheKey = ParseResultCache::makeKey(context, "view", sql, schema.is_valid() ? *schema->name() : "");
+  if (_parseCache->materialize(cacheKey, sql, view))
+    return 0;
+
+  MemberRecorder recorder(view);
   context->recognizer()->parse(sql.c_str(), sql.length(), true, PuCreateView);
   size_t error_count = context->recognizer()->error_info().size();
   MySQLRecognizerTreeWalker walker = context->recognizer()->tree_walker();
   if (error_count == 0)
   {
-    db_mysql_SchemaRef schema;
-    if (view->owner().is_valid())
-      schema = db_mysql_SchemaRef::cast_from(view->owner());
     std::pair<std::string, bool> info = fillViewDetails(walker, view);
     if (!info.first.empty() && schema.is_valid())
     {
@@ -2423,6 +2922,7 @@ size_t MySQLParserServicesImpl::parseView(ParserContext::Ref context,
       }
     }
 
+    _parseCache->store(cacheKey, sql, view, recorder.members());
   }
   else
   {
@@ -2668,21 +3168,33 @@ size_t MySQLParserServicesImpl::parseRoutine(ParserContext::Ref context,
   routine->sqlDefinition(base::trim(sql));
   routine->lastChangeDate(base::fmttime(0, DATETIME_FMT));
 
+  // The schema name is part of the key because of the wrong schema check.
+  db_mysql_SchemaRef schema;
+  if (routine->owner().is_valid())
+    schema = db_mysql_SchemaRef::cast_from(routine->owner());
+  std::string cacheKey = ParseResultCache::makeKey(context, "routine", sql, schema.is_valid() ? *schema->name() : "");
+  if (_parseCache->materialize(cacheKey, sql, routine))
+    return 0;
+
+  MemberRecorder recorder(routine);
   context->recognizer()->parse(sql.c_str(), sql.length(), true, PuCreateRoutine);
   MySQLRecognizerTreeWalker walker = context->recognizer()->tree_walker();
   size_t error_count = context->recognizer()->error_info().size();
   if (error_count == 0)
   {
     std::string schemaName = fillRoutineDetails(walker, routine);
-    if (!schemaName.empty() && routine->owner().is_valid())
+    if (!schemaName.empty() && schema.is_valid())
     {
-      db_mysql_SchemaRef schema = db_mysql_SchemaRef::cast_from(routine->owner());
       if (!base::same_string(schema->name(), schemaName, false)) // Routine names are never case sensitive.
       {
         routine->name(*routine->name() + "_WRONG_SCHEMA");
         routine->oldName(routine->name());
       }
     }
+
+    if (*routine->routineType() != "udf")
+      recorder.add("params");
+    _parseCache->store(cacheKey, sql, routine, recorder.members());
   }
   else
   {
@@ -3555,776 +4067,1373 @@ size_t MySQLParserServicesImpl::parseTablespace(parser::ParserContext::Ref conte
   return error_count;
 }
 
-size_t MySQLParserServicesImpl::parseSQLIntoCatalogSql(parser_ContextReferenceRef context_ref, db_mysql_CatalogRef catalog,
-          const std::string &sql, grt::DictRef options)
-{
-  ParserContext::Ref context = parser_context_from_grt(context_ref);
-  return parseSQLIntoCatalog( context, catalog, sql, options);
-}
+//--------------------------------------------------------------------------------------------------
 
 /**
-*	Expects the sql to be a single or multi-statement text in utf-8 encoding which is parsed and
-*	the details are used to build a grt tree. Existing objects are replaced unless the SQL has
-*	an "if not exist" clause (or no "or replace" clause for views).
-*	Statements handled are: create, drop and table rename, everything else is ignored.
-*
-*  Note for case sensitivity: only schema, table and trigger names *can* be case sensitive.
-*  This is determined by the case_sensitive() function of the given context. All other objects
-*  are searched for case-insensitively.
-*
-*	@result Returns the number of errors found during parsing.
-*/
-size_t MySQLParserServicesImpl::parseSQLIntoCatalog(parser::ParserContext::Ref context,
-  db_mysql_CatalogRef catalog, const std::string &sql, grt::DictRef options)
+ * The state of a script import (see parseSQLIntoCatalog), which is carried from statement to statement.
+ */
+struct CatalogImportState
 {
+  db_mysql_CatalogRef catalog;
+  db_mysql_SchemaRef currentSchema;
+  bool caseSensitive;
+  bool autoGenerateFkNames;
+  grt::ListRef<GrtObject> createdObjects;
 
-  std::set<MySQLQueryType> relevantQueryTypes;
-  relevantQueryTypes.insert(QtAlterDatabase);
-  relevantQueryTypes.insert(QtAlterLogFileGroup);
-  relevantQueryTypes.insert(QtAlterFunction);
-  relevantQueryTypes.insert(QtAlterProcedure);
-  relevantQueryTypes.insert(QtAlterServer);
-  relevantQueryTypes.insert(QtAlterTable);
-  relevantQueryTypes.insert(QtAlterTableSpace);
-  relevantQueryTypes.insert(QtAlterEvent);
-  relevantQueryTypes.insert(QtAlterView);
-
-  relevantQueryTypes.insert(QtCreateTable);
-  relevantQueryTypes.insert(QtCreateIndex);
-  relevantQueryTypes.insert(QtCreateDatabase);
-  relevantQueryTypes.insert(QtCreateEvent);
-  relevantQueryTypes.insert(QtCreateView);
-  relevantQueryTypes.insert(QtCreateRoutine);
-  relevantQueryTypes.insert(QtCreateProcedure);
-  relevantQueryTypes.insert(QtCreateFunction);
-  relevantQueryTypes.insert(QtCreateUdf);
-  relevantQueryTypes.insert(QtCreateTrigger);
-  relevantQueryTypes.insert(QtCreateLogFileGroup);
-  relevantQueryTypes.insert(QtCreateServer);
-  relevantQueryTypes.insert(QtCreateTableSpace);
-
-  relevantQueryTypes.insert(QtDropDatabase);
-  relevantQueryTypes.insert(QtDropEvent);
-  relevantQueryTypes.insert(QtDropFunction);
-  relevantQueryTypes.insert(QtDropProcedure);
-  relevantQueryTypes.insert(QtDropIndex);
-  relevantQueryTypes.insert(QtDropLogfileGroup);
-  relevantQueryTypes.insert(QtDropServer);
-  relevantQueryTypes.insert(QtDropTable);
-  relevantQueryTypes.insert(QtDropTablespace);
-  relevantQueryTypes.insert(QtDropTrigger);
-  relevantQueryTypes.insert(QtDropView);
-
-  relevantQueryTypes.insert(QtRenameTable);
+  // Textual FK references. At the end these are used to find actual ref tables + columns,
+  // when all tables have been parsed.
+  DbObjectsRefsCache refCache;
+};
 
-  relevantQueryTypes.insert(QtUse);
+//--------------------------------------------------------------------------------------------------
 
+static void addTable(CatalogImportState &state, db_mysql_TableRef table, const std::pair<std::string, bool> &result)
+{
+  db_mysql_SchemaRef schema = state.currentSchema;
+  if (!result.first.empty() && !base::same_string(schema->name(), result.first, state.caseSensitive))
+    schema = ensureSchemaExists(state.catalog, result.first, state.caseSensitive);
+  table->owner(schema);
+
+  // Ignore tables that use a name that is already used for a view (no drop/new-add takes place then).
+  db_mysql_ViewRef existingView = find_named_object_in_list(schema->views(), table->name());
+  if (!existingView.is_valid())
+  {
+    db_TableRef existingTable = find_named_object_in_list(schema->tables(), table->name());
+    if (existingTable.is_valid())
+    {
+      // Ignore if the table exists already?
+      if (!result.second)
+      {
+        schema->tables()->remove(existingTable);
+        schema->tables().insert(table);
+        state.createdObjects.insert(table);
+      }
+    }
+    else
+    {
+      schema->tables().insert(table);
+      state.createdObjects.insert(table);
+    }
+  }
+}
 
-  log_debug2("Parse sql into catalog\n");
+//--------------------------------------------------------------------------------------------------
 
-  bool caseSensitive = context->case_sensitive();
+static void addEvent(CatalogImportState &state, db_mysql_EventRef event, const std::pair<std::string, bool> &result)
+{
+  db_SchemaRef schema = state.currentSchema;
+  if (!result.first.empty() && !base::same_string(schema->name(), result.first, false))
+    schema = ensureSchemaExists(state.catalog, result.first, false);
+  event->owner(schema);
 
-  std::string startSchema = options.get_string("schema");
-  db_mysql_SchemaRef currentSchema;
-  if (!startSchema.empty())
-    currentSchema = ensureSchemaExists(catalog, startSchema, caseSensitive);
+  db_EventRef existing = find_named_object_in_list(schema->events(), event->name());
+  if (existing.is_valid())
+  {
+    if (!result.second) // Ignore if exists?
+    {
+      schema->events()->remove(existing);
+      schema->events().insert(event);
+      state.createdObjects.insert(event);
+    }
+  }
+  else
+  {
+    schema->events().insert(event);
+    state.createdObjects.insert(event);
+  }
+}
 
-  bool defaultSchemaCreated = false;
-  bool autoGenerateFkNames = options.get_int("gen_fk_names_when_empty") != 0;
-  //bool reuseExistingObjects = options.get_int("reuse_existing_objects") != 0;
+//--------------------------------------------------------------------------------------------------
 
-  if (!currentSchema.is_valid())
+static void addView(CatalogImportState &state, db_mysql_ViewRef view, const std::pair<std::string, bool> &result)
+{
+  db_mysql_SchemaRef schema = state.currentSchema;
+  if (!result.first.empty() && !base::same_string(schema->name(), result.first, state.caseSensitive))
+    schema = ensureSchemaExists(state.catalog, result.first, state.caseSensitive);
+  view->owner(schema);
+
+  // Ignore views that use a name that is already used for a table (no drop/new-add takes place then).
+  db_mysql_TableRef existingTable = find_named_object_in_list(schema->tables(), view->name());
+  if (!existingTable.is_valid())
   {
-    currentSchema = db_mysql_SchemaRef::cast_from(catalog->defaultSchema());
-    if (!currentSchema.is_valid())
+    db_mysql_ViewRef existingView = find_named_object_in_list(schema->views(), view->name());
+    if (existingView.is_valid())
     {
-      db_SchemaRef df = find_named_object_in_list(catalog->schemata(), "default_schema", caseSensitive);
-      if (!df.is_valid())
-        defaultSchemaCreated = true;
-      currentSchema = ensureSchemaExists(catalog, "default_schema", caseSensitive);
+      if (!result.second) // Ignore if exists?
+      {
+        schema->views()->remove(existingView);
+        schema->views().insert(view);
+        state.createdObjects.insert(view);
+      }
+    }
+    else
+    {
+      schema->views().insert(view);
+      state.createdObjects.insert(view);
     }
   }
+}
 
-  size_t errorCount = 0;
-  MySQLRecognizer *recognizer = context->recognizer();
-  boost::shared_ptr<MySQLQueryIdentifier> queryIdentifier = context->createQueryIdentifier();
+//--------------------------------------------------------------------------------------------------
 
-  std::vector<std::pair<size_t, size_t> > ranges;
-  determineStatementRanges(sql.c_str(), sql.size(), ";", ranges, "\n");
+static void addRoutine(CatalogImportState &state, db_mysql_RoutineRef routine, const std::string &schemaName)
+{
+  db_SchemaRef schema = state.currentSchema;
+  if (!schemaName.empty() && !base::same_string(schema->name(), schemaName, false))
+    schema = ensureSchemaExists(state.catalog, schemaName, state.caseSensitive);
+  routine->owner(schema);
+
+  db_RoutineRef existing = find_named_object_in_list(schema->routines(), routine->name());
+  if (existing.is_valid())
+    schema->routines()->remove(existing);
+  schema->routines().insert(routine);
+  state.createdObjects.insert(routine);
+}
 
-  grt::ListRef<GrtObject> createdObjects = grt::ListRef<GrtObject>::cast_from(options.get("created_objects"));
-  if (!createdObjects.is_valid())
+//--------------------------------------------------------------------------------------------------
+
+static void addTrigger(CatalogImportState &state, db_mysql_TriggerRef trigger, const std::pair<std::string, std::string> &tableName)
+{
+  // Trigger table referencing is a bit different than for other objects because we need
+  // the table now to add the trigger to it. We cannot defer that to the resolveReferences() call.
+  // This has the implication that we can only work with tables we have found so far.
+  db_SchemaRef schema = state.currentSchema;
+  if (!tableName.first.empty())
+    schema = ensureSchemaExists(state.catalog, tableName.first, state.caseSensitive);
+  db_TableRef table = find_named_object_in_list(schema->tables(), tableName.second, state.caseSensitive);
+  if (!table.is_valid())
   {
-    createdObjects = grt::ListRef<GrtObject>(catalog->get_grt());
-    options.set("created_objects", createdObjects);
+    // If we don't find a table with the given name we create a stub object to be used instead.
+    table = db_mysql_TableRef(state.catalog->get_grt());
+    table->owner(schema);
+    table->isStub(1);
+    table->name(tableName.second);
+    table->oldName(tableName.second);
+    schema->tables().insert(table);
+    state.createdObjects.insert(table);
   }
 
-  // Collect textual FK references into a local cache. At the end this is used
-  // to find actual ref tables + columns, when all tables have been parsed.
-  DbObjectsRefsCache refCache;
-  for (std::vector<std::pair<size_t, size_t> >::iterator iterator = ranges.begin(); iterator != ranges.end(); ++iterator)
-  {
-    //std::string ddl(sql.c_str() + iterator->first, iterator->second);
-    MySQLQueryType queryType = queryIdentifier->getQueryType(sql.c_str() + iterator->first, iterator->second, true);
-    size_t errors = queryIdentifier->error_info().size(); // Can only be lexer errors.
-    if (errors > 0)
-    {
-      errorCount += errors;
-      continue;
-    }
+  trigger->owner(table);
 
-    if (relevantQueryTypes.count(queryType) == 0)
-      continue; // Something we are not interested in. Don't bother parsing it.
+  db_TriggerRef existing = find_named_object_in_list(table->triggers(), trigger->name());
+  if (existing.is_valid())
+    table->triggers()->remove(existing);
+  table->triggers().insert(trigger);
+  state.createdObjects.insert(trigger);
+}
 
-    recognizer->parse(sql.c_str() + iterator->first, iterator->second, true, PuGeneric);
-    errors = recognizer->error_info().size();
-    if (errors > 0)
-    {
-      errorCount += errors;
-      continue;
-    }
+//--------------------------------------------------------------------------------------------------
 
-    MySQLRecognizerTreeWalker walker = recognizer->tree_walker();
+/**
+ * Applies the statement the recognizer parsed last to the catalog.
+ */
+static void applyStatement(MySQLRecognizer *recognizer, MySQLQueryType queryType, CatalogImportState &state)
+{
+  db_mysql_CatalogRef catalog = state.catalog;
+  db_mysql_SchemaRef &currentSchema = state.currentSchema;
+  bool caseSensitive = state.caseSensitive;
+  bool autoGenerateFkNames = state.autoGenerateFkNames;
+  grt::ListRef<GrtObject> createdObjects = state.createdObjects;
+  DbObjectsRefsCache &refCache = state.refCache;
 
-    switch (queryType)
-    {
-    case QtCreateTable:
-    {
-      db_mysql_TableRef table(catalog->get_grt());
-      table->createDate(base::fmttime(0, DATETIME_FMT));
-      table->lastChangeDate(table->createDate());
+  MySQLRecognizerTreeWalker walker = recognizer->tree_walker();
 
-      std::pair<std::string, bool> result = fillTableDetails(walker, catalog, currentSchema,
-        table, caseSensitive, autoGenerateFkNames, refCache);
-      db_mysql_SchemaRef schema = currentSchema;
-      if (!result.first.empty() && !base::same_string(schema->name(), result.first, caseSensitive))
-        schema = ensureSchemaExists(catalog, result.first, caseSensitive);
-      table->owner(schema);
+  switch (queryType)
+  {
+  case QtCreateTable:
+  {
+    db_mysql_TableRef table(catalog->get_grt());
+    table->createDate(base::fmttime(0, DATETIME_FMT));
+    table->lastChangeDate(table->createDate());
 
-      // Ignore tables that use a name that is already used for a view (no drop/new-add takes place then).
-      db_mysql_ViewRef existingView = find_named_object_in_list(schema->views(), table->name());
-      if (!existingView.is_valid())
-      {
-        db_TableRef existingTable = find_named_object_in_list(schema->tables(), table->name());
-        if (existingTable.is_valid())
-        {
-          // Ignore if the table exists already?
-          if (!result.second)
-          {
-            schema->tables()->remove(existingTable);
-            schema->tables().insert(table);
-            createdObjects.insert(table);
-          }
-        }
-        else
-        {
-          schema->tables().insert(table);
-          createdObjects.insert(table);
-        }
-      }
+    std::pair<std::string, bool> result = fillTableDetails(walker, catalog, currentSchema,
+      table, caseSensitive, autoGenerateFkNames, refCache);
+    addTable(state, table, result);
 
-      break;
-    }
+    break;
+  }
 
-    case QtCreateIndex:
+  case QtCreateIndex:
+  {
+    db_mysql_IndexRef index(catalog->get_grt());
+    index->createDate(base::fmttime(0, DATETIME_FMT));
+    index->lastChangeDate(index->createDate());
+
+    Identifier tableReference = fillIndexDetails(walker, catalog, currentSchema, index, caseSensitive);
+    db_SchemaRef schema = currentSchema;
+    if (!tableReference.first.empty() && !base::same_string(schema->name(), tableReference.first, caseSensitive))
+      schema = ensureSchemaExists(catalog, tableReference.first, caseSensitive);
+    db_TableRef table = find_named_object_in_list(schema->tables(), tableReference.second, caseSensitive);
+    if (table.is_valid())
     {
-      db_mysql_IndexRef index(catalog->get_grt());
-      index->createDate(base::fmttime(0, DATETIME_FMT));
-      index->lastChangeDate(index->createDate());
-
-      Identifier tableReference = fillIndexDetails(walker, catalog, currentSchema, index, caseSensitive);
-      db_SchemaRef schema = currentSchema;
-      if (!tableReference.first.empty() && !base::same_string(schema->name(), tableReference.first, caseSensitive))
-        schema = ensureSchemaExists(catalog, tableReference.first, caseSensitive);
-      db_TableRef table = find_named_object_in_list(schema->tables(), tableReference.second, caseSensitive);
-      if (table.is_valid())
-      {
-        index->owner(table);
-
-        db_IndexRef existing = find_named_object_in_list(table->indices(), index->name());
-        if (existing.is_valid())
-          table->indices()->remove(existing);
-        table->indices().insert(index);
-        createdObjects.insert(index);
-      }
+      index->owner(table);
 
-      break;
+      db_IndexRef existing = find_named_object_in_list(table->indices(), index->name());
+      if (existing.is_valid())
+        table->indices()->remove(existing);
+      table->indices().insert(index);
+      createdObjects.insert(index);
     }
 
-    case QtCreateDatabase:
-    {
-      db_mysql_SchemaRef schema(catalog->get_grt());
-      schema->createDate(base::fmttime(0, DATETIME_FMT));
-      schema->lastChangeDate(schema->createDate());
+    break;
+  }
 
-      std::pair<std::string, std::string> info = detailsForCharset(catalog->defaultCharacterSetName(),
-        catalog->defaultCollationName(), catalog->defaultCharacterSetName());
-      schema->defaultCharacterSetName(info.first);
-      schema->defaultCollationName(info.second);
+  case QtCreateDatabase:
+  {
+    db_mysql_SchemaRef schema(catalog->get_grt());
+    schema->createDate(base::fmttime(0, DATETIME_FMT));
+    schema->lastChangeDate(schema->createDate());
+
+    std::pair<std::string, std::string> info = detailsForCharset(catalog->defaultCharacterSetName(),
+      catalog->defaultCollationName(), catalog->defaultCharacterSetName());
+    schema->defaultCharacterSetName(info.first);
+    schema->defaultCollationName(info.second);
 
-      bool ignoreIfExists = fillSchemaDetails(walker, catalog, schema);
-      schema->owner(catalog);
+    bool ignoreIfExists = fillSchemaDetails(walker, catalog, schema);
+    schema->owner(catalog);
 
-      db_SchemaRef existing = find_named_object_in_list(catalog->schemata(), schema->name(), caseSensitive);
-      if (existing.is_valid())
-      {
-        if (!ignoreIfExists)
-        {
-          catalog->schemata()->remove(existing);
-          catalog->schemata().insert(schema);
-          createdObjects.insert(schema);
-        }
-      }
-      else
+    db_SchemaRef existing = find_named_object_in_list(catalog->schemata(), schema->name(), caseSensitive);
+    if (existing.is_valid())
+    {
+      if (!ignoreIfExists)
       {
+        catalog->schemata()->remove(existing);
         catalog->schemata().insert(schema);
         createdObjects.insert(schema);
       }
-
-      break;
     }
-
-    case QtUse:
+    else
     {
-      walker.next(); // Skip USE.
-      Identifier identifier = getIdentifier(walker);
-      currentSchema = ensureSchemaExists(catalog, identifier.second, caseSensitive);
-      break;
+      catalog->schemata().insert(schema);
+      createdObjects.insert(schema);
     }
 
-    case QtCreateEvent:
-    {
-      db_mysql_EventRef event(catalog->get_grt());
-      event->sqlDefinition(base::trim(recognizer->text()));
-      event->createDate(base::fmttime(0, DATETIME_FMT));
-      event->lastChangeDate(event->createDate());
+    break;
+  }
 
-      std::pair<std::string, bool> result = fillEventDetails(walker, event);
-      db_SchemaRef schema = currentSchema;
-      if (!result.first.empty() && !base::same_string(schema->name(), result.first, false))
-        schema = ensureSchemaExists(catalog, result.first, false);
-      event->owner(schema);
+  case QtUse:
+  {
+    walker.next(); // Skip USE.
+    Identifier identifier = getIdentifier(walker);
+    currentSchema = ensureSchemaExists(catalog, identifier.second, caseSensitive);
+    break;
+  }
 
-      db_EventRef existing = find_named_object_in_list(schema->events(), event->name());
-      if (existing.is_valid())
-      {
-        if (!result.second) // Ignore if exists?
-        {
-          schema->events()->remove(existing);
-          schema->events().insert(event);
-          createdObjects.insert(event);
-        }
-      }
-      else
-      {
-        schema->events().insert(event);
-        createdObjects.insert(event);
-      }
+  case QtCreateEvent:
+  {
+    db_mysql_EventRef event(catalog->get_grt());
+    event->sqlDefinition(base::trim(recognizer->text()));
+    event->createDate(base::fmttime(0, DATETIME_FMT));
+    event->lastChangeDate(event->createDate());
 
-      break;
-    }
+    std::pair<std::string, bool> result = fillEventDetails(walker, event);
+    addEvent(state, event, result);
 
-    case QtCreateView:
-    {
-      db_mysql_ViewRef view(catalog->get_grt());
-      view->sqlDefinition(base::trim(recognizer->text()));
-      view->createDate(base::fmttime(0, DATETIME_FMT));
-      view->lastChangeDate(view->createDate());
+    break;
+  }
 
-      std::pair<std::string, bool> result = fillViewDetails(walker, view);
-      db_mysql_SchemaRef schema = currentSchema;
-      if (!result.first.empty() && !base::same_string(schema->name(), result.first, caseSensitive))
-        schema = ensureSchemaExists(catalog, result.first, caseSensitive);
-      view->owner(schema);
+  case QtCreateView:
+  {
+    db_mysql_ViewRef view(catalog->get_grt());
+    view->sqlDefinition(base::trim(recognizer->text()));
+    view->createDate(base::fmttime(0, DATETIME_FMT));
+    view->lastChangeDate(view->createDate());
 
-      // Ignore views that use a name that is already used for a table (no drop/new-add takes place then).
-      db_mysql_TableRef existingTable = find_named_object_in_list(schema->tables(), view->name());
-      if (!existingTable.is_valid())
-      {
-        db_mysql_ViewRef existingView = find_named_object_in_list(schema->views(), view->name());
-        if (existingView.is_valid())
-        {
-          if (!result.second) // Ignore if exists?
-          {
-            schema->views()->remove(existingView);
-            schema->views().insert(view);
-            createdObjects.insert(view);
-          }
-        }
-        else
-        {
-          schema->views().insert(view);
-          createdObjects.insert(view);
-        }
-      }
+    std::pair<std::string, bool> result = fillViewDetails(walker, view);
+    addView(state, view, result);
 
-      break;
-    }
+    break;
+  }
 
-    case QtCreateProcedure:
-    case QtCreateFunction:
-    case QtCreateUdf:
-    {
-      db_mysql_RoutineRef routine(catalog->get_grt());
-      routine->sqlDefinition(base::trim(recognizer->text()));
-      routine->createDate(base::fmttime(0, DATETIME_FMT));
-      routine->lastChangeDate(routine->createDate());
+  case QtCreateProcedure:
+  case QtCreateFunction:
+  case QtCreateUdf:
+  {
+    db_mysql_RoutineRef routine(catalog->get_grt());
+    routine->sqlDefinition(base::trim(recognizer->text()));
+    routine->createDate(base::fmttime(0, DATETIME_FMT));
+    routine->lastChangeDate(routine->createDate());
 
-      std::string schemaName = fillRoutineDetails(walker, routine);
-      db_SchemaRef schema = currentSchema;
-      if (!schemaName.empty() && !base::same_string(schema->name(), schemaName, false))
-        schema = ensureSchemaExists(catalog, schemaName, caseSensitive);
-      routine->owner(schema);
+    std::string schemaName = fillRoutineDetails(walker, routine);
+    addRoutine(state, routine, schemaName);
 
-      db_RoutineRef existing = find_named_object_in_list(schema->routines(), routine->name());
-      if (existing.is_valid())
-        schema->routines()->remove(existing);
-      schema->routines().insert(routine);
-      createdObjects.insert(routine);
+    break;
+  }
 
-      break;
-    }
+  case QtCreateTrigger:
+  {
+    db_mysql_TriggerRef trigger(catalog->get_grt());
+    trigger->sqlDefinition(base::trim(recognizer->text()));
+    trigger->createDate(base::fmttime(0, DATETIME_FMT));
+    trigger->lastChangeDate(trigger->createDate());
 
-    case QtCreateTrigger:
-    {
-      db_mysql_TriggerRef trigger(catalog->get_grt());
-      trigger->sqlDefinition(base::trim(recognizer->text()));
-      trigger->createDate(base::fmttime(0, DATETIME_FMT));
-      trigger->lastChangeDate(trigger->createDate());
+    std::pair<std::string, std::string> tableName = fillTriggerDetails(walker, trigger);
+    addTrigger(state, trigger, tableName);
 
-      std::pair<std::string, std::string> tableName = fillTriggerDetails(walker, trigger);
+    break;
+  }
 
-      // Trigger table referencing is a bit different than for other objects because we need
-      // the table now to add the trigger to it. We cannot defer that to the resolveReferences() call.
-      // This has the implication that we can only work with tables we have found so far.
-      db_SchemaRef schema = currentSchema;
-      if (!tableName.first.empty())
-        schema = ensureSchemaExists(catalog, tableName.first, caseSensitive);
-      db_TableRef table = find_named_object_in_list(schema->tables(), tableName.second, caseSensitive);
-      if (!table.is_valid())
-      {
-        // If we don't find a table with the given name we create a stub object to be used instead.
-        table = db_mysql_TableRef(catalog->get_grt());
-        table->owner(schema);
-        table->isStub(1);
-        table->name(tableName.second);
-        table->oldName(tableName.second);
-        schema->tables().insert(table);
-        createdObjects.insert(table);
-      }
+  case QtCreateLogFileGroup:
+  {
+    db_mysql_LogFileGroupRef group(catalog->get_grt());
+    group->createDate(base::fmttime(0, DATETIME_FMT));
+    group->lastChangeDate(group->createDate());
 
-      trigger->owner(table);
+    fillLogfileGroupDetails(walker, group);
+    group->owner(catalog);
 
-      db_TriggerRef existing = find_named_object_in_list(table->triggers(), trigger->name());
-      if (existing.is_valid())
-        table->triggers()->remove(existing);
-      table->triggers().insert(trigger);
-      createdObjects.insert(trigger);
+    db_LogFileGroupRef existing = find_named_object_in_list(catalog->logFileGroups(), group->name());
+    if (existing.is_valid())
+      catalog->logFileGroups()->remove(existing);
+    catalog->logFileGroups().insert(group);
+    createdObjects.insert(group);
 
-      break;
-    }
+    break;
+  }
 
-    case QtCreateLogFileGroup:
-    {
-      db_mysql_LogFileGroupRef group(catalog->get_grt());
-      group->createDate(base::fmttime(0, DATETIME_FMT));
-      group->lastChangeDate(group->createDate());
+  case QtCreateServer:
+  {
+    db_mysql_ServerLinkRef server(catalog->get_grt());
+    server->createDate(base::fmttime(0, DATETIME_FMT));
+    server->lastChangeDate(server->createDate());
 
-      fillLogfileGroupDetails(walker, group);
-      group->owner(catalog);
+    fillServerDetails(walker, server);
+    server->owner(catalog);
 
-      db_LogFileGroupRef existing = find_named_object_in_list(catalog->logFileGroups(), group->name());
-      if (existing.is_valid())
-        catalog->logFileGroups()->remove(existing);
-      catalog->logFileGroups().insert(group);
-      createdObjects.insert(group);
+    db_ServerLinkRef existing = find_named_object_in_list(catalog->serverLinks(), server->name());
+    if (existing.is_valid())
+      catalog->serverLinks()->remove(existing);
+    catalog->serverLinks().insert(server);
+    createdObjects.insert(server);
 
-      break;
-    }
+    break;
+  }
 
-    case QtCreateServer:
-    {
-      db_mysql_ServerLinkRef server(catalog->get_grt());
-      server->createDate(base::fmttime(0, DATETIME_FMT));
-      server->lastChangeDate(server->createDate());
+  case QtCreateTableSpace:
+  {
+    db_mysql_TablespaceRef tablespace(catalog->get_grt());
+    tablespace->createDate(base::fmttime(0, DATETIME_FMT));
+    tablespace->lastChangeDate(tablespace->createDate());
 
-      fillServerDetails(walker, server);
-      server->owner(catalog);
+    fillTablespaceDetails(walker, catalog, tablespace);
+    tablespace->owner(catalog);
 
-      db_ServerLinkRef existing = find_named_object_in_list(catalog->serverLinks(), server->name());
-      if (existing.is_valid())
-        catalog->serverLinks()->remove(existing);
-      catalog->serverLinks().insert(server);
-      createdObjects.insert(server);
+    db_TablespaceRef existing = find_named_object_in_list(catalog->tablespaces(), tablespace->name());
+    if (existing.is_valid())
+      catalog->tablespaces()->remove(existing);
+    catalog->tablespaces().insert(tablespace);
+    createdObjects.insert(tablespace);
 
-      break;
-    }
+    break;
+  }
 
-    case QtCreateTableSpace:
+  case QtDropDatabase:
+  {
+    walker.next(2); // DROP DATABASE.
+    walker.skip_if(IF_SYMBOL, 2); // IF EXISTS.
+    Identifier identifier = getIdentifier(walker);
+    db_SchemaRef schema = find_named_object_in_list(catalog->schemata(), identifier.second);
+    if (schema.is_valid())
     {
-      db_mysql_TablespaceRef tablespace(catalog->get_grt());
-      tablespace->createDate(base::fmttime(0, DATETIME_FMT));
-      tablespace->lastChangeDate(tablespace->createDate());
+      catalog->schemata()->remove(schema);
+      if (catalog->defaultSchema() == schema)
+        catalog->defaultSchema(db_mysql_SchemaRef());
+      if (currentSchema == schema)
+        currentSchema = db_mysql_SchemaRef::cast_from(catalog->defaultSchema());
+      if (!currentSchema.is_valid())
+        currentSchema = ensureSchemaExists(catalog, "default_schema", caseSensitive);
+    }
+    break;
+  }
 
-      fillTablespaceDetails(walker, catalog, tablespace);
-      tablespace->owner(catalog);
+  case QtDropEvent:
+  {
+    walker.next(2);
+    walker.skip_if(IF_SYMBOL, 2);
+    Identifier identifier = getIdentifier(walker);
+    db_SchemaRef schema = currentSchema;
+    if (!identifier.first.empty())
+      schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
+    db_EventRef event = find_named_object_in_list(schema->events(), identifier.second);
+    schema->events()->remove(event);
+    break;
+  }
 
-      db_TablespaceRef existing = find_named_object_in_list(catalog->tablespaces(), tablespace->name());
-      if (existing.is_valid())
-        catalog->tablespaces()->remove(existing);
-      catalog->tablespaces().insert(tablespace);
-      createdObjects.insert(tablespace);
+  case QtDropProcedure:
+  case QtDropFunction: // Including UDFs.
+  {
+    walker.next(2);
+    walker.skip_if(IF_SYMBOL, 2);
+    Identifier identifier = getIdentifier(walker);
+    db_SchemaRef schema = currentSchema;
+    if (!identifier.first.empty())
+      schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
+    db_RoutineRef routine = find_named_object_in_list(schema->routines(), identifier.second);
+    schema->routines()->remove(routine);
+    break;
+  }
 
-      break;
-    }
+  case QtDropIndex:
+  {
+    walker.next();
+    if (walker.is(ONLINE_SYMBOL) || walker.is(OFFLINE_SYMBOL))
+      walker.next();
+    walker.next();
+    std::string name = getIdentifier(walker).second;
+    walker.next(); // Skip ON.
 
-    case QtDropDatabase:
+    Identifier reference = getIdentifier(walker);
+    db_SchemaRef schema = currentSchema;
+    if (!reference.first.empty())
+      schema = ensureSchemaExists(catalog, reference.first, caseSensitive);
+    db_TableRef table = find_named_object_in_list(schema->tables(), reference.second);
+    if (table.is_valid())
     {
-      walker.next(2); // DROP DATABASE.
-      walker.skip_if(IF_SYMBOL, 2); // IF EXISTS.
-      Identifier identifier = getIdentifier(walker);
-      db_SchemaRef schema = find_named_object_in_list(catalog->schemata(), identifier.second);
-      if (schema.is_valid())
-      {
-        catalog->schemata()->remove(schema);
-        if (catalog->defaultSchema() == schema)
-          catalog->defaultSchema(db_mysql_SchemaRef());
-        if (currentSchema == schema)
-          currentSchema = db_mysql_SchemaRef::cast_from(catalog->defaultSchema());
-        if (!currentSchema.is_valid())
-          currentSchema = ensureSchemaExists(catalog, "default_schema", caseSensitive);
-      }
-      break;
+      db_IndexRef index = find_named_object_in_list(table->indices(), name);
+      if (index.is_valid())
+        table->indices()->remove(index);
     }
+    break;
+  }
 
-    case QtDropEvent:
-    {
-      walker.next(2);
-      walker.skip_if(IF_SYMBOL, 2);
-      Identifier identifier = getIdentifier(walker);
-      db_SchemaRef schema = currentSchema;
-      if (!identifier.first.empty())
-        schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
-      db_EventRef event = find_named_object_in_list(schema->events(), identifier.second);
-      schema->events()->remove(event);
-      break;
-    }
+  case QtDropLogfileGroup:
+  {
+    walker.next(3); // Skip DROP LOGFILE GROUP.
+    Identifier identifier = getIdentifier(walker);
+    db_LogFileGroupRef group = find_named_object_in_list(catalog->logFileGroups(), identifier.second);
+    if (group.is_valid())
+      catalog->logFileGroups()->remove(group);
+
+    break;
+  }
+
+  case QtDropServer:
+  {
+    walker.next(2); // Skip DROP SERVER.
+    walker.skip_if(IF_SYMBOL, 2); // Skip IF EXISTS.
+    Identifier identifier = getIdentifier(walker);
+    db_ServerLinkRef server = find_named_object_in_list(catalog->serverLinks(), identifier.second);
+    if (server.is_valid())
+      catalog->serverLinks()->remove(server);
+
+    break;
+  }
+
+  case QtDropTable:
+  case QtDropView:
+  {
+    bool isView = queryType == QtDropView;
+    walker.next();
+    walker.skip_if(TEMPORARY_SYMBOL);
+    walker.next(); // Skip TABLE | TABLES | VIEW.
+    walker.skip_if(IF_SYMBOL, 2); // Skip IF EXISTS.
 
-    case QtDropProcedure:
-    case QtDropFunction: // Including UDFs.
+    // We can have a list of tables to drop here.
+    while (true)
     {
-      walker.next(2);
-      walker.skip_if(IF_SYMBOL, 2);
       Identifier identifier = getIdentifier(walker);
       db_SchemaRef schema = currentSchema;
       if (!identifier.first.empty())
         schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
-      db_RoutineRef routine = find_named_object_in_list(schema->routines(), identifier.second);
-      schema->routines()->remove(routine);
-      break;
-    }
-
-    case QtDropIndex:
-    {
-      walker.next();
-      if (walker.is(ONLINE_SYMBOL) || walker.is(OFFLINE_SYMBOL))
-        walker.next();
-      walker.next();
-      std::string name = getIdentifier(walker).second;
-      walker.next(); // Skip ON.
-
-      Identifier reference = getIdentifier(walker);
-      db_SchemaRef schema = currentSchema;
-      if (!reference.first.empty())
-        schema = ensureSchemaExists(catalog, reference.first, caseSensitive);
-      db_TableRef table = find_named_object_in_list(schema->tables(), reference.second);
-      if (table.is_valid())
+      if (isView)
       {
-        db_IndexRef index = find_named_object_in_list(table->indices(), name);
-        if (index.is_valid())
-          table->indices()->remove(index);
+        db_ViewRef view = find_named_object_in_list(schema->views(), identifier.second);
+        if (view.is_valid())
+          schema->views()->remove(view);
       }
-      break;
+      else
+      {
+        db_TableRef table = find_named_object_in_list(schema->tables(), identifier.second);
+        if (table.is_valid())
+          schema->tables()->remove(table);
+      }
+      if (walker.token_type() != COMMA_SYMBOL)
+        break;
+      walker.next();
     }
 
-    case QtDropLogfileGroup:
-    {
-      walker.next(3); // Skip DROP LOGFILE GROUP.
-      Identifier identifier = getIdentifier(walker);
-      db_LogFileGroupRef group = find_named_object_in_list(catalog->logFileGroups(), identifier.second);
-      if (group.is_valid())
-        catalog->logFileGroups()->remove(group);
+    break;
+  }
 
-      break;
-    }
+  case QtDropTablespace:
+  {
+    walker.next(2);
+    Identifier identifier = getIdentifier(walker);
+    db_TablespaceRef tablespace = find_named_object_in_list(catalog->tablespaces(), identifier.second);
+    if (tablespace.is_valid())
+      catalog->tablespaces()->remove(tablespace);
 
-    case QtDropServer:
-    {
-      walker.next(2); // Skip DROP SERVER.
-      walker.skip_if(IF_SYMBOL, 2); // Skip IF EXISTS.
-      Identifier identifier = getIdentifier(walker);
-      db_ServerLinkRef server = find_named_object_in_list(catalog->serverLinks(), identifier.second);
-      if (server.is_valid())
-        catalog->serverLinks()->remove(server);
+    break;
+  }
 
-      break;
-    }
+  case QtDropTrigger:
+  {
+    walker.next(2);
+    walker.skip_if(IF_SYMBOL, 2);
+    Identifier identifier = getIdentifier(walker);
 
-    case QtDropTable:
-    case QtDropView:
+    // Even though triggers are schema level objects they work on specific tables
+    // and that's why we store them under the affected tables, not in the schema object.
+    // This however makes it more difficult to find the trigger to delete, as we have to
+    // iterate over all tables.
+    db_SchemaRef schema = currentSchema;
+    if (!identifier.first.empty())
+      schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
+    for (grt::ListRef<db_Table>::const_iterator table = schema->tables().begin(); table != schema->tables().end(); ++table)
     {
-      bool isView = queryType == QtDropView;
-      walker.next();
-      walker.skip_if(TEMPORARY_SYMBOL);
-      walker.next(); // Skip TABLE | TABLES | VIEW.
-      walker.skip_if(IF_SYMBOL, 2); // Skip IF EXISTS.
-
-      // We can have a list of tables to drop here.
-      while (true)
+      db_TriggerRef trigger = find_named_object_in_list((*table)->triggers(), identifier.second);
+      if (trigger.is_valid())
       {
-        Identifier identifier = getIdentifier(walker);
-        db_SchemaRef schema = currentSchema;
-        if (!identifier.first.empty())
-          schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
-        if (isView)
-        {
-          db_ViewRef view = find_named_object_in_list(schema->views(), identifier.second);
-          if (view.is_valid())
-            schema->views()->remove(view);
-        }
-        else
-        {
-          db_TableRef table = find_named_object_in_list(schema->tables(), identifier.second);
-          if (table.is_valid())
-            schema->tables()->remove(table);
-        }
-        if (walker.token_type() != COMMA_SYMBOL)
-          break;
-        walker.next();
+        (*table)->triggers()->remove(trigger);
+        break; // A trigger can only be assigned to a single table, so we can stop here.
       }
-
-      break;
     }
+    break;
+  }
 
-    case QtDropTablespace:
-    {
-      walker.next(2);
-      Identifier identifier = getIdentifier(walker);
-      db_TablespaceRef tablespace = find_named_object_in_list(catalog->tablespaces(), identifier.second);
-      if (tablespace.is_valid())
-        catalog->tablespaces()->remove(tablespace);
-
-      break;
-    }
+  case QtRenameTable:
+  {
+    // Renaming a table is special as you can use it also to rename a view and to move
+    // a table from one schema to the other (not for views, though).
+    // Due to the way we store triggers we have an easy life wrt. related triggers.
+    walker.next(2);
 
-    case QtDropTrigger:
+    while (true)
     {
-      walker.next(2);
-      walker.skip_if(IF_SYMBOL, 2);
-      Identifier identifier = getIdentifier(walker);
+      // Unlimited value pairs.
+      Identifier source = getIdentifier(walker);
+      db_SchemaRef sourceSchema = currentSchema;
+      if (!source.first.empty())
+        sourceSchema = ensureSchemaExists(catalog, source.first, caseSensitive);
 
-      // Even though triggers are schema level objects they work on specific tables
-      // and that's why we store them under the affected tables, not in the schema object.
-      // This however makes it more difficult to find the trigger to delete, as we have to
-      // iterate over all tables.
-      db_SchemaRef schema = currentSchema;
-      if (!identifier.first.empty())
-        schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
-      for (grt::ListRef<db_Table>::const_iterator table = schema->tables().begin(); table != schema->tables().end(); ++table)
+      walker.next(); // Skip TO.
+      Identifier target = getIdentifier(walker);
+      db_SchemaRef targetSchema = currentSchema;
+      if (!target.first.empty())
+        targetSchema = ensureSchemaExists(catalog, target.first, caseSensitive);
+
+      db_ViewRef view = find_named_object_in_list(sourceSchema->views(), source.second);
+      if (view.is_valid())
       {
-        db_TriggerRef trigger = find_named_object_in_list((*table)->triggers(), identifier.second);
-        if (trigger.is_valid())
-        {
-          (*table)->triggers()->remove(trigger);
-          break; // A trigger can only be assigned to a single table, so we can stop here.
-        }
+        // Cannot move between schemas.
+        if (sourceSchema == targetSchema)
+          view->name(target.second);
       }
-      break;
-    }
-
-    case QtRenameTable:
-    {
-      // Renaming a table is special as you can use it also to rename a view and to move
-      // a table from one schema to the other (not for views, though).
-      // Due to the way we store triggers we have an easy life wrt. related triggers.
-      walker.next(2);
-
-      while (true)
+      else
       {
-        // Unlimited value pairs.
-        Identifier source = getIdentifier(walker);
-        db_SchemaRef sourceSchema = currentSchema;
-        if (!source.first.empty())
-          sourceSchema = ensureSchemaExists(catalog, source.first, caseSensitive);
-
-        walker.next(); // Skip TO.
-        Identifier target = getIdentifier(walker);
-        db_SchemaRef targetSchema = currentSchema;
-        if (!target.first.empty())
-          targetSchema = ensureSchemaExists(catalog, target.first, caseSensitive);
-
-        db_ViewRef view = find_named_object_in_list(sourceSchema->views(), source.second);
-        if (view.is_valid())
-        {
-          // Cannot move between schemas.
-          if (sourceSchema == targetSchema)
-            view->name(target.second);
-        }
-        else
+        // Renaming a table.
+        db_TableRef table = find_named_object_in_list(sourceSchema->tables(), source.second);
+        if (table.is_valid())
         {
-          // Renaming a table.
-          db_TableRef table = find_named_object_in_list(sourceSchema->tables(), source.second);
-          if (table.is_valid())
+          if (sourceSchema != targetSchema)
           {
-            if (sourceSchema != targetSchema)
-            {
-              sourceSchema->tables()->remove(table);
-              targetSchema->tables().insert(table);
-              createdObjects.insert(table);
-            }
-            table->name(target.second);
+            sourceSchema->tables()->remove(table);
+            targetSchema->tables().insert(table);
+            createdObjects.insert(table);
           }
+          table->name(target.second);
         }
-
-        if (walker.token_type() != COMMA_SYMBOL)
-          break;
-        walker.next();
       }
 
-      break;
+      if (walker.token_type() != COMMA_SYMBOL)
+        break;
+      walker.next();
     }
 
-    // Alter commands. At the moment we only support a limited number of cases as we mostly
-    // need SQL-to-GRT conversion for create scripts.
-    case QtAlterDatabase:
-    {
-      db_mysql_SchemaRef schema = currentSchema;
-      walker.next(); // Skip DATABASE.
-      if (walker.is_identifier())
-      {
-        Identifier identifier = getIdentifier(walker);
-        schema = ensureSchemaExists(catalog, identifier.second, caseSensitive);
-      }
-      schema->lastChangeDate(base::fmttime(0, DATETIME_FMT));
-      fillSchemaOptions(walker, catalog, schema);
+    break;
+  }
 
-      break;
+  // Alter commands. At the moment we only support a limited number of cases as we mostly
+  // need SQL-to-GRT conversion for create scripts.
+  case QtAlterDatabase:
+  {
+    db_mysql_SchemaRef schema = currentSchema;
+    walker.next(); // Skip DATABASE.
+    if (walker.is_identifier())
+    {
+      Identifier identifier = getIdentifier(walker);
+      schema = ensureSchemaExists(catalog, identifier.second, caseSensitive);
     }
+    schema->lastChangeDate(base::fmttime(0, DATETIME_FMT));
+    fillSchemaOptions(walker, catalog, schema);
 
-    case QtAlterLogFileGroup:
-      break;
+    break;
+  }
 
-    case QtAlterFunction:
-      break;
+  case QtAlterLogFileGroup:
+    break;
 
-    case QtAlterProcedure:
-      break;
+  case QtAlterFunction:
+    break;
 
-    case QtAlterServer:
-      break;
+  case QtAlterProcedure:
+    break;
 
-    case QtAlterTable: // Alter table only for adding/removing indices and for renames.
-    {                // This is more than the old parser did. 
+  case QtAlterServer:
+    break;
+
+  case QtAlterTable: // Alter table only for adding/removing indices and for renames.
+  {                // This is more than the old parser did. 
+    walker.next();
+    if (walker.is(ONLINE_SYMBOL) || walker.is(OFFLINE_SYMBOL))
       walker.next();
-      if (walker.is(ONLINE_SYMBOL) || walker.is(OFFLINE_SYMBOL))
-        walker.next();
-      walker.skip_if(IGNORE_SYMBOL);
-      walker.next(); // Skip TABLE.
-      Identifier identifier = getIdentifier(walker);
-      db_mysql_SchemaRef schema = currentSchema;
-      if (!identifier.first.empty())
-        schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
+    walker.skip_if(IGNORE_SYMBOL);
+    walker.next(); // Skip TABLE.
+    Identifier identifier = getIdentifier(walker);
+    db_mysql_SchemaRef schema = currentSchema;
+    if (!identifier.first.empty())
+      schema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
 
-      db_mysql_TableRef table = find_named_object_in_list(schema->tables(), identifier.second, caseSensitive);
-      if (table.is_valid())
+    db_mysql_TableRef table = find_named_object_in_list(schema->tables(), identifier.second, caseSensitive);
+    if (table.is_valid())
+    {
+      // There must be at least one alter item.
+      while (true)
       {
-        // There must be at least one alter item.
-        while (true)
+        switch (walker.look_ahead(true))
         {
+        case ADD_SYMBOL:
+          walker.next();
           switch (walker.look_ahead(true))
           {
-          case ADD_SYMBOL:
+          case CONSTRAINT_SYMBOL:
+          case PRIMARY_SYMBOL:
+          case FOREIGN_SYMBOL:
+          case UNIQUE_SYMBOL:
+          case INDEX_SYMBOL:
+          case KEY_SYMBOL:
+          case FULLTEXT_SYMBOL:
+          case SPATIAL_SYMBOL:
             walker.next();
-            switch (walker.look_ahead(true))
-            {
-            case CONSTRAINT_SYMBOL:
-            case PRIMARY_SYMBOL:
-            case FOREIGN_SYMBOL:
-            case UNIQUE_SYMBOL:
-            case INDEX_SYMBOL:
-            case KEY_SYMBOL:
-            case FULLTEXT_SYMBOL:
-            case SPATIAL_SYMBOL:
-              walker.next();
-              processTableKeyItem(walker, catalog, schema->name(), table, autoGenerateFkNames, refCache);
-              break;
+            processTableKeyItem(walker, catalog, schema->name(), table, autoGenerateFkNames, refCache);
+            break;
 
-            case RENAME_SYMBOL:
-            {
-              walker.next(2);
-              if (walker.is(TO_SYMBOL) || walker.is(AS_SYMBOL))
-                walker.next();
+          case RENAME_SYMBOL:
+          {
+            walker.next(2);
+            if (walker.is(TO_SYMBOL) || walker.is(AS_SYMBOL))
+              walker.next();
 
-              identifier = getIdentifier(walker);
-              db_SchemaRef targetSchema = currentSchema;
-              if (!identifier.first.empty())
-                targetSchema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
+            identifier = getIdentifier(walker);
+            db_SchemaRef targetSchema = currentSchema;
+            if (!identifier.first.empty())
+              targetSchema = ensureSchemaExists(catalog, identifier.first, caseSensitive);
 
-              db_ViewRef view = find_named_object_in_list(schema->views(), identifier.second);
-              if (view.is_valid())
-              {
-                // Cannot move between schemas.
-                if (schema == targetSchema)
-                  view->name(identifier.second);
-              }
-              else
+            db_ViewRef view = find_named_object_in_list(schema->views(), identifier.second);
+            if (view.is_valid())
+            {
+              // Cannot move between schemas.
+              if (schema == targetSchema)
+                view->name(identifier.second);
+            }
+            else
+            {
+              // Renaming a table.
+              db_TableRef table = find_named_object_in_list(schema->tables(), identifier.second);
+              if (table.is_valid())
               {
-                // Renaming a table.
-                db_TableRef table = find_named_object_in_list(schema->tables(), identifier.second);
-                if (table.is_valid())
+                if (schema != targetSchema)
                 {
-                  if (schema != targetSchema)
-                  {
-                    schema->tables()->remove(table);
-                    targetSchema->tables().insert(table);
-                  }
-                  table->name(identifier.second);
+                  schema->tables()->remove(table);
+                  targetSchema->tables().insert(table);
                 }
+                table->name(identifier.second);
               }
-
-              break;
             }
 
-            default:
-              walker.up();
-              walker.skip_subtree();
-            }
             break;
+          }
 
           default:
+            walker.up();
             walker.skip_subtree();
           }
+          break;
 
-          if (!walker.is(COMMA_SYMBOL))
-            break;
-          walker.next();
+        default:
+          walker.skip_subtree();
         }
+
+        if (!walker.is(COMMA_SYMBOL))
+          break;
+        walker.next();
       }
-      break;
     }
+    break;
+  }
 
-    case QtAlterTableSpace:
-      break;
-    case QtAlterEvent:
-      break;
-    case QtAlterView:
-      break;
-    default:
-      continue; // Ignore anything else.
+  case QtAlterTableSpace:
+    break;
+  case QtAlterEvent:
+    break;
+  case QtAlterView:
+    break;
+  default:
+    break; // Ignore anything else.
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+// Scripts with fewer statements are imported serially, unless a thread count is given explicitly.
+#define PARALLEL_IMPORT_MIN_STATEMENTS 500
+
+// Number of statements a job parses in phase one of a parallel import.
+#define PARALLEL_IMPORT_CHUNK_SIZE 100
+
+/**
+ * Imports a large script in two phases. Phase one parses the create statements for tables, views,
+ * routines, triggers and events on several threads, into objects which are not part of the catalog yet.
+ * Each thread has its own parser context and a private catalog standing in for the target catalog.
+ * Phase two applies all statements in script order on the calling thread. Statements of other types
+ * are parsed only then, as they depend on the catalog state.
+ *
+ * Tables also depend on the current schema and on the default charset of their schema. Phase one
+ * guesses both from the USE and CREATE DATABASE statements before a table. If the guess turns out wrong
+ * in phase two the statement is parsed again, so the result is always that of a serial import.
+ */
+class ParallelCatalogImport
+{
+public:
+  ParallelCatalogImport(ParserContext::Ref context, CatalogImportState &state, const std::string &sql,
+    const std::set<MySQLQueryType> &relevantQueryTypes);
+  ~ParallelCatalogImport();
+
+  size_t run(const std::vector<std::pair<size_t, size_t> > &ranges, int threadCount);
+
+private:
+  struct Fragment
+  {
+    size_t start;
+    size_t length;
+    MySQLQueryType type;
+    size_t errorCount;
+    bool parseInPhaseOne;
+
+    // The results of phase one.
+    GrtNamedObjectRef object;
+    std::string schemaName; // As given in the statement.
+    std::string tableName;  // The table of a trigger.
+    bool ignoreIfExists;
+    DbObjectsRefsCache refCache;
+
+    // What phase one assumed for a table.
+    std::string assumedSchema; // The current schema.
+    std::string tableSchema;
+    std::string assumedCharset; // Defaults of the table schema.
+    std::string assumedCollation;
+    std::vector<std::string> usedSchemas; // Schemas the statement creates if they don't exist, in order.
+  };
+
+  struct Worker
+  {
+    ParserContext::Ref context;
+    db_mysql_CatalogRef catalog;
+  };
+
+  typedef std::map<std::string, std::pair<std::string, std::string> > SchemaDefaults;
+
+  ParserContext::Ref _context;
+  CatalogImportState &_state;
+  const std::string &_sql;
+  const std::set<MySQLQueryType> &_relevantQueryTypes;
+
+  std::vector<Fragment> _fragments;
+  SchemaDefaults _schemaDefaults; // Charset + collation of the schemas, as phase one expects them.
+
+  std::vector<Worker> _workers;
+  std::vector<size_t> _idleWorkers;
+  base::Mutex _workerLock;
+
+  std::vector<grt::BaseListRef> _indexedLists;
+
+  void prepare(const std::vector<std::pair<size_t, size_t> > &ranges);
+  std::string knownSchemaName(const std::string &name);
+  void parseFragments(size_t begin, size_t end);
+  void parseFragment(Worker &worker, Fragment &fragment);
+  bool applyFragment(Fragment &fragment);
+  db_mysql_CatalogRef createWorkerCatalog();
+  void indexNames(grt::BaseListRef list);
+};
+
+//--------------------------------------------------------------------------------------------------
+
+ParallelCatalogImport::ParallelCatalogImport(ParserContext::Ref context, CatalogImportState &state,
+  const std::string &sql, const std::set<MySQLQueryType> &relevantQueryTypes)
+  : _context(context), _state(state), _sql(sql), _relevantQueryTypes(relevantQueryTypes)
+{
+}
+
+//--------------------------------------------------------------------------------------------------
+
+ParallelCatalogImport::~ParallelCatalogImport()
+{
+  for (std::vector<grt::BaseListRef>::iterator list = _indexedLists.begin(); list != _indexedLists.end(); ++list)
+    (*list)->disable_name_index();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Imports all statements. The name indexes used in phase two are kept until the import object is destroyed,
+ * so that the reference resolution after the import can use them too.
+ *
+ * @result The number of errors found.
+ */
+size_t ParallelCatalogImport::run(const std::vector<std::pair<size_t, size_t> > &ranges, int threadCount)
+{
+  prepare(ranges);
+
+  // Phase one.
+  {
+    base::TaskGroup group(threadCount);
+    _workers.resize(group.thread_count());
+    for (size_t i = 0; i < _workers.size(); ++i)
+    {
+      _workers[i].context = MySQLParserServices::createParserContext(_context->get_charsets(),
+        _context->get_server_version(), _context->case_sensitive());
+      _workers[i].context->use_sql_mode(_context->get_sql_mode());
+      _workers[i].catalog = createWorkerCatalog();
+      _idleWorkers.push_back(i);
+    }
+    log_debug("Parsing %i statements on %i threads\n", (int)_fragments.size(), group.thread_count());
+
+    for (size_t i = 0; i < _fragments.size(); i += PARALLEL_IMPORT_CHUNK_SIZE)
+      group.run(boost::bind(&ParallelCatalogImport::parseFragments, this, i,
+        std::min(_fragments.size(), i + PARALLEL_IMPORT_CHUNK_SIZE)));
+    group.wait();
+
+    _workers.clear();
+    _idleWorkers.clear();
+  }
+
+  // Phase two. With many objects most of the time would go into name lookups, so index the object lists.
+  // Schemas can be added or replaced by any statement, so check them each time (there are only a few).
+  grt::ListRef<db_mysql_Schema> schemata = _state.catalog->schemata();
+  indexNames(schemata);
+
+  size_t errorCount = 0;
+  MySQLRecognizer *recognizer = _context->recognizer();
+  for (std::vector<Fragment>::iterator fragment = _fragments.begin(); fragment != _fragments.end(); ++fragment)
+  {
+    for (size_t i = 0; i < schemata.count(); ++i)
+    {
+      indexNames(schemata[i]->tables());
+      indexNames(schemata[i]->views());
+      indexNames(schemata[i]->routines());
+    }
+
+    if (fragment->errorCount > 0)
+    {
+      errorCount += fragment->errorCount;
+      continue;
+    }
+
+    if (_relevantQueryTypes.count(fragment->type) == 0)
+      continue;
+
+    if (fragment->object.is_valid() && applyFragment(*fragment))
+      continue;
+
+    recognizer->parse(_sql.c_str() + fragment->start, fragment->length, true, PuGeneric);
+    size_t errors = recognizer->error_info().size();
+    if (errors > 0)
+    {
+      errorCount += errors;
+      continue;
+    }
+    applyStatement(recognizer, fragment->type, _state);
+  }
+  _fragments.clear();
+
+  return errorCount;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Determines the statement types and the guesses for phase one. USE and CREATE DATABASE statements are
+ * parsed here for that, they are applied in phase two like all other statements.
+ */
+void ParallelCatalogImport::prepare(const std::vector<std::pair<size_t, size_t> > &ranges)
+{
+  MySQLRecognizer *recognizer = _context->recognizer();
+  boost::shared_ptr<MySQLQueryIdentifier> queryIdentifier = _context->createQueryIdentifier();
+
+  db_mysql_CatalogRef catalog = _state.catalog;
+  for (grt::ListRef<db_mysql_Schema>::const_iterator schema = catalog->schemata().begin();
+    schema != catalog->schemata().end(); ++schema)
+    _schemaDefaults[*(*schema)->name()] = std::make_pair(*(*schema)->defaultCharacterSetName(),
+      *(*schema)->defaultCollationName());
+  std::string currentSchema = *_state.currentSchema->name();
+
+  _fragments.resize(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i)
+  {
+    Fragment &fragment = _fragments[i];
+    fragment.start = ranges[i].first;
+    fragment.length = ranges[i].second;
+    fragment.type = queryIdentifier->getQueryType(_sql.c_str() + fragment.start, fragment.length, true);
+    fragment.errorCount = queryIdentifier->error_info().size(); // Can only be lexer errors.
+    fragment.parseInPhaseOne = false;
+    fragment.ignoreIfExists = false;
+    if (fragment.errorCount > 0)
+      continue;
+
+    switch (fragment.type)
+    {
+    case QtUse:
+    case QtCreateDatabase:
+    {
+      recognizer->parse(_sql.c_str() + fragment.start, fragment.length, true, PuGeneric);
+      if (!recognizer->error_info().empty())
+        break;
+
+      MySQLRecognizerTreeWalker walker = recognizer->tree_walker();
+      if (fragment.type == QtUse)
+      {
+        walker.next(); // Skip USE.
+        currentSchema = knownSchemaName(getIdentifier(walker).second);
+      }
+      else
+      {
+        db_mysql_SchemaRef schema(catalog->get_grt());
+        std::pair<std::string, std::string> info = detailsForCharset(catalog->defaultCharacterSetName(),
+          catalog->defaultCollationName(), catalog->defaultCharacterSetName());
+        schema->defaultCharacterSetName(info.first);
+        schema->defaultCollationName(info.second);
+        fillSchemaDetails(walker, catalog, schema);
+        _schemaDefaults[knownSchemaName(*schema->name())] = std::make_pair(*schema->defaultCharacterSetName(),
+          *schema->defaultCollationName());
+      }
+      break;
+    }
+
+    case QtCreateTable:
+    case QtCreateView:
+    case QtCreateProcedure:
+    case QtCreateFunction:
+    case QtCreateUdf:
+    case QtCreateTrigger:
+    case QtCreateEvent:
+      fragment.parseInPhaseOne = true;
+      fragment.assumedSchema = currentSchema;
+      break;
+
+    default:
+      break;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the name of a schema as it will be in the catalog, which differs from the given name
+ * if another schema matches it case-insensitively.
+ */
+std::string ParallelCatalogImport::knownSchemaName(const std::string &name)
+{
+  if (_state.caseSensitive || _schemaDefaults.find(name) != _schemaDefaults.end())
+    return name;
+
+  for (SchemaDefaults::const_iterator iterator = _schemaDefaults.begin(); iterator != _schemaDefaults.end(); ++iterator)
+  {
+    if (base::same_string(iterator->first, name, false))
+      return iterator->first;
+  }
+  return name;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Runs on a worker thread.
+ */
+void ParallelCatalogImport::parseFragments(size_t begin, size_t end)
+{
+  size_t workerIndex;
+  {
+    base::MutexLock lock(_workerLock);
+    workerIndex = _idleWorkers.back();
+    _idleWorkers.pop_back();
+  }
+
+  try
+  {
+    for (size_t i = begin; i < end; ++i)
+    {
+      if (_fragments[i].parseInPhaseOne)
+        parseFragment(_workers[workerIndex], _fragments[i]);
+    }
+  }
+  catch (...)
+  {
+    base::MutexLock lock(_workerLock);
+    _idleWorkers.push_back(workerIndex);
+    throw;
+  }
+
+  base::MutexLock lock(_workerLock);
+  _idleWorkers.push_back(workerIndex);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ParallelCatalogImport::parseFragment(Worker &worker, Fragment &fragment)
+{
+  MySQLRecognizer *recognizer = worker.context->recognizer();
+  recognizer->parse(_sql.c_str() + fragment.start, fragment.length, true, PuGeneric);
+  fragment.errorCount = recognizer->error_info().size();
+  if (fragment.errorCount > 0)
+    return;
+
+  MySQLRecognizerTreeWalker walker = recognizer->tree_walker();
+  grt::GRT *grt = worker.catalog->get_grt();
+  switch (fragment.type)
+  {
+  case QtCreateTable:
+  {
+    // Start with an empty catalog, so the schemas in it afterwards are those the statement uses.
+    worker.catalog->schemata().remove_all();
+    db_mysql_SchemaRef schema = ensureSchemaExists(worker.catalog, fragment.assumedSchema, _state.caseSensitive);
+    SchemaDefaults::const_iterator defaults = _schemaDefaults.find(fragment.assumedSchema);
+    if (defaults != _schemaDefaults.end())
+    {
+      schema->defaultCharacterSetName(defaults->second.first);
+      schema->defaultCollationName(defaults->second.second);
+    }
+
+    db_mysql_TableRef table(grt);
+    table->createDate(base::fmttime(0, DATETIME_FMT));
+    table->lastChangeDate(table->createDate());
+
+    bool isCopy = false;
+    std::pair<std::string, bool> result = fillTableDetails(walker, worker.catalog, schema, table,
+      _state.caseSensitive, _state.autoGenerateFkNames, fragment.refCache, &isCopy);
+    if (isCopy)
+    {
+      // A copy of another table needs the catalog state, so leave it to phase two.
+      fragment.refCache.clear();
+      break;
+    }
+
+    if (!result.first.empty())
+      schema = ensureSchemaExists(worker.catalog, result.first, _state.caseSensitive);
+
+    fragment.object = table;
+    fragment.schemaName = result.first;
+    fragment.ignoreIfExists = result.second;
+    fragment.tableSchema = *schema->name();
+    fragment.assumedCharset = *schema->defaultCharacterSetName();
+    fragment.assumedCollation = *schema->defaultCollationName();
+    for (grt::ListRef<db_mysql_Schema>::const_iterator iterator = worker.catalog->schemata().begin();
+      iterator != worker.catalog->schemata().end(); ++iterator)
+      fragment.usedSchemas.push_back(*(*iterator)->name());
+    break;
+  }
+
+  case QtCreateView:
+  {
+    db_mysql_ViewRef view(grt);
+    view->sqlDefinition(base::trim(recognizer->text()));
+    view->createDate(base::fmttime(0, DATETIME_FMT));
+    view->lastChangeDate(view->createDate());
+
+    std::pair<std::string, bool> result = fillViewDetails(walker, view);
+    fragment.object = view;
+    fragment.schemaName = result.first;
+    fragment.ignoreIfExists = result.second;
+    break;
+  }
+
+  case QtCreateProcedure:
+  case QtCreateFunction:
+  case QtCreateUdf:
+  {
+    db_mysql_RoutineRef routine(grt);
+    routine->sqlDefinition(base::trim(recognizer->text()));
+    routine->createDate(base::fmttime(0, DATETIME_FMT));
+    routine->lastChangeDate(routine->createDate());
+
+    fragment.schemaName = fillRoutineDetails(walker, routine);
+    fragment.object = routine;
+    break;
+  }
+
+  case QtCreateTrigger:
+  {
+    db_mysql_TriggerRef trigger(grt);
+    trigger->sqlDefinition(base::trim(recognizer->text()));
+    trigger->createDate(base::fmttime(0, DATETIME_FMT));
+    trigger->lastChangeDate(trigger->createDate());
+
+    std::pair<std::string, std::string> tableName = fillTriggerDetails(walker, trigger);
+    fragment.object = trigger;
+    fragment.schemaName = tableName.first;
+    fragment.tableName = tableName.second;
+    break;
+  }
+
+  case QtCreateEvent:
+  {
+    db_mysql_EventRef event(grt);
+    event->sqlDefinition(base::trim(recognizer->text()));
+    event->createDate(base::fmttime(0, DATETIME_FMT));
+    event->lastChangeDate(event->createDate());
+
+    std::pair<std::string, bool> result = fillEventDetails(walker, event);
+    fragment.object = event;
+    fragment.schemaName = result.first;
+    fragment.ignoreIfExists = result.second;
+    break;
+  }
+
+  default:
+    break;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds the object of a fragment to the catalog. Returns false if the fragment was built with wrong
+ * assumptions, in which case the statement must be parsed again.
+ */
+bool ParallelCatalogImport::applyFragment(Fragment &fragment)
+{
+  switch (fragment.type)
+  {
+  case QtCreateTable:
+  {
+    if (fragment.assumedSchema != *_state.currentSchema->name())
+      return false;
+
+    // Create the schemas in the same order the serial import would.
+    for (std::vector<std::string>::const_iterator name = fragment.usedSchemas.begin();
+      name != fragment.usedSchemas.end(); ++name)
+      ensureSchemaExists(_state.catalog, *name, _state.caseSensitive);
+
+    db_mysql_SchemaRef schema = _state.currentSchema;
+    if (!fragment.schemaName.empty())
+      schema = ensureSchemaExists(_state.catalog, fragment.schemaName, _state.caseSensitive);
+    if (*schema->name() != fragment.tableSchema || *schema->defaultCharacterSetName() != fragment.assumedCharset
+      || *schema->defaultCollationName() != fragment.assumedCollation)
+      return false;
+
+    _state.refCache.insert(_state.refCache.end(), fragment.refCache.begin(), fragment.refCache.end());
+    addTable(_state, db_mysql_TableRef::cast_from(fragment.object),
+      std::make_pair(fragment.schemaName, fragment.ignoreIfExists));
+    return true;
+  }
+
+  case QtCreateView:
+    addView(_state, db_mysql_ViewRef::cast_from(fragment.object),
+      std::make_pair(fragment.schemaName, fragment.ignoreIfExists));
+    return true;
+
+  case QtCreateProcedure:
+  case QtCreateFunction:
+  case QtCreateUdf:
+    addRoutine(_state, db_mysql_RoutineRef::cast_from(fragment.object), fragment.schemaName);
+    return true;
+
+  case QtCreateTrigger:
+    addTrigger(_state, db_mysql_TriggerRef::cast_from(fragment.object),
+      std::make_pair(fragment.schemaName, fragment.tableName));
+    return true;
+
+  case QtCreateEvent:
+    addEvent(_state, db_mysql_EventRef::cast_from(fragment.object),
+      std::make_pair(fragment.schemaName, fragment.ignoreIfExists));
+    return true;
+
+  default:
+    return false;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates an empty catalog which shares the data types and character sets of the target catalog,
+ * as needed by the parser.
+ */
+db_mysql_CatalogRef ParallelCatalogImport::createWorkerCatalog()
+{
+  db_mysql_CatalogRef catalog(_state.catalog.get_grt());
+  catalog->name(_state.catalog->name());
+  catalog->version(_state.catalog->version());
+  catalog->defaultCharacterSetName(_state.catalog->defaultCharacterSetName());
+  catalog->defaultCollationName(_state.catalog->defaultCollationName());
+  grt::replace_contents(catalog->simpleDatatypes(), _state.catalog->simpleDatatypes());
+  grt::replace_contents(catalog->userDatatypes(), _state.catalog->userDatatypes());
+  grt::replace_contents(catalog->characterSets(), _state.catalog->characterSets());
+
+  return catalog;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ParallelCatalogImport::indexNames(grt::BaseListRef list)
+{
+  if (list->has_name_index(true) || list->has_name_index(false))
+    return;
+  list->enable_name_index(_state.caseSensitive);
+  _indexedLists.push_back(list);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t MySQLParserServicesImpl::parseSQLIntoCatalogSql(parser_ContextReferenceRef context_ref, db_mysql_CatalogRef catalog,
+          const std::string &sql, grt::DictRef options)
+{
+  ParserContext::Ref context = parser_context_from_grt(context_ref);
+  return parseSQLIntoCatalog( context, catalog, sql, options);
+}
+
+/**
+*	Expects the sql to be a single or multi-statement text in utf-8 encoding which is parsed and
+*	the details are used to build a grt tree. Existing objects are replaced unless the SQL has
+*	an "if not exist" clause (or no "or replace" clause for views).
+*	Statements handled are: create, drop and table rename, everything else is ignored.
+*
+*  Note for case sensitivity: only schema, table and trigger names *can* be case sensitive.
+*  This is determined by the case_sensitive() function of the given context. All other objects
+*  are searched for case-insensitively.
+*
+*	@result Returns the number of errors found during parsing.
+*/
+size_t MySQLParserServicesImpl::parseSQLIntoCatalog(parser::ParserContext::Ref context,
+  db_mysql_CatalogRef catalog, const std::string &sql, grt::DictRef options)
+{
+
+  std::set<MySQLQueryType> relevantQueryTypes;
+  relevantQueryTypes.insert(QtAlterDatabase);
+  relevantQueryTypes.insert(QtAlterLogFileGroup);
+  relevantQueryTypes.insert(QtAlterFunction);
+  relevantQueryTypes.insert(QtAlterProcedure);
+  relevantQueryTypes.insert(QtAlterServer);
+  relevantQueryTypes.insert(QtAlterTable);
+  relevantQueryTypes.insert(QtAlterTableSpace);
+  relevantQueryTypes.insert(QtAlterEvent);
+  relevantQueryTypes.insert(QtAlterView);
+
+  relevantQueryTypes.insert(QtCreateTable);
+  relevantQueryTypes.insert(QtCreateIndex);
+  relevantQueryTypes.insert(QtCreateDatabase);
+  relevantQueryTypes.insert(QtCreateEvent);
+  relevantQueryTypes.insert(QtCreateView);
+  relevantQueryTypes.insert(QtCreateRoutine);
+  relevantQueryTypes.insert(QtCreateProcedure);
+  relevantQueryTypes.insert(QtCreateFunction);
+  relevantQueryTypes.insert(QtCreateUdf);
+  relevantQueryTypes.insert(QtCreateTrigger);
+  relevantQueryTypes.insert(QtCreateLogFileGroup);
+  relevantQueryTypes.insert(QtCreateServer);
+  relevantQueryTypes.insert(QtCreateTableSpace);
+
+  relevantQueryTypes.insert(QtDropDatabase);
+  relevantQueryTypes.insert(QtDropEvent);
+  relevantQueryTypes.insert(QtDropFunction);
+  relevantQueryTypes.insert(QtDropProcedure);
+  relevantQueryTypes.insert(QtDropIndex);
+  relevantQueryTypes.insert(QtDropLogfileGroup);
+  relevantQueryTypes.insert(QtDropServer);
+  relevantQueryTypes.insert(QtDropTable);
+  relevantQueryTypes.insert(QtDropTablespace);
+  relevantQueryTypes.insert(QtDropTrigger);
+  relevantQueryTypes.insert(QtDropView);
+
+  relevantQueryTypes.insert(QtRenameTable);
+
+  relevantQueryTypes.insert(QtUse);
+
+
+  log_debug2("Parse sql into catalog\n");
+
+  bool caseSensitive = context->case_sensitive();
+
+  std::string startSchema = options.get_string("schema");
+  db_mysql_SchemaRef currentSchema;
+  if (!startSchema.empty())
+    currentSchema = ensureSchemaExists(catalog, startSchema, caseSensitive);
+
+  bool defaultSchemaCreated = false;
+  bool autoGenerateFkNames = options.get_int("gen_fk_names_when_empty") != 0;
+  //bool reuseExistingObjects = options.get_int("reuse_existing_objects") != 0;
+
+  if (!currentSchema.is_valid())
+  {
+    currentSchema = db_mysql_SchemaRef::cast_from(catalog->defaultSchema());
+    if (!currentSchema.is_valid())
+    {
+      db_SchemaRef df = find_named_object_in_list(catalog->schemata(), "default_schema", caseSensitive);
+      if (!df.is_valid())
+        defaultSchemaCreated = true;
+      currentSchema = ensureSchemaExists(catalog, "default_schema", caseSensitive);
+    }
+  }
+
+  size_t errorCount = 0;
+  MySQLRecognizer *recognizer = context->recognizer();
+  boost::shared_ptr<MySQLQueryIdentifier> queryIdentifier = context->createQueryIdentifier();
+
+  std::vector<std::pair<size_t, size_t> > ranges;
+  determineStatementRanges(sql.c_str(), sql.size(), ";", ranges, "\n");
+
+  grt::ListRef<GrtObject> createdObjects = grt::ListRef<GrtObject>::cast_from(options.get("created_objects"));
+  if (!createdObjects.is_valid())
+  {
+    createdObjects = grt::ListRef<GrtObject>(catalog->get_grt());
+    options.set("created_objects", createdObjects);
+  }
+
+  CatalogImportState state;
+  state.catalog = catalog;
+  state.currentSchema = currentSchema;
+  state.caseSensitive = caseSensitive;
+  state.autoGenerateFkNames = autoGenerateFkNames;
+  state.createdObjects = createdObjects;
+
+  // Large scripts are parsed on several threads. The parse_thread_count option can force a thread count,
+  // 1 means a serial import.
+  int threadCount = (int)options.get_int("parse_thread_count", -1);
+  boost::scoped_ptr<ParallelCatalogImport> parallelImport;
+  if (threadCount > 1 || (threadCount < 1 && ranges.size() >= PARALLEL_IMPORT_MIN_STATEMENTS))
+  {
+    parallelImport.reset(new ParallelCatalogImport(context, state, sql, relevantQueryTypes));
+    errorCount = parallelImport->run(ranges, threadCount);
+  }
+  else
+  {
+    for (std::vector<std::pair<size_t, size_t> >::iterator iterator = ranges.begin(); iterator != ranges.end(); ++iterator)
+    {
+      //std::string ddl(sql.c_str() + iterator->first, iterator->second);
+      MySQLQueryType queryType = queryIdentifier->getQueryType(sql.c_str() + iterator->first, iterator->second, true);
+      size_t errors = queryIdentifier->error_info().size(); // Can only be lexer errors.
+      if (errors > 0)
+      {
+        errorCount += errors;
+        continue;
+      }
+
+      if (relevantQueryTypes.count(queryType) == 0)
+        continue; // Something we are not interested in. Don't bother parsing it.
+
+      recognizer->parse(sql.c_str() + iterator->first, iterator->second, true, PuGeneric);
+      errors = recognizer->error_info().size();
+      if (errors > 0)
+      {
+        errorCount += errors;
+        continue;
+      }
+
+      applyStatement(recognizer, queryType, state);
     }
   }
 
-  resolveReferences(catalog, refCache, context->case_sensitive());
+  resolveReferences(catalog, state.refCache, context->case_sensitive());
 
   // Remove the default_schema we may have created at the start, if it is empty.
   if (defaultSchemaCreated)
@@ -4602,7 +5711,7 @@ grt::BaseListRef MySQLParserServicesImpl::getSqlStatementRanges(const std::strin
 size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t length,
   const std::string &initial_delimiter,
   std::vector<std::pair<size_t, size_t> > &ranges,
-  const std::string &line_break)
+  const std::string &line_break, std::vector<std::pair<size_t, std::string> > *delimiter_changes)
 {
   _stop = false;
   std::string delimiter = initial_delimiter.empty() ? ";" : initial_delimiter;
@@ -4716,11 +5825,14 @@ size_t MySQLParserServicesImpl::determineStatementRanges(const char *sql, size_t
         if (count == 0 && *run == ' ')
         {
           // Delimiter keyword found. Get the new delimiter (everything until the end of the line).
+          size_t keyword_position = tail - (unsigned char *)sql;
           tail = run++;
           while (run < end && !is_line_break(run, new_line))
             run++;
           delimiter = base::trim(std::string((char *)tail, run - tail));
           delimiter_head = (unsigned char*)delimiter.c_str();
+          if (delimiter_changes != NULL)
+            delimiter_changes->push_back(std::make_pair(keyword_position, delimiter));
 
           // Skip over the delimiter statement and any following line breaks.
           while (is_line_break(run, new_line))
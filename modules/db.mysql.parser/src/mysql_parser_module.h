@@ -29,6 +29,8 @@
   #define MYSQL_PARSER_PUBLIC
 #endif
 
+#include <boost/scoped_ptr.hpp>
+
 #include "grtpp_module_cpp.h"
 #include "grtsqlparser/mysql_parser_services.h"
 
@@ -45,13 +47,13 @@
 
 //--------------------------------------------------------------------------------------------------
 
+class ParseResultCache;
+
 class MYSQL_PARSER_PUBLIC MySQLParserServicesImpl : public parser::MySQLParserServices, public grt::ModuleImplBase
 {
 public:
-  MySQLParserServicesImpl(grt::CPPModuleLoader *loader)
-    : grt::ModuleImplBase(loader)
-  {
-  }
+  MySQLParserServicesImpl(grt::CPPModuleLoader *loader);
+  virtual ~MySQLParserServicesImpl();
   DEFINE_INIT_MODULE_DOC("1.0", "Oracle Corporation", DOC_MYSQLPARSERSERVICESIMPL, grt::ModuleImplBase,
     DECLARE_MODULE_FUNCTION_DOC(MySQLParserServicesImpl::createParserContext,
       "Creates a new parser context which is needed for most calls to parse or syntax check something.",
@@ -133,6 +135,11 @@ public:
       "context_ref a previously created parser context reference\n"
       "sql the SQL code to parse"),
 
+    DECLARE_MODULE_FUNCTION_DOC(MySQLParserServicesImpl::getParseCacheStatistics,
+      "Returns the hit and miss counters, entry count, estimated size and size limit of the cache "
+      "used for parsing single object definitions (tables, views, routines and triggers).",
+      ""),
+
     NULL);
 
   // Certain module functions taking a parser context have 2 implementations. One for
@@ -201,11 +208,16 @@ public:
   grt::BaseListRef getSqlStatementRanges(const std::string &sql);
   virtual size_t determineStatementRanges(const char *sql, size_t length,
     const std::string &initial_delimiter, std::vector<std::pair<size_t, size_t> > &ranges,
-    const std::string &line_break = "\n");
+    const std::string &line_break = "\n", std::vector<std::pair<size_t, std::string> > *delimiter_changes = NULL);
 
   grt::DictRef parseStatementDetails(parser_ContextReferenceRef context_ref, const std::string &sql);
   virtual grt::DictRef parseStatement(parser::ParserContext::Ref context, grt::GRT *grt, const std::string &sql);
 
+  grt::DictRef getParseCacheStatistics();
+  virtual parser::ParseCacheStatistics parseCacheStatistics();
+  virtual void setParseCacheLimit(size_t limit);
+  virtual void clearParseCache();
+
   // Query manipulation.
   std::string replaceTokenSequence(parser_ContextReferenceRef context_ref,
     const std::string &sql, size_t start_token, size_t count, grt::StringListRef replacements);
@@ -213,4 +225,7 @@ public:
     const std::string &sql, size_t start_token, size_t count, const std::vector<std::string> replacements);
 private:
   bool _stop;
+
+  // There is one module instance per grt, so this is shared by all parser contexts and callers.
+  boost::scoped_ptr<ParseResultCache> _parseCache;
 };
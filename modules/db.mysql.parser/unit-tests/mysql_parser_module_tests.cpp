@@ -21,6 +21,7 @@
 
 #include "grtpp.h"
 #include "grtsqlparser/mysql_parser_services.h"
+#include "grt_test_utility.h"
 
 using namespace parser;
 
@@ -203,4 +204,195 @@ TEST_FUNCTION(95)
 // other_administrative_statement
 // utility_statement
 
+// A parallel import of a script must give the same catalog as a serial one. The script contains statements
+// which invalidate what the parallel import assumes about the current schema and schema charsets.
+TEST_FUNCTION(100)
+{
+  std::string sql =
+    "CREATE DATABASE latin CHARACTER SET latin1;\n"
+    "CREATE TABLE t0 (id int PRIMARY KEY, name varchar(20));\n"
+    "USE latin;\n"
+    "CREATE TABLE t1 (id int PRIMARY KEY, name varchar(20), t2_id int, FOREIGN KEY (t2_id) REFERENCES t2 (id));\n"
+    "CREATE TABLE other.t1 (id int, name text);\n"
+    "CREATE TABLE t1_copy LIKE t1;\n"
+    "CREATE VIEW v1 AS SELECT * FROM t1;\n"
+    "CREATE TRIGGER tr1 BEFORE INSERT ON t1 FOR EACH ROW SET NEW.name = upper(NEW.name);\n"
+    "CREATE EVENT e1 ON SCHEDULE EVERY 1 DAY DO DELETE FROM t1;\n"
+    "CREATE TABLE broken (id int,;\n"
+    "DROP DATABASE latin;\n"
+    "CREATE DATABASE latin CHARACTER SET utf8;\n"
+    "USE latin;\n"
+    "CREATE TABLE t2 (id int PRIMARY KEY, name varchar(20));\n"
+    "RENAME TABLE t2 TO t3;\n"
+    "CREATE TABLE t2 (id int PRIMARY KEY, t3_id int, FOREIGN KEY (t3_id) REFERENCES t3 (id));\n"
+    "USE Other;\n"
+    "CREATE TABLE t4 (id int);\n";
+
+  for (int i = 0; i < 300; ++i)
+  {
+    sql += base::strfmt("CREATE TABLE tab%i (id int PRIMARY KEY, value varchar(40), ref int, "
+      "FOREIGN KEY (ref) REFERENCES tab%i (id));\n", i, i + 1);
+    if (i % 50 == 0)
+      sql += base::strfmt("CREATE PROCEDURE proc%i() BEGIN SELECT * FROM tab%i; END;\n", i, i);
+  }
+
+  db_mysql_CatalogRef catalogs[2];
+  size_t errors[2];
+  int threadCounts[2] = { 1, 4 };
+  for (int i = 0; i < 2; ++i)
+  {
+    catalogs[i] = db_mysql_CatalogRef(_tester.grt);
+    catalogs[i]->version(_tester.get_rdbms()->version());
+    catalogs[i]->defaultCharacterSetName("utf8");
+    catalogs[i]->defaultCollationName("utf8_general_ci");
+    grt::replace_contents(catalogs[i]->simpleDatatypes(), _tester.get_rdbms()->simpleDatatypes());
+    grt::replace_contents(catalogs[i]->characterSets(), _tester.get_rdbms()->characterSets());
+
+    grt::DictRef options(_tester.grt);
+    options.set("gen_fk_names_when_empty", grt::IntegerRef(0));
+    options.set("parse_thread_count", grt::IntegerRef(threadCounts[i]));
+    errors[i] = _services->parseSQLIntoCatalog(_context, catalogs[i], sql, options);
+  }
+
+  ensure_equals("Error count", errors[1], errors[0]);
+  ensure("Objects created", catalogs[0]->schemata().count() > 1);
+  grt_ensure_equals("Parallel import", catalogs[1], catalogs[0]);
+}
+
+// Parse results of single objects are cached. A cached result must be the same as a parsed one and
+// must only change what parsing changes.
+TEST_FUNCTION(105)
+{
+  _services->clearParseCache();
+
+  db_mysql_CatalogRef catalog(_tester.grt);
+  catalog->version(_tester.get_rdbms()->version());
+  grt::replace_contents(catalog->simpleDatatypes(), _tester.get_rdbms()->simpleDatatypes());
+  db_mysql_SchemaRef schema(_tester.grt);
+  schema->owner(catalog);
+  schema->name("sakila");
+  catalog->schemata().insert(schema);
+
+  std::string sql = "CREATE TABLE actor (actor_id smallint unsigned NOT NULL AUTO_INCREMENT, "
+    "first_name varchar(45) NOT NULL, last_update timestamp NOT NULL DEFAULT CURRENT_TIMESTAMP, "
+    "PRIMARY KEY (actor_id), KEY idx_first_name (first_name)) ENGINE=InnoDB DEFAULT CHARSET=utf8";
+
+  db_mysql_TableRef tables[2];
+  for (int i = 0; i < 2; ++i)
+  {
+    tables[i] = db_mysql_TableRef(_tester.grt);
+    tables[i]->owner(schema);
+    tables[i]->comment("keep me");
+    ensure_equals("Table parse errors", _services->parseTable(_context, tables[i], sql), (size_t)0);
+  }
+
+  ParseCacheStatistics statistics = _services->parseCacheStatistics();
+  ensure_equals("Table hits", statistics.hits, (size_t)1);
+  ensure_equals("Table misses", statistics.misses, (size_t)1);
+  ensure_equals("Cache entries", statistics.entries, (size_t)1);
+  ensure("Cache size", statistics.size > sql.size());
+
+  db_mysql_TableRef table = tables[1];
+  ensure_equals("Name", *table->name(), "actor");
+  ensure_equals("Engine", *table->tableEngine(), "InnoDB");
+  ensure_equals("Untouched member", *table->comment(), "keep me");
+  ensure_equals("Column count", table->columns().count(), (size_t)3);
+  ensure("Own columns", table->columns()[0] != tables[0]->columns()[0]);
+  ensure("Column owner", table->columns()[0]->owner() == table);
+  ensure("Column type", table->columns()[1]->simpleType() == tables[0]->columns()[1]->simpleType());
+  ensure_equals("Index count", table->indices().count(), (size_t)2);
+  ensure("Primary key", table->primaryKey() == table->indices()[0]);
+  ensure("Index column", table->indices()[1]->columns()[0]->referencedColumn() == table->columns()[1]);
+
+  // Tables with foreign keys depend on other tables and are not cached.
+  sql = "CREATE TABLE film_actor (actor_id smallint unsigned NOT NULL, film_id smallint unsigned NOT NULL, "
+    "PRIMARY KEY (actor_id, film_id), CONSTRAINT fk_actor FOREIGN KEY (actor_id) REFERENCES actor (actor_id))";
+  for (int i = 0; i < 2; ++i)
+  {
+    db_mysql_TableRef table(_tester.grt);
+    table->owner(schema);
+    _services->parseTable(_context, table, sql);
+  }
+  statistics = _services->parseCacheStatistics();
+  ensure_equals("Foreign key misses", statistics.misses, (size_t)3);
+  ensure_equals("Foreign key entries", statistics.entries, (size_t)1);
+
+  // Views, routines and triggers. The sql mode is part of the key.
+  sql = "CREATE ALGORITHM=MERGE VIEW actor_names AS SELECT first_name FROM actor";
+  db_mysql_ViewRef views[3];
+  for (int i = 0; i < 3; ++i)
+  {
+    views[i] = db_mysql_ViewRef(_tester.grt);
+    views[i]->owner(schema);
+    if (i == 2)
+      _context->use_sql_mode("ANSI_QUOTES");
+    _services->parseView(_context, views[i], sql);
+  }
+  _context->use_sql_mode("");
+  ensure_equals("View name", *views[1]->name(), "actor_names");
+  ensure_equals("View algorithm", *views[1]->algorithm(), (ssize_t)1);
+
+  sql = "CREATE PROCEDURE get_actor(IN id int, OUT name varchar(45)) COMMENT 'lookup' "
+    "SELECT first_name INTO name FROM actor WHERE actor_id = id";
+  db_mysql_RoutineRef routines[2];
+  for (int i = 0; i < 2; ++i)
+  {
+    routines[i] = db_mysql_RoutineRef(_tester.grt);
+    routines[i]->owner(schema);
+    _services->parseRoutine(_context, routines[i], sql);
+  }
+  ensure_equals("Routine comment", *routines[1]->comment(), "lookup");
+  ensure_equals("Parameter count", routines[1]->params().count(), (size_t)2);
+  ensure("Parameter owner", routines[1]->params()[0]->owner() == routines[1]);
+
+  sql = "CREATE TRIGGER actor_bi BEFORE INSERT ON actor FOR EACH ROW SET NEW.first_name = upper(NEW.first_name)";
+  db_mysql_TriggerRef triggers[2];
+  for (int i = 0; i < 2; ++i)
+  {
+    triggers[i] = db_mysql_TriggerRef(_tester.grt);
+    triggers[i]->owner(table);
+    _services->parseTrigger(_context, triggers[i], sql);
+  }
+  ensure_equals("Trigger name", *triggers[1]->name(), "actor_bi");
+  ensure_equals("Trigger event", *triggers[1]->event(), "INSERT");
+
+  statistics = _services->parseCacheStatistics();
+  ensure_equals("Hits", statistics.hits, (size_t)4);
+  ensure_equals("Misses", statistics.misses, (size_t)7);
+
+  // With the cache disabled every parse is a miss, otherwise only the first one.
+  sql = "CREATE TABLE payment (payment_id smallint unsigned NOT NULL AUTO_INCREMENT, customer_id smallint unsigned NOT NULL, "
+    "staff_id tinyint unsigned NOT NULL, rental_id int DEFAULT NULL, amount decimal(5,2) NOT NULL, "
+    "payment_date datetime NOT NULL, last_update timestamp NULL DEFAULT CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP, "
+    "PRIMARY KEY (payment_id), KEY idx_fk_staff_id (staff_id), KEY idx_fk_customer_id (customer_id)) "
+    "ENGINE=InnoDB AUTO_INCREMENT=16050 DEFAULT CHARSET=utf8";
+
+  _services->setParseCacheLimit(0);
+  statistics = _services->parseCacheStatistics();
+  ensure_equals("Disabled cache", statistics.entries, (size_t)0);
+  for (int i = 0; i < 200; ++i)
+  {
+    db_mysql_TableRef table(_tester.grt);
+    table->owner(schema);
+    _services->parseTable(_context, table, sql);
+  }
+  ParseCacheStatistics disabled = _services->parseCacheStatistics();
+  ensure_equals("Disabled cache hits", disabled.hits, statistics.hits);
+  ensure_equals("Disabled cache misses", disabled.misses, statistics.misses + 200);
+  ensure_equals("Disabled cache entries", disabled.entries, (size_t)0);
+
+  _services->setParseCacheLimit(32 * 1024 * 1024);
+  for (int i = 0; i < 200; ++i)
+  {
+    db_mysql_TableRef table(_tester.grt);
+    table->owner(schema);
+    _services->parseTable(_context, table, sql);
+    ensure_equals("Payment columns", table->columns().count(), (size_t)7);
+  }
+  statistics = _services->parseCacheStatistics();
+  ensure_equals("Enabled cache hits", statistics.hits, disabled.hits + 199);
+  ensure_equals("Enabled cache misses", statistics.misses, disabled.misses + 1);
+  ensure_equals("Enabled cache entries", statistics.entries, (size_t)1);
+}
+
 END_TESTS
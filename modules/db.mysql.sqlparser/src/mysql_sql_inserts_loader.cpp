@@ -19,10 +19,12 @@
 
 #include <glib.h>
 #include <boost/signals2.hpp>
+#include <algorithm>
 #include <cctype>
 
 #include "mysql_sql_inserts_loader.h"
 #include "mysql_sql_parser_utils.h"
+#include "base/string_utilities.h"
 #include <boost/foreach.hpp>
 
 
@@ -32,10 +34,176 @@ using namespace grt;
 #define NULL_STATE_KEEPER Null_state_keeper _nsk(this);
 
 
+/*
+ * Helpers for the fast path. They work on the raw script text and only accept what they fully understand,
+ * everything else makes the statement go through the parser.
+ */
+
+static inline bool is_ident_char(char c)
+{
+  return isalnum((unsigned char)c) || (c == '_') || (c == '$') || ((unsigned char)c >= 0x80);
+}
+
+
+static inline bool is_line_comment(const char *p, const char *end)
+{
+  if (*p == '#')
+    return true;
+  return (*p == '-') && (p + 1 < end) && (p[1] == '-') && ((p + 2 == end) || isspace((unsigned char)p[2]));
+}
+
+
+static const char * skip_space(const char *p, const char *end)
+{
+  while ((p < end) && isspace((unsigned char)*p))
+    ++p;
+  return p;
+}
+
+
+// Version comments (/*!...*/) are not skipped, they contain statement text.
+static const char * skip_space_and_comments(const char *p, const char *end)
+{
+  while (p < end)
+  {
+    if (isspace((unsigned char)*p))
+      ++p;
+    else if (is_line_comment(p, end))
+      p= std::find(p, end, '\n');
+    else if ((*p == '/') && (p + 2 < end) && (p[1] == '*') && (p[2] != '!'))
+    {
+      static const char comment_end[]= "*/";
+      p= std::search(p + 2, end, comment_end, comment_end + 2);
+      p= (p == end) ? end : p + 2;
+    }
+    else
+      break;
+  }
+  return p;
+}
+
+
+// Returns the position of the ; ending the statement at p, or the end of the script.
+static const char * find_statement_end(const char *p, const char *end, bool backslash_escapes)
+{
+  while (p < end)
+  {
+    char c= *p;
+    if ((c == '\'') || (c == '"') || (c == '`'))
+    {
+      for (++p; (p < end) && (*p != c); ++p)
+      {
+        if (backslash_escapes && (c != '`') && (*p == '\\') && (p + 1 < end))
+          ++p;
+      }
+      if (p < end)
+        ++p;
+    }
+    else if (is_line_comment(p, end))
+      p= std::find(p, end, '\n');
+    else if ((c == '/') && (p + 1 < end) && (p[1] == '*'))
+    {
+      static const char comment_end[]= "*/";
+      p= std::search(p + 2, end, comment_end, comment_end + 2);
+      p= (p == end) ? end : p + 2;
+    }
+    else if (c == ';')
+      break;
+    else
+      ++p;
+  }
+  return p;
+}
+
+
+// Matches a keyword case insensitively and skips it, together with the white space after it.
+static bool match_keyword(const char *&p, const char *end, const char *keyword)
+{
+  size_t length= strlen(keyword);
+  if (((size_t)(end - p) < length) || (g_ascii_strncasecmp(p, keyword, length) != 0))
+    return false;
+  if ((p + length < end) && is_ident_char(p[length]))
+    return false;
+  p= skip_space(p + length, end);
+  return true;
+}
+
+
+// Plain or back tick quoted identifiers, the latter without escaped back ticks.
+static bool read_identifier(const char *&p, const char *end, std::string &name)
+{
+  const char *start;
+  if ((p < end) && (*p == '`'))
+  {
+    start= ++p;
+    p= std::find(p, end, '`');
+    if ((p == end) || (p == start) || ((p + 1 < end) && (p[1] == '`')))
+      return false;
+    name.assign(start, p++);
+  }
+  else
+  {
+    for (start= p; (p < end) && is_ident_char(*p); ++p)
+      ;
+    if (p == start)
+      return false;
+    name.assign(start, p);
+  }
+  p= skip_space(p, end);
+  return true;
+}
+
+
+// Converts the text of a value into what gets stored for it. Strings are stored without quotes
+// (but with escapes, as written), everything that is not a plain number is marked as expression.
+static void normalize_value(std::string &value)
+{
+  if (1 < value.size())
+  {
+    switch (value[0])
+    {
+    case '\'':
+    case '"':
+      value= value.substr(1, value.size()-2);
+      break;
+    default:
+      static const std::string func_call_seq= "\\func ";
+      if (value[0] == '\\')
+      {
+        if ((value.size() > func_call_seq.size()) && (value.compare(0, func_call_seq.size(), func_call_seq) == 0))
+        {
+          value= '\\' + value;
+        }
+      }
+      else
+      {
+        bool is_expression= false;
+        for (std::string::iterator i= value.begin(), i_end= value.end(); i != i_end; ++i)
+        {
+          if (!std::isdigit(*i) && (*i != '.') && (*i != ','))
+          {
+            is_expression= true;
+            break;
+          }
+        }
+        if (is_expression)
+        {
+          value= func_call_seq + value;
+        }
+      }
+      break;
+    }
+  }
+}
+
+
 Mysql_sql_inserts_loader::Mysql_sql_inserts_loader(grt::GRT *grt)
 :
 Sql_parser_base(grt),
-Mysql_sql_parser_base(grt)
+Mysql_sql_parser_base(grt),
+_use_fast_path(true),
+_backslash_escapes(true),
+_ansi_quotes(false)
 {
   NULL_STATE_KEEPER
 }
@@ -48,12 +216,232 @@ void Mysql_sql_inserts_loader::load(const std::string &sql, const std::string &s
   _schema_name= schema_name;
   _process_sql_statement= boost::bind(&Mysql_sql_inserts_loader::process_sql_statement, this, _1);
 
-  Mysql_sql_parser_fe sql_parser_fe(_grtm->get_app_option_string("SqlMode"));
+  std::string sql_mode= _grtm->get_app_option_string("SqlMode");
+  Mysql_sql_parser_fe sql_parser_fe(sql_mode);
   sql_parser_fe.ignore_dml= false;
+  if (!_use_fast_path)
+  {
+    Mysql_sql_parser_base::parse_sql_script(sql_parser_fe, sql.c_str());
+    return;
+  }
+
+  if (_override_sql_mode)
+    sql_mode= _sql_mode;
+  sql_mode= base::toupper(sql_mode);
+  _backslash_escapes= (sql_mode.find("NO_BACKSLASH_ESCAPES") == std::string::npos);
+  _ansi_quotes= (sql_mode.find("ANSI_QUOTES") != std::string::npos);
+
+  // Each statement is checked by the tuple scanner first. Runs of statements it doesn't accept are
+  // handed to the parser in one go, before the rows of the next accepted statement are reported,
+  // so rows arrive in script order.
+  const char *end= sql.c_str() + sql.size();
+  const char *fallback_begin= NULL;
+  for (const char *p= sql.c_str(); p < end; )
+  {
+    const char *statement= skip_space_and_comments(p, end);
+    if (statement == end)
+      break;
+
+    // A custom delimiter changes how statements end, leave the rest to the parser.
+    const char *delimiter= statement;
+    if (match_keyword(delimiter, end, "DELIMITER"))
+    {
+      if (fallback_begin == NULL)
+        fallback_begin= statement;
+      break;
+    }
+
+    const char *statement_end= find_statement_end(statement, end, _backslash_escapes);
+    if (read_insert_statement(statement, statement_end, false))
+    {
+      if (fallback_begin != NULL)
+      {
+        parse_statements(sql_parser_fe, fallback_begin, statement);
+        fallback_begin= NULL;
+      }
+      read_insert_statement(statement, statement_end, true);
+    }
+    else if (fallback_begin == NULL)
+      fallback_begin= statement;
+
+    p= (statement_end < end) ? statement_end + 1 : end;
+  }
+
+  if (fallback_begin != NULL)
+    parse_statements(sql_parser_fe, fallback_begin, end);
+}
+
+
+void Mysql_sql_inserts_loader::parse_statements(Mysql_sql_parser_fe &sql_parser_fe, const char *begin, const char *end)
+{
+  std::string sql(begin, end);
   Mysql_sql_parser_base::parse_sql_script(sql_parser_fe, sql.c_str());
 }
 
 
+/**
+ * Reads an INSERT [LOW_PRIORITY | DELAYED | HIGH_PRIORITY] [IGNORE] [INTO] table (columns) VALUES (...), ...
+ * statement. Returns false for anything else. Rows are only reported if report_rows is set, so a statement
+ * can be checked completely before any of its rows is passed on.
+ */
+bool Mysql_sql_inserts_loader::read_insert_statement(const char *begin, const char *end, bool report_rows)
+{
+  const char *p= begin;
+  if (!match_keyword(p, end, "INSERT"))
+    return false;
+  if (!match_keyword(p, end, "LOW_PRIORITY") && !match_keyword(p, end, "DELAYED"))
+    match_keyword(p, end, "HIGH_PRIORITY");
+  match_keyword(p, end, "IGNORE");
+  match_keyword(p, end, "INTO");
+
+  std::pair<std::string, std::string> schema_table(_schema_name, std::string());
+  if (!read_identifier(p, end, schema_table.second))
+    return false;
+  if ((p < end) && (*p == '.'))
+  {
+    p= skip_space(p + 1, end);
+    schema_table.first= schema_table.second;
+    if (!read_identifier(p, end, schema_table.second))
+      return false;
+  }
+
+  Strings fields_names;
+  if ((p == end) || (*p != '('))
+    return false;
+  p= skip_space(p + 1, end);
+  while (true)
+  {
+    std::string name;
+    if (!read_identifier(p, end, name))
+      return false;
+    fields_names.push_back(name);
+    if ((p < end) && (*p == ','))
+      p= skip_space(p + 1, end);
+    else if ((p < end) && (*p == ')'))
+    {
+      p= skip_space(p + 1, end);
+      break;
+    }
+    else
+      return false;
+  }
+
+  if (!match_keyword(p, end, "VALUES") && !match_keyword(p, end, "VALUE"))
+    return false;
+
+  std::string statement;
+  if (report_rows)
+    statement.assign(begin, end);
+
+  Strings fields_values;
+  std::vector<bool> null_fields;
+  fields_values.reserve(fields_names.size());
+  null_fields.reserve(fields_names.size());
+  std::string value;
+  while (true)
+  {
+    if ((p == end) || (*p != '('))
+      return false;
+    p= skip_space(p + 1, end);
+
+    fields_values.clear();
+    null_fields.clear();
+    if ((p < end) && (*p != ')'))
+    {
+      while (true)
+      {
+        bool is_null;
+        if (!read_value(p, end, value, is_null))
+          return false;
+        fields_values.push_back(value);
+        null_fields.push_back(is_null);
+        if (*p == ')')
+          break;
+        p= skip_space(p + 1, end); // Skip the comma.
+      }
+    }
+    if (p == end)
+      return false;
+    ++p;
+
+    if (report_rows)
+      _process_insert(statement, schema_table, fields_names, fields_values, null_fields);
+
+    p= skip_space(p, end);
+    if ((p < end) && (*p == ','))
+      p= skip_space(p + 1, end);
+    else
+      break;
+  }
+
+  return (p == end);
+}
+
+
+/**
+ * Reads a single value of a row, up to the comma or closing parenthesis after it.
+ * The value text is the same as the parser would return for the expression.
+ */
+bool Mysql_sql_inserts_loader::read_value(const char *&p, const char *end, std::string &value, bool &is_null)
+{
+  const char *start= p;
+  const char *value_end= p;
+  int depth= 0;
+  while (p < end)
+  {
+    char c= *p;
+    if ((c == '\'') || (c == '"'))
+    {
+      // Identifiers would be returned without quotes by the parser.
+      if ((c == '"') && _ansi_quotes)
+        return false;
+
+      for (++p; (p < end) && (*p != c); ++p)
+      {
+        if (_backslash_escapes && (*p == '\\') && (p + 1 < end))
+          ++p;
+      }
+      if (p == end)
+        return false;
+      value_end= ++p;
+      continue;
+    }
+
+    if (c == '(')
+      ++depth;
+    else if (c == ')')
+    {
+      if (depth == 0)
+        break;
+      --depth;
+    }
+    else if ((c == ',') && (depth == 0))
+      break;
+    else if ((c == ';') || (c == '`') || is_line_comment(p, end) || ((c == '/') && (p + 1 < end) && (p[1] == '*')))
+      return false;
+
+    if (!isspace((unsigned char)c))
+      value_end= p + 1;
+    ++p;
+  }
+  if ((p == end) || (value_end == start))
+    return false;
+
+  value.assign(start, value_end);
+  is_null= (value.size() == 4) && (g_ascii_strncasecmp(value.c_str(), "NULL", 4) == 0);
+  if (is_null)
+    value.clear();
+  else
+  {
+    // \N is a NULL for the parser, leave all such cases to it.
+    if (value[0] == '\\')
+      return false;
+    normalize_value(value);
+  }
+  return true;
+}
+
+
 int Mysql_sql_inserts_loader::process_sql_statement(const SqlAstNode *tree)
 {
   if (tree)
@@ -134,42 +522,7 @@ Mysql_sql_inserts_loader::process_insert_statement(const SqlAstNode *tree)
               if (!is_field_null)
               {
                 value= item->restore_sql_text(_sql_statement);
-                if (1 < value.size())
-                {
-                  switch (value[0])
-                  {
-                  case '\'':
-                  case '"':
-                    value= value.substr(1, value.size()-2);
-                    break;
-                  default:
-                    static const std::string func_call_seq= "\\func ";
-                    if (value[0] == '\\')
-                    {
-                      if ((value.size() > func_call_seq.size()) && (value.compare(0, func_call_seq.size(), func_call_seq) == 0))
-                      {
-                        value= '\\' + value;
-                      }
-                    }
-                    else
-                    {
-                      bool is_expression= false;
-                      for (std::string::iterator i= value.begin(), i_end= value.end(); i != i_end; ++i)
-                      {
-                        if (!std::isdigit(*i) && (*i != '.') && (*i != ','))
-                        {
-                          is_expression= true;
-                          break;
-                        }
-                      }
-                      if (is_expression)
-                      {
-                        value= func_call_seq + value;
-                      }
-                    }
-                    break;
-                  }
-                }
+                normalize_value(value);
               }
 
               fields_values.push_back(value);
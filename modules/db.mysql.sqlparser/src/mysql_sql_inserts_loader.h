@@ -42,6 +42,10 @@ protected:
 public:
   void load(const std::string &sql, const std::string &schema_name);
 
+  // Plain INSERT ... VALUES statements are read by a tuple scanner instead of the parser, which is
+  // much faster for big scripts. Enabled by default, other statements always go through the parser.
+  void use_fast_path(bool flag) { _use_fast_path= flag; }
+
 protected:
   // higher level
   int process_sql_statement(const SqlAstNode *tree);
@@ -49,6 +53,15 @@ protected:
   // parse tree core
   Parse_result process_insert_statement(const SqlAstNode *tree);
 
+  // fast path
+  bool read_insert_statement(const char *begin, const char *end, bool report_rows);
+  bool read_value(const char *&p, const char *end, std::string &value, bool &is_null);
+  void parse_statements(Mysql_sql_parser_fe &sql_parser_fe, const char *begin, const char *end);
+
+  bool _use_fast_path;
+  bool _backslash_escapes;
+  bool _ansi_quotes;
+
   // context
   std::string _schema_name;
 
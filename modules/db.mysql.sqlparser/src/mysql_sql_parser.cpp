@@ -95,6 +95,13 @@ Mysql_sql_parser::Null_state_keeper::~Null_state_keeper()
   _sql_parser->_sql_script_codeset= StringRef("");
   _sql_parser->_triggers_owner_table= db_mysql_TableRef();
 
+  for (std::vector<grt::BaseListRef>::iterator list= _sql_parser->_name_indexed_lists.begin();
+       list != _sql_parser->_name_indexed_lists.end(); ++list)
+    (*list)->disable_name_index();
+  _sql_parser->_name_indexed_lists.clear();
+  _sql_parser->_parse_thread_count= -1;
+  _sql_parser->_index_names= true;
+
   _sql_parser->_shape_schema = boost::bind(f);
   _sql_parser->_shape_table = boost::bind(f);
   _sql_parser->_shape_view = boost::bind(f);
@@ -151,6 +158,9 @@ void Mysql_sql_parser::set_options(grt::DictRef options)
   overwrite_default_option<grt::IntegerRef>(_processing_alter_statements, "processing_alter_statements", options);
   overwrite_default_option<grt::IntegerRef>(_processing_drop_statements, "processing_drop_statements", options);
   overwrite_default_option<grt::IntegerRef>(_reuse_existing_objects, "reuse_existing_objects", options);
+  overwrite_default_option<grt::IntegerRef>(_index_names, "index_names", options);
+  if (options.has_key("parse_thread_count"))
+    _parse_thread_count= (int)*grt::IntegerRef::cast_from(options.get("parse_thread_count"));
 }
 
 
@@ -183,6 +193,11 @@ int Mysql_sql_parser::parse_sql_script(db_CatalogRef &catalog, const std::string
 
   build_datatype_cache();
 
+  // Scripts with many objects would spend most time in name lookups otherwise.
+  index_names(_catalog->schemata());
+  for (size_t i= 0, count= _catalog->schemata().count(); i < count; ++i)
+    index_schema_names(_catalog->schemata().get(i));
+
   // change current schema to default, it will be used for objects without specified schema
   db_mysql_SchemaRef default_schema;
   int initial_schemata_count= -1;
@@ -205,6 +220,8 @@ int Mysql_sql_parser::parse_sql_script(db_CatalogRef &catalog, const std::string
   sql_parser_fe.processing_create_statements= _processing_create_statements;
   sql_parser_fe.processing_alter_statements= _processing_alter_statements;
   sql_parser_fe.processing_drop_statements= _processing_drop_statements;
+  // catalog objects are still created one statement after another, only the parsing runs in parallel
+  sql_parser_fe.parse_thread_count= _parse_thread_count;
 
   const std::string *sql_script= &sql;
   std::string sql_in_utf8;
@@ -641,6 +658,8 @@ db_mysql_SchemaRef Mysql_sql_parser::ensure_schema_created(const std::string &sc
       _shape_schema(schema);
     do_transactable_list_insert(_catalog->schemata(), schema);
     log_db_obj_created(schema);
+    if (_catalog->schemata()->has_name_index(_case_sensitive_identifiers))
+      index_schema_names(schema);
   }
   else if (check_obj_name_uniqueness)
     blame_existing_obj(false, schema);
@@ -649,6 +668,26 @@ db_mysql_SchemaRef Mysql_sql_parser::ensure_schema_created(const std::string &sc
 }
 
 
+void Mysql_sql_parser::index_schema_names(db_mysql_SchemaRef schema)
+{
+  index_names(schema->tables());
+  index_names(schema->views());
+  index_names(schema->routines());
+}
+
+
+/**
+ * Enables the name index of the given list until parsing is finished, unless it is indexed already.
+ */
+void Mysql_sql_parser::index_names(grt::BaseListRef list)
+{
+  if (!_index_names || list->has_name_index(true) || list->has_name_index(false))
+    return;
+  list->enable_name_index(_case_sensitive_identifiers);
+  _name_indexed_lists.push_back(list);
+}
+
+
 void Mysql_sql_parser::create_stub_table(db_mysql_SchemaRef &schema, db_mysql_TableRef &obj, const std::string &obj_name)
 {
   obj= db_mysql_TableRef(_grt);
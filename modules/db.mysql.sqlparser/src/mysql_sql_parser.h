@@ -66,6 +66,9 @@ protected:
   bool _gen_fk_names_when_empty; // generate unique fk name when name is not given
   bool _strip_sql; // it's not wanted to strip input in editors, while it's so in most other cases
   Parse_result _last_parse_result;
+  bool _index_names; // index object lists by name while parsing (option only meant for benchmarks)
+  std::vector<grt::BaseListRef> _name_indexed_lists; // object lists indexed by name while parsing
+  int _parse_thread_count; // see Mysql_sql_parser_fe::parse_thread_count
 
   // higher level
   int parse_sql_script(db_CatalogRef &catalog, const std::string &sql, bool from_file, grt::DictRef &options);
@@ -91,6 +94,8 @@ protected:
   // catalog helpers
   db_mysql_SchemaRef set_active_schema(const std::string &schema_name);
   db_mysql_SchemaRef ensure_schema_created(const std::string &schema_name, bool check_obj_name_uniqueness);
+  void index_schema_names(db_mysql_SchemaRef schema);
+  void index_names(grt::BaseListRef list);
   void create_stub_table(db_mysql_SchemaRef &schema, db_mysql_TableRef &obj, const std::string &obj_name);
   void create_stub_column(db_mysql_TableRef &table, db_mysql_ColumnRef &obj, const std::string &obj_name, db_mysql_ColumnRef tpl_obj);
   void blame_existing_obj(bool critical, const GrtNamedObjectRef &obj, const GrtNamedObjectRef &container1= GrtNamedObjectRef(), const GrtNamedObjectRef &container2= GrtNamedObjectRef());
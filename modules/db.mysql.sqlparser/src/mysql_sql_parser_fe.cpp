@@ -27,6 +27,8 @@
 #include "mysql_sql_parser_fe.h"
 #include <sstream>
 #include <boost/scoped_array.hpp>
+#include <boost/scoped_ptr.hpp>
+#include <boost/bind.hpp>
 #include <boost/shared_ptr.hpp>
 #include "myx_statement_parser.h"
 
@@ -48,6 +50,9 @@ typedef void * YYSTYPE;
 
 const char *MYSQL_DEFAULT_CHARSET= "utf8_bin";
 
+// Number of statements parsed ahead per worker thread before the results are passed on.
+static const size_t PARSE_BATCH_SIZE_PER_THREAD= 16;
+
 
 namespace mysql_parser
 {
@@ -58,22 +63,6 @@ CHARSET_INFO * get_sql_charset_by_name(const char *cs_name, int/*myf*/ flags)
 }
 
 
-struct Context
-{
-  Mysql_sql_parser_fe *sql_parser_fe;
-  Mysql_sql_parser_fe::fe_process_sql_statement_callback cb;
-  void* data;
-  int err_count;
-  bool ignore_dml;
-  bool is_ast_generation_enabled;
-  size_t max_insert_statement_size;
-  bool processing_create_statements;
-  bool processing_alter_statements;
-  bool processing_drop_statements;
-  Mysql_sql_parser_fe::SqlMode sql_mode;
-};
-
-
 class Lex_helper
 {
 public:
@@ -84,9 +73,7 @@ public:
     _lex.first_item= NULL;
     _lex.last_item= NULL;
     _lex.charset= charset();
-    lex_args.arg1= &_yystype;
-    lex_args.arg2= &_lex;
-    myx_set_parser_source(statement);
+    _context.lex(&_lex);
 
     _lex.sql_mode.MODE_ANSI_QUOTES= sql_mode.MODE_ANSI_QUOTES;
     _lex.sql_mode.MODE_HIGH_NOT_PRECEDENCE= sql_mode.MODE_HIGH_NOT_PRECEDENCE;
@@ -95,20 +82,59 @@ public:
     _lex.sql_mode.MODE_IGNORE_SPACE= sql_mode.MODE_IGNORE_SPACE;
     _lex.ignore_space= _lex.sql_mode.MODE_IGNORE_SPACE;
 
-    SqlAstStatics::sql_statement(statement);
-    SqlAstStatics::is_ast_generation_enabled= is_ast_generation_enabled != 0;
-  }
-  ~Lex_helper()
-  {
-    myx_free_parser_source();
+    _context.sql_statement(statement);
+    _context.is_ast_generation_enabled(is_ast_generation_enabled);
   }
   LEX * lex() { return &_lex; }
+  SqlAstContext & context() { return _context; }
 private:
-  YYSTYPE _yystype;
+  SqlAstContext _context; // owns the AST
   LEX _lex;
 };
 
 
+/**
+ * A statement parsed on a worker thread. Its AST is kept until the statement is handed to the callback,
+ * which happens on the calling thread in script order.
+ */
+struct Parsed_statement
+{
+  Parsed_statement(const MyxStatementParser *splitter_, const char *statement, std::string &effective_sql)
+    : splitter(*splitter_), orig_sql(statement), tree(NULL)
+  {
+    sql.swap(effective_sql);
+  }
+
+  MyxStatementParser splitter; // position of the statement in the script
+  std::string orig_sql;
+  std::string sql; // the text to parse, if it differs from orig_sql (see remove_versioning_comments)
+  boost::shared_ptr<Lex_helper> lex_helper;
+  const SqlAstNode *tree;
+  std::string err_msg;
+};
+
+
+struct Context
+{
+  Mysql_sql_parser_fe *sql_parser_fe;
+  Mysql_sql_parser_fe::fe_process_sql_statement_callback cb;
+  void* data;
+  int err_count;
+  bool ignore_dml;
+  bool is_ast_generation_enabled;
+  size_t max_insert_statement_size;
+  bool processing_create_statements;
+  bool processing_alter_statements;
+  bool processing_drop_statements;
+  Mysql_sql_parser_fe::SqlMode sql_mode;
+  base::TaskGroup *parse_tasks; // NULL if statements are parsed one by one
+  std::vector<boost::shared_ptr<Parsed_statement> > parsed_statements;
+};
+
+
+static void flush_parsed_statements(Context *context);
+
+
 #define LEX_HELPER(statement, sql_mode, is_ast_generation_enabled) Lex_helper _lex_helper(statement, sql_mode, is_ast_generation_enabled);
 
 
@@ -328,7 +354,8 @@ processing_create_statements(true),
 processing_alter_statements(true),
 processing_drop_statements(true),
 is_ast_generation_enabled(true),
-max_err_count(-1)
+max_err_count(-1),
+parse_thread_count(1)
 {
   sql_mode.parse(sql_mode_);
 }
@@ -339,7 +366,6 @@ boost::shared_ptr<base::Mutex> _parser_fe_critical_section(new base::Mutex);
 
 void Mysql_sql_parser_fe::reset()
 {
-  SqlAstStatics::tree(NULL);
   ::parser_is_stopped= false;
 
   static bool initialized= false;
@@ -367,8 +393,10 @@ int Mysql_sql_parser_fe::parse_sql_script(const char* sql, fe_process_sql_statem
 {
   base::MutexLock parser_fe_critical_section(*_parser_fe_critical_section);
   reset();
-  Context context= {this, cb, user_data, 0, ignore_dml, is_ast_generation_enabled, max_insert_statement_size, processing_create_statements, processing_alter_statements, processing_drop_statements, sql_mode};
+  boost::scoped_ptr<base::TaskGroup> parse_tasks((parse_thread_count != 1) ? new base::TaskGroup(parse_thread_count) : NULL);
+  Context context= {this, cb, user_data, 0, ignore_dml, is_ast_generation_enabled, max_insert_statement_size, processing_create_statements, processing_alter_statements, processing_drop_statements, sql_mode, parse_tasks.get()};
   myx_process_sql_statements(sql, Lex_helper::charset(), &process_sql_statement_cb, &context, MYX_SPM_NORMAL_MODE);
+  flush_parsed_statements(&context);
   return context.err_count;
 }
 
@@ -377,8 +405,10 @@ int Mysql_sql_parser_fe::parse_sql_script_file(const std::string &filename, fe_p
 {
   base::MutexLock parser_fe_critical_section(*_parser_fe_critical_section);
   reset();
-  Context context= {this, cb, user_data, 0, ignore_dml, is_ast_generation_enabled, max_insert_statement_size, processing_create_statements, processing_alter_statements, processing_drop_statements, sql_mode};
+  boost::scoped_ptr<base::TaskGroup> parse_tasks((parse_thread_count != 1) ? new base::TaskGroup(parse_thread_count) : NULL);
+  Context context= {this, cb, user_data, 0, ignore_dml, is_ast_generation_enabled, max_insert_statement_size, processing_create_statements, processing_alter_statements, processing_drop_statements, sql_mode, parse_tasks.get()};
   myx_process_sql_statements_from_file(filename.c_str(), Lex_helper::charset(), &process_sql_statement_cb, &context, MYX_SPM_NORMAL_MODE/*MYX_SPM_DELIMS_REQUIRED*/);
+  flush_parsed_statements(&context);
   return context.err_count;
 }
 
@@ -399,79 +429,28 @@ int Mysql_sql_parser_fe::escape_string(char *out, unsigned long out_size, const
 }
 
 
-int Mysql_sql_parser_fe::process_sql_statement_cb(const MyxStatementParser *splitter, const char *statement, void *context_ptr)
+// Passes the parse results of a statement to the callback, extending them with position info.
+static int report_statement(Context *context, const MyxStatementParser *splitter, const char *statement, Lex_helper &lex_helper,
+  const SqlAstNode *tree, std::string err_msg)
 {
-  // possible values for result:
-  // -1 - statement was ignored
-  // 0 - statement was successfully processed
-  // 1 - error occurred during statement processing
-  int result= 0;
-
-  if (::parser_is_stopped)
-    return -1;
-
-  Context *context= reinterpret_cast <Context *> (context_ptr);
-
-  if (!context || !context->cb)
-    return -1;
-
-  // check if statement is in utf8 encoding
-  if (!g_utf8_validate(statement, -1, NULL))
-  {
-    int stmt_lc= 1;
-    {
-      const char *c= statement - 1;
-      while (c)
-      {
-        if (base::EolHelpers::is_eol(++c))
-          ++stmt_lc;
-        else
-          c= NULL;
-      }
-    }
-    std::string err_msg= "SQL statement starting from pointed line contains non UTF8 characters";
-    context->cb(context->data, splitter, statement, NULL, 0, 0, stmt_lc, 0, stmt_lc, 0, 0, err_msg);
-    context->err_count++;
-    return 1;
-  }
-
-  // stripe comments before further statement processing because
-  // mysqldump puts the whole DDL in comments e.g. for triggers
-  std::string orig_sql(statement);
-  std::string effective_sql;
-  bool ignore_statement= false;
-  int first_versioning_comment_pos;
-  remove_versioning_comments(orig_sql, effective_sql, Lex_helper::charset(), &ignore_statement, &first_versioning_comment_pos);
-  const std::string &sql= effective_sql.empty() ? orig_sql : effective_sql;
-
-  // filter inappropriate statements
-  if (ignore_statement || !is_statement_relevant(sql.c_str(), context))
-    return -1; // ignored
-
-  // parse/generate AST
-  LEX_HELPER(sql.c_str(), context->sql_mode, context->is_ast_generation_enabled)
-  myx_parse();
-  const SqlAstNode *tree= SqlAstStatics::tree();
-
   // in case of syntax error extend err message with context
-  std::string err_msg= myx_get_err_msg();
   int err_tok_line_pos= 0;
   int err_tok_len= 0;
-  int err_tok_lineno= _lex_helper.lex()->yylineno;
+  int err_tok_lineno= lex_helper.lex()->yylineno;
   if (!tree)
   {
     if (err_msg.empty())
     {
-      if (!_lex_helper.lex()->last_item || (_lex_helper.lex()->first_item->value_length() == -1))
+      if (!lex_helper.lex()->last_item || (lex_helper.lex()->first_item->value_length() == -1))
       {
         // empty statement
-        return result;
+        return 0;
       }
     }
     else if ("syntax error" == err_msg)
     {
       // Simple style error messages.
-      if (const SqlAstNode *item= _lex_helper.lex()->last_item)
+      if (const SqlAstNode *item= lex_helper.lex()->last_item)
       {
         static const size_t MAX_SQL_CONTEXT_SIZE= 80;
         std::string statement_= statement;
@@ -484,30 +463,30 @@ int Mysql_sql_parser_fe::process_sql_statement_cb(const MyxStatementParser *spli
           .append(err_context)
           .append("'");
 
-        determine_token_position(item, splitter, statement, err_tok_lineno, err_tok_line_pos, err_tok_len);
+        Mysql_sql_parser_fe::determine_token_position(item, splitter, statement, err_tok_lineno, err_tok_line_pos, err_tok_len);
       }
     }
     else
     {
       // General error message style.
-      if (const SqlAstNode *item= _lex_helper.lex()->last_item)
-        determine_token_position(item, splitter, statement, err_tok_lineno, err_tok_line_pos, err_tok_len);
+      if (const SqlAstNode *item= lex_helper.lex()->last_item)
+        Mysql_sql_parser_fe::determine_token_position(item, splitter, statement, err_tok_lineno, err_tok_line_pos, err_tok_len);
     }
   }
 
   int stmt_begin_lineno= -1;
   int stmt_begin_line_pos= -1;
-  if (const SqlAstNode *first_item= _lex_helper.lex()->first_item)
+  if (const SqlAstNode *first_item= lex_helper.lex()->first_item)
   {
     stmt_begin_lineno= first_item->stmt_lineno();
     stmt_begin_line_pos= 0;
     int tok_len= 0;
-    determine_token_position(first_item, splitter, statement, stmt_begin_lineno, stmt_begin_line_pos, tok_len);
+    Mysql_sql_parser_fe::determine_token_position(first_item, splitter, statement, stmt_begin_lineno, stmt_begin_line_pos, tok_len);
   }
 
   int stmt_end_lineno= -1;
   int stmt_end_line_pos= -1;
-  if (const SqlAstNode *last_item= _lex_helper.lex()->last_item)
+  if (const SqlAstNode *last_item= lex_helper.lex()->last_item)
   {
     stmt_end_lineno= last_item->stmt_lineno();
     stmt_end_line_pos= 0;
@@ -515,7 +494,7 @@ int Mysql_sql_parser_fe::process_sql_statement_cb(const MyxStatementParser *spli
     bool is_tok_multiline= false;
     int alt_stmt_end_line_pos= 0;
 
-    determine_token_position(last_item, splitter, statement, stmt_end_lineno, stmt_end_line_pos, tok_len);
+    Mysql_sql_parser_fe::determine_token_position(last_item, splitter, statement, stmt_end_lineno, stmt_end_line_pos, tok_len);
 
     for (const char *c= (statement + last_item->stmt_boffset()), *end= (statement + last_item->stmt_boffset() + tok_len); c < end; ++c)
     {
@@ -550,8 +529,8 @@ int Mysql_sql_parser_fe::process_sql_statement_cb(const MyxStatementParser *spli
   }
 
   // call callback function to process generated AST or syntax error
-  result= context->cb(context->data, splitter,
-    orig_sql.c_str(),
+  int result= context->cb(context->data, splitter,
+    statement,
     tree,
     stmt_begin_lineno, stmt_begin_line_pos, stmt_end_lineno, stmt_end_line_pos,
     err_tok_lineno, err_tok_line_pos, err_tok_len, err_msg);
@@ -565,6 +544,112 @@ int Mysql_sql_parser_fe::process_sql_statement_cb(const MyxStatementParser *spli
 }
 
 
+
+
+// Worker thread part of the parallel processing: creates the AST of the statement.
+static void parse_statement(Parsed_statement *statement, const Context *context)
+{
+  if (::parser_is_stopped)
+    return;
+
+  const std::string &sql= statement->sql.empty() ? statement->orig_sql : statement->sql;
+  statement->lex_helper.reset(new Lex_helper(sql.c_str(), context->sql_mode, context->is_ast_generation_enabled));
+  myx_parse();
+  statement->tree= SqlAstStatics::tree();
+  statement->err_msg= myx_get_err_msg();
+
+  // the AST is used on the calling thread from now on
+  statement->lex_helper->context().leave();
+}
+
+
+// Waits for the queued statements to be parsed and hands them over to the callback in script order.
+static void flush_parsed_statements(Context *context)
+{
+  if (!context->parse_tasks || context->parsed_statements.empty())
+    return;
+
+  context->parse_tasks->wait();
+  for (size_t i= 0; i < context->parsed_statements.size() && !::parser_is_stopped; ++i)
+  {
+    Parsed_statement *statement= context->parsed_statements[i].get();
+    if (statement->lex_helper)
+      report_statement(context, &statement->splitter, statement->orig_sql.c_str(), *statement->lex_helper, statement->tree, statement->err_msg);
+  }
+  context->parsed_statements.clear();
+}
+
+
+int Mysql_sql_parser_fe::process_sql_statement_cb(const MyxStatementParser *splitter, const char *statement, void *context_ptr)
+{
+  // possible values for result:
+  // -1 - statement was ignored
+  // 0 - statement was successfully processed
+  // 1 - error occurred during statement processing
+  if (::parser_is_stopped)
+    return -1;
+
+  Context *context= reinterpret_cast <Context *> (context_ptr);
+
+  if (!context || !context->cb)
+    return -1;
+
+  // check if statement is in utf8 encoding
+  if (!g_utf8_validate(statement, -1, NULL))
+  {
+    // statements queued for parsing come first
+    flush_parsed_statements(context);
+    if (::parser_is_stopped)
+      return -1;
+
+    int stmt_lc= 1;
+    {
+      const char *c= statement - 1;
+      while (c)
+      {
+        if (base::EolHelpers::is_eol(++c))
+          ++stmt_lc;
+        else
+          c= NULL;
+      }
+    }
+    std::string err_msg= "SQL statement starting from pointed line contains non UTF8 characters";
+    context->cb(context->data, splitter, statement, NULL, 0, 0, stmt_lc, 0, stmt_lc, 0, 0, err_msg);
+    context->err_count++;
+    return 1;
+  }
+
+  // stripe comments before further statement processing because
+  // mysqldump puts the whole DDL in comments e.g. for triggers
+  std::string orig_sql(statement);
+  std::string effective_sql;
+  bool ignore_statement= false;
+  int first_versioning_comment_pos;
+  remove_versioning_comments(orig_sql, effective_sql, Lex_helper::charset(), &ignore_statement, &first_versioning_comment_pos);
+  const std::string &sql= effective_sql.empty() ? orig_sql : effective_sql;
+
+  // filter inappropriate statements
+  if (ignore_statement || !is_statement_relevant(sql.c_str(), context))
+    return -1; // ignored
+
+  if (context->parse_tasks)
+  {
+    // parse on a worker thread, the callback is called when a batch of statements is complete
+    boost::shared_ptr<Parsed_statement> parsed_statement(new Parsed_statement(splitter, statement, effective_sql));
+    context->parsed_statements.push_back(parsed_statement);
+    context->parse_tasks->run(boost::bind(&parse_statement, parsed_statement.get(), context));
+    if (context->parsed_statements.size() >= (size_t)context->parse_tasks->thread_count() * PARSE_BATCH_SIZE_PER_THREAD)
+      flush_parsed_statements(context);
+    return 0;
+  }
+
+  // parse/generate AST
+  LEX_HELPER(sql.c_str(), context->sql_mode, context->is_ast_generation_enabled)
+  myx_parse();
+  return report_statement(context, splitter, statement, _lex_helper, SqlAstStatics::tree(), myx_get_err_msg());
+}
+
+
 void Mysql_sql_parser_fe::determine_token_position(const SqlAstNode *item, const MyxStatementParser *splitter, const char *statement, int &lineno, int &token_line_pos, int &token_len)
 {
   lineno= item->stmt_lineno();
@@ -86,6 +86,9 @@ private:
 
 public:
   int max_err_count;
+  // Statements of a script are parsed on this many threads (-1: one per CPU core), the callback is still
+  // called for one statement after another in script order. 1 (the default) parses on the calling thread only.
+  int parse_thread_count;
 };
 
 
@@ -25,6 +25,7 @@
 #include "testgrt.h"
 #include "grtsqlparser/sql_facade.h"
 #include "wb_helpers.h"
+#include "mysql_sql_inserts_loader.h"
 
 BEGIN_TEST_DATA_CLASS(mysql_sql_facade)
 public:
@@ -224,4 +225,49 @@ TEST_FUNCTION(11)
   ensure_equals("Unexpected Column Count", columns.size(), 0U);
 }
 
+static void collect_insert_row(const std::string &sql, const std::pair<std::string, std::string> &schema_table,
+  const Sql_inserts_loader::Strings &fields_names, const Sql_inserts_loader::Strings &fields_values,
+  const std::vector<bool> &null_fields, std::vector<std::string> *rows)
+{
+  std::string row= schema_table.first + "." + schema_table.second + ":";
+  for (size_t i= 0; i < fields_values.size(); ++i)
+  {
+    row+= " " + (i < fields_names.size() ? fields_names[i] : "?") + "=";
+    row+= null_fields[i] ? "<NULL>" : "[" + fields_values[i] + "]";
+  }
+  rows->push_back(row);
+}
+
+// The inserts loader must report the same rows with and without its fast path for INSERT ... VALUES.
+TEST_FUNCTION(15)
+{
+  std::string script=
+    "-- dump\n"
+    "LOCK TABLES `t1` WRITE;\n"
+    "/*!40000 ALTER TABLE `t1` DISABLE KEYS */;\n"
+    "INSERT INTO `t1` (`id`, name, `value`) VALUES (1, 'it''s', NULL), (2, 'a\\'b;c' , now()), (3, -5, 1.5);\n"
+    "insert ignore into other.t1 (id) values (4);\n"
+    "INSERT INTO t1 VALUES (5);\n"
+    "INSERT INTO t1 (id) VALUES (6) ON DUPLICATE KEY UPDATE id = 7;\n"
+    "INSERT INTO t1 (id, name) VALUES (8, /* comment */ 'x');\n"
+    "INSERT INTO t1 (id, value) VALUES (10, (1 + 2) * 3), ( 11 , \"dq\" ), (12, `id`);\n"
+    "INSERT INTO t1 (id, name) VALUES (13, \\N), (14, '\\\\func x'), (15, 0x1F);\n"
+    "UNLOCK TABLES;\n"
+    "INSERT INTO t1 (id, name) VALUES (16, 'no delimiter')";
+
+  std::vector<std::string> rows[2];
+  for (int i= 0; i < 2; ++i)
+  {
+    Mysql_sql_inserts_loader::Ref loader= Mysql_sql_inserts_loader::create(wbt.grt);
+    loader->use_fast_path(i == 1);
+    loader->process_insert_cb(boost::bind(collect_insert_row, _1, _2, _3, _4, _5, &rows[i]));
+    loader->load(script, "test");
+  }
+
+  ensure_equals("Row count", rows[1].size(), rows[0].size());
+  ensure("Rows loaded", rows[0].size() >= 12);
+  for (size_t i= 0; i < rows[0].size(); ++i)
+    ensure_equals(base::strfmt("Row %i", (int)i), rows[1][i], rows[0][i]);
+}
+
 END_TESTS
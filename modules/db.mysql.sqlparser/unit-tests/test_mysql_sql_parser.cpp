@@ -200,4 +200,28 @@ TEST_FUNCTION(90)
   test_import_sql(900, "test", "new_schema_name");
 }
 
+// Parsing statements on several threads must give the same catalog as parsing them one by one.
+TEST_FUNCTION(95)
+{
+  GRT* grt = rdbms.get_grt();
+  db_mysql_CatalogRef catalogs[2];
+  int thread_counts[2] = { 1, 4 };
+  for (int i = 0; i < 2; ++i)
+  {
+    catalogs[i] = db_mysql_CatalogRef(grt);
+    catalogs[i]->version(rdbms->version());
+    catalogs[i]->defaultCharacterSetName("utf8");
+    catalogs[i]->defaultCollationName("utf8_general_ci");
+    grt::replace_contents(catalogs[i]->simpleDatatypes(), rdbms->simpleDatatypes());
+
+    DictRef thread_options = DictRef(grt);
+    thread_options.set("gen_fk_names_when_empty", IntegerRef(0));
+    thread_options.set("parse_thread_count", IntegerRef(thread_counts[i]));
+    sql_facade->parseSqlScriptFileEx(catalogs[i], "data/modules_grt/wb_mysql_import/sql/702.sql", thread_options);
+  }
+
+  ensure("Objects created", catalogs[0]->schemata().count() > 0);
+  grt_ensure_equals("Parallel parsing", catalogs[1], catalogs[0]);
+}
+
 END_TESTS
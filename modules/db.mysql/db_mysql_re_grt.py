@@ -21,6 +21,7 @@ import grt
 from workbench.db_utils import MySQLConnection, escape_sql_string, escape_sql_identifier
 
 from workbench.exceptions import NotConnectedError
+from workbench.utils import find_object_with_name
 
 ModuleInfo = DefineModule(name= "DbMySQLRE", author= "Oracle Corp.", version="1.0")
 
@@ -206,6 +207,384 @@ def getServerMode(connection):
     return None
 
 
+#########  Reverse Engineering from information_schema #########
+
+# Engines whose tables are fully described by information_schema. Tables of other engines (e.g. MERGE
+# or FEDERATED) have options which are only available from SHOW CREATE TABLE.
+_information_schema_engines = set(["innodb", "myisam", "memory", "archive", "csv", "blackhole"])
+
+# Table options listed in information_schema.TABLES.CREATE_OPTIONS, mapped to the table members.
+_string_table_options = {"row_format" : "rowFormat", "max_rows" : "maxRows", "min_rows" : "minRows",
+                         "avg_row_length" : "avgRowLength", "pack_keys" : "packKeys", "key_block_size" : "keyBlockSize",
+                         "stats_persistent" : "statsPersistent", "stats_auto_recalc" : "statsAutoRecalc"}
+_int_table_options = {"checksum" : "checksum", "delay_key_write" : "delayKeyWrite", "stats_sample_pages" : "statsSamplePages"}
+
+
+def fetch_rows(connection, query, column_count):
+    """Returns all rows of the query as lists of strings, with None for NULL values."""
+    rows = []
+    result = execute_query(connection, query)
+    while result and result.nextRow():
+        rows.append([result.stringByIndex(i) for i in range(1, column_count + 1)])
+    check_interruption()
+    return rows
+
+
+def charset_and_collation(collation, collations):
+    """Returns the character set of the collation and the collation itself, which is left empty if it
+    is the default collation of its character set (that's how the parser stores it)."""
+    charset, is_default = collations.get(collation.lower(), ("", False))
+    return charset, "" if is_default else collation.lower()
+
+
+def fill_table_options(table, create_options):
+    """Sets the table options from a CREATE_OPTIONS value. Returns False if there are options
+    (like partitioning) which can only be taken from the table DDL."""
+    for option in (create_options or "").split():
+        key, sep, value = option.partition("=")
+        key = key.lower()
+        if key in _string_table_options:
+            setattr(table, _string_table_options[key], value)
+        elif key in _int_table_options:
+            setattr(table, _int_table_options[key], int(value))
+        else:
+            return False
+    return True
+
+
+def fill_column(catalog, column, row, table_collation, collations):
+    """Sets the column details from an information_schema.COLUMNS row. Returns False if the column
+    uses features (like generated values) which can only be taken from the table DDL."""
+    column_type, nullable, default, extra, collation, comment = row
+
+    flags = []
+    for flag in ("zerofill", "unsigned"):
+        if column_type.endswith(" " + flag):
+            column_type = column_type[:-len(flag) - 1]
+            flags.insert(0, flag.upper())
+    if not column.setParseType(column_type, catalog.simpleDatatypes):
+        return False
+    for flag in flags:
+        column.flags.append(flag)
+
+    column.isNotNull = 1 if nullable == "NO" else 0
+
+    extra = (extra or "").lower()
+    on_update = ""
+    if "on update " in extra:
+        extra, on_update = extra.split("on update ", 1)
+        on_update = "ON UPDATE " + on_update.strip().upper()
+    extra = extra.strip()
+    if extra == "auto_increment":
+        column.autoIncrement = 1
+    elif extra == "default_generated" and default and default.upper().startswith("CURRENT_TIMESTAMP"):
+        pass
+    elif extra:
+        return False
+
+    # Store the default value as the parser does: strings quoted, DEFAULT NOW and ON UPDATE NOW combined.
+    if default is None:
+        value = "NULL" if not column.isNotNull else ""
+    elif default.upper().startswith("CURRENT_TIMESTAMP"):
+        value = default.upper()
+    elif column_type.startswith("bit") and default.startswith("b'"):
+        value = default
+    else:
+        value = "'%s'" % escape_sql_string(default)
+    if on_update:
+        value = value + " " + on_update if value.startswith("CURRENT_TIMESTAMP") else on_update
+    if value:
+        column.defaultValue = value
+        column.defaultValueIsNull = 1 if value == "NULL" else 0
+
+    # As in SHOW CREATE TABLE output, the charset is only set when it differs from the table's.
+    if collation and collation.lower() != table_collation:
+        column.characterSetName, column.collationName = charset_and_collation(collation, collations)
+
+    column.comment = comment or ""
+    return True
+
+
+def find_fk_index(table, fk):
+    """Returns the first index starting with the columns of the foreign key, creating one if there's none."""
+    for index in table.indices:
+        if len(index.columns) >= len(fk.columns) and all(index.columns[i].referencedColumn == column for i, column in enumerate(fk.columns)):
+            if not index.indexType:
+                index.indexType = "INDEX"
+            return index
+
+    index = grt.classes.db_mysql_Index()
+    index.owner = table
+    index.name = fk.name
+    index.oldName = fk.name
+    index.indexType = "INDEX"
+    for column in fk.columns:
+        index_column = grt.classes.db_mysql_IndexColumn()
+        index_column.owner = index
+        index_column.referencedColumn = column
+        index.columns.append(index_column)
+    table.indices.append(index)
+    return index
+
+
+def reverseEngineerFromInformationSchema(connection, catalog, schemata_list, table_names_per_schema, trigger_names_per_schema):
+    """Creates the given tables (with columns, indices, foreign keys) and triggers in the catalog from
+    a few queries over all schemas in information_schema, instead of fetching and parsing the DDL of
+    each object.
+
+    Objects which can't be fully described that way (views, partitioned tables, tables with generated
+    columns etc. and their triggers) are left out. Returns the table and trigger names per schema which
+    still must be reverse engineered from their DDL. Foreign keys referencing such tables point to stub
+    tables, which get replaced when the real table is merged in.
+    """
+    schema_list = ", ".join("'%s'" % escape_sql_string(name) for name in schemata_list)
+
+    collations = {}
+    for name, charset, is_default in fetch_rows(connection, "SELECT COLLATION_NAME, CHARACTER_SET_NAME, IS_DEFAULT FROM information_schema.COLLATIONS", 3):
+        collations[name.lower()] = (charset.lower(), is_default == "Yes")
+
+    schemas = {}
+    for schema_name in schemata_list:
+        schema = find_object_with_name(catalog.schemata, schema_name)
+        if not schema:
+            schema = grt.classes.db_mysql_Schema()
+            schema.owner = catalog
+            schema.name = schema_name
+            schema.oldName = schema_name
+            catalog.schemata.append(schema)
+        schemas[schema_name] = schema
+
+    requested = set((schema_name, name) for schema_name in schemata_list for name in table_names_per_schema[schema_name])
+    tables = {}
+    table_collations = {}
+
+    grt.send_progress(0.0, "Retrieving tables from information_schema...")
+    for schema_name, name, table_type, engine, auto_increment, collation, create_options, comment in fetch_rows(connection,
+            "SELECT TABLE_SCHEMA, TABLE_NAME, TABLE_TYPE, ENGINE, AUTO_INCREMENT, TABLE_COLLATION, CREATE_OPTIONS, TABLE_COMMENT "
+            "FROM information_schema.TABLES WHERE TABLE_SCHEMA IN (%s)" % schema_list, 8):
+        key = (schema_name, name)
+        if key not in requested:
+            continue
+        if table_type != "BASE TABLE" or not engine or engine.lower() not in _information_schema_engines:
+            continue
+
+        table = grt.classes.db_mysql_Table()
+        table.owner = schemas[schema_name]
+        table.name = name
+        table.oldName = name
+        table.tableEngine = engine
+        if auto_increment and int(auto_increment) > 1:
+            table.nextAutoInc = auto_increment
+        if collation:
+            table.defaultCharacterSetName, table.defaultCollationName = charset_and_collation(collation, collations)
+        table.comment = comment or ""
+        if not fill_table_options(table, create_options):
+            continue
+        tables[key] = table
+        table_collations[key] = (collation or "").lower()
+
+    grt.send_progress(0.2, "Retrieving columns from information_schema...")
+    for row in fetch_rows(connection,
+            "SELECT TABLE_SCHEMA, TABLE_NAME, COLUMN_NAME, COLUMN_TYPE, IS_NULLABLE, COLUMN_DEFAULT, EXTRA, COLLATION_NAME, COLUMN_COMMENT "
+            "FROM information_schema.COLUMNS WHERE TABLE_SCHEMA IN (%s) ORDER BY TABLE_SCHEMA, TABLE_NAME, ORDINAL_POSITION" % schema_list, 9):
+        key = (row[0], row[1])
+        table = tables.get(key)
+        if not table:
+            continue
+        column = grt.classes.db_mysql_Column()
+        column.owner = table
+        column.name = row[2]
+        column.oldName = row[2]
+        if not fill_column(catalog, column, row[3:], table_collations[key], collations):
+            del tables[key]
+            continue
+        table.columns.append(column)
+
+    # Index rows come in index order, but the columns of an index not necessarily in sequence.
+    grt.send_progress(0.4, "Retrieving indices from information_schema...")
+    indices = {}
+    index_order = []
+    for schema_name, table_name, index_name, non_unique, sequence, column_name, sub_part, collation, index_type, comment in fetch_rows(connection,
+            "SELECT TABLE_SCHEMA, TABLE_NAME, INDEX_NAME, NON_UNIQUE, SEQ_IN_INDEX, COLUMN_NAME, SUB_PART, COLLATION, INDEX_TYPE, INDEX_COMMENT "
+            "FROM information_schema.STATISTICS WHERE TABLE_SCHEMA IN (%s)" % schema_list, 10):
+        key = (schema_name, table_name)
+        if key not in tables:
+            continue
+        index_key = (schema_name, table_name, index_name)
+        if index_key not in indices:
+            index_order.append(index_key)
+            indices[index_key] = (non_unique, index_type, comment, [])
+        indices[index_key][3].append((int(sequence), column_name, sub_part, collation))
+
+    for index_key in index_order:
+        key = index_key[:2]
+        table = tables.get(key)
+        if not table:
+            continue
+        non_unique, index_type, comment, index_columns = indices[index_key]
+
+        index = grt.classes.db_mysql_Index()
+        index.owner = table
+        index.name = index_key[2]
+        index.oldName = index_key[2]
+        if index.name == "PRIMARY":
+            index.isPrimary = 1
+            index.indexType = "PRIMARY"
+            table.primaryKey = index
+        elif non_unique == "0":
+            index.unique = 1
+            index.indexType = "UNIQUE"
+        elif index_type in ("FULLTEXT", "SPATIAL"):
+            index.indexType = index_type
+        else:
+            index.indexType = "INDEX"
+        index.comment = comment or ""
+
+        for sequence, column_name, sub_part, collation in sorted(index_columns):
+            column = find_object_with_name(table.columns, column_name) if column_name else None
+            if not column:
+                # Functional key parts have no column and need the DDL.
+                break
+            index_column = grt.classes.db_mysql_IndexColumn()
+            index_column.owner = index
+            index_column.referencedColumn = column
+            if sub_part:
+                index_column.columnLength = int(sub_part)
+            index_column.descend = 1 if collation == "D" else 0
+            index.columns.append(index_column)
+        else:
+            table.indices.append(index)
+            continue
+        del tables[key]
+
+    grt.send_progress(0.6, "Retrieving foreign keys from information_schema...")
+    foreign_keys = {}
+    fk_order = []
+    for row in fetch_rows(connection,
+            "SELECT k.TABLE_SCHEMA, k.TABLE_NAME, k.CONSTRAINT_NAME, k.COLUMN_NAME, k.REFERENCED_TABLE_SCHEMA, k.REFERENCED_TABLE_NAME, "
+            "k.REFERENCED_COLUMN_NAME, r.UPDATE_RULE, r.DELETE_RULE FROM information_schema.KEY_COLUMN_USAGE k "
+            "JOIN information_schema.REFERENTIAL_CONSTRAINTS r ON r.CONSTRAINT_SCHEMA = k.CONSTRAINT_SCHEMA "
+            "AND r.TABLE_NAME = k.TABLE_NAME AND r.CONSTRAINT_NAME = k.CONSTRAINT_NAME "
+            "WHERE k.TABLE_SCHEMA IN (%s) AND k.REFERENCED_TABLE_NAME IS NOT NULL "
+            "ORDER BY k.TABLE_SCHEMA, k.TABLE_NAME, k.CONSTRAINT_NAME, k.ORDINAL_POSITION" % schema_list, 9):
+        fk_key = tuple(row[:3])
+        if fk_key not in foreign_keys:
+            fk_order.append(fk_key)
+            foreign_keys[fk_key] = (row[4], row[5], row[7], row[8], [])
+        foreign_keys[fk_key][4].append((row[3], row[6]))
+
+    # Tables are added to their schemas before foreign keys are resolved, so that any stub tables
+    # for references to other tables come after them, as with the parser.
+    for schema_name in schemata_list:
+        for name in table_names_per_schema[schema_name]:
+            table = tables.get((schema_name, name))
+            if table:
+                schemas[schema_name].tables.append(table)
+
+    stubs = {}
+    for fk_key in fk_order:
+        table = tables.get(fk_key[:2])
+        if not table:
+            continue
+        referenced_schema, referenced_name, update_rule, delete_rule, column_pairs = foreign_keys[fk_key]
+
+        fk = grt.classes.db_mysql_ForeignKey()
+        fk.owner = table
+        fk.name = fk_key[2]
+        fk.oldName = fk_key[2]
+        # InnoDB doesn't list RESTRICT rules in the DDL, so they are not set by the parser either.
+        if update_rule != "RESTRICT":
+            fk.updateRule = update_rule
+        if delete_rule != "RESTRICT":
+            fk.deleteRule = delete_rule
+        for column_name, referenced_column_name in column_pairs:
+            fk.columns.append(find_object_with_name(table.columns, column_name))
+
+        referenced = tables.get((referenced_schema, referenced_name)) or stubs.get((referenced_schema, referenced_name))
+        if not referenced:
+            schema = schemas.get(referenced_schema) or find_object_with_name(catalog.schemata, referenced_schema)
+            if not schema:
+                schema = grt.classes.db_mysql_Schema()
+                schema.owner = catalog
+                schema.name = referenced_schema
+                schema.oldName = referenced_schema
+                catalog.schemata.append(schema)
+                schemas[referenced_schema] = schema
+            referenced = grt.classes.db_mysql_Table()
+            referenced.owner = schema
+            referenced.isStub = 1
+            referenced.name = referenced_name
+            referenced.oldName = referenced_name
+            referenced.tableEngine = table.tableEngine
+            schema.tables.append(referenced)
+            stubs[(referenced_schema, referenced_name)] = referenced
+        fk.referencedTable = referenced
+
+        for i, (column_name, referenced_column_name) in enumerate(column_pairs):
+            column = None
+            for c in referenced.columns:
+                if c.name.lower() == referenced_column_name.lower():
+                    column = c
+                    break
+            if not column:
+                if not referenced.isStub:
+                    fk = None
+                    break
+                # Stub columns take the data type of the foreign key column.
+                template = fk.columns[i]
+                column = grt.classes.db_mysql_Column()
+                column.owner = referenced
+                column.name = referenced_column_name
+                column.oldName = referenced_column_name
+                for member in ("simpleType", "userType", "structuredType", "precision", "scale", "length",
+                               "datatypeExplicitParams", "characterSetName", "collationName"):
+                    setattr(column, member, getattr(template, member))
+                for flag in template.flags:
+                    column.flags.append(flag)
+                referenced.columns.append(column)
+            fk.referencedColumns.append(column)
+
+        if fk:
+            fk.index = find_fk_index(table, fk)
+            table.foreignKeys.append(fk)
+
+    grt.send_progress(0.8, "Retrieving triggers from information_schema...")
+    requested_triggers = set((schema_name, name) for schema_name in schemata_list for name in trigger_names_per_schema[schema_name])
+    triggers = set()
+    for schema_name, name, table_name, timing, event, statement, definer, order in fetch_rows(connection,
+            "SELECT TRIGGER_SCHEMA, TRIGGER_NAME, EVENT_OBJECT_TABLE, ACTION_TIMING, EVENT_MANIPULATION, ACTION_STATEMENT, DEFINER, ACTION_ORDER "
+            "FROM information_schema.TRIGGERS WHERE TRIGGER_SCHEMA IN (%s) ORDER BY TRIGGER_SCHEMA, EVENT_OBJECT_TABLE, ACTION_ORDER" % schema_list, 8):
+        if (schema_name, name) not in requested_triggers:
+            continue
+        table = tables.get((schema_name, table_name))
+        # FOLLOWS/PRECEDES clauses are only kept in the trigger DDL.
+        if not table or int(order or 0) > 1:
+            continue
+
+        user, sep, host = definer.rpartition("@")
+        trigger = grt.classes.db_mysql_Trigger()
+        trigger.owner = table
+        trigger.name = name
+        trigger.oldName = name
+        trigger.enabled = 1
+        trigger.timing = timing
+        trigger.event = event
+        trigger.definer = "`%s`@`%s`" % (escape_sql_identifier(user), escape_sql_identifier(host))
+        trigger.sqlDefinition = "CREATE DEFINER=%s TRIGGER `%s` %s %s ON `%s` FOR EACH ROW %s" % (trigger.definer,
+            escape_sql_identifier(name), timing, event, escape_sql_identifier(table_name), statement)
+        table.triggers.append(trigger)
+        triggers.add((schema_name, name))
+
+    # Whatever was not created here (including objects which disappeared in the meantime) goes the DDL way.
+    remaining_tables = {}
+    remaining_triggers = {}
+    for schema_name in schemata_list:
+        remaining_tables[schema_name] = [name for name in table_names_per_schema[schema_name] if (schema_name, name) not in tables]
+        remaining_triggers[schema_name] = [name for name in trigger_names_per_schema[schema_name] if (schema_name, name) not in triggers]
+    grt.send_info("Created %i tables and %i triggers from information_schema" % (len(tables), len(triggers)))
+    return remaining_tables, remaining_triggers
+
+
 #########  Reverse Engineering functions #########
 
 
@@ -234,6 +613,7 @@ def reverseEngineer(connection, catalog_name, schemata_list, context):
     get_triggers = context.get("reverseEngineerTriggers", True) and (version.majorNumber, version.minorNumber, version.releaseNumber) >= (5, 1, 21)
     get_views = context.get("reverseEngineerViews", True)
     get_routines = context.get("reverseEngineerRoutines", True)
+    use_information_schema = context.get("reverseEngineerUsingInformationSchema", False) and get_tables and (version.majorNumber, version.minorNumber, version.releaseNumber) >= (5, 5, 0)
     
     # calculate total workload 1st
     
@@ -275,90 +655,128 @@ def reverseEngineer(connection, catalog_name, schemata_list, context):
         grt.send_progress(0.1 * (i/len(schemata_list)), "Preparing...")
         i += 1.0
 
+    progress_start = 0.1
+    if use_information_schema:
+        # setParseType() needs the server version to pick the data types.
+        catalog.version = version
+        grt.push_message_handler(filter_warnings)
+        grt.begin_progress_step(0.1, 0.4)
+        try:
+            table_names_per_schema, trigger_names_per_schema = reverseEngineerFromInformationSchema(connection, catalog, schemata_list,
+                table_names_per_schema, trigger_names_per_schema)
+        finally:
+            grt.end_progress_step()
+            grt.pop_message_handler()
+        progress_start = 0.4
+
     def wrap_sql(sql, schema):
         return "USE `%s`;\n%s"%(escape_sql_identifier(schema), sql)
 
     def wrap_routine_sql(sql):
         return "DELIMITER $$\n"+sql
 
-    i = 0.0
-    for schema_name in schemata_list:
-        schema = grt.classes.db_mysql_Schema()
-        schema.owner = catalog
-        schema.name = schema_name
-        catalog.schemata.append(schema)
-        context = grt.modules.MySQLParserServices.createParserContext(catalog.characterSets, getServerVersion(connection), getServerMode(connection), 1)
-        options = {}
-
-        if get_tables or get_views:
-            grt.send_info("Reverse engineering tables from %s" % schema_name)
-            for table_name in table_names_per_schema[schema_name]:
-                check_interruption()
-                grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving table %s.%s..." % (schema_name, table_name))
-                result = execute_query(connection, "SHOW CREATE TABLE `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(table_name)))
-                i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, table_name))
-                if result and result.nextRow():
-                    sql = result.stringByIndex(2)
-                    grt.push_message_handler(filter_warnings)
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(sql, schema_name), options)
-                    grt.end_progress_step()
-                    grt.pop_message_handler()
+    connection_count = context.get("reverseEngineerConnections", 0)
+    if connection_count != 1 or use_information_schema:
+        # Fetch and parse the DDL over several connections at once (see ParallelReverseEngineer in the DbMySQL module).
+        # This also merges the parsed objects with those already created from information_schema.
+        objects = {}
+        for schema_name in schemata_list:
+            procedure_names, function_names = routine_names_per_schema[schema_name]
+            objects[schema_name] = {"tables" : table_names_per_schema[schema_name] if get_tables or get_views else [],
+                                    "triggers" : trigger_names_per_schema[schema_name],
+                                    "procedures" : procedure_names,
+                                    "functions" : function_names}
+        options = {"serverVersion" : version, "sqlMode" : getServerMode(connection), "connections" : connection_count}
+        password = get_connection(connection).password
+        if password is not None:
+            options["password"] = password
+
+        grt.push_message_handler(filter_warnings)
+        grt.begin_progress_step(progress_start, 1.0)
+        try:
+            grt.modules.DbMySQL.reverseEngineerObjects(connection, catalog, schemata_list, objects, options)
+        finally:
+            grt.end_progress_step()
+            grt.pop_message_handler()
+    else:
+        i = 0.0
+        for schema_name in schemata_list:
+            schema = grt.classes.db_mysql_Schema()
+            schema.owner = catalog
+            schema.name = schema_name
+            catalog.schemata.append(schema)
+            context = grt.modules.MySQLParserServices.createParserContext(catalog.characterSets, getServerVersion(connection), getServerMode(connection), 1)
+            options = {}
+
+            if get_tables or get_views:
+                grt.send_info("Reverse engineering tables from %s" % schema_name)
+                for table_name in table_names_per_schema[schema_name]:
+                    check_interruption()
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving table %s.%s..." % (schema_name, table_name))
+                    result = execute_query(connection, "SHOW CREATE TABLE `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(table_name)))
                     i += 0.5
-                else:
-                    raise Exception("Could not fetch table information for %s.%s" % (schema_name, table_name))
-
-        if get_triggers:
-            grt.send_info("Reverse engineering triggers from %s" % schema_name)
-            for trigger_name in trigger_names_per_schema[schema_name]:
-                check_interruption()
-                grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving trigger %s.%s..." % (schema_name, trigger_name))
-                result = execute_query(connection, "SHOW CREATE TRIGGER `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(trigger_name)))
-                i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, trigger_name))
-                if result and result.nextRow():
-                    sql = result.stringByName("SQL Original Statement")
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
-                    grt.end_progress_step()
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, table_name))
+                    if result and result.nextRow():
+                        sql = result.stringByIndex(2)
+                        grt.push_message_handler(filter_warnings)
+                        grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
+                        grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(sql, schema_name), options)
+                        grt.end_progress_step()
+                        grt.pop_message_handler()
+                        i += 0.5
+                    else:
+                        raise Exception("Could not fetch table information for %s.%s" % (schema_name, table_name))
+
+            if get_triggers:
+                grt.send_info("Reverse engineering triggers from %s" % schema_name)
+                for trigger_name in trigger_names_per_schema[schema_name]:
+                    check_interruption()
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving trigger %s.%s..." % (schema_name, trigger_name))
+                    result = execute_query(connection, "SHOW CREATE TRIGGER `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(trigger_name)))
                     i += 0.5
-                else:
-                    raise Exception("Could not fetch trigger information for %s.%s" % (schema_name, trigger_name))
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, trigger_name))
+                    if result and result.nextRow():
+                        sql = result.stringByName("SQL Original Statement")
+                        grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
+                        grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
+                        grt.end_progress_step()
+                        i += 0.5
+                    else:
+                        raise Exception("Could not fetch trigger information for %s.%s" % (schema_name, trigger_name))
         
-        if get_routines:
-            grt.send_info("Reverse engineering stored procedures from %s" % schema_name)
-            procedure_names, function_names = routine_names_per_schema[schema_name]
-            for name in procedure_names:
-                check_interruption()
-                grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving stored procedure %s.%s..." % (schema_name, name))
-                result = execute_query(connection, "SHOW CREATE PROCEDURE `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(name)))
-                i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, name))
-                if result and result.nextRow():
-                    sql = result.stringByName("Create Procedure")
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
-                    grt.end_progress_step()
+            if get_routines:
+                grt.send_info("Reverse engineering stored procedures from %s" % schema_name)
+                procedure_names, function_names = routine_names_per_schema[schema_name]
+                for name in procedure_names:
+                    check_interruption()
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving stored procedure %s.%s..." % (schema_name, name))
+                    result = execute_query(connection, "SHOW CREATE PROCEDURE `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(name)))
                     i += 0.5
-                else:
-                    raise Exception("Could not fetch procedure information for %s.%s" % (schema_name, name))
-
-            grt.send_info("Reverse engineering functions from %s" % schema_name)
-            for name in function_names:
-                check_interruption()
-                grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving function %s.%s..." % (schema_name, name))
-                result = execute_query(connection, "SHOW CREATE FUNCTION `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(name)))
-                i += 0.5
-                grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, name))
-                if result and result.nextRow():
-                    sql = result.stringByName("Create Function")
-                    grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
-                    grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
-                    grt.end_progress_step()
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, name))
+                    if result and result.nextRow():
+                        sql = result.stringByName("Create Procedure")
+                        grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
+                        grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
+                        grt.end_progress_step()
+                        i += 0.5
+                    else:
+                        raise Exception("Could not fetch procedure information for %s.%s" % (schema_name, name))
+
+                grt.send_info("Reverse engineering functions from %s" % schema_name)
+                for name in function_names:
+                    check_interruption()
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Retrieving function %s.%s..." % (schema_name, name))
+                    result = execute_query(connection, "SHOW CREATE FUNCTION `%s`.`%s`" % (escape_sql_identifier(schema_name), escape_sql_identifier(name)))
                     i += 0.5
-                else:
-                    raise Exception("Could not fetch function information for %s.%s" % (schema_name, name))
+                    grt.send_progress(0.1 + 0.9 * (i / total), "Reverse engineering %s.%s..." % (schema_name, name))
+                    if result and result.nextRow():
+                        sql = result.stringByName("Create Function")
+                        grt.begin_progress_step(0.1 + 0.9 * (i / total), 0.1 + 0.9 * ((i+0.5) / total))
+                        grt.modules.MySQLParserServices.parseSQLIntoCatalogSql(context, catalog, wrap_sql(wrap_routine_sql(sql), schema_name), options)
+                        grt.end_progress_step()
+                        i += 0.5
+                    else:
+                        raise Exception("Could not fetch function information for %s.%s" % (schema_name, name))
 
     grt.send_progress(1.0, "Reverse engineered %i objects" % total)
     
@@ -31,9 +31,16 @@
 #include <algorithm>
 #include <ctype.h>
 
+#include <boost/bind.hpp>
+
 #include "module_db_mysql.h"
 #include "module_db_mysql_shared_code.h"
 
+#include "base/threading.h"
+
+// Number of tables whose statements are generated by a single job.
+#define DIFF_TABLES_PER_JOB 16
+
 void DiffSQLGeneratorBE::remember(const GrtNamedObjectRef &obj, const std::string &sql)
 {
   if(target_list.is_valid())
@@ -427,11 +434,11 @@ void DiffSQLGeneratorBE::generate_create_stmt(db_mysql_SchemaRef schema)
   callback->create_schema(schema);
 
   grt::ListRef<db_mysql_Table> tables= schema->tables();
+  std::vector<TableTask> table_tasks;
+  table_tasks.reserve(tables.count());
   for(size_t count= tables.count(), i= 0; i < count; i++)
-  {
-    db_mysql_TableRef table= tables.get(i);
-    generate_create_stmt(table);
-  }
+    table_tasks.push_back(TableTask(CreateTable, tables.get(i)));
+  generate_table_stmts(table_tasks);
 
   grt::ListRef<db_mysql_View> views= schema->views();
   for(size_t count= views.count(), i= 0; i < count; i++)
@@ -1423,41 +1430,44 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_SchemaRef schema, const gr
       const grt::ChangeSet *tables_cs= list_change->subchanges();
 
       // 1st pass, do everything except FKs
+      std::vector<TableTask> table_tasks;
       for(grt::ChangeSet::const_iterator e2= tables_cs->end(), jt= tables_cs->begin(); jt != e2; jt++)
       {
         const grt::DiffChange *table_change= jt->get();
         switch(table_change->get_change_type())
         {
         case grt::ListItemAdded:
-          generate_create_stmt(
-            db_mysql_TableRef::cast_from(static_cast<const grt::ListItemAddedChange *>(table_change)->get_value()));
+          table_tasks.push_back(TableTask(CreateTable,
+            db_mysql_TableRef::cast_from(static_cast<const grt::ListItemAddedChange *>(table_change)->get_value())));
           break;
         case grt::ListItemRemoved:
-          generate_drop_stmt(db_mysql_TableRef::cast_from(
-            static_cast<const grt::ListItemRemovedChange *>(table_change)->get_value()));
+          table_tasks.push_back(TableTask(DropTable, db_mysql_TableRef::cast_from(
+            static_cast<const grt::ListItemRemovedChange *>(table_change)->get_value())));
           break;
         case grt::ListItemModified:
-          generate_alter_stmt(db_mysql_TableRef::cast_from(
+          table_tasks.push_back(TableTask(AlterTable, db_mysql_TableRef::cast_from(
             static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
             static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get(),
-                              _separate_foreign_keys ? EverythingButForeignKeys : Everything); // everything but FK 1st
+                              _separate_foreign_keys ? EverythingButForeignKeys : Everything)); // everything but FK 1st
           break;
         case grt::ListItemOrderChanged:
           {
             const grt::ListItemOrderChange *oc= 
               static_cast<const grt::ListItemOrderChange *>(table_change);
             if(oc->get_subchange())
-              generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()), oc->get_subchange()->get_subchange().get(), _separate_foreign_keys ? EverythingButForeignKeys : Everything);
+              table_tasks.push_back(TableTask(AlterTable, db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()), oc->get_subchange()->get_subchange().get(), _separate_foreign_keys ? EverythingButForeignKeys : Everything));
           }
           break;
           default: 
             break;
         }
       }
+      generate_table_stmts(table_tasks);
 
       if (_separate_foreign_keys)
       {
         // 2nd pass, do FKs only
+        table_tasks.clear();
         for(grt::ChangeSet::const_iterator e2= tables_cs->end(), jt= tables_cs->begin(); jt != e2; jt++)
         {
           const grt::DiffChange *table_change= jt->get();
@@ -1467,23 +1477,24 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_SchemaRef schema, const gr
             case grt::ListItemRemoved:
               break;
             case grt::ListItemModified:
-              generate_alter_stmt(db_mysql_TableRef::cast_from(
+              table_tasks.push_back(TableTask(AlterTable, db_mysql_TableRef::cast_from(
                                   static_cast<const grt::ListItemModifiedChange *>(table_change)->get_new_value()),
                                   static_cast<const grt::ListItemModifiedChange *>(table_change)->get_subchange().get(),
-                                  OnlyForeignKeys); // FK only
+                                  OnlyForeignKeys)); // FK only
               break;
             case grt::ListItemOrderChanged:
             {
               const grt::ListItemOrderChange *oc=
               static_cast<const grt::ListItemOrderChange *>(table_change);
               if(oc->get_subchange())
-                generate_alter_stmt(db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()), oc->get_subchange()->get_subchange().get(), OnlyForeignKeys);
+                table_tasks.push_back(TableTask(AlterTable, db_mysql_TableRef::cast_from(oc->get_subchange()->get_new_value()), oc->get_subchange()->get_subchange().get(), OnlyForeignKeys));
             }
               break;
             default: 
               break;
           }
         }
+        generate_table_stmts(table_tasks);
       }
     }
     else if(attr_change->get_attr_name().compare("views") == 0)
@@ -1641,6 +1652,71 @@ void DiffSQLGeneratorBE::generate_alter_stmt(db_mysql_CatalogRef catalog, const
   }
 }
 
+void DiffSQLGeneratorBE::run_table_tasks(std::vector<TableTask>::const_iterator begin,
+  std::vector<TableTask>::const_iterator end)
+{
+  for (std::vector<TableTask>::const_iterator task= begin; task != end; ++task)
+  {
+    switch (task->type)
+    {
+    case CreateTable:
+      generate_create_stmt(task->table);
+      break;
+    case DropTable:
+      generate_drop_stmt(task->table);
+      break;
+    case AlterTable:
+      generate_alter_stmt(task->table, task->change, task->alter_table_flags);
+      break;
+    }
+  }
+}
+
+void DiffSQLGeneratorBE::generate_table_stmts(const std::vector<TableTask> &tasks)
+{
+  DiffSQLGeneratorBEActionInterface *first_copy= NULL;
+  if (_parallel_jobs && tasks.size() > DIFF_TABLES_PER_JOB)
+    first_copy= callback->create_job_copy();
+  if (first_copy == NULL)
+  {
+    run_table_tasks(tasks.begin(), tasks.end());
+    return;
+  }
+
+  // Each job works on a copy of this generator which uses its own call-back.
+  std::vector<DiffSQLGeneratorBE> jobs;
+  jobs.reserve((tasks.size() + DIFF_TABLES_PER_JOB - 1) / DIFF_TABLES_PER_JOB);
+  for (size_t i= 0; i < tasks.size(); i+= DIFF_TABLES_PER_JOB)
+  {
+    jobs.push_back(*this);
+    jobs.back().callback= jobs.size() == 1 ? first_copy : callback->create_job_copy();
+  }
+
+  try
+  {
+    base::TaskGroup group;
+    for (size_t i= 0; i < jobs.size(); i++)
+    {
+      std::vector<TableTask>::const_iterator begin= tasks.begin() + i * DIFF_TABLES_PER_JOB;
+      std::vector<TableTask>::const_iterator end= tasks.begin() + std::min((i + 1) * DIFF_TABLES_PER_JOB, tasks.size());
+      group.run(boost::bind(&DiffSQLGeneratorBE::run_table_tasks, &jobs[i], begin, end));
+    }
+    group.wait();
+  }
+  catch (...)
+  {
+    for (size_t i= 0; i < jobs.size(); i++)
+      delete jobs[i].callback;
+    throw;
+  }
+
+  for (size_t i= 0; i < jobs.size(); i++)
+  {
+    callback->append_job_output(jobs[i].callback);
+    delete jobs[i].callback;
+  }
+}
+
 static void fill_set_from_list(grt::StringListRef string_list, std::set<std::string>& string_set)
 {
   for(size_t count= string_list.count(), i= 0; i < count; i++)
@@ -1649,7 +1725,8 @@ static void fill_set_from_list(grt::StringListRef string_list, std::set<std::str
 
 DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtraits, DiffSQLGeneratorBEActionInterface *cb)
     : callback(cb), _gen_create_index(false), _use_filtered_lists(true),
-    _skip_foreign_keys(false), _skip_fk_indexes(false), _case_sensitive(false), _use_oid_as_dict_key(false), _separate_foreign_keys(true)
+    _skip_foreign_keys(false), _skip_fk_indexes(false), _case_sensitive(false), _use_oid_as_dict_key(false), _separate_foreign_keys(true),
+    _parallel_jobs(true)
 {
     if (!options.is_valid())
         return;
@@ -1662,6 +1739,7 @@ DiffSQLGeneratorBE::DiffSQLGeneratorBE(grt::DictRef options, grt::DictRef dbtrai
     _gen_create_index = (options.get_int("GenerateCreateIndex", _gen_create_index) != 0);
     _use_filtered_lists = options.get_int("UseFilteredLists", _use_filtered_lists)!= 0;
     _separate_foreign_keys = options.get_int("SeparateForeignKeys", _separate_foreign_keys)!= 0;
+    _parallel_jobs = options.get_int("UseParallelJobs", _parallel_jobs) != 0;
     cb->set_short_names(options.get_int("UseShortNames", 0) != 0);
     cb->set_gen_use(options.get_int("GenerateUse", 0) != 0);
     fill_set_from_list(grt::StringListRef::cast_from(options.get("UserFilterList", empty_list)), _filtered_users);
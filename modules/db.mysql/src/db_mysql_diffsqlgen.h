@@ -30,6 +30,7 @@
 #include "grts/structs.db.mysql.h"
 
 #include <set>
+#include <vector>
 
 namespace grt 
 {
@@ -80,6 +81,7 @@ class DiffSQLGeneratorBE
   bool _case_sensitive;
   bool _use_oid_as_dict_key;
   bool _separate_foreign_keys;
+  bool _parallel_jobs;
   std::set<std::string> _filtered_schemata, _filtered_tables, _filtered_views, _filtered_routines, _filtered_triggers, _filtered_users;
 
   // to be removed
@@ -195,6 +197,30 @@ class DiffSQLGeneratorBE
 
   void process_trigger_alter_stmts(db_mysql_TableRef table, const grt::DiffChange *triggers_cs);
 
+  /**
+   * The statements for the tables of a schema don't depend on each other, so they are generated
+   * in parallel jobs (each with its own copy of the call-back) and then added in their original order.
+   * The option UseParallelJobs = 0 generates them serially instead.
+   */
+  enum TableTaskType {
+    CreateTable,
+    DropTable,
+    AlterTable
+  };
+  struct TableTask
+  {
+    TableTaskType type;
+    db_mysql_TableRef table;
+    const grt::DiffChange *change;
+    AlterTableFlags alter_table_flags;
+
+    TableTask(TableTaskType t, db_mysql_TableRef tbl, const grt::DiffChange *c = NULL, AlterTableFlags flags = Everything)
+      : type(t), table(tbl), change(c), alter_table_flags(flags)
+    {}
+  };
+  void generate_table_stmts(const std::vector<TableTask> &tasks);
+  void run_table_tasks(std::vector<TableTask>::const_iterator begin, std::vector<TableTask>::const_iterator end);
+
   /**
    * The 2 routines below - remember() and remember_alter() are used to store the gerneated SQL.
    * remember() just adds SQL strings to a list and remember_alter() can store to both a list or a map
@@ -0,0 +1,507 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <memory>
+
+#include <boost/bind.hpp>
+
+#include "db_mysql_parallel_re.h"
+
+#include "base/log.h"
+#include "base/sqlstring.h"
+#include "base/string_utilities.h"
+#include "grtpp_util.h"
+
+DEFAULT_LOG_DOMAIN("ParallelRE")
+
+// Number of objects fetched and parsed by one work unit. Small enough to spread a large schema
+// over all connections, large enough to keep the merge cheap.
+#define UNIT_OBJECT_COUNT 50
+
+// Connections used if the caller does not specify a number. The work is mostly waiting for the server.
+#define DEFAULT_CONNECTION_COUNT 8
+
+//--------------------------------------------------------------------------------------------------
+
+ParallelReverseEngineer::ParallelReverseEngineer(db_mysql_CatalogRef catalog, GrtVersionRef version,
+  const std::string &sql_mode)
+  : _catalog(catalog), _version(version), _sql_mode(sql_mode), _unit_finished(0), _cancelled(0),
+  _calling_thread(NULL)
+{
+  _services = parser::MySQLParserServices::get(catalog->get_grt());
+
+  // Index what is already in the target catalog, so objects get merged with it.
+  for (grt::ListRef<db_mysql_Schema>::const_iterator schema = _catalog->schemata().begin();
+    schema != _catalog->schemata().end(); ++schema)
+  {
+    _schemata[(*schema)->name()] = *schema;
+    TableMap &tables = _tables[(*schema)->name()];
+    for (grt::ListRef<db_mysql_Table>::const_iterator table = (*schema)->tables().begin();
+      table != (*schema)->tables().end(); ++table)
+      tables[(*table)->name()] = *table;
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Schedules the given objects for reverse engineering. The schema is created in the target catalog
+ * if it doesn't exist yet, so schemas appear in the order they were first added.
+ */
+void ParallelReverseEngineer::add_objects(const std::string &schema_name, ObjectType type,
+  const std::vector<std::string> &names)
+{
+  target_schema(schema_name);
+
+  for (size_t i = 0; i < names.size(); i += UNIT_OBJECT_COUNT)
+  {
+    WorkUnit unit;
+    unit.schema_name = schema_name;
+    unit.type = type;
+    unit.names.assign(names.begin() + i, names.begin() + std::min(names.size(), i + UNIT_OBJECT_COUNT));
+    unit.error_count = 0;
+    _units.push_back(unit);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fetches and parses all scheduled objects and merges them into the target catalog.
+ * Connections are opened on the calling thread as that might involve asking the user for a password.
+ *
+ * @result The number of parse errors found.
+ */
+size_t ParallelReverseEngineer::reverse_engineer(const ConnectionFactory &open_connection, int max_connections)
+{
+  if (_units.empty())
+    return 0;
+
+  grt::GRT *grt = _catalog->get_grt();
+
+  size_t worker_count = max_connections > 0 ? (size_t)max_connections : DEFAULT_CONNECTION_COUNT;
+  worker_count = std::min(worker_count, _units.size());
+  _workers.resize(worker_count);
+  for (size_t i = 0; i < worker_count; ++i)
+  {
+    _workers[i].connection = open_connection();
+    _workers[i].context = parser::MySQLParserServices::createParserContext(_catalog->characterSets(), _version, true);
+    _workers[i].context->use_sql_mode(_sql_mode);
+    _idle_workers.push_back(i);
+  }
+  log_debug("Reverse engineering %i work units over %i connections\n", (int)_units.size(), (int)worker_count);
+
+  // All units must exist before the first job runs, as jobs keep a pointer to their unit.
+  for (std::vector<WorkUnit>::iterator unit = _units.begin(); unit != _units.end(); ++unit)
+    unit->catalog = create_part_catalog();
+
+  _calling_thread = g_thread_self();
+  grt->push_message_handler(boost::bind(&ParallelReverseEngineer::queue_message, this, _1, _2));
+  try
+  {
+    base::TaskGroup group((int)worker_count);
+    for (std::vector<WorkUnit>::iterator unit = _units.begin(); unit != _units.end(); ++unit)
+      group.run(boost::bind(&ParallelReverseEngineer::process_unit, this, &*unit));
+
+    for (size_t i = 0; i < _units.size(); ++i)
+    {
+      _unit_finished.wait();
+      flush_messages(grt);
+      if (grt->query_status())
+        g_atomic_int_set(&_cancelled, 1);
+      grt->send_progress((float)(i + 1) / _units.size(), base::strfmt("Reverse engineered %i of %i object groups",
+        (int)(i + 1), (int)_units.size()));
+    }
+    group.wait();
+  }
+  catch (...)
+  {
+    grt->pop_message_handler();
+    throw;
+  }
+  grt->pop_message_handler();
+  flush_messages(grt);
+
+  _workers.clear();
+  _idle_workers.clear();
+
+  if (g_atomic_int_get(&_cancelled))
+    throw grt::user_cancelled("Reverse engineering cancelled");
+
+  size_t error_count = 0;
+  for (std::vector<WorkUnit>::iterator unit = _units.begin(); unit != _units.end(); ++unit)
+  {
+    if (!unit->error.empty())
+      throw std::runtime_error(unit->error);
+    error_count += unit->error_count;
+  }
+
+  grt->send_progress(1, "Merging reverse engineered objects...");
+  for (std::vector<WorkUnit>::iterator unit = _units.begin(); unit != _units.end(); ++unit)
+  {
+    merge_catalog(unit->catalog);
+    unit->catalog = db_mysql_CatalogRef();
+  }
+  resolve_stub_references();
+  _units.clear();
+
+  return error_count;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates an empty catalog which shares the data types and character sets of the target catalog,
+ * as needed by the parser.
+ */
+db_mysql_CatalogRef ParallelReverseEngineer::create_part_catalog()
+{
+  db_mysql_CatalogRef catalog(_catalog.get_grt());
+  catalog->name(_catalog->name());
+  catalog->version(_catalog->version());
+  catalog->defaultCharacterSetName(_catalog->defaultCharacterSetName());
+  catalog->defaultCollationName(_catalog->defaultCollationName());
+  grt::replace_contents(catalog->simpleDatatypes(), _catalog->simpleDatatypes());
+  grt::replace_contents(catalog->userDatatypes(), _catalog->userDatatypes());
+  grt::replace_contents(catalog->characterSets(), _catalog->characterSets());
+
+  return catalog;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Runs on a worker thread. Must not throw, the calling thread waits for each unit to signal it is done.
+ */
+void ParallelReverseEngineer::process_unit(WorkUnit *unit)
+{
+  size_t worker_index;
+  {
+    base::MutexLock lock(_worker_lock);
+    worker_index = _idle_workers.back();
+    _idle_workers.pop_back();
+  }
+  Worker &worker = _workers[worker_index];
+
+  try
+  {
+    std::auto_ptr<sql::Statement> statement(worker.connection->createStatement());
+
+    grt::DictRef options(_catalog.get_grt());
+    options.set("schema", grt::StringRef(unit->schema_name));
+
+    for (std::vector<std::string>::const_iterator name = unit->names.begin(); name != unit->names.end(); ++name)
+    {
+      if (g_atomic_int_get(&_cancelled))
+        break;
+
+      std::string sql = fetch_ddl(statement.get(), unit->type, unit->schema_name, *name);
+      unit->error_count += _services->parseSQLIntoCatalog(worker.context, unit->catalog, sql, options);
+    }
+  }
+  catch (sql::SQLException &exc)
+  {
+    unit->error = base::strfmt("Error reverse engineering objects from %s: %s (%i)", unit->schema_name.c_str(),
+      exc.what(), exc.getErrorCode());
+  }
+  catch (std::exception &exc)
+  {
+    unit->error = exc.what();
+  }
+
+  {
+    base::MutexLock lock(_worker_lock);
+    _idle_workers.push_back(worker_index);
+  }
+  _unit_finished.post();
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Message handler installed while units are processed. Messages from worker threads are kept
+ * until the calling thread sends them on, everything else goes to the next handler.
+ */
+bool ParallelReverseEngineer::queue_message(const grt::Message &message, void *sender)
+{
+  if (g_thread_self() == _calling_thread)
+    return false;
+
+  // Progress is reported per unit by the calling thread.
+  if (message.type == grt::ProgressMsg)
+    return true;
+
+  base::MutexLock lock(_worker_lock);
+  _pending_messages.push_back(message);
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Sends all queued worker messages on. Must be called on the calling thread.
+ */
+void ParallelReverseEngineer::flush_messages(grt::GRT *grt)
+{
+  std::vector<grt::Message> messages;
+  {
+    base::MutexLock lock(_worker_lock);
+    messages.swap(_pending_messages);
+  }
+
+  for (std::vector<grt::Message>::const_iterator message = messages.begin(); message != messages.end(); ++message)
+  {
+    switch (message->type)
+    {
+    case grt::ErrorMsg:
+      grt->send_error(message->text, message->detail);
+      break;
+    case grt::WarningMsg:
+      grt->send_warning(message->text, message->detail);
+      break;
+    case grt::InfoMsg:
+      grt->send_info(message->text, message->detail);
+      break;
+    case grt::OutputMsg:
+      grt->send_output(message->text);
+      break;
+    case grt::VerboseMsg:
+      grt->send_verbose(message->text);
+      break;
+    default:
+      break;
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fetches the create statement of an object, prepared the same way as for the serial reverse engineering.
+ */
+std::string ParallelReverseEngineer::fetch_ddl(sql::Statement *statement, ObjectType type,
+  const std::string &schema_name, const std::string &name)
+{
+  std::string query;
+  std::string column;
+  std::string kind;
+  switch (type)
+  {
+  case TableObject:
+    query = "SHOW CREATE TABLE !.!";
+    kind = "table";
+    break;
+  case TriggerObject:
+    query = "SHOW CREATE TRIGGER !.!";
+    column = "SQL Original Statement";
+    kind = "trigger";
+    break;
+  case ProcedureObject:
+    query = "SHOW CREATE PROCEDURE !.!";
+    column = "Create Procedure";
+    kind = "procedure";
+    break;
+  case FunctionObject:
+    query = "SHOW CREATE FUNCTION !.!";
+    column = "Create Function";
+    kind = "function";
+    break;
+  }
+
+  std::auto_ptr<sql::ResultSet> rs(statement->executeQuery(std::string(base::sqlstring(query.c_str(), 0)
+    << schema_name << name)));
+  if (!rs.get() || !rs->next())
+    throw std::runtime_error(base::strfmt("Could not fetch %s information for %s.%s", kind.c_str(),
+      schema_name.c_str(), name.c_str()));
+
+  std::string sql = std::string(base::sqlstring("USE !;\n", 0) << schema_name);
+  if (type == TableObject)
+  {
+    std::string ddl = rs->getString(2);
+    return sql + ddl;
+  }
+
+  std::string ddl = rs->getString(column);
+  return sql + "DELIMITER $$\n" + ddl;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the schema with the given name in the target catalog, creating it if needed.
+ */
+db_mysql_SchemaRef ParallelReverseEngineer::target_schema(const std::string &name)
+{
+  std::map<std::string, db_mysql_SchemaRef>::iterator iterator = _schemata.find(name);
+  if (iterator != _schemata.end())
+    return iterator->second;
+
+  db_mysql_SchemaRef schema(_catalog.get_grt());
+  schema->owner(_catalog);
+  schema->name(name);
+  schema->oldName(name);
+  _catalog->schemata().insert(schema);
+  _schemata[name] = schema;
+
+  return schema;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Moves all objects of a part catalog into the target catalog.
+ */
+void ParallelReverseEngineer::merge_catalog(db_mysql_CatalogRef part)
+{
+  for (grt::ListRef<db_mysql_Schema>::const_iterator part_schema = part->schemata().begin();
+    part_schema != part->schemata().end(); ++part_schema)
+  {
+    db_mysql_SchemaRef schema = target_schema((*part_schema)->name());
+
+    for (grt::ListRef<db_mysql_Table>::const_iterator table = (*part_schema)->tables().begin();
+      table != (*part_schema)->tables().end(); ++table)
+      merge_table(schema, *table);
+
+    for (grt::ListRef<db_mysql_View>::const_iterator view = (*part_schema)->views().begin();
+      view != (*part_schema)->views().end(); ++view)
+    {
+      (*view)->owner(schema);
+      schema->views().insert(*view);
+    }
+
+    for (grt::ListRef<db_mysql_Routine>::const_iterator routine = (*part_schema)->routines().begin();
+      routine != (*part_schema)->routines().end(); ++routine)
+    {
+      (*routine)->owner(schema);
+      schema->routines().insert(*routine);
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void move_triggers(db_mysql_TableRef source, db_mysql_TableRef target)
+{
+  for (grt::ListRef<db_mysql_Trigger>::const_iterator trigger = source->triggers().begin();
+    trigger != source->triggers().end(); ++trigger)
+  {
+    db_mysql_TriggerRef existing = grt::find_named_object_in_list(target->triggers(), (*trigger)->name());
+    if (existing.is_valid())
+      target->triggers().remove_value(existing);
+    (*trigger)->owner(target);
+    target->triggers().insert(*trigger);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Adds a table to the given target schema. A stub table is only added if no table of that name
+ * exists yet, a real table replaces a stub. Triggers parsed into a stub (because their table
+ * was handled by another unit) are moved to the real table.
+ */
+void ParallelReverseEngineer::merge_table(db_mysql_SchemaRef schema, db_mysql_TableRef table)
+{
+  TableMap &tables = _tables[schema->name()];
+  TableMap::iterator existing = tables.find(table->name());
+  if (existing == tables.end())
+  {
+    table->owner(schema);
+    schema->tables().insert(table);
+    tables[table->name()] = table;
+    return;
+  }
+
+  db_mysql_TableRef current = existing->second;
+  if (table->isStub())
+  {
+    move_triggers(table, current);
+    return;
+  }
+
+  table->owner(schema);
+  size_t index = schema->tables().get_index(current);
+  if (index == grt::BaseListRef::npos)
+    schema->tables().insert(table);
+  else
+    schema->tables().set(index, table);
+  existing->second = table;
+
+  if (current->isStub())
+    move_triggers(current, table);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Points foreign keys which reference stub tables to the real tables, if they were reverse engineered.
+ * Foreign keys whose columns don't exist in the real table are removed, as the parser does.
+ */
+void ParallelReverseEngineer::resolve_stub_references()
+{
+  for (grt::ListRef<db_mysql_Schema>::const_iterator schema = _catalog->schemata().begin();
+    schema != _catalog->schemata().end(); ++schema)
+  {
+    for (grt::ListRef<db_mysql_Table>::const_iterator table = (*schema)->tables().begin();
+      table != (*schema)->tables().end(); ++table)
+    {
+      grt::ListRef<db_mysql_ForeignKey> foreign_keys = (*table)->foreignKeys();
+      for (size_t i = foreign_keys.count(); i > 0; --i)
+      {
+        db_mysql_ForeignKeyRef fk = foreign_keys[i - 1];
+        db_mysql_TableRef referenced = db_mysql_TableRef::cast_from(fk->referencedTable());
+        if (!referenced.is_valid() || !referenced->isStub() || !referenced->owner().is_valid())
+          continue;
+
+        std::map<std::string, TableMap>::iterator tables = _tables.find(referenced->owner()->name());
+        if (tables == _tables.end())
+          continue;
+        TableMap::iterator real = tables->second.find(referenced->name());
+        if (real == tables->second.end() || real->second == referenced || real->second->isStub())
+          continue;
+
+        std::vector<db_ColumnRef> columns;
+        for (grt::ListRef<db_Column>::const_iterator column = fk->referencedColumns().begin();
+          column != fk->referencedColumns().end(); ++column)
+        {
+          // MySQL column names are always case-insensitive.
+          db_ColumnRef real_column = grt::find_named_object_in_list(real->second->columns(), (*column)->name(), false);
+          if (!real_column.is_valid())
+            break;
+          columns.push_back(real_column);
+        }
+
+        if (columns.size() != fk->referencedColumns().count())
+        {
+          log_warning("Removing foreign key %s.%s, referenced columns do not exist in %s\n",
+            (*table)->name().c_str(), fk->name().c_str(), referenced->name().c_str());
+          foreign_keys.remove(i - 1);
+          continue;
+        }
+
+        fk->referencedTable(real->second);
+        fk->referencedColumns().remove_all();
+        for (std::vector<db_ColumnRef>::const_iterator column = columns.begin(); column != columns.end(); ++column)
+          fk->referencedColumns().insert(*column);
+      }
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
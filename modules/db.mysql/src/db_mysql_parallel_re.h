@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include "db_mysql_public_interface.h"
+#include "cppdbc.h"
+#include "base/threading.h"
+#include "grtsqlparser/mysql_parser_services.h"
+#include "grts/structs.db.mysql.h"
+
+/**
+ * Reverse engineers objects from a MySQL server using several connections at once.
+ *
+ * The object list is split into work units. Each unit fetches the DDL of its objects and parses it
+ * into a private catalog, using a connection and a parser context no other thread uses at the same
+ * time. Once all units are done their catalogs are merged into the target catalog on the calling
+ * thread. Stub tables created for references to objects of other units are replaced by the real
+ * tables in that step.
+ *
+ * Messages the parser sends while running on a worker thread are queued and passed on from the
+ * calling thread, as message handlers (e.g. the ones of Python callers) may not be thread safe.
+ */
+class MYSQLMODULEDBMYSQL_PUBLIC_FUNC ParallelReverseEngineer
+{
+public:
+  enum ObjectType
+  {
+    TableObject, // Tables and views, both are fetched with SHOW CREATE TABLE.
+    TriggerObject,
+    ProcedureObject,
+    FunctionObject
+  };
+
+  typedef boost::function<sql::ConnectionWrapper ()> ConnectionFactory;
+
+  ParallelReverseEngineer(db_mysql_CatalogRef catalog, GrtVersionRef version, const std::string &sql_mode);
+
+  void add_objects(const std::string &schema_name, ObjectType type, const std::vector<std::string> &names);
+  size_t reverse_engineer(const ConnectionFactory &open_connection, int max_connections = -1);
+
+  // The steps reverse_engineer() does after all DDL is parsed, accessible for tests.
+  db_mysql_CatalogRef create_part_catalog();
+  void merge_catalog(db_mysql_CatalogRef part);
+  void resolve_stub_references();
+
+private:
+  struct WorkUnit
+  {
+    std::string schema_name;
+    ObjectType type;
+    std::vector<std::string> names;
+    db_mysql_CatalogRef catalog;
+    size_t error_count;
+    std::string error;
+  };
+
+  struct Worker
+  {
+    sql::ConnectionWrapper connection;
+    parser::ParserContext::Ref context;
+  };
+
+  typedef std::map<std::string, db_mysql_TableRef> TableMap;
+
+  db_mysql_CatalogRef _catalog;
+  GrtVersionRef _version;
+  std::string _sql_mode;
+  parser::MySQLParserServices::Ref _services;
+
+  std::vector<WorkUnit> _units;
+  std::vector<Worker> _workers;
+  std::vector<size_t> _idle_workers;
+  base::Mutex _worker_lock;
+  base::Semaphore _unit_finished;
+  volatile gint _cancelled;
+
+  GThread *_calling_thread;
+  std::vector<grt::Message> _pending_messages; // Guarded by _worker_lock.
+
+  // Schemas and tables in the target catalog, by name.
+  std::map<std::string, db_mysql_SchemaRef> _schemata;
+  std::map<std::string, TableMap> _tables;
+
+  void process_unit(WorkUnit *unit);
+  bool queue_message(const grt::Message &message, void *sender);
+  void flush_messages(grt::GRT *grt);
+  std::string fetch_ddl(sql::Statement *statement, ObjectType type, const std::string &schema_name,
+    const std::string &name);
+
+  db_mysql_SchemaRef target_schema(const std::string &name);
+  void merge_table(db_mysql_SchemaRef schema, db_mysql_TableRef table);
+};
@@ -21,6 +21,9 @@
 #include <pcre.h>
 #include <stdio.h>
 #endif
+#include <errno.h>
+
+#include <boost/bind.hpp>
 
 #include "base/sqlstring.h"
 
@@ -35,9 +38,11 @@
 
 #include "db_mysql_diffsqlgen_grant.h"
 #include "db_mysql_catalog_report.h"
+#include "db_mysql_parallel_re.h"
 #include "base/string_utilities.h"
 #include "base/sqlstring.h"
 #include "base/util_functions.h"
+#include "base/file_functions.h"
 
 #include "grtsqlparser/sql_specifics.h"
 #include "sqlide/recordset_table_inserts_storage.h"
@@ -293,6 +298,16 @@ class ActionGenerateSQL : public DiffSQLGeneratorBEActionInterface
   grt::ListRef<GrtNamedObject> target_object_list;
   bool disable_object_list;
 
+  // What a job copy remembered, in order, to be replayed by append_job_output().
+  struct JobStatement
+  {
+    GrtNamedObjectRef object;
+    std::string sql;
+    bool alter;
+  };
+  bool _is_job_copy;
+  std::vector<JobStatement> _job_statements;
+
   void remember_alter(const GrtNamedObjectRef &obj, const std::string &sql);
   void remember(const GrtNamedObjectRef &obj, const std::string &sql,const bool front = false);
 
@@ -430,11 +445,14 @@ public:
   std::string generate_add_index(db_mysql_IndexRef index);
   
   virtual void disable_list_insert(const bool flag){disable_object_list = flag;};
+
+  virtual DiffSQLGeneratorBEActionInterface *create_job_copy();
+  virtual void append_job_output(DiffSQLGeneratorBEActionInterface *job);
 };
 
 ActionGenerateSQL::ActionGenerateSQL(grt::ValueRef target, grt::ListRef<GrtNamedObject> obj_list, grt::GRT *grt, 
                                      const grt::DictRef options, bool use_oids_as_key = false)
-  : padding(2), _use_oids_as_dict_key(use_oids_as_key),disable_object_list(false)
+  : padding(2), _use_oids_as_dict_key(use_oids_as_key),disable_object_list(false), _is_job_copy(false)
 {
 
   first_column = false;
@@ -1688,6 +1706,12 @@ void ActionGenerateSQL::drop_user(db_UserRef user)
 
 void ActionGenerateSQL::remember(const GrtNamedObjectRef &obj, const std::string &sql, const bool front)
 {
+  if (_is_job_copy)
+  {
+    JobStatement statement= { obj, sql, false };
+    _job_statements.push_back(statement);
+  }
+
   if(target_list.is_valid())
   {
     if(disable_object_list)
@@ -1706,6 +1730,12 @@ void ActionGenerateSQL::remember(const GrtNamedObjectRef &obj, const std::string
 // so we use grt::StringListRefs as needed
 void ActionGenerateSQL::remember_alter(const GrtNamedObjectRef &obj, const std::string &sql)
 {
+  if (_is_job_copy)
+  {
+    JobStatement statement= { obj, sql, true };
+    _job_statements.push_back(statement);
+  }
+
   if(target_list.is_valid())
   {
     if(disable_object_list)
@@ -1743,6 +1773,47 @@ void ActionGenerateSQL::remember_alter(const GrtNamedObjectRef &obj, const std::
   }
 }
 
+/**
+ * Creates a copy for generating the SQL of some tables on a worker thread. The copy stores into containers
+ * of its own, which are only used for lookups while it runs. Must be called on the generating thread, as it
+ * also sets up data the generation initializes lazily.
+ */
+DiffSQLGeneratorBEActionInterface *ActionGenerateSQL::create_job_copy()
+{
+  grt::GRT *grt= target_list.is_valid() ? target_list.get_grt() : target_map.get_grt();
+
+  bec::TableHelper::get_engine_by_name(grt, "");
+  charsetForCollation("");
+  defaultCollationForCharset("");
+
+  ActionGenerateSQL *copy= new ActionGenerateSQL(*this);
+  copy->_is_job_copy= true;
+  copy->_job_statements.clear();
+  if (target_list.is_valid())
+  {
+    copy->target_list= grt::StringListRef(grt);
+    if (target_object_list.is_valid())
+      copy->target_object_list= grt::ListRef<GrtNamedObject>(grt);
+  }
+  else
+    copy->target_map= grt::DictRef(grt);
+
+  return copy;
+}
+
+void ActionGenerateSQL::append_job_output(DiffSQLGeneratorBEActionInterface *job)
+{
+  ActionGenerateSQL *copy= static_cast<ActionGenerateSQL*>(job);
+  for (std::vector<JobStatement>::const_iterator statement= copy->_job_statements.begin();
+       statement != copy->_job_statements.end(); ++statement)
+  {
+    if (statement->alter)
+      remember_alter(statement->object, statement->sql);
+    else
+      remember(statement->object, statement->sql);
+  }
+}
+
 } // namespace
 
 DbMySQLImpl::DbMySQLImpl(grt::CPPModuleLoader *ldr) : grt::ModuleImplBase(ldr), _default_traits(get_grt())
@@ -1900,6 +1971,60 @@ public:
     }
 };
 
+// Receives a generated script piece by piece, so that big scripts can go to their destination
+// without being kept in memory as a whole.
+class SQLScriptOutput
+{
+public:
+    virtual ~SQLScriptOutput() {}
+    virtual void write(const std::string &sql) = 0;
+};
+
+class SQLScriptStringOutput : public SQLScriptOutput
+{
+    std::string &_script;
+public:
+    SQLScriptStringOutput(std::string &script) : _script(script) {}
+
+    virtual void write(const std::string &sql)
+    {
+        _script.append(sql);
+    }
+};
+
+class SQLScriptFileOutput : public SQLScriptOutput
+{
+    std::string _path;
+    FILE *_file;
+public:
+    SQLScriptFileOutput(const std::string &path) : _path(path)
+    {
+        _file = base_fopen(path.c_str(), "wb");
+        if (_file == NULL)
+            throw std::runtime_error(base::strfmt("Could not open file %s for writing: %s", path.c_str(), g_strerror(errno)));
+    }
+
+    virtual ~SQLScriptFileOutput()
+    {
+        if (_file != NULL)
+            fclose(_file);
+    }
+
+    virtual void write(const std::string &sql)
+    {
+        if (!sql.empty() && fwrite(sql.data(), 1, sql.size(), _file) != sql.size())
+            throw std::runtime_error(base::strfmt("Error writing to file %s: %s", _path.c_str(), g_strerror(errno)));
+    }
+
+    void close()
+    {
+        int result = fclose(_file);
+        _file = NULL;
+        if (result != 0)
+            throw std::runtime_error(base::strfmt("Error writing to file %s: %s", _path.c_str(), g_strerror(errno)));
+    }
+};
+
 class SQLComposer
 {
 protected:
@@ -2181,7 +2306,6 @@ protected:
 
         result.append(create_table_sql).append(";\n\n");
         result.append(show_warnings_sql());
-        send_output(std::string("Processing Table ").append(table->owner()->name()).append(".").append(table->name()).append("\n"));
 
         // table indices
         if(gen_create_index)
@@ -2287,9 +2411,6 @@ protected:
     {
         std::string result;
 
-        send_output(std::string("Processing Trigger ") 
-            .append(trigger->owner()->owner()->name()).append(".").append(trigger->owner()->name()).append(".").append(trigger->name()).append("\n"));
-
         if (trigger->modelOnly() || !exists_in_map(trigger, create_map, case_sensitive))
             return "";
 
@@ -2330,65 +2451,115 @@ protected:
         return result;
     }
 
+    // The DDL of a table and its triggers.
+    struct TableFragment
+    {
+        db_mysql_TableRef table;
+        bool create;
+        std::string table_sql;
+        std::string triggers_sql;
+    };
+
+    // The statements themselves were generated (in parallel) by DiffSQLGeneratorBE into the create and
+    // drop maps, here they are only put together.
+    void generate_table_fragments(std::vector<std::vector<TableFragment> > &fragments) const
+    {
+        for (std::vector<std::vector<TableFragment> >::iterator schema = fragments.begin(); schema != fragments.end(); ++schema)
+        {
+            for (std::vector<TableFragment>::iterator fragment = schema->begin(); fragment != schema->end(); ++fragment)
+            {
+                if (fragment->create)
+                    fragment->table_sql = table_sql(fragment->table);
+
+                grt::ListRef<db_mysql_Trigger> triggers= fragment->table->triggers();
+                for(size_t c= triggers.count(), i= 0; i < c; i++)
+                    fragment->triggers_sql.append(trigger_sql(triggers.get(i)));
+            }
+        }
+    }
+
+    void write_scripts(const db_mysql_CatalogRef &cat, const std::string &position, SQLScriptOutput &out) const
+    {
+        if (include_scripts && cat->owner().is_valid())
+        {
+            GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script)
+            {
+                if ((*script)->forwardEngineerScriptPosition() == position)
+                    out.write(user_script(*script));
+            }
+        }
+    }
+
 public:
-    std::string get_export_sql(const db_mysql_CatalogRef cat)
+    void get_export_sql(const db_mysql_CatalogRef cat, SQLScriptOutput &out)
     {
-        std::string out_sql;
-        std::string inserts_sql;  // separate from main sql script & append to it as a last step,
-                                  // to separate creation of structures from data loading.
+        std::string header;
+        std::vector<db_mysql_TableRef> insert_tables; // inserts are written after all structures,
+                                                      // to separate creation of structures from data loading.
         std::string triggers_sql; //Triggers DDLs could be prior or after INSERTs depending on settings
 
-        out_sql.append("-- MySQL Workbench Forward Engineering").append("\n");
+        header.append("-- MySQL Workbench Forward Engineering").append("\n");
         if (include_document_properties && cat->owner().is_valid() && cat->owner()->owner().is_valid())
         {
-          out_sql.append("-- Generated: ").append(fmttime(0, DATETIME_FMT)).append("\n");
+          header.append("-- Generated: ").append(fmttime(0, DATETIME_FMT)).append("\n");
           
           workbench_DocumentRef doc(workbench_DocumentRef::cast_from(cat->owner()->owner()));
           if (strlen(doc->info()->caption().c_str()))
-              out_sql.append("-- Model: ").append(doc->info()->caption()).append("\n");
+              header.append("-- Model: ").append(doc->info()->caption()).append("\n");
           if (strlen(doc->info()->version().c_str()))
-              out_sql.append("-- Version: ").append(doc->info()->version()).append("\n");
+              header.append("-- Version: ").append(doc->info()->version()).append("\n");
           if (strlen(doc->info()->project().c_str()))
-              out_sql.append("-- Project: ").append(doc->info()->project()).append("\n");
+              header.append("-- Project: ").append(doc->info()->project()).append("\n");
           if (strlen(doc->info()->author().c_str()))
-              out_sql.append("-- Author: ").append(doc->info()->author()).append("\n");
+              header.append("-- Author: ").append(doc->info()->author()).append("\n");
           if (strlen(doc->info()->description().c_str()))
           {
             std::string description = doc->info()->description();
             base::replace(description, "\n", "\n --");
-            out_sql.append("-- ").append(description).append("\n");
+            header.append("-- ").append(description).append("\n");
           }
         }
-        out_sql.append("\n");
+        header.append("\n");
+        out.write(header);
 
-        if (include_scripts && cat->owner().is_valid())
-        {
-          GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script)
-          {
-            if ((*script)->forwardEngineerScriptPosition() == "top_file")
-              out_sql.append(user_script(*script));
-          }
-        }
+        write_scripts(cat, "top_file", out);
 
         send_output("Generating Script\n");
-        out_sql.append(set_server_vars());
+        out.write(set_server_vars());
         TableSorterByFK sorter;
 
-        if (include_scripts && cat->owner().is_valid())
+        write_scripts(cat, "before_ddl", out);
+
+        // schemata
+        grt::ListRef<db_mysql_Schema> schemata= cat->schemata();
+        out.write(schemata_sql(schemata));
+
+        // tables in dependency order, per schema
+        std::vector<std::vector<TableFragment> > fragments(schemata.count());
+        for(size_t c1= schemata.count(), i= 0; i < c1; i++)
         {
-            GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script)
+            db_mysql_SchemaRef schema= schemata.get(i);
+            if (schema->modelOnly())
+                continue;
+
+            grt::ListRef<db_mysql_Table> tables= schema->tables();
+            std::vector<db_mysql_TableRef> sorted_tables;
+            for(size_t c2= tables.count(), j= 0; j < c2; j++)
+                sorter.perform(tables.get(j), sorted_tables);
+            for(std::vector<db_mysql_TableRef>::iterator It = sorted_tables.begin(); It != sorted_tables.end(); ++It)
             {
-                if ((*script)->forwardEngineerScriptPosition() == "before_ddl")
-                    out_sql.append(user_script(*script));
+                if ((*It)->modelOnly() || (*It)->isStub())
+                    continue;
+                TableFragment fragment;
+                fragment.table = *It;
+                fragment.create = exists_in_map(*It, create_map, case_sensitive);
+                fragments[i].push_back(fragment);
             }
         }
+        generate_table_fragments(fragments);
 
-        // schemata
-        grt::ListRef<db_mysql_Schema> schemata= cat->schemata();
-        out_sql.append(schemata_sql(schemata));
         for(size_t c1= schemata.count(), i= 0; i < c1; i++)
         {
-            std::string objects_sql;
             std::string schema_triggers_sql;
 
             db_mysql_SchemaRef schema= schemata.get(i);
@@ -2398,34 +2569,29 @@ public:
             send_output(std::string("Processing Schema ").append(schema->name()).append("\n"));
 
             if ((!use_short_names || gen_use) && (create_map.has_key(get_full_object_name_for_key(schema, case_sensitive))))
-                out_sql.append("USE `").append(schema->name().c_str()).append("` ;\n");
+                out.write(std::string("USE `").append(schema->name().c_str()).append("` ;\n"));
 
-            // tables
-            grt::ListRef<db_mysql_Table> tables= schema->tables();
-            std::vector<db_mysql_TableRef> sorted_tables;
-            for(size_t c2= tables.count(), j= 0; j < c2; j++)
-                sorter.perform(tables.get(j), sorted_tables);
-            for(std::vector<db_mysql_TableRef>::iterator It = sorted_tables.begin(); It != sorted_tables.end(); ++It)
+            for (std::vector<TableFragment>::iterator fragment = fragments[i].begin(); fragment != fragments[i].end(); ++fragment)
             {
-                db_mysql_TableRef table = *It;
-                if (table->modelOnly() || table->isStub())
-                    continue;
-                if(exists_in_map(table, create_map, case_sensitive))
+                db_mysql_TableRef table = fragment->table;
+                if (fragment->create)
                 {
-                    out_sql.append(table_sql(table));
+                    send_output(std::string("Processing Table ").append(table->owner()->name()).append(".").append(table->name()).append("\n"));
+                    out.write(fragment->table_sql);
                     if (gen_inserts)
-                    {
-                      std::string tmp = table_inserts_sql(table);
-                      if (!tmp.empty())
-                        inserts_sql.append(tmp).append("\n");
-                    }
+                        insert_tables.push_back(table);
                 } // process table
 
-                // Fill triggers_sql with triggers DDLs and append it to out_sql later
-                // tables
+                // Collect triggers DDLs in triggers_sql and write it out later
                 grt::ListRef<db_mysql_Trigger> triggers= table->triggers();
                 for(size_t c3= triggers.count(), k= 0; k < c3; k++)
-                    schema_triggers_sql.append(trigger_sql(triggers.get(k)));
+                    send_output(std::string("Processing Trigger ")
+                        .append(table->owner()->name()).append(".").append(table->name()).append(".").append(triggers[k]->name()).append("\n"));
+                schema_triggers_sql.append(fragment->triggers_sql);
+
+                // Each fragment is written only once.
+                std::string().swap(fragment->table_sql);
+                std::string().swap(fragment->triggers_sql);
             }
             if(!schema_triggers_sql.empty())
             {
@@ -2468,13 +2634,13 @@ public:
             if (!objects_sql.empty() && create_map.has_key(get_full_object_name_for_key(schema, case_sensitive)))
             {
               if (!use_short_names || gen_use)
-                out_sql.append("USE `").append(schema->name().c_str()).append("` ;\n");
-              out_sql.append(objects_sql);
+                out.write(std::string("USE `").append(schema->name().c_str()).append("` ;\n"));
+              out.write(objects_sql);
             }
         }
 
         if(!triggers_after_inserts)
-            out_sql.append(triggers_sql);
+            out.write(triggers_sql);
 
         if (no_user_just_privileges)
         {
@@ -2482,68 +2648,54 @@ public:
             gen_grant_sql(cat, grants);
 
             for(std::list<std::string>::iterator iter= grants.begin(); iter != grants.end(); ++iter)
-                out_sql.append(*iter).append(";\n");
+                out.write(std::string(*iter).append(";\n"));
         }
         else
         {
             grt::ListRef<db_User> users= cat->users();
             for(size_t c1= users.count(), i= 0; i < c1; i++)
-                out_sql.append(user_sql(users.get(i)));
+                out.write(user_sql(users.get(i)));
         }
 
 
         if(!no_FK_for_inserts)
-            out_sql.append(restore_server_vars());
+            out.write(restore_server_vars());
 
-        if (gen_inserts && !inserts_sql.empty())
+        // Inserts are generated one table at a time, right before they are written.
+        bool has_inserts = false;
+        for (std::vector<db_mysql_TableRef>::const_iterator table = insert_tables.begin(); table != insert_tables.end(); ++table)
         {
-          if (include_scripts && cat->owner().is_valid())
-          {
-            GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script)
-            {
-              if ((*script)->forwardEngineerScriptPosition() == "before_inserts")
-                out_sql.append(user_script(*script));
-            }
-          }
-
-          out_sql.append(inserts_sql);
+            std::string inserts_sql = table_inserts_sql(*table);
+            if (inserts_sql.empty())
+                continue;
 
-          if (include_scripts && cat->owner().is_valid())
-          {
-            GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script)
+            if (!has_inserts)
             {
-              if ((*script)->forwardEngineerScriptPosition() == "after_inserts")
-                out_sql.append(user_script(*script));
+                write_scripts(cat, "before_inserts", out);
+                has_inserts = true;
             }
-          }
+            out.write(inserts_sql.append("\n"));
         }
+        if (has_inserts)
+            write_scripts(cat, "after_inserts", out);
 
         if(triggers_after_inserts)
-            out_sql.append(triggers_sql);
+            out.write(triggers_sql);
+
+        write_scripts(cat, "after_ddl", out);
 
-        if (include_scripts && cat->owner().is_valid())
-        {
-            GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script)
-            {
-                if ((*script)->forwardEngineerScriptPosition() == "after_ddl")
-                    out_sql.append(user_script(*script));
-            }
-        }
         if(no_FK_for_inserts)
-            out_sql.append(restore_server_vars());
+            out.write(restore_server_vars());
 
-        if (include_scripts && cat->owner().is_valid())
-        {
-            GRTLIST_FOREACH(db_Script, workbench_physical_ModelRef::cast_from(cat->owner())->scripts(), script)
-            {
-                if ((*script)->forwardEngineerScriptPosition() == "bottom_file")
-                    out_sql.append(user_script(*script));
-            }
-        }
-        return out_sql;
+        write_scripts(cat, "bottom_file", out);
     }
 };
 
+/**
+ * Puts the export script together from the statements in createSQL and dropSQL. The script is returned
+ * in the "OutputScript" option, unless "OutputFileName" is set. In that case the script is written
+ * straight to that file, preceded by the "OutputScriptHeader" option.
+ */
 ssize_t DbMySQLImpl::makeSQLExportScript(GrtNamedObjectRef dbobject, grt::DictRef options, 
     const grt::DictRef& createSQL, const grt::DictRef& dropSQL)
 {
@@ -2553,11 +2705,24 @@ ssize_t DbMySQLImpl::makeSQLExportScript(GrtNamedObjectRef dbobject, grt::DictRe
 
     db_mysql_CatalogRef catalog= db_mysql_CatalogRef::cast_from(dbobject);
     SQLExportComposer composer(options, createSQL, dropSQL, get_grt());
-    options.set("OutputScript", grt::StringRef(composer.get_export_sql(catalog)));
+
+    std::string filename = options.get_string("OutputFileName");
+    if (!filename.empty())
+    {
+        SQLScriptFileOutput output(filename);
+        output.write(options.get_string("OutputScriptHeader"));
+        composer.get_export_sql(catalog, output);
+        output.close();
+        return 0;
+    }
+
+    std::string script;
+    SQLScriptStringOutput output(script);
+    composer.get_export_sql(catalog, output);
+    options.set("OutputScript", grt::StringRef(script));
     return 0;
 }
 
-
 class SQLSyncComposer : public SQLComposer
 {
 
@@ -3078,5 +3243,56 @@ grt::ListRef<db_UserDatatype> DbMySQLImpl::getDefaultUserDatatypes(db_mgmt_Rdbms
   return list;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+static sql::ConnectionWrapper open_re_connection(db_mgmt_ConnectionRef connection, grt::StringRef password)
+{
+  sql::DriverManager *dm = sql::DriverManager::getDriverManager();
+  if (!password.is_valid())
+    return dm->getConnection(connection);
+
+  sql::Authentication::Ref auth = sql::Authentication::create(connection, "");
+  auth->set_password(password.c_str());
+  return dm->getConnection(connection, dm->getTunnel(connection), auth);
+}
+
+static std::vector<std::string> object_names(const grt::DictRef &objects, const std::string &key)
+{
+  std::vector<std::string> names;
+  grt::BaseListRef list = grt::BaseListRef::cast_from(objects.get(key));
+  if (list.is_valid())
+  {
+    for (size_t i = 0; i < list.count(); ++i)
+      names.push_back(grt::StringRef::cast_from(list.get(i)));
+  }
+  return names;
+}
+
+int DbMySQLImpl::reverseEngineerObjects(db_mgmt_ConnectionRef connection, db_mysql_CatalogRef catalog,
+                                        grt::StringListRef schemata, grt::DictRef objects, grt::DictRef options)
+{
+  ParallelReverseEngineer engine(catalog, GrtVersionRef::cast_from(options.get("serverVersion")),
+                                 options.get_string("sqlMode"));
+
+  for (grt::StringListRef::const_iterator schema = schemata.begin(); schema != schemata.end(); ++schema)
+  {
+    grt::DictRef schema_objects = grt::DictRef::cast_from(objects.get(*schema));
+    if (!schema_objects.is_valid())
+      continue;
+
+    engine.add_objects(*schema, ParallelReverseEngineer::TableObject, object_names(schema_objects, "tables"));
+    engine.add_objects(*schema, ParallelReverseEngineer::TriggerObject, object_names(schema_objects, "triggers"));
+    engine.add_objects(*schema, ParallelReverseEngineer::ProcedureObject, object_names(schema_objects, "procedures"));
+    engine.add_objects(*schema, ParallelReverseEngineer::FunctionObject, object_names(schema_objects, "functions"));
+  }
+
+  grt::StringRef password;
+  if (options.has_key("password"))
+    password = grt::StringRef::cast_from(options.get("password"));
+
+  return (int)engine.reverse_engineer(boost::bind(open_re_connection, connection, password),
+                                      (int)options.get_int("connections", 0));
+}
+
 
 GRT_MODULE_ENTRY_POINT(DbMySQLImpl);
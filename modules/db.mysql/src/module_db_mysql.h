@@ -193,6 +193,12 @@ public:
   virtual void alter_schema_default_collate(db_mysql_SchemaRef, grt::StringRef value) = 0;
   virtual void alter_schema_props_end(db_mysql_SchemaRef) = 0;
   virtual void disable_list_insert(const bool flag) = 0;
+
+  // Support for generating the SQL of several tables in parallel. create_job_copy() returns a new call-back
+  // with the same settings that keeps its output to itself, append_job_output() adds the output of such a copy
+  // to this call-back as if it had been generated here. Call-backs that can't be copied return NULL.
+  virtual DiffSQLGeneratorBEActionInterface *create_job_copy() { return NULL; }
+  virtual void append_job_output(DiffSQLGeneratorBEActionInterface *job) {}
 };
 
 
@@ -229,7 +235,15 @@ public:
                   DECLARE_MODULE_FUNCTION(DbMySQLImpl::makeAlterScript),
                   DECLARE_MODULE_FUNCTION(DbMySQLImpl::getKnownEngines),
                   DECLARE_MODULE_FUNCTION(DbMySQLImpl::getDefaultUserDatatypes),
-                  DECLARE_MODULE_FUNCTION(DbMySQLImpl::getDefaultColumnValueMappings));
+                  DECLARE_MODULE_FUNCTION(DbMySQLImpl::getDefaultColumnValueMappings),
+                  DECLARE_MODULE_FUNCTION_DOC(DbMySQLImpl::reverseEngineerObjects,
+                                              "Fetches the DDL of the given objects over several connections and parses it into the catalog. "
+                                              "Returns the number of parse errors.",
+                                              "connection the connection to the server to reverse engineer\n"
+                                              "catalog the catalog to add the objects to\n"
+                                              "schemata the names of the schemas to process, in the order they are added to the catalog\n"
+                                              "objects a dict per schema name, with lists of object names for the keys tables (incl. views), triggers, procedures and functions\n"
+                                              "options serverVersion and sqlMode for the parser, optionally connections (how many to use) and password"));
 
   virtual std::string getTargetDBMSName()
   {
@@ -298,6 +312,12 @@ public:
   grt::ListRef<db_UserDatatype> getDefaultUserDatatypes(db_mgmt_RdbmsRef rdbms);
 
   grt::DictRef getDefaultColumnValueMappings() { return grt::DictRef(get_grt()); }
+
+  /**
+   * parallel reverse engineering of a list of schema objects, see ParallelReverseEngineer
+   */
+  int reverseEngineerObjects(db_mgmt_ConnectionRef connection, db_mysql_CatalogRef catalog,
+                             grt::StringListRef schemata, grt::DictRef objects, grt::DictRef options);
   
   grt::DictRef getDefaultTraits() const {return _default_traits;};
   
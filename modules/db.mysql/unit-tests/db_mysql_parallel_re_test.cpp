@@ -0,0 +1,134 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include "wb_helpers.h"
+
+#include "grtpp.h"
+#include "grtsqlparser/mysql_parser_services.h"
+#include "db_mysql_parallel_re.h"
+
+using namespace parser;
+
+BEGIN_TEST_DATA_CLASS(db_mysql_parallel_re_test)
+protected:
+  WBTester _tester;
+  MySQLParserServices::Ref _services;
+  ParserContext::Ref _context;
+  GrtVersionRef _version;
+
+  TEST_DATA_CONSTRUCTOR(db_mysql_parallel_re_test)
+  {
+    populate_grt(_tester.grt, _tester);
+
+    _services = MySQLParserServices::get(_tester.grt);
+    _version = GrtVersionRef(_tester.grt);
+    _version->majorNumber(5);
+    _version->minorNumber(6);
+    _version->releaseNumber(20);
+    _context = MySQLParserServices::createParserContext(_tester.get_rdbms()->characterSets(), _version, true);
+  }
+
+  db_mysql_CatalogRef create_catalog()
+  {
+    db_mysql_CatalogRef catalog(_tester.grt);
+    catalog->version(_version);
+    grt::replace_contents(catalog->simpleDatatypes(), _tester.get_rdbms()->simpleDatatypes());
+    return catalog;
+  }
+
+  // Parses the sql into a new part catalog, like a work unit does with the DDL it fetched.
+  db_mysql_CatalogRef parse_part(ParallelReverseEngineer &engine, const std::string &sql)
+  {
+    db_mysql_CatalogRef part = engine.create_part_catalog();
+    grt::DictRef options(_tester.grt);
+    options.set("schema", grt::StringRef("sakila"));
+    ensure_equals("Parse errors", _services->parseSQLIntoCatalog(_context, part, sql, options), (size_t)0);
+    return part;
+  }
+
+END_TEST_DATA_CLASS
+
+TEST_MODULE(db_mysql_parallel_re_test, "parallel reverse engineering");
+
+// Objects referencing tables of another unit must end up referencing the real tables after the merge.
+TEST_FUNCTION(5)
+{
+  db_mysql_CatalogRef catalog = create_catalog();
+  ParallelReverseEngineer engine(catalog, _version, "");
+
+  db_mysql_CatalogRef part1 = parse_part(engine, "USE sakila;\n"
+    "CREATE TABLE city (city_id int NOT NULL, country_id int NOT NULL, PRIMARY KEY (city_id), "
+    "CONSTRAINT fk_city_country FOREIGN KEY (country_id) REFERENCES country (country_id))");
+  db_mysql_CatalogRef part2 = parse_part(engine, "USE sakila;\n"
+    "CREATE TABLE country (country_id int NOT NULL, country varchar(50), PRIMARY KEY (country_id))");
+  db_mysql_CatalogRef part3 = parse_part(engine, "USE sakila;\nDELIMITER $$\n"
+    "CREATE TRIGGER city_insert BEFORE INSERT ON city FOR EACH ROW SET NEW.city_id = NEW.city_id + 1");
+
+  // The first part has a stub for country, the third one a stub for city.
+  ensure_equals("Tables in part 1", part1->schemata()[0]->tables().count(), (size_t)2);
+  ensure("Stub table in part 1", part1->schemata()[0]->tables()[1]->isStub() != 0);
+  ensure("Stub table in part 3", part3->schemata()[0]->tables()[0]->isStub() != 0);
+
+  engine.merge_catalog(part1);
+  engine.merge_catalog(part2);
+  engine.merge_catalog(part3);
+  engine.resolve_stub_references();
+
+  ensure_equals("Schemas", catalog->schemata().count(), (size_t)1);
+  db_mysql_SchemaRef schema = catalog->schemata()[0];
+  ensure_equals("Schema name", *schema->name(), "sakila");
+  ensure_equals("Tables", schema->tables().count(), (size_t)2);
+
+  db_mysql_TableRef city = schema->tables()[0];
+  db_mysql_TableRef country = schema->tables()[1];
+  ensure_equals("First table", *city->name(), "city");
+  ensure_equals("Second table", *country->name(), "country");
+  ensure("Real tables", !city->isStub() && !country->isStub());
+  ensure("Table owners", city->owner() == schema && country->owner() == schema);
+
+  ensure_equals("Foreign keys", city->foreignKeys().count(), (size_t)1);
+  db_mysql_ForeignKeyRef fk = city->foreignKeys()[0];
+  ensure("Referenced table", fk->referencedTable() == country);
+  ensure_equals("Referenced columns", fk->referencedColumns().count(), (size_t)1);
+  ensure("Referenced column", fk->referencedColumns()[0] == country->columns()[0]);
+
+  ensure_equals("Triggers", city->triggers().count(), (size_t)1);
+  ensure("Trigger owner", city->triggers()[0]->owner() == city);
+}
+
+// A foreign key to a stub whose columns don't exist in the real table is removed.
+TEST_FUNCTION(10)
+{
+  db_mysql_CatalogRef catalog = create_catalog();
+  ParallelReverseEngineer engine(catalog, _version, "");
+
+  engine.merge_catalog(parse_part(engine, "USE sakila;\n"
+    "CREATE TABLE city (city_id int NOT NULL, country_id int NOT NULL, PRIMARY KEY (city_id), "
+    "CONSTRAINT fk_city_country FOREIGN KEY (country_id) REFERENCES country (id))"));
+  engine.merge_catalog(parse_part(engine, "USE sakila;\n"
+    "CREATE TABLE country (country_id int NOT NULL, PRIMARY KEY (country_id))"));
+  engine.resolve_stub_references();
+
+  db_mysql_SchemaRef schema = catalog->schemata()[0];
+  ensure_equals("Tables", schema->tables().count(), (size_t)2);
+  ensure("Real table", !schema->tables()[1]->isStub());
+  ensure_equals("Foreign keys", schema->tables()[0]->foreignKeys().count(), (size_t)0);
+}
+
+END_TESTS
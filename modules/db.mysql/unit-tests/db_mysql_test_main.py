@@ -0,0 +1,77 @@
+# Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License as
+# published by the Free Software Foundation; version 2 of the
+# License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+# 02110-1301  USA
+
+import os
+import sys
+import glob
+import unittest
+
+import grt
+
+try:
+    import coverage
+except ImportError:
+    has_coverage = False
+else:
+    has_coverage = True
+
+CURRENT_DIR = os.path.abspath(os.path.dirname(__file__))
+SRC_DIR = os.path.abspath(os.path.join(CURRENT_DIR, '../../../'))
+
+def get_rdbms():
+    for rdbms in grt.root.wb.rdbmsMgmt.rdbms:
+        if rdbms.name == 'Mysql':
+            return rdbms
+    return None
+
+def create_connection():
+    """Returns a connection object for the MySQL driver. It is never opened, the tests register
+    their own connections with canned results for it."""
+    rdbms = get_rdbms()
+    conn = None
+    if rdbms:
+        conn = grt.classes.db_mgmt_Connection()
+        conn.driver = rdbms.defaultDriver
+        conn.name = 'canned:3306'
+        conn.hostIdentifier = 'Mysql@' + conn.name
+    return conn
+
+class MySQLTestCase(unittest.TestCase):
+    connection = create_connection()
+
+if __name__ == '__main__':
+    if has_coverage:
+        cov = coverage.coverage()
+        cov.start()
+
+    os.chdir(CURRENT_DIR)
+    sys.path[:0] = [ CURRENT_DIR, os.path.join(SRC_DIR, 'modules/db.mysql'), os.path.join(SRC_DIR, 'library/python') ]
+
+    suite = unittest.TestSuite()
+    names = [ os.path.splitext(fname)[0] for fname in glob.glob("test_*.py") ]
+    suite.addTest(unittest.defaultTestLoader.loadTestsFromNames(names))
+
+    result = unittest.TextTestRunner(stream=open(os.path.join(SRC_DIR, 'testing/python/test_results_db.mysql.txt'), 'w'), verbosity=2).run(suite)
+
+    if has_coverage:
+        cov.stop()
+        report_file = open(os.path.join(SRC_DIR, 'testing/python/coverage_db_mysql_report.txt'), 'a')
+        cov.report(file=report_file)
+        report_file.write('\n\n')
+
+    if not result.wasSuccessful():
+        sys.exit(1)
@@ -21,6 +21,8 @@
 #include "grt_test_utility.h"
 #include "grt/grt_manager.h"
 #include "grtpp.h"
+#include "base/file_functions.h"
+#include "base/string_utilities.h"
 #include "synthetic_mysql_model.h"
 #include "grtdb/diff_dbobjectmatch.h"
 #include "interfaces/sqlgenerator.h"
@@ -30,6 +32,7 @@
 #include "db_mysql_diffsqlgen.h"
 
 #include "grtsqlparser/mysql_parser_services.h"
+#include "grtsqlparser/sql_facade.h"
 
 BEGIN_TEST_DATA_CLASS(sql_create)
 protected:
@@ -551,4 +554,135 @@ TEST_FUNCTION(70)
   tester.wb->close_document_finish();
 }
 
+// The script written straight to a file must be the same as the one returned in OutputScript.
+TEST_FUNCTION(80)
+{
+  tester.wb->open_document("data/forward_engineer/sakila_full.mwb");
+  db_mysql_CatalogRef catalog = db_mysql_CatalogRef::cast_from(tester.get_catalog());
+
+  grt::DictRef options = DictRef::cast_from(tester.grt->unserialize("data/forward_engineer/rename_opts.dict"));
+  options.set("GenerateDocumentProperties", grt::IntegerRef(0));
+  options.set("GenerateDrops", grt::IntegerRef(1));
+  options.set("OutputScriptHeader", grt::StringRef("-- header\n"));
+
+  DictRef create_map = diffsql_module->generateSQLForDifferences(GrtNamedObjectRef(), catalog, options);
+  DictRef drop_map = diffsql_module->generateSQLForDifferences(catalog, GrtNamedObjectRef(), options);
+
+  ensure_equals("Export to string", diffsql_module->makeSQLExportScript(catalog, options, create_map, drop_map), 0);
+  std::string export_sql_script = options.get_string("OutputScriptHeader") + options.get_string("OutputScript");
+  size_t customer = export_sql_script.find("`customer` (");
+  size_t rental = export_sql_script.find("`rental` (");
+  ensure("CREATE TABLE in script", customer != std::string::npos && rental != std::string::npos);
+  ensure("Referenced table created first", customer < rental);
+
+  std::string filename = "sql_create_test_output.sql";
+  options.remove("OutputScript");
+  options.set("OutputFileName", grt::StringRef(filename));
+  ensure_equals("Export to file", diffsql_module->makeSQLExportScript(catalog, options, create_map, drop_map), 0);
+  ensure("No OutputScript for file export", !options.has_key("OutputScript"));
+
+  gchar *contents = NULL;
+  gsize length = 0;
+  ensure("Script file written", g_file_get_contents(filename.c_str(), &contents, &length, NULL) != 0);
+  std::string file_script(contents, length);
+  g_free(contents);
+  base_remove(filename);
+
+  ensure_equals("File script", file_script, export_sql_script);
+
+  tester.wb->close_document();
+  tester.wb->close_document_finish();
+}
+
+// Tables with foreign keys between them, with columns and indexes depending on the version. The modified version
+// changes every table, so a diff between the two alters all of them.
+static std::string many_tables_script(size_t count, bool modified)
+{
+  std::string script = "CREATE DATABASE IF NOT EXISTS many_tables;\nUSE many_tables;\n";
+  for (size_t i = 0; i < count; ++i)
+  {
+    script += base::strfmt("CREATE TABLE t%u (\n  id INT NOT NULL AUTO_INCREMENT,\n  name VARCHAR(%u) NULL,\n"
+      "  parent_id INT NULL,\n", (unsigned)i, modified ? 100 : 45);
+    if (modified)
+      script += "  created DATETIME NULL COMMENT 'added',\n";
+    script += "  PRIMARY KEY (id),\n  INDEX idx_name (name)";
+    if (i > 0)
+      script += base::strfmt(",\n  CONSTRAINT fk_t%u_parent FOREIGN KEY (parent_id) REFERENCES t%u (id)",
+        (unsigned)i, (unsigned)(i - 1));
+    script += base::strfmt("\n) ENGINE = InnoDB COMMENT = '%s table %u';\n", modified ? "changed" : "original",
+      (unsigned)i);
+  }
+  return script;
+}
+
+// The SQL for many tables is generated in parallel jobs (in chunks of 16 tables per schema). The result must be
+// exactly the same as generating it serially: the export map and script as well as the statement list used
+// for synchronization.
+TEST_FUNCTION(90)
+{
+  SqlFacade *parser = SqlFacade::instance_for_rdbms_name(tester.grt, "Mysql");
+  db_mysql_CatalogRef org_catalog = create_empty_catalog_for_import(tester.grt);
+  db_mysql_CatalogRef catalog = create_empty_catalog_for_import(tester.grt);
+  parser->parseSqlScriptString(org_catalog, many_tables_script(100, false));
+  parser->parseSqlScriptString(catalog, many_tables_script(100, true));
+  ensure_equals("Table count", catalog->schemata()[0]->tables().count(), (size_t)100);
+
+  // Export (map mode).
+  std::string scripts[2];
+  DictRef create_maps[2];
+  for (int parallel = 0; parallel < 2; ++parallel)
+  {
+    grt::DictRef options = DictRef::cast_from(tester.grt->unserialize("data/forward_engineer/rename_opts.dict"));
+    options.set("GenerateDocumentProperties", grt::IntegerRef(0));
+    options.set("GenerateDrops", grt::IntegerRef(1));
+    options.set("UseParallelJobs", grt::IntegerRef(parallel));
+
+    create_maps[parallel] = diffsql_module->generateSQLForDifferences(GrtNamedObjectRef(), catalog, options);
+    DictRef drop_map = diffsql_module->generateSQLForDifferences(catalog, GrtNamedObjectRef(), options);
+    ensure_equals("Export", diffsql_module->makeSQLExportScript(catalog, options, create_maps[parallel], drop_map), 0);
+    scripts[parallel] = options.get_string("OutputScript");
+  }
+
+  ensure_equals("Create map size", create_maps[1].count(), create_maps[0].count());
+  for (grt::DictRef::const_iterator iterator = create_maps[0].begin(); iterator != create_maps[0].end(); ++iterator)
+  {
+    ensure(iterator->first + " in parallel create map", create_maps[1].has_key(iterator->first));
+    ensure_equals(iterator->first, create_maps[1].get(iterator->first).repr(), iterator->second.repr());
+  }
+  ensure("All tables exported", scripts[0].find("`t99`") != std::string::npos);
+  ensure_equals("Export script", scripts[1], scripts[0]);
+
+  // Synchronization (list mode), altering all tables.
+  NormalizedComparer cmp(tester.grt);
+  grt::DbObjectMatchAlterOmf omf;
+  cmp.init_omf(&omf);
+  boost::shared_ptr<DiffChange> alter_change = diff_make(org_catalog, catalog, &omf);
+  ensure("Catalogs differ", alter_change.get() != NULL);
+
+  grt::StringListRef lists[2];
+  grt::ListRef<GrtNamedObject> objects[2];
+  for (int parallel = 0; parallel < 2; ++parallel)
+  {
+    lists[parallel] = grt::StringListRef(tester.grt);
+    objects[parallel] = grt::ListRef<GrtNamedObject>(tester.grt);
+
+    grt::DictRef options(tester.grt);
+    options.set("UseFilteredLists", grt::IntegerRef(0));
+    options.set("OutputContainer", lists[parallel]);
+    options.set("OutputObjectContainer", objects[parallel]);
+    options.set("CaseSensitive", grt::IntegerRef(omf.case_sensitive));
+    options.set("UseParallelJobs", grt::IntegerRef(parallel));
+    diffsql_module->generateSQL(org_catalog, options, alter_change);
+  }
+
+  ensure("Tables altered", lists[0].count() >= 100);
+  ensure_equals("Sync statement count", lists[1].count(), lists[0].count());
+  ensure_equals("Sync object count", objects[1].count(), objects[0].count());
+  for (size_t i = 0; i < lists[0].count(); ++i)
+  {
+    ensure_equals(base::strfmt("Sync statement %u", (unsigned)i), *lists[1][i], *lists[0][i]);
+    ensure(base::strfmt("Sync object %u", (unsigned)i), objects[1][i] == objects[0][i]);
+  }
+}
+
 END_TESTS
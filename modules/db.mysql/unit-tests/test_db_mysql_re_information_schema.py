@@ -0,0 +1,273 @@
+# Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+#
+# This program is free software; you can redistribute it and/or
+# modify it under the terms of the GNU General Public License as
+# published by the Free Software Foundation; version 2 of the
+# License.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program; if not, write to the Free Software
+# Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+# 02110-1301  USA
+
+import re
+import unittest
+
+import db_mysql_test_main
+import grt
+
+import db_mysql_re_grt
+
+# Canned information_schema result sets, per queried table. Rows are in the order the queries ask for.
+canned_rows = {
+    'COLLATIONS' : [
+        ['utf8_general_ci', 'utf8', 'Yes'],
+        ['utf8_bin', 'utf8', ''],
+        ['latin1_swedish_ci', 'latin1', 'Yes'],
+    ],
+    # TABLE_SCHEMA, TABLE_NAME, TABLE_TYPE, ENGINE, AUTO_INCREMENT, TABLE_COLLATION, CREATE_OPTIONS, TABLE_COMMENT
+    'TABLES' : [
+        ['shop', 'customer', 'BASE TABLE', 'InnoDB', '5', 'utf8_general_ci', 'row_format=DYNAMIC', 'Customers'],
+        ['shop', 'orders', 'BASE TABLE', 'InnoDB', None, 'latin1_swedish_ci', '', ''],
+        ['shop', 'order_item', 'BASE TABLE', 'InnoDB', None, 'latin1_swedish_ci', '', ''],
+        ['shop', 'log', 'BASE TABLE', 'InnoDB', None, 'latin1_swedish_ci', 'partitioned', ''],
+        ['shop', 'v', 'VIEW', None, None, None, None, 'VIEW'],
+        ['shop', 'fn_index', 'BASE TABLE', 'InnoDB', None, 'latin1_swedish_ci', '', ''],
+        ['shop', 'generated', 'BASE TABLE', 'InnoDB', None, 'latin1_swedish_ci', '', ''],
+        ['shop', 'not_requested', 'BASE TABLE', 'InnoDB', None, 'latin1_swedish_ci', '', ''],
+    ],
+    # TABLE_SCHEMA, TABLE_NAME, COLUMN_NAME, COLUMN_TYPE, IS_NULLABLE, COLUMN_DEFAULT, EXTRA, COLLATION_NAME, COLUMN_COMMENT
+    'COLUMNS' : [
+        ['shop', 'customer', 'id', 'int(10) unsigned', 'NO', None, 'auto_increment', None, ''],
+        ['shop', 'customer', 'name', 'varchar(45)', 'NO', None, '', 'utf8_bin', 'Full name'],
+        ['shop', 'customer', 'email', 'varchar(100)', 'YES', None, '', 'utf8_general_ci', ''],
+        ['shop', 'customer', 'created', 'timestamp', 'NO', 'CURRENT_TIMESTAMP', 'on update CURRENT_TIMESTAMP', None, ''],
+        ['shop', 'fn_index', 'id', 'int(11)', 'NO', None, '', None, ''],
+        ['shop', 'generated', 'id', 'int(11)', 'NO', None, '', None, ''],
+        ['shop', 'generated', 'double_id', 'int(11)', 'YES', None, 'VIRTUAL GENERATED', None, ''],
+        ['shop', 'log', 'id', 'int(11)', 'NO', None, '', None, ''],
+        ['shop', 'order_item', 'order_id', 'int(11)', 'NO', None, '', None, ''],
+        ['shop', 'order_item', 'line', 'int(11)', 'NO', None, '', None, ''],
+        ['shop', 'order_item', 'qty', 'int(11)', 'NO', '1', '', None, ''],
+        ['shop', 'orders', 'id', 'int(11)', 'NO', None, 'auto_increment', None, ''],
+        ['shop', 'orders', 'customer_id', 'int(10) unsigned', 'NO', None, '', None, ''],
+        ['shop', 'orders', 'product_id', 'int(11)', 'YES', None, '', None, ''],
+        ['shop', 'orders', 'total', 'decimal(10,2)', 'NO', '0.00', '', None, ''],
+    ],
+    # TABLE_SCHEMA, TABLE_NAME, INDEX_NAME, NON_UNIQUE, SEQ_IN_INDEX, COLUMN_NAME, SUB_PART, COLLATION, INDEX_TYPE, INDEX_COMMENT
+    'STATISTICS' : [
+        ['shop', 'customer', 'PRIMARY', '0', '1', 'id', None, 'A', 'BTREE', ''],
+        ['shop', 'customer', 'email_UNIQUE', '0', '1', 'email', None, 'A', 'BTREE', ''],
+        ['shop', 'customer', 'idx_name', '1', '1', 'name', '10', 'A', 'BTREE', 'Name prefix'],
+        ['shop', 'customer', 'idx_created', '1', '1', 'created', None, 'D', 'BTREE', ''],
+        ['shop', 'fn_index', 'idx_expression', '1', '1', None, None, 'A', 'BTREE', ''],
+        ['shop', 'log', 'PRIMARY', '0', '1', 'id', None, 'A', 'BTREE', ''],
+        # Columns of an index don't necessarily come in sequence.
+        ['shop', 'order_item', 'PRIMARY', '0', '2', 'line', None, 'A', 'BTREE', ''],
+        ['shop', 'order_item', 'PRIMARY', '0', '1', 'order_id', None, 'A', 'BTREE', ''],
+        ['shop', 'orders', 'PRIMARY', '0', '1', 'id', None, 'A', 'BTREE', ''],
+    ],
+    # TABLE_SCHEMA, TABLE_NAME, CONSTRAINT_NAME, COLUMN_NAME, REFERENCED_TABLE_SCHEMA, REFERENCED_TABLE_NAME,
+    # REFERENCED_COLUMN_NAME, UPDATE_RULE, DELETE_RULE
+    'KEY_COLUMN_USAGE' : [
+        ['shop', 'order_item', 'fk_item_order', 'order_id', 'shop', 'orders', 'id', 'NO ACTION', 'NO ACTION'],
+        ['shop', 'orders', 'fk_orders_customer', 'customer_id', 'shop', 'customer', 'id', 'RESTRICT', 'CASCADE'],
+        ['shop', 'orders', 'fk_orders_product', 'product_id', 'stock', 'product', 'id', 'NO ACTION', 'SET NULL'],
+    ],
+    # TRIGGER_SCHEMA, TRIGGER_NAME, EVENT_OBJECT_TABLE, ACTION_TIMING, EVENT_MANIPULATION, ACTION_STATEMENT, DEFINER, ACTION_ORDER
+    'TRIGGERS' : [
+        ['shop', 'customer_bi', 'customer', 'BEFORE', 'INSERT', 'SET NEW.name = TRIM(NEW.name)', 'root@localhost', '1'],
+        ['shop', 'customer_bi2', 'customer', 'BEFORE', 'INSERT', 'SET NEW.email = LOWER(NEW.email)', 'root@localhost', '2'],
+        ['shop', 'log_ai', 'log', 'AFTER', 'INSERT', 'SET @count = @count + 1', 'root@localhost', '1'],
+    ],
+}
+
+
+class CannedResult(object):
+    def __init__(self, rows):
+        self.rows = rows
+        self.row = -1
+
+    def nextRow(self):
+        self.row += 1
+        return self.row < len(self.rows)
+
+    def stringByIndex(self, index):
+        return self.rows[self.row][index - 1]
+
+
+class CannedConnection(object):
+    """Answers the information_schema queries with the canned rows and records the queries."""
+    def __init__(self):
+        self.queries = []
+
+    def executeQuery(self, query):
+        self.queries.append(query)
+        table = re.search(r"FROM information_schema\.(\w+)", query).group(1)
+        return CannedResult(canned_rows[table])
+
+
+class TestReverseEngineerFromInformationSchema(db_mysql_test_main.MySQLTestCase):
+    def setUp(self):
+        self.canned_connection = CannedConnection()
+        db_mysql_re_grt._connections[self.connection.__id__] = self.canned_connection
+
+        rdbms = db_mysql_test_main.get_rdbms()
+        version = grt.classes.GrtVersion()
+        version.majorNumber, version.minorNumber, version.releaseNumber, version.buildNumber = 5, 6, 20, -1
+
+        self.catalog = grt.classes.db_mysql_Catalog()
+        self.catalog.name = 'def'
+        self.catalog.version = version
+        self.catalog.simpleDatatypes.extend(rdbms.simpleDatatypes)
+
+        table_names = { 'shop' : ['customer', 'orders', 'order_item', 'log', 'v', 'fn_index', 'generated'] }
+        trigger_names = { 'shop' : ['customer_bi', 'customer_bi2', 'log_ai'] }
+        self.remaining_tables, self.remaining_triggers = db_mysql_re_grt.reverseEngineerFromInformationSchema(
+            self.connection, self.catalog, ['shop'], table_names, trigger_names)
+        self.schema = self.catalog.schemata[0]
+
+    def tearDown(self):
+        del db_mysql_re_grt._connections[self.connection.__id__]
+
+    def table(self, name, schema_name='shop'):
+        return find_object(find_object(self.catalog.schemata, schema_name).tables, name)
+
+    def test_queries(self):
+        self.assertEqual(len(self.canned_connection.queries), 6)
+        for query in self.canned_connection.queries[1:]:
+            self.assertTrue("IN ('shop')" in query, query)
+
+    def test_remaining_objects(self):
+        # Views, partitioned tables, functional indices and generated columns need the DDL.
+        self.assertEqual(self.remaining_tables, { 'shop' : ['log', 'v', 'fn_index', 'generated'] })
+        # Triggers with an action order > 1 and triggers of tables left out, too.
+        self.assertEqual(self.remaining_triggers, { 'shop' : ['customer_bi2', 'log_ai'] })
+
+    def test_tables(self):
+        self.assertEqual([table.name for table in self.schema.tables], ['customer', 'orders', 'order_item'])
+
+        customer = self.table('customer')
+        self.assertEqual(customer.tableEngine, 'InnoDB')
+        self.assertEqual(customer.nextAutoInc, '5')
+        self.assertEqual(customer.defaultCharacterSetName, 'utf8')
+        self.assertEqual(customer.defaultCollationName, '')
+        self.assertEqual(customer.rowFormat, 'DYNAMIC')
+        self.assertEqual(customer.comment, 'Customers')
+        self.assertEqual(customer.oldName, 'customer')
+        self.assertEqual(self.table('orders').defaultCharacterSetName, 'latin1')
+        self.assertEqual(self.table('orders').nextAutoInc, '')
+
+    def test_columns(self):
+        customer = self.table('customer')
+        self.assertEqual([column.name for column in customer.columns], ['id', 'name', 'email', 'created'])
+
+        id_column, name, email, created = customer.columns
+        self.assertEqual(id_column.simpleType.name, 'INT')
+        self.assertEqual(list(id_column.flags), ['UNSIGNED'])
+        self.assertEqual(id_column.autoIncrement, 1)
+        self.assertEqual(id_column.isNotNull, 1)
+        self.assertEqual(id_column.defaultValue, '')
+
+        self.assertEqual(name.simpleType.name, 'VARCHAR')
+        self.assertEqual(name.length, 45)
+        self.assertEqual(name.characterSetName, 'utf8')
+        self.assertEqual(name.collationName, 'utf8_bin')
+        self.assertEqual(name.comment, 'Full name')
+
+        # Same collation as the table, so no charset. Nullable without default means DEFAULT NULL.
+        self.assertEqual(email.characterSetName, '')
+        self.assertEqual(email.isNotNull, 0)
+        self.assertEqual(email.defaultValue, 'NULL')
+        self.assertEqual(email.defaultValueIsNull, 1)
+
+        self.assertEqual(created.simpleType.name, 'TIMESTAMP')
+        self.assertEqual(created.defaultValue, 'CURRENT_TIMESTAMP ON UPDATE CURRENT_TIMESTAMP')
+        self.assertEqual(created.defaultValueIsNull, 0)
+
+        total = find_object(self.table('orders').columns, 'total')
+        self.assertEqual(total.simpleType.name, 'DECIMAL')
+        self.assertEqual((total.precision, total.scale), (10, 2))
+        self.assertEqual(total.defaultValue, "'0.00'")
+
+    def test_indices(self):
+        customer = self.table('customer')
+        self.assertEqual([index.name for index in customer.indices], ['PRIMARY', 'email_UNIQUE', 'idx_name', 'idx_created'])
+
+        primary, unique, prefix, descending = customer.indices
+        self.assertEqual(customer.primaryKey, primary)
+        self.assertEqual((primary.isPrimary, primary.indexType), (1, 'PRIMARY'))
+        self.assertEqual((unique.unique, unique.indexType), (1, 'UNIQUE'))
+        self.assertEqual((prefix.unique, prefix.indexType), (0, 'INDEX'))
+        self.assertEqual(prefix.comment, 'Name prefix')
+        self.assertEqual(prefix.columns[0].referencedColumn.name, 'name')
+        self.assertEqual(prefix.columns[0].columnLength, 10)
+        self.assertEqual(prefix.columns[0].descend, 0)
+        self.assertEqual(descending.columns[0].descend, 1)
+
+        # Columns are sorted by their position in the index.
+        order_item = self.table('order_item')
+        self.assertEqual([column.referencedColumn.name for column in order_item.primaryKey.columns], ['order_id', 'line'])
+        for column in order_item.primaryKey.columns:
+            self.assertEqual(column.referencedColumn.owner, order_item)
+
+    def test_foreign_keys(self):
+        orders = self.table('orders')
+        self.assertEqual([fk.name for fk in orders.foreignKeys], ['fk_orders_customer', 'fk_orders_product'])
+
+        to_customer, to_product = orders.foreignKeys
+        self.assertEqual(to_customer.referencedTable, self.table('customer'))
+        self.assertEqual([column.name for column in to_customer.columns], ['customer_id'])
+        self.assertEqual(to_customer.referencedColumns[0], self.table('customer').columns[0])
+        # RESTRICT is what InnoDB uses if there's no rule in the DDL, so the parser doesn't set it either.
+        self.assertEqual(to_customer.updateRule, '')
+        self.assertEqual(to_customer.deleteRule, 'CASCADE')
+
+        # Foreign keys without a matching index get one, named after the foreign key.
+        self.assertEqual(to_customer.index.name, 'fk_orders_customer')
+        self.assertEqual(to_customer.index.indexType, 'INDEX')
+        self.assertEqual([column.referencedColumn.name for column in to_customer.index.columns], ['customer_id'])
+        self.assertEqual([index.name for index in orders.indices], ['PRIMARY', 'fk_orders_customer', 'fk_orders_product'])
+
+        # References to tables outside of the reverse engineered ones point to stubs.
+        product = self.table('product', 'stock')
+        self.assertEqual(to_product.referencedTable, product)
+        self.assertEqual(product.isStub, 1)
+        self.assertEqual(to_product.updateRule, 'NO ACTION')
+        self.assertEqual(to_product.deleteRule, 'SET NULL')
+        self.assertEqual([column.name for column in product.columns], ['id'])
+        self.assertEqual(product.columns[0].simpleType.name, 'INT')
+        self.assertEqual(to_product.referencedColumns[0], product.columns[0])
+
+        # An index starting with the foreign key columns is used for the foreign key.
+        order_item = self.table('order_item')
+        to_order = order_item.foreignKeys[0]
+        self.assertEqual(to_order.referencedTable, orders)
+        self.assertEqual(to_order.index, order_item.primaryKey)
+        self.assertEqual(len(order_item.indices), 1)
+
+    def test_triggers(self):
+        customer = self.table('customer')
+        self.assertEqual([trigger.name for trigger in customer.triggers], ['customer_bi'])
+
+        trigger = customer.triggers[0]
+        self.assertEqual((trigger.timing, trigger.event, trigger.enabled), ('BEFORE', 'INSERT', 1))
+        self.assertEqual(trigger.definer, '`root`@`localhost`')
+        self.assertEqual(trigger.sqlDefinition, 'CREATE DEFINER=`root`@`localhost` TRIGGER `customer_bi` BEFORE INSERT '
+                         'ON `customer` FOR EACH ROW SET NEW.name = TRIM(NEW.name)')
+
+
+def find_object(objects, name):
+    for obj in objects:
+        if obj.name == name:
+            return obj
+    return None
+
+
+if __name__ == '__main__':
+    unittest.main()
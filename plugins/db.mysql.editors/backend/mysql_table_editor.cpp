@@ -1694,7 +1694,7 @@ void MySQLTableEditorBE::set_table_option_by_name(const std::string& name, const
           }
 
           if ("ENGINE" == name)
-            bec::ValidationManager::validate_instance(get_table(), "chk_fk_lgc");
+            bec::ValidationManager::validate_changes(get_table(), "chk_fk_lgc");
         }
       }
       found= true;
@@ -54,6 +54,7 @@ DbMySQLSQLExport::DbMySQLSQLExport(bec::GRTManager *grtm, db_mysql_CatalogRef ca
   _case_sensitive = true;
   _gen_doc_props = false;
   _gen_attached_scripts = false;
+  _script_in_file = false;
 
   if(!_catalog.is_valid())
     _catalog= get_model_catalog();  // call own version
@@ -260,6 +261,28 @@ void DbMySQLSQLExport::start_export(bool wait_finish)
 
 //--------------------------------------------------------------------------------------------------
 
+/**
+ * Returns the generated script. If it was streamed to the output file it is only loaded from there
+ * when actually needed (e.g. for the preview).
+ */
+std::string DbMySQLSQLExport::export_sql_script()
+{
+  if (_script_in_file)
+  {
+    gchar *contents = NULL;
+    gsize length = 0;
+    if (g_file_get_contents(_output_filename.c_str(), &contents, &length, NULL))
+    {
+      _export_sql_script.assign(contents, length);
+      g_free(contents);
+    }
+    _script_in_file = false;
+  }
+  return _export_sql_script;
+}
+
+//--------------------------------------------------------------------------------------------------
+
 void DbMySQLSQLExport::export_finished(grt::ValueRef res)
 {
   CatalogMap cmap;
@@ -317,22 +340,26 @@ ValueRef DbMySQLSQLExport::export_task(grt::GRT* grt, grt::StringRef)
     if (_db_options.is_valid())
       _db_options.set("CaseSensitive", grt::IntegerRef(_case_sensitive));
 
+    // With an output file the script is streamed straight to it instead of being kept in memory.
+    _export_sql_script.clear();
+    _script_in_file = !_output_filename.empty();
+    if (_script_in_file)
+      options.set("OutputFileName", grt::StringRef(_output_filename));
+
     if (diffsql_module->makeSQLExportScript(_catalog, options, create_map, drop_map))
     {
+      _script_in_file = false;
       return grt::StringRef("\nSQL Script Export Error: SQL Script Export Module Returned Error");
     }
     
-    _export_sql_script= options.get_string("OutputScriptHeader") + options.get_string("OutputScript");
+    if (!_script_in_file)
+      _export_sql_script= options.get_string("OutputScriptHeader") + options.get_string("OutputScript");
 
-    if (!_output_filename.empty())
-    {
-      g_file_set_contents(_output_filename.c_str(), 
-                          _export_sql_script.c_str(), (gssize)_export_sql_script.size(), NULL);
-    }
     return StringRef("\nSQL Script Export Completed");
   }
   catch(std::exception& ex)
   {
+    _script_in_file = false;
     if(ex.what())
     {
       return grt::StringRef(std::string("\nSQL Script Export Error: ").append(ex.what()).c_str());
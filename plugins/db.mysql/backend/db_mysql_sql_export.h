@@ -117,13 +117,14 @@ public:
                                                  bec::GrtStringListModel **triggers_model,
                                                  bec::GrtStringListModel **triggers_exc_model);
 
-  std::string export_sql_script() { return _export_sql_script; }
+  std::string export_sql_script();
 
 private:
   //Validation_finished_cb _validation_finished_cb;
   //Validation_step_finished_cb _validation_step_finished_cb;
   Task_finish_cb _task_finish_cb;
   std::string _export_sql_script;
+  bool _script_in_file;
 };
 
 
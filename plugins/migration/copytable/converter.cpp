@@ -24,6 +24,13 @@
 #include "base/string_utilities.h"
 #include <string>
 #include <cstdlib>
+#include <cstring>
+#include <algorithm>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #include <emmintrin.h>
+  #define HAVE_SSE2_KERNELS 1
+#endif
 
 DEFAULT_LOG_DOMAIN("copytable");
 
@@ -174,3 +181,322 @@ void BaseConverter::convert_date_time(const char* source, MYSQL_TIME* target, in
     break;
   }
 }
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Reads count decimal digits. Returns false if any of them is not a digit.
+ */
+static inline bool read_digits(const char* source, int count, unsigned int &value)
+{
+  unsigned int result = 0;
+  for (int i = 0; i < count; ++i)
+  {
+    unsigned int digit = (unsigned char)source[i] - '0';
+    if (digit > 9)
+      return false;
+    result = result * 10 + digit;
+  }
+  value = result;
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Reads a fractional second part, scaled to microseconds the same way as the generic converters
+ * (only the first 6 digits are used). The whole part must consist of digits.
+ */
+static inline bool read_fraction(const char* source, size_t length, unsigned long &value)
+{
+  unsigned long result = 0;
+  size_t i = 0;
+  for (; i < length; ++i)
+  {
+    unsigned int digit = (unsigned char)source[i] - '0';
+    if (digit > 9)
+      return false;
+    if (i < 6)
+      result = result * 10 + digit;
+  }
+  for (; i < 6; ++i)
+    result *= 10;
+  value = result;
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fixed format parser for the ISO layout. Returns false if the value is not in that layout,
+ * in which case the caller has to use the generic conversion.
+ */
+bool BaseConverter::parse_iso_date_time(const char* source, size_t length, MYSQL_TIME* target, int type)
+{
+  unsigned int year, month, day, hour, minute, second;
+  unsigned long fraction = 0;
+
+  switch (type)
+  {
+    case MYSQL_TYPE_DATE:
+      // YYYY-MM-DD, anything after it is ignored (like in convert_date).
+      if (length < 10 || source[4] != '-' || source[7] != '-'
+        || !read_digits(source, 4, year) || !read_digits(source + 5, 2, month) || !read_digits(source + 8, 2, day))
+        return false;
+
+      init_mysql_time(target);
+      target->year = year;
+      target->month = month;
+      target->day = day;
+      target->time_type = MYSQL_TIMESTAMP_DATE;
+      return true;
+
+    case MYSQL_TYPE_TIME:
+      // HH:MM:SS[.ffffff]
+      if (length < 8 || source[2] != ':' || source[5] != ':' || (length > 8 && source[8] != '.')
+        || !read_digits(source, 2, hour) || !read_digits(source + 3, 2, minute) || !read_digits(source + 6, 2, second))
+        return false;
+      if (length > 9 && !read_fraction(source + 9, length - 9, fraction))
+        return false;
+
+      init_mysql_time(target);
+      target->hour = hour;
+      target->minute = minute;
+      target->second = second;
+      target->second_part = fraction;
+      target->time_type = MYSQL_TIMESTAMP_TIME;
+      return true;
+
+    case MYSQL_TYPE_DATETIME:
+    case MYSQL_TYPE_TIMESTAMP:
+      // YYYY-MM-DD HH:MM:SS[.ffffff], the date/time separator can also be a T.
+      if (length < 19 || source[4] != '-' || source[7] != '-' || (source[10] != ' ' && source[10] != 'T')
+        || source[13] != ':' || source[16] != ':' || (length > 19 && source[19] != '.'))
+        return false;
+      if (!read_digits(source, 4, year) || !read_digits(source + 5, 2, month) || !read_digits(source + 8, 2, day)
+        || !read_digits(source + 11, 2, hour) || !read_digits(source + 14, 2, minute) || !read_digits(source + 17, 2, second))
+        return false;
+      if (length > 20 && !read_fraction(source + 20, length - 20, fraction))
+        return false;
+
+      init_mysql_time(target);
+      target->year = year;
+      target->month = month;
+      target->day = day;
+      target->hour = hour;
+      target->minute = minute;
+      target->second = second;
+      target->second_part = fraction;
+      target->time_type = MYSQL_TIMESTAMP_DATETIME;
+      return true;
+  }
+  return false;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void BaseConverter::convert_date_time_column(const char* values, size_t value_size, const SQLLEN* lengths,
+                                             size_t count, MYSQL_TIME* targets, int type)
+{
+  for (size_t i = 0; i < count; ++i)
+  {
+    const char *value = values + i * value_size;
+    size_t length;
+
+    if (lengths != NULL && lengths[i] == SQL_NULL_DATA)
+    {
+      targets[i].time_type = MYSQL_TIMESTAMP_NONE;
+      continue;
+    }
+
+    if (lengths != NULL && lengths[i] >= 0 && (size_t)lengths[i] < value_size)
+      length = (size_t)lengths[i];
+    else
+    {
+      // No length or a truncated value: the value is zero terminated within its slot.
+      const char *end = (const char*)memchr(value, 0, value_size);
+      length = end ? end - value : value_size;
+    }
+
+    if (!parse_iso_date_time(value, length, &targets[i], type))
+      convert_date_time(std::string(value, length).c_str(), &targets[i], type);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Copies the leading ASCII characters from a block of 16 bit code units. Returns the number copied.
+ */
+static size_t copy_ascii_16(const unsigned short* source, size_t count, char* out)
+{
+  size_t i = 0;
+#ifdef HAVE_SSE2_KERNELS
+  // 8 code units at a time: check that none has bits above 0x7F set and pack them to bytes.
+  const __m128i non_ascii_mask = _mm_set1_epi16((short)0xFF80);
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 8 <= count; i += 8)
+  {
+    __m128i units = _mm_loadu_si128((const __m128i*)(source + i));
+    if (_mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, non_ascii_mask), zero)) != 0xFFFF)
+      break;
+    _mm_storel_epi64((__m128i*)(out + i), _mm_packus_epi16(units, units));
+  }
+#else
+  for (; i + 4 <= count; i += 4)
+  {
+    if ((source[i] | source[i + 1] | source[i + 2] | source[i + 3]) & 0xFF80)
+      break;
+    out[i] = (char)source[i];
+    out[i + 1] = (char)source[i + 1];
+    out[i + 2] = (char)source[i + 2];
+    out[i + 3] = (char)source[i + 3];
+  }
+#endif
+  for (; i < count && source[i] < 0x80; ++i)
+    out[i] = (char)source[i];
+  return i;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template <typename Unit>
+static inline unsigned long code_unit(Unit unit)
+{
+  // SQLWCHAR can be a signed type (wchar_t), so go through the unsigned type of the same size.
+  if (sizeof(Unit) == 2)
+    return (unsigned short)unit;
+  return (unsigned int)unit;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+template <typename Unit>
+static size_t utf16_to_utf8(const Unit* source, size_t count, char* out, size_t out_size, size_t &consumed)
+{
+  size_t written = 0;
+  size_t i = 0;
+
+  while (i < count)
+  {
+    size_t run = std::min(count - i, out_size - written);
+    if (run > 0)
+    {
+      size_t copied;
+      if (sizeof(Unit) == 2)
+        copied = copy_ascii_16((const unsigned short*)(source + i), run, out + written);
+      else
+      {
+        copied = 0;
+        while (copied < run && code_unit(source[i + copied]) < 0x80)
+        {
+          out[written + copied] = (char)source[i + copied];
+          ++copied;
+        }
+      }
+      i += copied;
+      written += copied;
+      if (i == count)
+        break;
+    }
+
+    unsigned long c = code_unit(source[i]);
+    size_t units = 1;
+    if (c >= 0xD800 && c <= 0xDBFF)
+    {
+      unsigned long low = i + 1 < count ? code_unit(source[i + 1]) : 0;
+      if (low >= 0xDC00 && low <= 0xDFFF)
+      {
+        c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+        units = 2;
+      }
+      else
+        c = 0xFFFD;
+    }
+    else if ((c >= 0xDC00 && c <= 0xDFFF) || c > 0x10FFFF)
+      c = 0xFFFD;
+
+    char buffer[4];
+    size_t length;
+    if (c < 0x80)
+    {
+      buffer[0] = (char)c;
+      length = 1;
+    }
+    else if (c < 0x800)
+    {
+      buffer[0] = (char)(0xC0 | (c >> 6));
+      buffer[1] = (char)(0x80 | (c & 0x3F));
+      length = 2;
+    }
+    else if (c < 0x10000)
+    {
+      buffer[0] = (char)(0xE0 | (c >> 12));
+      buffer[1] = (char)(0x80 | ((c >> 6) & 0x3F));
+      buffer[2] = (char)(0x80 | (c & 0x3F));
+      length = 3;
+    }
+    else
+    {
+      buffer[0] = (char)(0xF0 | (c >> 18));
+      buffer[1] = (char)(0x80 | ((c >> 12) & 0x3F));
+      buffer[2] = (char)(0x80 | ((c >> 6) & 0x3F));
+      buffer[3] = (char)(0x80 | (c & 0x3F));
+      length = 4;
+    }
+
+    if (written + length > out_size)
+      break;
+    memcpy(out + written, buffer, length);
+    written += length;
+    i += units;
+  }
+
+  consumed = i;
+  return written;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t BaseConverter::ucs2_to_utf8(const SQLWCHAR* source, size_t count, char* out, size_t out_size, size_t* consumed)
+{
+  size_t converted;
+  size_t written = utf16_to_utf8(source, count, out, out_size, converted);
+  if (consumed != NULL)
+    *consumed = converted;
+  return written;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+size_t BaseConverter::ucs2_to_utf8_column(const char* values, size_t value_size, const SQLLEN* lengths, size_t count,
+                                          char* out, size_t out_size, unsigned long* out_lengths)
+{
+  size_t truncated = 0;
+  size_t max_bytes = value_size - sizeof(SQLWCHAR); // Room for the terminator is reserved by the driver.
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (lengths[i] == SQL_NULL_DATA)
+    {
+      out_lengths[i] = 0;
+      continue;
+    }
+
+    size_t bytes = (size_t)lengths[i];
+    bool was_truncated = false;
+    if (lengths[i] < 0 || bytes > max_bytes)
+    {
+      bytes = max_bytes;
+      was_truncated = true;
+    }
+
+    size_t units = bytes / sizeof(SQLWCHAR);
+    size_t consumed;
+    out_lengths[i] = (unsigned long)ucs2_to_utf8((const SQLWCHAR*)(values + i * value_size), units,
+                                                 out + i * out_size, out_size, &consumed);
+    if (was_truncated || consumed < units)
+      ++truncated;
+  }
+  return truncated;
+}
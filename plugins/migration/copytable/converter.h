@@ -29,6 +29,7 @@
 class BaseConverter
 {
   static void init_mysql_time(MYSQL_TIME* target);
+  static bool parse_iso_date_time(const char* source, size_t length, MYSQL_TIME* target, int type);
 public:
   static void convert_date(DATE_STRUCT* source, MYSQL_TIME* target);
   static void convert_date(const char* source, MYSQL_TIME* target);
@@ -36,4 +37,31 @@ public:
   static void convert_timestamp(const char* source, MYSQL_TIME* target);
   static void convert_timestamp(TIMESTAMP_STRUCT* source, MYSQL_TIME* target);
   static void convert_date_time(const char* source, MYSQL_TIME* target, int type);
+
+  // Block conversion kernels, working on a whole fetched column at once.
+
+  /**
+   * Converts count date/time strings, stored value_size bytes apart, to MYSQL_TIME values.
+   * lengths holds the ODBC length/indicator of each value (SQL_NULL_DATA for NULL) and may be NULL
+   * for zero terminated input. Values in the ISO layout (YYYY-MM-DD[ HH:MM:SS[.ffffff]]) are parsed in place,
+   * everything else falls back to convert_date_time().
+   */
+  static void convert_date_time_column(const char* values, size_t value_size, const SQLLEN* lengths,
+                                       size_t count, MYSQL_TIME* targets, int type);
+
+  /**
+   * Converts count UCS-2/UTF-16 code units to UTF-8, writing at most out_size bytes (only whole characters).
+   * Runs of ASCII characters are converted in blocks. Unpaired surrogates become U+FFFD.
+   * Returns the number of bytes written. If consumed is given it receives the number of code units converted.
+   */
+  static size_t ucs2_to_utf8(const SQLWCHAR* source, size_t count, char* out, size_t out_size, size_t* consumed = NULL);
+
+  /**
+   * Converts count wide strings, stored value_size bytes apart, to UTF-8 strings stored out_size bytes apart.
+   * lengths holds the ODBC length/indicator (in bytes) of each value. The UTF-8 length of each value
+   * is written to out_lengths, NULL values get a length of 0.
+   * Returns the number of values that had to be truncated.
+   */
+  static size_t ucs2_to_utf8_column(const char* values, size_t value_size, const SQLLEN* lengths, size_t count,
+                                    char* out, size_t out_size, unsigned long* out_lengths);
 };
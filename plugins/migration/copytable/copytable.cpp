@@ -39,6 +39,18 @@
 #include <boost/algorithm/string.hpp>
 
 DEFAULT_LOG_DOMAIN("copytable");
+
+// Number of rows fetched at once from ODBC sources if no block size was set.
+#define DEFAULT_ROW_ARRAY_SIZE 1000
+
+// Upper limit for the memory used by the bound column arrays of an ODBC source.
+#define MAX_BLOCK_BUFFER_SIZE (16 * 1024 * 1024)
+
+// Larger string columns are read with SQLGetData() instead of being bound.
+#define MAX_BOUND_VALUE_SIZE (64 * 1024)
+
+// Size of the string buffer for date/time values.
+#define DATE_TIME_VALUE_SIZE 32
 #define TMP_TRIGGER_TABLE "wb_tmp_triggers"
 
 #if defined(MYSQL_VERSION_MAJOR) && defined(MYSQL_VERSION_MINOR) && defined(MYSQL_VERSION_PATCH)
@@ -596,7 +608,8 @@ ODBCCopyDataSource::ODBCCopyDataSource(SQLHENV env,
                                        const std::string &password,
                                        bool force_utf8_input,
                                        const std::string &source_rdbms_type)
-: _connstring(connstring), _stmt_ok(false), _source_rdbms_type(source_rdbms_type)
+: _connstring(connstring), _stmt_ok(false), _source_rdbms_type(source_rdbms_type),
+  _rows_fetched(0), _block_row(0), _block_fetch_checked(false), _block_fetch(false), _select_ordered(false), _rows_returned(0)
 {
   _blob_buffer = NULL;
   _utf8_blob_buffer = NULL;
@@ -640,39 +653,15 @@ ODBCCopyDataSource::~ODBCCopyDataSource()
 
 void ODBCCopyDataSource::ucs2_to_utf8(char *inbuf, size_t inbuf_len, char *&utf8buf, size_t &utf8buf_len)
 {
-  size_t outbuf_len = _max_blob_chunk_size;
-
-  // outside Windows, SQLWCHAR is wchar_t, which is not always 2 bytes
-  if (sizeof(SQLWCHAR) > sizeof(unsigned short))
-  {
-    SQLWCHAR *in = (SQLWCHAR*)inbuf;
-    unsigned short *out = (unsigned short*)inbuf;
-    for (size_t i = 0; i < inbuf_len/sizeof(SQLWCHAR); i++)
-      out[i] = in[i];
-    inbuf_len = (inbuf_len/sizeof(SQLWCHAR)) * sizeof(unsigned short);
-  }
-  else if (sizeof(SQLWCHAR) < sizeof(unsigned short))
-    throw std::logic_error("Unexpected architecture. sizeof(SQLWCHAR) < sizeof(unsigned short)!");
-
-  //log_debug3("Convert string with %i chars to buffer size %i\n", inbuf_len, outbuf_len);
-
-  // convert data from UCS-2 to utf-8
-  std::string s_outbuf = base::wstring_to_string((wchar_t*)inbuf);
-  outbuf_len = s_outbuf.size();
-  if (outbuf_len > _max_blob_chunk_size - 1)
-	  throw std::logic_error("Output buffer size is greater than max blob chunk size.");
-
-  if (s_outbuf.empty())
-    throw std::logic_error(base::strfmt("Error during charset conversion of wstring: %s", strerror(errno)));
-
-  std::strcpy(_utf8_blob_buffer, s_outbuf.c_str());
+  // Outside Windows SQLWCHAR is not necessarily 2 bytes, the converter handles both.
+  size_t units = inbuf_len / sizeof(SQLWCHAR);
+  size_t consumed;
 
-  if (inbuf_len > 0)
-    log_warning("%li characters could not be converted to UTF-8 during copy\n",
-                (long)inbuf_len);//, (*_columns)[column-1].source_name.c_str());
+  utf8buf_len = BaseConverter::ucs2_to_utf8((const SQLWCHAR*)inbuf, units, _utf8_blob_buffer, _max_blob_chunk_size, &consumed);
+  if (consumed < units)
+    throw std::logic_error("Output buffer size is greater than max blob chunk size.");
 
   utf8buf = _utf8_blob_buffer;
-  utf8buf_len = _max_blob_chunk_size - outbuf_len;
 }
 
 
@@ -682,17 +671,10 @@ SQLRETURN ODBCCopyDataSource::get_wchar_buffer_data(RowBuffer &rowbuffer, int co
   SQLLEN len_or_indicator = 0;
   char* out_buffer = NULL;
   size_t out_buffer_len = 0;
-  wchar_t tmpbuf[64 * 1024] = { 0 };
-
-  if(typeid(wchar_t*) != typeid(SQLWCHAR*))
-    log_warning("Forcing wchar_t but SQLWCHAR is of different type which shouldn't happen. Potential problems during migration may occur.\n");
+  SQLWCHAR tmpbuf[64 * 1024];
 
   SQLRETURN ret = SQLGetData(_stmt, column, _column_types[column - 1], tmpbuf, sizeof(tmpbuf), &len_or_indicator);
-  // check if the data fits
-  //if (len_or_indicator > out_buffer_len)
-  //  ;
   rowbuffer.prepare_add_string(out_buffer, out_buffer_len, out_length);
-  memset(out_buffer, 0, out_buffer_len);
   if (SQL_SUCCEEDED(ret))
   {
     if (len_or_indicator == SQL_NO_TOTAL)
@@ -700,24 +682,13 @@ SQLRETURN ODBCCopyDataSource::get_wchar_buffer_data(RowBuffer &rowbuffer, int co
 
     if (len_or_indicator != SQL_NULL_DATA)
     {
-      size_t outbuf_len = out_buffer_len;
-
-      //log_debug3("Convert string with %i chars to buffer size %i\n", inbuf_len, outbuf_len);
-
       // convert data from UCS-2 to utf-8
-      std::string s_outbuf = base::wstring_to_string(tmpbuf);
-      //log_debug3("get_wchar_buffer_data wstring_to_string i<%S> o<%s>\n", (wchar_t*)tmpbuf, s_outbuf.c_str());
-
-      outbuf_len = s_outbuf.size();
-      if (outbuf_len > _max_blob_chunk_size - 1)
-      	  throw std::logic_error("Output buffer size is greater than max blob chunk size.");
-
-      if (s_outbuf.empty())
-        throw std::logic_error(base::strfmt("Error during charset conversion of wstring: %s", strerror(errno)));
-
-      std::strcpy(out_buffer, s_outbuf.c_str());
-
-      *out_length = outbuf_len;
+      size_t units = std::min((size_t)len_or_indicator, sizeof(tmpbuf) - sizeof(SQLWCHAR)) / sizeof(SQLWCHAR);
+      size_t consumed;
+      *out_length = (unsigned long)BaseConverter::ucs2_to_utf8(tmpbuf, units, out_buffer, out_buffer_len, &consumed);
+      if (consumed < units)
+        log_error("Truncating data in column %s to %lu bytes. Possible loss of data.\n",
+                  (*_columns)[column - 1].source_name.c_str(), (unsigned long)out_buffer_len);
     }
     rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
   }
@@ -741,10 +712,7 @@ SQLRETURN ODBCCopyDataSource::get_date_time_data(RowBuffer &rowbuffer, int colum
     if (len_or_indicator == SQL_NO_TOTAL)
       throw std::runtime_error(base::strfmt("Got SQL_NO_TOTAL for string size during copy of column %i", column));
 
-    if (len_or_indicator != SQL_NULL_DATA)
-      BaseConverter::convert_date_time(out_date, (MYSQL_TIME*)out_buffer, type);
-    else
-      ((MYSQL_TIME*)out_buffer)->time_type = MYSQL_TIMESTAMP_NONE;
+    BaseConverter::convert_date_time_column(out_date, sizeof(out_date), &len_or_indicator, 1, (MYSQL_TIME*)out_buffer, type);
 
     rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
   }
@@ -895,6 +863,12 @@ boost::shared_ptr<std::vector<ColumnInfo> > ODBCCopyDataSource::begin_select_tab
   _schema_name = schema;
   _table_name = table;
 
+  _block_fetch_checked = false;
+  _block_fetch = false;
+  _rows_fetched = 0;
+  _block_row = 0;
+  _rows_returned = 0;
+
   _stmt_ok = true;
   SQLRETURN ret;
   if (!SQL_SUCCEEDED(ret = SQLAllocHandle(SQL_HANDLE_STMT, _dbc, &_stmt)))
@@ -919,6 +893,8 @@ boost::shared_ptr<std::vector<ColumnInfo> > ODBCCopyDataSource::begin_select_tab
     select_query.add_where(spec.where_expression);
 
   q = select_query.build_query();
+  _select_query = q;
+  _select_ordered = !pk_columns.empty();
 
   log_debug("Executing query: %s\n", q.c_str());
   if (!SQL_SUCCEEDED(ret = SQLExecDirect(_stmt, (SQLCHAR*)q.c_str(), SQL_NTS)))
@@ -997,279 +973,746 @@ void ODBCCopyDataSource::end_select_table()
   SQLFreeHandle(SQL_HANDLE_STMT, _stmt);
   _column_types.clear();
   _columns.reset();
+  _bound_columns.clear();
+  _row_status.clear();
   _stmt_ok = false;
 }
 
-bool ODBCCopyDataSource::fetch_row(RowBuffer &rowbuffer)
+void ODBCCopyDataSource::get_column_data(RowBuffer &rowbuffer, int i)
 {
-  if (SQL_SUCCEEDED(SQLFetch(_stmt)))
-  {
-    for (int i = 1; i <= _column_count; i++)
-    {
-      SQLRETURN ret = 0;
-      SQLLEN len_or_indicator;
-      char* out_buffer;
-      size_t out_buffer_len;
+  SQLRETURN ret = 0;
+  SQLLEN len_or_indicator;
+  char* out_buffer;
+  size_t out_buffer_len;
 
-      //log_debug3("Copy %i from type %i to %i\n", i,
+  //log_debug3("Copy %i from type %i to %i\n", i,
 //                 _column_types[i-1],
 //                 rowbuffer[i-1].buffer_type);
 
-      // if this column is a blob, handle it as such
-      if (rowbuffer.check_if_blob() || (*_columns)[i-1].is_long_data)
-      {
-        if (!_blob_buffer)
-        {
-          _blob_buffer = (char*)malloc(_max_blob_chunk_size);
-          if (!_blob_buffer)
-            throw std::runtime_error(base::strfmt("malloc(%lu) failed for blob transfer buffer", (unsigned long)_max_blob_chunk_size));
+  // if this column is a blob, handle it as such
+  if (rowbuffer.check_if_blob() || (*_columns)[i-1].is_long_data)
+  {
+    if (!_blob_buffer)
+    {
+      _blob_buffer = (char*)malloc(_max_blob_chunk_size);
+      if (!_blob_buffer)
+        throw std::runtime_error(base::strfmt("malloc(%lu) failed for blob transfer buffer", (unsigned long)_max_blob_chunk_size));
 
-          _utf8_blob_buffer = (char*)malloc(_max_blob_chunk_size);
-          if (!_utf8_blob_buffer)
-            throw std::runtime_error(base::strfmt("malloc(%lu) failed for blob transfer buffer", (unsigned long)_max_blob_chunk_size));
-        }
+      _utf8_blob_buffer = (char*)malloc(_max_blob_chunk_size);
+      if (!_utf8_blob_buffer)
+        throw std::runtime_error(base::strfmt("malloc(%lu) failed for blob transfer buffer", (unsigned long)_max_blob_chunk_size));
+    }
 
-        ret = SQLGetData(_stmt, i,_column_types[i-1], _blob_buffer, _max_blob_chunk_size, &len_or_indicator);
+    ret = SQLGetData(_stmt, i,_column_types[i-1], _blob_buffer, _max_blob_chunk_size, &len_or_indicator);
 
-        // Saves the column length, at the first call it is the total column size
-        if (len_or_indicator > _max_parameter_size)
+    // Saves the column length, at the first call it is the total column size
+    if (len_or_indicator > _max_parameter_size)
+    {
+      if (_abort_on_oversized_blobs)
+        throw std::runtime_error(base::strfmt("oversized blob found in table %s.%s, size: %lli",
+                                              _schema_name.c_str(), _table_name.c_str(),
+                                              (long long)len_or_indicator));
+      else
+      {
+        printf("oversized blob found in table %s.%s, size: %lli",
+               _schema_name.c_str(), _table_name.c_str(),
+               (long long)len_or_indicator);
+        rowbuffer.finish_field(true);
+        return;
+      }
+    }
+    else
+    {
+      while (ret == SQL_SUCCESS_WITH_INFO)
+      {
+        SQLUSMALLINT  i = 0;
+        SQLINTEGER    native;
+        SQLCHAR       state[7];
+        SQLCHAR       text[256];
+        SQLSMALLINT   len;
+
+        ret = SQLGetDiagRec(SQL_HANDLE_STMT, _stmt, ++i, state, &native, text,
+                            sizeof(text), &len);
+
+        // This should be done ONLY if no bulk updates
+        // are being used
+        if (native == 1014 && !_use_bulk_inserts)
+          rowbuffer.send_blob_data(_blob_buffer, len_or_indicator);
+
+        // Unrecognized characters were changed to ?? but data was read
+        else if (native == 2403)
         {
-          if (_abort_on_oversized_blobs)
-            throw std::runtime_error(base::strfmt("oversized blob found in table %s.%s, size: %lli",
-                                                  _schema_name.c_str(), _table_name.c_str(),
-                                                  (long long)len_or_indicator));
-          else
-          {
-            printf("oversized blob found in table %s.%s, size: %lli",
-                   _schema_name.c_str(), _table_name.c_str(),
-                   (long long)len_or_indicator);
-            rowbuffer.finish_field(true);
-            continue;
-          }
+          log_warning("[%s - %ld]: %s\n", state, (long int)native, text);
+          break;
         }
-        else
+
+        ret = SQLGetData(_stmt, i, _column_types[i-1], _blob_buffer, _max_blob_chunk_size, &len_or_indicator);
+      }
+
+      if (ret == SQL_SUCCESS)
+      {
+        bool was_null = len_or_indicator == SQL_NULL_DATA;
+
+        if(!was_null)
         {
-          while (ret == SQL_SUCCESS_WITH_INFO)
+          char *utf8_data;
+          char *final_data = _blob_buffer;
+          size_t final_length = len_or_indicator;
+
+          // Convers the data to utf8 if needed
+          if (_column_types[i-1] == SQL_C_WCHAR)
           {
-            SQLUSMALLINT  i = 0;
-            SQLINTEGER    native;
-            SQLCHAR       state[7];
-            SQLCHAR       text[256];
-            SQLSMALLINT   len;
-
-            ret = SQLGetDiagRec(SQL_HANDLE_STMT, _stmt, ++i, state, &native, text,
-                                sizeof(text), &len);
-
-            // This should be done ONLY if no bulk updates
-            // are being used
-            if (native == 1014 && !_use_bulk_inserts)
-              rowbuffer.send_blob_data(_blob_buffer, len_or_indicator);
-
-            // Unrecognized characters were changed to ?? but data was read
-            else if (native == 2403)
+            //XXX take care of case where the utf8 data is bigger than _max_blob_chunk_size
+            try
             {
-              log_warning("[%s - %ld]: %s\n", state, (long int)native, text);
-              break;
+              ucs2_to_utf8(_blob_buffer, len_or_indicator, utf8_data, final_length);
             }
-
-            ret = SQLGetData(_stmt, i, _column_types[i-1], _blob_buffer, _max_blob_chunk_size, &len_or_indicator);
+            catch (std::logic_error &)
+            {
+              const std::string msg = base::strfmt("ERROR: Could not successfully convert UCS-2 string to UTF-8 "
+                  "in table %s.%s (column %s). Original string: \"%s\"",
+                  _schema_name.c_str(), _table_name.c_str(), (*_columns)[i-1].source_name.c_str(), std::string(_blob_buffer, len_or_indicator).c_str()
+                  );
+              log_error("%s", msg.c_str());
+              throw std::invalid_argument(msg);
+            }
+            final_data = utf8_data;
           }
 
-          if (ret == SQL_SUCCESS)
+          if (_use_bulk_inserts)
           {
-            bool was_null = len_or_indicator == SQL_NULL_DATA;
+            if (rowbuffer[i-1].buffer_length)
+              free(rowbuffer[i-1].buffer);
 
-            if(!was_null)
-            {
-              char *utf8_data;
-              char *final_data = _blob_buffer;
-              size_t final_length = len_or_indicator;
-
-              // Convers the data to utf8 if needed
-              if (_column_types[i-1] == SQL_C_WCHAR)
-              {
-                //XXX take care of case where the utf8 data is bigger than _max_blob_chunk_size
-                try
-                {
-                  ucs2_to_utf8(_blob_buffer, len_or_indicator, utf8_data, final_length);
-                }
-                catch (std::logic_error &)
-                {
-                  const std::string msg = base::strfmt("ERROR: Could not successfully convert UCS-2 string to UTF-8 "
-                      "in table %s.%s (column %s). Original string: \"%s\"",
-                      _schema_name.c_str(), _table_name.c_str(), (*_columns)[i-1].source_name.c_str(), std::string(_blob_buffer, len_or_indicator).c_str()
-                      );
-                  log_error("%s", msg.c_str());
-                  throw std::invalid_argument(msg);
-                }
-                final_data = utf8_data;
-              }
-
-              if (_use_bulk_inserts)
-              {
-                if (rowbuffer[i-1].buffer_length)
-                  free(rowbuffer[i-1].buffer);
-
-                *rowbuffer[i - 1].length = (unsigned long)final_length;
-                rowbuffer[i - 1].buffer_length = (unsigned long)final_length;
-                rowbuffer[i-1].buffer = malloc(final_length);
-
-                memcpy(rowbuffer[i-1].buffer, final_data, final_length);
-              }
-              else
-                rowbuffer.send_blob_data(final_data, final_length);
-            }
+            *rowbuffer[i - 1].length = (unsigned long)final_length;
+            rowbuffer[i - 1].buffer_length = (unsigned long)final_length;
+            rowbuffer[i-1].buffer = malloc(final_length);
 
-            rowbuffer.finish_field(was_null);
+            memcpy(rowbuffer[i-1].buffer, final_data, final_length);
           }
           else
-          {
-            rowbuffer.finish_field(true);
-            throw ConnectionError("SQLGetData", ret, SQL_HANDLE_STMT, _stmt);
-          }
-          continue;
+            rowbuffer.send_blob_data(final_data, final_length);
         }
+
+        rowbuffer.finish_field(was_null);
       }
+      else
+      {
+        rowbuffer.finish_field(true);
+        throw ConnectionError("SQLGetData", ret, SQL_HANDLE_STMT, _stmt);
+      }
+      return;
+    }
+  }
 
-      switch (_column_types[i-1])
+  switch (_column_types[i-1])
+  {
+    case SQL_C_BIT:
+      rowbuffer.prepare_add_tiny(out_buffer, out_buffer_len);
+      ret = SQLGetData(_stmt, i, SQL_C_STINYINT, out_buffer, out_buffer_len, &len_or_indicator);
+      if (SQL_SUCCEEDED(ret))
+        rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
+      break;
+    case SQL_C_FLOAT:
+    case SQL_C_DOUBLE:
+      if (rowbuffer[i-1].buffer_type == MYSQL_TYPE_FLOAT)
       {
-        case SQL_C_BIT:
-          rowbuffer.prepare_add_tiny(out_buffer, out_buffer_len);
-          ret = SQLGetData(_stmt, i, SQL_C_STINYINT, out_buffer, out_buffer_len, &len_or_indicator);
-          if (SQL_SUCCEEDED(ret))
-            rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
-          break;
-        case SQL_C_FLOAT:
-        case SQL_C_DOUBLE:
-          if (rowbuffer[i-1].buffer_type == MYSQL_TYPE_FLOAT)
-          {
-            rowbuffer.prepare_add_float(out_buffer, out_buffer_len);
-            ret = SQLGetData(_stmt, i, SQL_C_FLOAT, out_buffer, out_buffer_len, &len_or_indicator);
-            if (SQL_SUCCEEDED(ret))
-              rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
-          }
-          else
-          {
-            rowbuffer.prepare_add_double(out_buffer, out_buffer_len);
-            ret = SQLGetData(_stmt, i, SQL_C_DOUBLE, out_buffer, out_buffer_len, &len_or_indicator);
-            if (SQL_SUCCEEDED(ret))
-              rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
-          }
-          break;
-        case SQL_C_DATE:
-          ret = get_date_time_data(rowbuffer, i, MYSQL_TYPE_DATE);
-          break;
-        case SQL_C_TIME:
-          ret = get_date_time_data(rowbuffer, i, MYSQL_TYPE_TIME);
-          break;
-        case SQL_C_TIMESTAMP:
-          ret = get_date_time_data(rowbuffer, i, MYSQL_TYPE_TIMESTAMP);
-          break;
-        case SQL_C_UBIGINT:
-        case SQL_C_SBIGINT:
-          rowbuffer.prepare_add_bigint(out_buffer, out_buffer_len);
-          ret = SQLGetData(_stmt, i, _column_types[i-1], out_buffer, out_buffer_len, &len_or_indicator);
-          if (SQL_SUCCEEDED(ret))
-            rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
-          break;
-        case SQL_C_ULONG:
-        case SQL_C_SLONG:
+        rowbuffer.prepare_add_float(out_buffer, out_buffer_len);
+        ret = SQLGetData(_stmt, i, SQL_C_FLOAT, out_buffer, out_buffer_len, &len_or_indicator);
+        if (SQL_SUCCEEDED(ret))
+          rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
+      }
+      else
+      {
+        rowbuffer.prepare_add_double(out_buffer, out_buffer_len);
+        ret = SQLGetData(_stmt, i, SQL_C_DOUBLE, out_buffer, out_buffer_len, &len_or_indicator);
+        if (SQL_SUCCEEDED(ret))
+          rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
+      }
+      break;
+    case SQL_C_DATE:
+      ret = get_date_time_data(rowbuffer, i, MYSQL_TYPE_DATE);
+      break;
+    case SQL_C_TIME:
+      ret = get_date_time_data(rowbuffer, i, MYSQL_TYPE_TIME);
+      break;
+    case SQL_C_TIMESTAMP:
+      ret = get_date_time_data(rowbuffer, i, MYSQL_TYPE_TIMESTAMP);
+      break;
+    case SQL_C_UBIGINT:
+    case SQL_C_SBIGINT:
+      rowbuffer.prepare_add_bigint(out_buffer, out_buffer_len);
+      ret = SQLGetData(_stmt, i, _column_types[i-1], out_buffer, out_buffer_len, &len_or_indicator);
+      if (SQL_SUCCEEDED(ret))
+        rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
+      break;
+    case SQL_C_ULONG:
+    case SQL_C_SLONG:
+      {
+        long tmp_buffer;
+        bool unsig;
+        enum enum_field_types target_type;
+        ret = SQLGetData(_stmt, i, _column_types[i-1], &tmp_buffer, sizeof(tmp_buffer), &len_or_indicator);
+        if (SQL_SUCCEEDED(ret))
+        {
+          switch ((target_type = rowbuffer.target_type(unsig)))
           {
-            long tmp_buffer;
-            bool unsig;
-            enum enum_field_types target_type;
-            ret = SQLGetData(_stmt, i, _column_types[i-1], &tmp_buffer, sizeof(tmp_buffer), &len_or_indicator);
-            if (SQL_SUCCEEDED(ret))
-            {
-              switch ((target_type = rowbuffer.target_type(unsig)))
-              {
-              case MYSQL_TYPE_SHORT:
-                rowbuffer.prepare_add_short(out_buffer, out_buffer_len);
-                if ((unsig && (tmp_buffer < 0 || tmp_buffer > UINT16_MAX)) || (!unsig && (tmp_buffer > INT16_MAX || tmp_buffer < INT16_MIN)))
-                  throw std::logic_error(base::strfmt("Range error fetching field %i (value %li, target is %s)",
-                                        i, tmp_buffer, mysql_field_type_to_name(target_type)));
-                *(short*)out_buffer = (short)tmp_buffer;
-                break;
-              case MYSQL_TYPE_TINY:
-                rowbuffer.prepare_add_tiny(out_buffer, out_buffer_len);
-                if ((unsig && (tmp_buffer < 0 || tmp_buffer > UINT8_MAX)) || (!unsig && (tmp_buffer > INT8_MAX || tmp_buffer < INT8_MIN)))
-                  throw std::logic_error(base::strfmt("Range error fetching field %i (value %li, target is %s)",
-                                        i, tmp_buffer, mysql_field_type_to_name(target_type)));
-                *(char*)out_buffer = (char)tmp_buffer;
-                break;
-              default:
-                rowbuffer.prepare_add_long(out_buffer, out_buffer_len);
-                *(long*)out_buffer = tmp_buffer;
-                break;
-              }
-              rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);}
-            }
+          case MYSQL_TYPE_SHORT:
+            rowbuffer.prepare_add_short(out_buffer, out_buffer_len);
+            if ((unsig && (tmp_buffer < 0 || tmp_buffer > UINT16_MAX)) || (!unsig && (tmp_buffer > INT16_MAX || tmp_buffer < INT16_MIN)))
+              throw std::logic_error(base::strfmt("Range error fetching field %i (value %li, target is %s)",
+                                    i, tmp_buffer, mysql_field_type_to_name(target_type)));
+            *(short*)out_buffer = (short)tmp_buffer;
             break;
-        case SQL_C_USHORT:
-        case SQL_C_SSHORT:
-          rowbuffer.prepare_add_short(out_buffer, out_buffer_len);
-          ret = SQLGetData(_stmt, i, _column_types[i-1], out_buffer, out_buffer_len, &len_or_indicator);
-          if (SQL_SUCCEEDED(ret))
-            rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
-          break;
-        case SQL_C_UTINYINT:
-        case SQL_C_STINYINT:
-          rowbuffer.prepare_add_tiny(out_buffer, out_buffer_len);
-          ret = SQLGetData(_stmt, i, _column_types[i-1], out_buffer, out_buffer_len, &len_or_indicator);
-          if (SQL_SUCCEEDED(ret))
-            rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
-          break;
-        case SQL_C_WCHAR:
-        case SQL_C_CHAR:
-          switch (rowbuffer[i-1].buffer_type)
-          {
+          case MYSQL_TYPE_TINY:
+            rowbuffer.prepare_add_tiny(out_buffer, out_buffer_len);
+            if ((unsig && (tmp_buffer < 0 || tmp_buffer > UINT8_MAX)) || (!unsig && (tmp_buffer > INT8_MAX || tmp_buffer < INT8_MIN)))
+              throw std::logic_error(base::strfmt("Range error fetching field %i (value %li, target is %s)",
+                                    i, tmp_buffer, mysql_field_type_to_name(target_type)));
+            *(char*)out_buffer = (char)tmp_buffer;
+            break;
+          default:
+            rowbuffer.prepare_add_long(out_buffer, out_buffer_len);
+            *(long*)out_buffer = tmp_buffer;
+            break;
+          }
+          rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);}
+        }
+        break;
+    case SQL_C_USHORT:
+    case SQL_C_SSHORT:
+      rowbuffer.prepare_add_short(out_buffer, out_buffer_len);
+      ret = SQLGetData(_stmt, i, _column_types[i-1], out_buffer, out_buffer_len, &len_or_indicator);
+      if (SQL_SUCCEEDED(ret))
+        rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
+      break;
+    case SQL_C_UTINYINT:
+    case SQL_C_STINYINT:
+      rowbuffer.prepare_add_tiny(out_buffer, out_buffer_len);
+      ret = SQLGetData(_stmt, i, _column_types[i-1], out_buffer, out_buffer_len, &len_or_indicator);
+      if (SQL_SUCCEEDED(ret))
+        rowbuffer.finish_field(len_or_indicator == SQL_NULL_DATA);
+      break;
+    case SQL_C_WCHAR:
+    case SQL_C_CHAR:
+      switch (rowbuffer[i-1].buffer_type)
+      {
+      case MYSQL_TYPE_TIME:
+      case MYSQL_TYPE_DATE:
+      case MYSQL_TYPE_DATETIME:
+      case MYSQL_TYPE_NEWDATE:
+        ret = get_date_time_data(rowbuffer, i, rowbuffer[i-1].buffer_type);
+        break;
+      case MYSQL_TYPE_GEOMETRY:
+        ret = get_geometry_buffer_data(rowbuffer, i);
+        break;
+      default:
+        if (_column_types[i-1] == SQL_C_WCHAR)
+          ret = get_wchar_buffer_data(rowbuffer, i);
+        else
+          ret = get_char_buffer_data(rowbuffer, i);
+        break;
+      }
+      break;
+    case SQL_C_BINARY:
+      {
+        bool was_null = true;
+
+        // During the migration process some non standard data types are migrated as strings
+        // Those will come as SQL_C_BINARY but will be migrated as NULL for now
+        if (rowbuffer[i-1].buffer_type != MYSQL_TYPE_STRING)
+        {
+          was_null = false;
+          ret = get_char_buffer_data(rowbuffer, i);
+        }
+
+        rowbuffer.finish_field(was_null);
+      }
+      break;
+
+    default:
+      throw std::logic_error(base::strfmt("Unhandled type %i", _column_types[i-1]));
+  }
+  if (!SQL_SUCCEEDED(ret))
+  {
+    rowbuffer.finish_field(true);
+    throw ConnectionError("SQLGetData", ret, SQL_HANDLE_STMT, _stmt);
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Binds the columns of the current result set to arrays, so that SQLFetchScroll() returns a whole block
+ * of rows at once instead of requiring an SQLFetch() plus one SQLGetData() call per value.
+ * Long data and columns whose size is unknown are not bound but read with SQLGetData() per row, which
+ * requires driver support for SQLGetData() in block cursors. Returns false if block fetching is not
+ * possible, in which case the rows are fetched one by one.
+ * Must be called on the first fetch, once the target types are known.
+ */
+bool ODBCCopyDataSource::setup_block_fetch(RowBuffer &rowbuffer)
+{
+  bool has_unbound_columns = false;
+  size_t row_size = 0;
+
+  _bound_columns.clear();
+  _bound_columns.resize(_column_count);
+  for (int i = 0; i < _column_count; ++i)
+  {
+    BoundColumn &column = _bound_columns[i];
+    enum enum_field_types target_type = rowbuffer[i].buffer_type;
+
+    column.c_type = 0;
+    column.time_type = 0;
+    column.value_size = 0;
+    column.converted_size = 0;
+
+    if (target_type == MYSQL_TYPE_BLOB || (*_columns)[i].is_long_data)
+    {
+      has_unbound_columns = true;
+      continue;
+    }
+
+    switch (_column_types[i])
+    {
+      case SQL_C_BIT:
+        column.c_type = SQL_C_STINYINT;
+        column.value_size = sizeof(SQLSCHAR);
+        break;
+      case SQL_C_FLOAT:
+      case SQL_C_DOUBLE:
+        if (target_type == MYSQL_TYPE_FLOAT)
+        {
+          column.c_type = SQL_C_FLOAT;
+          column.value_size = sizeof(SQLREAL);
+        }
+        else
+        {
+          column.c_type = SQL_C_DOUBLE;
+          column.value_size = sizeof(SQLDOUBLE);
+        }
+        break;
+      case SQL_C_DATE:
+        column.time_type = MYSQL_TYPE_DATE;
+        break;
+      case SQL_C_TIME:
+        column.time_type = MYSQL_TYPE_TIME;
+        break;
+      case SQL_C_TIMESTAMP:
+        column.time_type = MYSQL_TYPE_TIMESTAMP;
+        break;
+      case SQL_C_UBIGINT:
+      case SQL_C_SBIGINT:
+        column.c_type = _column_types[i];
+        column.value_size = sizeof(SQLBIGINT);
+        break;
+      case SQL_C_ULONG:
+      case SQL_C_SLONG:
+        column.c_type = _column_types[i];
+        column.value_size = sizeof(SQLINTEGER);
+        break;
+      case SQL_C_USHORT:
+      case SQL_C_SSHORT:
+        column.c_type = _column_types[i];
+        column.value_size = sizeof(SQLSMALLINT);
+        break;
+      case SQL_C_UTINYINT:
+      case SQL_C_STINYINT:
+        column.c_type = _column_types[i];
+        column.value_size = sizeof(SQLSCHAR);
+        break;
+      case SQL_C_WCHAR:
+      case SQL_C_CHAR:
+        switch (target_type)
+        {
           case MYSQL_TYPE_TIME:
           case MYSQL_TYPE_DATE:
           case MYSQL_TYPE_DATETIME:
           case MYSQL_TYPE_NEWDATE:
-            ret = get_date_time_data(rowbuffer, i, rowbuffer[i-1].buffer_type);
-            break;
-          case MYSQL_TYPE_GEOMETRY:
-            ret = get_geometry_buffer_data(rowbuffer, i);
+            column.time_type = target_type;
             break;
-          default:
-            if (_column_types[i-1] == SQL_C_WCHAR)
-              ret = get_wchar_buffer_data(rowbuffer, i);
-            else
-              ret = get_char_buffer_data(rowbuffer, i);
-            break;
-          }
-          break;
-        case SQL_C_BINARY:
+          case MYSQL_TYPE_STRING:
           {
-            bool was_null = true;
+            size_t buffer_length = rowbuffer[i].buffer_length;
+            if (buffer_length == 0 || buffer_length > MAX_BOUND_VALUE_SIZE)
+              break;
 
-            // During the migration process some non standard data types are migrated as strings
-            // Those will come as SQL_C_BINARY but will be migrated as NULL for now
-            if (rowbuffer[i-1].buffer_type != MYSQL_TYPE_STRING)
+            column.c_type = _column_types[i];
+            if (column.c_type == SQL_C_WCHAR)
             {
-              was_null = false;
-              ret = get_char_buffer_data(rowbuffer, i);
+              // The target buffer is sized for UTF-8 (4 bytes per character), so this is enough for all UTF-16 units.
+              column.value_size = (SQLLEN)((buffer_length / 2 + 1) * sizeof(SQLWCHAR));
+              column.converted_size = buffer_length;
             }
-
-            rowbuffer.finish_field(was_null);
+            else
+              column.value_size = (SQLLEN)buffer_length;
+            break;
           }
-          break;
+          default: // Geometries and anything unusual are read as before.
+            break;
+        }
+        break;
+      default:
+        break;
+    }
+
+    if (column.time_type != 0)
+    {
+      // Date and time values are fetched as strings and converted per block.
+      column.c_type = SQL_C_CHAR;
+      column.value_size = DATE_TIME_VALUE_SIZE;
+      column.converted_size = sizeof(MYSQL_TIME);
+    }
+
+    if (column.c_type == 0)
+      has_unbound_columns = true;
+    else
+      row_size += column.value_size + sizeof(SQLLEN) + column.converted_size;
+  }
+
+  if (row_size == 0)
+  {
+    _bound_columns.clear();
+    return false;
+  }
+
+  if (has_unbound_columns)
+  {
+    SQLUINTEGER extensions = 0;
+    if (!SQL_SUCCEEDED(SQLGetInfo(_dbc, SQL_GETDATA_EXTENSIONS, &extensions, sizeof(extensions), NULL))
+        || (extensions & (SQL_GD_BLOCK | SQL_GD_ANY_COLUMN)) != (SQL_GD_BLOCK | SQL_GD_ANY_COLUMN))
+    {
+      log_debug("Driver does not support SQLGetData in block cursors, fetching rows of %s.%s one by one\n",
+                _schema_name.c_str(), _table_name.c_str());
+      _bound_columns.clear();
+      return false;
+    }
+  }
+
+  SQLULEN rows = _block_size > 0 ? (SQLULEN)_block_size : DEFAULT_ROW_ARRAY_SIZE;
+  rows = std::min(rows, (SQLULEN)(MAX_BLOCK_BUFFER_SIZE / row_size));
+
+  SQLRETURN ret = SQL_ERROR;
+  if (rows > 1)
+  {
+    ret = SQLSetStmtAttr(_stmt, SQL_ATTR_ROW_BIND_TYPE, (SQLPOINTER)SQL_BIND_BY_COLUMN, 0);
+    if (SQL_SUCCEEDED(ret))
+      ret = SQLSetStmtAttr(_stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)rows, 0);
+    // The driver may have used a different size (SQLSTATE 01S02).
+    if (SQL_SUCCEEDED(ret))
+      ret = SQLGetStmtAttr(_stmt, SQL_ATTR_ROW_ARRAY_SIZE, &rows, 0, NULL);
+  }
+
+  if (!SQL_SUCCEEDED(ret) || rows < 2)
+  {
+    log_debug("Block fetch not available for %s.%s, fetching rows one by one\n", _schema_name.c_str(), _table_name.c_str());
+    SQLSetStmtAttr(_stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+    _bound_columns.clear();
+    return false;
+  }
+
+  _row_status.resize(rows);
+  SQLSetStmtAttr(_stmt, SQL_ATTR_ROW_STATUS_PTR, &_row_status[0], 0);
+  SQLSetStmtAttr(_stmt, SQL_ATTR_ROWS_FETCHED_PTR, &_rows_fetched, 0);
+
+  for (int i = 0; i < _column_count; ++i)
+  {
+    BoundColumn &column = _bound_columns[i];
+    if (column.c_type == 0)
+      continue;
+
+    column.values.resize(rows * column.value_size);
+    column.indicators.resize(rows);
+    column.converted.resize(rows * column.converted_size);
+    if (column.converted_size > 0 && column.time_type == 0)
+      column.converted_lengths.resize(rows);
+
+    if (!SQL_SUCCEEDED(ret = SQLBindCol(_stmt, (SQLUSMALLINT)(i + 1), column.c_type, &column.values[0],
+                                        column.value_size, &column.indicators[0])))
+      throw ConnectionError("SQLBindCol", ret, SQL_HANDLE_STMT, _stmt);
+  }
+
+  log_debug("Fetching blocks of %lu rows from %s.%s%s\n", (unsigned long)rows, _schema_name.c_str(), _table_name.c_str(),
+            has_unbound_columns ? " (long data read per row)" : "");
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Converts date/time and wide string columns of the block just fetched, column by column, and reports
+ * bound strings that did not fit their slot.
+ */
+void ODBCCopyDataSource::convert_block()
+{
+  for (int i = 0; i < _column_count; ++i)
+  {
+    BoundColumn &column = _bound_columns[i];
+    if (column.c_type == SQL_C_CHAR && column.time_type == 0)
+    {
+      // Longer values were cut to the slot size by the driver (SQLSTATE 01004).
+      size_t truncated = 0;
+      for (SQLULEN row = 0; row < _rows_fetched; ++row)
+      {
+        SQLLEN indicator = column.indicators[row];
+        if (indicator != SQL_NULL_DATA && (indicator == SQL_NO_TOTAL || indicator >= column.value_size))
+          ++truncated;
+      }
+      if (truncated > 0)
+        log_error("Truncated %lu values in column %s to %lu bytes. Possible loss of data.\n",
+                  (unsigned long)truncated, (*_columns)[i].source_name.c_str(), (unsigned long)column.value_size - 1);
+    }
+
+    if (column.converted_size == 0)
+      continue;
+
+    if (column.time_type != 0)
+      BaseConverter::convert_date_time_column(&column.values[0], column.value_size, &column.indicators[0],
+                                              _rows_fetched, (MYSQL_TIME*)&column.converted[0], column.time_type);
+    else
+    {
+      size_t truncated = BaseConverter::ucs2_to_utf8_column(&column.values[0], column.value_size, &column.indicators[0],
+                                                            _rows_fetched, &column.converted[0], column.converted_size,
+                                                            &column.converted_lengths[0]);
+      if (truncated > 0)
+        log_error("Truncated %lu values in column %s. Possible loss of data.\n",
+                  (unsigned long)truncated, (*_columns)[i].source_name.c_str());
+    }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+void ODBCCopyDataSource::get_bound_data(RowBuffer &rowbuffer, int column, SQLULEN row)
+{
+  BoundColumn &bound = _bound_columns[column - 1];
+  SQLLEN indicator = bound.indicators[row];
+  bool was_null = indicator == SQL_NULL_DATA;
+  const char *value = &bound.values[row * bound.value_size];
+
+  char *out_buffer;
+  size_t out_buffer_len;
+  unsigned long *out_length;
 
+  if (bound.time_type != 0)
+  {
+    rowbuffer.prepare_add_time(out_buffer, out_buffer_len);
+    *(MYSQL_TIME*)out_buffer = ((MYSQL_TIME*)&bound.converted[0])[row];
+    rowbuffer.finish_field(was_null);
+    return;
+  }
+
+  switch (bound.c_type)
+  {
+    case SQL_C_UTINYINT:
+    case SQL_C_STINYINT:
+      rowbuffer.prepare_add_tiny(out_buffer, out_buffer_len);
+      *out_buffer = *value;
+      break;
+    case SQL_C_USHORT:
+    case SQL_C_SSHORT:
+      rowbuffer.prepare_add_short(out_buffer, out_buffer_len);
+      memcpy(out_buffer, value, sizeof(SQLSMALLINT));
+      break;
+    case SQL_C_UBIGINT:
+    case SQL_C_SBIGINT:
+      rowbuffer.prepare_add_bigint(out_buffer, out_buffer_len);
+      memcpy(out_buffer, value, sizeof(SQLBIGINT));
+      break;
+    case SQL_C_FLOAT:
+      rowbuffer.prepare_add_float(out_buffer, out_buffer_len);
+      memcpy(out_buffer, value, sizeof(SQLREAL));
+      break;
+    case SQL_C_DOUBLE:
+      rowbuffer.prepare_add_double(out_buffer, out_buffer_len);
+      memcpy(out_buffer, value, sizeof(SQLDOUBLE));
+      break;
+    case SQL_C_ULONG:
+    case SQL_C_SLONG:
+    {
+      long tmp_buffer = bound.c_type == SQL_C_ULONG ? (long)*(const SQLUINTEGER*)value : (long)*(const SQLINTEGER*)value;
+      bool unsig;
+      enum enum_field_types target_type;
+      switch ((target_type = rowbuffer.target_type(unsig)))
+      {
+        case MYSQL_TYPE_SHORT:
+          rowbuffer.prepare_add_short(out_buffer, out_buffer_len);
+          if (!was_null && ((unsig && (tmp_buffer < 0 || tmp_buffer > UINT16_MAX)) || (!unsig && (tmp_buffer > INT16_MAX || tmp_buffer < INT16_MIN))))
+            throw std::logic_error(base::strfmt("Range error fetching field %i (value %li, target is %s)",
+                                                column, tmp_buffer, mysql_field_type_to_name(target_type)));
+          *(short*)out_buffer = (short)tmp_buffer;
+          break;
+        case MYSQL_TYPE_TINY:
+          rowbuffer.prepare_add_tiny(out_buffer, out_buffer_len);
+          if (!was_null && ((unsig && (tmp_buffer < 0 || tmp_buffer > UINT8_MAX)) || (!unsig && (tmp_buffer > INT8_MAX || tmp_buffer < INT8_MIN))))
+            throw std::logic_error(base::strfmt("Range error fetching field %i (value %li, target is %s)",
+                                                column, tmp_buffer, mysql_field_type_to_name(target_type)));
+          *(char*)out_buffer = (char)tmp_buffer;
+          break;
         default:
-          throw std::logic_error(base::strfmt("Unhandled type %i", _column_types[i-1]));
+          rowbuffer.prepare_add_long(out_buffer, out_buffer_len);
+          *(int*)out_buffer = (int)tmp_buffer;
+          break;
       }
+      break;
+    }
+    case SQL_C_CHAR:
+      rowbuffer.prepare_add_string(out_buffer, out_buffer_len, out_length);
+      if (!was_null)
+      {
+        if (indicator == SQL_NO_TOTAL)
+          throw std::runtime_error(base::strfmt("Got SQL_NO_TOTAL for string size during copy of column %i", column));
+
+        // A truncated value is zero terminated in its slot.
+        size_t length = indicator >= bound.value_size ? (size_t)bound.value_size - 1 : (size_t)indicator;
+        memcpy(out_buffer, value, std::min(length, out_buffer_len));
+        *out_length = (unsigned long)std::min(length, out_buffer_len);
+      }
+      break;
+    case SQL_C_WCHAR:
+      rowbuffer.prepare_add_string(out_buffer, out_buffer_len, out_length);
+      if (!was_null)
+      {
+        if (indicator == SQL_NO_TOTAL)
+          throw std::runtime_error(base::strfmt("Got SQL_NO_TOTAL for string size during copy of column %i", column));
+
+        size_t length = std::min((size_t)bound.converted_lengths[row], out_buffer_len);
+        memcpy(out_buffer, &bound.converted[row * bound.converted_size], length);
+        *out_length = (unsigned long)length;
+      }
+      break;
+    default:
+      throw std::logic_error(base::strfmt("Unhandled type %i", bound.c_type));
+  }
+  rowbuffer.finish_field(was_null);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ODBCCopyDataSource::fetch_block_row(RowBuffer &rowbuffer)
+{
+  if (_block_row >= _rows_fetched)
+  {
+    SQLRETURN ret = SQLFetchScroll(_stmt, SQL_FETCH_NEXT, 0);
+    if (ret == SQL_NO_DATA)
+      return false;
+    if (!SQL_SUCCEEDED(ret))
+      throw ConnectionError("SQLFetchScroll", ret, SQL_HANDLE_STMT, _stmt);
+
+    _block_row = 0;
+    if (_rows_fetched == 0)
+      return false;
+    convert_block();
+  }
+
+  SQLULEN row = _block_row;
+  if (_row_status[row] == SQL_ROW_ERROR)
+    throw std::runtime_error(base::strfmt("Error fetching row from table %s.%s", _schema_name.c_str(), _table_name.c_str()));
+
+  // Make the current row of the block the one SQLGetData() reads from. This is done before any field
+  // is added to the row buffer, so the row can still be read the normal way if the driver fails here.
+  for (int i = 0; i < _column_count; i++)
+  {
+    if (_bound_columns[i].c_type == 0)
+    {
+      SQLRETURN ret = SQLSetPos(_stmt, (SQLSETPOSIROW)(row + 1), SQL_POSITION, SQL_LOCK_NO_CHANGE);
       if (!SQL_SUCCEEDED(ret))
       {
-        rowbuffer.finish_field(true);
-        throw ConnectionError("SQLGetData", ret, SQL_HANDLE_STMT, _stmt);
+        log_warning("SQLSetPos failed for a row of %s.%s, continuing the copy row by row\n",
+                    _schema_name.c_str(), _table_name.c_str());
+        restart_row_fetch();
+        return fetch_single_row(rowbuffer);
       }
+      break;
+    }
+  }
+  _block_row++;
+
+  for (int i = 1; i <= _column_count; i++)
+  {
+    if (_bound_columns[i - 1].c_type != 0)
+      get_bound_data(rowbuffer, i, row);
+    else
+      get_column_data(rowbuffer, i);
+  }
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Switches from block fetching to the row by row fetch for the rest of the table. Rows of the current
+ * block cannot be read anymore once positioning failed, so the query is executed again and all rows
+ * already returned are skipped. This relies on the query being ordered by the primary key, without one
+ * the rows skipped need not be the ones already copied and the copy is aborted instead.
+ */
+void ODBCCopyDataSource::restart_row_fetch()
+{
+  if (!_select_ordered)
+    throw std::runtime_error(base::strfmt("Cannot continue copying table %s.%s row by row after the driver failed to "
+                                          "position in a fetched block: the table has no primary key to order the rows by, "
+                                          "so the %lu rows already copied cannot be skipped reliably",
+                                          _schema_name.c_str(), _table_name.c_str(), (unsigned long)_rows_returned));
+
+  _block_fetch = false;
+  _bound_columns.clear();
+  _row_status.clear();
+  _rows_fetched = 0;
+  _block_row = 0;
+
+  SQLFreeStmt(_stmt, SQL_CLOSE);
+  SQLFreeStmt(_stmt, SQL_UNBIND);
+  SQLSetStmtAttr(_stmt, SQL_ATTR_ROW_STATUS_PTR, NULL, 0);
+  SQLSetStmtAttr(_stmt, SQL_ATTR_ROWS_FETCHED_PTR, NULL, 0);
+  SQLSetStmtAttr(_stmt, SQL_ATTR_ROW_ARRAY_SIZE, (SQLPOINTER)1, 0);
+
+  SQLRETURN ret;
+  log_debug("Executing query: %s\n", _select_query.c_str());
+  if (!SQL_SUCCEEDED(ret = SQLExecDirect(_stmt, (SQLCHAR*)_select_query.c_str(), SQL_NTS)))
+    throw ConnectionError("SQLExecDirect(" + _select_query + ")", ret, SQL_HANDLE_STMT, _stmt);
+
+  for (size_t i = 0; i < _rows_returned; ++i)
+  {
+    ret = SQLFetch(_stmt);
+    if (!SQL_SUCCEEDED(ret))
+    {
+      if (ret == SQL_NO_DATA)
+        throw std::runtime_error(base::strfmt("Table %s.%s changed while it was copied",
+                                              _schema_name.c_str(), _table_name.c_str()));
+      throw ConnectionError("SQLFetch", ret, SQL_HANDLE_STMT, _stmt);
     }
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool ODBCCopyDataSource::fetch_single_row(RowBuffer &rowbuffer)
+{
+  if (SQL_SUCCEEDED(SQLFetch(_stmt)))
+  {
+    for (int i = 1; i <= _column_count; i++)
+      get_column_data(rowbuffer, i);
     return true;
   }
   return false;
 }
 
+//--------------------------------------------------------------------------------------------------
+
+bool ODBCCopyDataSource::fetch_row(RowBuffer &rowbuffer)
+{
+  if (!_block_fetch_checked)
+  {
+    _block_fetch_checked = true;
+    _block_fetch = setup_block_fetch(rowbuffer);
+  }
+
+  bool result = _block_fetch ? fetch_block_row(rowbuffer) : fetch_single_row(rowbuffer);
+  if (result)
+    ++_rows_returned;
+  return result;
+}
+
 
 MySQLCopyDataSource::MySQLCopyDataSource(const std::string &hostname, int port,
                     const std::string &username, const std::string &password,
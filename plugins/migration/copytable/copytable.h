@@ -235,10 +235,44 @@ class ODBCCopyDataSource : public CopyDataSource
 
   std::string _source_rdbms_type;
 
+  // Column-wise bound buffers for block fetching (SQL_ATTR_ROW_ARRAY_SIZE > 1). Columns with a c_type of 0
+  // are not bound and read with SQLGetData (long data, geometries etc.).
+  struct BoundColumn
+  {
+    SQLSMALLINT c_type;
+    int time_type;              // The MYSQL_TYPE_* for date/time values, which are fetched as strings.
+    SQLLEN value_size;
+    std::vector<char> values;
+    std::vector<SQLLEN> indicators;
+
+    // Values converted for the whole block after each fetch (MYSQL_TIME or UTF-8 strings).
+    size_t converted_size;
+    std::vector<char> converted;
+    std::vector<unsigned long> converted_lengths;
+  };
+  std::vector<BoundColumn> _bound_columns;
+  std::vector<SQLUSMALLINT> _row_status;
+  SQLULEN _rows_fetched;
+  SQLULEN _block_row;
+  bool _block_fetch_checked;
+  bool _block_fetch;
+
+  std::string _select_query;
+  bool _select_ordered;  // The query has an ORDER BY, so a re-executed query returns the rows in the same order.
+  size_t _rows_returned; // Rows of the current table returned by fetch_row().
+
   SQLSMALLINT odbc_type_to_c_type(SQLSMALLINT type, bool is_unsigned);
 
   void ucs2_to_utf8(char *inbuf, size_t inbuf_len, char *&utf8buf, size_t &utf8buf_len);
 
+  bool setup_block_fetch(RowBuffer &rowbuffer);
+  void convert_block();
+  bool fetch_block_row(RowBuffer &rowbuffer);
+  bool fetch_single_row(RowBuffer &rowbuffer);
+  void restart_row_fetch();
+  void get_bound_data(RowBuffer &rowbuffer, int column, SQLULEN row);
+  void get_column_data(RowBuffer &rowbuffer, int column);
+
 public:
   ODBCCopyDataSource(SQLHENV env,
                      const std::string &connstring,
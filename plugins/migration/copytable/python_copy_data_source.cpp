@@ -31,12 +31,20 @@
 #include "converter.h"
 
 #include <boost/algorithm/string.hpp>
+#include <algorithm>
 
 DEFAULT_LOG_DOMAIN("copytable");
 
+// Number of rows requested from the cursor at once if no block size was set.
+#define DEFAULT_FETCH_BATCH_SIZE 1000
+
+// Upper limit of rows per batch for tables with blob columns, which are held in memory until written.
+#define BLOB_FETCH_BATCH_SIZE 32
+
 PythonCopyDataSource::PythonCopyDataSource(const std::string &connstring,
                      const std::string &password)
-: _password(password), _connection(NULL), _cursor(NULL), initialized(false)
+: _password(password), _connection(NULL), _cursor(NULL), _column_count(0), _batch_refs(NULL),
+  _batch_rows(0), _batch_row(0), _batch_failed(false), _no_more_rows(false), initialized(false)
 {
   // connstring comes as "pythonmodule://connection_parameters"
   std::vector<std::string> conn_parts = base::split(connstring, "://", 1);
@@ -63,6 +71,7 @@ PythonCopyDataSource::PythonCopyDataSource(const std::string &connstring,
 PythonCopyDataSource::~PythonCopyDataSource()
 {
   PyGILState_STATE state = PyGILState_Ensure();
+  Py_XDECREF(_batch_refs);
   Py_XDECREF(_cursor);
   Py_XDECREF(_connection);
   PyGILState_Release(state);
@@ -306,6 +315,11 @@ boost::shared_ptr<std::vector<ColumnInfo> > PythonCopyDataSource::begin_select_t
   _schema_name = schema;
   _table_name = table;
 
+  release_batch();
+  _column_kinds.clear();
+  _batch_failed = false;
+  _no_more_rows = false;
+
   std::string q;
 
   PyGILState_STATE state = PyGILState_Ensure();
@@ -400,43 +414,113 @@ boost::shared_ptr<std::vector<ColumnInfo> > PythonCopyDataSource::begin_select_t
 
 void PythonCopyDataSource::end_select_table()
 {
+  release_batch();
 }
 
-bool PythonCopyDataSource::fetch_row(RowBuffer &rowbuffer)
+//--------------------------------------------------------------------------------------------------
+
+void PythonCopyDataSource::release_batch()
 {
-  PyGILState_STATE state = PyGILState_Ensure();
-  if (!_cursor || _cursor == Py_None)
+  if (_batch_refs)
   {
-    if (PyErr_Occurred())
-      PyErr_Print();
-    log_error("No cursor object available while attempting to fetch a row. Skipping table %s\n",
-              _table_name.c_str());
+    PyGILState_STATE state = PyGILState_Ensure();
+    Py_CLEAR(_batch_refs);
     PyGILState_Release(state);
-    return false;
   }
+  _batch_rows = 0;
+  _batch_row = 0;
+}
 
-  PyObject * row = PyObject_CallMethod(_cursor, (char*)"fetchone", NULL);
-  if (row == NULL || row == Py_None)
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Decides once per table how the values of each column must be converted. The target types are
+ * only known after set_target_table() has been called on the target, i.e. after begin_select_table().
+ */
+void PythonCopyDataSource::prepare_column_kinds()
+{
+  _column_kinds.clear();
+  _column_kinds.reserve(_column_count);
+  for (size_t i = 0; i < _column_count; ++i)
   {
-    PyGILState_Release(state);
-    return false;
+    const ColumnInfo &column = (*_columns)[i];
+    ValueKind kind;
+
+    if (column.target_type == MYSQL_TYPE_BLOB || column.is_long_data || column.target_type == MYSQL_TYPE_GEOMETRY)
+      kind = ValueBlob;
+    else
+    {
+      switch (column.target_type)
+      {
+        case MYSQL_TYPE_TINY:
+          kind = ValueTiny;
+          break;
+        case MYSQL_TYPE_YEAR:
+        case MYSQL_TYPE_SHORT:
+          kind = ValueShort;
+          break;
+        case MYSQL_TYPE_INT24:
+        case MYSQL_TYPE_LONG:
+          kind = ValueLong;
+          break;
+        case MYSQL_TYPE_LONGLONG:
+          kind = ValueLongLong;
+          break;
+        case MYSQL_TYPE_FLOAT:
+          kind = ValueFloat;
+          break;
+        case MYSQL_TYPE_DOUBLE:
+          kind = ValueDouble;
+          break;
+        case MYSQL_TYPE_TIME:
+        case MYSQL_TYPE_DATE:
+        case MYSQL_TYPE_NEWDATE:
+        case MYSQL_TYPE_DATETIME:
+        case MYSQL_TYPE_TIMESTAMP:
+          kind = ValueTime;
+          break;
+        case MYSQL_TYPE_NEWDECIMAL:
+        case MYSQL_TYPE_STRING:
+        case MYSQL_TYPE_VAR_STRING:
+        case MYSQL_TYPE_BIT:
+          kind = ValueString;
+          break;
+        case MYSQL_TYPE_NULL:
+          kind = ValueNull;
+          break;
+        default:
+          kind = ValueUnsupported;
+          break;
+      }
+    }
+    _column_kinds.push_back(kind);
   }
+}
 
-  char *buffer;
-  size_t buffer_len;
-  PyObject * element;
+//--------------------------------------------------------------------------------------------------
 
-  for (size_t i=0; i<_column_count; ++i)
+/**
+ * Converts a single Python value to its native representation. Must be called with the GIL held.
+ * Takes over the reference to element. Returns false if the value cannot be converted, in which
+ * case the table is skipped (after the rows preceding the failing one were written).
+ */
+bool PythonCopyDataSource::convert_value(PyObject *element, size_t column, BatchValue &value)
+{
+  const ColumnInfo &info = (*_columns)[column];
+
+  value.is_null = element == Py_None;
+  value.data = NULL;
+  value.length = 0;
+  if (value.is_null)
   {
-    element = PySequence_GetItem(row, i);
-    if (rowbuffer.check_if_blob() || (*_columns)[i].is_long_data || (*_columns)[i].target_type == MYSQL_TYPE_GEOMETRY)
+    Py_DECREF(element);
+    return true;
+  }
+
+  switch (_column_kinds[column])
+  {
+    case ValueBlob:
     {
-      if (element == Py_None)
-      {
-        rowbuffer.finish_field(true);
-        Py_DECREF(element);
-        continue;
-      }
       if (PyUnicode_Check(element))
       {
         PyObject *element_ref = element;
@@ -446,9 +530,9 @@ bool PythonCopyDataSource::fetch_row(RowBuffer &rowbuffer)
         {
           if (PyErr_Occurred())
             PyErr_Print();
+          Py_XDECREF(element);
           log_error("An error occurred while encoding unicode data as UTF-8 in a long field object at column %s.%s. Skipping table!\n.",
-              _table_name.c_str(), (*_columns)[i].source_name.c_str() );
-          PyGILState_Release(state);
+            _table_name.c_str(), info.source_name.c_str());
           return false;
         }
       }
@@ -463,251 +547,377 @@ bool PythonCopyDataSource::fetch_row(RowBuffer &rowbuffer)
           PyErr_Print();
           Py_XDECREF(element);
           log_error("Unexpected value for BLOB object at column %s.%s. Skipping table!\n.",
-              _table_name.c_str(), (*_columns)[i].source_name.c_str() );
-          PyGILState_Release(state);
+            _table_name.c_str(), info.source_name.c_str());
           return false;
         }
       }
+
       const char *blob_read_buffer;
       Py_ssize_t blob_read_buffer_len;
-      int res = PyObject_AsReadBuffer(element, (const void **) &blob_read_buffer, &blob_read_buffer_len);
-      if (res != 0)
+      if (PyObject_AsReadBuffer(element, (const void **) &blob_read_buffer, &blob_read_buffer_len) != 0)
       {
         if (PyErr_Occurred())
           PyErr_Print();
         log_error("Could not get a read buffer for the BLOB column %s.%s. Skipping table!\n",
-                  _table_name.c_str(), (*_columns)[i].source_name.c_str() );
+          _table_name.c_str(), info.source_name.c_str());
         Py_DECREF(element);
-        PyGILState_Release(state);
         return false;
       }
-      if (blob_read_buffer_len > _max_parameter_size)
+      value.data = blob_read_buffer;
+      value.length = blob_read_buffer_len;
+      break;
+    }
+
+    case ValueTiny:
+    case ValueShort:
+      value.int_value = PyInt_AsLong(element);
+      break;
+
+    case ValueLong:
+      if (info.is_unsigned)
+        value.int_value = (long long)PyInt_AsUnsignedLongMask(element);
+      else
+        value.int_value = PyInt_AsLong(element);
+      break;
+
+    case ValueLongLong:
+      if (info.is_unsigned)
+        value.int_value = (long long)(PyInt_Check(element) ? PyInt_AsUnsignedLongLongMask(element) : PyLong_AsUnsignedLongLong(element));
+      else
+        value.int_value = PyLong_AsLongLong(element);
+      break;
+
+    case ValueFloat:
+    case ValueDouble:
+      value.double_value = PyFloat_AsDouble(element);
+      break;
+
+    case ValueTime:
+      // The select query can yield these fields as Unicode/strings or as datetime.* objects.
+      memset(&value.time_value, 0, sizeof(value.time_value));
+      if (PyObject_HasAttrString(element, "isoformat"))  // element is a python datetime.* object
+      {
+        PyObject *old_ref = element;
+        element = PyObject_CallMethod(element, (char*)"isoformat", NULL); // Will return an ISO 8601 string representation of the date/time/datetime object
+        Py_DECREF(old_ref);
+      }
+      if (element && (PyUnicode_Check(element) || PyString_Check(element)))  // element is a string (sqlite sends time data as strings)
+      {
+        std::string elem_str;
+        pystring_to_string(element, elem_str);
+        BaseConverter::convert_date_time(elem_str.c_str(), &value.time_value, info.target_type);
+      }
+      else
+      {
+        Py_XDECREF(element);
+        throw std::logic_error(base::strfmt("Wrong python type for date/time/datetime column %s found in table %s.%s: "
+          "A string or datetime.* object is expected",
+          info.source_name.c_str(), _schema_name.c_str(), _table_name.c_str()));
+      }
+      break;
+
+    case ValueString:
+      // Target type can be MYSQL_TYPE_STRING for decimal columns and yet values can be ints or floats
+      // If that's the case, get str(element) for insertion:
+      if (PyFloat_Check(element) || PyInt_Check(element) || PyLong_Check(element))
       {
-        if (_abort_on_oversized_blobs)
+        PyObject *elem_ref = element;
+        element = PyObject_Str(element);
+        Py_DECREF(elem_ref);
+      }
+
+      if (element && PyUnicode_Check(element))
+      {
+        PyObject *ref = PyUnicode_AsUTF8String(element);
+        Py_DECREF(element);
+        if (!ref)
         {
-          PyGILState_Release(state);
-          throw std::runtime_error(base::strfmt("oversized blob found in table %s.%s, size: %lu",
-                                   _schema_name.c_str(), _table_name.c_str(),
-                                   (long unsigned int) blob_read_buffer_len ));
+          log_error("Could not convert unicode string to UTF-8\n");
+          return false;
         }
-        else
+        element = ref;
+      }
+
+      if (element && PyString_Check(element))
+      {
+        char *s;
+        PyString_AsStringAndSize(element, &s, &value.length);
+        value.data = s;
+      }
+      else  // Neither a PyUnicode nor a PyString object. This should be an error:
+      {
+        log_error("The python object for column %s is neither a PyUnicode nor a PyString object. Skipping table...\n", info.source_name.c_str());
+        Py_XDECREF(element);
+        return false;
+      }
+      break;
+
+    case ValueNull:
+      break;
+
+    case ValueUnsupported:
+      Py_DECREF(element);
+      throw std::logic_error(base::strfmt("Unhandled MySQL type %i for column '%s'", info.target_type, info.target_name.c_str()));
+  }
+
+  // Keep the (possibly converted) object alive as long as the batch refers to its data.
+  if (value.data)
+    PyList_Append(_batch_refs, element);
+  Py_DECREF(element);
+  return true;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Fetches the next block of rows with cursor.fetchmany() and converts all of its values while holding
+ * the GIL once, instead of acquiring it and calling fetchone() for every row.
+ * Returns false if there are no more rows or the table must be skipped.
+ */
+bool PythonCopyDataSource::fetch_batch()
+{
+  release_batch();
+
+  PyGILState_STATE state = PyGILState_Ensure();
+  if (!_cursor || _cursor == Py_None)
+  {
+    if (PyErr_Occurred())
+      PyErr_Print();
+    log_error("No cursor object available while attempting to fetch a row. Skipping table %s\n",
+              _table_name.c_str());
+    PyGILState_Release(state);
+    return false;
+  }
+
+  // Blob values are kept in memory until the batch is written, so use smaller batches for them.
+  size_t batch_size = _block_size > 0 ? _block_size : DEFAULT_FETCH_BATCH_SIZE;
+  if (std::find(_column_kinds.begin(), _column_kinds.end(), ValueBlob) != _column_kinds.end())
+    batch_size = std::min(batch_size, (size_t)BLOB_FETCH_BATCH_SIZE);
+
+  PyObject *rows = PyObject_CallMethod(_cursor, (char*)"fetchmany", (char*)"(i)", (int)batch_size);
+  PyObject *fast_rows = rows ? PySequence_Fast(rows, "fetchmany() did not return a sequence") : NULL;
+  Py_XDECREF(rows);
+  if (!fast_rows)
+  {
+    if (PyErr_Occurred())
+      PyErr_Print();
+    PyGILState_Release(state);
+    return false;
+  }
+
+  size_t row_count = (size_t)PySequence_Fast_GET_SIZE(fast_rows);
+  if (row_count < batch_size)
+    _no_more_rows = true;
+
+  _batch_refs = PyList_New(0);
+  PyList_Append(_batch_refs, fast_rows); // Row objects own the string values we point to.
+  Py_DECREF(fast_rows);
+
+  _batch.resize(row_count * _column_count);
+  try
+  {
+    for (size_t r = 0; r < row_count; ++r)
+    {
+      PyObject *row = PySequence_Fast_GET_ITEM(fast_rows, r);
+      BatchValue *values = &_batch[r * _column_count];
+      for (size_t i = 0; i < _column_count; ++i)
+      {
+        PyObject *element = PySequence_GetItem(row, i);
+        if (!element || !convert_value(element, i, values[i]))
+        {
+          if (!element && PyErr_Occurred())
+            PyErr_Print();
+          _batch_failed = true;
+          break;
+        }
+      }
+      if (_batch_failed)
+        break;
+      _batch_rows = r + 1;
+    }
+  }
+  catch (...)
+  {
+    Py_CLEAR(_batch_refs);
+    _batch_rows = 0;
+    PyGILState_Release(state);
+    throw;
+  }
+  PyGILState_Release(state);
+
+  return _batch_rows > 0;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+bool PythonCopyDataSource::fetch_row(RowBuffer &rowbuffer)
+{
+  if (_column_kinds.size() != _column_count)
+    prepare_column_kinds();
+
+  if (_batch_row >= _batch_rows)
+  {
+    if (_batch_failed || _no_more_rows || !fetch_batch())
+      return false;
+  }
+
+  // From here on no Python object is touched, so the GIL is not needed.
+  const BatchValue *values = &_batch[_batch_row++ * _column_count];
+
+  char *buffer;
+  size_t buffer_len;
+  unsigned long *length;
+
+  for (size_t i = 0; i < _column_count; ++i)
+  {
+    const BatchValue &value = values[i];
+    bool is_unsigned = (*_columns)[i].is_unsigned;
+
+    switch (_column_kinds[i])
+    {
+      case ValueBlob:
+        if (value.is_null)
+        {
+          rowbuffer.finish_field(true);
+          break;
+        }
+        if (value.length > _max_parameter_size)
         {
+          if (_abort_on_oversized_blobs)
+            throw std::runtime_error(base::strfmt("oversized blob found in table %s.%s, size: %lu",
+                                     _schema_name.c_str(), _table_name.c_str(),
+                                     (long unsigned int) value.length));
+
           log_error("Oversized blob found in table %s.%s, size: %lu",
                     _schema_name.c_str(), _table_name.c_str(),
-                    (long unsigned int) blob_read_buffer_len);
+                    (long unsigned int) value.length);
           rowbuffer.finish_field(true);
-          Py_DECREF(element);
-          continue;
+          break;
         }
-      }
-      else  // Proceed to copy from the buffer
-      {
-        Py_ssize_t copied_bytes = 0;
-        if (!blob_read_buffer_len) // empty buffer
+
+        if (!value.length) // empty buffer
         {
-          rowbuffer[i].buffer_length = *rowbuffer[i].length = (unsigned long)blob_read_buffer_len;
+          rowbuffer[i].buffer_length = *rowbuffer[i].length = 0;
           rowbuffer[i].buffer = NULL;
         }
-        while (copied_bytes < blob_read_buffer_len)
+        else if (_use_bulk_inserts)
         {
-          Py_ssize_t this_pass_size = std::min(blob_read_buffer_len - copied_bytes, (Py_ssize_t) _max_blob_chunk_size);
-          // ---- Begin Section: This will fail if multiple passes are done. TODO: Fix this.
-          if (_use_bulk_inserts)
-          {
-            if (rowbuffer[i].buffer_length)
-              free(rowbuffer[i].buffer);
+          if (rowbuffer[i].buffer_length)
+            free(rowbuffer[i].buffer);
 
-            *rowbuffer[i].length = (unsigned long)blob_read_buffer_len;
-            rowbuffer[i].buffer_length = (unsigned long)blob_read_buffer_len;
-            rowbuffer[i].buffer = malloc(blob_read_buffer_len);
+          *rowbuffer[i].length = (unsigned long)value.length;
+          rowbuffer[i].buffer_length = (unsigned long)value.length;
+          rowbuffer[i].buffer = malloc(value.length);
 
-            memcpy(rowbuffer[i].buffer, blob_read_buffer, blob_read_buffer_len);
+          memcpy(rowbuffer[i].buffer, value.data, value.length);
+        }
+        else
+        {
+          Py_ssize_t copied_bytes = 0;
+          while (copied_bytes < value.length)
+          {
+            Py_ssize_t this_pass_size = std::min(value.length - copied_bytes, (Py_ssize_t) _max_blob_chunk_size);
+            rowbuffer.send_blob_data(value.data + copied_bytes, this_pass_size);
+            copied_bytes += this_pass_size;
           }
-          else
-            rowbuffer.send_blob_data(blob_read_buffer + copied_bytes, this_pass_size);
-          // ---- End Section
-          copied_bytes += this_pass_size;
         }
         rowbuffer.finish_field(false);
-        Py_DECREF(element);
-        continue;
-      }
-    }
-    bool was_null = element == Py_None;
-    enum enum_field_types target_type = (*_columns)[i].target_type;
-    bool is_unsigned = (*_columns)[i].is_unsigned;
-    switch (target_type)
-    {
-      case MYSQL_TYPE_TINY:
+        break;
+
+      case ValueTiny:
         rowbuffer.prepare_add_tiny(buffer, buffer_len);
-        if (!was_null)
+        if (!value.is_null)
         {
           if (is_unsigned)
-            *( (unsigned char *) buffer) = (unsigned char) PyInt_AsLong(element);
+            *( (unsigned char *) buffer) = (unsigned char) value.int_value;
           else
-            *buffer = (char) PyInt_AsLong(element);
+            *buffer = (char) value.int_value;
         }
-        rowbuffer.finish_field(was_null);
+        rowbuffer.finish_field(value.is_null);
         break;
-      case MYSQL_TYPE_YEAR:
-      case MYSQL_TYPE_SHORT:
+
+      case ValueShort:
         rowbuffer.prepare_add_short(buffer, buffer_len);
-        if (!was_null)
+        if (!value.is_null)
         {
           if (is_unsigned)
-            *( (unsigned short *) buffer) = (unsigned short) PyInt_AsLong(element);
+            *( (unsigned short *) buffer) = (unsigned short) value.int_value;
           else
-            *( (short *) buffer) = (short) PyInt_AsLong(element);
+            *( (short *) buffer) = (short) value.int_value;
         }
-        rowbuffer.finish_field(was_null);
+        rowbuffer.finish_field(value.is_null);
         break;
-      case MYSQL_TYPE_INT24:
-      case MYSQL_TYPE_LONG:
+
+      case ValueLong:
+        // The bind buffer for LONG columns is sizeof(int) large.
         rowbuffer.prepare_add_long(buffer, buffer_len);
-        if (!was_null)
+        if (!value.is_null)
         {
           if (is_unsigned)
-            *( (unsigned long *) buffer) = PyInt_AsUnsignedLongMask(element);
+            *( (unsigned int *) buffer) = (unsigned int) value.int_value;
           else
-            *( (long *) buffer) = PyInt_AsLong(element);
+            *( (int *) buffer) = (int) value.int_value;
         }
-        rowbuffer.finish_field(was_null);
+        rowbuffer.finish_field(value.is_null);
         break;
-      case MYSQL_TYPE_LONGLONG:
+
+      case ValueLongLong:
         rowbuffer.prepare_add_bigint(buffer, buffer_len);
-        if (!was_null)
-        {
-          if (is_unsigned)
-            *( (unsigned long long *) buffer) = PyInt_Check(element) ? PyInt_AsUnsignedLongLongMask(element) : PyLong_AsUnsignedLongLong(element);
-          else
-            *( (long long *) buffer) = PyLong_AsLongLong(element);
-        }
-        rowbuffer.finish_field(was_null);
+        if (!value.is_null)
+          *( (long long *) buffer) = value.int_value;
+        rowbuffer.finish_field(value.is_null);
         break;
-      case MYSQL_TYPE_FLOAT:
+
+      case ValueFloat:
         rowbuffer.prepare_add_float(buffer, buffer_len);
-        if (!was_null)
-          *( (float *) buffer) = (float) PyFloat_AsDouble(element);
-        rowbuffer.finish_field(was_null);
+        if (!value.is_null)
+          *( (float *) buffer) = (float) value.double_value;
+        rowbuffer.finish_field(value.is_null);
         break;
-      case MYSQL_TYPE_DOUBLE:
+
+      case ValueDouble:
         rowbuffer.prepare_add_double(buffer, buffer_len);
-        if (!was_null)
-          *( (double *) buffer) = PyFloat_AsDouble(element);
-        rowbuffer.finish_field(was_null);
+        if (!value.is_null)
+          *( (double *) buffer) = value.double_value;
+        rowbuffer.finish_field(value.is_null);
         break;
-      case MYSQL_TYPE_TIME:
-      case MYSQL_TYPE_DATE:
-      case MYSQL_TYPE_NEWDATE:
-      case MYSQL_TYPE_DATETIME:
-      case MYSQL_TYPE_TIMESTAMP:
+
+      case ValueTime:
         rowbuffer.prepare_add_time(buffer, buffer_len);
-        // The select query can yield these fields as Unicode/strings or as datetime.* objects
-        if (element == Py_None)  // element is NULL
-            ((MYSQL_TIME *) buffer)->time_type = MYSQL_TIMESTAMP_NONE;
+        if (value.is_null)
+          ((MYSQL_TIME *) buffer)->time_type = MYSQL_TIMESTAMP_NONE;
         else
-        { if (PyObject_HasAttrString(element, "isoformat"))  // element is a python datetime.* object
-          {
-            PyObject *old_ref = element;
-            element = PyObject_CallMethod(element, (char*)"isoformat", NULL); // Will return an ISO 8601 string representation of the date/time/datetime object
-            Py_DECREF(old_ref);
-          }
-          if (PyUnicode_Check(element) || PyString_Check(element))  // element is a string (sqlite sends time data as strings)
-          {
-            std::string elem_str;
-            pystring_to_string(element, elem_str);
-            BaseConverter::convert_date_time(elem_str.c_str(), (MYSQL_TIME*)buffer, rowbuffer[i].buffer_type);
-          }
-          else
-          {
-            PyGILState_Release(state);
-            throw std::logic_error(base::strfmt("Wrong python type for date/time/datetime column %s found in table %s.%s: "
-                                   "A string or datetime.* object is expected",
-                                   (*_columns)[i].source_name.c_str(), _schema_name.c_str(), _table_name.c_str()));
-          }
-        }
-
-        rowbuffer.finish_field(was_null);
+          *((MYSQL_TIME *) buffer) = value.time_value;
+        rowbuffer.finish_field(value.is_null);
         break;
-      case MYSQL_TYPE_NEWDECIMAL:
-      case MYSQL_TYPE_STRING:
-      case MYSQL_TYPE_VAR_STRING:
-      case MYSQL_TYPE_BIT:
-        unsigned long *length;
-        rowbuffer.prepare_add_string(buffer, buffer_len, length);
 
-        if (!was_null)
+      case ValueString:
+      {
+        rowbuffer.prepare_add_string(buffer, buffer_len, length);
+        if (!value.is_null)
         {
-          // Target type can be MYSQL_TYPE_STRING for decimal columns and yet values can be ints or floats
-          // If that's the case, get str(element) for insertion:
-          if (PyFloat_Check(element) || PyInt_Check(element) || PyLong_Check(element))
-          {
-            PyObject *elem_ref = element;
-            element = PyObject_Str(element);
-            Py_DECREF(elem_ref);
-          }
-
-          if (PyUnicode_Check(element))
+          size_t len = (size_t)value.length;
+          if (buffer_len < len)
           {
-            PyObject *ref = PyUnicode_AsUTF8String(element);
-            if (ref)
-            {
-              char *s;
-              Py_ssize_t len;
-              PyString_AsStringAndSize(ref, &s, &len);
-              if (buffer_len < (size_t)len)
-              {
-                log_error("Truncating data in column %s from %lul to %lul. Possible loss of data.\n",
-                          (*_columns)[i].source_name.c_str(),
-                          (long unsigned int) len, (long unsigned int) buffer_len);
-                len = buffer_len;
-              }
-              memcpy(buffer, s, len);
-              *length = (unsigned long)len;
-              Py_DECREF(ref);
-            }
-            else
-            {
-              log_error("Could not convert unicode string to UTF-8\n");
-              PyGILState_Release(state);
-              return false;
-            }
-          }
-          else
-          if (PyString_Check(element))
-          {
-            char *s;
-            Py_ssize_t len;
-            PyString_AsStringAndSize(element, &s, &len);
-            if (buffer_len < (size_t)len)
-            {
-              log_error("Truncating data in column %s from %lul to %lul. Possible loss of data.\n",
-                        (*_columns)[i].source_name.c_str(),
-                        (long unsigned int) len, (long unsigned int) buffer_len);
-              len = buffer_len;
-            }
-            memcpy(buffer, s, len);
-            *length = (unsigned long)len;
-          }
-          else  // Neither a PyUnicode nor a PyString object. This should be an error:
-          {
-            log_error("The python object for column %s is neither a PyUnicode nor a PyString object. Skipping table...\n", (*_columns)[i].source_name.c_str());
-            PyGILState_Release(state);
-            return false;
+            log_error("Truncating data in column %s from %lul to %lul. Possible loss of data.\n",
+                      (*_columns)[i].source_name.c_str(),
+                      (long unsigned int) len, (long unsigned int) buffer_len);
+            len = buffer_len;
           }
+          memcpy(buffer, value.data, len);
+          *length = (unsigned long)len;
         }
-        rowbuffer.finish_field(was_null);
+        rowbuffer.finish_field(value.is_null);
         break;
-      case MYSQL_TYPE_NULL:
+      }
+
+      case ValueNull:
         rowbuffer[i].buffer_length = 0;
         break;
-      default:
-        Py_DECREF(element);
-        PyGILState_Release(state);
-        throw std::logic_error(base::strfmt("Unhandled MySQL type %i for column '%s'", (*_columns)[i].target_type, (*_columns)[i].target_name.c_str()));
+
+      case ValueUnsupported: // Rejected by convert_value().
+        break;
     }
-    Py_DECREF(element);
   }
-  PyGILState_Release(state);
   return true;
 }
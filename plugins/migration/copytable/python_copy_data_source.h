@@ -28,6 +28,35 @@
 
 class PythonCopyDataSource : public CopyDataSource
 {
+  // How the values of a column are converted. Chosen once per table from the target column type.
+  enum ValueKind
+  {
+    ValueBlob,
+    ValueTiny,
+    ValueShort,
+    ValueLong,
+    ValueLongLong,
+    ValueFloat,
+    ValueDouble,
+    ValueTime,
+    ValueString,
+    ValueNull,
+    ValueUnsupported
+  };
+
+  // A value of the current batch, converted to its native form. String and blob data are not copied
+  // but point into Python objects, which are kept alive by _batch_refs until the next batch is fetched.
+  // This way rows can be passed on to the row buffer without holding the GIL.
+  struct BatchValue
+  {
+    bool is_null;
+    long long int_value;
+    double double_value;
+    MYSQL_TIME time_value;
+    const char *data;
+    Py_ssize_t length;
+  };
+
   std::string _connstring;
   std::string _python_module;
   std::string _password;
@@ -38,10 +67,23 @@ class PythonCopyDataSource : public CopyDataSource
   std::vector<SQLSMALLINT> _column_types;
   size_t _column_count;
 
+  std::vector<ValueKind> _column_kinds;
+  std::vector<BatchValue> _batch;
+  PyObject *_batch_refs;
+  size_t _batch_rows;
+  size_t _batch_row;
+  bool _batch_failed; // Conversion stopped at _batch_rows because of an error. The table is skipped.
+  bool _no_more_rows;
+
   bool initialized;
 
   void _init();
   bool pystring_to_string(PyObject *strobject, std::string &ret_string, bool convert);
+
+  void prepare_column_kinds();
+  bool fetch_batch();
+  bool convert_value(PyObject *element, size_t column, BatchValue &value);
+  void release_batch();
 public:
   PythonCopyDataSource(const std::string &connstring,
                      const std::string &password);
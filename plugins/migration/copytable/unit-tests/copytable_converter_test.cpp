@@ -0,0 +1,179 @@
+/*
+ * Copyright (c) 2014, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <cstring>
+
+#include "test.h"
+#include "copytable/copytable.h"
+#include "copytable/converter.h"
+#include "base/string_utilities.h"
+
+// Rows per simulated fetch block.
+#define BLOCK_ROWS 1000
+
+#define DATE_VALUE_SIZE 32
+#define STRING_CHARS 64
+
+static bool same_time(const MYSQL_TIME &t1, const MYSQL_TIME &t2)
+{
+  return t1.time_type == t2.time_type && t1.year == t2.year && t1.month == t2.month && t1.day == t2.day
+    && t1.hour == t2.hour && t1.minute == t2.minute && t1.second == t2.second && t1.second_part == t2.second_part;
+}
+
+BEGIN_TEST_DATA_CLASS(copytable_converter_test)
+public:
+  std::vector<char> dates;
+  std::vector<SQLLEN> date_lengths;
+
+  std::vector<char> strings;
+  std::vector<SQLLEN> string_lengths;
+  std::vector<std::wstring> wide_strings;
+
+TEST_DATA_CONSTRUCTOR(copytable_converter_test)
+{
+  // A block of timestamps as returned by a column bound to SQL_C_CHAR, with every 10th value NULL.
+  dates.resize(BLOCK_ROWS * DATE_VALUE_SIZE);
+  date_lengths.resize(BLOCK_ROWS);
+  for (int i = 0; i < BLOCK_ROWS; ++i)
+  {
+    char *value = &dates[i * DATE_VALUE_SIZE];
+    if (i % 10 == 9)
+      date_lengths[i] = SQL_NULL_DATA;
+    else
+    {
+      std::string s = base::strfmt("%04i-%02i-%02i %02i:%02i:%02i.%03i", 1990 + i % 30, 1 + i % 12, 1 + i % 28,
+        i % 24, i % 60, (i * 7) % 60, i % 1000);
+      strcpy(value, s.c_str());
+      date_lengths[i] = (SQLLEN)s.size();
+    }
+  }
+
+  // A block of mostly ASCII wide strings (as usual for names, codes etc.) with some non-ASCII ones.
+  strings.resize(BLOCK_ROWS * (STRING_CHARS + 1) * sizeof(SQLWCHAR));
+  string_lengths.resize(BLOCK_ROWS);
+  for (int i = 0; i < BLOCK_ROWS; ++i)
+  {
+    std::wstring s = base::string_to_wstring(base::strfmt("Customer name %i, Some Street %i", i, i * 3));
+    if (i % 8 == 0)
+      s += L"\u00e4\u00f6\u00fc \u4e2d\u6587";
+
+    SQLWCHAR *value = (SQLWCHAR*)&strings[i * (STRING_CHARS + 1) * sizeof(SQLWCHAR)];
+    for (size_t j = 0; j < s.size(); ++j)
+      value[j] = (SQLWCHAR)s[j];
+    value[s.size()] = 0;
+    string_lengths[i] = (SQLLEN)(s.size() * sizeof(SQLWCHAR));
+    wide_strings.push_back(s);
+  }
+}
+END_TEST_DATA_CLASS
+
+TEST_MODULE(copytable_converter_test, "copytable conversion kernels");
+
+// The ISO fast path must give the same results as the generic date/time converters.
+TEST_FUNCTION(5)
+{
+  const char *values[] = {
+    "2014-03-05", "2014-03-05 12:34:56", "2014-03-05T12:34:56", "2014-03-05 12:34:56.5",
+    "2014-03-05 12:34:56.1234567", "2014-3-5 1:2:3", "12:34:56", "12:34:56.789", "garbage"
+  };
+  int types[] = { MYSQL_TYPE_DATE, MYSQL_TYPE_TIME, MYSQL_TYPE_DATETIME, MYSQL_TYPE_TIMESTAMP };
+
+  for (size_t t = 0; t < sizeof(types) / sizeof(types[0]); ++t)
+  {
+    for (size_t i = 0; i < sizeof(values) / sizeof(values[0]); ++i)
+    {
+      MYSQL_TIME expected, result;
+      memset(&expected, 0, sizeof(expected));
+      memset(&result, 0, sizeof(result));
+
+      BaseConverter::convert_date_time(values[i], &expected, types[t]);
+      BaseConverter::convert_date_time_column(values[i], strlen(values[i]) + 1, NULL, 1, &result, types[t]);
+      ensure(base::strfmt("Conversion of '%s' (type %i)", values[i], types[t]), same_time(expected, result));
+    }
+  }
+
+  MYSQL_TIME result;
+  SQLLEN null_indicator = SQL_NULL_DATA;
+  BaseConverter::convert_date_time_column("", 1, &null_indicator, 1, &result, MYSQL_TYPE_DATETIME);
+  ensure_equals("NULL value", result.time_type, MYSQL_TIMESTAMP_NONE);
+}
+
+// UCS-2 to UTF-8 conversion, including surrogate pairs and truncation at character boundaries.
+TEST_FUNCTION(10)
+{
+  std::wstring text = L"plain ascii text, long enough for the block path \u00e9\u4e2d";
+  std::vector<SQLWCHAR> source(text.begin(), text.end());
+  source.push_back(0xD83D); // U+1F600 as surrogate pair.
+  source.push_back(0xDE00);
+  source.push_back(0xDC00); // Unpaired low surrogate.
+
+  char buffer[256];
+  size_t consumed;
+  size_t length = BaseConverter::ucs2_to_utf8(&source[0], source.size(), buffer, sizeof(buffer), &consumed);
+  std::string expected = base::wstring_to_string(text) + "\xF0\x9F\x98\x80" + "\xEF\xBF\xBD";
+  ensure_equals("Converted text", std::string(buffer, length), expected);
+  ensure_equals("Consumed units", consumed, source.size());
+
+  // The 2 byte sequence for U+00E9 does not fit anymore.
+  size_t ascii_length = text.find(L'\u00e9');
+  length = BaseConverter::ucs2_to_utf8(&source[0], source.size(), buffer, ascii_length + 1, &consumed);
+  ensure_equals("Truncated length", length, ascii_length);
+  ensure_equals("Truncated units", consumed, ascii_length);
+}
+
+// Block conversion must give the same results as the per value converters.
+TEST_FUNCTION(15)
+{
+  std::vector<MYSQL_TIME> expected(BLOCK_ROWS);
+  std::vector<MYSQL_TIME> results(BLOCK_ROWS);
+
+  for (int i = 0; i < BLOCK_ROWS; ++i)
+  {
+    if (date_lengths[i] == SQL_NULL_DATA)
+      expected[i].time_type = MYSQL_TIMESTAMP_NONE;
+    else
+      BaseConverter::convert_date_time(&dates[i * DATE_VALUE_SIZE], &expected[i], MYSQL_TYPE_DATETIME);
+  }
+
+  BaseConverter::convert_date_time_column(&dates[0], DATE_VALUE_SIZE, &date_lengths[0], BLOCK_ROWS,
+    &results[0], MYSQL_TYPE_DATETIME);
+
+  for (int i = 0; i < BLOCK_ROWS; ++i)
+    ensure("Timestamp " + base::to_string(i), same_time(expected[i], results[i]));
+}
+
+TEST_FUNCTION(20)
+{
+  const size_t out_size = STRING_CHARS * 4;
+  std::vector<std::string> expected(BLOCK_ROWS);
+  std::vector<char> results(BLOCK_ROWS * out_size);
+  std::vector<unsigned long> result_lengths(BLOCK_ROWS);
+
+  for (int i = 0; i < BLOCK_ROWS; ++i)
+    expected[i] = base::wstring_to_string(wide_strings[i]);
+
+  size_t truncated = BaseConverter::ucs2_to_utf8_column(&strings[0], (STRING_CHARS + 1) * sizeof(SQLWCHAR),
+    &string_lengths[0], BLOCK_ROWS, &results[0], out_size, &result_lengths[0]);
+
+  ensure_equals("Truncated values", truncated, (size_t)0);
+  for (int i = 0; i < BLOCK_ROWS; ++i)
+    ensure_equals("String " + base::to_string(i), std::string(&results[i * out_size], result_lengths[i]), expected[i]);
+}
+
+END_TESTS
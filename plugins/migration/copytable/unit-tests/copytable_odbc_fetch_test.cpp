@@ -0,0 +1,418 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+#include <cstring>
+#include <algorithm>
+
+#include "test.h"
+#include "copytable/copytable.h"
+#include "base/string_utilities.h"
+
+#define TABLE_ROWS 10
+#define FETCH_BLOCK_SIZE 4
+#define NAME_COLUMN_SIZE 100000 // Larger than what is bound, so names are read with SQLGetData().
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * A minimal ODBC driver serving a single table of (id BIGINT, name VARCHAR) from memory. The unit tests
+ * are not linked against a driver manager, so copytable.cpp calls these functions directly.
+ * Without an ORDER BY the rows come in a different order on every execution, like from a server that
+ * scans a table in parallel.
+ */
+struct FakeOdbcTable
+{
+  struct Binding
+  {
+    SQLSMALLINT type;
+    char *values;
+    SQLLEN size;
+    SQLLEN *indicators;
+  };
+
+  std::vector<std::string> names;
+  int fail_set_pos_at; // Row (0 based, in result order) at which SQLSetPos() fails, -1 for never.
+
+  int executions;
+  int set_pos_failures;
+  std::vector<size_t> order;
+  size_t next_row;
+  size_t block_start;
+  size_t current_row;
+
+  SQLULEN array_size;
+  SQLUSMALLINT *row_status;
+  SQLULEN *rows_fetched;
+  Binding bindings[2];
+
+  void reset(int fail_at)
+  {
+    names.clear();
+    for (int i = 0; i < TABLE_ROWS; ++i)
+      names.push_back(base::strfmt("name %i", i + 1));
+    fail_set_pos_at = fail_at;
+    executions = 0;
+    set_pos_failures = 0;
+    order.clear();
+    next_row = 0;
+    block_start = 0;
+    current_row = 0;
+    array_size = 1;
+    row_status = NULL;
+    rows_fetched = NULL;
+    unbind();
+  }
+
+  void unbind()
+  {
+    memset(bindings, 0, sizeof(bindings));
+  }
+
+  void execute(const std::string &query)
+  {
+    ++executions;
+    order.clear();
+    size_t start = query.find("ORDER BY") != std::string::npos ? 0 : executions * 3;
+    for (size_t i = 0; i < names.size(); ++i)
+      order.push_back((start + i) % names.size());
+    next_row = 0;
+    block_start = 0;
+    current_row = 0;
+  }
+
+  void fill(int column, size_t slot, size_t row)
+  {
+    Binding &binding = bindings[column];
+    if (binding.values == NULL)
+      return;
+
+    if (column == 0)
+    {
+      SQLBIGINT id = row + 1;
+      memcpy(binding.values + slot * binding.size, &id, sizeof(id));
+      binding.indicators[slot] = sizeof(id);
+    }
+    else
+    {
+      char *value = binding.values + slot * binding.size;
+      size_t length = std::min(names[row].size(), (size_t)binding.size - 1);
+      memcpy(value, names[row].data(), length);
+      value[length] = 0;
+      binding.indicators[slot] = (SQLLEN)names[row].size();
+    }
+  }
+
+  SQLRETURN fetch()
+  {
+    SQLULEN count = std::min(array_size, (SQLULEN)(order.size() - next_row));
+    if (rows_fetched)
+      *rows_fetched = count;
+    if (count == 0)
+      return SQL_NO_DATA;
+
+    for (SQLULEN slot = 0; slot < count; ++slot)
+    {
+      fill(0, slot, order[next_row + slot]);
+      fill(1, slot, order[next_row + slot]);
+      if (row_status)
+        row_status[slot] = SQL_ROW_SUCCESS;
+    }
+    block_start = next_row;
+    current_row = next_row;
+    next_row += count;
+    return SQL_SUCCESS;
+  }
+};
+
+static FakeOdbcTable fake_table;
+
+extern "C" {
+
+SQLRETURN SQL_API SQLAllocHandle(SQLSMALLINT HandleType, SQLHANDLE InputHandle, SQLHANDLE *OutputHandle)
+{
+  *OutputHandle = (SQLHANDLE)&fake_table;
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFreeHandle(SQLSMALLINT HandleType, SQLHANDLE Handle)
+{
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLSetConnectAttr(SQLHDBC ConnectionHandle, SQLINTEGER Attribute, SQLPOINTER Value,
+                                    SQLINTEGER StringLength)
+{
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDriverConnect(SQLHDBC hdbc, SQLHWND hwnd, SQLCHAR *szConnStrIn, SQLSMALLINT cbConnStrIn,
+                                   SQLCHAR *szConnStrOut, SQLSMALLINT cbConnStrOutMax, SQLSMALLINT *pcbConnStrOut,
+                                   SQLUSMALLINT fDriverCompletion)
+{
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetInfo(SQLHDBC ConnectionHandle, SQLUSMALLINT InfoType, SQLPOINTER InfoValue,
+                             SQLSMALLINT BufferLength, SQLSMALLINT *StringLength)
+{
+  if (InfoType != SQL_GETDATA_EXTENSIONS)
+    return SQL_ERROR;
+  *(SQLUINTEGER*)InfoValue = SQL_GD_ANY_COLUMN | SQL_GD_ANY_ORDER | SQL_GD_BLOCK;
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetDiagRec(SQLSMALLINT HandleType, SQLHANDLE Handle, SQLSMALLINT RecNumber, SQLCHAR *Sqlstate,
+                                SQLINTEGER *NativeError, SQLCHAR *MessageText, SQLSMALLINT BufferLength,
+                                SQLSMALLINT *TextLength)
+{
+  return SQL_NO_DATA;
+}
+
+SQLRETURN SQL_API SQLExecDirect(SQLHSTMT StatementHandle, SQLCHAR *StatementText, SQLINTEGER TextLength)
+{
+  fake_table.execute((const char*)StatementText);
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLNumResultCols(SQLHSTMT StatementHandle, SQLSMALLINT *ColumnCount)
+{
+  *ColumnCount = 2;
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLDescribeCol(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLCHAR *ColumnName,
+                                 SQLSMALLINT BufferLength, SQLSMALLINT *NameLength, SQLSMALLINT *DataType,
+                                 SQLULEN *ColumnSize, SQLSMALLINT *DecimalDigits, SQLSMALLINT *Nullable)
+{
+  const char *name = ColumnNumber == 1 ? "id" : "name";
+  strcpy((char*)ColumnName, name);
+  *NameLength = (SQLSMALLINT)strlen(name);
+  *DataType = ColumnNumber == 1 ? SQL_BIGINT : SQL_VARCHAR;
+  *ColumnSize = ColumnNumber == 1 ? 19 : NAME_COLUMN_SIZE;
+  *DecimalDigits = 0;
+  *Nullable = SQL_NO_NULLS;
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLColAttribute(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLUSMALLINT FieldIdentifier,
+                                  SQLPOINTER CharacterAttribute, SQLSMALLINT BufferLength, SQLSMALLINT *StringLength,
+                                  SQLLEN *NumericAttribute)
+{
+  if (FieldIdentifier == SQL_DESC_UNSIGNED)
+    *NumericAttribute = SQL_FALSE;
+  else
+  {
+    const char *type = ColumnNumber == 1 ? "BIGINT" : "VARCHAR";
+    strcpy((char*)CharacterAttribute, type);
+    *StringLength = (SQLSMALLINT)strlen(type);
+  }
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLSetStmtAttr(SQLHSTMT StatementHandle, SQLINTEGER Attribute, SQLPOINTER Value,
+                                 SQLINTEGER StringLength)
+{
+  switch (Attribute)
+  {
+    case SQL_ATTR_ROW_ARRAY_SIZE:
+      fake_table.array_size = (SQLULEN)Value;
+      break;
+    case SQL_ATTR_ROW_STATUS_PTR:
+      fake_table.row_status = (SQLUSMALLINT*)Value;
+      break;
+    case SQL_ATTR_ROWS_FETCHED_PTR:
+      fake_table.rows_fetched = (SQLULEN*)Value;
+      break;
+  }
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetStmtAttr(SQLHSTMT StatementHandle, SQLINTEGER Attribute, SQLPOINTER Value,
+                                 SQLINTEGER BufferLength, SQLINTEGER *StringLength)
+{
+  if (Attribute != SQL_ATTR_ROW_ARRAY_SIZE)
+    return SQL_ERROR;
+  *(SQLULEN*)Value = fake_table.array_size;
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLBindCol(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLSMALLINT TargetType,
+                             SQLPOINTER TargetValue, SQLLEN BufferLength, SQLLEN *StrLen_or_Ind)
+{
+  FakeOdbcTable::Binding &binding = fake_table.bindings[ColumnNumber - 1];
+  binding.type = TargetType;
+  binding.values = (char*)TargetValue;
+  binding.size = BufferLength;
+  binding.indicators = StrLen_or_Ind;
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFreeStmt(SQLHSTMT StatementHandle, SQLUSMALLINT Option)
+{
+  if (Option == SQL_UNBIND)
+    fake_table.unbind();
+  else if (Option == SQL_CLOSE)
+  {
+    fake_table.order.clear();
+    fake_table.next_row = 0;
+  }
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLFetch(SQLHSTMT StatementHandle)
+{
+  return fake_table.fetch();
+}
+
+SQLRETURN SQL_API SQLFetchScroll(SQLHSTMT StatementHandle, SQLSMALLINT FetchOrientation, SQLLEN FetchOffset)
+{
+  return fake_table.fetch();
+}
+
+SQLRETURN SQL_API SQLSetPos(SQLHSTMT hstmt, SQLSETPOSIROW irow, SQLUSMALLINT fOption, SQLUSMALLINT fLock)
+{
+  size_t row = fake_table.block_start + irow - 1;
+  if ((int)row == fake_table.fail_set_pos_at)
+  {
+    ++fake_table.set_pos_failures;
+    return SQL_ERROR;
+  }
+  fake_table.current_row = row;
+  return SQL_SUCCESS;
+}
+
+SQLRETURN SQL_API SQLGetData(SQLHSTMT StatementHandle, SQLUSMALLINT ColumnNumber, SQLSMALLINT TargetType,
+                             SQLPOINTER TargetValue, SQLLEN BufferLength, SQLLEN *StrLen_or_Ind)
+{
+  size_t row = fake_table.order[fake_table.current_row];
+  if (ColumnNumber == 1)
+  {
+    *(SQLBIGINT*)TargetValue = row + 1;
+    *StrLen_or_Ind = sizeof(SQLBIGINT);
+  }
+  else
+  {
+    const std::string &name = fake_table.names[row];
+    size_t length = std::min(name.size(), (size_t)BufferLength - 1);
+    memcpy(TargetValue, name.data(), length);
+    ((char*)TargetValue)[length] = 0;
+    *StrLen_or_Ind = (SQLLEN)name.size();
+  }
+  return SQL_SUCCESS;
+}
+
+}
+
+//--------------------------------------------------------------------------------------------------
+
+BEGIN_TEST_DATA_CLASS(copytable_odbc_fetch_test)
+public:
+  CopySpec spec;
+
+  // Copies the fake table with block fetching and returns the ids in the order they were fetched.
+  // The names are checked against the ids on the way.
+  std::vector<long long> copy_table(int fail_set_pos_at, bool ordered)
+  {
+    fake_table.reset(fail_set_pos_at);
+
+    ODBCCopyDataSource source(NULL, "DSN=fake;PWD=", "", false, "fake");
+    source.set_block_size(FETCH_BLOCK_SIZE);
+
+    std::vector<std::string> pk_columns;
+    if (ordered)
+      pk_columns.push_back("id");
+
+    boost::shared_ptr<std::vector<ColumnInfo> > columns =
+      source.begin_select_table("db", "tbl", pk_columns, "*", spec, std::vector<std::string>());
+    (*columns)[0].target_name = "id";
+    (*columns)[0].target_type = MYSQL_TYPE_LONGLONG;
+    (*columns)[1].target_name = "name";
+    (*columns)[1].target_type = MYSQL_TYPE_STRING;
+
+    std::vector<long long> ids;
+    RowBuffer row(columns, boost::function<void (int, const char*, size_t)>(), 1024 * 1024);
+    while (source.fetch_row(row))
+    {
+      long long id = *(long long*)row[0].buffer;
+      ensure_equals("name of row " + base::to_string(id), std::string((char*)row[1].buffer, *row[1].length),
+                    base::strfmt("name %lli", id));
+      ids.push_back(id);
+      row.clear();
+    }
+    source.end_select_table();
+
+    return ids;
+  }
+
+TEST_DATA_CONSTRUCTOR(copytable_odbc_fetch_test)
+{
+  spec.type = CopyAll;
+  spec.range_start = 0;
+  spec.range_end = -1;
+  spec.row_count = 0;
+  spec.max_count = 0;
+  spec.resume = false;
+}
+
+END_TEST_DATA_CLASS
+
+TEST_MODULE(copytable_odbc_fetch_test, "copytable ODBC block fetch");
+
+// All rows come through the bound blocks if the driver can position in them.
+TEST_FUNCTION(5)
+{
+  std::vector<long long> ids = copy_table(-1, true);
+
+  ensure_equals("row count", ids.size(), (size_t)TABLE_ROWS);
+  for (size_t i = 0; i < ids.size(); ++i)
+    ensure_equals("id", ids[i], (long long)i + 1);
+  ensure_equals("executions", fake_table.executions, 1);
+}
+
+// Positioning fails in the middle of the second block: the copy continues row by row, with every row
+// returned exactly once and in order.
+TEST_FUNCTION(10)
+{
+  std::vector<long long> ids = copy_table(FETCH_BLOCK_SIZE + 1, true);
+
+  ensure_equals("SQLSetPos failures", fake_table.set_pos_failures, 1);
+  ensure_equals("executions", fake_table.executions, 2);
+  ensure_equals("row count", ids.size(), (size_t)TABLE_ROWS);
+  for (size_t i = 0; i < ids.size(); ++i)
+    ensure_equals("id", ids[i], (long long)i + 1);
+}
+
+// The same failure without a primary key: the re-executed query may return the rows in another order,
+// so skipping the rows already copied could lose some and copy others twice. The copy must stop instead.
+TEST_FUNCTION(15)
+{
+  try
+  {
+    copy_table(FETCH_BLOCK_SIZE + 1, false);
+    fail("Row fetch was restarted for a table without primary key");
+  }
+  catch (std::runtime_error &exc)
+  {
+    ensure("error message", std::string(exc.what()).find("db.tbl") != std::string::npos);
+  }
+  ensure_equals("SQLSetPos failures", fake_table.set_pos_failures, 1);
+  ensure_equals("executions", fake_table.executions, 1);
+}
+
+END_TESTS
@@ -160,8 +160,13 @@ class CopyTablesTestCase(unittest.TestCase):
         logging.debug('Calling the MySQL Client with command: %s' % scramble_pwd(mysql_call))
         subprocess.Popen(mysql_call, shell=True).wait()
 
-        # Call copytables to transfer the data from source to target:
-        copytables_params = (' --pythondbapi-source="%(module)s' % source_info + '''://'%s'"''' % source_conn_str + 
+        # Call copytables to transfer the data from source to target. The data is read through ODBC
+        # if the source instance has an ODBC connection string, otherwise through the Python DB API module:
+        if 'odbc_connection_string' in source_info:
+            source_param = ' --odbc-source="%s"' % (source_info['odbc_connection_string'] % source_info)
+        else:
+            source_param = ' --pythondbapi-source="%(module)s' % source_info + '''://'%s'"''' % source_conn_str
+        copytables_params = (source_param +
                              ' --source-password="%(password)s"' % source_info +
                              ' --target="%(user)s@%(host)s:%(port)d" --target-password="%(password)s"' % target_info +
                              ' --table-file="%(table_file)s"' % test_info +
@@ -270,7 +275,7 @@ def available_tests(path):
 
 # Generate the tests based on the directory structure and the files on disk:
 for source_instance, source_info in settings.source_instances:
-    for test_info in available_tests(os.path.join(_this_dir, 'fixtures', source_instance)):
+    for test_info in available_tests(os.path.join(_this_dir, 'fixtures', source_info.get('fixtures', source_instance))):
         for target_instance, target_info in settings.mysql_instances:
             # Dynamically add a meaningful test function to the test case class defined above:
             setattr(CopyTablesTestCase, 'test_%s_%s_%s' % (test_info['test_name'], source_instance, target_instance),
@@ -21,11 +21,7 @@ import re
 import grt
 import mforms
 
-from threading import Thread
-from Queue import Queue, Empty
-
 from workbench.log import log_info, log_error
-from workbench.client_utils import MySQLScriptImporter
 
 
 class RunPanel(mforms.Table):
@@ -49,16 +45,8 @@ class RunPanel(mforms.Table):
         
         self.log_callback = log_callback
         self.editor = editor
-        
-        self.importer = MySQLScriptImporter(editor.connection)
-        self.importer.report_progress = self.report_progress
-        self.importer.report_output = self.report_output
-        
-        self._worker_queue = Queue()
-        self._worker = None
-        self._progress_status = None
-        self._progress_value = 0
 
+        self._output_count = 0
         self._update_timer = None
 
     def __del__(self):
@@ -67,103 +55,63 @@ class RunPanel(mforms.Table):
 
     @property
     def is_busy(self):
-        return self._worker != None
+        return self._update_timer != None
 
 
-    def report_progress(self, status, current, total):
-        self._progress_status = status
-        if status:
-            self._worker_queue.put(status)
-        if total > 0:
-            self._progress_value = float(current) / total
+    def report_error(self, message):
+        mforms.Utilities.show_error("Run SQL Script", "Error executing SQL script.\n"+message, "OK", "", "")
 
 
-    def report_output(self, message):
-        log_info("%s\n" % message)
-        self._worker_queue.put(message)
+    def update_ui(self):
+        # The editor executes the script in the background, its state is polled here.
+        status = self.editor.scriptFileStatus()
 
+        output = status["output"]
+        for i in range(self._output_count, len(output)):
+            log_info("%s\n" % output[i])
+            self.log_callback(output[i]+"\n")
+        self._output_count = len(output)
 
-    def update_ui(self):
-        try:
-            while True:
-                data = self._worker_queue.get_nowait()
-                if data is None:
-                    self._worker.join()
-                    self._worker = None
-                    self._update_timer = None
-                    self.progress.show(False)
-                    self.log_callback(None)
-                    return False
-
-                if isinstance(data, Exception):
-                    self.log_callback(str(data)+"\n")
-                    if isinstance(data, grt.DBError) and data.args[1] == 1044:
-                        mforms.Utilities.show_error("Run SQL Script",
-                                                    "The current MySQL account does not have enough privileges to execute the script.", "OK", "", "")
-                    elif isinstance(data, grt.DBLoginError):
-                        username = self.editor.connection.parameterValues["userName"]
-                        host = self.editor.connection.hostIdentifier
-                        mforms.Utilities.forget_password(host, username)
-
-                        mforms.Utilities.show_error("Run SQL Script",
-                                                    "Error executing SQL script.\n"+str(data), "OK", "", "")
-                    else:
-                        mforms.Utilities.show_error("Run SQL Script",
-                                                    "Error executing SQL script.\n"+str(data), "OK", "", "")
-                else:
-                    self.log_callback(data+"\n")
-
-                if self._progress_status is not None:
-                    self.label.set_text(self._progress_status)
-                self.progress.set_value(self._progress_value)
-        except Empty:
-            pass
-
-        if self._progress_status is not None:
-            self.label.set_text(self._progress_status)
-        self.progress.set_value(self._progress_value)
-
-        return True
-            
-            
-    def work(self, file, schema, charset):
-        try:
-            log_info("Executing %s...\n" % file)
-            self._progress_status = "Executing %s..." % file
-            self._progress_value = 0
-            self.importer.import_script(file, default_schema = schema, default_charset = charset)
+        if status["total"] > 0:
+            self.label.set_text("Executing script: %i of %i bytes" % (status["done"], status["total"]))
+            self.progress.set_value(float(status["done"]) / status["total"])
 
-            log_info("Run script finished\n")
-        except grt.DBLoginError, e:
-            log_error("MySQL login error running script: %s\n" % e)
-            self._worker_queue.put(e)
-        except grt.DBError, e:
-            log_error("MySQL error running script: %s\n" % e)
-            self._worker_queue.put(e)
-        except Exception, e:
-            import traceback
-            log_error("Unexpected exception running script: %s\n%s\n" % (e, traceback.format_exc()))
-            self._worker_queue.put(e)
-        self._worker_queue.put(None)
+        if status["running"]:
+            return True
 
+        self._update_timer = None
+        self.progress.show(False)
+        self.log_callback(None)
 
-    def start(self, what, default_db, default_charset):
-        parameterValues = self.editor.connection.parameterValues
-        pwd = parameterValues["password"]
-        if not pwd:
-            username = parameterValues["userName"]
+        if status["loginError"]:
+            username = self.editor.connection.parameterValues["userName"]
             host = self.editor.connection.hostIdentifier
+            mforms.Utilities.forget_password(host, username)
+
+            self.report_error("\n".join([output[i] for i in range(len(output))]))
+        elif status["errorCode"] == 1044:
+            mforms.Utilities.show_error("Run SQL Script",
+                                        "The current MySQL account does not have enough privileges to execute the script.", "OK", "", "")
+        elif status["errorCode"]:
+            self.report_error("\n".join([output[i] for i in range(len(output))]))
+        else:
+            log_info("Run script finished\n")
+        return False
 
-            ok, pwd = mforms.Utilities.find_cached_password(host, username)
-            if not ok:
-                accepted, pwd = mforms.Utilities.find_or_ask_for_password("Run SQL Script", host, username, False)
-                if not accepted:
-                    return
-        self.importer.set_password(pwd)
 
-        self._worker = Thread(target = self.work, args = (what, default_db, default_charset))
-        self._worker.start()
-    
+    def start(self, what, default_db, default_charset, start_offset = 0, delimiter = ";"):
+        # Connecting and executing happens in the background, so login errors (grt.DBLoginError) and
+        # server errors like 1044 are reported through the polled status, see update_ui().
+        try:
+            log_info("Executing %s...\n" % what)
+            self.editor.executeScriptFile(what, default_db, default_charset, start_offset, delimiter)
+        except Exception, e:
+            log_error("Error starting script: %s\n" % e)
+            self.log_callback(str(e)+"\n")
+            self.log_callback(None)
+            self.report_error(str(e))
+            return
+
         self._update_timer = mforms.Utilities.add_timeout(0.2, self.update_ui)
 
 
@@ -324,12 +272,8 @@ class RunScriptForm(mforms.Form):
         self.ok.set_text("Close")
         self.ok.add_clicked_callback(self.close)
 
-        #self.abort = mforms.newButton()
-        #self.abort.set_text("Abort")
-
         hbox = mforms.Box(True)
         hbox.set_spacing(8)
-        #hbox.add(self.abort, False, True)
         hbox.add_end(self.ok, False, True)
         box.add_end(hbox, False, True)
 
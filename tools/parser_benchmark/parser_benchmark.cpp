@@ -0,0 +1,912 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+/**
+ * Benchmarks for the SQL splitter, scanner, parsers and code completion.
+ *
+ * Each benchmark runs on a number of corpora: generated scripts of several sizes (a mix of the
+ * statements usually found in model and dump scripts), the sys schema script that ships with
+ * Workbench and any file given on the command line. The name index benchmarks (code completion
+ * lookups) run once on a generated catalog instead. Results are written to stdout as one JSON
+ * object per line (benchmark + corpus), so they can be collected and compared between releases.
+ * Progress and errors go to stderr.
+ *
+ * Syntax:
+ *   parser_benchmark [--source-dir <dir>] [--iterations <n>] [--sizes <n,n,...>]
+ *                    [--server-version <n>] [--only <benchmark,...>] [file ...]
+ *
+ * The source dir is the root of the Workbench source tree (default: current dir). The struct
+ * definitions, the rdbms info, the grammar for code completion and the sys schema scripts are
+ * loaded from there.
+ *
+ * To compare the script import with and without the name indexes on the object lists, e.g. for
+ * about 5000 tables:
+ *   parser_benchmark --sizes 20000 --only legacy_parser,legacy_parser_unindexed
+ *
+ * To compare the splitting the SQL editor does in large file mode with splitting an entire file,
+ * e.g. for a script of about 50MB:
+ *   parser_benchmark --sizes 200000 --only split,editor_scroll,editor_edit
+ *
+ * To compare reused, fresh and pooled scanners and recognizers:
+ *   parser_benchmark --only scan,scan_fresh,parse,parse_fresh,parse_pooled
+ */
+
+#include <glib.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <boost/scoped_ptr.hpp>
+
+#include "base/string_utilities.h"
+#include "base/file_utilities.h"
+
+#include "grtpp.h"
+#include "grt/common.h"
+#include "grt/grt_manager.h"
+#include "grts/structs.db.mysql.h"
+#include "grtsqlparser/mysql_parser_services.h"
+#include "grtsqlparser/sql_facade.h"
+#include "sqlide/object_name_index.h"
+#include "sqlide/sql_editor_be.h"
+#include "sqlide/statement_ranges.h"
+
+#include "mysql-parser.h"
+#include "mysql-scanner.h"
+
+#include "mysql_parser_module.h"
+#include "mysql_sql_facade.h"
+
+using namespace parser;
+
+//--------------------------------------------------------------------------------------------------
+
+struct Corpus
+{
+  std::string name;
+  std::string sql;
+  std::vector<std::string> statements; // As determined by the splitter, without delimiters.
+};
+
+struct BenchmarkResult
+{
+  std::string benchmark;
+  std::string corpus;
+  size_t bytes;
+  size_t statements;
+  std::vector<double> timings;
+  std::map<std::string, size_t> counters; // Benchmark specific values, e.g. the number of tokens.
+};
+
+struct Environment
+{
+  grt::GRT *grt;
+  db_mgmt_RdbmsRef rdbms;
+  GrtVersionRef version;
+  long server_version;
+  std::set<std::string> charsets;
+
+  MySQLParserServices::Ref services;
+  ParserContext::Ref context;
+  SqlFacade *facade;
+
+  size_t iterations;
+  std::set<std::string> benchmarks; // Empty means all.
+};
+
+//--------------------------------------------------------------------------------------------------
+
+static std::vector<std::string> split_list(const std::string &list)
+{
+  std::vector<std::string> result;
+  gchar **parts = g_strsplit(list.c_str(), ",", -1);
+  for (gchar **part = parts; *part != NULL; ++part)
+  {
+    std::string value = base::trim(*part);
+    if (!value.empty())
+      result.push_back(value);
+  }
+  g_strfreev(parts);
+
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static std::string read_file(const std::string &path)
+{
+  gchar *contents = NULL;
+  gsize length = 0;
+  if (!g_file_get_contents(path.c_str(), &contents, &length, NULL))
+    return "";
+
+  std::string result(contents, length);
+  g_free(contents);
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * The sys schema main script only consists of SOURCE commands for the actual object scripts.
+ * They are replaced by the content of the referenced files (relative to the script's folder).
+ */
+static std::string expand_source_commands(const std::string &sql, const std::string &folder)
+{
+  std::string result;
+  std::istringstream stream(sql);
+  std::string line;
+  while (std::getline(stream, line))
+  {
+    std::string trimmed = base::trim(line);
+    if (base::starts_with(base::toupper(trimmed), "SOURCE "))
+    {
+      std::string file = base::trim(trimmed.substr(7));
+      if (base::ends_with(file, ";"))
+        file.erase(file.size() - 1);
+      result += read_file(bec::make_path(folder, file));
+      result += "\n";
+    }
+    else
+      result += line + "\n";
+  }
+
+  return result;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Creates a script with roughly the given number of statements. The content only depends on the
+ * count, so results for a given size are comparable between runs and releases.
+ */
+static std::string generate_script(size_t statement_count)
+{
+  std::string sql = "-- Generated benchmark script.\nCREATE DATABASE IF NOT EXISTS bench;\nUSE bench;\n\n";
+
+  size_t count = 2;
+  for (size_t i = 0; count < statement_count; ++i)
+  {
+    switch (i % 8)
+    {
+      case 0:
+        sql += base::strfmt("CREATE TABLE IF NOT EXISTS customer%lu (\n"
+          "  id INT UNSIGNED NOT NULL AUTO_INCREMENT,\n"
+          "  name VARCHAR(45) NOT NULL COMMENT 'The full name',\n"
+          "  email VARCHAR(100) NULL DEFAULT NULL,\n"
+          "  balance DECIMAL(10,2) NOT NULL DEFAULT 0.00,\n"
+          "  created TIMESTAMP NOT NULL DEFAULT CURRENT_TIMESTAMP,\n"
+          "  PRIMARY KEY (id),\n"
+          "  UNIQUE INDEX email_UNIQUE (email ASC),\n"
+          "  INDEX idx_name (name(10))\n"
+          ") ENGINE = InnoDB DEFAULT CHARACTER SET = utf8;\n", (unsigned long)i);
+        break;
+
+      case 1:
+        sql += base::strfmt("CREATE TABLE IF NOT EXISTS order%lu (\n"
+          "  id INT UNSIGNED NOT NULL AUTO_INCREMENT,\n"
+          "  customer_id INT UNSIGNED NOT NULL,\n"
+          "  total DECIMAL(10,2) NOT NULL,\n"
+          "  status ENUM('new', 'paid', 'shipped') NOT NULL DEFAULT 'new',\n"
+          "  PRIMARY KEY (id),\n"
+          "  CONSTRAINT fk_order%lu_customer FOREIGN KEY (customer_id)\n"
+          "    REFERENCES customer%lu (id) ON DELETE CASCADE ON UPDATE NO ACTION\n"
+          ") ENGINE = InnoDB;\n", (unsigned long)i, (unsigned long)i, (unsigned long)(i - 1));
+        break;
+
+      case 2:
+        sql += "INSERT INTO customer" + base::to_string(i - 2) + " (name, email, balance) VALUES\n";
+        for (int row = 0; row < 10; ++row)
+          sql += base::strfmt("  ('Customer %i', 'customer%i@example.com', %i.%02i)%s\n", row, row, row * 17, row,
+            row < 9 ? "," : ";");
+        break;
+
+      case 3:
+        sql += base::strfmt("SELECT c.name, COUNT(o.id) AS orders, SUM(o.total) AS total\n"
+          "  FROM customer%lu c LEFT JOIN order%lu o ON o.customer_id = c.id\n"
+          "  WHERE c.balance > 100 AND o.status IN ('paid', 'shipped')\n"
+          "  GROUP BY c.name HAVING COUNT(o.id) > 1 ORDER BY total DESC LIMIT 20;\n",
+          (unsigned long)(i - 3), (unsigned long)(i - 2));
+        break;
+
+      case 4:
+        sql += base::strfmt("/* Keep the balance in sync. */\n"
+          "UPDATE customer%lu SET balance = balance - 10.5 WHERE id = %lu;\n",
+          (unsigned long)(i - 4), (unsigned long)i);
+        break;
+
+      case 5:
+        sql += base::strfmt("CREATE OR REPLACE VIEW customer_orders%lu AS\n"
+          "  SELECT c.id, c.name, o.total FROM customer%lu c JOIN order%lu o ON o.customer_id = c.id;\n",
+          (unsigned long)i, (unsigned long)(i - 5), (unsigned long)(i - 4));
+        break;
+
+      case 6:
+        sql += base::strfmt("DELIMITER $$\n"
+          "CREATE PROCEDURE close_orders%lu(IN max_total DECIMAL(10,2))\n"
+          "BEGIN\n"
+          "  DECLARE done INT DEFAULT 0;\n"
+          "  IF max_total > 0 THEN\n"
+          "    UPDATE order%lu SET status = 'shipped' WHERE total < max_total;\n"
+          "  END IF;\n"
+          "  SELECT COUNT(*) FROM order%lu WHERE status = 'shipped';\n"
+          "END$$\n"
+          "DELIMITER ;\n", (unsigned long)i, (unsigned long)(i - 5), (unsigned long)(i - 5));
+        break;
+
+      case 7:
+        sql += base::strfmt("# Clean up old data.\nDELETE FROM order%lu WHERE status = 'new' AND total = 0;\n",
+          (unsigned long)(i - 6));
+        break;
+    }
+    ++count;
+  }
+
+  return sql;
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void split_corpus(Environment &environment, Corpus &corpus)
+{
+  std::vector<std::pair<size_t, size_t> > ranges;
+  environment.services->determineStatementRanges(corpus.sql.c_str(), corpus.sql.size(), ";", ranges, "\n");
+
+  corpus.statements.clear();
+  corpus.statements.reserve(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i)
+    corpus.statements.push_back(corpus.sql.substr(ranges[i].first, ranges[i].second));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static double median(std::vector<double> values)
+{
+  if (values.empty())
+    return 0;
+
+  std::sort(values.begin(), values.end());
+  size_t middle = values.size() / 2;
+  if (values.size() % 2 == 0)
+    return (values[middle - 1] + values[middle]) / 2;
+  return values[middle];
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Returns the text as JSON string literal (including the quotes). Corpus names come from file names,
+ * which can contain quotes, backslashes and control characters.
+ */
+static std::string json_string(const std::string &text)
+{
+  std::string escaped = base::escape_json_string(text);
+  std::string result = "\"";
+  for (std::string::const_iterator iterator = escaped.begin(); iterator != escaped.end(); ++iterator)
+  {
+    // escape_json_string() leaves control characters without a short escape sequence as they are.
+    if ((unsigned char)*iterator < 0x20)
+      result += base::strfmt("\\u%04x", (unsigned char)*iterator);
+    else
+      result += *iterator;
+  }
+  return result + "\"";
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void print_result(const BenchmarkResult &result)
+{
+  double minimum = *std::min_element(result.timings.begin(), result.timings.end());
+  double sum = 0;
+  for (size_t i = 0; i < result.timings.size(); ++i)
+    sum += result.timings[i];
+  double mean = sum / result.timings.size();
+  double middle = median(result.timings);
+
+  // Throughput is computed from the median, which is less sensitive to outliers than the mean.
+  double mb_per_s = middle > 0 ? result.bytes / middle / (1024 * 1024) : 0;
+  double statements_per_s = middle > 0 ? result.statements / middle : 0;
+
+  std::string line = base::strfmt("{\"benchmark\": %s, \"corpus\": %s, \"bytes\": %lu, \"statements\": %lu, "
+    "\"iterations\": %lu, \"seconds_min\": %.6f, \"seconds_median\": %.6f, \"seconds_mean\": %.6f, "
+    "\"mb_per_s\": %.3f, \"statements_per_s\": %.1f", json_string(result.benchmark).c_str(),
+    json_string(result.corpus).c_str(),
+    (unsigned long)result.bytes, (unsigned long)result.statements, (unsigned long)result.timings.size(),
+    minimum, middle, mean, mb_per_s, statements_per_s);
+
+  for (std::map<std::string, size_t>::const_iterator iterator = result.counters.begin();
+    iterator != result.counters.end(); ++iterator)
+    line += base::strfmt(", %s: %lu", json_string(iterator->first).c_str(), (unsigned long)iterator->second);
+  line += "}\n";
+
+  fputs(line.c_str(), stdout);
+  fflush(stdout);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * A single benchmark. run() does one complete pass over the corpus and is called once for warm up
+ * (e.g. to fill the recognizer pools) and then for each iteration. Counters are taken from the
+ * last run.
+ */
+class Benchmark
+{
+public:
+  virtual ~Benchmark() {}
+
+  virtual std::string name() = 0;
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters) = 0;
+
+  // The number of bytes and statements processed in one run, for the throughput values.
+  virtual size_t bytes(const Corpus &corpus) { return corpus.sql.size(); }
+  virtual size_t statements(const Corpus &corpus) { return corpus.statements.size(); }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+class SplitterBenchmark : public Benchmark
+{
+public:
+  virtual std::string name() { return "split"; }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    std::vector<std::pair<size_t, size_t> > ranges;
+    environment.services->determineStatementRanges(corpus.sql.c_str(), corpus.sql.size(), ";", ranges, "\n");
+    counters["ranges"] = ranges.size();
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+// The text the editor splits beyond the visible part when scrolling or editing in large file mode
+// (about a screen plus the marker margin).
+#define EDITOR_VIEW_BYTES (16 * 1024)
+
+/**
+ * Splitting as the editor does it in large file mode while scrolling: on load only the start of the text
+ * is split, every scroll step (a view further) splits only what became visible.
+ */
+class EditorScrollBenchmark : public Benchmark
+{
+public:
+  virtual std::string name() { return "editor_scroll"; }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    StatementRanges ranges(environment.services);
+    size_t steps = 0;
+    for (size_t position = 0; position < corpus.sql.size(); position += EDITOR_VIEW_BYTES)
+    {
+      ranges.split(corpus.sql.c_str(), corpus.sql.size(), position + EDITOR_VIEW_BYTES);
+      ++steps;
+    }
+    counters["ranges"] = ranges.ranges().size();
+    counters["steps"] = steps;
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Splitting as the editor does it in large file mode after each key stroke: text from the statement before
+ * the change on is split again, up to the end of the visible text. The key strokes are in the middle of the
+ * text, with all text before them split already (by the warm up run), as after scrolling there.
+ */
+class EditorEditBenchmark : public Benchmark
+{
+public:
+  static const size_t edit_count = 100;
+
+  EditorEditBenchmark() : _corpus(NULL) {}
+
+  virtual std::string name() { return "editor_edit"; }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    if (_corpus != &corpus)
+    {
+      _corpus = &corpus;
+      _ranges.reset(new StatementRanges(environment.services));
+    }
+
+    // Edits only mark text as changed, the text itself stays the same.
+    size_t position = corpus.sql.size() / 2;
+    for (size_t i = 0; i < edit_count; ++i)
+    {
+      _ranges->changed(position);
+      _ranges->split(corpus.sql.c_str(), corpus.sql.size(), position + EDITOR_VIEW_BYTES);
+    }
+    counters["edits"] = edit_count;
+    counters["ranges"] = _ranges->ranges().size();
+  }
+
+  // Key strokes are counted as statements, so statements_per_s are key strokes per second.
+  virtual size_t bytes(const Corpus &corpus) { return 0; }
+  virtual size_t statements(const Corpus &corpus) { return edit_count; }
+
+private:
+  const Corpus *_corpus;
+  boost::shared_ptr<StatementRanges> _ranges;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Scans each statement with a scanner that is reused for all statements, as the editor and the import do it.
+ * The fresh variant creates a new scanner for each statement instead.
+ */
+class ScannerBenchmark : public Benchmark
+{
+public:
+  ScannerBenchmark(bool reuse) : _reuse(reuse) {}
+
+  virtual std::string name() { return _reuse ? "scan" : "scan_fresh"; }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    MySQLScanner reused_scanner("", 0, true, environment.server_version, "", environment.charsets);
+    size_t tokens = 0;
+    for (size_t i = 0; i < corpus.statements.size(); ++i)
+    {
+      const std::string &statement = corpus.statements[i];
+      boost::scoped_ptr<MySQLScanner> fresh_scanner;
+      MySQLScanner *scanner = &reused_scanner;
+      if (_reuse)
+        reused_scanner.set_text(statement.c_str(), statement.size(), true);
+      else
+      {
+        fresh_scanner.reset(new MySQLScanner(statement.c_str(), statement.size(), true, environment.server_version,
+          "", environment.charsets));
+        scanner = fresh_scanner.get();
+      }
+
+      while (scanner->token_type() != ANTLR3_TOKEN_EOF)
+      {
+        ++tokens;
+        scanner->next(false);
+      }
+    }
+    counters["tokens"] = tokens;
+  }
+
+private:
+  bool _reuse;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Parses each statement with a recognizer that is reused for all statements (as the editor does it),
+ * with a new recognizer per statement or with the recognizer of a new parser context per statement
+ * (taken from the recognizer pool, as for each opened object editor).
+ */
+class ParserBenchmark : public Benchmark
+{
+public:
+  enum Recognizer { Reused, Fresh, Pooled };
+
+  ParserBenchmark(Recognizer recognizer) : _recognizer(recognizer) {}
+
+  virtual std::string name()
+  {
+    switch (_recognizer)
+    {
+      case Fresh:
+        return "parse_fresh";
+      case Pooled:
+        return "parse_pooled";
+      default:
+        return "parse";
+    }
+  }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    MySQLRecognizer reused_recognizer(environment.server_version, "", environment.charsets);
+    size_t errors = 0;
+    for (size_t i = 0; i < corpus.statements.size(); ++i)
+    {
+      const std::string &statement = corpus.statements[i];
+      switch (_recognizer)
+      {
+        case Fresh:
+        {
+          MySQLRecognizer recognizer(environment.server_version, "", environment.charsets);
+          recognizer.parse(statement.c_str(), statement.size(), true, PuGeneric);
+          errors += recognizer.error_info().size();
+          break;
+        }
+
+        case Pooled:
+        {
+          ParserContext::Ref context = MySQLParserServices::createParserContext(environment.rdbms->characterSets(),
+            environment.version, false);
+          context->recognizer()->parse(statement.c_str(), statement.size(), true, PuGeneric);
+          errors += context->recognizer()->error_info().size();
+          break;
+        }
+
+        default:
+          reused_recognizer.parse(statement.c_str(), statement.size(), true, PuGeneric);
+          errors += reused_recognizer.error_info().size();
+          break;
+      }
+    }
+    counters["errors"] = errors;
+  }
+
+private:
+  Recognizer _recognizer;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+class SyntaxCheckBenchmark : public Benchmark
+{
+public:
+  virtual std::string name() { return "syntax_check"; }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    size_t errors = 0;
+    for (size_t i = 0; i < corpus.statements.size(); ++i)
+    {
+      const std::string &statement = corpus.statements[i];
+      errors += environment.services->checkSqlSyntax(environment.context, statement.c_str(), statement.size(),
+        QtUnknown);
+    }
+    counters["errors"] = errors;
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Imports the corpus into a new catalog, as done for reverse engineering a script. The unindexed
+ * variant parses without the name indexes on the object lists (every lookup of a schema or table
+ * is a linear scan), which gives the numbers to compare the indexed import with.
+ */
+class LegacyParserBenchmark : public Benchmark
+{
+public:
+  LegacyParserBenchmark(bool index_names) : _index_names(index_names) {}
+
+  virtual std::string name() { return _index_names ? "legacy_parser" : "legacy_parser_unindexed"; }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    db_mysql_CatalogRef catalog(environment.grt);
+    catalog->version(environment.rdbms->version());
+    catalog->defaultCharacterSetName("utf8");
+    catalog->defaultCollationName("utf8_general_ci");
+    grt::replace_contents(catalog->simpleDatatypes(), environment.rdbms->simpleDatatypes());
+    grt::replace_contents(catalog->characterSets(), environment.rdbms->characterSets());
+
+    grt::DictRef options(environment.grt);
+    options.set("index_names", grt::IntegerRef(_index_names ? 1 : 0));
+    counters["result"] = (size_t)environment.facade->parseSqlScriptStringEx(catalog, corpus.sql, options);
+
+    size_t tables = 0;
+    for (size_t i = 0; i < catalog->schemata().count(); ++i)
+      tables += catalog->schemata()[i]->tables().count();
+    counters["tables"] = tables;
+  }
+
+private:
+  bool _index_names;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Collects completion candidates with the caret at the end of the first line of each statement,
+ * which is where most of the work is done for the start of a statement. Only a sample of the
+ * statements is used, as the completion engine walks the grammar for each of them.
+ */
+class CompletionBenchmark : public Benchmark
+{
+public:
+  static const size_t max_statements = 200;
+
+  virtual std::string name() { return "completion"; }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    size_t candidates = 0;
+    size_t count = statements(corpus);
+    for (size_t i = 0; i < count; ++i)
+    {
+      const std::string &statement = corpus.statements[i];
+      std::string::size_type line_end = statement.find('\n');
+      size_t offset = (line_end == std::string::npos) ? statement.size() : line_end;
+      candidates += MySQLEditor::collect_completion_candidates(environment.context, statement, 1, offset).size();
+    }
+    counters["candidates"] = candidates;
+  }
+
+  virtual size_t bytes(const Corpus &corpus)
+  {
+    size_t result = 0;
+    for (size_t i = 0; i < statements(corpus); ++i)
+      result += corpus.statements[i].size();
+    return result;
+  }
+
+  virtual size_t statements(const Corpus &corpus)
+  {
+    return std::min(corpus.statements.size(), max_statements);
+  }
+};
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Name lookups for code completion in a big catalog (100k columns in 2000 tables). The catalog is generated,
+ * so this benchmark runs only once and not for each corpus.
+ */
+class NameIndexBenchmark : public Benchmark
+{
+public:
+  enum Lookup { TablePrefix, SchemaPrefix, SchemaFuzzy };
+
+  NameIndexBenchmark(Lookup lookup) : _lookup(lookup)
+  {
+    static const char *words[] = { "customer", "order", "id", "name", "address", "created", "at", "total",
+      "amount", "status", "Product", "line", "item", "city", "zip" };
+
+    for (int t = 0; t < 2000; ++t)
+    {
+      std::vector<std::string> columns;
+      for (int c = 0; c < 50; ++c)
+        columns.push_back(base::strfmt("%s_%s_%i", words[(t * 7 + c) % 15], words[(c * 3 + t) % 15], c));
+      _index.set_names("columns", "shop", base::strfmt("table%i", t), columns);
+    }
+  }
+
+  virtual std::string name()
+  {
+    switch (_lookup)
+    {
+      case TablePrefix:
+        return "name_index_table_prefix";
+      case SchemaPrefix:
+        return "name_index_schema_prefix";
+      default:
+        return "name_index_schema_fuzzy";
+    }
+  }
+
+  virtual void run(Environment &environment, const Corpus &corpus, std::map<std::string, size_t> &counters)
+  {
+    size_t matches = 0;
+    for (size_t i = 0; i < statements(corpus); ++i)
+    {
+      switch (_lookup)
+      {
+        case TablePrefix:
+          matches += _index.prefix_matches("columns", "shop", base::strfmt("table%u", (unsigned)i), "or").size();
+          break;
+        case SchemaPrefix:
+          matches += _index.prefix_matches("columns", "shop", "", "ord").size();
+          break;
+        case SchemaFuzzy:
+          matches += _index.fuzzy_matches("columns", "shop", "", "ps", 50).size();
+          break;
+      }
+    }
+    counters["matches"] = matches;
+  }
+
+  // Lookups are counted as statements, so statements_per_s are lookups per second.
+  virtual size_t bytes(const Corpus &corpus) { return 0; }
+  virtual size_t statements(const Corpus &corpus) { return _lookup == TablePrefix ? 1000 : 100; }
+
+private:
+  Lookup _lookup;
+  ObjectNameIndex _index;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+static void run_benchmark(Environment &environment, Benchmark &benchmark, const Corpus &corpus)
+{
+  if (!environment.benchmarks.empty() && environment.benchmarks.count(benchmark.name()) == 0)
+    return;
+
+  BenchmarkResult result;
+  result.benchmark = benchmark.name();
+  result.corpus = corpus.name;
+  result.bytes = benchmark.bytes(corpus);
+  result.statements = benchmark.statements(corpus);
+
+  g_printerr("Running %s on %s...\n", result.benchmark.c_str(), result.corpus.c_str());
+
+  benchmark.run(environment, corpus, result.counters);
+
+  GTimer *timer = g_timer_new();
+  for (size_t i = 0; i < environment.iterations; ++i)
+  {
+    g_timer_start(timer);
+    benchmark.run(environment, corpus, result.counters);
+    result.timings.push_back(g_timer_elapsed(timer, NULL));
+  }
+  g_timer_destroy(timer);
+
+  print_result(result);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void print_usage()
+{
+  g_printerr("\nSyntax:\n");
+  g_printerr("  parser_benchmark [--source-dir <dir>] [--iterations <n>] [--sizes <n,n,...>]\n");
+  g_printerr("                   [--server-version <n>] [--only <benchmark,...>] [file ...]\n\n");
+  g_printerr("Benchmarks: split, editor_scroll, editor_edit, scan, scan_fresh, parse, parse_fresh, parse_pooled,\n");
+  g_printerr("            syntax_check, legacy_parser, legacy_parser_unindexed, completion, name_index_table_prefix,\n");
+  g_printerr("            name_index_schema_prefix, name_index_schema_fuzzy.\n");
+  g_printerr("Results are written to stdout as one JSON object per line.\n");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  std::string source_dir = ".";
+  std::vector<std::string> sizes = split_list("100,1000,10000");
+  std::vector<std::string> files;
+  long server_version = 50710;
+
+  Environment environment;
+  environment.iterations = 5;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--source-dir" && has_value)
+      source_dir = argv[++i];
+    else if (arg == "--iterations" && has_value)
+      environment.iterations = (size_t)std::max(1, base::atoi<int>(argv[++i], 1));
+    else if (arg == "--sizes" && has_value)
+      sizes = split_list(argv[++i]);
+    else if (arg == "--server-version" && has_value)
+      server_version = base::atoi<long>(argv[++i], 50710);
+    else if (arg == "--only" && has_value)
+    {
+      std::vector<std::string> names = split_list(argv[++i]);
+      environment.benchmarks.insert(names.begin(), names.end());
+    }
+    else if (arg == "--help" || arg == "-h" || base::starts_with(arg, "--"))
+    {
+      print_usage();
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+    else
+      files.push_back(arg);
+  }
+
+  std::string rdbms_path = bec::make_path(source_dir, "modules/db.mysql/res/mysql_rdbms_info.xml");
+  if (!g_file_test(rdbms_path.c_str(), G_FILE_TEST_EXISTS))
+  {
+    g_printerr("Cannot find %s, please specify the Workbench source folder with --source-dir.\n", rdbms_path.c_str());
+    return 1;
+  }
+
+  // The legacy parser needs a GRT manager (for its app options), which owns the GRT.
+  bec::GRTManager grtm(false);
+  environment.grt = grtm.get_grt();
+  environment.grt->scan_metaclasses_in(bec::make_path(source_dir, "res/grt/"));
+  environment.grt->end_loading_metaclasses();
+
+  environment.grt->get_native_module<MySQLParserServicesImpl>();
+  environment.grt->get_native_module<MysqlSqlFacadeImpl>();
+  environment.services = MySQLParserServices::get(environment.grt);
+  environment.facade = SqlFacade::instance_for_rdbms_name(environment.grt, "Mysql");
+
+  environment.rdbms = db_mgmt_RdbmsRef::cast_from(environment.grt->unserialize(rdbms_path));
+
+  environment.server_version = server_version;
+  environment.version = GrtVersionRef(environment.grt);
+  environment.version->majorNumber(server_version / 10000);
+  environment.version->minorNumber((server_version / 100) % 100);
+  environment.version->releaseNumber(server_version % 100);
+  environment.version->buildNumber(-1);
+
+  GrtCharacterSetsRef charsets = environment.rdbms->characterSets();
+  for (size_t i = 0; i < charsets->count(); ++i)
+    environment.charsets.insert(base::tolower(*charsets[i]->name()));
+  environment.context = MySQLParserServices::createParserContext(charsets, environment.version, false);
+
+  MySQLEditor::load_completion_grammar(bec::make_path(source_dir, "library/mysql.parser/grammar/MySQL.g"));
+
+  // Collect the corpora.
+  std::vector<Corpus> corpora;
+  for (size_t i = 0; i < sizes.size(); ++i)
+  {
+    Corpus corpus;
+    corpus.name = "generated_" + sizes[i];
+    corpus.sql = generate_script((size_t)std::max(1, base::atoi<int>(sizes[i], 100)));
+    corpora.push_back(corpus);
+  }
+
+  std::string sys_folder = bec::make_path(source_dir, "res/scripts/sys");
+  std::string sys_script = read_file(bec::make_path(sys_folder, "sys_57.sql"));
+  if (!sys_script.empty())
+  {
+    Corpus corpus;
+    corpus.name = "sys_57";
+    corpus.sql = expand_source_commands(sys_script, sys_folder);
+    corpora.push_back(corpus);
+  }
+  else
+    g_printerr("sys schema script not found, skipping it.\n");
+
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    Corpus corpus;
+    corpus.name = base::basename(files[i]);
+    corpus.sql = read_file(files[i]);
+    if (corpus.sql.empty())
+    {
+      g_printerr("Cannot read %s or it is empty, skipping it.\n", files[i].c_str());
+      continue;
+    }
+    corpora.push_back(corpus);
+  }
+
+  for (size_t i = 0; i < corpora.size(); ++i)
+    split_corpus(environment, corpora[i]);
+
+  SplitterBenchmark splitter;
+  EditorScrollBenchmark editor_scroll;
+  EditorEditBenchmark editor_edit;
+  ScannerBenchmark scanner(true);
+  ScannerBenchmark scanner_fresh(false);
+  ParserBenchmark parser(ParserBenchmark::Reused);
+  ParserBenchmark parser_fresh(ParserBenchmark::Fresh);
+  ParserBenchmark parser_pooled(ParserBenchmark::Pooled);
+  SyntaxCheckBenchmark syntax_check;
+  LegacyParserBenchmark legacy_parser(true);
+  LegacyParserBenchmark legacy_parser_unindexed(false);
+  CompletionBenchmark completion;
+
+  Benchmark *benchmarks[] = { &splitter, &editor_scroll, &editor_edit, &scanner, &scanner_fresh, &parser,
+    &parser_fresh, &parser_pooled, &syntax_check, &legacy_parser, &legacy_parser_unindexed, &completion };
+  for (size_t i = 0; i < corpora.size(); ++i)
+    for (size_t j = 0; j < sizeof(benchmarks) / sizeof(benchmarks[0]); ++j)
+      run_benchmark(environment, *benchmarks[j], corpora[i]);
+
+  // Benchmarks on generated data of their own.
+  Corpus catalog;
+  catalog.name = "catalog_100k_columns";
+  NameIndexBenchmark name_index_table_prefix(NameIndexBenchmark::TablePrefix);
+  NameIndexBenchmark name_index_schema_prefix(NameIndexBenchmark::SchemaPrefix);
+  NameIndexBenchmark name_index_schema_fuzzy(NameIndexBenchmark::SchemaFuzzy);
+  run_benchmark(environment, name_index_table_prefix, catalog);
+  run_benchmark(environment, name_index_schema_prefix, catalog);
+  run_benchmark(environment, name_index_schema_fuzzy, catalog);
+
+  return 0;
+}
+
+//--------------------------------------------------------------------------------------------------
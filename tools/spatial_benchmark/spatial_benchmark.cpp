@@ -0,0 +1,229 @@
+/*
+ * Copyright (c) 2015, Oracle and/or its affiliates. All rights reserved.
+ *
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License as
+ * published by the Free Software Foundation; version 2 of the
+ * License.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin St, Fifth Floor, Boston, MA
+ * 02110-1301  USA
+ */
+
+/**
+ * Benchmarks for the feature import and reprojection of the spatial viewer, serial and parallel.
+ *
+ * The features are generated polygons spread over the whole map. Results are written to stdout
+ * as one JSON object per line (the same format as parser_benchmark), progress goes to stderr.
+ *
+ * Syntax:
+ *   spatial_benchmark [--iterations <n>] [--features <n>] [--threads <n>]
+ *
+ * The thread count is used for the parallel benchmarks (default: one per processor).
+ */
+
+#include <glib.h>
+
+#include <algorithm>
+#include <memory>
+
+#include "base/string_utilities.h"
+#include "grt/spatial_handler.h"
+
+//--------------------------------------------------------------------------------------------------
+
+struct BenchmarkResult
+{
+  std::string benchmark;
+  size_t features;
+  std::vector<double> timings;
+};
+
+//--------------------------------------------------------------------------------------------------
+
+static void generate_polygons(std::vector<std::pair<int, std::string> > &data, int count)
+{
+  data.reserve(count);
+  for (int i = 0; i < count; ++i)
+  {
+    double x = -170 + (i % 340);
+    double y = -80 + (i / 340) % 160;
+    std::string wkt = base::strfmt("POLYGON((%f %f,%f %f,%f %f,%f %f,%f %f,%f %f))",
+      x, y, x + 0.5, y, x + 0.5, y + 0.25, x + 0.5, y + 0.5, x, y + 0.5, x, y);
+    data.push_back(std::make_pair(i, wkt));
+  }
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static spatial::Converter *create_converter(spatial::ProjectionType type)
+{
+  spatial::ProjectionView view;
+  view.width = 1000;
+  view.height = 500;
+  view.MaxLat = 179;
+  view.MinLat = -179;
+  view.MaxLon = 89;
+  view.MinLon = -89;
+
+  return new spatial::Converter(view, spatial::Projection::get_instance().get_projection(spatial::ProjGeodetic),
+    spatial::Projection::get_instance().get_projection(type));
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static double median(std::vector<double> values)
+{
+  if (values.empty())
+    return 0;
+
+  std::sort(values.begin(), values.end());
+  size_t middle = values.size() / 2;
+  if (values.size() % 2 == 0)
+    return (values[middle - 1] + values[middle]) / 2;
+  return values[middle];
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void print_result(const BenchmarkResult &result)
+{
+  double minimum = *std::min_element(result.timings.begin(), result.timings.end());
+  double sum = 0;
+  for (size_t i = 0; i < result.timings.size(); ++i)
+    sum += result.timings[i];
+  double mean = sum / result.timings.size();
+  double middle = median(result.timings);
+  double features_per_s = middle > 0 ? result.features / middle : 0;
+
+  std::string line = base::strfmt("{\"benchmark\": \"%s\", \"features\": %lu, \"iterations\": %lu, "
+    "\"seconds_min\": %.6f, \"seconds_median\": %.6f, \"seconds_mean\": %.6f, \"features_per_s\": %.1f}\n",
+    result.benchmark.c_str(), (unsigned long)result.features, (unsigned long)result.timings.size(),
+    minimum, middle, mean, features_per_s);
+
+  fputs(line.c_str(), stdout);
+  fflush(stdout);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Imports the features into a new layer in each run.
+ */
+static void benchmark_import(const std::vector<std::pair<int, std::string> > &data, int threads,
+  size_t iterations, const std::string &name)
+{
+  g_printerr("Running %s...\n", name.c_str());
+
+  BenchmarkResult result;
+  result.benchmark = name;
+  result.features = data.size();
+
+  GTimer *timer = g_timer_new();
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    spatial::Layer layer(spatial::new_layer_id(), base::Color(0, 0, 0));
+    layer.set_max_threads(threads);
+
+    g_timer_start(timer);
+    layer.add_features(data, true);
+    result.timings.push_back(g_timer_elapsed(timer, NULL));
+  }
+  g_timer_destroy(timer);
+
+  print_result(result);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+/**
+ * Renders an imported layer. Without the cached variant each run uses a new converter, which has a new
+ * projection serial and so makes the features reproject. The cached variant renders with the same converter
+ * again (as after panning or zooming), which only maps the projected coordinates to the screen.
+ */
+static void benchmark_render(const std::vector<std::pair<int, std::string> > &data, int threads,
+  size_t iterations, bool cached, const std::string &name)
+{
+  g_printerr("Running %s...\n", name.c_str());
+
+  BenchmarkResult result;
+  result.benchmark = name;
+  result.features = data.size();
+
+  spatial::Layer layer(spatial::new_layer_id(), base::Color(0, 0, 0));
+  layer.set_max_threads(threads);
+  layer.add_features(data, true);
+
+  std::auto_ptr<spatial::Converter> converter(create_converter(spatial::ProjRobinson));
+  layer.render(converter.get());
+
+  GTimer *timer = g_timer_new();
+  for (size_t i = 0; i < iterations; ++i)
+  {
+    if (!cached)
+      converter.reset(create_converter(spatial::ProjRobinson));
+
+    g_timer_start(timer);
+    layer.render(converter.get());
+    result.timings.push_back(g_timer_elapsed(timer, NULL));
+  }
+  g_timer_destroy(timer);
+
+  print_result(result);
+}
+
+//--------------------------------------------------------------------------------------------------
+
+static void print_usage()
+{
+  g_printerr("\nSyntax:\n");
+  g_printerr("  spatial_benchmark [--iterations <n>] [--features <n>] [--threads <n>]\n\n");
+  g_printerr("Benchmarks: import_serial, import_parallel, render_serial, render_parallel, render_cached.\n");
+  g_printerr("Results are written to stdout as one JSON object per line.\n");
+}
+
+//--------------------------------------------------------------------------------------------------
+
+int main(int argc, char **argv)
+{
+  size_t iterations = 5;
+  int feature_count = 50000;
+  int threads = -1;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+    bool has_value = i + 1 < argc;
+    if (arg == "--iterations" && has_value)
+      iterations = (size_t)std::max(1, base::atoi<int>(argv[++i], 1));
+    else if (arg == "--features" && has_value)
+      feature_count = std::max(1, base::atoi<int>(argv[++i], 50000));
+    else if (arg == "--threads" && has_value)
+      threads = std::max(1, base::atoi<int>(argv[++i], 1));
+    else
+    {
+      print_usage();
+      return arg == "--help" || arg == "-h" ? 0 : 1;
+    }
+  }
+
+  std::vector<std::pair<int, std::string> > data;
+  generate_polygons(data, feature_count);
+
+  benchmark_import(data, 1, iterations, "import_serial");
+  benchmark_import(data, threads, iterations, "import_parallel");
+  benchmark_render(data, 1, iterations, false, "render_serial");
+  benchmark_render(data, threads, iterations, false, "render_parallel");
+  benchmark_render(data, threads, iterations, true, "render_cached");
+
+  return 0;
+}
+
+//--------------------------------------------------------------------------------------------------